@@ -0,0 +1,12 @@
+#include <fmus/plugins/plugin_host.h>
+
+/**
+ * Plugin host process
+ *
+ * Started by fmus::plugins::PluginHost to run a single plugin out of
+ * process. It is not meant to be launched by hand: the parent passes the
+ * shared-memory segment and eventfd descriptors on the command line.
+ */
+int main(int argc, char* argv[]) {
+    return fmus::plugins::runPluginHost(argc, argv);
+}
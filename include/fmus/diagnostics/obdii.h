@@ -7,6 +7,7 @@
  */
 
 #include <fmus/protocols/can.h>
+#include <fmus/protocols/transport.h>
 #include <vector>
 #include <memory>
 #include <functional>
@@ -215,6 +216,14 @@ public:
      */
     bool initialize(const OBDConfig& config, std::shared_ptr<protocols::CANProtocol> canProtocol);
     
+    /**
+     * @brief Initialize OBD client on any diagnostic transport
+     *
+     * Positive responses from every ECU the transport reaches are accepted.
+     * The transport is left open on shutdown.
+     */
+    bool initialize(const OBDConfig& config, std::shared_ptr<protocols::DiagnosticTransport> transport);
+    
     /**
      * @brief Shutdown OBD client
      */
@@ -0,0 +1,203 @@
+#ifndef FMUS_DIAGNOSTICS_PROTOCOL_DETECTOR_H
+#define FMUS_DIAGNOSTICS_PROTOCOL_DETECTOR_H
+
+/**
+ * @file protocol_detector.h
+ * @brief Concurrent OBD protocol auto-detection over a J2534 device
+ */
+
+#include <fmus/j2534/channel.h>
+#include <array>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace diagnostics {
+
+/**
+ * @brief OBD protocols the detector can find
+ */
+enum class OBDProtocol {
+    CAN_11BIT_500K = 0,     ///< ISO 15765-4, 11-bit IDs, 500 kbps
+    CAN_29BIT_500K,         ///< ISO 15765-4, 29-bit IDs, 500 kbps
+    CAN_11BIT_250K,         ///< ISO 15765-4, 11-bit IDs, 250 kbps
+    CAN_29BIT_250K,         ///< ISO 15765-4, 29-bit IDs, 250 kbps
+    KWP2000_FAST_INIT,      ///< ISO 14230-4, fast initialization
+    KWP2000_5BAUD_INIT,     ///< ISO 14230-4, 5-baud initialization
+    ISO9141_2,              ///< ISO 9141-2, 5-baud initialization
+    J1850_VPW,              ///< SAE J1850 VPW, 10.4 kbps
+    J1850_PWM,              ///< SAE J1850 PWM, 41.6 kbps
+    UNKNOWN
+};
+
+/// Number of detectable protocols, i.e. OBDProtocol values before UNKNOWN
+constexpr size_t OBD_PROTOCOL_COUNT = static_cast<size_t>(OBDProtocol::UNKNOWN);
+
+/**
+ * @brief Outcome of one detection run
+ */
+struct DetectionResult {
+    OBDProtocol protocol = OBDProtocol::UNKNOWN;
+    std::shared_ptr<j2534::PassThruChannel> channel;    ///< Open channel on the found protocol
+    std::vector<uint32_t> responders;                   ///< CAN IDs or node addresses that answered
+    std::vector<uint8_t> keyBytes;                      ///< K-line key bytes, if any
+    std::vector<OBDProtocol> probed;                    ///< Probes that ran, in completion order
+    std::chrono::milliseconds elapsed{0};
+
+    bool success() const { return protocol != OBDProtocol::UNKNOWN; }
+    std::string toString() const;
+};
+
+/**
+ * @brief Learned likelihood of each protocol, per VIN and per region
+ *
+ * A VIN seen before goes straight to the protocol it last connected on.
+ * Otherwise candidates are tried in order of how often they succeeded in
+ * the region, which puts J1850 first for older US fleets and K-line first
+ * where that dominates. Thread-safe.
+ */
+class FMUS_AUTO_API ProtocolPriors {
+public:
+    ProtocolPriors();
+    ~ProtocolPriors();
+
+    ProtocolPriors(const ProtocolPriors&) = delete;
+    ProtocolPriors& operator=(const ProtocolPriors&) = delete;
+
+    /**
+     * @brief Record a successful connection
+     */
+    void record(const std::string& vin, const std::string& region, OBDProtocol protocol);
+
+    /**
+     * @brief Protocol a VIN last connected on, or UNKNOWN
+     */
+    OBDProtocol lookup(const std::string& vin) const;
+
+    /**
+     * @brief Successful connections per protocol in a region
+     */
+    std::array<uint32_t, OBD_PROTOCOL_COUNT> getRegionCounts(const std::string& region) const;
+
+    /**
+     * @brief Sort candidates: the VIN's protocol first, then by regional count
+     *
+     * Ties keep the given order, so callers pass their default order.
+     */
+    std::vector<OBDProtocol> order(std::vector<OBDProtocol> candidates,
+                                   const std::string& vin, const std::string& region) const;
+
+    /**
+     * @brief Load and save as a line-based text file
+     */
+    bool loadFromFile(const std::string& filename);
+    bool saveToFile(const std::string& filename) const;
+
+    void clear();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+/**
+ * @brief Detector configuration
+ */
+struct DetectorConfig {
+    std::chrono::milliseconds canTimeout{150};      ///< Wait for a mode $01 reply on CAN
+    std::chrono::milliseconds serialTimeout{300};   ///< Wait for a reply on J1850
+    std::chrono::milliseconds kLineDelay{200};      ///< Head start for CAN before K-line inits begin
+    bool parallel = true;                           ///< Run CAN, K-line and J1850 concurrently
+    std::string region;                             ///< Region key for ProtocolPriors
+    std::vector<OBDProtocol> candidates;            ///< Probes to run; empty for all
+
+    std::string toString() const;
+};
+
+/**
+ * @brief Finds the OBD protocol of the connected vehicle
+ *
+ * Probes run in three lanes on separate channels, since each uses its own
+ * DLC pins: CAN (pins 6/14), K-line (pin 7) and J1850 (pins 2/10). Both
+ * ID widths at one CAN bit rate share a CAN_ID_BOTH channel where the
+ * adapter supports it. CAN channels are opened as many at once as the
+ * adapter grants and probed together; those it refuses run in a later
+ * round. K-line inits are slow, so that lane waits kLineDelay unless the
+ * priors favour K-line, letting a CAN vehicle answer before any 5-baud
+ * init starts. ISO 9141-2 and ISO 14230 share one 5-baud init, whose key
+ * bytes pick the protocol and the channel framing. The first success
+ * cancels everything not yet started and ends every probe's wait; a
+ * probe that is already running an init finishes and is closed. Probes
+ * whose channel could not be opened while others held the adapter are
+ * retried one at a time afterwards.
+ */
+class FMUS_AUTO_API ProtocolDetector {
+public:
+    /**
+     * @brief Detector statistics
+     */
+    struct Statistics {
+        uint64_t detections = 0;
+        uint64_t failures = 0;
+        uint64_t cacheHits = 0;
+        std::chrono::milliseconds lastDetectionTime{0};
+        std::chrono::milliseconds totalDetectionTime{0};
+    };
+
+    ProtocolDetector(std::shared_ptr<j2534::PassThruDevice> device,
+                     std::shared_ptr<ProtocolPriors> priors = nullptr);
+    ~ProtocolDetector();
+
+    ProtocolDetector(const ProtocolDetector&) = delete;
+    ProtocolDetector& operator=(const ProtocolDetector&) = delete;
+
+    void setConfig(const DetectorConfig& config);
+    DetectorConfig getConfig() const;
+
+    std::shared_ptr<ProtocolPriors> getPriors() const;
+
+    /**
+     * @brief Detect the protocol
+     * @param vin VIN if already known, used for the cache and recorded on success
+     */
+    DetectionResult detect(const std::string& vin = "");
+
+    /**
+     * @brief Abort a detection running on another thread
+     *
+     * A cancel that arrives before that detect() call has started still
+     * aborts it; the flag is cleared when the run ends.
+     */
+    void cancel();
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+// Utility functions
+FMUS_AUTO_API std::string obdProtocolToString(OBDProtocol protocol);
+FMUS_AUTO_API OBDProtocol stringToOBDProtocol(const std::string& str);
+FMUS_AUTO_API j2534::Protocol obdProtocolToJ2534(OBDProtocol protocol);
+
+} // namespace diagnostics
+} // namespace fmus
+
+#endif // FMUS_DIAGNOSTICS_PROTOCOL_DETECTOR_H
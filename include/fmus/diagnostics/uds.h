@@ -7,6 +7,8 @@
  */
 
 #include <fmus/protocols/can.h>
+#include <fmus/protocols/doip.h>
+#include <fmus/protocols/transport.h>
 #include <vector>
 #include <memory>
 #include <functional>
@@ -121,6 +123,16 @@ struct UDSMessage {
      */
     static UDSMessage fromCANMessage(const protocols::CANMessage& canMsg);
     
+    /**
+     * @brief Serialize as service ID followed by data
+     */
+    std::vector<uint8_t> toBytes() const;
+    
+    /**
+     * @brief Parse a raw UDS PDU
+     */
+    static UDSMessage fromBytes(const uint8_t* bytes, size_t length);
+    
     /**
      * @brief Get string representation
      */
@@ -134,6 +146,9 @@ struct UDSMessage {
 
 /**
  * @brief UDS Configuration
+ *
+ * Over DoIP, requestId is the ECU's logical address and responseId the
+ * logical address its responses come from, usually the same value.
  */
 struct UDSConfig {
     uint32_t requestId = 0x7E0;         ///< Request CAN ID
@@ -144,6 +159,7 @@ struct UDSConfig {
     bool extendedAddressing = false;    ///< Use extended addressing
     uint8_t sourceAddress = 0xF1;       ///< Source address for extended addressing
     uint8_t targetAddress = 0x10;       ///< Target address for extended addressing
+    std::string securityAlgorithm;      ///< Registered key algorithm used by unlockSecurityAccess(level)
     
     std::string toString() const;
 };
@@ -168,6 +184,19 @@ public:
      */
     bool initialize(const UDSConfig& config, std::shared_ptr<protocols::CANProtocol> canProtocol);
     
+    /**
+     * @brief Initialize UDS client on a DoIP connection with routing active
+     */
+    bool initialize(const UDSConfig& config, std::shared_ptr<protocols::DoIPClient> doipClient);
+    
+    /**
+     * @brief Initialize UDS client on any diagnostic transport
+     *
+     * Requests go to the transport's peer; responses are accepted from
+     * config.responseId. The transport is left open on shutdown.
+     */
+    bool initialize(const UDSConfig& config, std::shared_ptr<protocols::DiagnosticTransport> transport);
+    
     /**
      * @brief Shutdown UDS client
      */
@@ -178,6 +207,11 @@ public:
      */
     bool isInitialized() const;
     
+    /**
+     * @brief Capabilities of the transport in use, for sizing requests
+     */
+    protocols::TransportCapabilities getTransportCapabilities() const;
+    
     /**
      * @brief Send UDS request and wait for response
      */
@@ -200,6 +234,14 @@ public:
     std::vector<uint8_t> requestSeed(uint8_t level);
     bool sendKey(uint8_t level, const std::vector<uint8_t>& key);
     bool unlockSecurityAccess(uint8_t level, const std::vector<uint8_t>& key);
+
+    /**
+     * @brief Unlock using the key algorithm named in the configuration
+     *
+     * The key is computed from the seed by the algorithm registered under
+     * UDSConfig::securityAlgorithm in the global extension registry.
+     */
+    bool unlockSecurityAccess(uint8_t level);
     
     // Tester Present (0x3E)
     bool sendTesterPresent(bool suppressResponse = false);
@@ -208,6 +250,21 @@ public:
     std::vector<uint8_t> readDataByIdentifier(uint16_t dataIdentifier);
     std::map<uint16_t, std::vector<uint8_t>> readMultipleDataByIdentifier(
         const std::vector<uint16_t>& identifiers);
+
+    /**
+     * @brief Value decoded from a data identifier record
+     */
+    struct DecodedDataValue {
+        std::string name;
+        double value = 0.0;
+        std::string unit;
+    };
+
+    /**
+     * @brief Read a data identifier and decode it with the plugin decoder registered for it
+     * @return Decoded values, empty if no decoder is registered or the read fails
+     */
+    std::vector<DecodedDataValue> readDecodedDataByIdentifier(uint16_t dataIdentifier);
     
     // Write Data by Identifier (0x2E)
     bool writeDataByIdentifier(uint16_t dataIdentifier, const std::vector<uint8_t>& data);
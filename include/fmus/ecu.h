@@ -13,6 +13,8 @@
 #include <functional>
 #include <chrono>
 #include <map>
+#include <variant>
+#include <cstdint>
 
 #ifdef _WIN32
     #ifdef FMUS_AUTO_EXPORTS
@@ -115,6 +117,54 @@ struct FMUS_AUTO_API Parameter {
     std::string getFormattedValue() const; ///< Get value with unit
 };
 
+/**
+ * @struct DiagnosticTroubleCode
+ * @brief DTC as read from an ECU, with decoded status flags
+ */
+struct FMUS_AUTO_API DiagnosticTroubleCode {
+    std::string code;           ///< DTC code (e.g., "P0301")
+    std::string description;    ///< Human-readable description
+    uint8_t status = 0;         ///< Raw status byte
+    bool isPending = false;
+    bool isConfirmed = false;
+    bool isActive = false;
+    std::chrono::system_clock::time_point timestamp; ///< When the DTC was read
+
+    char getCategory() const;           ///< 'P', 'C', 'B' or 'U'
+    bool isEmissionsRelated() const;
+};
+
+/**
+ * @struct LiveDataParameter
+ * @brief One live data reading
+ */
+struct FMUS_AUTO_API LiveDataParameter {
+    std::string name;           ///< Parameter name
+    std::string description;    ///< Human-readable description
+    std::variant<int32_t, uint32_t, float, double, std::string> value;
+    std::string unit;           ///< Unit of measurement
+    std::chrono::system_clock::time_point timestamp; ///< When the value was read
+
+    std::string getValueAsString() const;
+    std::optional<double> getValueAsNumber() const; ///< Empty for string values
+};
+
+/**
+ * @struct ECUIdentification
+ * @brief ECU identification data
+ */
+struct FMUS_AUTO_API ECUIdentification {
+    std::string vin;
+    std::string ecuSerialNumber;
+    std::string partNumber;
+    std::string softwareVersion;
+    std::string hardwareVersion;
+    std::string supplierName;
+    std::string calibrationId;
+    std::string repairShopCode;
+    std::string programmingDate;
+};
+
 /**
  * @class ECU
  * @brief Interface for ECU diagnostics and programming
@@ -13,6 +13,8 @@
 #include <map>
 #include <chrono>
 #include <functional>
+#include <stdexcept>
+#include <cstdint>
 
 // Define exports macro
 #ifdef _WIN32
@@ -294,6 +296,107 @@ private:
     std::unique_ptr<Impl> pImpl;
 };
 
+/**
+ * @brief One pre-formatted column of an export
+ *
+ * Cells hold the final display string for the value; writers only apply
+ * their own escaping on top of it.
+ */
+struct FormattedColumn {
+    std::string name;
+    std::vector<std::string> values;
+    bool numeric = false;           ///< Values can be emitted unquoted (JSON)
+};
+
+/**
+ * @brief Export data converted once into shared intermediate columns
+ */
+struct FormattedExportData {
+    ExportDataType type = ExportDataType::CUSTOM_DATA;
+    std::string name;
+    std::string description;
+    std::string timestamp;
+    std::vector<std::pair<std::string, std::string>> metadata;
+    std::vector<FormattedColumn> columns;
+    size_t rowCount = 0;
+    
+    /**
+     * @brief Walk the source data once and format every value
+     */
+    static FormattedExportData build(const ExportData& data, const std::string& dateFormat);
+    
+    /**
+     * @brief Approximate size of all cells, used to presize writer buffers
+     */
+    size_t estimateSize() const;
+};
+
+/**
+ * @brief Format writer operating on pre-formatted columns
+ */
+using ColumnWriter = std::function<bool(const FormattedExportData& data,
+                                        const ExportConfig& config,
+                                        std::string& output)>;
+
+/**
+ * @brief Result of a fan-out export
+ */
+struct FanOutExportResult {
+    std::vector<ExportResult> results;              ///< One result per requested config, same order
+    std::chrono::milliseconds formatDuration{0};    ///< Time spent in the shared formatting pass
+    std::chrono::milliseconds totalDuration{0};     ///< Wall time of the whole export
+    
+    bool allSucceeded() const;
+    std::string toString() const;
+};
+
+/**
+ * @brief Multi-format exporter sharing a single serialization pass
+ *
+ * The data is walked once into a FormattedExportData, then one writer per
+ * requested format runs on the global thread pool. Total time approaches the
+ * slowest single writer instead of the sum of all of them.
+ */
+class FMUS_AUTO_API FanOutExporter {
+public:
+    /**
+     * @brief Constructor - registers the built-in CSV, JSON, XML, HTML and TXT writers
+     */
+    FanOutExporter();
+    
+    /**
+     * @brief Destructor
+     */
+    ~FanOutExporter();
+    
+    /**
+     * @brief Register or replace the writer for a format
+     */
+    void registerWriter(ExportFormat format, ColumnWriter writer);
+    
+    /**
+     * @brief Check if a writer is available for a format
+     */
+    bool supportsFormat(ExportFormat format) const;
+    
+    /**
+     * @brief Export the same data to every config in parallel
+     *
+     * Timestamps are formatted with the dateFormat of the first config.
+     */
+    FanOutExportResult exportAll(const ExportData& data, const std::vector<ExportConfig>& configs,
+                                 ExportProgressCallback callback = nullptr);
+    
+    /**
+     * @brief Render one format into memory without writing a file
+     */
+    bool render(const FormattedExportData& data, const ExportConfig& config, std::string& output) const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
 /**
  * @brief Export template system
  */
@@ -358,6 +461,9 @@ FMUS_AUTO_API std::string exportDataTypeToString(ExportDataType type);
 FMUS_AUTO_API ExportDataType stringToExportDataType(const std::string& str);
 FMUS_AUTO_API std::string generateUniqueFileName(const std::string& baseName, ExportFormat format);
 FMUS_AUTO_API bool isValidExportPath(const std::string& path);
+FMUS_AUTO_API std::string escapeCSVField(const std::string& field, const std::string& delimiter = ",");
+FMUS_AUTO_API std::string escapeJSONString(const std::string& str);
+FMUS_AUTO_API std::string escapeXMLText(const std::string& str);
 
 } // namespace export_system
 } // namespace fmus
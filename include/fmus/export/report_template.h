@@ -0,0 +1,131 @@
+#ifndef FMUS_EXPORT_REPORT_TEMPLATE_H
+#define FMUS_EXPORT_REPORT_TEMPLATE_H
+
+/**
+ * @file report_template.h
+ * @brief Precompiled report templates for HTML/PDF report generation
+ */
+
+#include <fmus/export/data_exporter.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace export_system {
+
+/**
+ * @brief Escaping applied to substituted values
+ */
+enum class TemplateEscape {
+    NONE,           ///< Values are inserted verbatim
+    HTML,           ///< HTML/XML entity escaping
+    JSON            ///< JSON string escaping
+};
+
+/**
+ * @brief Report template compiled into an instruction list
+ *
+ * Template syntax:
+ * - `{{name}}`, `{{description}}`, `{{timestamp}}`, `{{type}}`, `{{count}}`
+ * - `{{meta.KEY}}` and `{{custom.KEY}}` for metadata and custom data entries
+ * - `{{#dtcs}}...{{/dtcs}}` repeats its body per DTC; inside, `{{code}}`,
+ *   `{{description}}`, `{{status}}`, `{{pending}}`, `{{confirmed}}`, `{{active}}`, `{{timestamp}}`
+ * - `{{#liveData}}...{{/liveData}}` with `{{name}}`, `{{value}}`, `{{unit}}`, `{{description}}`, `{{timestamp}}`
+ * - `{{#ecuInfo}}...{{/ecuInfo}}` with `{{vin}}`, `{{serialNumber}}`, `{{partNumber}}`,
+ *   `{{softwareVersion}}`, `{{hardwareVersion}}`, `{{supplier}}`, `{{calibrationId}}`
+ * - `{{#log}}...{{/log}}` with `{{entry}}`; `{{#metadata}}` / `{{#custom}}` with `{{key}}`, `{{value}}`
+ * - `{{^dtcs}}...{{/dtcs}}` renders its body only when the section is empty
+ * - `{{{field}}}` inserts a value without escaping
+ *
+ * Field names are resolved when the template is compiled, static text is kept
+ * in a single literal pool, and rendering only appends into the output buffer.
+ * A compiled template is immutable and can be rendered from many threads.
+ */
+class FMUS_AUTO_API ReportTemplate {
+public:
+    /**
+     * @brief Compile template source
+     * @throws ExportError with TEMPLATE_ERROR on syntax errors or unknown fields
+     */
+    static std::shared_ptr<const ReportTemplate> compile(const std::string& source,
+                                                         TemplateEscape escape = TemplateEscape::HTML,
+                                                         const std::string& dateFormat = "%Y-%m-%d %H:%M:%S");
+
+    /**
+     * @brief Compile the "template" custom field of an export template
+     */
+    static std::shared_ptr<const ReportTemplate> compile(const ExportTemplate::TemplateInfo& templateInfo);
+
+    /**
+     * @brief Load and compile a template file
+     */
+    static std::shared_ptr<const ReportTemplate> compileFile(const std::string& filePath,
+                                                             TemplateEscape escape = TemplateEscape::HTML);
+
+    ~ReportTemplate();
+
+    /**
+     * @brief Render one report, replacing the contents of output
+     *
+     * The output capacity is kept, so reusing the same string across calls
+     * avoids reallocation once it has grown to the typical report size.
+     */
+    void render(const ExportData& data, std::string& output) const;
+
+    /**
+     * @brief Render one report into a new string
+     */
+    std::string render(const ExportData& data) const;
+
+    /**
+     * @brief Render many reports in parallel on the global thread pool
+     */
+    std::vector<std::string> renderBatch(const std::vector<ExportData>& reports) const;
+
+    /**
+     * @brief Render many reports in parallel and write each to its path
+     * @return One result per report
+     */
+    std::vector<ExportResult> renderBatchToFiles(const std::vector<ExportData>& reports,
+                                                 const std::vector<std::string>& filePaths) const;
+
+    /**
+     * @brief Number of compiled instructions
+     */
+    size_t getInstructionCount() const;
+
+    /**
+     * @brief Size of the static text pool in bytes
+     */
+    size_t getLiteralSize() const;
+
+    /**
+     * @brief Capacity reserved up front for a new output buffer
+     */
+    size_t getSizeHint() const;
+
+private:
+    ReportTemplate();
+
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace export_system
+} // namespace fmus
+
+#endif // FMUS_EXPORT_REPORT_TEMPLATE_H
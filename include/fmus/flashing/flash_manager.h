@@ -152,7 +152,7 @@ using FlashProgressCallback = std::function<void(
  * @brief Flash programming configuration
  */
 struct FlashConfig {
-    uint32_t blockSize = 256;           ///< Programming block size
+    uint32_t blockSize = 0;             ///< TransferData payload per request; 0 = largest the ECU and transport accept
     uint32_t timeout = 5000;            ///< Operation timeout (ms)
     bool verifyAfterWrite = true;       ///< Verify after each block
     bool eraseBeforeWrite = true;       ///< Erase before programming
@@ -8,11 +8,14 @@
 
 #include <fmus/auto.h>
 #include <fmus/ecu.h>
+#include <fmus/live_data_store.h>
+#include <fmus/gui/plot_decimator.h>
 #include <memory>
 #include <string>
 #include <vector>
 #include <functional>
 #include <map>
+#include <chrono>
 
 // Define exports macro
 #ifdef _WIN32
@@ -81,8 +84,26 @@ private:
     std::unique_ptr<Impl> pImpl;
 };
 
+/**
+ * @brief Displayed state of one live data parameter
+ */
+struct LiveDataRow {
+    std::string name;
+    std::string unit;
+    double value = 0.0;
+    int64_t timestampUs = 0;
+    uint64_t sampleCount = 0;
+    bool changed = false;       ///< New samples arrived since the previous frame
+};
+
 /**
  * @brief Live Data Widget
+ *
+ * updateParameter() only publishes into a LiveDataStore and is safe to call
+ * from acquisition threads. update() pulls what changed since the previous
+ * frame and folds it into per-parameter plots, so widget work follows the
+ * display refresh rate rather than the sample rate. Drive it from a
+ * RenderThread.
  */
 class FMUS_AUTO_API LiveDataWidget : public Widget {
 public:
@@ -109,6 +130,30 @@ public:
      */
     void clearParameters();
 
+    /**
+     * @brief Display channels of a shared store
+     *
+     * Acquisition code can then publish into the store directly by
+     * channel ID. Clears the displayed parameters.
+     */
+    void setDataSource(std::shared_ptr<LiveDataStore> store);
+    std::shared_ptr<LiveDataStore> getDataSource() const;
+
+    /**
+     * @brief Set plot width in pixels and the time span it covers
+     */
+    void setPlotGeometry(size_t columns, std::chrono::milliseconds span);
+
+    /**
+     * @brief Parameter rows as of the last update()
+     */
+    std::vector<LiveDataRow> getRows() const;
+
+    /**
+     * @brief Decimated plot of a parameter as of the last update()
+     */
+    bool getPlot(const std::string& name, std::vector<PlotColumn>& columns) const;
+
 private:
     class Impl;
     std::unique_ptr<Impl> pImpl;
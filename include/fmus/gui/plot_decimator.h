@@ -0,0 +1,105 @@
+#ifndef FMUS_GUI_PLOT_DECIMATOR_H
+#define FMUS_GUI_PLOT_DECIMATOR_H
+
+/**
+ * @file plot_decimator.h
+ * @brief Min/max-per-pixel decimation of scrolling plot series
+ */
+
+#include <fmus/live_data_store.h>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace gui {
+
+/**
+ * @brief Samples falling into one pixel column
+ *
+ * Drawing a vertical line from min to max, joined through first and last to
+ * the neighbouring columns, reproduces the full-resolution trace exactly at
+ * this pixel width.
+ */
+struct PlotColumn {
+    double min = 0.0;
+    double max = 0.0;
+    double first = 0.0;
+    double last = 0.0;
+    uint32_t count = 0;     ///< 0 for a gap
+};
+
+/**
+ * @brief Scrolling time series decimated to one bucket per pixel column
+ *
+ * Samples are folded into their column as they arrive, so each frame only
+ * pays for the samples published since the previous one and the drawing
+ * cost is bounded by the column count, whatever the sample rate.
+ */
+class FMUS_AUTO_API PlotDecimator {
+public:
+    /**
+     * @brief Constructor
+     * @param columns Plot width in pixels
+     * @param span Time covered by the plot
+     */
+    PlotDecimator(size_t columns = 600, std::chrono::microseconds span = std::chrono::seconds(30));
+
+    /**
+     * @brief Change the plot geometry; discards folded samples
+     */
+    void resize(size_t columns, std::chrono::microseconds span);
+
+    void add(const LiveSample& sample);
+    void add(const std::vector<LiveSample>& samples);
+
+    /**
+     * @brief Scroll the plot so its right edge is at timestampUs
+     */
+    void advanceTo(int64_t timestampUs);
+
+    void clear();
+
+    /**
+     * @brief Copy columns oldest first, always getColumnCount() entries
+     */
+    void getColumns(std::vector<PlotColumn>& columns) const;
+
+    /**
+     * @brief Min and max over all visible columns
+     * @return False if no column holds samples
+     */
+    bool getRange(double& min, double& max) const;
+
+    size_t getColumnCount() const { return columnCount; }
+    std::chrono::microseconds getSpan() const { return std::chrono::microseconds(columnWidth * static_cast<int64_t>(columnCount)); }
+
+    /**
+     * @brief Timestamp at the right edge of the plot
+     */
+    int64_t getEndTime() const { return (newestBucket + 1) * columnWidth; }
+
+private:
+    std::vector<PlotColumn> ring;
+    size_t columnCount;
+    int64_t columnWidth;                ///< Microseconds per column
+    int64_t newestBucket = -1;          ///< Absolute bucket index of the rightmost column
+    bool started = false;
+};
+
+} // namespace gui
+} // namespace fmus
+
+#endif // FMUS_GUI_PLOT_DECIMATOR_H
@@ -0,0 +1,89 @@
+#ifndef FMUS_GUI_RENDER_THREAD_H
+#define FMUS_GUI_RENDER_THREAD_H
+
+/**
+ * @file render_thread.h
+ * @brief Fixed-rate render loop decoupled from data acquisition
+ */
+
+#include <fmus/gui/main_window.h>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace gui {
+
+/**
+ * @brief Calls Widget::update() on its own thread at the display refresh rate
+ *
+ * Widgets pull their data each frame, so acquisition callbacks never touch
+ * the UI and any number of samples between two frames costs one update.
+ * A frame that overruns its deadline skips the missed ticks instead of
+ * rendering them back to back.
+ */
+class FMUS_AUTO_API RenderThread {
+public:
+    /**
+     * @brief Render statistics
+     */
+    struct Statistics {
+        uint64_t framesRendered = 0;
+        uint64_t framesSkipped = 0;
+        std::chrono::microseconds lastFrameTime{0};
+        std::chrono::microseconds maxFrameTime{0};
+        std::chrono::microseconds averageFrameTime{0};
+    };
+
+    explicit RenderThread(double refreshRate = 60.0);
+    ~RenderThread();
+
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    /**
+     * @brief Add a widget updated every frame; not owned
+     */
+    void addWidget(Widget* widget);
+
+    /**
+     * @brief Remove a widget; returns once it is no longer being updated
+     */
+    void removeWidget(Widget* widget);
+
+    /**
+     * @brief Set a callback run after the widgets each frame, e.g. to present
+     */
+    void setFrameCallback(std::function<void()> callback);
+
+    void setRefreshRate(double refreshRate);
+    double getRefreshRate() const;
+
+    bool start();
+    void stop();
+    bool isRunning() const;
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace gui
+} // namespace fmus
+
+#endif // FMUS_GUI_RENDER_THREAD_H
@@ -204,6 +204,15 @@ struct AdapterInfo {
     bool supportsProtocol(Protocol protocol) const;
 };
 
+/**
+ * @brief Bus access backend
+ */
+enum class Backend : uint32_t {
+    J2534 = 0,              ///< Vendor pass-thru library
+    SOCKETCAN = 1,          ///< Linux raw CAN socket
+    PLUGIN = 2              ///< Transport backend registered by a plugin
+};
+
 /**
  * @brief Connection options
  */
@@ -213,6 +222,8 @@ struct ConnectionOptions {
     Protocol protocol = Protocol::CAN;
     BaudRate baudRate = BaudRate::AUTO;
     uint32_t flags = 0;
+    Backend backend = Backend::J2534;
+    std::string interfaceName;      ///< SocketCAN interface, e.g. "can0" or "vcan0", or plugin backend name
     
     ConnectionOptions() = default;
     ConnectionOptions(const std::string& vendor, uint32_t id, Protocol proto, BaudRate baud)
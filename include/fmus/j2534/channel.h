@@ -0,0 +1,200 @@
+#ifndef FMUS_J2534_CHANNEL_H
+#define FMUS_J2534_CHANNEL_H
+
+/**
+ * @file channel.h
+ * @brief PassThru device and channel wrappers over a loaded J2534 library
+ */
+
+#include <fmus/j2534.h>
+#include <fmus/j2534/library_loader.h>
+#include <string>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace j2534 {
+
+/**
+ * @brief Logical channel opened with PassThruConnect
+ *
+ * Message::flags carries TxFlags on write and RxStatus on read. For CAN and
+ * ISO15765 the ID travels in Message::id; for the other protocols the
+ * message data is the raw frame. Reading and writing may happen from
+ * different threads. All failures throw J2534Error.
+ */
+class FMUS_AUTO_API PassThruChannel {
+public:
+    /**
+     * @brief Channel statistics
+     */
+    struct Statistics {
+        uint64_t messagesWritten = 0;
+        uint64_t messagesRead = 0;
+        uint64_t errors = 0;
+        std::chrono::system_clock::time_point startTime;
+    };
+
+    ~PassThruChannel();
+
+    PassThruChannel(const PassThruChannel&) = delete;
+    PassThruChannel& operator=(const PassThruChannel&) = delete;
+
+    Protocol getProtocol() const;
+    unsigned long getChannelId() const;
+    uint32_t getBaudRate() const;
+    bool isConnected() const;
+
+    /**
+     * @brief Disconnect the channel; also done by the destructor
+     */
+    void disconnect();
+
+    /**
+     * @brief Set configuration parameters in one SET_CONFIG call
+     */
+    void setConfig(const std::vector<SCONFIG>& parameters);
+    void setConfig(unsigned long parameter, unsigned long value);
+    unsigned long getConfig(unsigned long parameter);
+
+    /**
+     * @brief ISO 9141 / ISO 14230 5-baud initialization
+     * @return Key bytes reported by the ECU
+     */
+    std::vector<uint8_t> fiveBaudInit(uint8_t address);
+
+    /**
+     * @brief ISO 14230 fast initialization
+     * @param request StartCommunication request frame without checksum
+     * @return The ECU's StartCommunication response frame
+     */
+    Message fastInit(const Message& request);
+
+    void clearReceiveBuffer();
+    void clearTransmitBuffer();
+
+    /**
+     * @brief Write messages
+     * @return Number of messages the device accepted
+     */
+    size_t writeMessages(const std::vector<Message>& messages, uint32_t timeoutMs);
+    bool writeMessage(const Message& message, uint32_t timeoutMs);
+
+    /**
+     * @brief Append up to maxMessages received messages
+     *
+     * Returns early once at least one message is available; a timeout with
+     * nothing received is not an error.
+     * @return Number of messages appended
+     */
+    size_t readMessages(std::vector<Message>& messages, size_t maxMessages, uint32_t timeoutMs);
+
+    unsigned long startFilter(const Filter& filter);
+    void stopFilter(unsigned long filterId);
+
+    /**
+     * @brief Start a pass filter matching every frame
+     *
+     * Devices block all receive traffic until a filter exists, so protocols
+     * that filter in software open one of these after connecting.
+     */
+    unsigned long startPassAllFilter();
+
+    unsigned long startPeriodicMessage(const Message& message, uint32_t intervalMs);
+    void stopPeriodicMessage(unsigned long messageId);
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+    std::string toString() const;
+
+private:
+    friend class PassThruDevice;
+    PassThruChannel(std::shared_ptr<LibraryLoader> library, unsigned long channelId,
+                    Protocol protocol, uint32_t flags, uint32_t baudRate);
+
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+/**
+ * @brief Device opened with PassThruOpen
+ */
+class FMUS_AUTO_API PassThruDevice {
+public:
+    /**
+     * @brief Version strings reported by PassThruReadVersion
+     */
+    struct Version {
+        std::string firmware;
+        std::string dll;
+        std::string api;
+    };
+
+    PassThruDevice();
+    ~PassThruDevice();
+
+    PassThruDevice(const PassThruDevice&) = delete;
+    PassThruDevice& operator=(const PassThruDevice&) = delete;
+
+    /**
+     * @brief Load a J2534 library and open its device
+     * @return False on failure, see getLastError()
+     */
+    bool open(const std::string& libraryPath, const std::string& deviceName = "");
+
+    /**
+     * @brief Open a device through an already loaded library
+     */
+    bool open(std::shared_ptr<LibraryLoader> library, const std::string& deviceName = "");
+
+    void close();
+    bool isOpen() const;
+
+    /**
+     * @brief Open a channel
+     * @param dataBaudRate CAN FD data phase rate, set on channels opened with CAN_FD_FORMAT
+     * @throws J2534Error
+     */
+    std::shared_ptr<PassThruChannel> connect(Protocol protocol, uint32_t flags, uint32_t baudRate,
+                                             uint32_t dataBaudRate = 0);
+
+    /**
+     * @brief Battery voltage on pin 16 in millivolts
+     */
+    uint32_t readBatteryVoltage();
+
+    Version readVersion();
+
+    unsigned long getDeviceId() const;
+    std::shared_ptr<LibraryLoader> getLibrary() const;
+    std::string getLastError() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+/**
+ * @brief Check a PassThru return code
+ * @throws J2534Error with the library's last error text if code is not STATUS_NOERROR
+ */
+FMUS_AUTO_API void checkPassThruResult(const LibraryLoader& library, long code, const std::string& operation);
+
+} // namespace j2534
+} // namespace fmus
+
+#endif // FMUS_J2534_CHANNEL_H
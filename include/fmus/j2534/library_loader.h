@@ -186,6 +186,14 @@ struct SCONFIG_LIST {
     SCONFIG* ConfigPtr;
 };
 
+/**
+ * @brief J2534 Byte Array (FIVE_BAUD_INIT and functional lookup tables)
+ */
+struct SBYTE_ARRAY {
+    unsigned long NumOfBytes;
+    unsigned char* BytePtr;
+};
+
 // J2534 Constants
 namespace J2534Constants {
     // Protocol IDs
@@ -209,6 +217,18 @@ namespace J2534Constants {
     constexpr unsigned long CAN_29BIT_ID = 0x00000100;
     constexpr unsigned long ISO15765_FRAME_PAD = 0x00000040;
     constexpr unsigned long ISO15765_ADDR_TYPE = 0x00000080;
+    constexpr unsigned long ISO9141_NO_CHECKSUM = 0x00000200;
+    constexpr unsigned long CAN_ID_BOTH = 0x00000800;
+    constexpr unsigned long ISO9141_K_LINE_ONLY = 0x00001000;
+    constexpr unsigned long CAN_FD_BRS = 0x00100000;        // J2534-2 CAN FD bit rate switch
+    constexpr unsigned long CAN_FD_FORMAT = 0x00200000;     // J2534-2 CAN FD frame format
+
+    // RxStatus bits
+    constexpr unsigned long TX_MSG_TYPE = 0x00000001;
+    constexpr unsigned long START_OF_MESSAGE = 0x00000002;
+    constexpr unsigned long RX_BREAK = 0x00000004;
+    constexpr unsigned long TX_INDICATION = 0x00000008;
+    constexpr unsigned long CAN_FD_ESI = 0x00400000;        // J2534-2 CAN FD error state indicator
     
     // IOCTL IDs
     constexpr unsigned long GET_CONFIG = 0x01;
@@ -216,6 +236,10 @@ namespace J2534Constants {
     constexpr unsigned long READ_VBATT = 0x03;
     constexpr unsigned long FIVE_BAUD_INIT = 0x04;
     constexpr unsigned long FAST_INIT = 0x05;
+    constexpr unsigned long CLEAR_TX_BUFFER = 0x07;
+    constexpr unsigned long CLEAR_RX_BUFFER = 0x08;
+    constexpr unsigned long CLEAR_PERIODIC_MSGS = 0x09;
+    constexpr unsigned long CLEAR_MSG_FILTERS = 0x0A;
     
     // Configuration Parameters
     constexpr unsigned long DATA_RATE = 0x01;
@@ -230,6 +254,19 @@ namespace J2534Constants {
     constexpr unsigned long P3_MAX = 0x0B;
     constexpr unsigned long P4_MIN = 0x0C;
     constexpr unsigned long P4_MAX = 0x0D;
+    constexpr unsigned long W1 = 0x0E;
+    constexpr unsigned long W2 = 0x0F;
+    constexpr unsigned long W3 = 0x10;
+    constexpr unsigned long W4 = 0x11;
+    constexpr unsigned long W5 = 0x12;
+    constexpr unsigned long TIDLE = 0x13;
+    constexpr unsigned long TINIL = 0x14;
+    constexpr unsigned long TWUP = 0x15;
+    constexpr unsigned long PARITY = 0x16;
+    constexpr unsigned long W0 = 0x19;
+    constexpr unsigned long DATA_BITS = 0x20;
+    constexpr unsigned long FIVE_BAUD_MOD = 0x21;
+    constexpr unsigned long FD_CAN_DATA_PHASE_RATE = 0x801C;
 }
 
 } // namespace j2534
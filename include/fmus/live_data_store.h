@@ -0,0 +1,143 @@
+#ifndef FMUS_LIVE_DATA_STORE_H
+#define FMUS_LIVE_DATA_STORE_H
+
+/**
+ * @file live_data_store.h
+ * @brief Lock-free latest-value and history store for live data channels
+ */
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// Define exports macro for cross-platform compatibility
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+
+/**
+ * @brief One live data sample
+ */
+struct LiveSample {
+    int64_t timestampUs = 0;    ///< steady_clock time in microseconds
+    double value = 0.0;
+};
+
+/**
+ * @brief Store of live data channels shared between acquisition and display
+ *
+ * Each channel keeps its recent samples in a fixed ring. Publishing is
+ * wait-free and never allocates; readers take consistent copies through
+ * per-slot sequence stamps and never block the writer. Each channel must
+ * have a single publishing thread at a time. Channels are added up front
+ * and live as long as the store.
+ */
+class FMUS_AUTO_API LiveDataStore {
+public:
+    using ChannelId = uint32_t;
+    static constexpr ChannelId INVALID_CHANNEL = 0xFFFFFFFF;
+
+    /**
+     * @brief Store statistics
+     */
+    struct Statistics {
+        uint64_t samplesPublished = 0;
+        uint64_t samplesOverwritten = 0;    ///< History readers fell behind the ring
+        uint64_t readRetries = 0;
+        uint32_t channels = 0;
+    };
+
+    /**
+     * @brief Constructor
+     * @param historyCapacity Samples kept per channel, rounded up to a power of two
+     * @param maxChannels Upper bound on channels
+     */
+    explicit LiveDataStore(size_t historyCapacity = 4096, size_t maxChannels = 1024);
+    ~LiveDataStore();
+
+    LiveDataStore(const LiveDataStore&) = delete;
+    LiveDataStore& operator=(const LiveDataStore&) = delete;
+
+    /**
+     * @brief Add a channel, or return the existing one with that name
+     * @return INVALID_CHANNEL when maxChannels is reached
+     */
+    ChannelId addChannel(const std::string& name, const std::string& unit = "");
+
+    /**
+     * @brief Find a channel by name
+     */
+    ChannelId findChannel(const std::string& name) const;
+
+    size_t getChannelCount() const;
+    std::string getChannelName(ChannelId id) const;
+    std::string getChannelUnit(ChannelId id) const;
+    size_t getHistoryCapacity() const;
+
+    /**
+     * @brief Publish a sample timestamped now
+     */
+    void publish(ChannelId id, double value);
+
+    /**
+     * @brief Publish a sample
+     */
+    void publish(ChannelId id, double value, int64_t timestampUs);
+
+    /**
+     * @brief Publish by name; looks up the channel, prefer the ChannelId overload
+     */
+    bool publish(const std::string& name, double value);
+
+    /**
+     * @brief Number of samples ever published on a channel
+     *
+     * Cheap enough to poll each frame to skip unchanged channels.
+     */
+    uint64_t getSequence(ChannelId id) const;
+
+    /**
+     * @brief Read the most recent sample
+     * @param sequence Receives the sequence the sample brought the channel to
+     * @return False if nothing was published yet
+     */
+    bool readLatest(ChannelId id, LiveSample& sample, uint64_t* sequence = nullptr) const;
+
+    /**
+     * @brief Append samples published since fromSequence
+     *
+     * Starts at the oldest sample still in the ring if the reader fell
+     * behind.
+     * @return Sequence to pass on the next call
+     */
+    uint64_t readHistory(ChannelId id, uint64_t fromSequence, std::vector<LiveSample>& samples) const;
+
+    /**
+     * @brief Current time in the store's timestamp base
+     */
+    static int64_t now();
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+    std::string toString() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace fmus
+
+#endif // FMUS_LIVE_DATA_STORE_H
@@ -0,0 +1,259 @@
+#ifndef FMUS_PLUGINS_EVENT_BUS_H
+#define FMUS_PLUGINS_EVENT_BUS_H
+
+/**
+ * @file event_bus.h
+ * @brief Typed asynchronous event bus for plugins
+ */
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <map>
+#include <array>
+#include <variant>
+#include <chrono>
+#include <functional>
+#include <type_traits>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace plugins {
+
+/**
+ * @brief Interned event identifier
+ */
+using EventId = uint32_t;
+
+/**
+ * @brief Subscription handle returned by EventBus::subscribe
+ */
+using SubscriptionId = uint64_t;
+
+constexpr EventId INVALID_EVENT_ID = 0;
+constexpr SubscriptionId INVALID_SUBSCRIPTION_ID = 0;
+
+/**
+ * @brief Bus frame observed on a diagnostic channel
+ */
+struct FrameEvent {
+    uint32_t id = 0;                    ///< Arbitration / header ID
+    uint8_t length = 0;                 ///< Number of valid bytes in data
+    std::array<uint8_t, 64> data{};     ///< Payload (sized for CAN FD)
+    bool extended = false;              ///< 29-bit identifier
+    bool transmitted = false;           ///< Sent by us rather than received
+    uint32_t channel = 0;               ///< Source channel index
+    std::chrono::steady_clock::time_point timestamp;
+};
+
+/**
+ * @brief DTC status change reported by an ECU
+ */
+struct DTCEvent {
+    std::string ecuName;
+    std::string code;
+    std::string description;
+    uint8_t status = 0;
+    bool cleared = false;
+    std::chrono::system_clock::time_point timestamp;
+};
+
+/**
+ * @brief Single live-data parameter sample
+ */
+struct ParameterSample {
+    std::string name;
+    double value = 0.0;
+    std::string unit;
+    std::chrono::steady_clock::time_point timestamp;
+};
+
+/**
+ * @brief String key/value payload used by PluginManager::triggerEvent
+ */
+struct LegacyEvent {
+    std::map<std::string, std::string> data;
+};
+
+/**
+ * @brief Event payload variants
+ */
+using EventPayload = std::variant<FrameEvent, DTCEvent, ParameterSample, LegacyEvent>;
+
+/**
+ * @brief Event as delivered to subscribers
+ *
+ * The payload is shared by every subscriber; handlers must treat it as read-only.
+ */
+struct Event {
+    EventId id = INVALID_EVENT_ID;
+    std::chrono::steady_clock::time_point published;
+    std::shared_ptr<const EventPayload> payload;
+
+    template<typename T>
+    const T* get() const { return payload ? std::get_if<T>(payload.get()) : nullptr; }
+};
+
+/**
+ * @brief Event handler callback, invoked on the subscriber's delivery thread
+ */
+using EventHandler = std::function<void(const Event&)>;
+
+/**
+ * @brief Typed asynchronous event bus
+ *
+ * Event names are interned into integer IDs once, at registration. Each
+ * subscriber owns a bounded lock-free queue drained by its own delivery
+ * thread, so publish() never waits on a handler: when a subscriber's queue
+ * is full the event is dropped for that subscriber and counted.
+ */
+class FMUS_AUTO_API EventBus {
+public:
+    /**
+     * @brief Per-subscriber delivery statistics
+     */
+    struct SubscriberStatistics {
+        SubscriptionId subscription = INVALID_SUBSCRIPTION_ID;
+        std::string subscriber;
+        EventId eventId = INVALID_EVENT_ID;
+        uint64_t delivered = 0;
+        uint64_t dropped = 0;
+        uint64_t handlerErrors = 0;
+        size_t queued = 0;
+        size_t queueCapacity = 0;
+        std::chrono::microseconds averageLatency{0};    ///< Publish to handler start
+        std::chrono::microseconds maxLatency{0};
+        std::chrono::microseconds averageHandlerTime{0};
+        std::chrono::microseconds maxHandlerTime{0};
+
+        std::string toString() const;
+    };
+
+    /**
+     * @brief Bus statistics
+     */
+    struct Statistics {
+        uint64_t eventsPublished = 0;
+        uint64_t eventsQueued = 0;
+        uint64_t eventsDropped = 0;
+        uint64_t eventsWithoutSubscribers = 0;
+        std::chrono::system_clock::time_point startTime;
+    };
+
+    /**
+     * @brief Constructor
+     */
+    EventBus();
+
+    /**
+     * @brief Destructor, stops all delivery threads
+     */
+    ~EventBus();
+
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+    /**
+     * @brief Intern an event name, returning the existing ID if already registered
+     */
+    EventId registerEvent(const std::string& name);
+
+    /**
+     * @brief Look up an event ID without registering it
+     * @return INVALID_EVENT_ID if unknown
+     */
+    EventId findEvent(const std::string& name) const;
+
+    /**
+     * @brief Get the name of an event ID
+     */
+    std::string getEventName(EventId id) const;
+
+    /**
+     * @brief Subscribe to an event
+     * @param id Event to receive
+     * @param subscriber Name used in statistics (typically the plugin name)
+     * @param handler Callback, run on a dedicated delivery thread
+     * @param queueCapacity Maximum queued events before dropping (rounded up to a power of two)
+     */
+    SubscriptionId subscribe(EventId id, const std::string& subscriber, EventHandler handler,
+                             size_t queueCapacity = 1024);
+
+    /**
+     * @brief Remove a subscription; events still queued for it are discarded
+     */
+    bool unsubscribe(SubscriptionId subscription);
+
+    /**
+     * @brief Remove every subscription owned by a subscriber name
+     */
+    size_t unsubscribeAll(const std::string& subscriber);
+
+    /**
+     * @brief Publish an event without blocking
+     * @return Number of subscribers the event was queued for
+     */
+    size_t publish(EventId id, std::shared_ptr<const EventPayload> payload);
+
+    /**
+     * @brief Publish a payload value
+     *
+     * Only participates for payload alternatives, so shared pointers always
+     * take the overload above.
+     */
+    template<typename T,
+             typename = std::enable_if_t<std::is_constructible<EventPayload, T&&>::value>>
+    size_t publish(EventId id, T&& payload) {
+        return publish(id, std::make_shared<const EventPayload>(std::forward<T>(payload)));
+    }
+
+    /**
+     * @brief Check whether an event has any subscribers
+     *
+     * Lets hot paths skip building a payload nobody will receive.
+     */
+    bool hasSubscribers(EventId id) const;
+
+    /**
+     * @brief Wait until all queues are drained or the timeout expires
+     */
+    bool flush(std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+
+    /**
+     * @brief Stop all delivery threads and remove all subscriptions
+     */
+    void shutdown();
+
+    /**
+     * @brief Get per-subscriber statistics
+     */
+    std::vector<SubscriberStatistics> getSubscriberStatistics() const;
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+/**
+ * @brief Get global event bus instance
+ */
+FMUS_AUTO_API std::shared_ptr<EventBus> getGlobalEventBus();
+
+} // namespace plugins
+} // namespace fmus
+
+#endif // FMUS_PLUGINS_EVENT_BUS_H
@@ -0,0 +1,339 @@
+#ifndef FMUS_PLUGINS_EXTENSION_POINTS_H
+#define FMUS_PLUGINS_EXTENSION_POINTS_H
+
+/**
+ * @file extension_points.h
+ * @brief Typed fast-path extension points for decoders, key algorithms and transports
+ */
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace plugins {
+
+/**
+ * @brief Handle identifying one registration
+ */
+using ExtensionHandle = uint64_t;
+
+/**
+ * @brief Mask matching a frame ID exactly
+ */
+constexpr uint32_t FRAME_ID_EXACT = 0xFFFFFFFF;
+
+/**
+ * @brief One value produced by a decoder
+ *
+ * name and unit must point to storage that outlives the registration,
+ * typically string literals in the plugin.
+ */
+struct DecodedValue {
+    const char* name = nullptr;
+    double value = 0.0;
+    const char* unit = nullptr;
+};
+
+/**
+ * @brief Decoder for frames, data identifiers and PIDs
+ *
+ * Writes up to capacity values to out and returns how many were written.
+ * Called on the receiving thread; must not block.
+ */
+using DecodeFunction = size_t (*)(void* context, uint32_t id, const uint8_t* data, size_t length,
+                                  DecodedValue* out, size_t capacity);
+
+/**
+ * @brief Security access key algorithm
+ *
+ * keyLength holds the key buffer capacity on entry and the key length on
+ * return. Returns false if the seed cannot be handled.
+ */
+using SecurityKeyFunction = bool (*)(void* context, uint8_t level, const uint8_t* seed, size_t seedLength,
+                                     uint8_t* key, size_t* keyLength);
+
+/**
+ * @brief Frame exchanged with a transport backend
+ */
+struct TransportFrame {
+    uint32_t id = 0;
+    uint8_t length = 0;
+    uint8_t flags = 0;                  ///< TRANSPORT_FRAME_* bits
+    uint8_t channel = 0;
+    std::array<uint8_t, 64> data{};
+    uint64_t timestampUs = 0;           ///< Backend timestamp in microseconds
+};
+
+constexpr uint8_t TRANSPORT_FRAME_EXTENDED = 0x01;
+constexpr uint8_t TRANSPORT_FRAME_FD = 0x02;
+constexpr uint8_t TRANSPORT_FRAME_RTR = 0x04;
+constexpr uint8_t TRANSPORT_FRAME_ERROR = 0x08;
+
+/**
+ * @brief Transport backend provided by a plugin
+ *
+ * Frames are moved in caller-owned batches so one virtual call covers many
+ * frames. Instances must be destroyed before their plugin is unloaded.
+ */
+class FMUS_AUTO_API ITransportBackend {
+public:
+    virtual ~ITransportBackend() = default;
+
+    virtual bool open(const std::map<std::string, std::string>& options) = 0;
+    virtual void close() = 0;
+    virtual bool isOpen() const = 0;
+
+    /**
+     * @brief Queue frames for transmission, returns the number accepted
+     */
+    virtual size_t write(const TransportFrame* frames, size_t count) = 0;
+
+    /**
+     * @brief Read up to capacity frames, waiting at most timeout for the first
+     */
+    virtual size_t read(TransportFrame* frames, size_t capacity, std::chrono::milliseconds timeout) = 0;
+};
+
+/**
+ * @brief Transport backend factory, the caller owns the returned instance
+ */
+using TransportBackendFactory = ITransportBackend* (*)(void* context);
+
+/**
+ * @brief Compiled dispatch tables
+ *
+ * Immutable snapshot built from the registrations. Exact frame IDs, DIDs and
+ * algorithm names resolve through hash lookups and PIDs through a direct
+ * 256-entry table; masked frame decoders are scanned in priority order after
+ * the exact ones. Holding a snapshot keeps it valid across re-registration.
+ */
+class FMUS_AUTO_API ExtensionTables {
+public:
+    struct Slot {
+        DecodeFunction function = nullptr;
+        void* context = nullptr;
+    };
+
+    struct MaskedSlot {
+        uint32_t id = 0;                ///< Already masked
+        uint32_t mask = 0;
+        Slot slot;
+    };
+
+    struct KeySlot {
+        SecurityKeyFunction function = nullptr;
+        void* context = nullptr;
+    };
+
+    struct BackendSlot {
+        TransportBackendFactory factory = nullptr;
+        void* context = nullptr;
+    };
+
+    /**
+     * @brief Run every decoder matching a frame ID
+     * @return Number of values written
+     */
+    size_t decodeFrame(uint32_t id, const uint8_t* data, size_t length,
+                       DecodedValue* out, size_t capacity) const;
+
+    /**
+     * @brief Decode a data identifier record
+     * @return Number of values written, 0 if no decoder is registered
+     */
+    size_t decodeDataIdentifier(uint16_t did, const uint8_t* data, size_t length,
+                                DecodedValue* out, size_t capacity) const;
+
+    /**
+     * @brief Decode a mode 01 PID response
+     * @return Number of values written, 0 if no decoder is registered
+     */
+    size_t decodePID(uint8_t pid, const uint8_t* data, size_t length,
+                     DecodedValue* out, size_t capacity) const;
+
+    bool hasFrameDecoder(uint32_t id) const;
+    bool hasDataIdentifierDecoder(uint16_t did) const;
+    bool hasPIDDecoder(uint8_t pid) const { return pidSlots[pid].function != nullptr; }
+
+    /**
+     * @brief Compute a security access key
+     * @return False if the algorithm is unknown or rejects the seed
+     */
+    bool computeKey(const std::string& algorithm, uint8_t level, const std::vector<uint8_t>& seed,
+                    std::vector<uint8_t>& key) const;
+
+    const KeySlot* findSecurityAlgorithm(const std::string& algorithm) const;
+    const BackendSlot* findTransportBackend(const std::string& name) const;
+
+    /**
+     * @brief Registry version this snapshot was compiled from
+     */
+    uint64_t getVersion() const { return version; }
+
+private:
+    friend class ExtensionRegistry;
+
+    uint64_t version = 0;
+    std::unordered_map<uint32_t, std::pair<uint32_t, uint32_t>> exactFrames; ///< ID -> [begin, end) in frameSlots
+    std::vector<Slot> frameSlots;
+    std::vector<MaskedSlot> maskedFrames;
+    std::unordered_map<uint16_t, Slot> didSlots;
+    std::array<Slot, 256> pidSlots{};
+    std::unordered_map<std::string, KeySlot> keySlots;
+    std::unordered_map<std::string, BackendSlot> backendSlots;
+    std::vector<std::shared_ptr<const void>> keepAlive;  ///< Owners' libraries stay loaded while referenced
+};
+
+class ExtensionRegistry;
+
+/**
+ * @brief Optional interface for plugins contributing extension points
+ *
+ * Implemented next to IPlugin. The plugin manager registers providers after
+ * initialize() and removes every registration under the plugin's name
+ * before shutdown().
+ */
+class FMUS_AUTO_API IExtensionProvider {
+public:
+    virtual ~IExtensionProvider() = default;
+
+    virtual void registerExtensions(ExtensionRegistry& registry, const std::string& owner) = 0;
+};
+
+/**
+ * @brief Registry of typed plugin extension points
+ *
+ * Registration is cheap and only marks the tables stale; they are compiled
+ * once on the next getTables(), so a plugin registering many decoders pays
+ * for one rebuild. The hot path is a single atomic snapshot load followed by
+ * direct calls through function pointers.
+ *
+ * For DIDs, PIDs, algorithms and backends the highest priority registration
+ * wins, the most recent one on ties. All frame decoders matching an ID run.
+ */
+class FMUS_AUTO_API ExtensionRegistry {
+public:
+    /**
+     * @brief Registry statistics
+     */
+    struct Statistics {
+        uint64_t registrations = 0;
+        uint64_t unregistrations = 0;
+        uint64_t rebuilds = 0;
+        std::chrono::microseconds lastRebuildDuration{0};
+        std::chrono::system_clock::time_point startTime;
+    };
+
+    ExtensionRegistry();
+    ~ExtensionRegistry();
+
+    ExtensionRegistry(const ExtensionRegistry&) = delete;
+    ExtensionRegistry& operator=(const ExtensionRegistry&) = delete;
+
+    /**
+     * @brief Register a frame decoder for IDs where (frameId & mask) == (id & mask)
+     */
+    ExtensionHandle registerFrameDecoder(const std::string& owner, uint32_t id, uint32_t mask,
+                                         DecodeFunction function, void* context = nullptr,
+                                         int priority = 0);
+
+    ExtensionHandle registerDataIdentifierDecoder(const std::string& owner, uint16_t did,
+                                                  DecodeFunction function, void* context = nullptr,
+                                                  int priority = 0);
+
+    ExtensionHandle registerPIDDecoder(const std::string& owner, uint8_t pid,
+                                       DecodeFunction function, void* context = nullptr,
+                                       int priority = 0);
+
+    ExtensionHandle registerSecurityAlgorithm(const std::string& owner, const std::string& name,
+                                              SecurityKeyFunction function, void* context = nullptr,
+                                              int priority = 0);
+
+    ExtensionHandle registerTransportBackend(const std::string& owner, const std::string& name,
+                                             TransportBackendFactory factory, void* context = nullptr,
+                                             int priority = 0);
+
+    /**
+     * @brief Let a provider register its extensions under owner
+     *
+     * keepAlive (usually the plugin instance, which holds its library) is
+     * referenced by every snapshot compiled while the owner has
+     * registrations, so a snapshot still in use after unregisterOwner()
+     * never calls into an unloaded library.
+     * @return Number of registrations added
+     */
+    size_t registerProvider(IExtensionProvider& provider, const std::string& owner,
+                            std::shared_ptr<const void> keepAlive = nullptr);
+
+    /**
+     * @brief Remove one registration
+     */
+    bool unregister(ExtensionHandle handle);
+
+    /**
+     * @brief Remove every registration made by an owner
+     * @return Number of registrations removed
+     */
+    size_t unregisterOwner(const std::string& owner);
+
+    /**
+     * @brief Get the current dispatch tables, compiling them if stale
+     */
+    std::shared_ptr<const ExtensionTables> getTables() const;
+
+    /**
+     * @brief Version incremented on every change
+     *
+     * Lets callers that cache a snapshot check it without loading a new one.
+     */
+    uint64_t getVersion() const;
+
+    /**
+     * @brief Create a transport backend by name
+     *
+     * The backend holds the snapshot it came from, so the owning plugin's
+     * library stays loaded until the last reference is gone.
+     * @return nullptr if no backend is registered under that name
+     */
+    std::shared_ptr<ITransportBackend> createTransportBackend(const std::string& name) const;
+
+    std::vector<std::string> getSecurityAlgorithms() const;
+    std::vector<std::string> getTransportBackends() const;
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+    std::string toString() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+/**
+ * @brief Get the process-wide extension registry
+ */
+FMUS_AUTO_API std::shared_ptr<ExtensionRegistry> getGlobalExtensionRegistry();
+
+} // namespace plugins
+} // namespace fmus
+
+#endif // FMUS_PLUGINS_EXTENSION_POINTS_H
@@ -0,0 +1,181 @@
+#ifndef FMUS_PLUGINS_PLUGIN_HOST_H
+#define FMUS_PLUGINS_PLUGIN_HOST_H
+
+/**
+ * @file plugin_host.h
+ * @brief Out-of-process plugin hosting over shared-memory rings
+ */
+
+#include <fmus/plugins/plugin_manager.h>
+#include <fmus/plugins/event_bus.h>
+#include <string>
+#include <memory>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace plugins {
+
+/**
+ * @brief Plugin host configuration
+ */
+struct PluginHostConfig {
+    std::string libraryPath;                        ///< Plugin library loaded by the child
+    std::string hostExecutable = "fmus_plugin_host"; ///< Child executable; required, the child always execs
+    size_t ringBytes = 1 << 20;                     ///< Capacity of each direction's ring
+    std::vector<std::string> forwardedEvents;       ///< Bus events delivered to the plugin
+    std::vector<std::string> exportedEvents;        ///< Plugin events republished on our bus
+    std::chrono::milliseconds commandTimeout{5000};
+    std::chrono::milliseconds heartbeatInterval{200};
+    std::chrono::milliseconds heartbeatTimeout{2000};
+    uint32_t maxRestarts = 5;                       ///< Consecutive restarts before giving up
+    std::chrono::milliseconds restartBackoff{100};  ///< Doubled after each consecutive restart
+
+    std::string toString() const;
+};
+
+/**
+ * @brief Runs one plugin in a child process
+ *
+ * The parent and child share one memory segment holding two single-producer
+ * single-consumer byte rings, one per direction, each paired with an eventfd
+ * that is only signalled when the consumer is asleep. Messages are built
+ * directly in ring memory and decoded in place on the other side.
+ *
+ * Events named in forwardedEvents are taken from the parent's event bus and
+ * republished on the child's global bus, where the plugin subscribes as it
+ * would in-process; exportedEvents travel the other way. If the child exits
+ * or stops sending heartbeats, pending commands fail and it is restarted
+ * with exponential backoff.
+ *
+ * Only available on Linux; start() fails elsewhere.
+ */
+class FMUS_AUTO_API PluginHost {
+public:
+    /**
+     * @brief Host statistics
+     */
+    struct Statistics {
+        uint64_t commandsSent = 0;
+        uint64_t commandsFailed = 0;
+        uint64_t eventsForwarded = 0;
+        uint64_t eventsDropped = 0;
+        uint64_t eventsReceived = 0;
+        uint32_t restarts = 0;
+        uint32_t crashes = 0;
+        std::chrono::system_clock::time_point startTime;
+    };
+
+    /**
+     * @brief Constructor
+     */
+    explicit PluginHost(const PluginHostConfig& config,
+                        std::shared_ptr<EventBus> eventBus = getGlobalEventBus());
+
+    /**
+     * @brief Destructor, stops the child process
+     */
+    ~PluginHost();
+
+    PluginHost(const PluginHost&) = delete;
+    PluginHost& operator=(const PluginHost&) = delete;
+
+    /**
+     * @brief Start the child process and wait until the plugin is ready
+     */
+    bool start();
+
+    /**
+     * @brief Stop the child process
+     */
+    void stop();
+
+    /**
+     * @brief Check if the child process is running
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Plugin information reported by the child
+     */
+    PluginInfo getInfo() const;
+
+    /**
+     * @brief Plugin capabilities reported by the child
+     */
+    std::vector<std::string> getCapabilities() const;
+
+    /**
+     * @brief Execute a plugin command in the child
+     * @throws PluginError if the child is unavailable or the command times out
+     */
+    std::string executeCommand(const std::string& command,
+                               const std::map<std::string, std::string>& parameters);
+
+    /**
+     * @brief Get last error message
+     */
+    std::string getLastError() const;
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+/**
+ * @brief IPlugin adapter for a plugin running in a PluginHost
+ *
+ * Used by PluginManager for manifests declaring `isolated=true`. The Auto
+ * instance cannot cross the process boundary, so the child plugin is
+ * initialized with a null instance.
+ */
+class FMUS_AUTO_API RemotePlugin : public IPlugin {
+public:
+    RemotePlugin(const PluginInfo& info, const PluginHostConfig& config);
+    ~RemotePlugin() override;
+
+    PluginInfo getInfo() const override;
+    bool initialize(std::shared_ptr<Auto> autoInstance) override;
+    void shutdown() override;
+    bool isInitialized() const override;
+    std::string executeCommand(const std::string& command,
+                               const std::map<std::string, std::string>& parameters) override;
+    std::vector<std::string> getCapabilities() const override;
+
+    /**
+     * @brief Get the underlying host
+     */
+    PluginHost& getHost();
+
+private:
+    PluginInfo info;
+    std::unique_ptr<PluginHost> host;
+};
+
+/**
+ * @brief Entry point of the plugin host child process
+ *
+ * A host executable only needs `return fmus::plugins::runPluginHost(argc, argv);`.
+ */
+FMUS_AUTO_API int runPluginHost(int argc, char* argv[]);
+
+} // namespace plugins
+} // namespace fmus
+
+#endif // FMUS_PLUGINS_PLUGIN_HOST_H
@@ -7,11 +7,15 @@
  */
 
 #include <fmus/auto.h>
+#include <fmus/plugins/event_bus.h>
 #include <string>
 #include <memory>
 #include <vector>
 #include <map>
+#include <chrono>
 #include <functional>
+#include <stdexcept>
+#include <cstdint>
 
 // Define exports macro
 #ifdef _WIN32
@@ -32,6 +36,11 @@ namespace plugins {
  */
 constexpr int PLUGIN_INTERFACE_VERSION = 1;
 
+/**
+ * @brief File extension of plugin manifests
+ */
+constexpr const char* PLUGIN_MANIFEST_EXTENSION = ".plugin";
+
 /**
  * @brief Plugin types
  */
@@ -159,6 +168,31 @@ struct PluginLoadResult {
     std::string toString() const;
 };
 
+/**
+ * @brief Plugin manifest
+ *
+ * Sidecar `<name>.plugin` file describing a plugin library, so it can be
+ * discovered and scheduled without loading its code. Format is one
+ * `key=value` per line: name, description, version, author, website, type,
+ * interfaceVersion, library (relative to the manifest), dependencies and
+ * capabilities (comma separated), lazy (true/false) and `metadata.<key>`.
+ * `isolated=true` runs the plugin in a child process (see PluginHost), with
+ * forwardEvents/exportEvents naming the bus events that cross the boundary.
+ */
+struct PluginManifest {
+    PluginInfo info;
+    std::string manifestPath;
+    std::string libraryPath;
+    std::vector<std::string> capabilities;
+    bool lazy = true;               ///< Defer loading until a capability or the plugin is requested
+    bool isolated = false;          ///< Host the plugin out of process
+    std::vector<std::string> forwardedEvents;
+    std::vector<std::string> exportedEvents;
+
+    bool isValid() const { return !info.name.empty() && !libraryPath.empty(); }
+    std::string toString() const;
+};
+
 /**
  * @brief Plugin Manager
  */
@@ -191,8 +225,45 @@ public:
     
     /**
      * @brief Load plugins from directory
+     *
+     * Plugins with a manifest are registered without loading their code;
+     * eager ones (and their dependencies) are loaded in parallel and then
+     * initialized level by level in dependency order. Lazy plugins are loaded
+     * on first use. Libraries without a manifest are loaded eagerly.
      */
     std::vector<PluginLoadResult> loadPluginsFromDirectory(const std::string& directory);
+
+    /**
+     * @brief Read manifests in a directory without loading any plugin code
+     */
+    std::vector<PluginManifest> discoverPlugins(const std::string& directory) const;
+
+    /**
+     * @brief Get a plugin providing a capability, loading it if deferred
+     */
+    std::shared_ptr<IPlugin> getPluginForCapability(const std::string& capability);
+
+    /**
+     * @brief Execute a plugin command, loading the plugin if deferred
+     *
+     * Commands are tracked so a reload waits for in-flight commands to finish.
+     */
+    std::string executeCommand(const std::string& pluginName, const std::string& command,
+                               const std::map<std::string, std::string>& parameters);
+
+    /**
+     * @brief Reload a plugin from its library file
+     *
+     * New commands wait while in-flight ones drain, then the old instance is
+     * shut down and replaced by a freshly loaded and initialized one.
+     */
+    bool reloadPlugin(const std::string& pluginName);
+
+    /**
+     * @brief Enable or disable reloading plugins when their library file changes
+     */
+    void setHotReloadEnabled(bool enabled,
+                             std::chrono::milliseconds pollInterval = std::chrono::milliseconds(500));
     
     /**
      * @brief Get loaded plugins
@@ -227,8 +298,15 @@ public:
     
     /**
      * @brief Trigger plugin event
+     *
+     * Published on the event bus as a LegacyEvent; handlers run asynchronously.
      */
     void triggerEvent(const std::string& event, const std::map<std::string, std::string>& data);
+
+    /**
+     * @brief Get the event bus shared with plugins
+     */
+    std::shared_ptr<EventBus> getEventBus() const;
     
     /**
      * @brief Get plugin statistics
@@ -236,8 +314,11 @@ public:
     struct Statistics {
         uint32_t pluginsLoaded = 0;
         uint32_t pluginsFailed = 0;
+        uint32_t pluginsDeferred = 0;
+        uint32_t pluginsReloaded = 0;
         uint32_t commandsExecuted = 0;
         uint32_t eventsTriggered = 0;
+        std::chrono::milliseconds lastLoadDuration{0};
         std::chrono::system_clock::time_point startTime;
     };
     
@@ -245,8 +326,8 @@ public:
     void resetStatistics();
 
 private:
-    PluginManager() = default;
-    ~PluginManager() = default;
+    PluginManager();
+    ~PluginManager();
     
     class Impl;
     std::unique_ptr<Impl> pImpl;
@@ -345,6 +426,14 @@ FMUS_AUTO_API std::string pluginTypeToString(PluginType type);
 FMUS_AUTO_API PluginType stringToPluginType(const std::string& str);
 FMUS_AUTO_API bool isValidPluginFile(const std::string& filePath);
 FMUS_AUTO_API std::string getPluginDirectory();
+FMUS_AUTO_API PluginManifest loadPluginManifest(const std::string& manifestPath);
+
+/**
+ * @brief Create a plugin instance from a library exporting createPlugin
+ *
+ * The returned instance keeps the library loaded until it is destroyed.
+ */
+FMUS_AUTO_API std::shared_ptr<IPlugin> createPluginFromLibrary(const std::string& libraryPath, std::string& error);
 
 } // namespace plugins
 } // namespace fmus
@@ -0,0 +1,158 @@
+#ifndef FMUS_PROTOCOLS_BUS_STATISTICS_H
+#define FMUS_PROTOCOLS_BUS_STATISTICS_H
+
+/**
+ * @file bus_statistics.h
+ * @brief Bus load and per-ID traffic statistics
+ */
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace protocols {
+
+struct CANMessage;
+
+/**
+ * @brief How stuff bits are counted when estimating frame length
+ */
+enum class StuffingModel {
+    NONE,
+    EXACT,              ///< Stuff the actual header, payload and CRC bits
+    WORST_CASE          ///< One stuff bit per four stuffable bits
+};
+
+/**
+ * @brief Bits a frame occupies on the bus
+ */
+struct CANFrameBits {
+    uint32_t nominalBits = 0;       ///< At the nominal (arbitration) rate, including interframe space
+    uint32_t dataBits = 0;          ///< At the data rate; CAN FD frames with bit rate switch only
+    uint32_t stuffBits = 0;         ///< Included in the counts above
+};
+
+/**
+ * @brief Statistics configuration
+ */
+struct BusStatisticsConfig {
+    uint32_t baudRate = 500000;
+    uint32_t dataBaudRate = 2000000;            ///< CAN FD data phase, used with bit rate switch
+    StuffingModel stuffing = StuffingModel::EXACT;
+    size_t idCapacity = 2048;                   ///< Distinct IDs tracked, rounded up to a power of two
+    double periodWeight = 1.0 / 16;             ///< EWMA weight of each new inter-arrival time
+    double overloadThreshold = 80.0;            ///< Load (%) reported as overloaded
+
+    std::string toString() const;
+};
+
+/**
+ * @brief Traffic of one identifier
+ */
+struct CANIdStatistics {
+    uint32_t id = 0;
+    bool extended = false;
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    double period = 0.0;                        ///< EWMA of the inter-arrival time (ms)
+    double jitter = 0.0;                        ///< EWMA of |inter-arrival - period| (ms)
+    double loadShare = 0.0;                     ///< Share of the bus time used by all frames (%)
+    std::chrono::system_clock::time_point lastSeen;
+
+    std::string toString() const;
+};
+
+/**
+ * @brief Bus load at one point in time
+ */
+struct BusLoadSnapshot {
+    double load = 0.0;                          ///< Since the previous snapshot (%)
+    double averageLoad = 0.0;                   ///< Since start or reset (%)
+    double peakLoad = 0.0;                      ///< Highest load of any snapshot interval (%)
+    double framesPerSecond = 0.0;               ///< Since the previous snapshot
+    uint64_t frames = 0;
+    uint64_t errorFrames = 0;
+    uint64_t untrackedFrames = 0;               ///< Counted in the load but the ID table was full
+    std::chrono::milliseconds interval{0};
+    bool overloaded = false;
+
+    std::string toString() const;
+};
+
+/**
+ * @brief Lock-free per-ID counters and bus load
+ *
+ * IDs live in a fixed open-addressing table claimed with compare-and-swap,
+ * so record() never locks or allocates and may run on several dispatch
+ * threads at once. Each frame's bus time comes from its bit length at the
+ * configured rates, stuff bits included. Period and jitter are
+ * exponentially weighted from frame timestamps; under concurrent
+ * recording of the same ID an occasional sample may be lost.
+ */
+class FMUS_AUTO_API BusStatistics {
+public:
+    explicit BusStatistics(const BusStatisticsConfig& config = BusStatisticsConfig());
+    ~BusStatistics();
+
+    BusStatistics(const BusStatistics&) = delete;
+    BusStatistics& operator=(const BusStatistics&) = delete;
+
+    /**
+     * @brief Change bit rates and stuffing model; the ID table is kept
+     */
+    void setBitRates(uint32_t baudRate, uint32_t dataBaudRate);
+    void setStuffingModel(StuffingModel stuffing);
+
+    void record(const CANMessage& message);
+    void recordErrorFrames(uint64_t count);
+
+    /**
+     * @brief Take a load snapshot; the interval runs from the previous call
+     */
+    BusLoadSnapshot snapshot();
+
+    /**
+     * @brief Every ID seen, ordered by ID
+     */
+    std::vector<CANIdStatistics> getIdStatistics() const;
+    bool getIdStatistics(uint32_t id, bool extended, CANIdStatistics& statistics) const;
+
+    /**
+     * @brief Zero all counters; IDs stay in the table
+     */
+    void reset();
+
+    std::string toString() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+// Utility functions
+
+/**
+ * @brief Bus bits of a frame (ISO 11898-1 field layout)
+ */
+FMUS_AUTO_API CANFrameBits canFrameBits(const CANMessage& message, StuffingModel stuffing = StuffingModel::EXACT);
+
+FMUS_AUTO_API std::string stuffingModelToString(StuffingModel stuffing);
+
+} // namespace protocols
+} // namespace fmus
+
+#endif // FMUS_PROTOCOLS_BUS_STATISTICS_H
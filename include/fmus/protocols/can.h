@@ -7,10 +7,12 @@
  */
 
 #include <fmus/j2534.h>
+#include <fmus/protocols/bus_statistics.h>
 #include <vector>
 #include <memory>
 #include <functional>
 #include <chrono>
+#include <cstddef>
 
 // Define exports macro for cross-platform compatibility
 #ifdef _WIN32
@@ -24,6 +26,9 @@
 #endif
 
 namespace fmus {
+
+class LiveDataStore;
+
 namespace protocols {
 
 /**
@@ -41,9 +46,12 @@ enum class CANFrameType {
  */
 struct CANMessage {
     uint32_t id = 0;                    ///< CAN identifier
-    std::vector<uint8_t> data;          ///< Data payload (0-8 bytes for CAN 2.0)
+    std::vector<uint8_t> data;          ///< Data payload (0-8 bytes for CAN 2.0, up to 64 for CAN FD)
     bool extended = false;              ///< Extended frame format (29-bit ID)
     bool rtr = false;                   ///< Remote transmission request
+    bool fd = false;                    ///< CAN FD frame format
+    bool brs = false;                   ///< CAN FD bit rate switch for the data phase
+    bool esi = false;                   ///< CAN FD error state indicator (received frames)
     CANFrameType frameType = CANFrameType::DATA;
     std::chrono::system_clock::time_point timestamp;
     
@@ -53,6 +61,8 @@ struct CANMessage {
     
     /**
      * @brief Check if this is a valid CAN message
+     *
+     * CAN FD payloads must have a length a DLC can express (see canFdLength).
      */
     bool isValid() const;
     
@@ -76,12 +86,18 @@ struct CANMessage {
  * @brief CAN bus configuration
  */
 struct CANConfig {
-    uint32_t baudRate = 500000;         ///< Baud rate in bps
+    uint32_t baudRate = 500000;         ///< Baud rate in bps; the nominal (arbitration) rate for CAN FD
+    bool fd = false;                    ///< Allow CAN FD frames
+    uint32_t dataBaudRate = 2000000;    ///< CAN FD data phase rate in bps, used with bit rate switch
     bool listenOnly = false;            ///< Listen-only mode
     bool loopback = false;              ///< Loopback mode
     bool extendedFrames = true;         ///< Support extended frames
     uint32_t txTimeout = 1000;          ///< Transmission timeout in ms
     uint32_t rxTimeout = 1000;          ///< Reception timeout in ms
+    j2534::Backend backend = j2534::Backend::J2534;
+    std::string interfaceName = "can0"; ///< SocketCAN interface (bit rates are set on the link) or plugin backend name
+    bool hardwareTimestamps = true;     ///< Prefer adapter timestamps to kernel receive time (SocketCAN)
+    uint32_t rxBatchSize = 32;          ///< Frames read per system call (SocketCAN)
     
     std::string toString() const;
 };
@@ -159,6 +175,10 @@ public:
     
     /**
      * @brief Add a message filter
+     *
+     * With SocketCAN the filters are also installed in the kernel, so
+     * frames they block are not counted by getBusLoad() or
+     * getIdStatistics().
      */
     bool addFilter(const CANFilter& filter);
     
@@ -192,6 +212,41 @@ public:
      */
     bool isMonitoring() const;
     
+    /**
+     * @brief Add a receive listener next to the monitoring callback
+     *
+     * Every received message that passes the filters goes to the monitoring
+     * callback and to all listeners, so several clients can share the bus.
+     * In loopback mode sent messages are delivered as well.
+     * @return Listener ID for removeListener, 0 if not initialized
+     */
+    uint32_t addListener(std::function<void(const CANMessage&)> listener);
+    
+    /**
+     * @brief Remove a listener added with addListener
+     *
+     * Returns once no dispatch is inside the listener any more, so its
+     * captures may be destroyed. Called from within a listener, it does not
+     * wait for dispatches on other threads.
+     */
+    void removeListener(uint32_t listenerId);
+    
+    /**
+     * @brief Deliver a message to the filters and listeners as if received
+     *
+     * Nothing goes on the bus; used to replay recorded traffic.
+     */
+    bool injectMessage(const CANMessage& message);
+    
+    /**
+     * @brief Publish values from plugin frame decoders into a live data store
+     *
+     * Received messages that pass the filters are run through the frame
+     * decoders in the global extension registry, and each value goes to the
+     * channel of the same name, added on first use. nullptr stops publishing.
+     */
+    void publishDecodedValuesTo(std::shared_ptr<LiveDataStore> store);
+    
     /**
      * @brief Get protocol statistics
      */
@@ -206,10 +261,25 @@ public:
     Statistics getStatistics() const;
     
     /**
-     * @brief Reset statistics
+     * @brief Reset statistics, including bus load and per-ID counters
      */
     void resetStatistics();
     
+    /**
+     * @brief Bus load over the time since the previous call
+     *
+     * Counts every frame received before filtering, frames sent when they
+     * are not looped back, and bus error frames reported by SocketCAN.
+     * SocketCAN filters act in the kernel, so frames they block are not
+     * counted; clear the filters for a full bus load.
+     */
+    BusLoadSnapshot getBusLoad();
+    
+    /**
+     * @brief Frame counts, period and jitter of every ID seen
+     */
+    std::vector<CANIdStatistics> getIdStatistics() const;
+    
     /**
      * @brief Get current configuration
      */
@@ -229,6 +299,28 @@ private:
 FMUS_AUTO_API bool isValidCANId(uint32_t id, bool extended = false);
 FMUS_AUTO_API bool isValidCANBaudRate(uint32_t baudRate);
 FMUS_AUTO_API std::vector<uint32_t> getStandardCANBaudRates();
+FMUS_AUTO_API bool isValidCANFDDataRate(uint32_t baudRate);
+
+/**
+ * @brief Payload length for a DLC (0-15)
+ */
+FMUS_AUTO_API size_t canDlcToLength(uint8_t dlc);
+
+/**
+ * @brief Smallest DLC whose length holds the payload; 15 beyond 48 bytes
+ */
+FMUS_AUTO_API uint8_t canLengthToDlc(size_t length);
+
+/**
+ * @brief Payload length rounded up to the next CAN FD frame size
+ */
+FMUS_AUTO_API size_t canFdLength(size_t length);
+
+/**
+ * @brief Bus configuration for connection options, CAN FD with the CAN_FD_FORMAT flag
+ */
+FMUS_AUTO_API CANConfig canConfigFromOptions(const j2534::ConnectionOptions& options);
+
 FMUS_AUTO_API std::string canIdToString(uint32_t id, bool extended = false);
 FMUS_AUTO_API uint32_t stringToCANId(const std::string& str);
 
@@ -0,0 +1,220 @@
+#ifndef FMUS_PROTOCOLS_DBC_H
+#define FMUS_PROTOCOLS_DBC_H
+
+/**
+ * @file dbc.h
+ * @brief DBC signal database and compiled broadcast signal decoding
+ */
+
+#include <fmus/protocols/can.h>
+#include <fmus/live_data_store.h>
+#include <vector>
+#include <map>
+#include <memory>
+#include <string>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace protocols {
+
+/**
+ * @brief Signal definition from an SG_ line
+ */
+struct DBCSignal {
+    enum class Multiplex {
+        NONE,
+        MULTIPLEXOR,                ///< "M": selects which multiplexed signals are present
+        MULTIPLEXED                 ///< "m<n>": present when the multiplexor equals muxValue
+    };
+
+    std::string name;
+    uint16_t startBit = 0;          ///< As written in the DBC (MSB for big-endian signals)
+    uint8_t bitLength = 1;
+    bool littleEndian = true;       ///< @1 (Intel); @0 is Motorola
+    bool isSigned = false;
+    double factor = 1.0;
+    double offset = 0.0;
+    double minimum = 0.0;
+    double maximum = 0.0;
+    std::string unit;
+    Multiplex multiplex = Multiplex::NONE;
+    uint32_t muxValue = 0;
+    std::map<int64_t, std::string> valueDescriptions;   ///< From VAL_
+
+    std::string toString() const;
+};
+
+/**
+ * @brief Message definition from a BO_ line
+ */
+struct DBCMessage {
+    uint32_t id = 0;
+    bool extended = false;
+    std::string name;
+    uint8_t length = 8;
+    std::string transmitter;
+    std::vector<DBCSignal> signals;
+    uint32_t firstSignal = 0;       ///< Database-wide index of signals[0]
+
+    std::string toString() const;
+};
+
+/**
+ * @brief Decoded signal
+ */
+struct DBCSignalValue {
+    uint32_t signal = 0;            ///< Database-wide signal index
+    int64_t raw = 0;                ///< Sign-extended for signed signals
+    double value = 0.0;             ///< raw * factor + offset
+};
+
+/**
+ * @brief Parsed DBC file with each message compiled for decoding
+ *
+ * Loading compiles every signal into a byte offset, shift, mask and
+ * endianness; multiplexed signals are grouped by multiplexor value.
+ * Decoding copies the frame once into a zero-padded buffer, extracts all
+ * raw values with unchecked word loads, then scales them in a separate
+ * branch-free pass the compiler can vectorize. The database is read-only
+ * after loading, so decode() may run on several threads.
+ */
+class FMUS_AUTO_API DBCDatabase {
+public:
+    DBCDatabase();
+    ~DBCDatabase();
+
+    DBCDatabase(const DBCDatabase&) = delete;
+    DBCDatabase& operator=(const DBCDatabase&) = delete;
+
+    bool loadFile(const std::string& path);
+    bool loadString(const std::string& text);
+
+    const std::vector<DBCMessage>& getMessages() const;
+    const DBCMessage* findMessage(uint32_t id, bool extended) const;
+
+    size_t getSignalCount() const;
+    const DBCSignal* getSignal(uint32_t signal) const;
+    const DBCMessage* getSignalMessage(uint32_t signal) const;
+
+    /**
+     * @brief Find a signal by "Signal" or "Message.Signal"
+     *
+     * A bare signal name used by more than one message is ambiguous and only
+     * found in its qualified form.
+     * @return Database-wide index, or INVALID_SIGNAL
+     */
+    uint32_t findSignal(const std::string& name) const;
+    static constexpr uint32_t INVALID_SIGNAL = 0xFFFFFFFF;
+
+    /**
+     * @brief Decode the signals present in a frame
+     * @return Number of values written; 0 for unknown IDs
+     */
+    size_t decode(uint32_t id, bool extended, const uint8_t* data, size_t length,
+                  DBCSignalValue* out, size_t capacity) const;
+
+    /**
+     * @brief Most signals any one frame can decode to; sizes decode() buffers
+     */
+    size_t getMaxSignalsPerFrame() const;
+
+    std::string toString() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+/**
+ * @brief Decoded signal as delivered to subscribers
+ */
+struct DBCSignalUpdate {
+    const DBCMessage* message = nullptr;
+    const DBCSignal* signal = nullptr;
+    uint32_t index = 0;
+    int64_t raw = 0;
+    double value = 0.0;
+    std::chrono::system_clock::time_point timestamp;
+};
+
+/**
+ * @brief Decodes frames from a CANProtocol and fans signals out
+ *
+ * Subscriptions are copy-on-write, so decoding on the receive thread
+ * never waits on subscribe() calls. Decoded values can also be published
+ * into a LiveDataStore, one channel per signal named "Message.Signal".
+ */
+class FMUS_AUTO_API DBCDecoder {
+public:
+    using SignalHandler = std::function<void(const DBCSignalUpdate&)>;
+    using MessageHandler = std::function<void(const DBCMessage&, const DBCSignalValue*, size_t,
+                                              std::chrono::system_clock::time_point)>;
+
+    explicit DBCDecoder(std::shared_ptr<const DBCDatabase> database);
+    ~DBCDecoder();
+
+    DBCDecoder(const DBCDecoder&) = delete;
+    DBCDecoder& operator=(const DBCDecoder&) = delete;
+
+    bool attach(std::shared_ptr<CANProtocol> canProtocol);
+    void detach();
+
+    /**
+     * @brief Publish every decoded signal into a store
+     */
+    bool publishTo(std::shared_ptr<LiveDataStore> store);
+
+    /**
+     * @brief Subscribe to one signal by "Signal" or "Message.Signal"
+     * @return Subscription ID, 0 if the signal is unknown
+     */
+    uint32_t subscribe(const std::string& signal, SignalHandler handler);
+
+    /**
+     * @brief Subscribe to every decode of a message
+     */
+    uint32_t subscribeMessage(uint32_t id, bool extended, MessageHandler handler);
+    bool unsubscribe(uint32_t subscription);
+
+    /**
+     * @brief Decode one frame and notify subscribers
+     * @return Signals decoded
+     */
+    size_t process(const CANMessage& message);
+
+    /**
+     * @brief Get decoder statistics
+     */
+    struct Statistics {
+        uint64_t framesDecoded = 0;
+        uint64_t framesUnknown = 0;
+        uint64_t signalsDecoded = 0;
+        std::chrono::system_clock::time_point startTime;
+    };
+
+    Statistics getStatistics() const;
+
+    std::string toString() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace protocols
+} // namespace fmus
+
+#endif // FMUS_PROTOCOLS_DBC_H
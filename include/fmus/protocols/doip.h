@@ -0,0 +1,245 @@
+#ifndef FMUS_PROTOCOLS_DOIP_H
+#define FMUS_PROTOCOLS_DOIP_H
+
+/**
+ * @file doip.h
+ * @brief Diagnostics over IP (ISO 13400-2) tester-side transport
+ */
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace protocols {
+
+/// UDP discovery and TCP data port
+constexpr uint16_t DOIP_PORT = 13400;
+/// Protocol version written in every header (ISO 13400-2:2012)
+constexpr uint8_t DOIP_PROTOCOL_VERSION = 0x02;
+/// Version accepted in vehicle identification requests
+constexpr uint8_t DOIP_DEFAULT_VERSION = 0xFF;
+
+/**
+ * @brief DoIP payload types
+ */
+enum class DoIPPayloadType : uint16_t {
+    GENERIC_NACK = 0x0000,
+    VEHICLE_ID_REQUEST = 0x0001,
+    VEHICLE_ID_REQUEST_EID = 0x0002,
+    VEHICLE_ID_REQUEST_VIN = 0x0003,
+    VEHICLE_ANNOUNCEMENT = 0x0004,          ///< Also the vehicle identification response
+    ROUTING_ACTIVATION_REQUEST = 0x0005,
+    ROUTING_ACTIVATION_RESPONSE = 0x0006,
+    ALIVE_CHECK_REQUEST = 0x0007,
+    ALIVE_CHECK_RESPONSE = 0x0008,
+    ENTITY_STATUS_REQUEST = 0x4001,
+    ENTITY_STATUS_RESPONSE = 0x4002,
+    POWER_MODE_REQUEST = 0x4003,
+    POWER_MODE_RESPONSE = 0x4004,
+    DIAGNOSTIC_MESSAGE = 0x8001,
+    DIAGNOSTIC_ACK = 0x8002,
+    DIAGNOSTIC_NACK = 0x8003
+};
+
+/**
+ * @brief Routing activation response codes
+ */
+enum class DoIPRoutingCode : uint8_t {
+    DENIED_UNKNOWN_SOURCE = 0x00,
+    DENIED_ALL_SOCKETS_REGISTERED = 0x01,
+    DENIED_SOURCE_MISMATCH = 0x02,
+    DENIED_SOURCE_ALREADY_ACTIVE = 0x03,
+    DENIED_MISSING_AUTHENTICATION = 0x04,
+    DENIED_REJECTED_CONFIRMATION = 0x05,
+    DENIED_UNSUPPORTED_TYPE = 0x06,
+    SUCCESS = 0x10,
+    CONFIRMATION_REQUIRED = 0x11
+};
+
+/**
+ * @brief Diagnostic message negative acknowledge codes
+ */
+enum class DoIPDiagnosticNack : uint8_t {
+    INVALID_SOURCE_ADDRESS = 0x02,
+    UNKNOWN_TARGET_ADDRESS = 0x03,
+    MESSAGE_TOO_LARGE = 0x04,
+    OUT_OF_MEMORY = 0x05,
+    TARGET_UNREACHABLE = 0x06,
+    UNKNOWN_NETWORK = 0x07,
+    TRANSPORT_PROTOCOL_ERROR = 0x08
+};
+
+/**
+ * @brief Generic DoIP header
+ */
+struct FMUS_AUTO_API DoIPHeader {
+    static constexpr size_t SIZE = 8;
+
+    uint8_t version = DOIP_PROTOCOL_VERSION;
+    DoIPPayloadType payloadType = DoIPPayloadType::GENERIC_NACK;
+    uint32_t payloadLength = 0;
+
+    DoIPHeader() = default;
+    DoIPHeader(DoIPPayloadType type, uint32_t length, uint8_t ver = DOIP_PROTOCOL_VERSION)
+        : version(ver), payloadType(type), payloadLength(length) {}
+
+    /**
+     * @brief Write the 8 header bytes
+     */
+    void encode(uint8_t* out) const;
+
+    /**
+     * @brief Parse 8 header bytes
+     * @return False if the version and its inverse do not match
+     */
+    static bool decode(const uint8_t* in, DoIPHeader& header);
+};
+
+/**
+ * @brief Vehicle announcement / identification response
+ */
+struct FMUS_AUTO_API DoIPVehicleAnnouncement {
+    std::string vin;                        ///< 17 characters
+    uint16_t logicalAddress = 0;
+    std::array<uint8_t, 6> eid{};           ///< Entity ID, usually the MAC address
+    std::array<uint8_t, 6> gid{};           ///< Group ID
+    uint8_t furtherAction = 0;              ///< 0x10: routing activation needed for central security
+    uint8_t syncStatus = 0;
+    std::string ipAddress;                  ///< Sender of the announcement
+
+    std::vector<uint8_t> toPayload() const;
+    static bool fromPayload(const uint8_t* data, size_t length, DoIPVehicleAnnouncement& announcement);
+
+    std::string toString() const;
+};
+
+/**
+ * @brief DoIP client configuration
+ */
+struct DoIPConfig {
+    uint16_t testerAddress = 0x0E00;        ///< Our logical address (external test equipment range)
+    uint8_t activationType = 0x00;          ///< 0x00 default, 0x01 WWH-OBD, 0xE0 central security
+    uint16_t port = DOIP_PORT;
+    uint32_t connectTimeout = 2000;         ///< TCP connect (ms)
+    uint32_t controlTimeout = 2000;         ///< Routing activation and other control responses (ms)
+    uint32_t diagnosticAckTimeout = 2000;   ///< Wait for the diagnostic message ACK (ms)
+    uint32_t maxPayloadSize = 16 * 1024 * 1024;
+
+    std::string toString() const;
+};
+
+/**
+ * @brief DoIP tester connection to one DoIP entity
+ *
+ * Diagnostic messages are written as a header plus the caller's buffer in
+ * one gathered send, and received payloads are handed to the diagnostic
+ * handler as a view into the connection's receive buffer, so UDS data is
+ * never copied on its way through the transport. The handler runs on the
+ * receive thread and must copy what it keeps. Alive check requests from
+ * the entity are answered automatically.
+ */
+class FMUS_AUTO_API DoIPClient {
+public:
+    /**
+     * @brief Called for every diagnostic message from the entity
+     */
+    using DiagnosticHandler = std::function<void(uint16_t sourceAddress, uint16_t targetAddress,
+                                                 const uint8_t* data, size_t length)>;
+
+    /**
+     * @brief Connection statistics
+     */
+    struct Statistics {
+        uint64_t messagesSent = 0;
+        uint64_t messagesReceived = 0;
+        uint64_t bytesSent = 0;
+        uint64_t bytesReceived = 0;
+        uint64_t negativeAcks = 0;
+        uint64_t aliveChecks = 0;
+        std::chrono::system_clock::time_point startTime;
+    };
+
+    /**
+     * @brief Broadcast a vehicle identification request and gather answers
+     * @param broadcastAddress IPv4 address to send to, e.g. a subnet broadcast
+     * @param vin Ask only the entity with this VIN if not empty
+     */
+    static std::vector<DoIPVehicleAnnouncement> discover(const std::string& broadcastAddress = "255.255.255.255",
+                                                         uint32_t timeoutMs = 500,
+                                                         const std::string& vin = "",
+                                                         uint16_t port = DOIP_PORT);
+
+    DoIPClient();
+    ~DoIPClient();
+
+    DoIPClient(const DoIPClient&) = delete;
+    DoIPClient& operator=(const DoIPClient&) = delete;
+
+    /**
+     * @brief Open the TCP connection to an entity
+     */
+    bool connect(const std::string& host, const DoIPConfig& config = DoIPConfig{});
+    void disconnect();
+    bool isConnected() const;
+
+    /**
+     * @brief Activate routing for our tester address
+     */
+    bool activateRouting();
+    bool isRoutingActive() const;
+
+    /**
+     * @brief Logical address of the entity, as reported by routing activation
+     */
+    uint16_t getEntityAddress() const;
+
+    /**
+     * @brief Send a diagnostic message and wait for its acknowledgement
+     * @return False on a negative acknowledgement, timeout or connection loss
+     */
+    bool sendDiagnosticMessage(uint16_t targetAddress, const uint8_t* data, size_t length);
+    bool sendDiagnosticMessage(uint16_t targetAddress, const std::vector<uint8_t>& data);
+
+    void setDiagnosticHandler(DiagnosticHandler handler);
+
+    /**
+     * @brief Code of the last routing activation or diagnostic NACK, for diagnostics
+     */
+    uint8_t getLastResponseCode() const;
+
+    DoIPConfig getConfiguration() const;
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+    std::string toString() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+// Utility functions
+FMUS_AUTO_API std::string doipPayloadTypeToString(DoIPPayloadType type);
+FMUS_AUTO_API std::string doipRoutingCodeToString(DoIPRoutingCode code);
+
+} // namespace protocols
+} // namespace fmus
+
+#endif // FMUS_PROTOCOLS_DOIP_H
@@ -6,11 +6,15 @@
  * @brief ISO 9141 Protocol Implementation
  */
 
+#include <fmus/j2534/channel.h>
+#include <fmus/protocols/timing_engine.h>
 #include <vector>
 #include <memory>
 #include <functional>
 #include <chrono>
 #include <string>
+#include <stdexcept>
+#include <cstdint>
 
 // Define exports macro
 #ifdef _WIN32
@@ -87,6 +91,7 @@ struct ISO9141Config {
     uint32_t p4Min = 5;                 ///< P4 minimum timing (ms)
     bool useChecksum = true;            ///< Enable checksum validation
     uint8_t sourceAddress = 0xF1;       ///< Default source address
+    int timingCpuCore = -1;             ///< Pin the transmit thread to this core, -1 for none
     
     std::string toString() const;
 };
@@ -120,9 +125,23 @@ public:
     
     /**
      * @brief Initialize protocol
+     *
+     * Without a channel there is no K-line to drive, so this only validates
+     * and stores the configuration and returns false.
      */
     bool initialize(const ISO9141Config& config);
     
+    /**
+     * @brief Initialize protocol on a connected J2534 ISO9141 channel
+     *
+     * P1max and P4min are handed to the adapter, which owns the byte-level
+     * timing. P3min is enforced here: each request is released at the end
+     * of the previous bus activity plus P3min, with no extra margin. P2 and
+     * P3 as seen on the bus are measured from the adapter's timestamps.
+     * Connect the channel with ISO9141_NO_CHECKSUM when useChecksum is set.
+     */
+    bool initialize(const ISO9141Config& config, std::shared_ptr<j2534::PassThruChannel> channel);
+    
     /**
      * @brief Shutdown protocol
      */
@@ -173,12 +192,19 @@ public:
         uint64_t timeouts = 0;
         uint64_t initAttempts = 0;
         uint64_t initSuccesses = 0;
+        uint64_t timingViolations = 0;
+        std::chrono::microseconds lastResponseTime{0};
         std::chrono::system_clock::time_point startTime;
     };
     
     Statistics getStatistics() const;
     void resetStatistics();
     
+    /**
+     * @brief Achieved P1-P4 timing and wait accuracy
+     */
+    TimingEngine::Statistics getTimingStatistics() const;
+    
     /**
      * @brief Get current configuration
      */
@@ -6,11 +6,15 @@
  * @brief J1850 VPW/PWM Protocol Implementation
  */
 
+#include <fmus/j2534/channel.h>
 #include <vector>
 #include <memory>
 #include <functional>
+#include <optional>
 #include <chrono>
 #include <string>
+#include <stdexcept>
+#include <cstdint>
 
 // Define exports macro
 #ifdef _WIN32
@@ -44,16 +48,28 @@ enum class J1850Priority : uint8_t {
     LOW = 0x03
 };
 
+/// Target address of OBD functional requests
+constexpr uint8_t J1850_FUNCTIONAL_REQUEST = 0x6A;
+/// Target address of OBD functional responses
+constexpr uint8_t J1850_FUNCTIONAL_RESPONSE = 0x6B;
+/// Target address reaching every node on the bus
+constexpr uint8_t J1850_BROADCAST = 0xFE;
+
 /**
  * @brief J1850 Message structure
+ *
+ * Frames use the three-byte consolidated header: header byte, target,
+ * source, then up to 7 data bytes and the CRC.
  */
 struct J1850Message {
-    J1850Priority priority = J1850Priority::MEDIUM;
+    J1850Priority priority = J1850Priority::LOW;    ///< Priority 3, as OBD requests use
+    J1850Type type = J1850Type::VPW;                ///< Selects the header byte layout
     uint8_t sourceAddress = 0xF1;
     uint8_t targetAddress = 0x10;
     std::vector<uint8_t> data;
     uint8_t checksum = 0;
     bool isResponse = false;
+    std::optional<uint8_t> receivedHeader;          ///< Header byte of a received frame, kept as sent
     std::chrono::system_clock::time_point timestamp;
     
     J1850Message() = default;
@@ -85,9 +101,19 @@ struct J1850Message {
     
     /**
      * @brief Get header byte
+     *
+     * Priority in bits 7-5 and the addressing mode taken from the target:
+     * functional for the OBD functional addresses, physical otherwise. VPW
+     * frames request no in-frame response; PWM frames do, as the bus
+     * requires. A received frame keeps the header byte it arrived with.
      */
     uint8_t getHeaderByte() const;
     
+    /**
+     * @brief Check whether the target is an OBD functional address
+     */
+    bool isFunctional() const;
+    
     std::string toString() const;
     bool isValid() const;
 };
@@ -100,6 +126,8 @@ struct J1850Config {
     uint32_t timeout = 1000;            ///< Response timeout (ms)
     bool useChecksum = true;            ///< Enable checksum validation
     uint8_t sourceAddress = 0xF1;       ///< Default source address
+    uint32_t responseWindow = 100;      ///< Functional requests end this long after the last response (ms)
+    bool highSpeed = false;             ///< Switch VPW to 4x (41.6 kbps) after initialization
     
     std::string toString() const;
 };
@@ -121,9 +149,20 @@ public:
     
     /**
      * @brief Initialize protocol
+     *
+     * Without a channel there is no bus to drive, so this only stores the
+     * configuration and returns false.
      */
     bool initialize(const J1850Config& config);
     
+    /**
+     * @brief Initialize protocol on a connected J2534 J1850VPW or J1850PWM channel
+     *
+     * The adapter generates and checks the CRC, so received frames arrive
+     * without it; the CRC field of delivered messages is recomputed.
+     */
+    bool initialize(const J1850Config& config, std::shared_ptr<j2534::PassThruChannel> channel);
+    
     /**
      * @brief Shutdown protocol
      */
@@ -144,6 +183,23 @@ public:
      */
     J1850Message sendRequest(const J1850Message& request);
     
+    /**
+     * @brief Send a functional request and collect every ECU's response
+     *
+     * Collection stops once no further response arrives within the
+     * response window, or at the timeout.
+     */
+    std::vector<J1850Message> sendFunctionalRequest(const J1850Message& request);
+    
+    /**
+     * @brief Switch a VPW bus to 4x mode
+     *
+     * Asks every node with mode $A0, and only if none refuses commands the
+     * switch with $A1 and moves the channel to 41.6 kbps.
+     */
+    bool enableHighSpeedMode();
+    bool isHighSpeedMode() const;
+    
     /**
      * @brief Start message monitoring
      */
@@ -167,6 +223,8 @@ public:
         uint64_t messagesReceived = 0;
         uint64_t checksumErrors = 0;
         uint64_t timeouts = 0;
+        uint64_t functionalRequests = 0;
+        uint64_t negativeResponses = 0;
         std::chrono::system_clock::time_point startTime;
     };
     
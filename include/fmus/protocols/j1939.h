@@ -0,0 +1,296 @@
+#ifndef FMUS_PROTOCOLS_J1939_H
+#define FMUS_PROTOCOLS_J1939_H
+
+/**
+ * @file j1939.h
+ * @brief SAE J1939 stack on a CANProtocol: PGN addressing, transport protocol, address claim and DM1/DM2
+ */
+
+#include <fmus/protocols/can.h>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace protocols {
+
+/**
+ * @brief Well-known parameter group numbers
+ */
+namespace J1939PGN {
+    constexpr uint32_t REQUEST = 0xEA00;
+    constexpr uint32_t ADDRESS_CLAIMED = 0xEE00;
+    constexpr uint32_t TP_CM = 0xEC00;          ///< Transport connection management
+    constexpr uint32_t TP_DT = 0xEB00;          ///< Transport data transfer
+    constexpr uint32_t DM1 = 0xFECA;            ///< Active diagnostic trouble codes
+    constexpr uint32_t DM2 = 0xFECB;            ///< Previously active diagnostic trouble codes
+    constexpr uint32_t DM3 = 0xFECC;            ///< Clear previously active DTCs
+    constexpr uint32_t EEC1 = 0xF004;           ///< Electronic engine controller 1
+    constexpr uint32_t ET1 = 0xFEEE;            ///< Engine temperature 1
+    constexpr uint32_t EFL_P1 = 0xFEEF;         ///< Engine fluid level/pressure 1
+    constexpr uint32_t CCVS = 0xFEF1;           ///< Cruise control/vehicle speed
+    constexpr uint32_t LFE = 0xFEF2;            ///< Fuel economy (liquid)
+    constexpr uint32_t VEP1 = 0xFEF7;           ///< Vehicle electrical power 1
+}
+
+constexpr uint8_t J1939_GLOBAL_ADDRESS = 0xFF;
+constexpr uint8_t J1939_NULL_ADDRESS = 0xFE;
+constexpr size_t J1939_MAX_TP_SIZE = 1785;      ///< 255 packets of 7 bytes
+
+/**
+ * @brief J1939 message (one parameter group)
+ */
+struct J1939Message {
+    uint32_t pgn = 0;
+    uint8_t priority = 6;
+    uint8_t source = J1939_NULL_ADDRESS;
+    uint8_t destination = J1939_GLOBAL_ADDRESS; ///< Global for PDU2 groups
+    std::vector<uint8_t> data;
+    std::chrono::system_clock::time_point timestamp;
+
+    J1939Message() = default;
+    J1939Message(uint32_t pgNumber, const std::vector<uint8_t>& payload, uint8_t dest = J1939_GLOBAL_ADDRESS)
+        : pgn(pgNumber), destination(dest), data(payload), timestamp(std::chrono::system_clock::now()) {}
+
+    /**
+     * @brief PDU1 groups are addressed to one node, PDU2 groups are broadcast
+     */
+    bool isPDU1() const { return ((pgn >> 8) & 0xFF) < 0xF0; }
+
+    std::string toString() const;
+};
+
+/**
+ * @brief Lamp states reported with DM1/DM2 (2 bits each: 0 off, 1 on)
+ */
+struct J1939LampStatus {
+    uint8_t malfunction = 0;
+    uint8_t redStop = 0;
+    uint8_t amberWarning = 0;
+    uint8_t protect = 0;
+};
+
+/**
+ * @brief One J1939 diagnostic trouble code
+ */
+struct J1939DTC {
+    uint32_t spn = 0;               ///< Suspect parameter number (19 bits)
+    uint8_t fmi = 0;                ///< Failure mode identifier
+    uint8_t occurrenceCount = 0;
+    bool conversionMethod = false;  ///< Old SPN byte order when set
+
+    std::string toString() const;
+};
+
+/**
+ * @brief Decoded DM1 or DM2 message
+ */
+struct J1939DiagnosticMessage {
+    J1939LampStatus lamps;
+    std::vector<J1939DTC> dtcs;
+
+    /**
+     * @brief Decode the payload of a DM1 or DM2 message
+     *
+     * A single all-zero DTC, as sent when nothing is active, gives no DTCs.
+     */
+    static J1939DiagnosticMessage fromBytes(const uint8_t* data, size_t length);
+
+    std::string toString() const;
+};
+
+/**
+ * @brief Suspect parameter definition: where a value sits in its group
+ */
+struct J1939SPN {
+    uint32_t spn = 0;
+    uint32_t pgn = 0;
+    std::string name;
+    uint16_t startBit = 0;          ///< Bit 0 is the least significant bit of the first byte
+    uint8_t bitLength = 8;          ///< 1-64; multi-byte values are little-endian
+    double scale = 1.0;
+    double offset = 0.0;
+    std::string unit;
+};
+
+/**
+ * @brief Decoded SPN value
+ */
+struct J1939SPNValue {
+    uint32_t spn = 0;
+    uint64_t raw = 0;
+    double value = 0.0;             ///< raw * scale + offset
+    bool valid = false;             ///< False for error and not-available codes or missing bytes
+};
+
+/**
+ * @brief SPN decoding table
+ *
+ * Each definition is compiled once into a byte offset, shift and mask
+ * (byte-aligned values read whole bytes), grouped by PGN, so decoding a
+ * message is one table lookup plus a few shifts per SPN and no allocation.
+ * Build the table first; decode() may then run on several threads.
+ */
+class FMUS_AUTO_API J1939SPNDecoder {
+public:
+    J1939SPNDecoder();
+    ~J1939SPNDecoder();
+
+    /**
+     * @brief Add or replace a definition
+     */
+    bool addDefinition(const J1939SPN& definition);
+    bool removeDefinition(uint32_t spn);
+
+    /**
+     * @brief Find a definition by SPN, nullptr if unknown
+     */
+    const J1939SPN* getDefinition(uint32_t spn) const;
+
+    /**
+     * @brief Decode every known SPN of a group
+     * @return Number of values written
+     */
+    size_t decode(uint32_t pgn, const uint8_t* data, size_t length, J1939SPNValue* out, size_t capacity) const;
+
+    bool hasPGN(uint32_t pgn) const;
+
+    /**
+     * @brief Common engine and vehicle SPNs (EEC1, ET1, EFL/P1, CCVS, LFE, VEP1)
+     */
+    static std::vector<J1939SPN> standardDefinitions();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+/**
+ * @brief J1939 configuration
+ */
+struct J1939Config {
+    uint64_t name = 0;                  ///< 64-bit NAME used in address claim
+    uint8_t preferredAddress = 0xF9;    ///< Off-board diagnostic tool #1
+    bool claimAddress = true;           ///< Claim at initialize; otherwise use the address unclaimed
+    uint8_t priority = 6;               ///< Default priority for sent messages
+    uint32_t bamPacketInterval = 50;    ///< Gap between BAM data packets (ms, 50-200)
+    uint8_t packetsPerCTS = 16;         ///< Packets we allow per clear-to-send
+    size_t maxSessions = 32;            ///< Concurrent receive sessions
+    uint32_t claimTimeout = 250;        ///< Wait for contending claims (ms)
+
+    std::string toString() const;
+};
+
+/**
+ * @brief J1939 stack on a CANProtocol
+ *
+ * Frames are routed through a PGN dispatch table; messages longer than
+ * eight bytes go through TP.CM/TP.DT, broadcast (BAM) or connection mode
+ * (RTS/CTS). Receive sessions run concurrently per source/destination pair
+ * and reassemble into pooled buffers.
+ */
+class FMUS_AUTO_API J1939Protocol {
+public:
+    using Handler = std::function<void(const J1939Message&)>;
+
+    static constexpr uint32_t ANY_PGN = 0xFFFFFFFF;
+
+    J1939Protocol();
+    ~J1939Protocol();
+
+    /**
+     * @brief Attach to the bus and claim an address if configured
+     */
+    bool initialize(const J1939Config& config, std::shared_ptr<CANProtocol> canProtocol);
+    void shutdown();
+    bool isInitialized() const;
+
+    /**
+     * @brief Send a message, using the transport protocol above 8 bytes
+     *
+     * Connection mode sends block until the receiver acknowledges the
+     * whole message or aborts.
+     */
+    bool sendMessage(const J1939Message& message);
+
+    /**
+     * @brief Send a request for a PGN
+     */
+    bool request(uint32_t pgn, uint8_t destination = J1939_GLOBAL_ADDRESS);
+
+    /**
+     * @brief Add a handler for a PGN, or ANY_PGN for all
+     *
+     * Handlers run on the CAN receive thread; multi-packet messages are
+     * delivered once complete.
+     * @return Handler ID for removeHandler
+     */
+    uint32_t addHandler(uint32_t pgn, Handler handler);
+    void removeHandler(uint32_t handlerId);
+
+    /**
+     * @brief Claim the configured address, moving on if the NAME allows it
+     */
+    bool claimAddress();
+
+    /**
+     * @brief Our source address, J1939_NULL_ADDRESS if none is claimed
+     */
+    uint8_t getAddress() const;
+
+    /**
+     * @brief Get protocol statistics
+     */
+    struct Statistics {
+        uint64_t messagesSent = 0;
+        uint64_t messagesReceived = 0;
+        uint64_t transportSessions = 0;     ///< Multi-packet messages received
+        uint64_t transportAborts = 0;
+        uint64_t transportTimeouts = 0;
+        std::chrono::system_clock::time_point startTime;
+    };
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+    J1939Config getConfiguration() const;
+
+    std::string toString() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+// Utility functions
+FMUS_AUTO_API uint32_t makeJ1939Id(uint8_t priority, uint32_t pgn, uint8_t destination, uint8_t source);
+FMUS_AUTO_API uint32_t j1939PGN(uint32_t canId);
+FMUS_AUTO_API uint8_t j1939Source(uint32_t canId);
+FMUS_AUTO_API uint8_t j1939Destination(uint32_t canId);
+FMUS_AUTO_API uint8_t j1939Priority(uint32_t canId);
+
+/**
+ * @brief Build a 64-bit NAME from its fields
+ */
+FMUS_AUTO_API uint64_t makeJ1939Name(bool arbitraryAddressCapable, uint8_t industryGroup, uint8_t vehicleSystemInstance,
+                                     uint8_t vehicleSystem, uint8_t function, uint8_t functionInstance,
+                                     uint8_t ecuInstance, uint16_t manufacturerCode, uint32_t identityNumber);
+
+} // namespace protocols
+} // namespace fmus
+
+#endif // FMUS_PROTOCOLS_J1939_H
@@ -7,11 +7,15 @@
  */
 
 #include <fmus/protocols/can.h>
+#include <fmus/protocols/transport.h>
+#include <fmus/j2534/channel.h>
 #include <vector>
 #include <memory>
 #include <functional>
 #include <chrono>
 #include <string>
+#include <stdexcept>
+#include <cstdint>
 
 // Define exports macro
 #ifdef _WIN32
@@ -111,18 +115,76 @@ struct KWP2000Message {
     bool isValid() const;
 };
 
+/**
+ * @brief Physical layer carrying KWP2000
+ */
+enum class KWP2000Transport {
+    CAN,        ///< ISO-TP on a CANProtocol
+    K_LINE,     ///< ISO 14230 on a J2534 ISO14230_4 channel
+    TP20        ///< VW TP 2.0 channel on a CANProtocol
+};
+
+/**
+ * @brief ISO 14230-2 header format used on K-line
+ *
+ * The length goes in the format byte when it fits and the ECU supports it,
+ * otherwise in a separate length byte.
+ */
+enum class KWP2000HeaderFormat {
+    AUTO,           ///< Chosen from the key bytes returned by initialization
+    NO_ADDRESS,     ///< Format byte only
+    WITH_ADDRESS    ///< Format, target and source bytes
+};
+
+/**
+ * @brief K-line initialization method
+ */
+enum class KWP2000InitMode {
+    FAST,           ///< 25 ms wake-up pattern and StartCommunication (FAST_INIT)
+    FIVE_BAUD,      ///< Address sent at 5 baud (FIVE_BAUD_INIT)
+    NONE            ///< Bus already initialized
+};
+
+/**
+ * @brief Key bytes reported by the ECU at initialization
+ */
+struct KWP2000KeyBytes {
+    uint8_t kb1 = 0;
+    uint8_t kb2 = 0;
+
+    bool lengthInFormatByte() const { return (kb1 & 0x01) != 0; }   ///< AL0
+    bool lengthByte() const { return (kb1 & 0x02) != 0; }           ///< AL1
+    bool formatOnlyHeader() const { return (kb1 & 0x04) != 0; }     ///< HB0
+    bool addressHeader() const { return (kb1 & 0x08) != 0; }        ///< HB1
+    bool extendedTiming() const { return (kb1 & 0x10) != 0; }       ///< TP
+    uint16_t keyWord() const { return static_cast<uint16_t>(((kb2 & 0x7F) << 7) | (kb1 & 0x7F)); }
+};
+
 /**
  * @brief KWP2000 Configuration
  */
 struct KWP2000Config {
     uint32_t requestId = 0x200;         ///< Request CAN ID
     uint32_t responseId = 0x201;        ///< Response CAN ID
-    uint32_t timeout = 1000;            ///< Response timeout (ms)
-    uint32_t p2ClientMax = 50;          ///< P2 timing (ms)
+    uint32_t timeout = 1000;            ///< Unused by requests, which are timed by P2 and P2*
+    uint32_t p2ClientMax = 50;          ///< P2 timing (ms), time allowed for the ECU to respond
     uint32_t p2StarClientMax = 5000;    ///< P2* timing (ms)
     bool useExtendedAddressing = false;  ///< Extended addressing
     uint8_t sourceAddress = 0xF1;       ///< Source address
     uint8_t targetAddress = 0x10;       ///< Target address
+
+    // K-line settings
+    KWP2000Transport transport = KWP2000Transport::CAN;
+    KWP2000HeaderFormat headerFormat = KWP2000HeaderFormat::AUTO;
+    KWP2000InitMode initMode = KWP2000InitMode::FAST;
+    bool functionalAddressing = false;  ///< Functional target address in requests
+    uint32_t baudRate = 10400;          ///< K-line baud rate
+    double p1Max = 20.0;                ///< ECU inter-byte time max (ms)
+    double p3Min = 55.0;                ///< Tester inter-message time min (ms)
+    double p4Min = 5.0;                 ///< Tester inter-byte time min (ms)
+
+    // TP 2.0 settings
+    Tp20Config tp20;                    ///< Channel to the module when transport is TP20
     
     std::string toString() const;
 };
@@ -146,6 +208,33 @@ public:
      * @brief Initialize protocol
      */
     bool initialize(const KWP2000Config& config, std::shared_ptr<CANProtocol> canProtocol);
+
+    /**
+     * @brief Initialize on K-line over a J2534 ISO14230_4 channel
+     *
+     * Applies P1/P3/P4 with SET_CONFIG so the adapter enforces them, then
+     * wakes the ECU as configured by initMode. The adapter holds each request
+     * until P3min after the previous response, so requests are written as
+     * soon as the response is read and never wait on the host.
+     */
+    bool initialize(const KWP2000Config& config, std::shared_ptr<j2534::PassThruChannel> channel);
+
+    /**
+     * @brief Initialize on any diagnostic transport
+     *
+     * The transport is opened if needed and left open on shutdown.
+     */
+    bool initialize(const KWP2000Config& config, std::shared_ptr<DiagnosticTransport> transport);
+
+    /**
+     * @brief Repeat the K-line initialization, e.g. after P3max expired
+     */
+    bool startCommunication();
+
+    /**
+     * @brief Key bytes from the last K-line initialization
+     */
+    KWP2000KeyBytes getKeyBytes() const;
     
     /**
      * @brief Shutdown protocol
@@ -166,6 +255,13 @@ public:
      * @brief Send request and wait for response
      */
     KWP2000Message sendRequest(const KWP2000Message& request);
+
+    /**
+     * @brief Send requests back to back, each after the previous response
+     *
+     * Stops at the first timeout; returns the responses received.
+     */
+    std::vector<KWP2000Message> sendRequests(const std::vector<KWP2000Message>& requests);
     
     /**
      * @brief Start message monitoring
@@ -190,6 +286,8 @@ public:
         uint64_t messagesReceived = 0;
         uint64_t negativeResponses = 0;
         uint64_t timeouts = 0;
+        uint64_t responsePending = 0;                   ///< 0x78 responses seen
+        std::chrono::microseconds lastResponseTime{0};  ///< Request write to response read
         std::chrono::system_clock::time_point startTime;
     };
     
@@ -202,6 +300,9 @@ public:
     KWP2000Config getConfiguration() const;
 
 private:
+    bool initialize(const KWP2000Config& config, std::shared_ptr<DiagnosticTransport> transport,
+                    bool ownsTransport);
+
     class Impl;
     std::unique_ptr<Impl> pImpl;
 };
@@ -229,6 +330,25 @@ FMUS_AUTO_API std::string kwp2000NRCToString(KWP2000NRC nrc);
 FMUS_AUTO_API bool isValidKWP2000Service(uint8_t serviceId);
 FMUS_AUTO_API uint8_t calculateKWP2000Checksum(const std::vector<uint8_t>& data);
 
+/**
+ * @brief Build an ISO 14230-2 frame: header, service and data, and checksum
+ * @param addressHeader Include target and source bytes
+ * @param lengthInFormatByte Put lengths up to 63 in the format byte
+ */
+FMUS_AUTO_API std::vector<uint8_t> encodeKWP2000Frame(const std::vector<uint8_t>& payload, bool addressHeader,
+                                                      bool functional, uint8_t target, uint8_t source,
+                                                      bool lengthInFormatByte = true, bool appendChecksum = true);
+
+/**
+ * @brief Parse an ISO 14230-2 frame
+ *
+ * Accepts frames with or without the trailing checksum; a checksum that is
+ * present must match.
+ * @return False if the frame is truncated or the checksum is wrong
+ */
+FMUS_AUTO_API bool decodeKWP2000Frame(const std::vector<uint8_t>& frame, std::vector<uint8_t>& payload,
+                                      uint8_t* target = nullptr, uint8_t* source = nullptr);
+
 } // namespace protocols
 } // namespace fmus
 
@@ -0,0 +1,114 @@
+#ifndef FMUS_PROTOCOLS_SOCKETCAN_H
+#define FMUS_PROTOCOLS_SOCKETCAN_H
+
+/**
+ * @file socketcan.h
+ * @brief Linux raw CAN socket used as a CANProtocol backend
+ */
+
+#include <fmus/protocols/can.h>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace protocols {
+
+/**
+ * @brief Raw CAN socket bound to one interface
+ *
+ * Frames are sent and received in batches with sendmmsg/recvmmsg into
+ * buffers allocated at open. Filters are installed in the kernel with
+ * CAN_RAW_FILTER, so unwanted frames never reach user space, nor the
+ * CANProtocol bus statistics. Receive
+ * times come from SO_TIMESTAMPING, hardware first when the adapter
+ * provides it. One thread may receive while another sends.
+ */
+class FMUS_AUTO_API SocketCANChannel {
+public:
+    SocketCANChannel();
+    ~SocketCANChannel();
+
+    /**
+     * @brief Open a socket on config.interfaceName
+     *
+     * Uses fd, loopback (receive own frames), hardwareTimestamps and
+     * rxBatchSize; bit rates and listen-only are properties of the link.
+     */
+    bool open(const CANConfig& config);
+    void close();
+    bool isOpen() const;
+
+    /**
+     * @brief Replace the kernel filters; an empty list receives everything
+     */
+    bool setFilters(const std::vector<CANFilter>& filters);
+
+    /**
+     * @brief Send frames, waiting up to txTimeout for queue space
+     * @return Number of frames sent
+     */
+    size_t send(const CANMessage* messages, size_t count);
+
+    /**
+     * @brief Append up to rxBatchSize received frames
+     * @param timeout Wait for the first frame (ms)
+     * @return Number of frames appended
+     */
+    size_t receive(std::vector<CANMessage>& messages, uint32_t timeout);
+
+    /**
+     * @brief Bus error frames reported by the controller so far
+     *
+     * Counted by receive(); the link needs bus-error reporting enabled
+     * (ip link ... berr-reporting on).
+     */
+    uint64_t getErrorFrameCount() const;
+
+    /**
+     * @brief Whether this build has SocketCAN support
+     */
+    static bool isSupported();
+
+    std::string toString() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+/**
+ * @brief One CAN_RAW_FILTER entry, laid out like struct can_filter
+ */
+struct SocketCANFilter {
+    uint32_t id = 0;                    ///< can_id with the EFF and INV flags
+    uint32_t mask = 0;                  ///< can_mask; 0 passes everything
+};
+
+/**
+ * @brief Kernel filters for setFilters()
+ *
+ * The kernel passes a frame matching any entry and receives at least every
+ * frame the CANFilters pass. It may receive more: a blocking standard-frame
+ * filter also lets every extended frame through. An empty list, or one
+ * longer than CAN_RAW_FILTER_MAX, becomes a single entry passing everything.
+ * Returns nothing where SocketCAN is unsupported.
+ */
+FMUS_AUTO_API std::vector<SocketCANFilter> toSocketCANFilters(const std::vector<CANFilter>& filters);
+
+} // namespace protocols
+} // namespace fmus
+
+#endif // FMUS_PROTOCOLS_SOCKETCAN_H
@@ -0,0 +1,148 @@
+#ifndef FMUS_PROTOCOLS_TIMING_ENGINE_H
+#define FMUS_PROTOCOLS_TIMING_ENGINE_H
+
+/**
+ * @file timing_engine.h
+ * @brief Deadline-based waits and timing supervision for slow serial protocols
+ */
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace protocols {
+
+/**
+ * @brief Timing parameters shared by ISO 9141 and ISO 14230
+ */
+enum class TimingParameter {
+    P1 = 0,     ///< ECU inter-byte time
+    P2 = 1,     ///< Request end to response start
+    P3 = 2,     ///< Response end to next request
+    P4 = 3      ///< Tester inter-byte time
+};
+
+/**
+ * @brief Allowed window for one timing parameter; a zero bound is unchecked
+ */
+struct TimingLimits {
+    std::chrono::microseconds min{0};
+    std::chrono::microseconds max{0};
+};
+
+/**
+ * @brief Waits for absolute deadlines and checks measured protocol timing
+ *
+ * sleepUntil() blocks with clock_nanosleep(TIMER_ABSTIME) until shortly
+ * before the deadline and spins for the remainder, so waits land within a
+ * few microseconds instead of the 1-10 ms a relative sleep overshoots by.
+ * Because deadlines are absolute, time spent between computing one and
+ * waiting for it is not added on top. The thread that performs waits can
+ * be pinned to an isolated core to keep scheduler jitter out of the spin.
+ */
+class FMUS_AUTO_API TimingEngine {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Engine configuration
+     */
+    struct Config {
+        std::chrono::microseconds spinThreshold{200};  ///< Busy-wait this long before a deadline
+        int cpuCore = -1;                               ///< Core for pinCurrentThread(), -1 to leave unpinned
+    };
+
+    /**
+     * @brief Measurements of one timing parameter
+     */
+    struct ParameterStatistics {
+        uint64_t samples = 0;
+        uint64_t violations = 0;
+        std::chrono::microseconds minimum{0};
+        std::chrono::microseconds maximum{0};
+        std::chrono::microseconds average{0};
+    };
+
+    /**
+     * @brief Engine statistics
+     */
+    struct Statistics {
+        std::array<ParameterStatistics, 4> parameters;  ///< Indexed by TimingParameter
+        uint64_t waits = 0;
+        std::chrono::microseconds maxOvershoot{0};      ///< Latest wake-up past a deadline
+        std::chrono::microseconds averageOvershoot{0};
+        std::chrono::system_clock::time_point startTime;
+
+        const ParameterStatistics& operator[](TimingParameter parameter) const {
+            return parameters[static_cast<size_t>(parameter)];
+        }
+    };
+
+    TimingEngine();
+    explicit TimingEngine(const Config& config);
+    ~TimingEngine();
+
+    TimingEngine(const TimingEngine&) = delete;
+    TimingEngine& operator=(const TimingEngine&) = delete;
+
+    void setLimits(TimingParameter parameter, const TimingLimits& limits);
+    TimingLimits getLimits(TimingParameter parameter) const;
+
+    /**
+     * @brief Block until the deadline; returns at once if it has passed
+     * @return Time at which the wait returned
+     */
+    Clock::time_point sleepUntil(Clock::time_point deadline);
+
+    /**
+     * @brief Block for a duration measured from now
+     */
+    Clock::time_point sleepFor(Clock::duration duration);
+
+    /**
+     * @brief Pin the calling thread to the configured core
+     * @return False if no core is configured or pinning failed
+     */
+    bool pinCurrentThread();
+
+    /**
+     * @brief Pin the calling thread to a core
+     */
+    static bool pinThreadToCore(int core);
+
+    /**
+     * @brief Record a measured interval and check it against its limits
+     * @return False if the interval violates the limits
+     */
+    bool record(TimingParameter parameter, Clock::duration measured);
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+    std::string toString() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+FMUS_AUTO_API std::string timingParameterToString(TimingParameter parameter);
+
+} // namespace protocols
+} // namespace fmus
+
+#endif // FMUS_PROTOCOLS_TIMING_ENGINE_H
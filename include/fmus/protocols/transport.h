@@ -0,0 +1,315 @@
+#ifndef FMUS_PROTOCOLS_TRANSPORT_H
+#define FMUS_PROTOCOLS_TRANSPORT_H
+
+/**
+ * @file transport.h
+ * @brief Diagnostic transports carrying complete request/response PDUs
+ */
+
+#include <fmus/protocols/can.h>
+#include <fmus/protocols/doip.h>
+#include <fmus/j2534/channel.h>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace protocols {
+
+/**
+ * @brief What a transport can carry and how fast
+ *
+ * Upper layers size their requests from these instead of assuming CAN,
+ * e.g. FlashManager picks its TransferData length from maxPduSize.
+ */
+struct TransportCapabilities {
+    std::string name;                                   ///< "ISO-TP", "DoIP", "K-line", ...
+    size_t maxPduSize = 4095;                           ///< Largest PDU in one send
+    uint8_t blockSize = 0;                              ///< Frames sent per flow control or ACK; 0 = unlimited
+    std::chrono::microseconds separationTime{0};        ///< Minimum gap between consecutive frames
+    std::chrono::milliseconds p2Timeout{50};            ///< Expected response time
+    std::chrono::milliseconds p2StarTimeout{5000};      ///< Response time after a response-pending NRC
+    bool functionalAddressing = false;                  ///< Requests may reach several ECUs
+
+    std::string toString() const;
+};
+
+/**
+ * @brief Carries complete diagnostic PDUs (service ID plus data)
+ *
+ * send() hands one PDU to the transport and returns once it is on the wire
+ * or queued for it; PDUs from ECUs arrive on the receive handler, already
+ * reassembled, together with the address they came from. The handler runs
+ * on the transport's receive thread and sees a view it must copy from.
+ */
+class FMUS_AUTO_API DiagnosticTransport {
+public:
+    /**
+     * @brief Called for every PDU received
+     * @param source CAN ID, DoIP logical address or K-line source byte
+     */
+    using ReceiveHandler = std::function<void(uint32_t source, const uint8_t* data, size_t length)>;
+
+    virtual ~DiagnosticTransport() = default;
+
+    /**
+     * @brief Start receiving; idempotent
+     */
+    virtual bool open() = 0;
+    virtual void close() = 0;
+    virtual bool isOpen() const = 0;
+
+    /**
+     * @brief Send one PDU
+     */
+    virtual bool send(const uint8_t* data, size_t length) = 0;
+    bool send(const std::vector<uint8_t>& pdu) { return send(pdu.data(), pdu.size()); }
+
+    virtual void setReceiveHandler(ReceiveHandler handler) = 0;
+
+    virtual TransportCapabilities getCapabilities() const = 0;
+
+    virtual std::string toString() const = 0;
+};
+
+/**
+ * @brief ISO-TP (ISO 15765-2) configuration
+ */
+struct IsoTpConfig {
+    uint32_t txId = 0x7E0;                  ///< Request CAN ID
+    uint32_t rxId = 0x7E8;                  ///< Response CAN ID
+    std::vector<uint32_t> extraRxIds;       ///< Further responders, e.g. 0x7E9-0x7EF for OBD
+    uint32_t flowControlId = 0;             ///< CAN ID for flow control to rxId; 0 to derive it per responder
+    bool extendedIds = false;               ///< 29-bit CAN IDs
+    uint8_t blockSize = 0;                  ///< Block size we grant; 0 = no further flow control
+    uint8_t stMin = 0;                      ///< Separation time we ask for (ISO 15765-2 encoding)
+    uint8_t padding = 0xCC;                 ///< Fill byte for frames shorter than 8
+    bool padFrames = true;
+    uint32_t flowControlTimeout = 1000;     ///< N_Bs: wait for the receiver's flow control (ms)
+    uint32_t consecutiveFrameTimeout = 1000;///< N_Cr: wait for the next consecutive frame (ms)
+    bool canFd = false;                     ///< CAN FD frames (ISO 15765-2:2016)
+    uint8_t txDataLength = 64;              ///< TX_DL with CAN FD: 8, 12, 16, 20, 24, 32, 48 or 64
+    bool bitRateSwitch = true;              ///< CAN FD frames use the data phase rate
+
+    std::string toString() const;
+};
+
+/**
+ * @brief ISO-TP frame types (high nibble of the first PCI byte)
+ */
+enum class IsoTpFrameType : uint8_t {
+    SINGLE = 0x00,
+    FIRST = 0x10,
+    CONSECUTIVE = 0x20,
+    FLOW_CONTROL = 0x30,
+    INVALID = 0xFF
+};
+
+/**
+ * @brief Protocol control information of one ISO-TP frame
+ */
+struct IsoTpPci {
+    IsoTpFrameType type = IsoTpFrameType::INVALID;
+    size_t dataLength = 0;          ///< SF_DL or FF_DL
+    size_t payloadOffset = 0;       ///< First payload byte in the frame
+    uint8_t sequence = 0;           ///< Consecutive frame sequence number
+    uint8_t flowStatus = 0;         ///< Flow control: 0 continue, 1 wait, 2 overflow
+    uint8_t blockSize = 0;          ///< Flow control BS
+    uint8_t stMin = 0;              ///< Flow control STmin
+};
+
+/**
+ * @brief ISO-TP segmentation over a CANProtocol
+ *
+ * Registers as one of the CANProtocol's listeners, so several transports
+ * and clients can share a bus. Each responder has its own reassembly.
+ * PDUs over 4095 bytes use the escape first frame (32-bit FF_DL).
+ */
+class FMUS_AUTO_API IsoTpTransport : public DiagnosticTransport {
+public:
+    IsoTpTransport(std::shared_ptr<CANProtocol> canProtocol, const IsoTpConfig& config);
+    ~IsoTpTransport() override;
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override;
+
+    using DiagnosticTransport::send;
+    bool send(const uint8_t* data, size_t length) override;
+
+    void setReceiveHandler(ReceiveHandler handler) override;
+    TransportCapabilities getCapabilities() const override;
+    std::string toString() const override;
+
+    IsoTpConfig getConfiguration() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+/**
+ * @brief Diagnostic messages to one logical address over a DoIPClient
+ *
+ * The client must be connected with routing active. PDUs are passed
+ * through without copies in either direction.
+ */
+class FMUS_AUTO_API DoIPTransport : public DiagnosticTransport {
+public:
+    DoIPTransport(std::shared_ptr<DoIPClient> client, uint16_t targetAddress);
+    ~DoIPTransport() override;
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override;
+
+    using DiagnosticTransport::send;
+    bool send(const uint8_t* data, size_t length) override;
+
+    void setReceiveHandler(ReceiveHandler handler) override;
+    TransportCapabilities getCapabilities() const override;
+    std::string toString() const override;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+/**
+ * @brief ISO 14230-2 framing on a K-line
+ */
+struct KLineFraming {
+    bool addressHeader = true;          ///< Format, target and source bytes
+    bool lengthInFormatByte = true;     ///< Length in the format byte when it fits
+    bool lengthByte = true;             ///< ECU accepts a separate length byte, for PDUs over 63 bytes
+    bool functional = false;            ///< Functional target address
+    uint8_t targetAddress = 0x33;
+    uint8_t sourceAddress = 0xF1;
+};
+
+/**
+ * @brief PDUs on an initialized J2534 ISO14230_4 channel
+ *
+ * Waking the ECU (fast or 5-baud init) is left to the owner, which then
+ * sets the framing the key bytes allow. The adapter appends checksums and
+ * enforces P1-P4.
+ */
+class FMUS_AUTO_API KLineTransport : public DiagnosticTransport {
+public:
+    KLineTransport(std::shared_ptr<j2534::PassThruChannel> channel, const KLineFraming& framing);
+    ~KLineTransport() override;
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override;
+
+    using DiagnosticTransport::send;
+    bool send(const uint8_t* data, size_t length) override;
+
+    void setReceiveHandler(ReceiveHandler handler) override;
+    TransportCapabilities getCapabilities() const override;
+    std::string toString() const override;
+
+    /**
+     * @brief Change the framing, e.g. after a new initialization
+     */
+    void setFraming(const KLineFraming& framing);
+    KLineFraming getFraming() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+/**
+ * @brief VW TP 2.0 channel configuration
+ */
+struct Tp20Config {
+    uint8_t moduleAddress = 0x01;           ///< Logical address, e.g. 0x01 engine
+    uint8_t applicationType = 0x01;         ///< 0x01 = KWP2000
+    uint32_t setupId = 0x200;               ///< CAN ID for channel setup; responses on setupId + module
+    uint32_t testerRxId = 0x300;            ///< CAN ID proposed for the module's transmissions
+    uint8_t blockSize = 0x0F;               ///< Packets the module may send before we acknowledge
+    std::chrono::microseconds ackTimeout{100000};       ///< T1: our wait for an acknowledgement
+    std::chrono::microseconds packetInterval{5000};     ///< T3: gap we ask between the module's packets
+    uint32_t setupTimeout = 500;            ///< Wait for channel setup and parameter responses (ms)
+    uint32_t keepAliveInterval = 1000;      ///< Channel test period while idle (ms); 0 = off
+
+    std::string toString() const;
+};
+
+/**
+ * @brief VW TP 2.0 channel over a CANProtocol
+ *
+ * open() negotiates a channel with the module (dynamic CAN IDs, block size,
+ * T1/T3) and keeps it alive with channel tests until close(). Sends go out
+ * in windows of the module's block size, acknowledged once per window.
+ */
+class FMUS_AUTO_API Tp20Transport : public DiagnosticTransport {
+public:
+    Tp20Transport(std::shared_ptr<CANProtocol> canProtocol, const Tp20Config& config);
+    ~Tp20Transport() override;
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override;
+
+    using DiagnosticTransport::send;
+    bool send(const uint8_t* data, size_t length) override;
+
+    void setReceiveHandler(ReceiveHandler handler) override;
+    TransportCapabilities getCapabilities() const override;
+    std::string toString() const override;
+
+    Tp20Config getConfiguration() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+// Utility functions
+
+/**
+ * @brief Decode a TP 2.0 timing byte (2-bit unit, 6-bit count)
+ */
+FMUS_AUTO_API std::chrono::microseconds tp20Timing(uint8_t value);
+
+/**
+ * @brief Encode a TP 2.0 timing byte, rounding up to the unit
+ */
+FMUS_AUTO_API uint8_t tp20TimingByte(std::chrono::microseconds time);
+
+/**
+ * @brief Decode an ISO 15765-2 STmin byte
+ */
+FMUS_AUTO_API std::chrono::microseconds isoTpSeparationTime(uint8_t stMin);
+
+/**
+ * @brief Parse the PCI of one ISO-TP frame
+ *
+ * Handles the CAN FD single frame escape (0x00 and SF_DL) and the first
+ * frame escape (0x10 0x00 and 32-bit FF_DL). Lengths are checked against
+ * the frame: a single frame must hold its payload, a first frame must not.
+ * @return false if the frame is not valid ISO-TP
+ */
+FMUS_AUTO_API bool parseIsoTpPci(const uint8_t* data, size_t length, IsoTpPci& pci);
+
+} // namespace protocols
+} // namespace fmus
+
+#endif // FMUS_PROTOCOLS_TRANSPORT_H
@@ -0,0 +1,199 @@
+#ifndef FMUS_PROTOCOLS_XCP_H
+#define FMUS_PROTOCOLS_XCP_H
+
+/**
+ * @file xcp.h
+ * @brief XCP-on-CAN master with dynamic DAQ measurement
+ */
+
+#include <fmus/protocols/can.h>
+#include <fmus/live_data_store.h>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace protocols {
+
+/**
+ * @brief Data type of a measured ECU variable
+ */
+enum class XcpDataType {
+    UINT8,
+    INT8,
+    UINT16,
+    INT16,
+    UINT32,
+    INT32,
+    UINT64,
+    INT64,
+    FLOAT32,
+    FLOAT64
+};
+
+/**
+ * @brief ECU variable sampled by DAQ
+ */
+struct XcpMeasurement {
+    std::string name;                   ///< Live data channel name
+    uint32_t address = 0;
+    uint8_t addressExtension = 0;
+    XcpDataType type = XcpDataType::UINT16;
+    double scale = 1.0;                 ///< Physical value = raw * scale + offset
+    double offset = 0.0;
+    std::string unit;
+};
+
+/**
+ * @brief Variables sampled together on one ECU event channel
+ */
+struct XcpDaqList {
+    uint16_t eventChannel = 0;          ///< ECU event, e.g. a 1 ms or 10 ms task
+    uint8_t prescaler = 1;              ///< Sample every nth event
+    uint8_t priority = 0;
+    std::vector<XcpMeasurement> measurements;
+};
+
+/**
+ * @brief Slave properties from CONNECT
+ */
+struct XcpSlaveInfo {
+    uint8_t resources = 0;              ///< CAL/PAG, DAQ, STIM, PGM bits
+    bool motorola = false;              ///< Big-endian multi-byte values
+    uint8_t maxCto = 8;
+    uint16_t maxDto = 8;
+    uint8_t protocolVersion = 0;
+    uint8_t transportVersion = 0;
+
+    bool supportsDaq() const { return (resources & 0x04) != 0; }
+
+    std::string toString() const;
+};
+
+/**
+ * @brief DAQ processor properties from GET_DAQ_PROCESSOR_INFO
+ */
+struct XcpDaqProcessorInfo {
+    uint8_t properties = 0;
+    uint16_t maxDaq = 0;
+    uint16_t maxEventChannel = 0;
+    uint8_t minDaq = 0;                 ///< Predefined lists ahead of ours
+    uint8_t keyByte = 0;
+
+    bool dynamic() const { return (properties & 0x01) != 0; }
+    bool timestampSupported() const { return (properties & 0x10) != 0; }
+    uint8_t identificationType() const { return keyByte >> 6; }    ///< 0 = absolute ODT number
+
+    std::string toString() const;
+};
+
+/**
+ * @brief XCP on CAN configuration
+ */
+struct XcpConfig {
+    uint32_t commandId = 0x7F0;         ///< Master to slave (CMD/STIM)
+    uint32_t responseId = 0x7F1;        ///< Slave to master (RES/ERR/EV/DAQ)
+    bool extendedIds = false;
+    uint32_t timeout = 100;             ///< T1 command timeout (ms)
+    bool padFrames = true;              ///< Pad to the slave's frame length (MAX_DLC_REQUIRED)
+    bool useTimestamps = true;          ///< Take sample times from DTO timestamps when the slave has them
+
+    std::string toString() const;
+};
+
+/**
+ * @brief XCP master on a CANProtocol
+ *
+ * configureDaq() allocates dynamic DAQ lists, packs the measurements into
+ * ODTs and adds one LiveDataStore channel per measurement; after
+ * startDaq() the slave pushes DTOs on its events and each is decoded on
+ * the CAN receive thread straight into the store without allocating.
+ * Sample times come from the DTO timestamps, anchored to the host clock
+ * at start, or from the receive time if the slave has none.
+ */
+class FMUS_AUTO_API XcpMaster {
+public:
+    XcpMaster();
+    ~XcpMaster();
+
+    bool initialize(const XcpConfig& config, std::shared_ptr<CANProtocol> canProtocol);
+    void shutdown();
+    bool isInitialized() const;
+
+    /**
+     * @brief CONNECT in normal mode
+     */
+    bool connect();
+    void disconnect();
+    bool isConnected() const;
+
+    XcpSlaveInfo getSlaveInfo() const;
+
+    /**
+     * @brief Read the DAQ processor properties
+     */
+    bool getDaqProcessorInfo(XcpDaqProcessorInfo& info);
+
+    /**
+     * @brief Allocate and program DAQ lists and select them for start
+     * @param store Receives one channel per measurement, named after it
+     */
+    bool configureDaq(const std::vector<XcpDaqList>& lists, std::shared_ptr<LiveDataStore> store);
+
+    /**
+     * @brief Start all configured lists synchronously
+     */
+    bool startDaq();
+
+    /**
+     * @brief Stop all DAQ lists
+     */
+    bool stopDaq();
+    bool isDaqRunning() const;
+
+    /**
+     * @brief Get master statistics
+     */
+    struct Statistics {
+        uint64_t commandsSent = 0;
+        uint64_t commandErrors = 0;
+        uint64_t dtosReceived = 0;
+        uint64_t dtosDropped = 0;           ///< Unknown or short DTOs
+        uint64_t samplesPublished = 0;
+        uint64_t overloads = 0;             ///< EV_DAQ_OVERLOAD from the slave
+        std::chrono::system_clock::time_point startTime;
+    };
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+    XcpConfig getConfiguration() const;
+
+    std::string toString() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+// Utility functions
+FMUS_AUTO_API size_t xcpDataTypeSize(XcpDataType type);
+FMUS_AUTO_API std::string xcpErrorToString(uint8_t code);
+
+} // namespace protocols
+} // namespace fmus
+
+#endif // FMUS_PROTOCOLS_XCP_H
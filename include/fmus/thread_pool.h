@@ -65,6 +65,14 @@ public:
      */
     size_t getPendingTaskCount() const;
     
+    /**
+     * @brief Check if the calling thread is one of this pool's workers
+     *
+     * A task that waits on futures of other tasks in the same pool can
+     * deadlock once every worker waits; such callers run the work inline.
+     */
+    bool isWorkerThread() const;
+    
     /**
      * @brief Check if the thread pool is stopping
      */
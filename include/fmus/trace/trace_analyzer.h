@@ -0,0 +1,165 @@
+#ifndef FMUS_TRACE_TRACE_ANALYZER_H
+#define FMUS_TRACE_TRACE_ANALYZER_H
+
+/**
+ * @file trace_analyzer.h
+ * @brief Offline reconstruction of ISO-TP diagnostic conversations from traces
+ */
+
+#include <fmus/trace/trace_file.h>
+#include <vector>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace trace {
+
+/**
+ * @brief Physical request/response CAN ID pair of one ECU
+ */
+struct TraceChannel {
+    uint32_t requestId = 0;
+    uint32_t responseId = 0;
+    bool extended = false;
+
+    std::string toString() const;
+};
+
+/**
+ * @brief Analyzer configuration
+ */
+struct TraceAnalyzerConfig {
+    std::vector<TraceChannel> channels;             ///< Empty to detect 0x7E0-0x7EF and 0x18DA normal fixed addressing
+    std::vector<uint32_t> functionalIds = {0x7DF, 0x18DB33F1}; ///< Requests paired on every answering channel of the same ID width
+    uint32_t responseTimeout = 5000;                ///< ms without a response before a request counts as unanswered
+    uint32_t chunksPerThread = 4;                   ///< Partitioning granularity for the parallel scan
+
+    std::string toString() const;
+};
+
+/**
+ * @brief Decoded protocol of a transaction
+ */
+enum class TransactionProtocol {
+    UDS,
+    OBD
+};
+
+/**
+ * @brief Outcome of a transaction
+ */
+enum class TransactionStatus {
+    POSITIVE,
+    NEGATIVE,
+    NO_RESPONSE,
+    SUPPRESSED,                                     ///< suppressPosRspMsgIndicationBit set, no response expected
+    UNSOLICITED                                     ///< Response without a matching request
+};
+
+/**
+ * @brief One request and its final response
+ */
+struct DiagnosticTransaction {
+    TraceChannel channel;
+    TransactionProtocol protocol = TransactionProtocol::UDS;
+    TransactionStatus status = TransactionStatus::NO_RESPONSE;
+    uint8_t service = 0;
+    uint8_t negativeResponseCode = 0;
+    uint32_t pendingResponses = 0;                  ///< NRC 0x78 replies before the final response
+    bool functional = false;
+    int64_t requestStartNs = 0;
+    int64_t requestEndNs = 0;
+    int64_t responseStartNs = 0;                    ///< First frame of the final response; 0 if none
+    int64_t responseEndNs = 0;
+    std::vector<uint8_t> request;
+    std::vector<uint8_t> response;
+
+    /**
+     * @brief Request end to first frame of the final response (P2/P2*)
+     */
+    std::chrono::microseconds latency() const;
+
+    /**
+     * @brief Service and payload decoded with the UDS/OBD parsers
+     */
+    std::string describe() const;
+
+    std::string toString() const;
+};
+
+/**
+ * @brief Result of an analysis
+ */
+struct TraceAnalysis {
+    std::vector<DiagnosticTransaction> transactions;    ///< Ordered by request time
+
+    uint64_t framesScanned = 0;
+    uint64_t diagnosticFrames = 0;
+    uint64_t channels = 0;
+    uint64_t pdus = 0;
+    uint64_t reassemblyErrors = 0;
+    std::chrono::microseconds elapsed{0};
+
+    /**
+     * @brief Write the transaction table as CSV
+     */
+    bool exportCsv(const std::string& path) const;
+
+    std::string toString() const;
+};
+
+/**
+ * @brief Rebuilds diagnostic conversations from a recorded trace
+ *
+ * The trace is partitioned at index block boundaries and scanned in
+ * parallel, sharding frames by request/response ID pair. Each channel is
+ * then reassembled and paired independently on the global thread pool,
+ * so work scales with both trace size and the number of ECUs talking.
+ */
+class FMUS_AUTO_API TraceAnalyzer {
+public:
+    explicit TraceAnalyzer(const TraceAnalyzerConfig& config = TraceAnalyzerConfig());
+    ~TraceAnalyzer();
+
+    TraceAnalyzer(const TraceAnalyzer&) = delete;
+    TraceAnalyzer& operator=(const TraceAnalyzer&) = delete;
+
+    TraceAnalysis analyze(const TraceReader& reader) const;
+
+    /**
+     * @brief Pair already reassembled PDUs of one channel, in time order
+     */
+    struct Pdu {
+        bool fromTester = true;
+        bool functional = false;
+        int64_t startNs = 0;
+        int64_t endNs = 0;
+        std::vector<uint8_t> data;
+    };
+    std::vector<DiagnosticTransaction> pair(const TraceChannel& channel, const std::vector<Pdu>& pdus) const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+// Utility functions
+FMUS_AUTO_API std::string transactionStatusToString(TransactionStatus status);
+
+} // namespace trace
+} // namespace fmus
+
+#endif // FMUS_TRACE_TRACE_ANALYZER_H
@@ -0,0 +1,192 @@
+#ifndef FMUS_TRACE_TRACE_FILE_H
+#define FMUS_TRACE_TRACE_FILE_H
+
+/**
+ * @file trace_file.h
+ * @brief Binary CAN trace format and memory-mapped reader
+ */
+
+#include <fmus/protocols/can.h>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace trace {
+
+/**
+ * @brief Frame flags stored with each record
+ */
+namespace TraceFlags {
+    constexpr uint8_t EXTENDED = 0x01;
+    constexpr uint8_t RTR = 0x02;
+    constexpr uint8_t FD = 0x04;
+    constexpr uint8_t BRS = 0x08;
+    constexpr uint8_t ESI = 0x10;
+}
+
+constexpr uint32_t TRACE_MAGIC = 0x52544D46;        ///< "FMTR"
+constexpr uint32_t TRACE_VERSION = 1;
+constexpr size_t TRACE_HEADER_SIZE = 4096;          ///< Segments start on the next page
+
+/**
+ * @brief File header, rewritten when the recorder closes
+ *
+ * The data region after the header is a run of equal segments. Records
+ * never straddle a segment; a PAD record or a tail shorter than a record
+ * header ends each segment.
+ */
+struct TraceFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t segmentSize;
+    uint64_t dataBytes;             ///< Used bytes of the data region; 0 until closed
+    uint64_t frameCount;            ///< 0 until closed
+    int64_t startTimeNs;            ///< Recorder open time, ns since the epoch
+    int64_t endTimeNs;
+    uint32_t closed;                ///< Non-zero once the recorder closed cleanly
+    uint32_t indexBlockSize;        ///< Data bytes per index entry; 0 if not indexed
+    uint64_t indexOffset;           ///< File offset of the TraceIndexBlock array; 0 if none
+    uint64_t indexBlocks;
+};
+
+/**
+ * @brief Record layout; the payload follows, padded to 8 bytes
+ *
+ * type is written last, so a zero type marks the end of the valid records
+ * in a segment of a file that was not closed.
+ */
+struct TraceRecordHeader {
+    int64_t timestampNs;            ///< Receive time, ns since the epoch
+    uint32_t id;
+    uint8_t flags;                  ///< TraceFlags
+    uint8_t length;                 ///< Payload bytes (0-64)
+    uint16_t type;
+};
+
+enum class TraceRecordType : uint16_t {
+    NONE = 0,
+    FRAME = 1,
+    PAD = 2                         ///< Fills the rest of the segment
+};
+
+/**
+ * @brief Summary of one fixed-size block of the data region, stored after the data
+ */
+struct TraceIndexBlock {
+    uint64_t offset;                ///< Data region offset of the block
+    int64_t minTimeNs;              ///< INT64_MAX for a block without frames
+    int64_t maxTimeNs;
+    uint32_t frames;
+    uint32_t reserved;
+    uint64_t idBloom[8];            ///< 512-bit Bloom filter of the CAN IDs in the block
+};
+
+/**
+ * @brief Size of the record holding a payload of the given length
+ */
+constexpr size_t traceRecordSize(size_t length) {
+    return sizeof(TraceRecordHeader) + ((length + 7) & ~static_cast<size_t>(7));
+}
+
+/**
+ * @brief Frame read from a trace; data points into the mapping
+ */
+struct TraceFrame {
+    int64_t timestampNs = 0;
+    uint32_t id = 0;
+    uint8_t flags = 0;
+    uint8_t length = 0;
+    const uint8_t* data = nullptr;
+
+    bool extended() const { return (flags & TraceFlags::EXTENDED) != 0; }
+
+    protocols::CANMessage toCANMessage() const;
+};
+
+/**
+ * @brief Position in a trace's data region
+ */
+struct TraceCursor {
+    uint64_t offset = 0;
+};
+
+/**
+ * @brief Read-only view of a trace file
+ *
+ * The file is mapped once; cursors are plain offsets, so any number of
+ * threads can read the same trace independently. Files that were not
+ * closed cleanly are read up to the last complete record of each segment.
+ */
+class FMUS_AUTO_API TraceReader {
+public:
+    TraceReader();
+    ~TraceReader();
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+
+    const TraceFileHeader& getHeader() const;
+
+    /**
+     * @brief Bytes of the data region to scan
+     */
+    uint64_t getDataBytes() const;
+
+    /**
+     * @brief Read the frame at the cursor and advance past it
+     * @return false at the end of the trace
+     */
+    bool next(TraceCursor& cursor, TraceFrame& frame) const;
+
+    /**
+     * @brief Block index written by the recorder, nullptr if the file has none
+     */
+    const TraceIndexBlock* getIndex(uint64_t& blocks) const;
+
+    /**
+     * @brief Write the trace as candump -L log lines
+     */
+    bool exportCandump(const std::string& path, const std::string& interfaceName = "can0") const;
+
+    /**
+     * @brief Write the trace as a Vector ASC log with absolute timestamps
+     */
+    bool exportAsc(const std::string& path, uint32_t channel = 1) const;
+
+    std::string toString() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+// Utility functions
+FMUS_AUTO_API uint8_t traceFlagsFromMessage(const protocols::CANMessage& message);
+
+/**
+ * @brief Read the record at the cursor from a region of whole segments
+ * @return false once the cursor reaches length
+ */
+FMUS_AUTO_API bool readTraceRecord(const uint8_t* data, uint64_t length, uint64_t segmentSize,
+                                   TraceCursor& cursor, TraceFrame& frame);
+
+} // namespace trace
+} // namespace fmus
+
+#endif // FMUS_TRACE_TRACE_FILE_H
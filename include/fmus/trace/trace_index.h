@@ -0,0 +1,126 @@
+#ifndef FMUS_TRACE_TRACE_INDEX_H
+#define FMUS_TRACE_TRACE_INDEX_H
+
+/**
+ * @file trace_index.h
+ * @brief Sparse time and CAN ID index for random access into traces
+ */
+
+#include <fmus/trace/trace_file.h>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <limits>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace trace {
+
+constexpr uint32_t TRACE_DEFAULT_INDEX_BLOCK = 64 * 1024;
+
+/**
+ * @brief Accumulates block summaries while records are scanned in order
+ */
+class FMUS_AUTO_API TraceIndexBuilder {
+public:
+    explicit TraceIndexBuilder(uint32_t blockSize = TRACE_DEFAULT_INDEX_BLOCK);
+
+    /**
+     * @brief Add the frame found at a data region offset
+     */
+    void add(uint64_t offset, const TraceFrame& frame);
+
+    /**
+     * @brief Scan whole segments starting at a data region offset
+     */
+    void addSegments(const uint8_t* data, uint64_t regionOffset, uint64_t length, uint64_t segmentSize);
+
+    uint32_t getBlockSize() const { return blockSize; }
+    const std::vector<TraceIndexBlock>& getBlocks() const { return blocks; }
+
+private:
+    uint32_t blockSize;
+    std::vector<TraceIndexBlock> blocks;
+};
+
+/**
+ * @brief Frames to select
+ */
+struct TraceQuery {
+    int64_t fromNs = std::numeric_limits<int64_t>::min();
+    int64_t toNs = std::numeric_limits<int64_t>::max();
+    std::vector<uint32_t> ids;          ///< Any of these IDs; empty for all
+};
+
+/**
+ * @brief Work done by a query
+ */
+struct TraceQueryStatistics {
+    uint64_t blocksScanned = 0;
+    uint64_t blocksSkipped = 0;         ///< In the time range but no ID can match
+    uint64_t framesMatched = 0;
+};
+
+/**
+ * @brief Block index over a trace
+ *
+ * Uses the index the recorder stored in the file, or scans the trace once
+ * if there is none. Queries binary-search the time range, test each
+ * block's ID Bloom filter and only read blocks that may hold a match.
+ */
+class FMUS_AUTO_API TraceIndex {
+public:
+    using Visitor = std::function<bool(const TraceFrame&)>;
+
+    TraceIndex();
+    ~TraceIndex();
+
+    /**
+     * @brief Load or build the index of an open trace; the reader must outlive the index
+     */
+    bool load(const TraceReader& reader);
+    bool isLoaded() const;
+
+    uint64_t getBlockCount() const;
+
+    /**
+     * @brief Block summaries in file order; each offset is a record boundary
+     */
+    const TraceIndexBlock* getBlocks() const;
+    uint64_t getBlockSize() const;
+
+    /**
+     * @brief Cursor at the first block that may hold frames at or after a time
+     */
+    TraceCursor seek(int64_t timeNs) const;
+
+    /**
+     * @brief Visit matching frames in file order until the visitor returns false
+     * @return Frames visited
+     */
+    uint64_t query(const TraceQuery& query, const Visitor& visitor, TraceQueryStatistics* statistics = nullptr) const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+// Utility functions
+FMUS_AUTO_API void traceBloomAdd(uint64_t* bloom, uint32_t id);
+FMUS_AUTO_API bool traceBloomMayContain(const uint64_t* bloom, uint32_t id);
+
+} // namespace trace
+} // namespace fmus
+
+#endif // FMUS_TRACE_TRACE_INDEX_H
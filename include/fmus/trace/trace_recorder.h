@@ -0,0 +1,112 @@
+#ifndef FMUS_TRACE_TRACE_RECORDER_H
+#define FMUS_TRACE_TRACE_RECORDER_H
+
+/**
+ * @file trace_recorder.h
+ * @brief Binary CAN trace recorder writing memory-mapped segments
+ */
+
+#include <fmus/trace/trace_file.h>
+#include <fmus/protocols/can.h>
+#include <memory>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace trace {
+
+/**
+ * @brief Trace recorder configuration
+ */
+struct TraceRecorderConfig {
+    uint64_t segmentSize = 64ULL << 20;         ///< Bytes per segment, a multiple of the page size
+    uint64_t maxBytes = 16ULL << 30;            ///< Frames beyond this are dropped
+    uint32_t segmentsAhead = 2;                 ///< Segments kept allocated and mapped ahead of the writer
+    uint32_t indexBlockSize = 64 * 1024;        ///< Data bytes per time/ID index entry, 0 for no index
+
+    std::string toString() const;
+};
+
+/**
+ * @brief Records CAN frames into a trace file
+ *
+ * record() reserves space with one atomic compare-and-swap and copies the
+ * frame straight into a mapped segment; it does not allocate and may be
+ * called from several dispatch threads. A background thread
+ * allocates and maps segments ahead of the writer and unmaps finished
+ * ones; should it fall segmentsAhead segments behind, writers wait for
+ * it. Frames are dropped only once maxBytes is reached or the disk is
+ * full.
+ *
+ * The same thread summarizes each finished segment into a TraceIndex
+ * block list, which close() appends after the data.
+ */
+class FMUS_AUTO_API TraceRecorder {
+public:
+    TraceRecorder();
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    /**
+     * @brief Create the trace file, replacing any existing one
+     */
+    bool open(const std::string& path, const TraceRecorderConfig& config = TraceRecorderConfig());
+
+    /**
+     * @brief Detach, wait for in-flight writes and finalize the header
+     */
+    void close();
+    bool isOpen() const;
+
+    /**
+     * @brief Record every frame dispatched by a CANProtocol
+     */
+    bool attach(std::shared_ptr<protocols::CANProtocol> canProtocol);
+    void detach();
+
+    /**
+     * @brief Record one frame
+     * @return false if the frame was dropped
+     */
+    bool record(const protocols::CANMessage& message);
+
+    /**
+     * @brief Get recorder statistics
+     */
+    struct Statistics {
+        uint64_t framesRecorded = 0;
+        uint64_t framesDropped = 0;
+        uint64_t bytesWritten = 0;
+        uint64_t segmentsMapped = 0;
+        std::chrono::system_clock::time_point startTime;
+    };
+
+    Statistics getStatistics() const;
+
+    std::string getPath() const;
+
+    std::string toString() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace trace
+} // namespace fmus
+
+#endif // FMUS_TRACE_TRACE_RECORDER_H
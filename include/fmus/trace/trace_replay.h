@@ -0,0 +1,107 @@
+#ifndef FMUS_TRACE_TRACE_REPLAY_H
+#define FMUS_TRACE_TRACE_REPLAY_H
+
+/**
+ * @file trace_replay.h
+ * @brief Replays recorded traces into a CANProtocol
+ */
+
+#include <fmus/trace/trace_file.h>
+#include <fmus/protocols/can.h>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace trace {
+
+/**
+ * @brief Replay configuration
+ */
+struct TraceReplayConfig {
+    double speed = 1.0;                             ///< Multiple of real time; 0 replays as fast as possible
+    bool loop = false;                              ///< Start over at the end until stopped
+    std::vector<protocols::CANFilter> filters;      ///< Replay frames passing any filter; empty for all
+    bool originalTimestamps = false;                ///< Keep recorded receive times instead of replay time
+    int cpuCore = -1;                               ///< Pin the replay thread, -1 to leave unpinned
+
+    std::string toString() const;
+};
+
+/**
+ * @brief Feeds a trace into CANProtocol's dispatch path
+ *
+ * Frames go through CANProtocol::injectMessage(), so filters and every
+ * listener (UDS, OBD, J1939, recorders) see them exactly as received
+ * traffic. Paced replays wait for absolute deadlines derived from the
+ * trace timestamps, so pacing errors do not accumulate.
+ */
+class FMUS_AUTO_API TraceReplayer {
+public:
+    TraceReplayer();
+    ~TraceReplayer();
+
+    TraceReplayer(const TraceReplayer&) = delete;
+    TraceReplayer& operator=(const TraceReplayer&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+
+    /**
+     * @brief Replay on a background thread
+     */
+    bool start(std::shared_ptr<protocols::CANProtocol> canProtocol, const TraceReplayConfig& config = TraceReplayConfig());
+    void stop();
+    bool isRunning() const;
+
+    /**
+     * @brief Wait for a replay without loop to finish
+     * @return false on timeout
+     */
+    bool waitForCompletion(uint32_t timeout);
+
+    /**
+     * @brief Replay on the calling thread, e.g. for benchmarks
+     * @return Frames replayed
+     */
+    uint64_t run(protocols::CANProtocol& canProtocol, const TraceReplayConfig& config = TraceReplayConfig());
+
+    /**
+     * @brief Get replay statistics
+     */
+    struct Statistics {
+        uint64_t framesReplayed = 0;
+        uint64_t framesFiltered = 0;
+        uint64_t loops = 0;                         ///< Completed passes over the trace
+        std::chrono::microseconds maxLateness{0};   ///< Worst dispatch delay behind schedule
+        std::chrono::microseconds elapsed{0};
+        std::chrono::system_clock::time_point startTime;
+    };
+
+    Statistics getStatistics() const;
+
+    std::string toString() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace trace
+} // namespace fmus
+
+#endif // FMUS_TRACE_TRACE_REPLAY_H
@@ -0,0 +1,197 @@
+#ifndef FMUS_TRACE_TRIGGER_CAPTURE_H
+#define FMUS_TRACE_TRIGGER_CAPTURE_H
+
+/**
+ * @file trigger_capture.h
+ * @brief In-memory pre/post-trigger capture of bus frames and live data
+ */
+
+#include <fmus/protocols/can.h>
+#include <fmus/live_data_store.h>
+#include <vector>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+
+// Define exports macro
+#ifdef _WIN32
+    #ifdef FMUS_AUTO_EXPORTS
+        #define FMUS_AUTO_API __declspec(dllexport)
+    #else
+        #define FMUS_AUTO_API __declspec(dllimport)
+    #endif
+#else
+    #define FMUS_AUTO_API
+#endif
+
+namespace fmus {
+namespace trace {
+
+/**
+ * @brief What fired a capture
+ */
+enum class CaptureTrigger {
+    MANUAL,
+    DTC,                ///< A DTC became active
+    THRESHOLD,          ///< A parameter crossed a threshold
+    NRC                 ///< A diagnostic negative response was seen on the bus
+};
+
+/**
+ * @brief Threshold crossing on a parameter
+ */
+struct CaptureThreshold {
+    enum class Edge {
+        RISING,
+        FALLING,
+        EITHER
+    };
+
+    std::string parameter;
+    double level = 0.0;
+    Edge edge = Edge::RISING;
+};
+
+/**
+ * @brief Capture configuration
+ */
+struct TriggerCaptureConfig {
+    std::chrono::milliseconds preTrigger{30000};
+    std::chrono::milliseconds postTrigger{30000};
+    size_t frameCapacity = 1 << 19;             ///< Frames kept in memory, rounded up to a power of two (80 bytes each)
+    size_t sampleCapacity = 1 << 18;            ///< Parameter samples kept in memory, rounded up to a power of two
+    std::string directory = ".";
+    std::string prefix = "capture";
+
+    bool nrcTrigger = true;
+    std::vector<uint8_t> ignoredNrcs = {0x78};  ///< Response pending is part of normal traffic
+    uint8_t dtcStatusMask = 0x09;               ///< testFailed | confirmedDTC marks a DTC as active
+    std::vector<CaptureThreshold> thresholds;
+
+    uint32_t maxPendingWrites = 2;              ///< Frozen windows waiting for disk; later triggers are ignored
+    uint32_t livePollInterval = 50;             ///< ms between reads of an attached LiveDataStore
+
+    std::string toString() const;
+};
+
+/**
+ * @brief A window written to disk
+ */
+struct CaptureInfo {
+    CaptureTrigger trigger = CaptureTrigger::MANUAL;
+    std::string reason;
+    int64_t triggerTimeNs = 0;                  ///< ns since the epoch
+    int64_t windowStartNs = 0;
+    int64_t windowEndNs = 0;
+    uint64_t frames = 0;
+    uint64_t samples = 0;
+    uint32_t retriggers = 0;                    ///< Further triggers that fell inside the post-trigger time
+    bool truncated = false;                     ///< Memory did not reach back to the pre-trigger start
+    std::string tracePath;                      ///< Trace file, readable with TraceReader
+    std::string samplesPath;                    ///< CSV of parameter samples
+    bool success = false;
+
+    std::string toString() const;
+};
+
+/**
+ * @brief Keeps the last moments of bus traffic and live data and saves
+ *        the window around a trigger
+ *
+ * Frames and samples go into fixed rings, so memory stays constant. A
+ * trigger arms the window; once the post-trigger time has passed a
+ * background thread copies the window out of the rings in short locked
+ * chunks and hands it to the global thread pool to be written, while
+ * capture continues into the rings. Size the rings for the pre- plus
+ * post-trigger time at the expected bus load to keep windows complete.
+ * Windows are located by timestamp; frames and samples that arrive out of
+ * time order (injected, replayed) are still captured, at the cost of
+ * scanning the whole ring while they are in it.
+ */
+class FMUS_AUTO_API TriggerCapture {
+public:
+    using CaptureCallback = std::function<void(const CaptureInfo&)>;
+
+    TriggerCapture();
+    ~TriggerCapture();
+
+    TriggerCapture(const TriggerCapture&) = delete;
+    TriggerCapture& operator=(const TriggerCapture&) = delete;
+
+    bool start(const TriggerCaptureConfig& config = TriggerCaptureConfig());
+
+    /**
+     * @brief Stop capturing; an armed window is saved with what was captured so far
+     */
+    void stop();
+    bool isRunning() const;
+
+    /**
+     * @brief Capture every frame dispatched by a CANProtocol
+     */
+    bool attach(std::shared_ptr<protocols::CANProtocol> canProtocol);
+
+    /**
+     * @brief Capture every channel of a live data store
+     */
+    bool attach(std::shared_ptr<LiveDataStore> store);
+    void detach();
+
+    void addFrame(const protocols::CANMessage& message);
+    void addSample(const std::string& parameter, double value);
+    void addSample(const std::string& parameter, double value, int64_t timestampNs);
+
+    /**
+     * @brief Report a DTC status; triggers when the DTC becomes active
+     */
+    void reportDTC(const std::string& code, uint8_t status);
+
+    /**
+     * @brief Trigger by hand
+     * @return false if not running or too many windows are waiting for disk
+     */
+    bool trigger(const std::string& reason = "manual");
+
+    /**
+     * @brief Called on a pool thread after each window is written
+     */
+    void setCaptureCallback(CaptureCallback callback);
+
+    /**
+     * @brief Wait until no window is armed or being written
+     * @return false on timeout
+     */
+    bool waitForIdle(uint32_t timeout);
+
+    /**
+     * @brief Get capture statistics
+     */
+    struct Statistics {
+        uint64_t framesCaptured = 0;
+        uint64_t samplesCaptured = 0;
+        uint64_t triggers = 0;
+        uint64_t triggersIgnored = 0;           ///< Too many windows waiting for disk
+        uint64_t capturesWritten = 0;
+        uint64_t captureFailures = 0;
+        uint64_t framesLost = 0;                ///< Overwritten before a window was copied
+        std::chrono::system_clock::time_point startTime;
+    };
+
+    Statistics getStatistics() const;
+
+    std::string toString() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+// Utility functions
+FMUS_AUTO_API std::string captureTriggerToString(CaptureTrigger trigger);
+
+} // namespace trace
+} // namespace fmus
+
+#endif // FMUS_TRACE_TRIGGER_CAPTURE_H
@@ -0,0 +1,264 @@
+#include <fmus/live_data_store.h>
+#include <fmus/logger.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <sstream>
+
+namespace fmus {
+
+namespace {
+
+/**
+ * Ring slot guarded by a sequence stamp: odd while being written, 2n+2 once
+ * sample n is complete. Fields are atomics so torn reads are detected rather
+ * than undefined.
+ */
+struct Slot {
+    std::atomic<uint64_t> stamp{0};
+    std::atomic<int64_t> timestampUs{0};
+    std::atomic<double> value{0.0};
+};
+
+struct Channel {
+    std::string name;
+    std::string unit;
+    std::unique_ptr<Slot[]> ring;
+    alignas(64) std::atomic<uint64_t> head{0};  ///< Samples published
+};
+
+size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 2;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+class LiveDataStore::Impl {
+public:
+    using NameIndex = std::unordered_map<std::string, ChannelId>;
+
+    size_t capacity;
+    size_t mask;
+    size_t maxChannels;
+
+    std::unique_ptr<std::unique_ptr<Channel>[]> channels;
+    std::atomic<size_t> channelCount{0};
+
+    std::mutex addMutex;
+    std::shared_ptr<const NameIndex> names = std::make_shared<NameIndex>();
+
+    mutable std::atomic<uint64_t> samplesOverwritten{0};
+    mutable std::atomic<uint64_t> readRetries{0};
+    std::atomic<uint64_t> publishedBaseline{0};
+
+    Impl(size_t historyCapacity, size_t channelLimit)
+        : capacity(roundUpToPowerOfTwo(historyCapacity)),
+          mask(capacity - 1),
+          maxChannels(channelLimit),
+          channels(new std::unique_ptr<Channel>[channelLimit]) {}
+
+    Channel* get(ChannelId id) const {
+        if (id >= channelCount.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return channels[id].get();
+    }
+
+    /**
+     * Copy sample n if the slot still holds it.
+     */
+    bool readSlot(const Channel& channel, uint64_t n, LiveSample& sample) const {
+        const Slot& slot = channel.ring[n & mask];
+        uint64_t expected = 2 * n + 2;
+
+        uint64_t before = slot.stamp.load(std::memory_order_acquire);
+        if (before != expected) {
+            return false;
+        }
+        sample.timestampUs = slot.timestampUs.load(std::memory_order_relaxed);
+        sample.value = slot.value.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.stamp.load(std::memory_order_relaxed) == expected;
+    }
+};
+
+LiveDataStore::LiveDataStore(size_t historyCapacity, size_t maxChannels)
+    : pImpl(std::make_unique<Impl>(historyCapacity, maxChannels)) {}
+
+LiveDataStore::~LiveDataStore() = default;
+
+LiveDataStore::ChannelId LiveDataStore::addChannel(const std::string& name, const std::string& unit) {
+    std::lock_guard<std::mutex> lock(pImpl->addMutex);
+
+    auto current = std::atomic_load(&pImpl->names);
+    auto it = current->find(name);
+    if (it != current->end()) {
+        return it->second;
+    }
+
+    size_t id = pImpl->channelCount.load(std::memory_order_relaxed);
+    if (id >= pImpl->maxChannels) {
+        Logger::getInstance()->warning("Live data store full, cannot add channel '" + name + "'");
+        return INVALID_CHANNEL;
+    }
+
+    auto channel = std::make_unique<Channel>();
+    channel->name = name;
+    channel->unit = unit;
+    channel->ring.reset(new Slot[pImpl->capacity]);
+    pImpl->channels[id] = std::move(channel);
+    pImpl->channelCount.store(id + 1, std::memory_order_release);
+
+    auto updated = std::make_shared<Impl::NameIndex>(*current);
+    (*updated)[name] = static_cast<ChannelId>(id);
+    std::atomic_store(&pImpl->names, std::shared_ptr<const Impl::NameIndex>(std::move(updated)));
+
+    return static_cast<ChannelId>(id);
+}
+
+LiveDataStore::ChannelId LiveDataStore::findChannel(const std::string& name) const {
+    auto current = std::atomic_load(&pImpl->names);
+    auto it = current->find(name);
+    return it != current->end() ? it->second : INVALID_CHANNEL;
+}
+
+size_t LiveDataStore::getChannelCount() const {
+    return pImpl->channelCount.load(std::memory_order_acquire);
+}
+
+std::string LiveDataStore::getChannelName(ChannelId id) const {
+    Channel* channel = pImpl->get(id);
+    return channel ? channel->name : "";
+}
+
+std::string LiveDataStore::getChannelUnit(ChannelId id) const {
+    Channel* channel = pImpl->get(id);
+    return channel ? channel->unit : "";
+}
+
+size_t LiveDataStore::getHistoryCapacity() const {
+    return pImpl->capacity;
+}
+
+void LiveDataStore::publish(ChannelId id, double value) {
+    publish(id, value, now());
+}
+
+void LiveDataStore::publish(ChannelId id, double value, int64_t timestampUs) {
+    Channel* channel = pImpl->get(id);
+    if (!channel) {
+        return;
+    }
+
+    uint64_t n = channel->head.load(std::memory_order_relaxed);
+    Slot& slot = channel->ring[n & pImpl->mask];
+
+    slot.stamp.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timestampUs.store(timestampUs, std::memory_order_relaxed);
+    slot.value.store(value, std::memory_order_relaxed);
+    slot.stamp.store(2 * n + 2, std::memory_order_release);
+
+    channel->head.store(n + 1, std::memory_order_release);
+}
+
+bool LiveDataStore::publish(const std::string& name, double value) {
+    ChannelId id = findChannel(name);
+    if (id == INVALID_CHANNEL) {
+        return false;
+    }
+    publish(id, value);
+    return true;
+}
+
+uint64_t LiveDataStore::getSequence(ChannelId id) const {
+    Channel* channel = pImpl->get(id);
+    return channel ? channel->head.load(std::memory_order_acquire) : 0;
+}
+
+bool LiveDataStore::readLatest(ChannelId id, LiveSample& sample, uint64_t* sequence) const {
+    Channel* channel = pImpl->get(id);
+    if (!channel) {
+        return false;
+    }
+
+    for (;;) {
+        uint64_t head = channel->head.load(std::memory_order_acquire);
+        if (head == 0) {
+            return false;
+        }
+        if (pImpl->readSlot(*channel, head - 1, sample)) {
+            if (sequence) {
+                *sequence = head;
+            }
+            return true;
+        }
+        // The writer lapped the whole ring while we read; try the newer head
+        pImpl->readRetries.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+uint64_t LiveDataStore::readHistory(ChannelId id, uint64_t fromSequence, std::vector<LiveSample>& samples) const {
+    Channel* channel = pImpl->get(id);
+    if (!channel) {
+        return fromSequence;
+    }
+
+    uint64_t head = channel->head.load(std::memory_order_acquire);
+    uint64_t oldest = head > pImpl->capacity ? head - pImpl->capacity : 0;
+    if (fromSequence < oldest) {
+        pImpl->samplesOverwritten.fetch_add(oldest - fromSequence, std::memory_order_relaxed);
+        fromSequence = oldest;
+    }
+
+    LiveSample sample;
+    for (uint64_t n = fromSequence; n < head; ++n) {
+        if (pImpl->readSlot(*channel, n, sample)) {
+            samples.push_back(sample);
+        } else {
+            pImpl->samplesOverwritten.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    return head;
+}
+
+int64_t LiveDataStore::now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+LiveDataStore::Statistics LiveDataStore::getStatistics() const {
+    Statistics stats;
+    stats.channels = static_cast<uint32_t>(getChannelCount());
+    for (ChannelId id = 0; id < stats.channels; ++id) {
+        stats.samplesPublished += getSequence(id);
+    }
+    stats.samplesPublished -= std::min(stats.samplesPublished, pImpl->publishedBaseline.load());
+    stats.samplesOverwritten = pImpl->samplesOverwritten.load(std::memory_order_relaxed);
+    stats.readRetries = pImpl->readRetries.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void LiveDataStore::resetStatistics() {
+    uint64_t published = 0;
+    for (ChannelId id = 0; id < getChannelCount(); ++id) {
+        published += getSequence(id);
+    }
+    pImpl->publishedBaseline = published;
+    pImpl->samplesOverwritten = 0;
+    pImpl->readRetries = 0;
+}
+
+std::string LiveDataStore::toString() const {
+    std::ostringstream oss;
+    oss << "LiveDataStore[Channels:" << getChannelCount()
+        << ", History:" << pImpl->capacity << "]";
+    return oss.str();
+}
+
+} // namespace fmus
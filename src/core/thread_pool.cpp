@@ -7,6 +7,9 @@ namespace fmus {
 static std::shared_ptr<ThreadPool> globalThreadPool = nullptr;
 static std::mutex globalThreadPoolMutex;
 
+// Pool owning the current worker thread, if any
+static thread_local const ThreadPool* currentThreadPool = nullptr;
+
 ThreadPool::ThreadPool(size_t threads) 
     : stop_flag(false), activeTasks(0) {
     
@@ -24,6 +27,7 @@ ThreadPool::ThreadPool(size_t threads)
     // Create worker threads
     for (size_t i = 0; i < threads; ++i) {
         workers.emplace_back([this] {
+            currentThreadPool = this;
             for (;;) {
                 std::function<void()> task;
                 
@@ -78,6 +82,10 @@ size_t ThreadPool::getPendingTaskCount() const {
     return tasks.size() + activeTasks;
 }
 
+bool ThreadPool::isWorkerThread() const {
+    return currentThreadPool == this;
+}
+
 bool ThreadPool::isStopping() const {
     std::unique_lock<std::mutex> lock(queueMutex);
     return stop_flag;
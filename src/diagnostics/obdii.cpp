@@ -2,6 +2,7 @@
 #include <fmus/logger.h>
 #include <fmus/utils.h>
 #include <fmus/thread_pool.h>
+#include <fmus/plugins/extension_points.h>
 #include <sstream>
 #include <iomanip>
 #include <thread>
@@ -211,7 +212,8 @@ std::string OBDConfig::toString() const {
 class OBDClient::Impl {
 public:
     OBDConfig config;
-    std::shared_ptr<protocols::CANProtocol> canProtocol;
+    std::shared_ptr<protocols::DiagnosticTransport> transport;
+    bool ownsTransport = false;
     std::atomic<bool> initialized{false};
     std::atomic<bool> monitoring{false};
     
@@ -260,46 +262,65 @@ public:
         }
     }
     
-    void onCANMessage(const protocols::CANMessage& canMsg) {
-        // Check if this is a response to our request
-        bool isResponse = false;
-        if (canMsg.id == config.responseId) {
-            isResponse = true;
-        } else {
-            // Check if it's from any of the configured ECU IDs
-            for (uint32_t ecuId : config.ecuIds) {
-                if (canMsg.id == ecuId) {
-                    isResponse = true;
-                    break;
-                }
-            }
-        }
-        
-        if (!isResponse || canMsg.data.size() < 2) {
-            return;
-        }
-        
+    void onPDU(const uint8_t* data, size_t length) {
         // Check if it's a positive response (mode + 0x40)
-        uint8_t responseMode = canMsg.data[0];
-        if (responseMode < 0x40) {
-            return; // Not a positive response
+        if (length < 2 || data[0] < 0x40) {
+            return;
         }
         
         std::lock_guard<std::mutex> lock(requestMutex);
-        pendingResponse = canMsg.data;
+        pendingResponse.assign(data, data + length);
         responseReceived = true;
         responseCondition.notify_one();
     }
     
+    void detach() {
+        if (!transport) {
+            return;
+        }
+        transport->setReceiveHandler(nullptr);
+        if (ownsTransport) {
+            transport->close();
+        }
+        transport.reset();
+    }
+    
+    bool attach(const OBDConfig& newConfig, std::shared_ptr<protocols::DiagnosticTransport> newTransport,
+                bool owned) {
+        auto logger = Logger::getInstance();
+        detach();
+        config = newConfig;
+        transport = std::move(newTransport);
+        ownsTransport = owned;
+        transport->setReceiveHandler([this](uint32_t, const uint8_t* data, size_t length) {
+            onPDU(data, length);
+        });
+        if (!transport->open()) {
+            logger->error("Failed to open transport for OBD: " + transport->toString());
+            detach();
+            return false;
+        }
+        
+        initialized = true;
+        logger->info("OBD client initialized successfully");
+        return true;
+    }
+    
+    static bool modeTakesPID(OBDMode mode) {
+        return mode != OBDMode::STORED_DTCS && mode != OBDMode::CLEAR_DTCS &&
+               mode != OBDMode::PENDING_DTCS && mode != OBDMode::PERMANENT_DTCS;
+    }
+    
     std::vector<uint8_t> sendOBDRequest(OBDMode mode, uint8_t pid = 0) {
         if (!initialized) {
             return {};
         }
         
         // Prepare request
-        protocols::CANMessage request;
-        request.id = config.requestId;
-        request.data = {static_cast<uint8_t>(mode), pid};
+        std::vector<uint8_t> request = {static_cast<uint8_t>(mode)};
+        if (modeTakesPID(mode)) {
+            request.push_back(pid);
+        }
         
         {
             std::unique_lock<std::mutex> lock(requestMutex);
@@ -307,7 +328,7 @@ public:
         }
         
         // Send request
-        if (!canProtocol->sendMessage(request)) {
+        if (!transport->send(request)) {
             updateStats(true, false, true);
             return {};
         }
@@ -315,9 +336,9 @@ public:
         updateStats(true);
         
         // Wait for response
+        auto timeout = std::max(std::chrono::milliseconds(config.timeout), transport->getCapabilities().p2Timeout);
         std::unique_lock<std::mutex> lock(requestMutex);
-        bool received = responseCondition.wait_for(lock, 
-            std::chrono::milliseconds(config.timeout),
+        bool received = responseCondition.wait_for(lock, timeout,
             [this] { return responseReceived; });
         
         if (!received) {
@@ -372,7 +393,10 @@ public:
 
 OBDClient::OBDClient() : pImpl(std::make_unique<Impl>()) {}
 
-OBDClient::~OBDClient() = default;
+OBDClient::~OBDClient() {
+    pImpl->stopMonitoring();
+    pImpl->detach();
+}
 
 bool OBDClient::initialize(const OBDConfig& config, std::shared_ptr<protocols::CANProtocol> canProtocol) {
     auto logger = Logger::getInstance();
@@ -383,20 +407,29 @@ bool OBDClient::initialize(const OBDConfig& config, std::shared_ptr<protocols::C
         return false;
     }
     
-    pImpl->config = config;
-    pImpl->canProtocol = canProtocol;
+    protocols::IsoTpConfig isoTp;
+    isoTp.txId = config.requestId;
+    isoTp.rxId = config.responseId;
+    isoTp.extendedIds = config.useExtendedIds;
+    for (uint32_t ecuId : config.ecuIds) {
+        if (ecuId != config.responseId) {
+            isoTp.extraRxIds.push_back(ecuId);
+        }
+    }
     
-    // Start monitoring CAN messages for responses
-    if (!pImpl->canProtocol->startMonitoring([this](const protocols::CANMessage& msg) {
-        pImpl->onCANMessage(msg);
-    })) {
-        logger->error("Failed to start CAN monitoring for OBD");
+    return pImpl->attach(config, std::make_shared<protocols::IsoTpTransport>(canProtocol, isoTp), true);
+}
+
+bool OBDClient::initialize(const OBDConfig& config, std::shared_ptr<protocols::DiagnosticTransport> transport) {
+    auto logger = Logger::getInstance();
+    logger->info("Initializing OBD client: " + config.toString());
+    
+    if (!transport) {
+        logger->error("No transport for OBD");
         return false;
     }
     
-    pImpl->initialized = true;
-    logger->info("OBD client initialized successfully");
-    return true;
+    return pImpl->attach(config, std::move(transport), false);
 }
 
 void OBDClient::shutdown() {
@@ -404,11 +437,8 @@ void OBDClient::shutdown() {
         stopMonitoring();
     }
     
-    if (pImpl->canProtocol && pImpl->canProtocol->isMonitoring()) {
-        pImpl->canProtocol->stopMonitoring();
-    }
-    
     pImpl->initialized = false;
+    pImpl->detach();
     
     auto logger = Logger::getInstance();
     logger->info("OBD client shutdown");
@@ -465,7 +495,19 @@ OBDParameter OBDClient::readParameter(OBDPID pid) {
     auto response = pImpl->sendOBDRequest(OBDMode::CURRENT_DATA, static_cast<uint8_t>(pid));
     if (response.size() >= 3 && response[0] == 0x41 && response[1] == static_cast<uint8_t>(pid)) {
         param.rawData.assign(response.begin() + 2, response.end());
-        param.calculateValue();
+
+        // A plugin decoder for this PID takes precedence over the built-in formulas
+        auto tables = plugins::getGlobalExtensionRegistry()->getTables();
+        plugins::DecodedValue decoded;
+        if (tables->decodePID(static_cast<uint8_t>(pid), param.rawData.data(), param.rawData.size(),
+                              &decoded, 1) > 0) {
+            param.value = decoded.value;
+            if (decoded.unit) {
+                param.unit = decoded.unit;
+            }
+        } else {
+            param.calculateValue();
+        }
     }
     
     return param;
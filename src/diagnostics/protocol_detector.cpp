@@ -0,0 +1,810 @@
+#include <fmus/diagnostics/protocol_detector.h>
+#include <fmus/protocols/kwp2000.h>
+#include <fmus/protocols/j1850.h>
+#include <fmus/logger.h>
+#include <fmus/utils.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace fmus {
+namespace diagnostics {
+
+namespace {
+
+constexpr uint32_t CAN_FUNCTIONAL_11BIT = 0x7DF;
+constexpr uint32_t CAN_FUNCTIONAL_29BIT = 0x18DB33F1;
+constexpr uint8_t OBD_INIT_ADDRESS = 0x33;
+constexpr uint8_t OBD_TESTER_ADDRESS = 0xF1;
+constexpr uint8_t KWP_START_COMMUNICATION = 0x81;
+constexpr uint8_t KWP_START_COMMUNICATION_RESPONSE = 0xC1;
+
+enum class Lane { CAN, K_LINE, J1850 };
+
+Lane laneOf(OBDProtocol protocol) {
+    switch (protocol) {
+        case OBDProtocol::KWP2000_FAST_INIT:
+        case OBDProtocol::KWP2000_5BAUD_INIT:
+        case OBDProtocol::ISO9141_2:
+            return Lane::K_LINE;
+        case OBDProtocol::J1850_VPW:
+        case OBDProtocol::J1850_PWM:
+            return Lane::J1850;
+        default:
+            return Lane::CAN;
+    }
+}
+
+bool usesFiveBaudInit(OBDProtocol protocol) {
+    return protocol == OBDProtocol::KWP2000_5BAUD_INIT || protocol == OBDProtocol::ISO9141_2;
+}
+
+bool is29Bit(OBDProtocol protocol) {
+    return protocol == OBDProtocol::CAN_29BIT_500K || protocol == OBDProtocol::CAN_29BIT_250K;
+}
+
+uint32_t baudRateOf(OBDProtocol protocol) {
+    switch (protocol) {
+        case OBDProtocol::CAN_11BIT_500K:
+        case OBDProtocol::CAN_29BIT_500K:
+            return 500000;
+        case OBDProtocol::CAN_11BIT_250K:
+        case OBDProtocol::CAN_29BIT_250K:
+            return 250000;
+        case OBDProtocol::J1850_PWM:
+            return 41600;
+        default:
+            return 10400;
+    }
+}
+
+std::vector<OBDProtocol> allProtocols() {
+    std::vector<OBDProtocol> protocols;
+    for (size_t i = 0; i < OBD_PROTOCOL_COUNT; ++i) {
+        protocols.push_back(static_cast<OBDProtocol>(i));
+    }
+    return protocols;
+}
+
+/**
+ * What one probe learned
+ */
+struct ProbeOutcome {
+    OBDProtocol protocol = OBDProtocol::UNKNOWN;
+    std::vector<uint32_t> responders;
+    std::vector<uint8_t> keyBytes;
+};
+
+/**
+ * CAN variants probed on one channel: a single variant, or both ID widths
+ * at one bit rate on a CAN_ID_BOTH channel
+ */
+struct CANUnit {
+    std::vector<OBDProtocol> variants;
+
+    uint32_t flags() const {
+        if (variants.size() > 1) {
+            return j2534::J2534Constants::CAN_ID_BOTH;
+        }
+        return is29Bit(variants.front()) ? j2534::J2534Constants::CAN_29BIT_ID : 0;
+    }
+};
+
+} // anonymous namespace
+
+// DetectionResult implementation
+std::string DetectionResult::toString() const {
+    std::ostringstream ss;
+    ss << "DetectionResult[" << obdProtocolToString(protocol)
+       << ", Elapsed:" << elapsed.count() << "ms"
+       << ", Probed:" << probed.size();
+    if (!responders.empty()) {
+        ss << ", Responders:" << std::hex;
+        for (size_t i = 0; i < responders.size(); ++i) {
+            ss << (i ? "," : "") << "0x" << responders[i];
+        }
+        ss << std::dec;
+    }
+    if (!keyBytes.empty()) {
+        ss << ", KeyBytes:" << utils::bytesToHex(keyBytes);
+    }
+    ss << "]";
+    return ss.str();
+}
+
+std::string DetectorConfig::toString() const {
+    std::ostringstream ss;
+    ss << "DetectorConfig[CAN:" << canTimeout.count() << "ms"
+       << ", Serial:" << serialTimeout.count() << "ms"
+       << ", KLineDelay:" << kLineDelay.count() << "ms"
+       << ", Parallel:" << (parallel ? "yes" : "no");
+    if (!region.empty()) {
+        ss << ", Region:" << region;
+    }
+    if (!candidates.empty()) {
+        ss << ", Candidates:" << candidates.size();
+    }
+    ss << "]";
+    return ss.str();
+}
+
+// ProtocolPriors implementation
+class ProtocolPriors::Impl {
+public:
+    mutable std::mutex mutex;
+    std::map<std::string, OBDProtocol> vinCache;
+    std::map<std::string, std::array<uint32_t, OBD_PROTOCOL_COUNT>> regionCounts;
+};
+
+ProtocolPriors::ProtocolPriors() : pImpl(std::make_unique<Impl>()) {}
+
+ProtocolPriors::~ProtocolPriors() = default;
+
+void ProtocolPriors::record(const std::string& vin, const std::string& region, OBDProtocol protocol) {
+    if (protocol == OBDProtocol::UNKNOWN) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    if (!vin.empty()) {
+        pImpl->vinCache[vin] = protocol;
+    }
+    auto& counts = pImpl->regionCounts[region];
+    counts[static_cast<size_t>(protocol)]++;
+}
+
+OBDProtocol ProtocolPriors::lookup(const std::string& vin) const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    auto it = pImpl->vinCache.find(vin);
+    return it != pImpl->vinCache.end() ? it->second : OBDProtocol::UNKNOWN;
+}
+
+std::array<uint32_t, OBD_PROTOCOL_COUNT> ProtocolPriors::getRegionCounts(const std::string& region) const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    auto it = pImpl->regionCounts.find(region);
+    if (it == pImpl->regionCounts.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+std::vector<OBDProtocol> ProtocolPriors::order(std::vector<OBDProtocol> candidates,
+                                               const std::string& vin, const std::string& region) const {
+    OBDProtocol cached = vin.empty() ? OBDProtocol::UNKNOWN : lookup(vin);
+    auto counts = getRegionCounts(region);
+
+    std::stable_sort(candidates.begin(), candidates.end(), [&](OBDProtocol a, OBDProtocol b) {
+        if ((a == cached) != (b == cached)) {
+            return a == cached;
+        }
+        return counts[static_cast<size_t>(a)] > counts[static_cast<size_t>(b)];
+    });
+    return candidates;
+}
+
+bool ProtocolPriors::loadFromFile(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file) {
+        return false;
+    }
+
+    std::map<std::string, OBDProtocol> vinCache;
+    std::map<std::string, std::array<uint32_t, OBD_PROTOCOL_COUNT>> regionCounts;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream in(line);
+        std::string kind;
+        if (!(in >> kind) || kind[0] == '#') {
+            continue;
+        }
+        if (kind == "vin") {
+            std::string vin, name;
+            if (in >> vin >> name) {
+                OBDProtocol protocol = stringToOBDProtocol(name);
+                if (protocol != OBDProtocol::UNKNOWN) {
+                    vinCache[vin] = protocol;
+                }
+            }
+        } else if (kind == "region") {
+            std::string region;
+            in >> region;
+            if (region == "-") {
+                region.clear();
+            }
+            auto& counts = regionCounts[region];
+            for (auto& count : counts) {
+                if (!(in >> count)) {
+                    break;
+                }
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->vinCache = std::move(vinCache);
+    pImpl->regionCounts = std::move(regionCounts);
+    return true;
+}
+
+bool ProtocolPriors::saveToFile(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    file << "# FMUS-AUTO protocol priors\n";
+    for (const auto& entry : pImpl->vinCache) {
+        file << "vin " << entry.first << " " << obdProtocolToString(entry.second) << "\n";
+    }
+    for (const auto& entry : pImpl->regionCounts) {
+        file << "region " << (entry.first.empty() ? "-" : entry.first);
+        for (uint32_t count : entry.second) {
+            file << " " << count;
+        }
+        file << "\n";
+    }
+    return static_cast<bool>(file);
+}
+
+void ProtocolPriors::clear() {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->vinCache.clear();
+    pImpl->regionCounts.clear();
+}
+
+// ProtocolDetector implementation
+class ProtocolDetector::Impl {
+public:
+    std::shared_ptr<j2534::PassThruDevice> device;
+    std::shared_ptr<ProtocolPriors> priors;
+    DetectorConfig config;
+    mutable std::mutex configMutex;
+
+    // Serializes detect() calls
+    std::mutex detectMutex;
+
+    // State of the run in progress
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> found{false};
+    std::atomic<bool> fiveBaudInitDone{false};
+    std::mutex stopMutex;
+    std::condition_variable stopCondition;
+    std::mutex resultMutex;
+    DetectionResult result;
+    std::deque<OBDProtocol> deferred;
+
+    Statistics stats;
+    mutable std::mutex statsMutex;
+
+    bool stopRequested() const {
+        return found || cancelled;
+    }
+
+    void requestStop() {
+        {
+            std::lock_guard<std::mutex> lock(stopMutex);
+        }
+        stopCondition.notify_all();
+    }
+
+    void waitOrStop(std::chrono::milliseconds delay) {
+        std::unique_lock<std::mutex> lock(stopMutex);
+        stopCondition.wait_for(lock, delay, [this] { return stopRequested(); });
+    }
+
+    void defer(OBDProtocol protocol) {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        deferred.push_back(protocol);
+    }
+
+    /**
+     * Record a finished probe; the first success keeps its channel.
+     */
+    void finish(const std::vector<OBDProtocol>& probed, const std::shared_ptr<j2534::PassThruChannel>& channel,
+                ProbeOutcome outcome) {
+        bool keep = false;
+        {
+            std::lock_guard<std::mutex> lock(resultMutex);
+            result.probed.insert(result.probed.end(), probed.begin(), probed.end());
+            if (outcome.protocol != OBDProtocol::UNKNOWN && !found) {
+                found = true;
+                keep = true;
+                result.protocol = outcome.protocol;
+                result.channel = channel;
+                result.responders = std::move(outcome.responders);
+                result.keyBytes = std::move(outcome.keyBytes);
+            }
+        }
+
+        if (keep) {
+            Logger::getInstance()->info("Detected " + obdProtocolToString(result.protocol));
+            requestStop();
+        } else if (channel) {
+            try {
+                channel->disconnect();
+            } catch (const j2534::J2534Error& e) {
+                Logger::getInstance()->warning(std::string("Failed to close probe channel: ") + e.what());
+            }
+        }
+    }
+
+    std::shared_ptr<j2534::PassThruChannel> open(OBDProtocol protocol, uint32_t flags) {
+        return device->connect(obdProtocolToJ2534(protocol), flags, baudRateOf(protocol));
+    }
+
+    // Wait for messages until the predicate accepts one or the deadline passes
+    template <typename Predicate>
+    void readUntil(j2534::PassThruChannel& channel, std::chrono::steady_clock::time_point deadline,
+                   Predicate accept) {
+        std::vector<j2534::Message> frames;
+        for (;;) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline || stopRequested()) {
+                return;
+            }
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now);
+            frames.clear();
+            channel.readMessages(frames, 16, static_cast<uint32_t>(std::max<int64_t>(remaining.count(), 1)));
+            bool done = false;
+            for (const auto& frame : frames) {
+                done = accept(frame) || done;
+            }
+            if (done) {
+                return;
+            }
+        }
+    }
+
+    ProbeOutcome probeCAN(j2534::PassThruChannel& channel, const CANUnit& unit) {
+        ProbeOutcome outcome;
+        channel.startPassAllFilter();
+
+        // Mode $01 PID $00 as a single frame to the functional address
+        const std::vector<uint8_t> request = {0x02, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+        for (OBDProtocol variant : unit.variants) {
+            bool extended = is29Bit(variant);
+            j2534::Message message(j2534::Protocol::CAN, extended ? CAN_FUNCTIONAL_29BIT : CAN_FUNCTIONAL_11BIT,
+                                   request);
+            message.flags = extended ? j2534::J2534Constants::CAN_29BIT_ID : 0;
+            channel.writeMessage(message, 50);
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + config.canTimeout;
+        readUntil(channel, deadline, [&](const j2534::Message& frame) {
+            if (frame.flags & j2534::J2534Constants::TX_MSG_TYPE) {
+                return false;
+            }
+            if (frame.data.size() < 3 || frame.data[1] != 0x41 || frame.data[2] != 0x00) {
+                return false;
+            }
+            bool extended = frame.id > 0x7FF;
+            bool physicalReply = extended ? (frame.id & 0x1FFFFF00) == 0x18DAF100
+                                          : (frame.id >= 0x7E8 && frame.id <= 0x7EF);
+            if (!physicalReply) {
+                return false;
+            }
+            for (OBDProtocol variant : unit.variants) {
+                if (is29Bit(variant) == extended &&
+                    (outcome.protocol == OBDProtocol::UNKNOWN || outcome.protocol == variant)) {
+                    outcome.protocol = variant;
+                    outcome.responders.push_back(frame.id);
+                }
+            }
+            return outcome.protocol != OBDProtocol::UNKNOWN;
+        });
+        return outcome;
+    }
+
+    ProbeOutcome probeKLine(j2534::PassThruChannel& channel, OBDProtocol protocol) {
+        ProbeOutcome outcome;
+        try {
+            if (protocol == OBDProtocol::KWP2000_FAST_INIT) {
+                auto frame = protocols::encodeKWP2000Frame({KWP_START_COMMUNICATION}, true, true,
+                                                           OBD_INIT_ADDRESS, OBD_TESTER_ADDRESS, true, false);
+                j2534::Message response = channel.fastInit(j2534::Message(j2534::Protocol::ISO14230_4, 0, frame));
+
+                std::vector<uint8_t> payload;
+                uint8_t target = 0;
+                uint8_t source = 0;
+                if (protocols::decodeKWP2000Frame(response.data, payload, &target, &source) &&
+                    payload.size() >= 3 && payload[0] == KWP_START_COMMUNICATION_RESPONSE) {
+                    outcome.protocol = protocol;
+                    outcome.keyBytes = {payload[1], payload[2]};
+                    outcome.responders.push_back(source);
+                }
+                return outcome;
+            }
+
+            // One 5-baud init answers for both protocols that use it
+            fiveBaudInitDone = true;
+            auto keyBytes = channel.fiveBaudInit(OBD_INIT_ADDRESS);
+            if (keyBytes.size() < 2) {
+                return outcome;
+            }
+            // ISO 9141-2 ECUs answer 08 08 or 94 94; ISO 14230 ones have KB2 = 8F
+            if (keyBytes[0] == keyBytes[1] && (keyBytes[0] == 0x08 || keyBytes[0] == 0x94)) {
+                outcome.protocol = OBDProtocol::ISO9141_2;
+            } else if (keyBytes[1] == 0x8F) {
+                outcome.protocol = OBDProtocol::KWP2000_5BAUD_INIT;
+            } else {
+                Logger::getInstance()->debug("5-baud init returned unknown key bytes " + utils::bytesToHex(keyBytes));
+                return outcome;
+            }
+            outcome.keyBytes = keyBytes;
+        } catch (const j2534::J2534Error& e) {
+            // No ECU answering the init shows up as an error from the IOCTL
+            Logger::getInstance()->debug(obdProtocolToString(protocol) + " init failed: " + e.what());
+        }
+        return outcome;
+    }
+
+    ProbeOutcome probeJ1850(j2534::PassThruChannel& channel, OBDProtocol protocol) {
+        ProbeOutcome outcome;
+        channel.startPassAllFilter();
+
+        protocols::J1850Message request(OBD_TESTER_ADDRESS, protocols::J1850_FUNCTIONAL_REQUEST, {0x01, 0x00});
+        request.type = protocol == OBDProtocol::J1850_PWM ? protocols::J1850Type::PWM : protocols::J1850Type::VPW;
+        std::vector<uint8_t> frame = request.toBytes();
+        frame.pop_back();   // The adapter appends the CRC
+        channel.writeMessage(j2534::Message(obdProtocolToJ2534(protocol), 0, frame), 100);
+
+        auto deadline = std::chrono::steady_clock::now() + config.serialTimeout;
+        readUntil(channel, deadline, [&](const j2534::Message& reply) {
+            if (reply.flags & j2534::J2534Constants::TX_MSG_TYPE) {
+                return false;
+            }
+            if (reply.data.size() < 5 || reply.data[3] != 0x41 || reply.data[4] != 0x00) {
+                return false;
+            }
+            outcome.protocol = protocol;
+            outcome.responders.push_back(reply.data[2]);
+            return true;
+        });
+        return outcome;
+    }
+
+    /**
+     * Move an initialized K-line session to a channel with the framing the
+     * key bytes call for; the ECU stays awake for P3max in between.
+     */
+    std::shared_ptr<j2534::PassThruChannel> reopen(std::shared_ptr<j2534::PassThruChannel> channel,
+                                                   OBDProtocol protocol) {
+        channel->disconnect();
+        channel.reset();
+        try {
+            return open(protocol, 0);
+        } catch (const j2534::J2534Error& e) {
+            Logger::getInstance()->debug("Cannot reopen as " + obdProtocolToString(protocol) + ": " + e.what());
+            return nullptr;
+        }
+    }
+
+    void runSingle(OBDProtocol protocol, bool deferOnConflict) {
+        if (stopRequested()) {
+            return;
+        }
+        if (usesFiveBaudInit(protocol) && fiveBaudInitDone) {
+            return;
+        }
+
+        std::shared_ptr<j2534::PassThruChannel> channel;
+        try {
+            channel = open(protocol, is29Bit(protocol) ? j2534::J2534Constants::CAN_29BIT_ID : 0);
+        } catch (const j2534::J2534Error& e) {
+            if (deferOnConflict) {
+                defer(protocol);
+            } else {
+                Logger::getInstance()->debug("Cannot open " + obdProtocolToString(protocol) + ": " + e.what());
+            }
+            return;
+        }
+
+        ProbeOutcome outcome;
+        try {
+            switch (laneOf(protocol)) {
+                case Lane::CAN:
+                    outcome = probeCAN(*channel, CANUnit{{protocol}});
+                    break;
+                case Lane::K_LINE:
+                    outcome = probeKLine(*channel, protocol);
+                    break;
+                case Lane::J1850:
+                    outcome = probeJ1850(*channel, protocol);
+                    break;
+            }
+        } catch (const j2534::J2534Error& e) {
+            Logger::getInstance()->debug(obdProtocolToString(protocol) + " probe failed: " + e.what());
+        }
+        if (outcome.protocol != OBDProtocol::UNKNOWN &&
+            obdProtocolToJ2534(outcome.protocol) != channel->getProtocol()) {
+            channel = reopen(std::move(channel), outcome.protocol);
+            if (!channel) {
+                outcome = ProbeOutcome{};
+            }
+        }
+        finish({protocol}, channel, std::move(outcome));
+    }
+
+    void runSerialLane(const std::vector<OBDProtocol>& lane, bool deferOnConflict) {
+        for (OBDProtocol protocol : lane) {
+            runSingle(protocol, deferOnConflict);
+        }
+    }
+
+    void runCANLane(const std::vector<OBDProtocol>& lane, bool concurrent) {
+        // Pair up the ID widths of each bit rate, keeping the prior order
+        std::deque<CANUnit> pending;
+        for (OBDProtocol protocol : lane) {
+            auto partner = std::find_if(pending.begin(), pending.end(), [&](const CANUnit& unit) {
+                return unit.variants.size() == 1 && baudRateOf(unit.variants.front()) == baudRateOf(protocol);
+            });
+            if (partner != pending.end()) {
+                partner->variants.push_back(protocol);
+            } else {
+                pending.push_back(CANUnit{{protocol}});
+            }
+        }
+
+        while (!pending.empty() && !stopRequested()) {
+            std::vector<std::pair<CANUnit, std::shared_ptr<j2534::PassThruChannel>>> opened;
+            std::deque<CANUnit> next;
+
+            for (auto& unit : pending) {
+                if (!opened.empty() && !concurrent) {
+                    next.push_back(unit);
+                    continue;
+                }
+                try {
+                    opened.emplace_back(unit, open(unit.variants.front(), unit.flags()));
+                } catch (const j2534::J2534Error& e) {
+                    if (!opened.empty()) {
+                        next.push_back(unit);   // Adapter busy with other probes; retry next round
+                    } else if (unit.variants.size() > 1) {
+                        for (OBDProtocol variant : unit.variants) {
+                            next.push_back(CANUnit{{variant}});
+                        }
+                    } else {
+                        Logger::getInstance()->debug("Cannot open " + obdProtocolToString(unit.variants.front()) +
+                                                     ": " + e.what());
+                    }
+                }
+            }
+
+            auto probe = [this](const CANUnit& unit, const std::shared_ptr<j2534::PassThruChannel>& channel) {
+                ProbeOutcome outcome;
+                try {
+                    outcome = probeCAN(*channel, unit);
+                } catch (const j2534::J2534Error& e) {
+                    Logger::getInstance()->debug("CAN probe failed: " + std::string(e.what()));
+                }
+                finish(unit.variants, channel, std::move(outcome));
+            };
+
+            if (opened.size() == 1) {
+                probe(opened.front().first, opened.front().second);
+            } else {
+                std::vector<std::thread> threads;
+                for (auto& entry : opened) {
+                    threads.emplace_back(probe, entry.first, entry.second);
+                }
+                for (auto& thread : threads) {
+                    thread.join();
+                }
+            }
+            pending = std::move(next);
+        }
+    }
+
+    DetectionResult run(const std::string& vin) {
+        DetectorConfig cfg;
+        {
+            std::lock_guard<std::mutex> lock(configMutex);
+            cfg = config;
+        }
+        std::vector<OBDProtocol> candidates = cfg.candidates.empty() ? allProtocols() : cfg.candidates;
+        candidates = priors->order(candidates, vin, cfg.region);
+
+        std::vector<OBDProtocol> canLane, kLineLane, j1850Lane;
+        for (OBDProtocol protocol : candidates) {
+            switch (laneOf(protocol)) {
+                case Lane::CAN: canLane.push_back(protocol); break;
+                case Lane::K_LINE: kLineLane.push_back(protocol); break;
+                case Lane::J1850: j1850Lane.push_back(protocol); break;
+            }
+        }
+
+        // A VIN seen before is tried alone first
+        OBDProtocol cached = vin.empty() ? OBDProtocol::UNKNOWN : priors->lookup(vin);
+        if (cached != OBDProtocol::UNKNOWN &&
+            std::find(candidates.begin(), candidates.end(), cached) != candidates.end()) {
+            runSingle(cached, false);
+            if (found) {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                stats.cacheHits++;
+                return result;
+            }
+            auto drop = [cached](std::vector<OBDProtocol>& lane) {
+                lane.erase(std::remove(lane.begin(), lane.end(), cached), lane.end());
+            };
+            drop(canLane);
+            drop(kLineLane);
+            drop(j1850Lane);
+        }
+
+        bool kLineFirst = !candidates.empty() && laneOf(candidates.front()) == Lane::K_LINE;
+
+        if (cfg.parallel) {
+            std::vector<std::thread> lanes;
+            if (!canLane.empty()) {
+                lanes.emplace_back([&] { runCANLane(canLane, true); });
+            }
+            if (!j1850Lane.empty()) {
+                lanes.emplace_back([&] { runSerialLane(j1850Lane, true); });
+            }
+            if (!kLineLane.empty()) {
+                lanes.emplace_back([&] {
+                    if (!kLineFirst && !canLane.empty()) {
+                        waitOrStop(cfg.kLineDelay);
+                    }
+                    runSerialLane(kLineLane, true);
+                });
+            }
+            for (auto& lane : lanes) {
+                lane.join();
+            }
+
+            // Probes the adapter refused while other lanes held it
+            std::deque<OBDProtocol> retry;
+            {
+                std::lock_guard<std::mutex> lock(resultMutex);
+                retry.swap(deferred);
+            }
+            for (OBDProtocol protocol : retry) {
+                runSingle(protocol, false);
+            }
+        } else {
+            // Sequential: whole lanes in the order of their most likely member
+            std::vector<Lane> order;
+            for (OBDProtocol protocol : candidates) {
+                if (std::find(order.begin(), order.end(), laneOf(protocol)) == order.end()) {
+                    order.push_back(laneOf(protocol));
+                }
+            }
+            for (Lane lane : order) {
+                switch (lane) {
+                    case Lane::CAN: runCANLane(canLane, false); break;
+                    case Lane::K_LINE: runSerialLane(kLineLane, false); break;
+                    case Lane::J1850: runSerialLane(j1850Lane, false); break;
+                }
+            }
+        }
+
+        return result;
+    }
+};
+
+ProtocolDetector::ProtocolDetector(std::shared_ptr<j2534::PassThruDevice> device,
+                                   std::shared_ptr<ProtocolPriors> priors)
+    : pImpl(std::make_unique<Impl>()) {
+    pImpl->device = std::move(device);
+    pImpl->priors = priors ? std::move(priors) : std::make_shared<ProtocolPriors>();
+}
+
+ProtocolDetector::~ProtocolDetector() {
+    cancel();
+}
+
+void ProtocolDetector::setConfig(const DetectorConfig& config) {
+    std::lock_guard<std::mutex> lock(pImpl->configMutex);
+    pImpl->config = config;
+}
+
+DetectorConfig ProtocolDetector::getConfig() const {
+    std::lock_guard<std::mutex> lock(pImpl->configMutex);
+    return pImpl->config;
+}
+
+std::shared_ptr<ProtocolPriors> ProtocolDetector::getPriors() const {
+    return pImpl->priors;
+}
+
+DetectionResult ProtocolDetector::detect(const std::string& vin) {
+    auto logger = Logger::getInstance();
+    std::lock_guard<std::mutex> detectLock(pImpl->detectMutex);
+
+    if (!pImpl->device || !pImpl->device->isOpen()) {
+        logger->error("Protocol detection needs an open J2534 device");
+        pImpl->cancelled = false;
+        return DetectionResult{};
+    }
+
+    // cancelled is cleared when a run ends, so a cancel() racing ahead of this run still stops it
+    logger->info("Detecting OBD protocol: " + getConfig().toString());
+    pImpl->found = false;
+    pImpl->fiveBaudInitDone = false;
+    pImpl->result = DetectionResult{};
+    pImpl->deferred.clear();
+
+    auto start = std::chrono::steady_clock::now();
+    DetectionResult result = pImpl->run(vin);
+    pImpl->cancelled = false;
+    result.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    if (result.success()) {
+        pImpl->priors->record(vin, getConfig().region, result.protocol);
+        logger->info("Protocol detection finished: " + result.toString());
+    } else {
+        logger->warning("No OBD protocol answered after " + std::to_string(result.elapsed.count()) + "ms");
+    }
+
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    if (result.success()) {
+        pImpl->stats.detections++;
+    } else {
+        pImpl->stats.failures++;
+    }
+    pImpl->stats.lastDetectionTime = result.elapsed;
+    pImpl->stats.totalDetectionTime += result.elapsed;
+    return result;
+}
+
+void ProtocolDetector::cancel() {
+    pImpl->cancelled = true;
+    pImpl->requestStop();
+}
+
+ProtocolDetector::Statistics ProtocolDetector::getStatistics() const {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    return pImpl->stats;
+}
+
+void ProtocolDetector::resetStatistics() {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    pImpl->stats = Statistics{};
+}
+
+// Utility functions
+std::string obdProtocolToString(OBDProtocol protocol) {
+    switch (protocol) {
+        case OBDProtocol::CAN_11BIT_500K: return "CAN_11BIT_500K";
+        case OBDProtocol::CAN_29BIT_500K: return "CAN_29BIT_500K";
+        case OBDProtocol::CAN_11BIT_250K: return "CAN_11BIT_250K";
+        case OBDProtocol::CAN_29BIT_250K: return "CAN_29BIT_250K";
+        case OBDProtocol::KWP2000_FAST_INIT: return "KWP2000_FAST_INIT";
+        case OBDProtocol::KWP2000_5BAUD_INIT: return "KWP2000_5BAUD_INIT";
+        case OBDProtocol::ISO9141_2: return "ISO9141_2";
+        case OBDProtocol::J1850_VPW: return "J1850_VPW";
+        case OBDProtocol::J1850_PWM: return "J1850_PWM";
+        default: return "UNKNOWN";
+    }
+}
+
+OBDProtocol stringToOBDProtocol(const std::string& str) {
+    for (OBDProtocol protocol : allProtocols()) {
+        if (obdProtocolToString(protocol) == str) {
+            return protocol;
+        }
+    }
+    return OBDProtocol::UNKNOWN;
+}
+
+j2534::Protocol obdProtocolToJ2534(OBDProtocol protocol) {
+    switch (laneOf(protocol)) {
+        case Lane::K_LINE:
+            return protocol == OBDProtocol::ISO9141_2 ? j2534::Protocol::ISO9141 : j2534::Protocol::ISO14230_4;
+        case Lane::J1850:
+            return protocol == OBDProtocol::J1850_PWM ? j2534::Protocol::J1850PWM : j2534::Protocol::J1850VPW;
+        default:
+            return j2534::Protocol::CAN;
+    }
+}
+
+} // namespace diagnostics
+} // namespace fmus
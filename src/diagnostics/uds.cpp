@@ -2,16 +2,26 @@
 #include <fmus/logger.h>
 #include <fmus/utils.h>
 #include <fmus/thread_pool.h>
+#include <fmus/plugins/extension_points.h>
 #include <sstream>
 #include <iomanip>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <algorithm>
+#include <array>
 
 namespace fmus {
 namespace diagnostics {
 
+namespace {
+
+// Values accepted from one plugin DID decoder call
+constexpr size_t MAX_DECODED_VALUES = 32;
+
+} // anonymous namespace
+
 // UDSMessage implementation
 protocols::CANMessage UDSMessage::toCANMessage(uint32_t requestId) const {
     protocols::CANMessage canMsg;
@@ -23,42 +33,52 @@ protocols::CANMessage UDSMessage::toCANMessage(uint32_t requestId) const {
 }
 
 UDSMessage UDSMessage::fromCANMessage(const protocols::CANMessage& canMsg) {
+    UDSMessage udsMsg = fromBytes(canMsg.data.data(), canMsg.data.size());
+    udsMsg.timestamp = canMsg.timestamp;
+    return udsMsg;
+}
+
+std::vector<uint8_t> UDSMessage::toBytes() const {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(data.size() + 1);
+    bytes.push_back(static_cast<uint8_t>(service));
+    bytes.insert(bytes.end(), data.begin(), data.end());
+    return bytes;
+}
+
+UDSMessage UDSMessage::fromBytes(const uint8_t* bytes, size_t length) {
     UDSMessage udsMsg;
+    udsMsg.timestamp = std::chrono::system_clock::now();
     
-    if (canMsg.data.empty()) {
+    if (length == 0) {
         return udsMsg;
     }
     
-    uint8_t serviceId = canMsg.data[0];
+    uint8_t serviceId = bytes[0];
     
     // Check for negative response
     if (serviceId == 0x7F) {
         udsMsg.isNegativeResponse = true;
-        if (canMsg.data.size() >= 3) {
-            udsMsg.service = static_cast<UDSService>(canMsg.data[1]);
-            udsMsg.negativeResponseCode = static_cast<UDSNegativeResponse>(canMsg.data[2]);
+        if (length >= 3) {
+            udsMsg.service = static_cast<UDSService>(bytes[1]);
+            udsMsg.negativeResponseCode = static_cast<UDSNegativeResponse>(bytes[2]);
         }
-        if (canMsg.data.size() > 3) {
-            udsMsg.data.assign(canMsg.data.begin() + 3, canMsg.data.end());
+        if (length > 3) {
+            udsMsg.data.assign(bytes + 3, bytes + length);
         }
     }
     // Check for positive response
     else if (serviceId >= 0x40 && serviceId <= 0x7E) {
         udsMsg.isResponse = true;
         udsMsg.service = static_cast<UDSService>(serviceId - 0x40);
-        if (canMsg.data.size() > 1) {
-            udsMsg.data.assign(canMsg.data.begin() + 1, canMsg.data.end());
-        }
+        udsMsg.data.assign(bytes + 1, bytes + length);
     }
     // Request message
     else {
         udsMsg.service = static_cast<UDSService>(serviceId);
-        if (canMsg.data.size() > 1) {
-            udsMsg.data.assign(canMsg.data.begin() + 1, canMsg.data.end());
-        }
+        udsMsg.data.assign(bytes + 1, bytes + length);
     }
     
-    udsMsg.timestamp = canMsg.timestamp;
     return udsMsg;
 }
 
@@ -107,7 +127,8 @@ std::string UDSConfig::toString() const {
 class UDSClient::Impl {
 public:
     UDSConfig config;
-    std::shared_ptr<protocols::CANProtocol> canProtocol;
+    std::shared_ptr<protocols::DiagnosticTransport> transport;
+    bool ownsTransport = false;
     UDSSession currentSession = UDSSession::DEFAULT;
     std::atomic<bool> initialized{false};
     
@@ -157,23 +178,57 @@ public:
         lastError.hasError = false;
     }
     
-    void onCANMessage(const protocols::CANMessage& canMsg) {
-        if (canMsg.id != config.responseId) {
+    void onPDU(uint32_t source, const uint8_t* data, size_t length) {
+        if (source != config.responseId) {
             return;
         }
         
-        UDSMessage udsMsg = UDSMessage::fromCANMessage(canMsg);
+        UDSMessage udsMsg = UDSMessage::fromBytes(data, length);
         
         std::lock_guard<std::mutex> lock(requestMutex);
-        pendingResponse = udsMsg;
+        pendingResponse = std::move(udsMsg);
         responseReceived = true;
         responseCondition.notify_one();
     }
+    
+    void detach() {
+        if (!transport) {
+            return;
+        }
+        transport->setReceiveHandler(nullptr);
+        if (ownsTransport) {
+            transport->close();
+        }
+        transport.reset();
+    }
+    
+    bool attach(const UDSConfig& newConfig, std::shared_ptr<protocols::DiagnosticTransport> newTransport,
+                bool owned) {
+        auto logger = Logger::getInstance();
+        detach();
+        config = newConfig;
+        transport = std::move(newTransport);
+        ownsTransport = owned;
+        transport->setReceiveHandler([this](uint32_t source, const uint8_t* data, size_t length) {
+            onPDU(source, data, length);
+        });
+        if (!transport->open()) {
+            logger->error("Failed to open transport for UDS: " + transport->toString());
+            detach();
+            return false;
+        }
+        
+        initialized = true;
+        logger->info("UDS client initialized on " + transport->getCapabilities().toString());
+        return true;
+    }
 };
 
 UDSClient::UDSClient() : pImpl(std::make_unique<Impl>()) {}
 
-UDSClient::~UDSClient() = default;
+UDSClient::~UDSClient() {
+    pImpl->detach();
+}
 
 bool UDSClient::initialize(const UDSConfig& config, std::shared_ptr<protocols::CANProtocol> canProtocol) {
     auto logger = Logger::getInstance();
@@ -184,28 +239,43 @@ bool UDSClient::initialize(const UDSConfig& config, std::shared_ptr<protocols::C
         return false;
     }
     
-    pImpl->config = config;
-    pImpl->canProtocol = canProtocol;
+    protocols::IsoTpConfig isoTp;
+    isoTp.txId = config.requestId;
+    isoTp.rxId = config.responseId;
+    isoTp.extendedIds = !protocols::isValidCANId(config.requestId) || !protocols::isValidCANId(config.responseId);
+    isoTp.canFd = canProtocol->getConfiguration().fd;
     
-    // Start monitoring CAN messages for responses
-    if (!pImpl->canProtocol->startMonitoring([this](const protocols::CANMessage& msg) {
-        pImpl->onCANMessage(msg);
-    })) {
-        logger->error("Failed to start CAN monitoring for UDS");
+    return pImpl->attach(config, std::make_shared<protocols::IsoTpTransport>(canProtocol, isoTp), true);
+}
+
+bool UDSClient::initialize(const UDSConfig& config, std::shared_ptr<protocols::DoIPClient> doipClient) {
+    auto logger = Logger::getInstance();
+    logger->info("Initializing UDS client over DoIP: " + config.toString());
+    
+    if (!doipClient || !doipClient->isRoutingActive()) {
+        logger->error("DoIP routing not active");
         return false;
     }
     
-    pImpl->initialized = true;
-    logger->info("UDS client initialized successfully");
-    return true;
+    return pImpl->attach(config, std::make_shared<protocols::DoIPTransport>(
+        doipClient, static_cast<uint16_t>(config.requestId)), true);
 }
 
-void UDSClient::shutdown() {
-    if (pImpl->canProtocol && pImpl->canProtocol->isMonitoring()) {
-        pImpl->canProtocol->stopMonitoring();
+bool UDSClient::initialize(const UDSConfig& config, std::shared_ptr<protocols::DiagnosticTransport> transport) {
+    auto logger = Logger::getInstance();
+    logger->info("Initializing UDS client: " + config.toString());
+    
+    if (!transport) {
+        logger->error("No transport for UDS");
+        return false;
     }
     
+    return pImpl->attach(config, std::move(transport), false);
+}
+
+void UDSClient::shutdown() {
     pImpl->initialized = false;
+    pImpl->detach();
     
     auto logger = Logger::getInstance();
     logger->info("UDS client shutdown");
@@ -215,6 +285,10 @@ bool UDSClient::isInitialized() const {
     return pImpl->initialized;
 }
 
+protocols::TransportCapabilities UDSClient::getTransportCapabilities() const {
+    return pImpl->transport ? pImpl->transport->getCapabilities() : protocols::TransportCapabilities{};
+}
+
 UDSMessage UDSClient::sendRequest(const UDSMessage& request) {
     if (!pImpl->initialized) {
         UDSMessage errorResponse;
@@ -226,17 +300,14 @@ UDSMessage UDSClient::sendRequest(const UDSMessage& request) {
     auto logger = Logger::getInstance();
     logger->debug("Sending UDS request: " + request.toString());
     
-    // Convert to CAN message and send
-    auto canMsg = request.toCANMessage(pImpl->config.requestId);
-    
     {
         std::unique_lock<std::mutex> lock(pImpl->requestMutex);
         pImpl->responseReceived = false;
     }
     
-    if (!pImpl->canProtocol->sendMessage(canMsg)) {
+    if (!pImpl->transport->send(request.toBytes())) {
         logger->error("Failed to send UDS request");
-        pImpl->setLastError(UDSNegativeResponse::GENERAL_REJECT, "Failed to send CAN message");
+        pImpl->setLastError(UDSNegativeResponse::GENERAL_REJECT, "Failed to send request");
         
         UDSMessage errorResponse;
         errorResponse.isNegativeResponse = true;
@@ -246,11 +317,24 @@ UDSMessage UDSClient::sendRequest(const UDSMessage& request) {
     
     pImpl->updateStats(true);
     
-    // Wait for response
+    // Wait for response, at least as long as the transport needs, and
+    // restart the wait with P2* on each response-pending NRC
+    auto caps = pImpl->transport->getCapabilities();
+    auto timeout = std::max(std::chrono::milliseconds(pImpl->config.timeout), caps.p2Timeout);
+    auto pendingTimeout = std::max(std::chrono::milliseconds(pImpl->config.p2StarClientMax), caps.p2StarTimeout);
+    
     std::unique_lock<std::mutex> lock(pImpl->requestMutex);
-    bool received = pImpl->responseCondition.wait_for(lock, 
-        std::chrono::milliseconds(pImpl->config.timeout),
-        [this] { return pImpl->responseReceived; });
+    bool received = false;
+    for (;;) {
+        received = pImpl->responseCondition.wait_for(lock, timeout,
+            [this] { return pImpl->responseReceived; });
+        if (!received || !pImpl->pendingResponse.isNegativeResponse ||
+            pImpl->pendingResponse.negativeResponseCode != UDSNegativeResponse::REQUEST_CORRECTLY_RECEIVED_RESPONSE_PENDING) {
+            break;
+        }
+        pImpl->responseReceived = false;
+        timeout = pendingTimeout;
+    }
     
     if (!received) {
         logger->warning("UDS request timeout");
@@ -345,6 +429,33 @@ bool UDSClient::unlockSecurityAccess(uint8_t level, const std::vector<uint8_t>&
     return sendKey(level, key);
 }
 
+bool UDSClient::unlockSecurityAccess(uint8_t level) {
+    const std::string& algorithm = pImpl->config.securityAlgorithm;
+    auto tables = plugins::getGlobalExtensionRegistry()->getTables();
+    if (algorithm.empty() || !tables->findSecurityAlgorithm(algorithm)) {
+        Logger::getInstance()->error("No security algorithm registered as '" + algorithm + "'");
+        return false;
+    }
+
+    auto seed = requestSeed(level);
+    if (seed.empty()) {
+        return false;
+    }
+
+    // An all-zero seed means the level is already unlocked
+    if (std::all_of(seed.begin(), seed.end(), [](uint8_t b) { return b == 0; })) {
+        return true;
+    }
+
+    std::vector<uint8_t> key;
+    if (!tables->computeKey(algorithm, level, seed, key)) {
+        Logger::getInstance()->error("Security algorithm '" + algorithm + "' rejected the seed");
+        return false;
+    }
+
+    return sendKey(level, key);
+}
+
 // Tester Present (0x3E)
 bool UDSClient::sendTesterPresent(bool suppressResponse) {
     uint8_t subFunction = suppressResponse ? 0x80 : 0x00;
@@ -383,6 +494,34 @@ std::map<uint16_t, std::vector<uint8_t>> UDSClient::readMultipleDataByIdentifier
     return results;
 }
 
+std::vector<UDSClient::DecodedDataValue> UDSClient::readDecodedDataByIdentifier(uint16_t dataIdentifier) {
+    std::vector<DecodedDataValue> values;
+
+    // Holding the snapshot keeps the decoder's library loaded for the whole call
+    auto tables = plugins::getGlobalExtensionRegistry()->getTables();
+    if (!tables->hasDataIdentifierDecoder(dataIdentifier)) {
+        return values;
+    }
+
+    auto data = readDataByIdentifier(dataIdentifier);
+    if (data.empty()) {
+        return values;
+    }
+
+    std::array<plugins::DecodedValue, MAX_DECODED_VALUES> decoded;
+    size_t count = tables->decodeDataIdentifier(dataIdentifier, data.data(), data.size(),
+                                                decoded.data(), decoded.size());
+    values.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        DecodedDataValue value;
+        value.name = decoded[i].name ? decoded[i].name : "";
+        value.value = decoded[i].value;
+        value.unit = decoded[i].unit ? decoded[i].unit : "";
+        values.push_back(std::move(value));
+    }
+    return values;
+}
+
 // Write Data by Identifier (0x2E)
 bool UDSClient::writeDataByIdentifier(uint16_t dataIdentifier, const std::vector<uint8_t>& data) {
     auto didBytes = utils::uint16ToBytes(dataIdentifier, true);
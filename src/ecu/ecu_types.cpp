@@ -0,0 +1,38 @@
+#include <fmus/ecu.h>
+#include <sstream>
+
+namespace fmus {
+
+// DiagnosticTroubleCode implementation
+char DiagnosticTroubleCode::getCategory() const {
+    if (code.empty()) return '?';
+    return code[0];
+}
+
+bool DiagnosticTroubleCode::isEmissionsRelated() const {
+    return getCategory() == 'P';
+}
+
+// LiveDataParameter implementation
+std::string LiveDataParameter::getValueAsString() const {
+    std::ostringstream ss;
+    std::visit([&ss](const auto& v) {
+        ss << v;
+    }, value);
+    return ss.str();
+}
+
+std::optional<double> LiveDataParameter::getValueAsNumber() const {
+    if (std::holds_alternative<int32_t>(value)) {
+        return static_cast<double>(std::get<int32_t>(value));
+    } else if (std::holds_alternative<uint32_t>(value)) {
+        return static_cast<double>(std::get<uint32_t>(value));
+    } else if (std::holds_alternative<float>(value)) {
+        return static_cast<double>(std::get<float>(value));
+    } else if (std::holds_alternative<double>(value)) {
+        return static_cast<double>(std::get<double>(value));
+    }
+    return std::nullopt;
+}
+
+} // namespace fmus
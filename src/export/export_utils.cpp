@@ -0,0 +1,68 @@
+#include <fmus/export/data_exporter.h>
+
+namespace fmus {
+namespace export_system {
+
+std::string exportFormatToString(ExportFormat format) {
+    switch (format) {
+        case ExportFormat::CSV: return "CSV";
+        case ExportFormat::JSON: return "JSON";
+        case ExportFormat::XML: return "XML";
+        case ExportFormat::PDF: return "PDF";
+        case ExportFormat::HTML: return "HTML";
+        case ExportFormat::EXCEL: return "EXCEL";
+        case ExportFormat::TXT: return "TXT";
+        case ExportFormat::CUSTOM: return "CUSTOM";
+        default: return "UNKNOWN";
+    }
+}
+
+ExportFormat stringToExportFormat(const std::string& str) {
+    if (str == "CSV" || str == "csv") {
+        return ExportFormat::CSV;
+    } else if (str == "JSON" || str == "json") {
+        return ExportFormat::JSON;
+    } else if (str == "XML" || str == "xml") {
+        return ExportFormat::XML;
+    } else if (str == "PDF" || str == "pdf") {
+        return ExportFormat::PDF;
+    } else if (str == "HTML" || str == "html") {
+        return ExportFormat::HTML;
+    } else if (str == "EXCEL" || str == "excel" || str == "xlsx") {
+        return ExportFormat::EXCEL;
+    } else if (str == "TXT" || str == "txt") {
+        return ExportFormat::TXT;
+    } else if (str == "CUSTOM" || str == "custom") {
+        return ExportFormat::CUSTOM;
+    }
+    throw ExportError(ExportError::ErrorCode::INVALID_FORMAT, "Unknown export format: " + str);
+}
+
+std::string exportDataTypeToString(ExportDataType type) {
+    switch (type) {
+        case ExportDataType::LIVE_DATA: return "LIVE_DATA";
+        case ExportDataType::DTC_DATA: return "DTC_DATA";
+        case ExportDataType::ECU_INFO: return "ECU_INFO";
+        case ExportDataType::SESSION_LOG: return "SESSION_LOG";
+        case ExportDataType::CUSTOM_DATA: return "CUSTOM_DATA";
+        default: return "UNKNOWN";
+    }
+}
+
+ExportDataType stringToExportDataType(const std::string& str) {
+    if (str == "LIVE_DATA") {
+        return ExportDataType::LIVE_DATA;
+    } else if (str == "DTC_DATA") {
+        return ExportDataType::DTC_DATA;
+    } else if (str == "ECU_INFO") {
+        return ExportDataType::ECU_INFO;
+    } else if (str == "SESSION_LOG") {
+        return ExportDataType::SESSION_LOG;
+    } else if (str == "CUSTOM_DATA") {
+        return ExportDataType::CUSTOM_DATA;
+    }
+    throw ExportError(ExportError::ErrorCode::DATA_CONVERSION_ERROR, "Unknown export data type: " + str);
+}
+
+} // namespace export_system
+} // namespace fmus
@@ -0,0 +1,576 @@
+#include <fmus/export/data_exporter.h>
+#include <fmus/logger.h>
+#include <fmus/thread_pool.h>
+#include <sstream>
+#include <iomanip>
+#include <fstream>
+#include <mutex>
+#include <ctime>
+#include <cmath>
+#include <cstdio>
+
+namespace fmus {
+namespace export_system {
+
+namespace {
+
+constexpr size_t MAX_COLUMNS = 7;       // ECU identification has the widest layout
+
+std::string formatTimePoint(const std::chrono::system_clock::time_point& timePoint,
+                            const std::string& dateFormat) {
+    std::time_t time = std::chrono::system_clock::to_time_t(timePoint);
+    std::tm tm{};
+#ifdef _WIN32
+    localtime_s(&tm, &time);
+#else
+    localtime_r(&time, &tm);
+#endif
+    std::ostringstream ss;
+    ss << std::put_time(&tm, dateFormat.c_str());
+    return ss.str();
+}
+
+std::string formatHexByte(uint8_t value) {
+    std::ostringstream ss;
+    ss << "0x" << std::hex << std::uppercase << std::setw(2) << std::setfill('0')
+       << static_cast<int>(value);
+    return ss.str();
+}
+
+// Column layout helper: add a column and return a reference to its values; the
+// reference stays valid only because build() reserves MAX_COLUMNS up front
+std::vector<std::string>& addColumn(FormattedExportData& table, const std::string& name,
+                                    size_t rows, bool numeric = false) {
+    FormattedColumn column;
+    column.name = name;
+    column.numeric = numeric;
+    column.values.reserve(rows);
+    table.columns.push_back(std::move(column));
+    return table.columns.back().values;
+}
+
+bool writeCSV(const FormattedExportData& data, const ExportConfig& config, std::string& out) {
+    const std::string& delimiter = config.delimiter.empty() ? std::string(",") : config.delimiter;
+
+    if (config.includeHeaders) {
+        for (size_t c = 0; c < data.columns.size(); ++c) {
+            if (c > 0) out += delimiter;
+            out += escapeCSVField(data.columns[c].name, delimiter);
+        }
+        out += '\n';
+    }
+
+    for (size_t r = 0; r < data.rowCount; ++r) {
+        for (size_t c = 0; c < data.columns.size(); ++c) {
+            if (c > 0) out += delimiter;
+            out += escapeCSVField(data.columns[c].values[r], delimiter);
+        }
+        out += '\n';
+    }
+
+    return true;
+}
+
+bool writeJSON(const FormattedExportData& data, const ExportConfig& config, std::string& out) {
+    out += "{\n  \"name\": \"" + escapeJSONString(data.name) + "\",\n";
+    out += "  \"type\": \"" + exportDataTypeToString(data.type) + "\",\n";
+    if (!data.description.empty()) {
+        out += "  \"description\": \"" + escapeJSONString(data.description) + "\",\n";
+    }
+    if (config.includeTimestamp) {
+        out += "  \"timestamp\": \"" + escapeJSONString(data.timestamp) + "\",\n";
+    }
+
+    out += "  \"metadata\": {";
+    for (size_t i = 0; i < data.metadata.size(); ++i) {
+        out += (i == 0) ? "\n" : ",\n";
+        out += "    \"" + escapeJSONString(data.metadata[i].first) + "\": \"" +
+               escapeJSONString(data.metadata[i].second) + "\"";
+    }
+    out += data.metadata.empty() ? "},\n" : "\n  },\n";
+
+    out += "  \"records\": [";
+    for (size_t r = 0; r < data.rowCount; ++r) {
+        out += (r == 0) ? "\n    {" : ",\n    {";
+        for (size_t c = 0; c < data.columns.size(); ++c) {
+            const auto& column = data.columns[c];
+            if (c > 0) out += ", ";
+            out += "\"" + escapeJSONString(column.name) + "\": ";
+            if (column.numeric) {
+                out += column.values[r];
+            } else {
+                out += "\"" + escapeJSONString(column.values[r]) + "\"";
+            }
+        }
+        out += "}";
+    }
+    out += (data.rowCount == 0) ? "]\n}\n" : "\n  ]\n}\n";
+
+    return true;
+}
+
+bool writeXML(const FormattedExportData& data, const ExportConfig& config, std::string& out) {
+    out += "<?xml version=\"1.0\" encoding=\"" + config.encoding + "\"?>\n";
+    out += "<export name=\"" + escapeXMLText(data.name) + "\" type=\"" +
+           exportDataTypeToString(data.type) + "\"";
+    if (config.includeTimestamp) {
+        out += " timestamp=\"" + escapeXMLText(data.timestamp) + "\"";
+    }
+    out += ">\n";
+
+    if (!data.metadata.empty()) {
+        out += "  <metadata>\n";
+        for (const auto& entry : data.metadata) {
+            out += "    <entry key=\"" + escapeXMLText(entry.first) + "\">" +
+                   escapeXMLText(entry.second) + "</entry>\n";
+        }
+        out += "  </metadata>\n";
+    }
+
+    out += "  <records>\n";
+    for (size_t r = 0; r < data.rowCount; ++r) {
+        out += "    <record>";
+        for (const auto& column : data.columns) {
+            out += "<field name=\"" + escapeXMLText(column.name) + "\">" +
+                   escapeXMLText(column.values[r]) + "</field>";
+        }
+        out += "</record>\n";
+    }
+    out += "  </records>\n</export>\n";
+
+    return true;
+}
+
+bool writeHTML(const FormattedExportData& data, const ExportConfig& config, std::string& out) {
+    out += "<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"" + config.encoding + "\">\n";
+    out += "<title>" + escapeXMLText(data.name) + "</title>\n</head>\n<body>\n";
+    out += "<h1>" + escapeXMLText(data.name) + "</h1>\n";
+    if (!data.description.empty()) {
+        out += "<p>" + escapeXMLText(data.description) + "</p>\n";
+    }
+    if (config.includeTimestamp) {
+        out += "<p>Generated: " + escapeXMLText(data.timestamp) + "</p>\n";
+    }
+
+    out += "<table>\n";
+    if (config.includeHeaders) {
+        out += "<tr>";
+        for (const auto& column : data.columns) {
+            out += "<th>" + escapeXMLText(column.name) + "</th>";
+        }
+        out += "</tr>\n";
+    }
+    for (size_t r = 0; r < data.rowCount; ++r) {
+        out += "<tr>";
+        for (const auto& column : data.columns) {
+            out += "<td>" + escapeXMLText(column.values[r]) + "</td>";
+        }
+        out += "</tr>\n";
+    }
+    out += "</table>\n</body>\n</html>\n";
+
+    return true;
+}
+
+bool writeTXT(const FormattedExportData& data, const ExportConfig& config, std::string& out) {
+    // Fixed-width layout: size each column to its widest cell
+    std::vector<size_t> widths(data.columns.size(), 0);
+    for (size_t c = 0; c < data.columns.size(); ++c) {
+        widths[c] = config.includeHeaders ? data.columns[c].name.size() : 0;
+        for (const auto& value : data.columns[c].values) {
+            widths[c] = std::max(widths[c], value.size());
+        }
+    }
+
+    auto appendCell = [&out](const std::string& value, size_t width, bool last) {
+        out += value;
+        if (!last) {
+            out.append(width - value.size() + 2, ' ');
+        }
+    };
+
+    out += data.name + "\n";
+    if (config.includeTimestamp) {
+        out += data.timestamp + "\n";
+    }
+    out += "\n";
+
+    if (config.includeHeaders) {
+        for (size_t c = 0; c < data.columns.size(); ++c) {
+            appendCell(data.columns[c].name, widths[c], c + 1 == data.columns.size());
+        }
+        out += "\n";
+    }
+    for (size_t r = 0; r < data.rowCount; ++r) {
+        for (size_t c = 0; c < data.columns.size(); ++c) {
+            appendCell(data.columns[c].values[r], widths[c], c + 1 == data.columns.size());
+        }
+        out += "\n";
+    }
+
+    return true;
+}
+
+} // anonymous namespace
+
+// FormattedExportData implementation
+FormattedExportData FormattedExportData::build(const ExportData& data, const std::string& dateFormat) {
+    FormattedExportData table;
+    table.type = data.type;
+    table.name = data.name;
+    table.description = data.description;
+    table.timestamp = formatTimePoint(data.timestamp, dateFormat);
+    table.metadata.assign(data.metadata.begin(), data.metadata.end());
+    table.columns.reserve(MAX_COLUMNS);
+
+    switch (data.type) {
+        case ExportDataType::LIVE_DATA: {
+            size_t rows = data.liveData.size();
+            auto& names = addColumn(table, "name", rows);
+            auto& values = addColumn(table, "value", rows, true);
+            auto& units = addColumn(table, "unit", rows);
+            auto& descriptions = addColumn(table, "description", rows);
+            auto& timestamps = addColumn(table, "timestamp", rows);
+
+            bool allNumeric = true;
+            for (const auto& param : data.liveData) {
+                names.push_back(param.name);
+                values.push_back(param.getValueAsString());
+                units.push_back(param.unit);
+                descriptions.push_back(param.description);
+                timestamps.push_back(formatTimePoint(param.timestamp, dateFormat));
+
+                auto number = param.getValueAsNumber();
+                if (!number || !std::isfinite(*number)) {
+                    allNumeric = false;
+                }
+            }
+            table.columns[1].numeric = allNumeric;
+            table.rowCount = rows;
+            break;
+        }
+
+        case ExportDataType::DTC_DATA: {
+            size_t rows = data.dtcData.size();
+            auto& codes = addColumn(table, "code", rows);
+            auto& descriptions = addColumn(table, "description", rows);
+            auto& statuses = addColumn(table, "status", rows);
+            auto& pending = addColumn(table, "pending", rows, true);
+            auto& confirmed = addColumn(table, "confirmed", rows, true);
+            auto& active = addColumn(table, "active", rows, true);
+            auto& timestamps = addColumn(table, "timestamp", rows);
+
+            for (const auto& dtc : data.dtcData) {
+                codes.push_back(dtc.code);
+                descriptions.push_back(dtc.description);
+                statuses.push_back(formatHexByte(dtc.status));
+                pending.push_back(dtc.isPending ? "true" : "false");
+                confirmed.push_back(dtc.isConfirmed ? "true" : "false");
+                active.push_back(dtc.isActive ? "true" : "false");
+                timestamps.push_back(formatTimePoint(dtc.timestamp, dateFormat));
+            }
+            table.rowCount = rows;
+            break;
+        }
+
+        case ExportDataType::ECU_INFO: {
+            size_t rows = data.ecuInfo.size();
+            auto& vins = addColumn(table, "vin", rows);
+            auto& serials = addColumn(table, "serial_number", rows);
+            auto& parts = addColumn(table, "part_number", rows);
+            auto& software = addColumn(table, "software_version", rows);
+            auto& hardware = addColumn(table, "hardware_version", rows);
+            auto& suppliers = addColumn(table, "supplier", rows);
+            auto& calibrations = addColumn(table, "calibration_id", rows);
+
+            for (const auto& info : data.ecuInfo) {
+                vins.push_back(info.vin);
+                serials.push_back(info.ecuSerialNumber);
+                parts.push_back(info.partNumber);
+                software.push_back(info.softwareVersion);
+                hardware.push_back(info.hardwareVersion);
+                suppliers.push_back(info.supplierName);
+                calibrations.push_back(info.calibrationId);
+            }
+            table.rowCount = rows;
+            break;
+        }
+
+        case ExportDataType::SESSION_LOG: {
+            auto& entries = addColumn(table, "entry", data.logEntries.size());
+            entries.assign(data.logEntries.begin(), data.logEntries.end());
+            table.rowCount = entries.size();
+            break;
+        }
+
+        case ExportDataType::CUSTOM_DATA:
+        default: {
+            auto& keys = addColumn(table, "key", data.customData.size());
+            auto& values = addColumn(table, "value", data.customData.size());
+            for (const auto& entry : data.customData) {
+                keys.push_back(entry.first);
+                values.push_back(entry.second);
+            }
+            table.rowCount = keys.size();
+            break;
+        }
+    }
+
+    return table;
+}
+
+size_t FormattedExportData::estimateSize() const {
+    size_t size = name.size() + description.size() + timestamp.size() + 256;
+    for (const auto& entry : metadata) {
+        size += entry.first.size() + entry.second.size() + 16;
+    }
+    for (const auto& column : columns) {
+        // Column name is repeated per record by the JSON and XML writers
+        size += (column.name.size() + 16) * (rowCount + 1);
+        for (const auto& value : column.values) {
+            size += value.size();
+        }
+    }
+    return size;
+}
+
+// FanOutExportResult implementation
+bool FanOutExportResult::allSucceeded() const {
+    for (const auto& result : results) {
+        if (!result.success) {
+            return false;
+        }
+    }
+    return !results.empty();
+}
+
+std::string FanOutExportResult::toString() const {
+    size_t succeeded = 0;
+    for (const auto& result : results) {
+        if (result.success) succeeded++;
+    }
+
+    std::ostringstream ss;
+    ss << "FanOutExportResult[Formats:" << succeeded << "/" << results.size()
+       << ", FormatPass:" << formatDuration.count() << "ms"
+       << ", Total:" << totalDuration.count() << "ms]";
+    return ss.str();
+}
+
+// FanOutExporter implementation
+class FanOutExporter::Impl {
+public:
+    std::map<ExportFormat, ColumnWriter> writers;
+    mutable std::mutex writersMutex;
+
+    ColumnWriter findWriter(ExportFormat format) const {
+        std::lock_guard<std::mutex> lock(writersMutex);
+        auto it = writers.find(format);
+        return it != writers.end() ? it->second : ColumnWriter();
+    }
+
+    static ExportResult writeFormat(const FormattedExportData& table, const ExportConfig& config,
+                                    const ColumnWriter& writer) {
+        auto start = std::chrono::steady_clock::now();
+        ExportResult result(false, config.filePath);
+
+        if (!writer) {
+            result.errorMessage = "No writer registered for format " + exportFormatToString(config.format);
+            return result;
+        }
+
+        std::string output;
+        output.reserve(table.estimateSize());
+
+        try {
+            if (!writer(table, config, output)) {
+                result.errorMessage = "Writer failed for format " + exportFormatToString(config.format);
+                return result;
+            }
+        } catch (const std::exception& e) {
+            result.errorMessage = "Writer error: " + std::string(e.what());
+            return result;
+        }
+
+        std::ofstream file(config.filePath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            result.errorMessage = "Failed to open output file: " + config.filePath;
+            return result;
+        }
+        file.write(output.data(), static_cast<std::streamsize>(output.size()));
+        if (!file.good()) {
+            result.errorMessage = "Failed to write output file: " + config.filePath;
+            return result;
+        }
+
+        result.success = true;
+        result.recordsExported = table.rowCount;
+        result.fileSize = output.size();
+        result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        return result;
+    }
+};
+
+FanOutExporter::FanOutExporter() : pImpl(std::make_unique<Impl>()) {
+    pImpl->writers[ExportFormat::CSV] = writeCSV;
+    pImpl->writers[ExportFormat::JSON] = writeJSON;
+    pImpl->writers[ExportFormat::XML] = writeXML;
+    pImpl->writers[ExportFormat::HTML] = writeHTML;
+    pImpl->writers[ExportFormat::TXT] = writeTXT;
+}
+
+FanOutExporter::~FanOutExporter() = default;
+
+void FanOutExporter::registerWriter(ExportFormat format, ColumnWriter writer) {
+    std::lock_guard<std::mutex> lock(pImpl->writersMutex);
+    pImpl->writers[format] = std::move(writer);
+}
+
+bool FanOutExporter::supportsFormat(ExportFormat format) const {
+    return static_cast<bool>(pImpl->findWriter(format));
+}
+
+FanOutExportResult FanOutExporter::exportAll(const ExportData& data, const std::vector<ExportConfig>& configs,
+                                             ExportProgressCallback callback) {
+    auto logger = Logger::getInstance();
+    FanOutExportResult fanOut;
+
+    if (configs.empty()) {
+        return fanOut;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Single walk over the source data, shared read-only by every writer
+    auto table = std::make_shared<const FormattedExportData>(
+        FormattedExportData::build(data, configs.front().dateFormat));
+
+    auto formatted = std::chrono::steady_clock::now();
+    fanOut.formatDuration = std::chrono::duration_cast<std::chrono::milliseconds>(formatted - start);
+
+    logger->debug("Fan-out export of '" + data.name + "': " + std::to_string(table->rowCount) +
+                  " records to " + std::to_string(configs.size()) + " formats");
+
+    // Progress callbacks arrive from pool workers; serialize them for the caller
+    auto callbackMutex = std::make_shared<std::mutex>();
+    auto completed = std::make_shared<size_t>(0);
+    size_t total = configs.size();
+
+    auto runOne = [table, callback, callbackMutex, completed, total](const ExportConfig& config,
+                                                                     ColumnWriter writer) {
+        ExportResult result = Impl::writeFormat(*table, config, writer);
+        if (callback) {
+            std::lock_guard<std::mutex> lock(*callbackMutex);
+            (*completed)++;
+            callback("Exporting", *completed, total,
+                     exportFormatToString(config.format) + (result.success ? " written" : " failed"));
+        }
+        return result;
+    };
+
+    auto threadPool = getGlobalThreadPool();
+    // Waiting on the pool from one of its own workers can deadlock it
+    if (configs.size() == 1 || threadPool->isWorkerThread()) {
+        for (const auto& config : configs) {
+            try {
+                fanOut.results.push_back(runOne(config, pImpl->findWriter(config.format)));
+            } catch (const std::exception& e) {
+                fanOut.results.emplace_back(false, config.filePath, e.what());
+            }
+        }
+    } else {
+        std::vector<std::future<ExportResult>> futures;
+        futures.reserve(configs.size());
+
+        for (const auto& config : configs) {
+            futures.push_back(threadPool->enqueue(runOne, config, pImpl->findWriter(config.format)));
+        }
+
+        for (size_t i = 0; i < futures.size(); ++i) {
+            try {
+                fanOut.results.push_back(futures[i].get());
+            } catch (const std::exception& e) {
+                fanOut.results.emplace_back(false, configs[i].filePath, e.what());
+            }
+        }
+    }
+
+    fanOut.totalDuration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    logger->info("Fan-out export completed: " + fanOut.toString());
+    return fanOut;
+}
+
+bool FanOutExporter::render(const FormattedExportData& data, const ExportConfig& config,
+                            std::string& output) const {
+    auto writer = pImpl->findWriter(config.format);
+    if (!writer) {
+        return false;
+    }
+    output.reserve(output.size() + data.estimateSize());
+    return writer(data, config, output);
+}
+
+// Escaping helpers
+std::string escapeCSVField(const std::string& field, const std::string& delimiter) {
+    bool needsQuotes = field.find_first_of("\"\r\n") != std::string::npos ||
+                       (!delimiter.empty() && field.find(delimiter) != std::string::npos);
+    if (!needsQuotes) {
+        return field;
+    }
+
+    std::string escaped;
+    escaped.reserve(field.size() + 8);
+    escaped += '"';
+    for (char c : field) {
+        if (c == '"') escaped += '"';
+        escaped += c;
+    }
+    escaped += '"';
+    return escaped;
+}
+
+std::string escapeJSONString(const std::string& str) {
+    std::string escaped;
+    escaped.reserve(str.size() + 8);
+    for (char c : str) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned char>(c));
+                    escaped += buffer;
+                } else {
+                    escaped += c;
+                }
+                break;
+        }
+    }
+    return escaped;
+}
+
+std::string escapeXMLText(const std::string& str) {
+    std::string escaped;
+    escaped.reserve(str.size() + 8);
+    for (char c : str) {
+        switch (c) {
+            case '&': escaped += "&amp;"; break;
+            case '<': escaped += "&lt;"; break;
+            case '>': escaped += "&gt;"; break;
+            case '"': escaped += "&quot;"; break;
+            case '\'': escaped += "&apos;"; break;
+            default: escaped += c; break;
+        }
+    }
+    return escaped;
+}
+
+} // namespace export_system
+} // namespace fmus
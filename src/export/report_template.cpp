@@ -0,0 +1,726 @@
+#include <fmus/export/report_template.h>
+#include <fmus/logger.h>
+#include <fmus/thread_pool.h>
+#include <fstream>
+#include <sstream>
+#include <future>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+namespace fmus {
+namespace export_system {
+
+namespace {
+
+enum class OpCode : uint8_t {
+    LITERAL,            ///< a = pool offset, b = length
+    REPORT_FIELD,       ///< a = ReportField
+    KEYED_FIELD,        ///< a = KeyedSource, key = lookup key
+    ITEM_FIELD,         ///< a = Section, b = ItemField
+    SECTION_BEGIN,      ///< a = Section, b = index of matching SECTION_END
+    INVERTED_BEGIN,     ///< a = Section, b = index of matching SECTION_END
+    SECTION_END         ///< a = Section, b = index of matching begin
+};
+
+enum ReportField : uint32_t {
+    REPORT_NAME, REPORT_DESCRIPTION, REPORT_TIMESTAMP, REPORT_TYPE, REPORT_COUNT
+};
+
+enum KeyedSource : uint32_t {
+    KEYED_METADATA, KEYED_CUSTOM
+};
+
+enum Section : uint32_t {
+    SECTION_DTCS, SECTION_LIVE_DATA, SECTION_ECU_INFO, SECTION_LOG,
+    SECTION_METADATA, SECTION_CUSTOM, SECTION_COUNT
+};
+
+enum ItemField : uint32_t {
+    // DTC
+    DTC_CODE, DTC_DESCRIPTION, DTC_STATUS, DTC_PENDING, DTC_CONFIRMED, DTC_ACTIVE, DTC_TIMESTAMP,
+    // Live data
+    PARAM_NAME, PARAM_VALUE, PARAM_UNIT, PARAM_DESCRIPTION, PARAM_TIMESTAMP,
+    // ECU identification
+    ECU_VIN, ECU_SERIAL, ECU_PART, ECU_SOFTWARE, ECU_HARDWARE, ECU_SUPPLIER, ECU_CALIBRATION,
+    // Log entry
+    LOG_ENTRY,
+    // Metadata / custom map entries
+    ENTRY_KEY, ENTRY_VALUE
+};
+
+struct NamedId {
+    const char* name;
+    uint32_t id;
+};
+
+const NamedId kReportFields[] = {
+    {"name", REPORT_NAME}, {"description", REPORT_DESCRIPTION}, {"timestamp", REPORT_TIMESTAMP},
+    {"type", REPORT_TYPE}, {"count", REPORT_COUNT}
+};
+
+const NamedId kSections[] = {
+    {"dtcs", SECTION_DTCS}, {"liveData", SECTION_LIVE_DATA}, {"ecuInfo", SECTION_ECU_INFO},
+    {"log", SECTION_LOG}, {"metadata", SECTION_METADATA}, {"custom", SECTION_CUSTOM}
+};
+
+const NamedId kDtcFields[] = {
+    {"code", DTC_CODE}, {"description", DTC_DESCRIPTION}, {"status", DTC_STATUS},
+    {"pending", DTC_PENDING}, {"confirmed", DTC_CONFIRMED}, {"active", DTC_ACTIVE},
+    {"timestamp", DTC_TIMESTAMP}
+};
+
+const NamedId kLiveDataFields[] = {
+    {"name", PARAM_NAME}, {"value", PARAM_VALUE}, {"unit", PARAM_UNIT},
+    {"description", PARAM_DESCRIPTION}, {"timestamp", PARAM_TIMESTAMP}
+};
+
+const NamedId kEcuInfoFields[] = {
+    {"vin", ECU_VIN}, {"serialNumber", ECU_SERIAL}, {"partNumber", ECU_PART},
+    {"softwareVersion", ECU_SOFTWARE}, {"hardwareVersion", ECU_HARDWARE},
+    {"supplier", ECU_SUPPLIER}, {"calibrationId", ECU_CALIBRATION}
+};
+
+const NamedId kLogFields[] = {
+    {"entry", LOG_ENTRY}
+};
+
+const NamedId kEntryFields[] = {
+    {"key", ENTRY_KEY}, {"value", ENTRY_VALUE}
+};
+
+template<size_t N>
+bool lookup(const NamedId (&table)[N], const std::string& name, uint32_t& id) {
+    for (const auto& entry : table) {
+        if (name == entry.name) {
+            id = entry.id;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool lookupItemField(uint32_t section, const std::string& name, uint32_t& id) {
+    switch (section) {
+        case SECTION_DTCS: return lookup(kDtcFields, name, id);
+        case SECTION_LIVE_DATA: return lookup(kLiveDataFields, name, id);
+        case SECTION_ECU_INFO: return lookup(kEcuInfoFields, name, id);
+        case SECTION_LOG: return lookup(kLogFields, name, id);
+        case SECTION_METADATA:
+        case SECTION_CUSTOM: return lookup(kEntryFields, name, id);
+        default: return false;
+    }
+}
+
+std::string trim(const std::string& str) {
+    size_t begin = str.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    size_t end = str.find_last_not_of(" \t\r\n");
+    return str.substr(begin, end - begin + 1);
+}
+
+ExportError templateError(const std::string& message, size_t position) {
+    return ExportError(ExportError::ErrorCode::TEMPLATE_ERROR,
+                       "Report template error at offset " + std::to_string(position) + ": " + message);
+}
+
+} // anonymous namespace
+
+class ReportTemplate::Impl {
+public:
+    struct Instruction {
+        OpCode op;
+        bool raw = false;
+        uint32_t a = 0;
+        uint32_t b = 0;
+        std::string key;
+    };
+
+    std::vector<Instruction> program;
+    std::string literals;
+    TemplateEscape escape = TemplateEscape::HTML;
+    std::string dateFormat;
+    mutable std::atomic<size_t> sizeHint{0};
+
+    void compile(const std::string& source) {
+        std::vector<size_t> openSections;  // indices of unmatched begin instructions
+        size_t pos = 0;
+
+        while (pos < source.size()) {
+            size_t open = source.find("{{", pos);
+            if (open == std::string::npos) {
+                emitLiteral(source, pos, source.size() - pos);
+                break;
+            }
+            emitLiteral(source, pos, open - pos);
+
+            bool raw = source.compare(open, 3, "{{{") == 0;
+            const char* closer = raw ? "}}}" : "}}";
+            size_t contentStart = open + (raw ? 3 : 2);
+            size_t close = source.find(closer, contentStart);
+            if (close == std::string::npos) {
+                throw templateError("unterminated tag", open);
+            }
+
+            std::string tag = trim(source.substr(contentStart, close - contentStart));
+            pos = close + (raw ? 3 : 2);
+
+            if (tag.empty()) {
+                throw templateError("empty tag", open);
+            }
+
+            char prefix = tag[0];
+            if (prefix == '#' || prefix == '^') {
+                uint32_t section;
+                if (raw || !lookup(kSections, trim(tag.substr(1)), section)) {
+                    throw templateError("unknown section '" + tag.substr(1) + "'", open);
+                }
+                Instruction instruction;
+                instruction.op = (prefix == '#') ? OpCode::SECTION_BEGIN : OpCode::INVERTED_BEGIN;
+                instruction.a = section;
+                openSections.push_back(program.size());
+                program.push_back(instruction);
+            } else if (prefix == '/') {
+                uint32_t section;
+                if (raw || !lookup(kSections, trim(tag.substr(1)), section)) {
+                    throw templateError("unknown section '" + tag.substr(1) + "'", open);
+                }
+                if (openSections.empty() || program[openSections.back()].a != section) {
+                    throw templateError("mismatched section end '" + tag.substr(1) + "'", open);
+                }
+                size_t begin = openSections.back();
+                openSections.pop_back();
+
+                Instruction instruction;
+                instruction.op = OpCode::SECTION_END;
+                instruction.a = section;
+                instruction.b = static_cast<uint32_t>(begin);
+                program[begin].b = static_cast<uint32_t>(program.size());
+                program.push_back(instruction);
+            } else {
+                program.push_back(resolveField(tag, raw, openSections, open));
+            }
+        }
+
+        if (!openSections.empty()) {
+            throw templateError("unterminated section", source.size());
+        }
+    }
+
+    void emitLiteral(const std::string& source, size_t offset, size_t length) {
+        if (length == 0) {
+            return;
+        }
+        // Merge with the previous literal so static runs stay one append
+        if (!program.empty() && program.back().op == OpCode::LITERAL &&
+            program.back().a + program.back().b == literals.size()) {
+            program.back().b += static_cast<uint32_t>(length);
+        } else {
+            Instruction instruction;
+            instruction.op = OpCode::LITERAL;
+            instruction.a = static_cast<uint32_t>(literals.size());
+            instruction.b = static_cast<uint32_t>(length);
+            program.push_back(instruction);
+        }
+        literals.append(source, offset, length);
+    }
+
+    Instruction resolveField(const std::string& name, bool raw,
+                             const std::vector<size_t>& openSections, size_t position) const {
+        Instruction instruction;
+        instruction.raw = raw;
+
+        // Innermost section fields take precedence over report fields
+        if (!openSections.empty()) {
+            uint32_t section = program[openSections.back()].a;
+            uint32_t field;
+            if (program[openSections.back()].op == OpCode::SECTION_BEGIN &&
+                lookupItemField(section, name, field)) {
+                instruction.op = OpCode::ITEM_FIELD;
+                instruction.a = section;
+                instruction.b = field;
+                return instruction;
+            }
+        }
+
+        uint32_t field;
+        if (lookup(kReportFields, name, field)) {
+            instruction.op = OpCode::REPORT_FIELD;
+            instruction.a = field;
+            return instruction;
+        }
+
+        if (name.compare(0, 5, "meta.") == 0 && name.size() > 5) {
+            instruction.op = OpCode::KEYED_FIELD;
+            instruction.a = KEYED_METADATA;
+            instruction.key = name.substr(5);
+            return instruction;
+        }
+
+        if (name.compare(0, 7, "custom.") == 0 && name.size() > 7) {
+            instruction.op = OpCode::KEYED_FIELD;
+            instruction.a = KEYED_CUSTOM;
+            instruction.key = name.substr(7);
+            return instruction;
+        }
+
+        throw templateError("unknown field '" + name + "'", position);
+    }
+
+    // Rendering
+
+    struct Cursor {
+        const void* item[SECTION_COUNT] = {};
+    };
+
+    void append(std::string& out, const std::string& value, bool raw) const {
+        append(out, value.data(), value.size(), raw);
+    }
+
+    void append(std::string& out, const char* data, size_t length, bool raw) const {
+        if (raw || escape == TemplateEscape::NONE) {
+            out.append(data, length);
+            return;
+        }
+
+        // Append unescaped runs in bulk, expanding only special characters
+        size_t runStart = 0;
+        for (size_t i = 0; i < length; ++i) {
+            const char* replacement = nullptr;
+            char unicodeEscape[8];
+            char c = data[i];
+
+            if (escape == TemplateEscape::HTML) {
+                switch (c) {
+                    case '&': replacement = "&amp;"; break;
+                    case '<': replacement = "&lt;"; break;
+                    case '>': replacement = "&gt;"; break;
+                    case '"': replacement = "&quot;"; break;
+                    case '\'': replacement = "&#39;"; break;
+                    default: break;
+                }
+            } else {
+                switch (c) {
+                    case '"': replacement = "\\\""; break;
+                    case '\\': replacement = "\\\\"; break;
+                    case '\n': replacement = "\\n"; break;
+                    case '\r': replacement = "\\r"; break;
+                    case '\t': replacement = "\\t"; break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) {
+                            std::snprintf(unicodeEscape, sizeof(unicodeEscape), "\\u%04x",
+                                          static_cast<unsigned char>(c));
+                            replacement = unicodeEscape;
+                        }
+                        break;
+                }
+            }
+
+            if (replacement) {
+                out.append(data + runStart, i - runStart);
+                out.append(replacement);
+                runStart = i + 1;
+            }
+        }
+        out.append(data + runStart, length - runStart);
+    }
+
+    void appendTime(std::string& out, const std::chrono::system_clock::time_point& timePoint, bool raw) const {
+        std::time_t time = std::chrono::system_clock::to_time_t(timePoint);
+        std::tm tm{};
+#ifdef _WIN32
+        localtime_s(&tm, &time);
+#else
+        localtime_r(&time, &tm);
+#endif
+        char buffer[128];
+        size_t length = std::strftime(buffer, sizeof(buffer), dateFormat.c_str(), &tm);
+        append(out, buffer, length, raw);
+    }
+
+    static void appendBool(std::string& out, bool value) {
+        out.append(value ? "true" : "false");
+    }
+
+    static size_t sectionSize(const ExportData& data, uint32_t section) {
+        switch (section) {
+            case SECTION_DTCS: return data.dtcData.size();
+            case SECTION_LIVE_DATA: return data.liveData.size();
+            case SECTION_ECU_INFO: return data.ecuInfo.size();
+            case SECTION_LOG: return data.logEntries.size();
+            case SECTION_METADATA: return data.metadata.size();
+            case SECTION_CUSTOM: return data.customData.size();
+            default: return 0;
+        }
+    }
+
+    static size_t recordCount(const ExportData& data) {
+        switch (data.type) {
+            case ExportDataType::LIVE_DATA: return data.liveData.size();
+            case ExportDataType::DTC_DATA: return data.dtcData.size();
+            case ExportDataType::ECU_INFO: return data.ecuInfo.size();
+            case ExportDataType::SESSION_LOG: return data.logEntries.size();
+            default: return data.customData.size();
+        }
+    }
+
+    void appendReportField(std::string& out, const ExportData& data, const Instruction& instruction) const {
+        switch (instruction.a) {
+            case REPORT_NAME: append(out, data.name, instruction.raw); break;
+            case REPORT_DESCRIPTION: append(out, data.description, instruction.raw); break;
+            case REPORT_TIMESTAMP: appendTime(out, data.timestamp, instruction.raw); break;
+            case REPORT_TYPE: out.append(exportDataTypeToString(data.type)); break;
+            case REPORT_COUNT: out.append(std::to_string(recordCount(data))); break;
+            default: break;
+        }
+    }
+
+    void appendKeyedField(std::string& out, const ExportData& data, const Instruction& instruction) const {
+        const auto& source = (instruction.a == KEYED_METADATA) ? data.metadata : data.customData;
+        auto it = source.find(instruction.key);
+        if (it != source.end()) {
+            append(out, it->second, instruction.raw);
+        }
+    }
+
+    void appendItemField(std::string& out, const Cursor& cursor, const Instruction& instruction) const {
+        const void* item = cursor.item[instruction.a];
+        if (!item) {
+            return;
+        }
+        bool raw = instruction.raw;
+
+        switch (instruction.a) {
+            case SECTION_DTCS: {
+                const auto& dtc = *static_cast<const DiagnosticTroubleCode*>(item);
+                switch (instruction.b) {
+                    case DTC_CODE: append(out, dtc.code, raw); break;
+                    case DTC_DESCRIPTION: append(out, dtc.description, raw); break;
+                    case DTC_STATUS: {
+                        char buffer[8];
+                        int length = std::snprintf(buffer, sizeof(buffer), "0x%02X",
+                                                   static_cast<unsigned>(dtc.status));
+                        out.append(buffer, static_cast<size_t>(length));
+                        break;
+                    }
+                    case DTC_PENDING: appendBool(out, dtc.isPending); break;
+                    case DTC_CONFIRMED: appendBool(out, dtc.isConfirmed); break;
+                    case DTC_ACTIVE: appendBool(out, dtc.isActive); break;
+                    case DTC_TIMESTAMP: appendTime(out, dtc.timestamp, raw); break;
+                    default: break;
+                }
+                break;
+            }
+            case SECTION_LIVE_DATA: {
+                const auto& param = *static_cast<const LiveDataParameter*>(item);
+                switch (instruction.b) {
+                    case PARAM_NAME: append(out, param.name, raw); break;
+                    case PARAM_VALUE: append(out, param.getValueAsString(), raw); break;
+                    case PARAM_UNIT: append(out, param.unit, raw); break;
+                    case PARAM_DESCRIPTION: append(out, param.description, raw); break;
+                    case PARAM_TIMESTAMP: appendTime(out, param.timestamp, raw); break;
+                    default: break;
+                }
+                break;
+            }
+            case SECTION_ECU_INFO: {
+                const auto& info = *static_cast<const ECUIdentification*>(item);
+                switch (instruction.b) {
+                    case ECU_VIN: append(out, info.vin, raw); break;
+                    case ECU_SERIAL: append(out, info.ecuSerialNumber, raw); break;
+                    case ECU_PART: append(out, info.partNumber, raw); break;
+                    case ECU_SOFTWARE: append(out, info.softwareVersion, raw); break;
+                    case ECU_HARDWARE: append(out, info.hardwareVersion, raw); break;
+                    case ECU_SUPPLIER: append(out, info.supplierName, raw); break;
+                    case ECU_CALIBRATION: append(out, info.calibrationId, raw); break;
+                    default: break;
+                }
+                break;
+            }
+            case SECTION_LOG:
+                append(out, *static_cast<const std::string*>(item), raw);
+                break;
+            case SECTION_METADATA:
+            case SECTION_CUSTOM: {
+                const auto& entry = *static_cast<const std::pair<const std::string, std::string>*>(item);
+                append(out, instruction.b == ENTRY_KEY ? entry.first : entry.second, raw);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    template<typename Container>
+    void renderItems(std::string& out, const ExportData& data, Cursor& cursor,
+                     const Container& items, uint32_t section, size_t begin, size_t end) const {
+        const void* saved = cursor.item[section];
+        for (const auto& item : items) {
+            cursor.item[section] = &item;
+            renderRange(out, data, cursor, begin, end);
+        }
+        cursor.item[section] = saved;
+    }
+
+    void renderRange(std::string& out, const ExportData& data, Cursor& cursor, size_t begin, size_t end) const {
+        for (size_t pc = begin; pc < end; ++pc) {
+            const Instruction& instruction = program[pc];
+
+            switch (instruction.op) {
+                case OpCode::LITERAL:
+                    out.append(literals, instruction.a, instruction.b);
+                    break;
+
+                case OpCode::REPORT_FIELD:
+                    appendReportField(out, data, instruction);
+                    break;
+
+                case OpCode::KEYED_FIELD:
+                    appendKeyedField(out, data, instruction);
+                    break;
+
+                case OpCode::ITEM_FIELD:
+                    appendItemField(out, cursor, instruction);
+                    break;
+
+                case OpCode::SECTION_BEGIN: {
+                    size_t bodyEnd = instruction.b;
+                    switch (instruction.a) {
+                        case SECTION_DTCS: renderItems(out, data, cursor, data.dtcData, instruction.a, pc + 1, bodyEnd); break;
+                        case SECTION_LIVE_DATA: renderItems(out, data, cursor, data.liveData, instruction.a, pc + 1, bodyEnd); break;
+                        case SECTION_ECU_INFO: renderItems(out, data, cursor, data.ecuInfo, instruction.a, pc + 1, bodyEnd); break;
+                        case SECTION_LOG: renderItems(out, data, cursor, data.logEntries, instruction.a, pc + 1, bodyEnd); break;
+                        case SECTION_METADATA: renderItems(out, data, cursor, data.metadata, instruction.a, pc + 1, bodyEnd); break;
+                        case SECTION_CUSTOM: renderItems(out, data, cursor, data.customData, instruction.a, pc + 1, bodyEnd); break;
+                        default: break;
+                    }
+                    pc = bodyEnd;
+                    break;
+                }
+
+                case OpCode::INVERTED_BEGIN:
+                    if (sectionSize(data, instruction.a) == 0) {
+                        renderRange(out, data, cursor, pc + 1, instruction.b);
+                    }
+                    pc = instruction.b;
+                    break;
+
+                case OpCode::SECTION_END:
+                    break;
+            }
+        }
+    }
+
+    void renderInto(const ExportData& data, std::string& out) const {
+        out.clear();
+        size_t hint = sizeHint.load(std::memory_order_relaxed);
+        if (out.capacity() < hint) {
+            out.reserve(hint);
+        }
+
+        Cursor cursor;
+        renderRange(out, data, cursor, 0, program.size());
+
+        // Grow the hint with some headroom so similar reports fit without reallocating
+        size_t wanted = out.size() + out.size() / 8;
+        while (hint < wanted &&
+               !sizeHint.compare_exchange_weak(hint, wanted, std::memory_order_relaxed)) {
+        }
+    }
+};
+
+namespace {
+
+// Split [0, count) into chunks sized for a few chunks per pool worker
+template<typename Task>
+void runChunked(size_t count, Task task) {
+    if (count == 0) {
+        return;
+    }
+
+    auto threadPool = getGlobalThreadPool();
+    size_t workers = std::max<size_t>(1, threadPool->getThreadCount());
+    size_t chunkSize = std::max<size_t>(1, count / (workers * 4));
+
+    // Waiting on the pool from one of its own workers can deadlock it
+    if (count <= chunkSize || threadPool->isWorkerThread()) {
+        task(0, count);
+        return;
+    }
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(count / chunkSize + 1);
+    for (size_t begin = 0; begin < count; begin += chunkSize) {
+        size_t end = std::min(count, begin + chunkSize);
+        futures.push_back(threadPool->enqueue(task, begin, end));
+    }
+
+    // Every chunk refers to the caller's buffers, so wait for all before rethrowing
+    std::exception_ptr failure;
+    for (auto& future : futures) {
+        try {
+            future.get();
+        } catch (...) {
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+TemplateEscape escapeForFormat(ExportFormat format) {
+    switch (format) {
+        case ExportFormat::HTML:
+        case ExportFormat::XML:
+        case ExportFormat::PDF:
+            return TemplateEscape::HTML;
+        case ExportFormat::JSON:
+            return TemplateEscape::JSON;
+        default:
+            return TemplateEscape::NONE;
+    }
+}
+
+std::string readTemplateFile(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        throw ExportError(ExportError::ErrorCode::TEMPLATE_ERROR,
+                          "Failed to open report template: " + filePath);
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+} // anonymous namespace
+
+// ReportTemplate implementation
+ReportTemplate::ReportTemplate() : pImpl(std::make_unique<Impl>()) {}
+
+ReportTemplate::~ReportTemplate() = default;
+
+std::shared_ptr<const ReportTemplate> ReportTemplate::compile(const std::string& source,
+                                                              TemplateEscape escape,
+                                                              const std::string& dateFormat) {
+    std::shared_ptr<ReportTemplate> compiled(new ReportTemplate());
+    compiled->pImpl->escape = escape;
+    compiled->pImpl->dateFormat = dateFormat;
+    compiled->pImpl->compile(source);
+    compiled->pImpl->sizeHint = compiled->pImpl->literals.size() + 256;
+
+    auto logger = Logger::getInstance();
+    logger->debug("Compiled report template: " + std::to_string(compiled->pImpl->program.size()) +
+                  " instructions, " + std::to_string(compiled->pImpl->literals.size()) + " literal bytes");
+
+    return compiled;
+}
+
+std::shared_ptr<const ReportTemplate> ReportTemplate::compile(const ExportTemplate::TemplateInfo& templateInfo) {
+    std::string source;
+    auto inlineSource = templateInfo.customFields.find("template");
+    auto fileSource = templateInfo.customFields.find("templateFile");
+
+    if (inlineSource != templateInfo.customFields.end()) {
+        source = inlineSource->second;
+    } else if (fileSource != templateInfo.customFields.end()) {
+        source = readTemplateFile(fileSource->second);
+    } else {
+        throw ExportError(ExportError::ErrorCode::TEMPLATE_ERROR,
+                          "Export template '" + templateInfo.name + "' has no report template source");
+    }
+
+    return compile(source, escapeForFormat(templateInfo.format), templateInfo.config.dateFormat);
+}
+
+std::shared_ptr<const ReportTemplate> ReportTemplate::compileFile(const std::string& filePath,
+                                                                  TemplateEscape escape) {
+    return compile(readTemplateFile(filePath), escape);
+}
+
+void ReportTemplate::render(const ExportData& data, std::string& output) const {
+    pImpl->renderInto(data, output);
+}
+
+std::string ReportTemplate::render(const ExportData& data) const {
+    std::string output;
+    pImpl->renderInto(data, output);
+    return output;
+}
+
+std::vector<std::string> ReportTemplate::renderBatch(const std::vector<ExportData>& reports) const {
+    std::vector<std::string> outputs(reports.size());
+    const Impl* impl = pImpl.get();
+
+    runChunked(reports.size(), [impl, &reports, &outputs](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            impl->renderInto(reports[i], outputs[i]);
+        }
+    });
+
+    return outputs;
+}
+
+std::vector<ExportResult> ReportTemplate::renderBatchToFiles(const std::vector<ExportData>& reports,
+                                                             const std::vector<std::string>& filePaths) const {
+    if (reports.size() != filePaths.size()) {
+        throw ExportError(ExportError::ErrorCode::CONFIGURATION_ERROR,
+                          "Report count does not match output path count");
+    }
+
+    std::vector<ExportResult> results(reports.size());
+    const Impl* impl = pImpl.get();
+
+    runChunked(reports.size(), [impl, &reports, &filePaths, &results](size_t begin, size_t end) {
+        // One buffer per chunk, reused for every report in it
+        std::string buffer;
+        for (size_t i = begin; i < end; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            ExportResult& result = results[i];
+            result.filePath = filePaths[i];
+
+            try {
+                impl->renderInto(reports[i], buffer);
+            } catch (const std::exception& e) {
+                result.errorMessage = "Failed to render report: " + std::string(e.what());
+                continue;
+            }
+
+            std::ofstream file(filePaths[i], std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                result.errorMessage = "Failed to open output file: " + filePaths[i];
+                continue;
+            }
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            if (!file.good()) {
+                result.errorMessage = "Failed to write output file: " + filePaths[i];
+                continue;
+            }
+
+            result.success = true;
+            result.recordsExported = Impl::recordCount(reports[i]);
+            result.fileSize = buffer.size();
+            result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start);
+        }
+    });
+
+    return results;
+}
+
+size_t ReportTemplate::getInstructionCount() const {
+    return pImpl->program.size();
+}
+
+size_t ReportTemplate::getLiteralSize() const {
+    return pImpl->literals.size();
+}
+
+size_t ReportTemplate::getSizeHint() const {
+    return pImpl->sizeHint.load(std::memory_order_relaxed);
+}
+
+} // namespace export_system
+} // namespace fmus
@@ -9,10 +9,18 @@
 #include <mutex>
 #include <atomic>
 #include <algorithm>
+#include <limits>
 
 namespace fmus {
 namespace flashing {
 
+namespace {
+
+/// TransferData service ID and block sequence counter
+constexpr size_t TRANSFER_DATA_OVERHEAD = 2;
+
+} // anonymous namespace
+
 // FlashRegion implementation
 std::string FlashRegion::toString() const {
     std::ostringstream ss;
@@ -399,7 +407,10 @@ public:
         }
     }
     
-    bool requestDownload(uint32_t address, uint32_t size) {
+    /**
+     * Returns the ECU's maxNumberOfBlockLength, or 0 on failure
+     */
+    size_t requestDownload(uint32_t address, uint32_t size) {
         try {
             // UDS Request Download service (0x34)
             std::vector<uint8_t> requestData;
@@ -417,10 +428,35 @@ public:
             diagnostics::UDSMessage request(diagnostics::UDSService::REQUEST_DOWNLOAD, requestData);
             diagnostics::UDSMessage response = udsClient->sendRequest(request);
             
-            return !response.isNegativeResponse;
+            if (response.isNegativeResponse) {
+                return 0;
+            }
+            
+            // lengthFormatIdentifier, then maxNumberOfBlockLength in its high nibble's byte count
+            size_t lengthBytes = response.data.empty() ? 0 : (response.data[0] >> 4);
+            if (lengthBytes == 0 || response.data.size() < 1 + lengthBytes) {
+                return std::numeric_limits<size_t>::max();
+            }
+            size_t maxBlockLength = 0;
+            for (size_t i = 0; i < lengthBytes; ++i) {
+                maxBlockLength = (maxBlockLength << 8) | response.data[1 + i];
+            }
+            return maxBlockLength;
         } catch (...) {
-            return false;
+            return 0;
+        }
+    }
+    
+    /**
+     * TransferData payload per request: the configured size, or the most
+     * the ECU and the transport accept after the SID and sequence counter
+     */
+    size_t transferChunkSize(size_t maxBlockLength) const {
+        if (config.blockSize) {
+            return config.blockSize;
         }
+        size_t limit = std::min(maxBlockLength, udsClient->getTransportCapabilities().maxPduSize);
+        return limit > TRANSFER_DATA_OVERHEAD ? limit - TRANSFER_DATA_OVERHEAD : 1;
     }
     
     bool transferData(uint8_t blockSequence, const std::vector<uint8_t>& data) {
@@ -523,16 +559,17 @@ bool FlashManager::programFlash(const FlashFile& flashFile, FlashProgressCallbac
             }
             
             // Request download for this block
-            if (!pImpl->requestDownload(block.address, block.data.size())) {
+            size_t maxBlockLength = pImpl->requestDownload(block.address, block.data.size());
+            if (maxBlockLength == 0) {
                 throw FlashError(FlashError::ErrorCode::PROGRAMMING_FAILED, 
                                "Request download failed", block.address);
             }
             
             // Transfer data in chunks
+            size_t transferSize = pImpl->transferChunkSize(maxBlockLength);
             size_t offset = 0;
             while (offset < block.data.size()) {
-                size_t chunkSize = std::min(static_cast<size_t>(pImpl->config.blockSize), 
-                                          block.data.size() - offset);
+                size_t chunkSize = std::min(transferSize, block.data.size() - offset);
                 
                 std::vector<uint8_t> chunk(block.data.begin() + offset, 
                                          block.data.begin() + offset + chunkSize);
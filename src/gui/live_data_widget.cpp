@@ -0,0 +1,152 @@
+#include <fmus/gui/main_window.h>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace fmus {
+namespace gui {
+
+namespace {
+
+struct DisplayedParameter {
+    LiveDataStore::ChannelId channel = LiveDataStore::INVALID_CHANNEL;
+    uint64_t readSequence = 0;      ///< Store sequence already folded into row and plot
+    LiveDataRow row;
+    PlotDecimator plot;
+};
+
+} // anonymous namespace
+
+class LiveDataWidget::Impl {
+public:
+    std::shared_ptr<LiveDataStore> store = std::make_shared<LiveDataStore>();
+    std::atomic<bool> visible{false};
+
+    // Held by update() for a whole frame; never taken on the publishing path
+    mutable std::mutex mutex;
+    std::vector<DisplayedParameter> parameters;
+    std::unordered_map<std::string, size_t> index;
+    size_t plotColumns = 600;
+    std::chrono::milliseconds plotSpan{30000};
+    std::vector<LiveSample> scratch;
+
+    void refresh() {
+        std::lock_guard<std::mutex> lock(mutex);
+        int64_t now = LiveDataStore::now();
+
+        for (auto& parameter : parameters) {
+            uint64_t sequence = store->getSequence(parameter.channel);
+            parameter.row.changed = sequence != parameter.readSequence;
+
+            if (parameter.row.changed) {
+                scratch.clear();
+                parameter.readSequence = store->readHistory(parameter.channel, parameter.readSequence, scratch);
+                parameter.plot.add(scratch);
+                if (!scratch.empty()) {
+                    parameter.row.value = scratch.back().value;
+                    parameter.row.timestampUs = scratch.back().timestampUs;
+                }
+                parameter.row.sampleCount = parameter.readSequence;
+            }
+            parameter.plot.advanceTo(now);
+        }
+    }
+};
+
+LiveDataWidget::LiveDataWidget()
+    : Widget("LiveData"), pImpl(std::make_unique<Impl>()) {}
+
+LiveDataWidget::~LiveDataWidget() = default;
+
+void LiveDataWidget::show() {
+    pImpl->visible = true;
+}
+
+void LiveDataWidget::hide() {
+    pImpl->visible = false;
+}
+
+void LiveDataWidget::update() {
+    if (pImpl->visible) {
+        pImpl->refresh();
+    }
+}
+
+bool LiveDataWidget::isVisible() const {
+    return pImpl->visible;
+}
+
+void LiveDataWidget::addParameter(const std::string& name, const std::string& unit) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    if (pImpl->index.count(name)) {
+        return;
+    }
+
+    DisplayedParameter parameter;
+    parameter.channel = pImpl->store->addChannel(name, unit);
+    if (parameter.channel == LiveDataStore::INVALID_CHANNEL) {
+        return;
+    }
+    parameter.row.name = name;
+    parameter.row.unit = unit.empty() ? pImpl->store->getChannelUnit(parameter.channel) : unit;
+    parameter.plot.resize(pImpl->plotColumns, pImpl->plotSpan);
+
+    pImpl->index[name] = pImpl->parameters.size();
+    pImpl->parameters.push_back(std::move(parameter));
+}
+
+void LiveDataWidget::updateParameter(const std::string& name, double value) {
+    pImpl->store->publish(name, value);
+}
+
+void LiveDataWidget::clearParameters() {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->parameters.clear();
+    pImpl->index.clear();
+}
+
+void LiveDataWidget::setDataSource(std::shared_ptr<LiveDataStore> store) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->store = store ? std::move(store) : std::make_shared<LiveDataStore>();
+    pImpl->parameters.clear();
+    pImpl->index.clear();
+}
+
+std::shared_ptr<LiveDataStore> LiveDataWidget::getDataSource() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->store;
+}
+
+void LiveDataWidget::setPlotGeometry(size_t columns, std::chrono::milliseconds span) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->plotColumns = columns;
+    pImpl->plotSpan = span;
+    for (auto& parameter : pImpl->parameters) {
+        parameter.plot.resize(columns, span);
+        // Refill from the history still in the store on the next frame
+        parameter.readSequence = 0;
+    }
+}
+
+std::vector<LiveDataRow> LiveDataWidget::getRows() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    std::vector<LiveDataRow> rows;
+    rows.reserve(pImpl->parameters.size());
+    for (const auto& parameter : pImpl->parameters) {
+        rows.push_back(parameter.row);
+    }
+    return rows;
+}
+
+bool LiveDataWidget::getPlot(const std::string& name, std::vector<PlotColumn>& columns) const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    auto it = pImpl->index.find(name);
+    if (it == pImpl->index.end()) {
+        return false;
+    }
+    pImpl->parameters[it->second].plot.getColumns(columns);
+    return true;
+}
+
+} // namespace gui
+} // namespace fmus
@@ -0,0 +1,102 @@
+#include <fmus/gui/plot_decimator.h>
+#include <algorithm>
+
+namespace fmus {
+namespace gui {
+
+PlotDecimator::PlotDecimator(size_t columns, std::chrono::microseconds span) {
+    resize(columns, span);
+}
+
+void PlotDecimator::resize(size_t columns, std::chrono::microseconds span) {
+    columnCount = std::max<size_t>(columns, 1);
+    columnWidth = std::max<int64_t>(span.count() / static_cast<int64_t>(columnCount), 1);
+    ring.assign(columnCount, PlotColumn{});
+    newestBucket = -1;
+    started = false;
+}
+
+void PlotDecimator::advanceTo(int64_t timestampUs) {
+    int64_t bucket = timestampUs / columnWidth;
+    if (!started) {
+        newestBucket = bucket;
+        started = true;
+        return;
+    }
+    if (bucket <= newestBucket) {
+        return;
+    }
+
+    // Clear the columns scrolling in; a jump longer than the plot clears all
+    int64_t steps = std::min<int64_t>(bucket - newestBucket, static_cast<int64_t>(columnCount));
+    for (int64_t i = 1; i <= steps; ++i) {
+        ring[static_cast<size_t>(newestBucket + i) % columnCount] = PlotColumn{};
+    }
+    newestBucket = bucket;
+}
+
+void PlotDecimator::add(const LiveSample& sample) {
+    advanceTo(sample.timestampUs);
+
+    int64_t bucket = sample.timestampUs / columnWidth;
+    if (bucket <= newestBucket - static_cast<int64_t>(columnCount)) {
+        return;     // Already scrolled out
+    }
+
+    PlotColumn& column = ring[static_cast<size_t>(bucket) % columnCount];
+    if (column.count == 0) {
+        column.min = column.max = column.first = sample.value;
+    } else {
+        column.min = std::min(column.min, sample.value);
+        column.max = std::max(column.max, sample.value);
+    }
+    column.last = sample.value;
+    column.count++;
+}
+
+void PlotDecimator::add(const std::vector<LiveSample>& samples) {
+    for (const auto& sample : samples) {
+        add(sample);
+    }
+}
+
+void PlotDecimator::clear() {
+    std::fill(ring.begin(), ring.end(), PlotColumn{});
+    newestBucket = -1;
+    started = false;
+}
+
+void PlotDecimator::getColumns(std::vector<PlotColumn>& columns) const {
+    columns.resize(columnCount);
+    if (!started) {
+        std::fill(columns.begin(), columns.end(), PlotColumn{});
+        return;
+    }
+
+    // Oldest visible bucket is newestBucket - columnCount + 1
+    size_t start = static_cast<size_t>(newestBucket + 1) % columnCount;
+    for (size_t i = 0; i < columnCount; ++i) {
+        columns[i] = ring[(start + i) % columnCount];
+    }
+}
+
+bool PlotDecimator::getRange(double& min, double& max) const {
+    bool found = false;
+    for (const auto& column : ring) {
+        if (column.count == 0) {
+            continue;
+        }
+        if (!found) {
+            min = column.min;
+            max = column.max;
+            found = true;
+        } else {
+            min = std::min(min, column.min);
+            max = std::max(max, column.max);
+        }
+    }
+    return found;
+}
+
+} // namespace gui
+} // namespace fmus
@@ -0,0 +1,162 @@
+#include <fmus/gui/render_thread.h>
+#include <fmus/logger.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fmus {
+namespace gui {
+
+class RenderThread::Impl {
+public:
+    std::atomic<double> refreshRate;
+    std::atomic<bool> running{false};
+    std::thread thread;
+
+    std::mutex stopMutex;
+    std::condition_variable stopCondition;
+
+    // Held for the whole frame, so removeWidget() waits for a frame in progress
+    std::mutex frameMutex;
+    std::vector<Widget*> widgets;
+    std::function<void()> frameCallback;
+
+    Statistics statistics;
+    mutable std::mutex statsMutex;
+
+    explicit Impl(double rate) : refreshRate(rate) {}
+
+    std::chrono::steady_clock::duration framePeriod() const {
+        double rate = std::max(refreshRate.load(), 1.0);
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / rate));
+    }
+
+    void renderFrame() {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        for (Widget* widget : widgets) {
+            try {
+                widget->update();
+            } catch (const std::exception& e) {
+                Logger::getInstance()->error("Widget '" + widget->getName() + "' update threw: " + e.what());
+            }
+        }
+        if (frameCallback) {
+            frameCallback();
+        }
+    }
+
+    void loop() {
+        auto deadline = std::chrono::steady_clock::now();
+
+        while (running) {
+            auto start = std::chrono::steady_clock::now();
+            renderFrame();
+            auto end = std::chrono::steady_clock::now();
+            auto frameTime = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+            auto period = framePeriod();
+            deadline += period;
+            uint64_t skipped = 0;
+            if (deadline < end) {
+                auto behind = end - deadline;
+                auto missed = behind / period + 1;
+                deadline += missed * period;
+                skipped = static_cast<uint64_t>(missed);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                statistics.framesRendered++;
+                statistics.framesSkipped += skipped;
+                statistics.lastFrameTime = frameTime;
+                statistics.maxFrameTime = std::max(statistics.maxFrameTime, frameTime);
+                // Exponential moving average over roughly the last 16 frames
+                statistics.averageFrameTime = statistics.framesRendered == 1
+                    ? frameTime
+                    : (statistics.averageFrameTime * 15 + frameTime) / 16;
+            }
+
+            std::unique_lock<std::mutex> lock(stopMutex);
+            stopCondition.wait_until(lock, deadline, [this] { return !running; });
+        }
+    }
+};
+
+RenderThread::RenderThread(double refreshRate)
+    : pImpl(std::make_unique<Impl>(refreshRate)) {}
+
+RenderThread::~RenderThread() {
+    stop();
+}
+
+void RenderThread::addWidget(Widget* widget) {
+    if (!widget) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(pImpl->frameMutex);
+    if (std::find(pImpl->widgets.begin(), pImpl->widgets.end(), widget) == pImpl->widgets.end()) {
+        pImpl->widgets.push_back(widget);
+    }
+}
+
+void RenderThread::removeWidget(Widget* widget) {
+    std::lock_guard<std::mutex> lock(pImpl->frameMutex);
+    pImpl->widgets.erase(std::remove(pImpl->widgets.begin(), pImpl->widgets.end(), widget),
+                         pImpl->widgets.end());
+}
+
+void RenderThread::setFrameCallback(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(pImpl->frameMutex);
+    pImpl->frameCallback = std::move(callback);
+}
+
+void RenderThread::setRefreshRate(double refreshRate) {
+    pImpl->refreshRate = refreshRate;
+}
+
+double RenderThread::getRefreshRate() const {
+    return pImpl->refreshRate;
+}
+
+bool RenderThread::start() {
+    if (pImpl->running.exchange(true)) {
+        return false;
+    }
+    pImpl->thread = std::thread([this] { pImpl->loop(); });
+    Logger::getInstance()->debug("Render thread started at " + std::to_string(pImpl->refreshRate.load()) + " Hz");
+    return true;
+}
+
+void RenderThread::stop() {
+    {
+        std::lock_guard<std::mutex> lock(pImpl->stopMutex);
+        if (!pImpl->running.exchange(false)) {
+            return;
+        }
+    }
+    pImpl->stopCondition.notify_all();
+    if (pImpl->thread.joinable()) {
+        pImpl->thread.join();
+    }
+}
+
+bool RenderThread::isRunning() const {
+    return pImpl->running;
+}
+
+RenderThread::Statistics RenderThread::getStatistics() const {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    return pImpl->statistics;
+}
+
+void RenderThread::resetStatistics() {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    pImpl->statistics = Statistics{};
+}
+
+} // namespace gui
+} // namespace fmus
@@ -0,0 +1,469 @@
+#include <fmus/j2534/channel.h>
+#include <fmus/logger.h>
+#include <atomic>
+#include <mutex>
+#include <sstream>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace fmus {
+namespace j2534 {
+
+namespace {
+
+constexpr size_t PASSTHRU_DATA_SIZE = sizeof(PASSTHRU_MSG::Data);
+
+bool carriesCANId(Protocol protocol) {
+    return protocol == Protocol::CAN || protocol == Protocol::ISO15765;
+}
+
+void toPassThru(const Message& message, Protocol protocol, PASSTHRU_MSG& out) {
+    size_t offset = carriesCANId(protocol) ? 4 : 0;
+    if (message.data.size() + offset > PASSTHRU_DATA_SIZE) {
+        throw J2534Error(ErrorCode::ERR_INVALID_MSG, "Message too long for PASSTHRU_MSG");
+    }
+
+    out.ProtocolID = static_cast<unsigned long>(protocol);
+    out.RxStatus = 0;
+    out.TxFlags = message.flags;
+    out.Timestamp = 0;
+    out.ExtraDataIndex = 0;
+    out.DataSize = static_cast<unsigned long>(message.data.size() + offset);
+    if (offset) {
+        out.Data[0] = static_cast<unsigned char>(message.id >> 24);
+        out.Data[1] = static_cast<unsigned char>(message.id >> 16);
+        out.Data[2] = static_cast<unsigned char>(message.id >> 8);
+        out.Data[3] = static_cast<unsigned char>(message.id);
+    }
+    if (!message.data.empty()) {
+        std::memcpy(out.Data + offset, message.data.data(), message.data.size());
+    }
+}
+
+Message fromPassThru(const PASSTHRU_MSG& in, Protocol protocol) {
+    Message message;
+    message.protocol = protocol;
+    message.flags = static_cast<uint32_t>(in.RxStatus);
+    message.timestamp = static_cast<uint32_t>(in.Timestamp);
+
+    size_t size = std::min<size_t>(in.DataSize, PASSTHRU_DATA_SIZE);
+    size_t offset = 0;
+    if (carriesCANId(protocol) && size >= 4) {
+        message.id = (static_cast<uint32_t>(in.Data[0]) << 24) | (static_cast<uint32_t>(in.Data[1]) << 16) |
+                     (static_cast<uint32_t>(in.Data[2]) << 8) | in.Data[3];
+        offset = 4;
+    }
+    message.data.assign(in.Data + offset, in.Data + size);
+    return message;
+}
+
+template<typename Function>
+Function require(Function function, const char* name) {
+    if (!function) {
+        throw J2534Error(ErrorCode::ERR_NOT_SUPPORTED, std::string(name) + " not available in J2534 library");
+    }
+    return function;
+}
+
+} // anonymous namespace
+
+void checkPassThruResult(const LibraryLoader& library, long code, const std::string& operation) {
+    if (code == static_cast<long>(ErrorCode::STATUS_NOERROR)) {
+        return;
+    }
+
+    std::string message = formatErrorMessage(static_cast<ErrorCode>(code), operation);
+    if (library.passThruGetLastError) {
+        char description[80] = {0};
+        if (library.passThruGetLastError(description) == 0 && description[0]) {
+            message += " (" + std::string(description) + ")";
+        }
+    }
+    throw J2534Error(static_cast<int>(code), message);
+}
+
+// PassThruChannel implementation
+class PassThruChannel::Impl {
+public:
+    std::shared_ptr<LibraryLoader> library;
+    unsigned long channelId = 0;
+    Protocol protocol = Protocol::CAN;
+    uint32_t flags = 0;
+    uint32_t baudRate = 0;
+    std::atomic<bool> connected{false};
+
+    Statistics statistics;
+    mutable std::mutex statsMutex;
+
+    void check(long code, const std::string& operation) {
+        if (code != static_cast<long>(ErrorCode::STATUS_NOERROR)) {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            statistics.errors++;
+        }
+        checkPassThruResult(*library, code, operation);
+    }
+
+    void ioctl(unsigned long id, void* input, void* output, const std::string& operation) {
+        check(require(library->passThruIoctl, "PassThruIoctl")(channelId, id, input, output), operation);
+    }
+};
+
+PassThruChannel::PassThruChannel(std::shared_ptr<LibraryLoader> library, unsigned long channelId,
+                                 Protocol protocol, uint32_t flags, uint32_t baudRate)
+    : pImpl(std::make_unique<Impl>()) {
+    pImpl->library = std::move(library);
+    pImpl->channelId = channelId;
+    pImpl->protocol = protocol;
+    pImpl->flags = flags;
+    pImpl->baudRate = baudRate;
+    pImpl->connected = true;
+    pImpl->statistics.startTime = std::chrono::system_clock::now();
+}
+
+PassThruChannel::~PassThruChannel() {
+    try {
+        disconnect();
+    } catch (const J2534Error& e) {
+        Logger::getInstance()->warning(std::string("PassThruDisconnect failed: ") + e.what());
+    }
+}
+
+Protocol PassThruChannel::getProtocol() const {
+    return pImpl->protocol;
+}
+
+unsigned long PassThruChannel::getChannelId() const {
+    return pImpl->channelId;
+}
+
+uint32_t PassThruChannel::getBaudRate() const {
+    return pImpl->baudRate;
+}
+
+bool PassThruChannel::isConnected() const {
+    return pImpl->connected;
+}
+
+void PassThruChannel::disconnect() {
+    if (!pImpl->connected.exchange(false)) {
+        return;
+    }
+    if (pImpl->library->passThruDisconnect) {
+        pImpl->check(pImpl->library->passThruDisconnect(pImpl->channelId), "PassThruDisconnect");
+    }
+}
+
+void PassThruChannel::setConfig(const std::vector<SCONFIG>& parameters) {
+    if (parameters.empty()) {
+        return;
+    }
+    std::vector<SCONFIG> copy(parameters);
+    SCONFIG_LIST list{static_cast<unsigned long>(copy.size()), copy.data()};
+    pImpl->ioctl(J2534Constants::SET_CONFIG, &list, nullptr, "SET_CONFIG");
+}
+
+void PassThruChannel::setConfig(unsigned long parameter, unsigned long value) {
+    setConfig(std::vector<SCONFIG>{{parameter, value}});
+}
+
+unsigned long PassThruChannel::getConfig(unsigned long parameter) {
+    SCONFIG config{parameter, 0};
+    SCONFIG_LIST list{1, &config};
+    pImpl->ioctl(J2534Constants::GET_CONFIG, &list, nullptr, "GET_CONFIG");
+    return config.Value;
+}
+
+std::vector<uint8_t> PassThruChannel::fiveBaudInit(uint8_t address) {
+    unsigned char input[1] = {address};
+    unsigned char output[2] = {0, 0};
+    SBYTE_ARRAY inputArray{1, input};
+    SBYTE_ARRAY outputArray{2, output};
+    pImpl->ioctl(J2534Constants::FIVE_BAUD_INIT, &inputArray, &outputArray, "FIVE_BAUD_INIT");
+    return std::vector<uint8_t>(output, output + std::min<unsigned long>(outputArray.NumOfBytes, 2));
+}
+
+Message PassThruChannel::fastInit(const Message& request) {
+    auto input = std::make_unique<PASSTHRU_MSG>();
+    auto output = std::make_unique<PASSTHRU_MSG>();
+    toPassThru(request, pImpl->protocol, *input);
+    std::memset(output.get(), 0, offsetof(PASSTHRU_MSG, Data));
+    output->ProtocolID = static_cast<unsigned long>(pImpl->protocol);
+    pImpl->ioctl(J2534Constants::FAST_INIT, input.get(), output.get(), "FAST_INIT");
+    return fromPassThru(*output, pImpl->protocol);
+}
+
+void PassThruChannel::clearReceiveBuffer() {
+    pImpl->ioctl(J2534Constants::CLEAR_RX_BUFFER, nullptr, nullptr, "CLEAR_RX_BUFFER");
+}
+
+void PassThruChannel::clearTransmitBuffer() {
+    pImpl->ioctl(J2534Constants::CLEAR_TX_BUFFER, nullptr, nullptr, "CLEAR_TX_BUFFER");
+}
+
+size_t PassThruChannel::writeMessages(const std::vector<Message>& messages, uint32_t timeoutMs) {
+    if (messages.empty()) {
+        return 0;
+    }
+
+    std::vector<PASSTHRU_MSG> buffer(messages.size());
+    for (size_t i = 0; i < messages.size(); ++i) {
+        toPassThru(messages[i], pImpl->protocol, buffer[i]);
+    }
+
+    unsigned long count = static_cast<unsigned long>(buffer.size());
+    long result = require(pImpl->library->passThruWriteMsgs, "PassThruWriteMsgs")(
+        pImpl->channelId, buffer.data(), &count, timeoutMs);
+    if (result != static_cast<long>(ErrorCode::ERR_TIMEOUT)) {
+        pImpl->check(result, "PassThruWriteMsgs");
+    }
+
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    pImpl->statistics.messagesWritten += count;
+    return count;
+}
+
+bool PassThruChannel::writeMessage(const Message& message, uint32_t timeoutMs) {
+    return writeMessages({message}, timeoutMs) == 1;
+}
+
+size_t PassThruChannel::readMessages(std::vector<Message>& messages, size_t maxMessages, uint32_t timeoutMs) {
+    if (maxMessages == 0) {
+        return 0;
+    }
+
+    // PASSTHRU_MSG is over 4 KiB; keep one buffer per reading thread
+    thread_local std::vector<PASSTHRU_MSG> buffer;
+    if (buffer.size() < maxMessages) {
+        buffer.resize(maxMessages);
+    }
+
+    unsigned long count = static_cast<unsigned long>(maxMessages);
+    long result = require(pImpl->library->passThruReadMsgs, "PassThruReadMsgs")(
+        pImpl->channelId, buffer.data(), &count, timeoutMs);
+    if (result != static_cast<long>(ErrorCode::ERR_TIMEOUT) &&
+        result != static_cast<long>(ErrorCode::ERR_BUFFER_EMPTY)) {
+        pImpl->check(result, "PassThruReadMsgs");
+    }
+
+    count = std::min<unsigned long>(count, static_cast<unsigned long>(maxMessages));
+    for (unsigned long i = 0; i < count; ++i) {
+        messages.push_back(fromPassThru(buffer[i], pImpl->protocol));
+    }
+
+    if (count > 0) {
+        std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+        pImpl->statistics.messagesRead += count;
+    }
+    return count;
+}
+
+unsigned long PassThruChannel::startFilter(const Filter& filter) {
+    auto mask = std::make_unique<PASSTHRU_MSG>();
+    auto pattern = std::make_unique<PASSTHRU_MSG>();
+    std::unique_ptr<PASSTHRU_MSG> flowControl;
+
+    toPassThru(Message(pImpl->protocol, filter.maskId, filter.maskData), pImpl->protocol, *mask);
+    toPassThru(Message(pImpl->protocol, filter.patternId, filter.patternData), pImpl->protocol, *pattern);
+    mask->TxFlags = pattern->TxFlags = filter.flags;
+    if (filter.filterType == FilterType::FLOW_CONTROL_FILTER) {
+        flowControl = std::make_unique<PASSTHRU_MSG>();
+        Message fc(pImpl->protocol, 0, filter.flowControlData);
+        if (carriesCANId(pImpl->protocol) && filter.flowControlData.size() >= 4) {
+            // Flow control data given as ID bytes followed by nothing
+            fc.id = (static_cast<uint32_t>(filter.flowControlData[0]) << 24) |
+                    (static_cast<uint32_t>(filter.flowControlData[1]) << 16) |
+                    (static_cast<uint32_t>(filter.flowControlData[2]) << 8) | filter.flowControlData[3];
+            fc.data.assign(filter.flowControlData.begin() + 4, filter.flowControlData.end());
+        }
+        toPassThru(fc, pImpl->protocol, *flowControl);
+        flowControl->TxFlags = filter.flags;
+    }
+
+    unsigned long filterId = 0;
+    pImpl->check(require(pImpl->library->passThruStartMsgFilter, "PassThruStartMsgFilter")(
+                     pImpl->channelId, static_cast<unsigned long>(filter.filterType), mask.get(),
+                     pattern.get(), flowControl.get(), &filterId),
+                 "PassThruStartMsgFilter");
+    return filterId;
+}
+
+void PassThruChannel::stopFilter(unsigned long filterId) {
+    pImpl->check(require(pImpl->library->passThruStopMsgFilter, "PassThruStopMsgFilter")(
+                     pImpl->channelId, filterId),
+                 "PassThruStopMsgFilter");
+}
+
+unsigned long PassThruChannel::startPassAllFilter() {
+    Filter filter(pImpl->protocol, FilterType::PASS_FILTER, 0, 0);
+    if (!carriesCANId(pImpl->protocol)) {
+        filter.maskData = {0x00};
+        filter.patternData = {0x00};
+    }
+    return startFilter(filter);
+}
+
+unsigned long PassThruChannel::startPeriodicMessage(const Message& message, uint32_t intervalMs) {
+    auto buffer = std::make_unique<PASSTHRU_MSG>();
+    toPassThru(message, pImpl->protocol, *buffer);
+    unsigned long messageId = 0;
+    pImpl->check(require(pImpl->library->passThruStartPeriodicMsg, "PassThruStartPeriodicMsg")(
+                     pImpl->channelId, buffer.get(), &messageId, intervalMs),
+                 "PassThruStartPeriodicMsg");
+    return messageId;
+}
+
+void PassThruChannel::stopPeriodicMessage(unsigned long messageId) {
+    pImpl->check(require(pImpl->library->passThruStopPeriodicMsg, "PassThruStopPeriodicMsg")(
+                     pImpl->channelId, messageId),
+                 "PassThruStopPeriodicMsg");
+}
+
+PassThruChannel::Statistics PassThruChannel::getStatistics() const {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    return pImpl->statistics;
+}
+
+void PassThruChannel::resetStatistics() {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    pImpl->statistics = Statistics{};
+    pImpl->statistics.startTime = std::chrono::system_clock::now();
+}
+
+std::string PassThruChannel::toString() const {
+    std::ostringstream oss;
+    oss << "PassThruChannel[ID:" << pImpl->channelId
+        << ", Protocol:" << protocolToString(pImpl->protocol)
+        << ", Baud:" << pImpl->baudRate
+        << ", Flags:0x" << std::hex << pImpl->flags << std::dec
+        << ", Connected:" << (pImpl->connected ? "Yes" : "No") << "]";
+    return oss.str();
+}
+
+// PassThruDevice implementation
+class PassThruDevice::Impl {
+public:
+    std::shared_ptr<LibraryLoader> library;
+    unsigned long deviceId = 0;
+    bool opened = false;
+    std::string lastError;
+};
+
+PassThruDevice::PassThruDevice() : pImpl(std::make_unique<Impl>()) {}
+
+PassThruDevice::~PassThruDevice() {
+    close();
+}
+
+bool PassThruDevice::open(const std::string& libraryPath, const std::string& deviceName) {
+    auto library = std::make_shared<LibraryLoader>();
+    if (!library->loadLibrary(libraryPath)) {
+        pImpl->lastError = library->getLastError();
+        return false;
+    }
+    return open(library, deviceName);
+}
+
+bool PassThruDevice::open(std::shared_ptr<LibraryLoader> library, const std::string& deviceName) {
+    close();
+
+    if (!library || !library->isLoaded() || !library->passThruOpen) {
+        pImpl->lastError = "J2534 library not loaded";
+        return false;
+    }
+
+    std::string name = deviceName;
+    unsigned long deviceId = 0;
+    long result = library->passThruOpen(name.empty() ? nullptr : &name[0], &deviceId);
+    try {
+        checkPassThruResult(*library, result, "PassThruOpen");
+    } catch (const J2534Error& e) {
+        pImpl->lastError = e.what();
+        Logger::getInstance()->error(pImpl->lastError);
+        return false;
+    }
+
+    pImpl->library = std::move(library);
+    pImpl->deviceId = deviceId;
+    pImpl->opened = true;
+    pImpl->lastError.clear();
+    Logger::getInstance()->info("Opened PassThru device " + std::to_string(deviceId));
+    return true;
+}
+
+void PassThruDevice::close() {
+    if (!pImpl->opened) {
+        return;
+    }
+    pImpl->opened = false;
+    if (pImpl->library->passThruClose) {
+        pImpl->library->passThruClose(pImpl->deviceId);
+    }
+}
+
+bool PassThruDevice::isOpen() const {
+    return pImpl->opened;
+}
+
+std::shared_ptr<PassThruChannel> PassThruDevice::connect(Protocol protocol, uint32_t flags, uint32_t baudRate,
+                                                         uint32_t dataBaudRate) {
+    if (!pImpl->opened) {
+        throw J2534Error(ErrorCode::ERR_DEVICE_NOT_CONNECTED, "PassThru device not open");
+    }
+
+    unsigned long channelId = 0;
+    checkPassThruResult(*pImpl->library,
+                        require(pImpl->library->passThruConnect, "PassThruConnect")(
+                            pImpl->deviceId, static_cast<unsigned long>(protocol), flags, baudRate, &channelId),
+                        "PassThruConnect");
+
+    auto channel = std::shared_ptr<PassThruChannel>(
+        new PassThruChannel(pImpl->library, channelId, protocol, flags, baudRate));
+    if ((flags & J2534Constants::CAN_FD_FORMAT) && dataBaudRate) {
+        // Disconnected again by the channel's destructor if the adapter refuses the rate
+        channel->setConfig(J2534Constants::FD_CAN_DATA_PHASE_RATE, dataBaudRate);
+    }
+    Logger::getInstance()->debug("Connected " + channel->toString());
+    return channel;
+}
+
+uint32_t PassThruDevice::readBatteryVoltage() {
+    if (!pImpl->opened) {
+        throw J2534Error(ErrorCode::ERR_DEVICE_NOT_CONNECTED, "PassThru device not open");
+    }
+    unsigned long voltage = 0;
+    checkPassThruResult(*pImpl->library,
+                        require(pImpl->library->passThruIoctl, "PassThruIoctl")(
+                            pImpl->deviceId, J2534Constants::READ_VBATT, nullptr, &voltage),
+                        "READ_VBATT");
+    return static_cast<uint32_t>(voltage);
+}
+
+PassThruDevice::Version PassThruDevice::readVersion() {
+    if (!pImpl->opened) {
+        throw J2534Error(ErrorCode::ERR_DEVICE_NOT_CONNECTED, "PassThru device not open");
+    }
+    char firmware[80] = {0};
+    char dll[80] = {0};
+    char api[80] = {0};
+    checkPassThruResult(*pImpl->library,
+                        require(pImpl->library->passThruReadVersion, "PassThruReadVersion")(
+                            pImpl->deviceId, firmware, dll, api),
+                        "PassThruReadVersion");
+    return Version{firmware, dll, api};
+}
+
+unsigned long PassThruDevice::getDeviceId() const {
+    return pImpl->deviceId;
+}
+
+std::shared_ptr<LibraryLoader> PassThruDevice::getLibrary() const {
+    return pImpl->library;
+}
+
+std::string PassThruDevice::getLastError() const {
+    return pImpl->lastError;
+}
+
+} // namespace j2534
+} // namespace fmus
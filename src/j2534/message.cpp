@@ -96,7 +96,13 @@ std::string ConnectionOptions::toString() const {
        << ", DeviceID: " << deviceId
        << ", Protocol: " << static_cast<uint32_t>(protocol)
        << ", BaudRate: " << static_cast<uint32_t>(baudRate)
-       << ", Flags: 0x" << std::hex << flags << "]";
+       << ", Flags: 0x" << std::hex << flags;
+    if (backend == Backend::SOCKETCAN) {
+        ss << ", SocketCAN: " << interfaceName;
+    } else if (backend == Backend::PLUGIN) {
+        ss << ", Plugin: " << interfaceName;
+    }
+    ss << "]";
     return ss.str();
 }
 
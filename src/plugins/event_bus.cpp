@@ -0,0 +1,513 @@
+#include <fmus/plugins/event_bus.h>
+#include <fmus/logger.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <sstream>
+
+namespace fmus {
+namespace plugins {
+
+// Global event bus instance
+static std::shared_ptr<EventBus> globalEventBus = nullptr;
+static std::mutex globalEventBusMutex;
+
+namespace {
+
+size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 2;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+void updateMax(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (current < value &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * Bounded multi-producer queue (Vyukov sequence-per-cell design).
+ * Publishers on any thread push; the subscriber's delivery thread pops.
+ */
+class EventQueue {
+public:
+    explicit EventQueue(size_t capacity)
+        : cells(new Cell[roundUpToPowerOfTwo(capacity)]),
+          mask(roundUpToPowerOfTwo(capacity) - 1) {
+        for (size_t i = 0; i <= mask; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool tryPush(const Event& event) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.event = event;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Full
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(Event& event) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell& cell = cells[pos & mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1) < 0) {
+            return false; // Empty
+        }
+        dequeuePos.store(pos + 1, std::memory_order_relaxed);
+        event = std::move(cell.event);
+        cell.event.payload.reset();
+        cell.sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * True once the next event is fully published, which is what tryPop needs
+     */
+    bool ready() const {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        size_t sequence = cells[pos & mask].sequence.load(std::memory_order_acquire);
+        return static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1) >= 0;
+    }
+
+    size_t size() const {
+        size_t head = dequeuePos.load(std::memory_order_relaxed);
+        size_t tail = enqueuePos.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        Event event;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    const size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) std::atomic<size_t> dequeuePos{0};
+};
+
+struct Subscriber {
+    SubscriptionId id = INVALID_SUBSCRIPTION_ID;
+    std::string name;
+    EventId eventId = INVALID_EVENT_ID;
+    EventHandler handler;
+    EventQueue queue;
+
+    std::atomic<bool> running{true};
+    std::atomic<bool> sleeping{false};
+    std::atomic<bool> busy{false};
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::thread thread;
+
+    std::atomic<uint64_t> delivered{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> handlerErrors{0};
+    std::atomic<uint64_t> latencyTotalNs{0};
+    std::atomic<uint64_t> latencyMaxNs{0};
+    std::atomic<uint64_t> handlerTotalNs{0};
+    std::atomic<uint64_t> handlerMaxNs{0};
+
+    Subscriber(size_t capacity) : queue(capacity) {}
+
+    bool enqueue(const Event& event) {
+        if (!queue.tryPush(event)) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        // Pairs with the fence in run(): either the publisher sees the
+        // subscriber going to sleep, or the subscriber sees the event
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            wakeCondition.notify_one();
+        }
+        return true;
+    }
+
+    void stop() {
+        running = false;
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            wakeCondition.notify_one();
+        }
+        if (thread.joinable()) {
+            // A handler may unsubscribe itself; it cannot join its own thread
+            if (thread.get_id() == std::this_thread::get_id()) {
+                thread.detach();
+            } else {
+                thread.join();
+            }
+        }
+    }
+
+    void run() {
+        Event event;
+        while (running) {
+            if (!queue.tryPop(event)) {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                sleeping.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                wakeCondition.wait(lock, [this] {
+                    return !running || queue.ready();
+                });
+                sleeping.store(false, std::memory_order_relaxed);
+                continue;
+            }
+
+            busy = true;
+            deliver(event);
+            event.payload.reset();
+            busy = false;
+        }
+    }
+
+    void deliver(const Event& event) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t latencyNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(start - event.published).count());
+
+        try {
+            handler(event);
+        } catch (const std::exception& e) {
+            handlerErrors.fetch_add(1, std::memory_order_relaxed);
+            Logger::getInstance()->warning("Event handler '" + name + "' threw: " + e.what());
+        } catch (...) {
+            handlerErrors.fetch_add(1, std::memory_order_relaxed);
+            Logger::getInstance()->warning("Event handler '" + name + "' threw an unknown exception");
+        }
+
+        uint64_t handlerNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+
+        delivered.fetch_add(1, std::memory_order_relaxed);
+        latencyTotalNs.fetch_add(latencyNs, std::memory_order_relaxed);
+        handlerTotalNs.fetch_add(handlerNs, std::memory_order_relaxed);
+        updateMax(latencyMaxNs, latencyNs);
+        updateMax(handlerMaxNs, handlerNs);
+    }
+
+    bool idle() const {
+        return queue.size() == 0 && !busy.load();
+    }
+};
+
+// Immutable routing table, replaced wholesale on subscribe/unsubscribe
+struct Routing {
+    std::vector<std::vector<std::shared_ptr<Subscriber>>> byEvent;
+};
+
+std::chrono::microseconds averageMicros(uint64_t totalNs, uint64_t count) {
+    return std::chrono::microseconds(count ? totalNs / count / 1000 : 0);
+}
+
+} // anonymous namespace
+
+class EventBus::Impl {
+public:
+    mutable std::mutex registryMutex;
+    std::map<std::string, EventId> eventIds;
+    std::vector<std::string> eventNames{""};  // Index 0 is INVALID_EVENT_ID
+    std::map<SubscriptionId, std::shared_ptr<Subscriber>> subscribers;
+    SubscriptionId nextSubscriptionId = 1;
+
+    std::shared_ptr<const Routing> routing = std::make_shared<Routing>();
+
+    std::atomic<uint64_t> eventsPublished{0};
+    std::atomic<uint64_t> eventsQueued{0};
+    std::atomic<uint64_t> eventsDropped{0};
+    std::atomic<uint64_t> eventsWithoutSubscribers{0};
+    std::chrono::system_clock::time_point startTime = std::chrono::system_clock::now();
+    mutable std::mutex statsMutex;
+
+    // Caller holds registryMutex
+    void rebuildRouting() {
+        auto updated = std::make_shared<Routing>();
+        updated->byEvent.resize(eventNames.size());
+        for (const auto& entry : subscribers) {
+            updated->byEvent[entry.second->eventId].push_back(entry.second);
+        }
+        std::atomic_store(&routing, std::shared_ptr<const Routing>(std::move(updated)));
+    }
+
+    std::shared_ptr<const Routing> currentRouting() const {
+        return std::atomic_load(&routing);
+    }
+};
+
+// SubscriberStatistics implementation
+std::string EventBus::SubscriberStatistics::toString() const {
+    std::ostringstream ss;
+    ss << "Subscriber[" << subscriber << ", Event:" << eventId
+       << ", Delivered:" << delivered << ", Dropped:" << dropped
+       << ", Queued:" << queued << "/" << queueCapacity
+       << ", Latency:" << averageLatency.count() << "us (max " << maxLatency.count() << "us)"
+       << ", Handler:" << averageHandlerTime.count() << "us (max " << maxHandlerTime.count() << "us)]";
+    return ss.str();
+}
+
+// EventBus implementation
+EventBus::EventBus() : pImpl(std::make_unique<Impl>()) {}
+
+EventBus::~EventBus() {
+    shutdown();
+}
+
+EventId EventBus::registerEvent(const std::string& name) {
+    std::lock_guard<std::mutex> lock(pImpl->registryMutex);
+
+    auto it = pImpl->eventIds.find(name);
+    if (it != pImpl->eventIds.end()) {
+        return it->second;
+    }
+
+    EventId id = static_cast<EventId>(pImpl->eventNames.size());
+    pImpl->eventIds[name] = id;
+    pImpl->eventNames.push_back(name);
+    pImpl->rebuildRouting();
+    return id;
+}
+
+EventId EventBus::findEvent(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(pImpl->registryMutex);
+    auto it = pImpl->eventIds.find(name);
+    return it != pImpl->eventIds.end() ? it->second : INVALID_EVENT_ID;
+}
+
+std::string EventBus::getEventName(EventId id) const {
+    std::lock_guard<std::mutex> lock(pImpl->registryMutex);
+    return id < pImpl->eventNames.size() ? pImpl->eventNames[id] : std::string();
+}
+
+SubscriptionId EventBus::subscribe(EventId id, const std::string& subscriber, EventHandler handler,
+                                   size_t queueCapacity) {
+    if (!handler) {
+        return INVALID_SUBSCRIPTION_ID;
+    }
+
+    std::lock_guard<std::mutex> lock(pImpl->registryMutex);
+    if (id == INVALID_EVENT_ID || id >= pImpl->eventNames.size()) {
+        return INVALID_SUBSCRIPTION_ID;
+    }
+
+    auto entry = std::make_shared<Subscriber>(queueCapacity);
+    entry->id = pImpl->nextSubscriptionId++;
+    entry->name = subscriber;
+    entry->eventId = id;
+    entry->handler = std::move(handler);
+    entry->thread = std::thread([entry]() { entry->run(); });
+
+    pImpl->subscribers[entry->id] = entry;
+    pImpl->rebuildRouting();
+
+    auto logger = Logger::getInstance();
+    logger->debug("Event bus: '" + subscriber + "' subscribed to '" + pImpl->eventNames[id] + "'");
+
+    return entry->id;
+}
+
+bool EventBus::unsubscribe(SubscriptionId subscription) {
+    std::shared_ptr<Subscriber> entry;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->registryMutex);
+        auto it = pImpl->subscribers.find(subscription);
+        if (it == pImpl->subscribers.end()) {
+            return false;
+        }
+        entry = it->second;
+        pImpl->subscribers.erase(it);
+        pImpl->rebuildRouting();
+    }
+
+    entry->stop();
+    return true;
+}
+
+size_t EventBus::unsubscribeAll(const std::string& subscriber) {
+    std::vector<std::shared_ptr<Subscriber>> removed;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->registryMutex);
+        for (auto it = pImpl->subscribers.begin(); it != pImpl->subscribers.end();) {
+            if (it->second->name == subscriber) {
+                removed.push_back(it->second);
+                it = pImpl->subscribers.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (!removed.empty()) {
+            pImpl->rebuildRouting();
+        }
+    }
+
+    for (auto& entry : removed) {
+        entry->stop();
+    }
+    return removed.size();
+}
+
+size_t EventBus::publish(EventId id, std::shared_ptr<const EventPayload> payload) {
+    pImpl->eventsPublished.fetch_add(1, std::memory_order_relaxed);
+
+    auto routing = pImpl->currentRouting();
+    if (id >= routing->byEvent.size() || routing->byEvent[id].empty()) {
+        pImpl->eventsWithoutSubscribers.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+
+    Event event;
+    event.id = id;
+    event.published = std::chrono::steady_clock::now();
+    event.payload = std::move(payload);
+
+    size_t queued = 0;
+    for (const auto& subscriber : routing->byEvent[id]) {
+        if (subscriber->enqueue(event)) {
+            queued++;
+        } else {
+            pImpl->eventsDropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    pImpl->eventsQueued.fetch_add(queued, std::memory_order_relaxed);
+    return queued;
+}
+
+bool EventBus::hasSubscribers(EventId id) const {
+    auto routing = pImpl->currentRouting();
+    return id < routing->byEvent.size() && !routing->byEvent[id].empty();
+}
+
+bool EventBus::flush(std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    for (;;) {
+        auto routing = pImpl->currentRouting();
+        bool idle = true;
+        for (const auto& subscribers : routing->byEvent) {
+            for (const auto& subscriber : subscribers) {
+                if (!subscriber->idle()) {
+                    idle = false;
+                    break;
+                }
+            }
+            if (!idle) break;
+        }
+
+        if (idle) {
+            return true;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void EventBus::shutdown() {
+    std::map<SubscriptionId, std::shared_ptr<Subscriber>> removed;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->registryMutex);
+        removed.swap(pImpl->subscribers);
+        pImpl->rebuildRouting();
+    }
+
+    for (auto& entry : removed) {
+        entry.second->stop();
+    }
+}
+
+std::vector<EventBus::SubscriberStatistics> EventBus::getSubscriberStatistics() const {
+    std::vector<SubscriberStatistics> result;
+    std::lock_guard<std::mutex> lock(pImpl->registryMutex);
+
+    for (const auto& entry : pImpl->subscribers) {
+        const auto& subscriber = *entry.second;
+        SubscriberStatistics stats;
+        stats.subscription = subscriber.id;
+        stats.subscriber = subscriber.name;
+        stats.eventId = subscriber.eventId;
+        stats.delivered = subscriber.delivered.load(std::memory_order_relaxed);
+        stats.dropped = subscriber.dropped.load(std::memory_order_relaxed);
+        stats.handlerErrors = subscriber.handlerErrors.load(std::memory_order_relaxed);
+        stats.queued = subscriber.queue.size();
+        stats.queueCapacity = subscriber.queue.capacity();
+        stats.averageLatency = averageMicros(subscriber.latencyTotalNs.load(std::memory_order_relaxed), stats.delivered);
+        stats.maxLatency = std::chrono::microseconds(subscriber.latencyMaxNs.load(std::memory_order_relaxed) / 1000);
+        stats.averageHandlerTime = averageMicros(subscriber.handlerTotalNs.load(std::memory_order_relaxed), stats.delivered);
+        stats.maxHandlerTime = std::chrono::microseconds(subscriber.handlerMaxNs.load(std::memory_order_relaxed) / 1000);
+        result.push_back(stats);
+    }
+
+    return result;
+}
+
+EventBus::Statistics EventBus::getStatistics() const {
+    Statistics stats;
+    stats.eventsPublished = pImpl->eventsPublished.load(std::memory_order_relaxed);
+    stats.eventsQueued = pImpl->eventsQueued.load(std::memory_order_relaxed);
+    stats.eventsDropped = pImpl->eventsDropped.load(std::memory_order_relaxed);
+    stats.eventsWithoutSubscribers = pImpl->eventsWithoutSubscribers.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    stats.startTime = pImpl->startTime;
+    return stats;
+}
+
+void EventBus::resetStatistics() {
+    pImpl->eventsPublished = 0;
+    pImpl->eventsQueued = 0;
+    pImpl->eventsDropped = 0;
+    pImpl->eventsWithoutSubscribers = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(pImpl->registryMutex);
+        for (auto& entry : pImpl->subscribers) {
+            auto& subscriber = *entry.second;
+            subscriber.delivered = 0;
+            subscriber.dropped = 0;
+            subscriber.handlerErrors = 0;
+            subscriber.latencyTotalNs = 0;
+            subscriber.latencyMaxNs = 0;
+            subscriber.handlerTotalNs = 0;
+            subscriber.handlerMaxNs = 0;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    pImpl->startTime = std::chrono::system_clock::now();
+}
+
+std::shared_ptr<EventBus> getGlobalEventBus() {
+    std::lock_guard<std::mutex> lock(globalEventBusMutex);
+    if (!globalEventBus) {
+        globalEventBus = std::make_shared<EventBus>();
+    }
+    return globalEventBus;
+}
+
+} // namespace plugins
+} // namespace fmus
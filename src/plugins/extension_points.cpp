@@ -0,0 +1,495 @@
+#include <fmus/plugins/extension_points.h>
+#include <fmus/logger.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+namespace fmus {
+namespace plugins {
+
+// ExtensionTables implementation
+size_t ExtensionTables::decodeFrame(uint32_t id, const uint8_t* data, size_t length,
+                                    DecodedValue* out, size_t capacity) const {
+    size_t written = 0;
+
+    auto it = exactFrames.find(id);
+    if (it != exactFrames.end()) {
+        for (uint32_t i = it->second.first; i < it->second.second && written < capacity; ++i) {
+            const Slot& slot = frameSlots[i];
+            written += slot.function(slot.context, id, data, length, out + written, capacity - written);
+        }
+    }
+
+    for (const auto& masked : maskedFrames) {
+        if (written >= capacity) {
+            break;
+        }
+        if ((id & masked.mask) == masked.id) {
+            written += masked.slot.function(masked.slot.context, id, data, length,
+                                            out + written, capacity - written);
+        }
+    }
+
+    return written;
+}
+
+size_t ExtensionTables::decodeDataIdentifier(uint16_t did, const uint8_t* data, size_t length,
+                                             DecodedValue* out, size_t capacity) const {
+    auto it = didSlots.find(did);
+    if (it == didSlots.end() || capacity == 0) {
+        return 0;
+    }
+    return it->second.function(it->second.context, did, data, length, out, capacity);
+}
+
+size_t ExtensionTables::decodePID(uint8_t pid, const uint8_t* data, size_t length,
+                                  DecodedValue* out, size_t capacity) const {
+    const Slot& slot = pidSlots[pid];
+    if (!slot.function || capacity == 0) {
+        return 0;
+    }
+    return slot.function(slot.context, pid, data, length, out, capacity);
+}
+
+bool ExtensionTables::hasFrameDecoder(uint32_t id) const {
+    if (exactFrames.count(id)) {
+        return true;
+    }
+    return std::any_of(maskedFrames.begin(), maskedFrames.end(),
+                       [id](const MaskedSlot& masked) { return (id & masked.mask) == masked.id; });
+}
+
+bool ExtensionTables::hasDataIdentifierDecoder(uint16_t did) const {
+    return didSlots.count(did) != 0;
+}
+
+bool ExtensionTables::computeKey(const std::string& algorithm, uint8_t level,
+                                 const std::vector<uint8_t>& seed, std::vector<uint8_t>& key) const {
+    const KeySlot* slot = findSecurityAlgorithm(algorithm);
+    if (!slot) {
+        return false;
+    }
+
+    // Keys longer than the seed are rare; leave generous room regardless
+    key.resize(std::max<size_t>(seed.size() * 2, 64));
+    size_t keyLength = key.size();
+    if (!slot->function(slot->context, level, seed.data(), seed.size(), key.data(), &keyLength) ||
+        keyLength > key.size()) {
+        key.clear();
+        return false;
+    }
+    key.resize(keyLength);
+    return true;
+}
+
+const ExtensionTables::KeySlot* ExtensionTables::findSecurityAlgorithm(const std::string& algorithm) const {
+    auto it = keySlots.find(algorithm);
+    return it != keySlots.end() ? &it->second : nullptr;
+}
+
+const ExtensionTables::BackendSlot* ExtensionTables::findTransportBackend(const std::string& name) const {
+    auto it = backendSlots.find(name);
+    return it != backendSlots.end() ? &it->second : nullptr;
+}
+
+// ExtensionRegistry implementation
+namespace {
+
+enum class ExtensionKind {
+    FRAME_DECODER,
+    DID_DECODER,
+    PID_DECODER,
+    SECURITY_ALGORITHM,
+    TRANSPORT_BACKEND
+};
+
+struct Registration {
+    ExtensionHandle handle = 0;
+    ExtensionKind kind = ExtensionKind::FRAME_DECODER;
+    std::string owner;
+    std::string name;
+    uint32_t id = 0;
+    uint32_t mask = FRAME_ID_EXACT;
+    DecodeFunction decode = nullptr;
+    SecurityKeyFunction key = nullptr;
+    TransportBackendFactory factory = nullptr;
+    void* context = nullptr;
+    int priority = 0;
+};
+
+/**
+ * Order in which registrations are compiled: higher priority first, then
+ * newer first, so the most recent registration wins a tie. Single-slot
+ * tables keep the last one written, so they iterate in reverse.
+ */
+bool compileOrder(const Registration* a, const Registration* b) {
+    if (a->priority != b->priority) {
+        return a->priority > b->priority;
+    }
+    return a->handle > b->handle;
+}
+
+} // anonymous namespace
+
+class ExtensionRegistry::Impl {
+public:
+    mutable std::mutex mutex;
+    std::vector<Registration> registrations;
+    std::map<std::string, std::shared_ptr<const void>> keepAlive;   ///< Owner -> library reference
+    ExtensionHandle nextHandle = 1;
+
+    mutable std::shared_ptr<const ExtensionTables> tables = std::make_shared<ExtensionTables>();
+    mutable std::atomic<bool> dirty{false};
+    std::atomic<uint64_t> version{0};
+
+    mutable Statistics statistics;
+    mutable std::mutex statsMutex;
+
+    Impl() {
+        statistics.startTime = std::chrono::system_clock::now();
+    }
+
+    ExtensionHandle add(Registration registration) {
+        ExtensionHandle handle = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            handle = nextHandle++;
+            registration.handle = handle;
+            registrations.push_back(std::move(registration));
+            version.fetch_add(1, std::memory_order_relaxed);
+            dirty.store(true, std::memory_order_release);
+        }
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        statistics.registrations++;
+        return handle;
+    }
+
+    size_t removeIf(const std::function<bool(const Registration&)>& predicate) {
+        size_t removed = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto end = std::remove_if(registrations.begin(), registrations.end(), predicate);
+            removed = static_cast<size_t>(registrations.end() - end);
+            registrations.erase(end, registrations.end());
+            for (auto it = keepAlive.begin(); it != keepAlive.end();) {
+                bool referenced = std::any_of(registrations.begin(), registrations.end(),
+                                              [&it](const Registration& registration) {
+                                                  return registration.owner == it->first;
+                                              });
+                it = referenced ? std::next(it) : keepAlive.erase(it);
+            }
+            if (removed > 0) {
+                version.fetch_add(1, std::memory_order_relaxed);
+                dirty.store(true, std::memory_order_release);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        statistics.unregistrations += removed;
+        return removed;
+    }
+
+    // Caller holds mutex
+    std::shared_ptr<ExtensionTables> compile() const {
+        auto compiled = std::make_shared<ExtensionTables>();
+        compiled->version = version.load(std::memory_order_relaxed);
+        for (const auto& entry : keepAlive) {
+            compiled->keepAlive.push_back(entry.second);
+        }
+
+        std::vector<const Registration*> ordered;
+        ordered.reserve(registrations.size());
+        for (const auto& registration : registrations) {
+            ordered.push_back(&registration);
+        }
+        std::sort(ordered.begin(), ordered.end(), compileOrder);
+
+        // Exact frame IDs: group each ID's decoders into one contiguous range
+        std::vector<const Registration*> exact;
+        for (const Registration* registration : ordered) {
+            if (registration->kind != ExtensionKind::FRAME_DECODER) {
+                continue;
+            }
+            if (registration->mask == FRAME_ID_EXACT) {
+                exact.push_back(registration);
+            } else {
+                compiled->maskedFrames.push_back({registration->id & registration->mask, registration->mask,
+                                                  {registration->decode, registration->context}});
+            }
+        }
+        std::stable_sort(exact.begin(), exact.end(),
+                         [](const Registration* a, const Registration* b) { return a->id < b->id; });
+        compiled->frameSlots.reserve(exact.size());
+        compiled->exactFrames.reserve(exact.size());
+        for (size_t i = 0; i < exact.size();) {
+            uint32_t id = exact[i]->id;
+            uint32_t begin = static_cast<uint32_t>(compiled->frameSlots.size());
+            for (; i < exact.size() && exact[i]->id == id; ++i) {
+                compiled->frameSlots.push_back({exact[i]->decode, exact[i]->context});
+            }
+            compiled->exactFrames[id] = {begin, static_cast<uint32_t>(compiled->frameSlots.size())};
+        }
+
+        // Single-slot tables: walk lowest precedence first so the winner is written last
+        for (auto it = ordered.rbegin(); it != ordered.rend(); ++it) {
+            const Registration& registration = **it;
+            switch (registration.kind) {
+                case ExtensionKind::DID_DECODER:
+                    compiled->didSlots[static_cast<uint16_t>(registration.id)] =
+                        {registration.decode, registration.context};
+                    break;
+                case ExtensionKind::PID_DECODER:
+                    compiled->pidSlots[registration.id & 0xFF] = {registration.decode, registration.context};
+                    break;
+                case ExtensionKind::SECURITY_ALGORITHM:
+                    compiled->keySlots[registration.name] = {registration.key, registration.context};
+                    break;
+                case ExtensionKind::TRANSPORT_BACKEND:
+                    compiled->backendSlots[registration.name] = {registration.factory, registration.context};
+                    break;
+                case ExtensionKind::FRAME_DECODER:
+                    break;
+            }
+        }
+
+        return compiled;
+    }
+
+    std::shared_ptr<const ExtensionTables> current() const {
+        if (!dirty.load(std::memory_order_acquire)) {
+            return std::atomic_load(&tables);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (dirty.load(std::memory_order_relaxed)) {
+            auto start = std::chrono::steady_clock::now();
+            std::shared_ptr<const ExtensionTables> compiled = compile();
+            std::atomic_store(&tables, compiled);
+            dirty.store(false, std::memory_order_release);
+
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
+            std::lock_guard<std::mutex> statsLock(statsMutex);
+            statistics.rebuilds++;
+            statistics.lastRebuildDuration = elapsed;
+        }
+        return std::atomic_load(&tables);
+    }
+};
+
+ExtensionRegistry::ExtensionRegistry() : pImpl(std::make_unique<Impl>()) {}
+
+ExtensionRegistry::~ExtensionRegistry() = default;
+
+ExtensionHandle ExtensionRegistry::registerFrameDecoder(const std::string& owner, uint32_t id, uint32_t mask,
+                                                        DecodeFunction function, void* context, int priority) {
+    if (!function) {
+        return 0;
+    }
+    Registration registration;
+    registration.kind = ExtensionKind::FRAME_DECODER;
+    registration.owner = owner;
+    registration.id = id;
+    registration.mask = mask;
+    registration.decode = function;
+    registration.context = context;
+    registration.priority = priority;
+    return pImpl->add(std::move(registration));
+}
+
+ExtensionHandle ExtensionRegistry::registerDataIdentifierDecoder(const std::string& owner, uint16_t did,
+                                                                 DecodeFunction function, void* context,
+                                                                 int priority) {
+    if (!function) {
+        return 0;
+    }
+    Registration registration;
+    registration.kind = ExtensionKind::DID_DECODER;
+    registration.owner = owner;
+    registration.id = did;
+    registration.decode = function;
+    registration.context = context;
+    registration.priority = priority;
+    return pImpl->add(std::move(registration));
+}
+
+ExtensionHandle ExtensionRegistry::registerPIDDecoder(const std::string& owner, uint8_t pid,
+                                                      DecodeFunction function, void* context, int priority) {
+    if (!function) {
+        return 0;
+    }
+    Registration registration;
+    registration.kind = ExtensionKind::PID_DECODER;
+    registration.owner = owner;
+    registration.id = pid;
+    registration.decode = function;
+    registration.context = context;
+    registration.priority = priority;
+    return pImpl->add(std::move(registration));
+}
+
+ExtensionHandle ExtensionRegistry::registerSecurityAlgorithm(const std::string& owner, const std::string& name,
+                                                             SecurityKeyFunction function, void* context,
+                                                             int priority) {
+    if (!function || name.empty()) {
+        return 0;
+    }
+    Registration registration;
+    registration.kind = ExtensionKind::SECURITY_ALGORITHM;
+    registration.owner = owner;
+    registration.name = name;
+    registration.key = function;
+    registration.context = context;
+    registration.priority = priority;
+    return pImpl->add(std::move(registration));
+}
+
+ExtensionHandle ExtensionRegistry::registerTransportBackend(const std::string& owner, const std::string& name,
+                                                            TransportBackendFactory factory, void* context,
+                                                            int priority) {
+    if (!factory || name.empty()) {
+        return 0;
+    }
+    Registration registration;
+    registration.kind = ExtensionKind::TRANSPORT_BACKEND;
+    registration.owner = owner;
+    registration.name = name;
+    registration.factory = factory;
+    registration.context = context;
+    registration.priority = priority;
+    return pImpl->add(std::move(registration));
+}
+
+size_t ExtensionRegistry::registerProvider(IExtensionProvider& provider, const std::string& owner,
+                                           std::shared_ptr<const void> keepAlive) {
+    if (keepAlive) {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+        pImpl->keepAlive[owner] = std::move(keepAlive);
+    }
+
+    try {
+        provider.registerExtensions(*this, owner);
+    } catch (const std::exception& e) {
+        Logger::getInstance()->error("Extension registration by '" + owner + "' threw: " + e.what());
+        unregisterOwner(owner);
+        return 0;
+    }
+
+    size_t added = 0;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+        added = static_cast<size_t>(std::count_if(pImpl->registrations.begin(), pImpl->registrations.end(),
+                                                  [&owner](const Registration& registration) {
+                                                      return registration.owner == owner;
+                                                  }));
+        if (added == 0) {
+            pImpl->keepAlive.erase(owner);
+        }
+    }
+    Logger::getInstance()->debug("'" + owner + "' registered " + std::to_string(added) + " extension(s)");
+    return added;
+}
+
+bool ExtensionRegistry::unregister(ExtensionHandle handle) {
+    return pImpl->removeIf([handle](const Registration& registration) {
+        return registration.handle == handle;
+    }) > 0;
+}
+
+size_t ExtensionRegistry::unregisterOwner(const std::string& owner) {
+    size_t removed = pImpl->removeIf([&owner](const Registration& registration) {
+        return registration.owner == owner;
+    });
+    if (removed > 0) {
+        Logger::getInstance()->debug("Removed " + std::to_string(removed) +
+                                     " extension(s) registered by '" + owner + "'");
+    }
+    return removed;
+}
+
+std::shared_ptr<const ExtensionTables> ExtensionRegistry::getTables() const {
+    return pImpl->current();
+}
+
+uint64_t ExtensionRegistry::getVersion() const {
+    return pImpl->version.load(std::memory_order_relaxed);
+}
+
+std::shared_ptr<ITransportBackend> ExtensionRegistry::createTransportBackend(const std::string& name) const {
+    auto tables = getTables();
+    const ExtensionTables::BackendSlot* slot = tables->findTransportBackend(name);
+    if (!slot) {
+        return nullptr;
+    }
+    ITransportBackend* backend = slot->factory(slot->context);
+    if (!backend) {
+        return nullptr;
+    }
+    // The destructor lives in the plugin's library; delete before the snapshot lets it go
+    return std::shared_ptr<ITransportBackend>(backend, [tables](ITransportBackend* instance) {
+        delete instance;
+    });
+}
+
+std::vector<std::string> ExtensionRegistry::getSecurityAlgorithms() const {
+    auto tables = getTables();
+    std::vector<std::string> names;
+    for (const auto& entry : tables->keySlots) {
+        names.push_back(entry.first);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+std::vector<std::string> ExtensionRegistry::getTransportBackends() const {
+    auto tables = getTables();
+    std::vector<std::string> names;
+    for (const auto& entry : tables->backendSlots) {
+        names.push_back(entry.first);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+ExtensionRegistry::Statistics ExtensionRegistry::getStatistics() const {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    return pImpl->statistics;
+}
+
+void ExtensionRegistry::resetStatistics() {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    pImpl->statistics = Statistics{};
+    pImpl->statistics.startTime = std::chrono::system_clock::now();
+}
+
+std::string ExtensionRegistry::toString() const {
+    size_t count = 0;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+        count = pImpl->registrations.size();
+    }
+
+    std::ostringstream oss;
+    oss << "ExtensionRegistry[Registrations:" << count
+        << ", Version:" << getVersion() << "]";
+    return oss.str();
+}
+
+// Global extension registry
+static std::shared_ptr<ExtensionRegistry> globalExtensionRegistry;
+static std::mutex globalExtensionRegistryMutex;
+
+std::shared_ptr<ExtensionRegistry> getGlobalExtensionRegistry() {
+    std::lock_guard<std::mutex> lock(globalExtensionRegistryMutex);
+    if (!globalExtensionRegistry) {
+        globalExtensionRegistry = std::make_shared<ExtensionRegistry>();
+    }
+    return globalExtensionRegistry;
+}
+
+} // namespace plugins
+} // namespace fmus
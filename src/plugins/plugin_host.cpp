@@ -0,0 +1,1291 @@
+#include <fmus/plugins/plugin_host.h>
+#include <fmus/logger.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <new>
+
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/eventfd.h>
+    #include <sys/prctl.h>
+    #include <sys/stat.h>
+    #include <sys/wait.h>
+    #include <poll.h>
+    #include <signal.h>
+    #include <unistd.h>
+#endif
+
+namespace fmus {
+namespace plugins {
+
+// PluginHostConfig implementation
+std::string PluginHostConfig::toString() const {
+    std::ostringstream ss;
+    ss << "PluginHostConfig[Library:" << libraryPath
+       << ", Executable:" << (hostExecutable.empty() ? "<none>" : hostExecutable)
+       << ", Ring:" << ringBytes << " bytes"
+       << ", Forwarded:" << forwardedEvents.size()
+       << ", Exported:" << exportedEvents.size()
+       << ", MaxRestarts:" << maxRestarts << "]";
+    return ss.str();
+}
+
+#ifdef __linux__
+
+namespace {
+
+constexpr uint32_t SEGMENT_MAGIC = 0x464D5553;  // "FMUS"
+constexpr uint32_t SEGMENT_VERSION = 1;
+
+enum class MessageType : uint16_t {
+    PAD,                ///< Filler up to the end of the ring
+    READY,              ///< Child: plugin loaded and initialized
+    COMMAND,            ///< Parent: execute command
+    RESPONSE,           ///< Child: command result
+    ERROR_RESPONSE,     ///< Child: command failed (id 0: plugin could not be loaded)
+    EVENT_FRAME,
+    EVENT_SAMPLE,
+    EVENT_DTC,
+    EVENT_LEGACY,
+    HEARTBEAT,
+    SHUTDOWN
+};
+
+struct MessageHeader {
+    uint32_t length;    ///< Payload bytes following the header
+    uint16_t type;
+    uint16_t channel;   ///< Event index in the forwarded/exported list
+    uint64_t id;        ///< Command correlation ID
+};
+static_assert(sizeof(MessageHeader) == 16, "MessageHeader must stay 16 bytes");
+
+struct RingControl {
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) std::atomic<uint32_t> consumerWaiting;
+    uint64_t capacity;
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared ring requires lock-free 64-bit atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "Shared ring requires lock-free 32-bit atomics");
+
+struct SegmentHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t ringBytes;
+};
+
+// Frame layout inside the ring; written and read in place
+struct FrameWire {
+    uint32_t id;
+    uint32_t channel;
+    int64_t timestampNs;
+    uint8_t length;
+    uint8_t flags;
+    uint8_t reserved[6];
+    uint8_t data[64];
+};
+
+constexpr uint8_t FRAME_FLAG_EXTENDED = 0x01;
+constexpr uint8_t FRAME_FLAG_TRANSMITTED = 0x02;
+
+constexpr size_t align(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+size_t segmentSize(size_t ringBytes) {
+    return align(sizeof(SegmentHeader), 64) + 2 * (align(sizeof(RingControl), 64) + ringBytes);
+}
+
+/**
+ * Single-producer single-consumer byte ring over shared memory.
+ * Records never straddle the end; a PAD record (or a tail too short for a
+ * header) fills the gap. Head and tail are monotonically increasing offsets.
+ */
+class ShmRing {
+public:
+    ShmRing() = default;
+
+    ShmRing(uint8_t* base, int eventFd) : eventFd(eventFd) {
+        control = reinterpret_cast<RingControl*>(base);
+        data = base + align(sizeof(RingControl), 64);
+    }
+
+    void reset(uint64_t capacity) {
+        new (control) RingControl();
+        control->head.store(0);
+        control->tail.store(0);
+        control->consumerWaiting.store(0);
+        control->capacity = capacity;
+    }
+
+    // Producer side
+
+    uint8_t* reserve(MessageType type, uint16_t channel, uint64_t id, uint32_t length) {
+        uint64_t capacity = control->capacity;
+        uint64_t recordSize = align(sizeof(MessageHeader) + length, 8);
+        if (recordSize > capacity / 2) {
+            return nullptr;
+        }
+
+        uint64_t head = control->head.load(std::memory_order_relaxed);
+        uint64_t tail = control->tail.load(std::memory_order_acquire);
+        uint64_t pos = head % capacity;
+        uint64_t toEnd = capacity - pos;
+        uint64_t needed = (toEnd < recordSize) ? recordSize + toEnd : recordSize;
+
+        if (capacity - (head - tail) < needed) {
+            return nullptr;
+        }
+
+        if (toEnd < recordSize) {
+            if (toEnd >= sizeof(MessageHeader)) {
+                auto pad = reinterpret_cast<MessageHeader*>(data + pos);
+                pad->length = 0;
+                pad->type = static_cast<uint16_t>(MessageType::PAD);
+            }
+            head += toEnd;
+            pos = 0;
+        }
+
+        auto header = reinterpret_cast<MessageHeader*>(data + pos);
+        header->length = length;
+        header->type = static_cast<uint16_t>(type);
+        header->channel = channel;
+        header->id = id;
+        pendingHead = head + recordSize;
+        return reinterpret_cast<uint8_t*>(header + 1);
+    }
+
+    void commit() {
+        control->head.store(pendingHead, std::memory_order_seq_cst);
+        if (control->consumerWaiting.load(std::memory_order_seq_cst)) {
+            uint64_t one = 1;
+            ssize_t written = ::write(eventFd, &one, sizeof(one));
+            (void)written;
+        }
+    }
+
+    bool write(MessageType type, uint16_t channel, uint64_t id, const void* payload, uint32_t length) {
+        uint8_t* slot = reserve(type, channel, id, length);
+        if (!slot) {
+            return false;
+        }
+        if (length > 0) {
+            std::memcpy(slot, payload, length);
+        }
+        commit();
+        return true;
+    }
+
+    // Consumer side
+
+    const MessageHeader* peek() {
+        uint64_t capacity = control->capacity;
+        for (;;) {
+            uint64_t tail = control->tail.load(std::memory_order_relaxed);
+            uint64_t head = control->head.load(std::memory_order_acquire);
+            if (tail == head) {
+                return nullptr;
+            }
+
+            uint64_t pos = tail % capacity;
+            uint64_t toEnd = capacity - pos;
+            if (toEnd < sizeof(MessageHeader)) {
+                control->tail.store(tail + toEnd, std::memory_order_release);
+                continue;
+            }
+
+            auto header = reinterpret_cast<const MessageHeader*>(data + pos);
+            if (header->type == static_cast<uint16_t>(MessageType::PAD)) {
+                control->tail.store(tail + toEnd, std::memory_order_release);
+                continue;
+            }
+            return header;
+        }
+    }
+
+    void release(const MessageHeader* header) {
+        uint64_t tail = control->tail.load(std::memory_order_relaxed);
+        control->tail.store(tail + align(sizeof(MessageHeader) + header->length, 8), std::memory_order_release);
+    }
+
+    void wait(int timeoutMs) {
+        control->consumerWaiting.store(1, std::memory_order_seq_cst);
+        if (control->head.load(std::memory_order_seq_cst) == control->tail.load(std::memory_order_relaxed)) {
+            pollfd pfd{eventFd, POLLIN, 0};
+            if (::poll(&pfd, 1, timeoutMs) > 0) {
+                uint64_t value;
+                ssize_t got = ::read(eventFd, &value, sizeof(value));
+                (void)got;
+            }
+        }
+        control->consumerWaiting.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    RingControl* control = nullptr;
+    uint8_t* data = nullptr;
+    int eventFd = -1;
+    uint64_t pendingHead = 0;
+};
+
+// Length-prefixed field encoding for non-POD payloads
+
+size_t encodedSize(const std::string& str) {
+    return sizeof(uint32_t) + str.size();
+}
+
+size_t encodedSize(const std::map<std::string, std::string>& map) {
+    size_t size = sizeof(uint32_t);
+    for (const auto& entry : map) {
+        size += encodedSize(entry.first) + encodedSize(entry.second);
+    }
+    return size;
+}
+
+class Writer {
+public:
+    explicit Writer(uint8_t* out) : p(out) {}
+
+    template<typename T>
+    void put(const T& value) {
+        std::memcpy(p, &value, sizeof(T));
+        p += sizeof(T);
+    }
+
+    void put(const std::string& str) {
+        put(static_cast<uint32_t>(str.size()));
+        std::memcpy(p, str.data(), str.size());
+        p += str.size();
+    }
+
+    void put(const std::map<std::string, std::string>& map) {
+        put(static_cast<uint32_t>(map.size()));
+        for (const auto& entry : map) {
+            put(entry.first);
+            put(entry.second);
+        }
+    }
+
+private:
+    uint8_t* p;
+};
+
+class Reader {
+public:
+    explicit Reader(const MessageHeader* header)
+        : p(reinterpret_cast<const uint8_t*>(header + 1)), end(p + header->length) {}
+
+    template<typename T>
+    T get() {
+        T value{};
+        if (static_cast<size_t>(end - p) < sizeof(T)) {
+            ok = false;
+            return value;
+        }
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return value;
+    }
+
+    std::string getString() {
+        uint32_t length = get<uint32_t>();
+        if (!ok || static_cast<size_t>(end - p) < length) {
+            ok = false;
+            return "";
+        }
+        std::string str(reinterpret_cast<const char*>(p), length);
+        p += length;
+        return str;
+    }
+
+    std::map<std::string, std::string> getMap() {
+        std::map<std::string, std::string> map;
+        uint32_t count = get<uint32_t>();
+        for (uint32_t i = 0; ok && i < count; ++i) {
+            std::string key = getString();
+            map[key] = getString();
+        }
+        return map;
+    }
+
+    bool ok = true;
+
+private:
+    const uint8_t* p;
+    const uint8_t* end;
+};
+
+int64_t toNanoseconds(std::chrono::steady_clock::time_point timePoint) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(timePoint.time_since_epoch()).count();
+}
+
+std::chrono::steady_clock::time_point fromNanoseconds(int64_t ns) {
+    return std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(ns)));
+}
+
+bool writeEvent(ShmRing& ring, uint16_t channel, const EventPayload& payload) {
+    if (auto frame = std::get_if<FrameEvent>(&payload)) {
+        // Built directly in the ring slot
+        auto slot = ring.reserve(MessageType::EVENT_FRAME, channel, 0, sizeof(FrameWire));
+        if (!slot) return false;
+        auto wire = reinterpret_cast<FrameWire*>(slot);
+        wire->id = frame->id;
+        wire->channel = frame->channel;
+        wire->timestampNs = toNanoseconds(frame->timestamp);
+        wire->length = std::min<uint8_t>(frame->length, 64);
+        wire->flags = (frame->extended ? FRAME_FLAG_EXTENDED : 0) | (frame->transmitted ? FRAME_FLAG_TRANSMITTED : 0);
+        std::memcpy(wire->data, frame->data.data(), wire->length);
+        ring.commit();
+        return true;
+    }
+
+    if (auto sample = std::get_if<ParameterSample>(&payload)) {
+        uint32_t length = static_cast<uint32_t>(sizeof(int64_t) + sizeof(double) +
+                                                encodedSize(sample->name) + encodedSize(sample->unit));
+        auto slot = ring.reserve(MessageType::EVENT_SAMPLE, channel, 0, length);
+        if (!slot) return false;
+        Writer writer(slot);
+        writer.put(toNanoseconds(sample->timestamp));
+        writer.put(sample->value);
+        writer.put(sample->name);
+        writer.put(sample->unit);
+        ring.commit();
+        return true;
+    }
+
+    if (auto dtc = std::get_if<DTCEvent>(&payload)) {
+        uint32_t length = static_cast<uint32_t>(sizeof(int64_t) + 2 * sizeof(uint8_t) + encodedSize(dtc->ecuName) +
+                                                encodedSize(dtc->code) + encodedSize(dtc->description));
+        auto slot = ring.reserve(MessageType::EVENT_DTC, channel, 0, length);
+        if (!slot) return false;
+        Writer writer(slot);
+        writer.put(static_cast<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            dtc->timestamp.time_since_epoch()).count()));
+        writer.put(dtc->status);
+        writer.put(static_cast<uint8_t>(dtc->cleared ? 1 : 0));
+        writer.put(dtc->ecuName);
+        writer.put(dtc->code);
+        writer.put(dtc->description);
+        ring.commit();
+        return true;
+    }
+
+    if (auto legacy = std::get_if<LegacyEvent>(&payload)) {
+        auto slot = ring.reserve(MessageType::EVENT_LEGACY, channel, 0,
+                                 static_cast<uint32_t>(encodedSize(legacy->data)));
+        if (!slot) return false;
+        Writer writer(slot);
+        writer.put(legacy->data);
+        ring.commit();
+        return true;
+    }
+
+    return false;
+}
+
+std::shared_ptr<const EventPayload> readEvent(const MessageHeader* header) {
+    switch (static_cast<MessageType>(header->type)) {
+        case MessageType::EVENT_FRAME: {
+            if (header->length < sizeof(FrameWire)) return nullptr;
+            auto wire = reinterpret_cast<const FrameWire*>(header + 1);
+            FrameEvent frame;
+            frame.id = wire->id;
+            frame.channel = wire->channel;
+            frame.timestamp = fromNanoseconds(wire->timestampNs);
+            frame.length = std::min<uint8_t>(wire->length, 64);
+            frame.extended = (wire->flags & FRAME_FLAG_EXTENDED) != 0;
+            frame.transmitted = (wire->flags & FRAME_FLAG_TRANSMITTED) != 0;
+            std::memcpy(frame.data.data(), wire->data, frame.length);
+            return std::make_shared<const EventPayload>(frame);
+        }
+        case MessageType::EVENT_SAMPLE: {
+            Reader reader(header);
+            ParameterSample sample;
+            sample.timestamp = fromNanoseconds(reader.get<int64_t>());
+            sample.value = reader.get<double>();
+            sample.name = reader.getString();
+            sample.unit = reader.getString();
+            return reader.ok ? std::make_shared<const EventPayload>(std::move(sample)) : nullptr;
+        }
+        case MessageType::EVENT_DTC: {
+            Reader reader(header);
+            DTCEvent dtc;
+            dtc.timestamp = std::chrono::system_clock::time_point(std::chrono::milliseconds(reader.get<int64_t>()));
+            dtc.status = reader.get<uint8_t>();
+            dtc.cleared = reader.get<uint8_t>() != 0;
+            dtc.ecuName = reader.getString();
+            dtc.code = reader.getString();
+            dtc.description = reader.getString();
+            return reader.ok ? std::make_shared<const EventPayload>(std::move(dtc)) : nullptr;
+        }
+        case MessageType::EVENT_LEGACY: {
+            Reader reader(header);
+            LegacyEvent legacy{reader.getMap()};
+            return reader.ok ? std::make_shared<const EventPayload>(std::move(legacy)) : nullptr;
+        }
+        default:
+            return nullptr;
+    }
+}
+
+std::string joinList(const std::vector<std::string>& items) {
+    std::string joined;
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (i > 0) joined += ",";
+        joined += items[i];
+    }
+    return joined;
+}
+
+std::vector<std::string> splitList(const std::string& value) {
+    std::vector<std::string> items;
+    std::istringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+struct ChildArguments {
+    int shmFd = -1;
+    int toChildFd = -1;
+    int toParentFd = -1;
+    std::string library;
+    std::vector<std::string> forwarded;
+    std::vector<std::string> exported;
+    int heartbeatMs = 200;
+};
+
+} // anonymous namespace
+
+class PluginHost::Impl {
+public:
+    PluginHostConfig config;
+    std::shared_ptr<EventBus> eventBus;
+
+    int memFd = -1;
+    int toChildFd = -1;
+    int toParentFd = -1;
+    uint8_t* segment = nullptr;
+    size_t segmentBytes = 0;
+    ShmRing toChild;
+    ShmRing fromChild;
+    std::mutex writeMutex;  // Commands and forwarded events share the producer side
+
+    std::atomic<pid_t> childPid{-1};    // Read by the reader thread, replaced on restart
+    std::chrono::steady_clock::time_point childStarted;
+    std::atomic<int64_t> lastHeartbeatNs{0};
+    uint32_t consecutiveRestarts = 0;
+    bool fatal = false;
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> stopping{false};
+    std::thread reader;
+
+    std::mutex stateMutex;
+    std::condition_variable stateCondition;
+    bool ready = false;
+    PluginInfo info;
+    std::vector<std::string> capabilities;
+    std::string lastError;
+
+    std::mutex pendingMutex;
+    std::map<uint64_t, std::promise<std::pair<bool, std::string>>> pending;
+    std::atomic<uint64_t> nextCommandId{1};
+
+    std::vector<SubscriptionId> forwardSubscriptions;
+    std::vector<EventId> exportedIds;
+
+    std::atomic<uint64_t> commandsSent{0};
+    std::atomic<uint64_t> commandsFailed{0};
+    std::atomic<uint64_t> eventsForwarded{0};
+    std::atomic<uint64_t> eventsDropped{0};
+    std::atomic<uint64_t> eventsReceived{0};
+    std::atomic<uint32_t> restarts{0};
+    std::atomic<uint32_t> crashes{0};
+    std::chrono::system_clock::time_point startTime = std::chrono::system_clock::now();
+    mutable std::mutex statsMutex;
+
+    void setError(const std::string& message) {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        lastError = message;
+    }
+
+    bool createSegment() {
+        size_t ringBytes = std::max<size_t>(align(config.ringBytes, 64), 4096);
+        segmentBytes = segmentSize(ringBytes);
+
+        memFd = ::memfd_create("fmus_plugin_host", MFD_CLOEXEC);
+        if (memFd < 0 || ::ftruncate(memFd, static_cast<off_t>(segmentBytes)) != 0) {
+            setError("Failed to create shared memory: " + std::string(std::strerror(errno)));
+            return false;
+        }
+
+        void* mapping = ::mmap(nullptr, segmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+        if (mapping == MAP_FAILED) {
+            setError("Failed to map shared memory: " + std::string(std::strerror(errno)));
+            return false;
+        }
+        segment = static_cast<uint8_t*>(mapping);
+
+        // Close-on-exec keeps other spawned processes from inheriting the
+        // channel; only our own child clears it before exec
+        toChildFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        toParentFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (toChildFd < 0 || toParentFd < 0) {
+            setError("Failed to create eventfd: " + std::string(std::strerror(errno)));
+            return false;
+        }
+
+        auto header = reinterpret_cast<SegmentHeader*>(segment);
+        header->magic = SEGMENT_MAGIC;
+        header->version = SEGMENT_VERSION;
+        header->ringBytes = ringBytes;
+
+        uint8_t* rings = segment + align(sizeof(SegmentHeader), 64);
+        toChild = ShmRing(rings, toChildFd);
+        fromChild = ShmRing(rings + align(sizeof(RingControl), 64) + ringBytes, toParentFd);
+        return true;
+    }
+
+    void destroySegment() {
+        if (segment) {
+            ::munmap(segment, segmentBytes);
+            segment = nullptr;
+        }
+        for (int* fd : {&memFd, &toChildFd, &toParentFd}) {
+            if (*fd >= 0) {
+                ::close(*fd);
+                *fd = -1;
+            }
+        }
+    }
+
+    bool spawnChild() {
+        auto header = reinterpret_cast<SegmentHeader*>(segment);
+        toChild.reset(header->ringBytes);
+        fromChild.reset(header->ringBytes);
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            ready = false;
+        }
+
+        // Build argv before forking; the child of a threaded parent only execs
+        std::vector<std::string> argStrings = {
+            config.hostExecutable,
+            "--shm", std::to_string(memFd),
+            "--to-child", std::to_string(toChildFd),
+            "--to-parent", std::to_string(toParentFd),
+            "--library", config.libraryPath,
+            "--forward", joinList(config.forwardedEvents),
+            "--export", joinList(config.exportedEvents),
+            "--heartbeat", std::to_string(config.heartbeatInterval.count())
+        };
+        std::vector<char*> argv;
+        for (auto& arg : argStrings) {
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+
+        pid_t parent = ::getpid();
+        pid_t pid = ::fork();
+        if (pid < 0) {
+            setError("fork failed: " + std::string(std::strerror(errno)));
+            return false;
+        }
+
+        if (pid == 0) {
+            ::prctl(PR_SET_PDEATHSIG, SIGKILL);
+            if (::getppid() != parent) {
+                ::_exit(1);
+            }
+            for (int fd : {memFd, toChildFd, toParentFd}) {
+                int flags = ::fcntl(fd, F_GETFD);
+                if (flags < 0 || ::fcntl(fd, F_SETFD, flags & ~FD_CLOEXEC) < 0) {
+                    ::_exit(127);
+                }
+            }
+            ::execvp(argv[0], argv.data());
+            ::_exit(127);
+        }
+
+        childPid = pid;
+        childStarted = std::chrono::steady_clock::now();
+        lastHeartbeatNs = toNanoseconds(childStarted);
+        return true;
+    }
+
+    bool waitReady(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        return stateCondition.wait_for(lock, timeout, [this] { return ready || fatal || !running; }) && ready;
+    }
+
+    void failPending(const std::string& message) {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        for (auto& entry : pending) {
+            entry.second.set_value({false, message});
+        }
+        pending.clear();
+    }
+
+    void handleMessage(const MessageHeader* header) {
+        auto type = static_cast<MessageType>(header->type);
+        switch (type) {
+            case MessageType::READY: {
+                Reader reader(header);
+                PluginInfo reported;
+                reported.name = reader.getString();
+                reported.version = reader.getString();
+                reported.description = reader.getString();
+                uint32_t count = reader.get<uint32_t>();
+                std::vector<std::string> reportedCapabilities;
+                for (uint32_t i = 0; reader.ok && i < count; ++i) {
+                    reportedCapabilities.push_back(reader.getString());
+                }
+                std::lock_guard<std::mutex> lock(stateMutex);
+                info = reported;
+                capabilities = reportedCapabilities;
+                ready = true;
+                stateCondition.notify_all();
+                break;
+            }
+
+            case MessageType::RESPONSE:
+            case MessageType::ERROR_RESPONSE: {
+                Reader reader(header);
+                std::string result = reader.getString();
+                if (header->id == 0) {
+                    // Child could not load or initialize the plugin; restarting will not help
+                    std::lock_guard<std::mutex> lock(stateMutex);
+                    lastError = result;
+                    fatal = true;
+                    stateCondition.notify_all();
+                    break;
+                }
+                std::lock_guard<std::mutex> lock(pendingMutex);
+                auto it = pending.find(header->id);
+                if (it != pending.end()) {
+                    it->second.set_value({type == MessageType::RESPONSE, result});
+                    pending.erase(it);
+                }
+                break;
+            }
+
+            case MessageType::HEARTBEAT:
+                lastHeartbeatNs = toNanoseconds(std::chrono::steady_clock::now());
+                break;
+
+            case MessageType::EVENT_FRAME:
+            case MessageType::EVENT_SAMPLE:
+            case MessageType::EVENT_DTC:
+            case MessageType::EVENT_LEGACY: {
+                if (header->channel < exportedIds.size()) {
+                    auto payload = readEvent(header);
+                    if (payload) {
+                        eventsReceived.fetch_add(1, std::memory_order_relaxed);
+                        eventBus->publish(exportedIds[header->channel], std::move(payload));
+                    }
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    bool childAlive() {
+        pid_t pid = childPid.load();
+        if (pid <= 0) {
+            return false;
+        }
+        int status = 0;
+        if (::waitpid(pid, &status, WNOHANG) == pid) {
+            childPid.compare_exchange_strong(pid, -1);
+            return false;
+        }
+        return true;
+    }
+
+    void killChild() {
+        pid_t pid = childPid.exchange(-1);
+        if (pid > 0) {
+            ::kill(pid, SIGKILL);
+            ::waitpid(pid, nullptr, 0);
+        }
+    }
+
+    void readerLoop() {
+        auto logger = Logger::getInstance();
+        int pollMs = static_cast<int>(std::max<int64_t>(1, config.heartbeatInterval.count()));
+
+        while (running) {
+            fromChild.wait(pollMs);
+            while (const MessageHeader* header = fromChild.peek()) {
+                handleMessage(header);
+                fromChild.release(header);
+            }
+
+            if (stopping) {
+                continue;
+            }
+
+            // Supervise: exited child, or a child that stopped heartbeating
+            bool alive = childAlive();
+            auto now = std::chrono::steady_clock::now();
+            if (alive && now - fromNanoseconds(lastHeartbeatNs) > config.heartbeatTimeout) {
+                logger->warning("Plugin host '" + config.libraryPath + "' missed heartbeats, killing");
+                killChild();
+                alive = false;
+            }
+            if (alive) {
+                continue;
+            }
+
+            crashes++;
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                ready = false;
+            }
+            failPending("Plugin host process exited");
+
+            bool giveUp;
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                giveUp = fatal;
+            }
+
+            // A child that ran for a while counts as healthy; reset the backoff
+            if (now - childStarted > config.heartbeatTimeout * 5) {
+                consecutiveRestarts = 0;
+            }
+            if (giveUp || consecutiveRestarts >= config.maxRestarts) {
+                logger->error("Plugin host '" + config.libraryPath + "' is down, not restarting");
+                setError("Plugin host process exited");
+                running = false;
+                std::lock_guard<std::mutex> lock(stateMutex);
+                stateCondition.notify_all();
+                break;
+            }
+
+            auto backoff = config.restartBackoff * (1 << std::min<uint32_t>(consecutiveRestarts, 10));
+            consecutiveRestarts++;
+            logger->warning("Plugin host '" + config.libraryPath + "' exited, restarting in " +
+                            std::to_string(backoff.count()) + "ms");
+            {
+                std::unique_lock<std::mutex> lock(stateMutex);
+                stateCondition.wait_for(lock, backoff, [this] { return stopping.load(); });
+            }
+            if (stopping) {
+                continue;
+            }
+
+            std::lock_guard<std::mutex> writeLock(writeMutex);
+            if (spawnChild()) {
+                restarts++;
+            }
+        }
+    }
+
+    void forward(uint16_t channel, const Event& event) {
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (!ready) {
+                eventsDropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        std::lock_guard<std::mutex> lock(writeMutex);
+        if (event.payload && writeEvent(toChild, channel, *event.payload)) {
+            eventsForwarded.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            eventsDropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+#else // !__linux__
+
+class PluginHost::Impl {
+public:
+    PluginHostConfig config;
+    std::shared_ptr<EventBus> eventBus;
+    std::string lastError = "Out-of-process plugin hosting is only supported on Linux";
+    std::chrono::system_clock::time_point startTime = std::chrono::system_clock::now();
+};
+
+#endif // __linux__
+
+// PluginHost implementation
+PluginHost::PluginHost(const PluginHostConfig& config, std::shared_ptr<EventBus> eventBus)
+    : pImpl(std::make_unique<Impl>()) {
+    pImpl->config = config;
+    pImpl->eventBus = eventBus ? eventBus : getGlobalEventBus();
+}
+
+PluginHost::~PluginHost() {
+    stop();
+}
+
+#ifdef __linux__
+
+bool PluginHost::start() {
+    auto logger = Logger::getInstance();
+    if (pImpl->running) {
+        return true;
+    }
+
+    logger->info("Starting plugin host: " + pImpl->config.toString());
+
+    // Anything but exec is unsafe in the child of a multithreaded process
+    if (pImpl->config.hostExecutable.empty()) {
+        pImpl->setError("Plugin isolation requires a host executable");
+        logger->error("Failed to start plugin host: " + getLastError());
+        return false;
+    }
+
+    pImpl->stopping = false;
+    pImpl->fatal = false;
+    pImpl->consecutiveRestarts = 0;
+    if (!pImpl->createSegment() || !pImpl->spawnChild()) {
+        logger->error("Failed to start plugin host: " + getLastError());
+        pImpl->destroySegment();
+        return false;
+    }
+
+    pImpl->exportedIds.clear();
+    for (const auto& name : pImpl->config.exportedEvents) {
+        pImpl->exportedIds.push_back(pImpl->eventBus->registerEvent(name));
+    }
+
+    pImpl->running = true;
+    pImpl->reader = std::thread([this]() { pImpl->readerLoop(); });
+
+    if (!pImpl->waitReady(pImpl->config.commandTimeout)) {
+        if (getLastError().empty()) {
+            pImpl->setError("Plugin host did not become ready");
+        }
+        logger->error("Plugin host failed to start: " + getLastError());
+        stop();
+        return false;
+    }
+
+    Impl* impl = pImpl.get();
+    for (size_t i = 0; i < pImpl->config.forwardedEvents.size(); ++i) {
+        EventId id = pImpl->eventBus->registerEvent(pImpl->config.forwardedEvents[i]);
+        uint16_t channel = static_cast<uint16_t>(i);
+        pImpl->forwardSubscriptions.push_back(pImpl->eventBus->subscribe(
+            id, "host:" + getInfo().name, [impl, channel](const Event& event) { impl->forward(channel, event); }));
+    }
+
+    logger->info("Plugin host ready: " + getInfo().toString());
+    return true;
+}
+
+void PluginHost::stop() {
+    if (!pImpl->segment) {
+        return;
+    }
+
+    pImpl->stopping = true;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->stateMutex);
+        pImpl->stateCondition.notify_all();
+    }
+
+    for (auto subscription : pImpl->forwardSubscriptions) {
+        pImpl->eventBus->unsubscribe(subscription);
+    }
+    pImpl->forwardSubscriptions.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(pImpl->writeMutex);
+        pImpl->toChild.write(MessageType::SHUTDOWN, 0, 0, nullptr, 0);
+    }
+
+    // Give the plugin a chance to shut down cleanly
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (pImpl->childAlive() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    pImpl->killChild();
+
+    pImpl->running = false;
+    if (pImpl->reader.joinable()) {
+        pImpl->reader.join();
+    }
+
+    pImpl->failPending("Plugin host stopped");
+    pImpl->destroySegment();
+    {
+        std::lock_guard<std::mutex> lock(pImpl->stateMutex);
+        pImpl->ready = false;
+    }
+}
+
+bool PluginHost::isRunning() const {
+    std::lock_guard<std::mutex> lock(pImpl->stateMutex);
+    return pImpl->running && pImpl->ready;
+}
+
+PluginInfo PluginHost::getInfo() const {
+    std::lock_guard<std::mutex> lock(pImpl->stateMutex);
+    return pImpl->info;
+}
+
+std::vector<std::string> PluginHost::getCapabilities() const {
+    std::lock_guard<std::mutex> lock(pImpl->stateMutex);
+    return pImpl->capabilities;
+}
+
+std::string PluginHost::executeCommand(const std::string& command,
+                                       const std::map<std::string, std::string>& parameters) {
+    auto deadline = std::chrono::steady_clock::now() + pImpl->config.commandTimeout;
+
+    // The child may be restarting; wait for it within the command timeout
+    if (!pImpl->waitReady(pImpl->config.commandTimeout)) {
+        pImpl->commandsFailed++;
+        throw PluginError(PluginError::ErrorCode::EXECUTION_FAILED,
+                          "Plugin host unavailable: " + getLastError());
+    }
+
+    uint64_t id = pImpl->nextCommandId++;
+    std::future<std::pair<bool, std::string>> result;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->pendingMutex);
+        result = pImpl->pending[id].get_future();
+    }
+
+    uint32_t length = static_cast<uint32_t>(encodedSize(command) + encodedSize(parameters));
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(pImpl->writeMutex);
+            uint8_t* slot = pImpl->toChild.reserve(MessageType::COMMAND, 0, id, length);
+            if (slot) {
+                Writer writer(slot);
+                writer.put(command);
+                writer.put(parameters);
+                pImpl->toChild.commit();
+                break;
+            }
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            std::lock_guard<std::mutex> lock(pImpl->pendingMutex);
+            pImpl->pending.erase(id);
+            pImpl->commandsFailed++;
+            throw PluginError(PluginError::ErrorCode::EXECUTION_FAILED, "Plugin host command ring full");
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    pImpl->commandsSent++;
+
+    if (result.wait_until(deadline) != std::future_status::ready) {
+        std::lock_guard<std::mutex> lock(pImpl->pendingMutex);
+        pImpl->pending.erase(id);
+        pImpl->commandsFailed++;
+        throw PluginError(PluginError::ErrorCode::EXECUTION_FAILED, "Plugin command timed out: " + command);
+    }
+
+    auto response = result.get();
+    if (!response.first) {
+        pImpl->commandsFailed++;
+        throw PluginError(PluginError::ErrorCode::EXECUTION_FAILED, response.second);
+    }
+    return response.second;
+}
+
+#else // !__linux__
+
+bool PluginHost::start() {
+    Logger::getInstance()->error(pImpl->lastError);
+    return false;
+}
+
+void PluginHost::stop() {}
+
+bool PluginHost::isRunning() const {
+    return false;
+}
+
+PluginInfo PluginHost::getInfo() const {
+    return PluginInfo();
+}
+
+std::vector<std::string> PluginHost::getCapabilities() const {
+    return {};
+}
+
+std::string PluginHost::executeCommand(const std::string&, const std::map<std::string, std::string>&) {
+    throw PluginError(PluginError::ErrorCode::EXECUTION_FAILED, pImpl->lastError);
+}
+
+#endif // __linux__
+
+std::string PluginHost::getLastError() const {
+#ifdef __linux__
+    std::lock_guard<std::mutex> lock(pImpl->stateMutex);
+#endif
+    return pImpl->lastError;
+}
+
+PluginHost::Statistics PluginHost::getStatistics() const {
+    Statistics stats;
+#ifdef __linux__
+    stats.commandsSent = pImpl->commandsSent;
+    stats.commandsFailed = pImpl->commandsFailed;
+    stats.eventsForwarded = pImpl->eventsForwarded;
+    stats.eventsDropped = pImpl->eventsDropped;
+    stats.eventsReceived = pImpl->eventsReceived;
+    stats.restarts = pImpl->restarts;
+    stats.crashes = pImpl->crashes;
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+#endif
+    stats.startTime = pImpl->startTime;
+    return stats;
+}
+
+void PluginHost::resetStatistics() {
+#ifdef __linux__
+    pImpl->commandsSent = 0;
+    pImpl->commandsFailed = 0;
+    pImpl->eventsForwarded = 0;
+    pImpl->eventsDropped = 0;
+    pImpl->eventsReceived = 0;
+    pImpl->restarts = 0;
+    pImpl->crashes = 0;
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+#endif
+    pImpl->startTime = std::chrono::system_clock::now();
+}
+
+// RemotePlugin implementation
+RemotePlugin::RemotePlugin(const PluginInfo& info, const PluginHostConfig& config)
+    : info(info), host(std::make_unique<PluginHost>(config)) {}
+
+RemotePlugin::~RemotePlugin() = default;
+
+PluginInfo RemotePlugin::getInfo() const {
+    return info;
+}
+
+bool RemotePlugin::initialize(std::shared_ptr<Auto> /*autoInstance*/) {
+    return host->start();
+}
+
+void RemotePlugin::shutdown() {
+    host->stop();
+}
+
+bool RemotePlugin::isInitialized() const {
+    return host->isRunning();
+}
+
+std::string RemotePlugin::executeCommand(const std::string& command,
+                                         const std::map<std::string, std::string>& parameters) {
+    return host->executeCommand(command, parameters);
+}
+
+std::vector<std::string> RemotePlugin::getCapabilities() const {
+    return host->getCapabilities();
+}
+
+PluginHost& RemotePlugin::getHost() {
+    return *host;
+}
+
+#ifdef __linux__
+
+namespace {
+
+int runChild(const ChildArguments& args) {
+    struct stat st{};
+    if (::fstat(args.shmFd, &st) != 0) {
+        return 2;
+    }
+
+    void* mapping = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, args.shmFd, 0);
+    if (mapping == MAP_FAILED) {
+        return 2;
+    }
+
+    auto segment = static_cast<uint8_t*>(mapping);
+    auto header = reinterpret_cast<SegmentHeader*>(segment);
+    if (header->magic != SEGMENT_MAGIC || header->version != SEGMENT_VERSION) {
+        return 2;
+    }
+
+    uint8_t* rings = segment + align(sizeof(SegmentHeader), 64);
+    ShmRing fromParent(rings, args.toChildFd);
+    ShmRing toParent(rings + align(sizeof(RingControl), 64) + header->ringBytes, args.toParentFd);
+    std::mutex writeMutex;  // Main loop, heartbeat thread and exported event handlers all produce
+
+    auto sendString = [&](MessageType type, uint64_t id, const std::string& text) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        uint8_t* slot = nullptr;
+        while (!(slot = toParent.reserve(type, 0, id, static_cast<uint32_t>(encodedSize(text))))) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        Writer writer(slot);
+        writer.put(text);
+        toParent.commit();
+    };
+
+    std::string error;
+    auto plugin = createPluginFromLibrary(args.library, error);
+    if (!plugin) {
+        sendString(MessageType::ERROR_RESPONSE, 0, error);
+        return 3;
+    }
+    if (!plugin->initialize(nullptr)) {
+        sendString(MessageType::ERROR_RESPONSE, 0, "Plugin initialization failed");
+        return 3;
+    }
+
+    // Announce
+    {
+        PluginInfo info = plugin->getInfo();
+        auto capabilities = plugin->getCapabilities();
+        size_t length = encodedSize(info.name) + encodedSize(info.version) + encodedSize(info.description) +
+                        sizeof(uint32_t);
+        for (const auto& capability : capabilities) {
+            length += encodedSize(capability);
+        }
+        std::lock_guard<std::mutex> lock(writeMutex);
+        uint8_t* slot = toParent.reserve(MessageType::READY, 0, 0, static_cast<uint32_t>(length));
+        if (!slot) {
+            return 4;
+        }
+        Writer writer(slot);
+        writer.put(info.name);
+        writer.put(info.version);
+        writer.put(info.description);
+        writer.put(static_cast<uint32_t>(capabilities.size()));
+        for (const auto& capability : capabilities) {
+            writer.put(capability);
+        }
+        toParent.commit();
+    }
+
+    // Forwarded events are replayed on the child's own bus, where the plugin subscribes
+    auto bus = getGlobalEventBus();
+    std::vector<EventId> forwardedIds;
+    for (const auto& name : args.forwarded) {
+        forwardedIds.push_back(bus->registerEvent(name));
+    }
+    for (size_t i = 0; i < args.exported.size(); ++i) {
+        uint16_t channel = static_cast<uint16_t>(i);
+        bus->subscribe(bus->registerEvent(args.exported[i]), "host", [&toParent, &writeMutex, channel](const Event& event) {
+            if (event.payload) {
+                std::lock_guard<std::mutex> lock(writeMutex);
+                writeEvent(toParent, channel, *event.payload);
+            }
+        });
+    }
+
+    std::atomic<bool> running{true};
+    pid_t parent = ::getppid();
+    std::thread heartbeat([&]() {
+        while (running) {
+            {
+                std::lock_guard<std::mutex> lock(writeMutex);
+                toParent.write(MessageType::HEARTBEAT, 0, 0, nullptr, 0);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(std::max(1, args.heartbeatMs)));
+            if (::getppid() != parent) {
+                running = false;
+            }
+        }
+    });
+
+    while (running) {
+        fromParent.wait(std::max(1, args.heartbeatMs));
+
+        while (const MessageHeader* message = fromParent.peek()) {
+            auto type = static_cast<MessageType>(message->type);
+
+            if (type == MessageType::COMMAND) {
+                Reader reader(message);
+                std::string command = reader.getString();
+                auto parameters = reader.getMap();
+                uint64_t id = message->id;
+                fromParent.release(message);
+
+                try {
+                    sendString(MessageType::RESPONSE, id, plugin->executeCommand(command, parameters));
+                } catch (const std::exception& e) {
+                    sendString(MessageType::ERROR_RESPONSE, id, e.what());
+                }
+                continue;
+            }
+
+            if (type == MessageType::SHUTDOWN) {
+                running = false;
+            } else if (message->channel < forwardedIds.size()) {
+                auto payload = readEvent(message);
+                if (payload) {
+                    bus->publish(forwardedIds[message->channel], std::move(payload));
+                }
+            }
+            fromParent.release(message);
+        }
+    }
+
+    heartbeat.join();
+    plugin->shutdown();
+    bus->shutdown();
+    plugin.reset();
+    return 0;
+}
+
+} // anonymous namespace
+
+int runPluginHost(int argc, char* argv[]) {
+    ChildArguments args;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string key = argv[i];
+        std::string value = argv[i + 1];
+        if (key == "--shm") {
+            args.shmFd = std::atoi(value.c_str());
+        } else if (key == "--to-child") {
+            args.toChildFd = std::atoi(value.c_str());
+        } else if (key == "--to-parent") {
+            args.toParentFd = std::atoi(value.c_str());
+        } else if (key == "--library") {
+            args.library = value;
+        } else if (key == "--forward") {
+            args.forwarded = splitList(value);
+        } else if (key == "--export") {
+            args.exported = splitList(value);
+        } else if (key == "--heartbeat") {
+            args.heartbeatMs = std::atoi(value.c_str());
+        }
+    }
+
+    if (args.shmFd < 0 || args.toChildFd < 0 || args.toParentFd < 0 || args.library.empty()) {
+        return 1;
+    }
+    return runChild(args);
+}
+
+#else // !__linux__
+
+int runPluginHost(int, char*[]) {
+    return 1;
+}
+
+#endif // __linux__
+
+} // namespace plugins
+} // namespace fmus
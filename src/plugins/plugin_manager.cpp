@@ -0,0 +1,1224 @@
+#include <fmus/plugins/plugin_manager.h>
+#include <fmus/plugins/plugin_host.h>
+#include <fmus/plugins/extension_points.h>
+#include <fmus/logger.h>
+#include <fmus/thread_pool.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <shared_mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <dlfcn.h>
+#endif
+
+namespace fmus {
+namespace plugins {
+
+namespace fs = std::filesystem;
+
+PluginManager* PluginManager::instance = nullptr;
+std::map<std::string, PluginFactoryFunction> PluginRegistry::factories;
+
+static std::mutex instanceMutex;
+
+namespace {
+
+using CreatePluginFunction = IPlugin* (*)();
+using DestroyPluginFunction = void (*)(IPlugin*);
+using InterfaceVersionFunction = int (*)();
+
+std::string trim(const std::string& str) {
+    size_t begin = str.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    size_t end = str.find_last_not_of(" \t\r\n");
+    return str.substr(begin, end - begin + 1);
+}
+
+std::vector<std::string> splitList(const std::string& value) {
+    std::vector<std::string> items;
+    std::istringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        item = trim(item);
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+std::shared_ptr<void> openLibrary(const std::string& path, std::string& error) {
+#ifdef _WIN32
+    HMODULE handle = LoadLibraryA(path.c_str());
+    if (!handle) {
+        error = "Failed to load library: " + std::to_string(GetLastError());
+        return nullptr;
+    }
+    return std::shared_ptr<void>(handle, [](void* h) { FreeLibrary(static_cast<HMODULE>(h)); });
+#else
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        error = "Failed to load library: " + std::string(dlerror());
+        return nullptr;
+    }
+    return std::shared_ptr<void>(handle, [](void* h) { dlclose(h); });
+#endif
+}
+
+void* findSymbol(const std::shared_ptr<void>& library, const char* name) {
+#ifdef _WIN32
+    return reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(library.get()), name));
+#else
+    return dlsym(library.get(), name);
+#endif
+}
+
+} // anonymous namespace
+
+std::shared_ptr<IPlugin> createPluginFromLibrary(const std::string& path, std::string& error) {
+    auto library = openLibrary(path, error);
+    if (!library) {
+        return nullptr;
+    }
+
+    auto versionFunction = reinterpret_cast<InterfaceVersionFunction>(
+        findSymbol(library, "getPluginInterfaceVersion"));
+    if (versionFunction && versionFunction() != PLUGIN_INTERFACE_VERSION) {
+        error = "Plugin interface version mismatch: " + std::to_string(versionFunction()) +
+                " (expected " + std::to_string(PLUGIN_INTERFACE_VERSION) + ")";
+        return nullptr;
+    }
+
+    auto createFunction = reinterpret_cast<CreatePluginFunction>(findSymbol(library, "createPlugin"));
+    auto destroyFunction = reinterpret_cast<DestroyPluginFunction>(findSymbol(library, "destroyPlugin"));
+    if (!createFunction) {
+        error = "Library does not export createPlugin: " + path;
+        return nullptr;
+    }
+
+    IPlugin* raw = createFunction();
+    if (!raw) {
+        error = "createPlugin returned null: " + path;
+        return nullptr;
+    }
+
+    return std::shared_ptr<IPlugin>(raw, [library, destroyFunction](IPlugin* plugin) {
+        if (destroyFunction) {
+            destroyFunction(plugin);
+        } else {
+            delete plugin;
+        }
+    });
+}
+
+namespace {
+
+/**
+ * Copy a library to a unique temporary path. Loading the copy lets the
+ * original file be replaced and reloaded while the old code is still mapped.
+ */
+std::string shadowCopy(const std::string& path, uint32_t generation, std::string& error) {
+    std::error_code ec;
+    fs::path directory = fs::temp_directory_path(ec) / "fmus_plugins";
+    fs::create_directories(directory, ec);
+
+    fs::path source(path);
+    fs::path target = directory / (source.stem().string() + "." + std::to_string(generation) + "." +
+                                   std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) +
+                                   source.extension().string());
+
+    fs::copy_file(source, target, fs::copy_options::overwrite_existing, ec);
+    if (ec) {
+        error = "Failed to copy plugin library: " + ec.message();
+        return "";
+    }
+    return target.string();
+}
+
+fs::file_time_type libraryWriteTime(const std::string& path) {
+    std::error_code ec;
+    auto time = fs::last_write_time(path, ec);
+    return ec ? fs::file_time_type::min() : time;
+}
+
+template<typename Task>
+void runParallel(size_t count, Task task) {
+    if (count == 0) {
+        return;
+    }
+    auto threadPool = getGlobalThreadPool();
+    // Waiting on the pool from one of its own workers can deadlock it
+    if (count == 1 || threadPool->isWorkerThread()) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        futures.push_back(threadPool->enqueue(task, i));
+    }
+
+    // Tasks refer to the caller's state, so wait for all before rethrowing
+    std::exception_ptr failure;
+    for (auto& future : futures) {
+        try {
+            future.get();
+        } catch (...) {
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+} // anonymous namespace
+
+/**
+ * Known plugin, loaded or deferred. The gate is held shared by running
+ * commands and exclusively by load, reload and unload.
+ */
+struct PluginRecord {
+    PluginManifest manifest;
+    std::shared_ptr<IPlugin> plugin;
+    std::shared_mutex gate;
+    bool initialized = false;
+    std::string lastError;
+    uint32_t generation = 0;
+    fs::file_time_type libraryTime = fs::file_time_type::min();
+    fs::file_time_type pendingTime = fs::file_time_type::min();   ///< Hot reload debounce
+};
+
+class PluginManager::Impl {
+public:
+    std::shared_ptr<Auto> autoInstance;
+    std::shared_ptr<EventBus> eventBus = getGlobalEventBus();
+    bool initialized = false;
+
+    mutable std::mutex recordsMutex;
+    std::map<std::string, std::shared_ptr<PluginRecord>> records;
+    std::map<std::string, std::string> capabilityIndex;   ///< Capability -> plugin name
+    std::vector<std::string> initOrder;
+
+    std::vector<SubscriptionId> legacySubscriptions;
+    std::mutex legacyMutex;
+
+    std::atomic<bool> hotReload{false};
+    std::thread watcher;
+    std::mutex watchMutex;
+    std::condition_variable watchCondition;
+    std::chrono::milliseconds pollInterval{500};
+
+    Statistics statistics;
+    mutable std::mutex statsMutex;
+
+    Impl() {
+        statistics.startTime = std::chrono::system_clock::now();
+    }
+
+    std::shared_ptr<PluginRecord> findRecord(const std::string& name) const {
+        std::lock_guard<std::mutex> lock(recordsMutex);
+        auto it = records.find(name);
+        return it != records.end() ? it->second : nullptr;
+    }
+
+    bool addRecord(const std::shared_ptr<PluginRecord>& record) {
+        std::lock_guard<std::mutex> lock(recordsMutex);
+        if (records.count(record->manifest.info.name)) {
+            return false;
+        }
+        records[record->manifest.info.name] = record;
+        for (const auto& capability : record->manifest.capabilities) {
+            capabilityIndex.emplace(capability, record->manifest.info.name);
+        }
+        return true;
+    }
+
+    void eraseRecord(const std::string& name) {
+        std::lock_guard<std::mutex> lock(recordsMutex);
+        records.erase(name);
+        for (auto it = capabilityIndex.begin(); it != capabilityIndex.end();) {
+            it = (it->second == name) ? capabilityIndex.erase(it) : std::next(it);
+        }
+    }
+
+    void indexCapabilities(const PluginRecord& record, const std::vector<std::string>& capabilities) {
+        std::lock_guard<std::mutex> lock(recordsMutex);
+        for (const auto& capability : capabilities) {
+            capabilityIndex.emplace(capability, record.manifest.info.name);
+        }
+    }
+
+    // Caller holds record.gate exclusively
+    bool loadRecord(PluginRecord& record, bool forceShadow) {
+        if (record.manifest.isolated) {
+            PluginHostConfig hostConfig;
+            hostConfig.libraryPath = record.manifest.libraryPath;
+            hostConfig.forwardedEvents = record.manifest.forwardedEvents;
+            hostConfig.exportedEvents = record.manifest.exportedEvents;
+            const char* hostExecutable = std::getenv("FMUS_PLUGIN_HOST");
+            if (hostExecutable) {
+                hostConfig.hostExecutable = hostExecutable;
+            }
+            record.plugin = std::make_shared<RemotePlugin>(record.manifest.info, hostConfig);
+            // Without this the watcher sees a changed library on every poll
+            record.libraryTime = libraryWriteTime(record.manifest.libraryPath);
+            record.initialized = false;
+            record.lastError.clear();
+            return true;
+        }
+
+        std::string error;
+        std::string path = record.manifest.libraryPath;
+
+        record.generation++;
+        if (forceShadow || hotReload) {
+            path = shadowCopy(record.manifest.libraryPath, record.generation, error);
+            if (path.empty()) {
+                record.lastError = error;
+                return false;
+            }
+        }
+
+        record.libraryTime = libraryWriteTime(record.manifest.libraryPath);
+        auto plugin = createPluginFromLibrary(path, error);
+
+#ifndef _WIN32
+        // The mapping stays valid once loaded; the shadow file is no longer needed
+        if (path != record.manifest.libraryPath) {
+            std::error_code ec;
+            fs::remove(path, ec);
+        }
+#endif
+
+        if (!plugin) {
+            record.lastError = error;
+            return false;
+        }
+
+        record.plugin = plugin;
+        record.initialized = false;
+        record.lastError.clear();
+        return true;
+    }
+
+    // Caller holds record.gate exclusively
+    bool initializeRecord(PluginRecord& record) {
+        try {
+            if (!record.plugin->initialize(autoInstance)) {
+                record.lastError = "Plugin initialization failed";
+                return false;
+            }
+        } catch (const std::exception& e) {
+            record.lastError = "Plugin initialization threw: " + std::string(e.what());
+            return false;
+        }
+
+        record.initialized = true;
+        if (auto provider = std::dynamic_pointer_cast<IExtensionProvider>(record.plugin)) {
+            getGlobalExtensionRegistry()->registerProvider(*provider, record.manifest.info.name, record.plugin);
+        }
+        indexCapabilities(record, record.plugin->getCapabilities());
+        {
+            std::lock_guard<std::mutex> lock(recordsMutex);
+            initOrder.push_back(record.manifest.info.name);
+        }
+        return true;
+    }
+
+    // Caller holds record.gate exclusively
+    void releaseRecord(PluginRecord& record) {
+        getGlobalExtensionRegistry()->unregisterOwner(record.manifest.info.name);
+        if (record.plugin && record.initialized) {
+            try {
+                record.plugin->shutdown();
+            } catch (const std::exception& e) {
+                Logger::getInstance()->warning("Plugin '" + record.manifest.info.name +
+                                               "' shutdown threw: " + e.what());
+            }
+        }
+        record.plugin.reset();
+        record.initialized = false;
+
+        std::lock_guard<std::mutex> lock(recordsMutex);
+        initOrder.erase(std::remove(initOrder.begin(), initOrder.end(), record.manifest.info.name),
+                        initOrder.end());
+    }
+
+    /**
+     * Load and initialize a deferred plugin and its dependencies on demand.
+     */
+    bool ensureLoaded(const std::string& name, std::set<std::string>& visiting, std::string& error) {
+        auto record = findRecord(name);
+        if (!record) {
+            error = "Plugin not found: " + name;
+            return false;
+        }
+
+        {
+            std::shared_lock<std::shared_mutex> lock(record->gate);
+            if (record->plugin && record->initialized) {
+                return true;
+            }
+        }
+
+        if (!visiting.insert(name).second) {
+            error = "Circular plugin dependency involving: " + name;
+            return false;
+        }
+
+        for (const auto& dependency : record->manifest.info.dependencies) {
+            if (!ensureLoaded(dependency, visiting, error)) {
+                error = "Dependency '" + dependency + "' of '" + name + "' unavailable: " + error;
+                return false;
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(record->gate);
+        if (record->plugin && record->initialized) {
+            return true;
+        }
+
+        auto logger = Logger::getInstance();
+        logger->info("Loading deferred plugin: " + name);
+
+        if ((!record->plugin && !loadRecord(*record, false)) || !initializeRecord(*record)) {
+            error = record->lastError;
+            record->plugin.reset();
+            logger->error("Failed to load plugin '" + name + "': " + error);
+            std::lock_guard<std::mutex> statsLock(statsMutex);
+            statistics.pluginsFailed++;
+            return false;
+        }
+
+        std::lock_guard<std::mutex> statsLock(statsMutex);
+        statistics.pluginsLoaded++;
+        return true;
+    }
+
+    std::shared_ptr<IPlugin> acquire(const std::string& name) {
+        std::set<std::string> visiting;
+        std::string error;
+        if (!ensureLoaded(name, visiting, error)) {
+            return nullptr;
+        }
+        auto record = findRecord(name);
+        if (!record) {
+            return nullptr;
+        }
+        std::shared_lock<std::shared_mutex> lock(record->gate);
+        return record->plugin;
+    }
+
+    /**
+     * Replace a plugin with a fresh copy of its library. Taking the gate
+     * exclusively blocks new commands until in-flight ones have drained.
+     */
+    bool reloadRecord(PluginRecord& record) {
+        auto logger = Logger::getInstance();
+        std::unique_lock<std::shared_mutex> lock(record.gate);
+        logger->info("Reloading plugin: " + record.manifest.info.name);
+
+        releaseRecord(record);
+
+        if (!loadRecord(record, true) || !initializeRecord(record)) {
+            logger->error("Failed to reload plugin '" + record.manifest.info.name + "': " + record.lastError);
+            record.plugin.reset();
+            std::lock_guard<std::mutex> statsLock(statsMutex);
+            statistics.pluginsFailed++;
+            return false;
+        }
+
+        std::lock_guard<std::mutex> statsLock(statsMutex);
+        statistics.pluginsReloaded++;
+        return true;
+    }
+
+    // Hot reload
+
+    void startWatcher() {
+        watcher = std::thread([this]() { watchLoop(); });
+    }
+
+    void stopWatcher() {
+        hotReload = false;
+        {
+            std::lock_guard<std::mutex> lock(watchMutex);
+            watchCondition.notify_all();
+        }
+        if (watcher.joinable()) {
+            watcher.join();
+        }
+    }
+
+    void watchLoop();
+};
+
+// PluginInfo implementation
+std::string PluginInfo::toString() const {
+    std::ostringstream ss;
+    ss << "PluginInfo[Name:" << name << ", Version:" << version
+       << ", Type:" << pluginTypeToString(type)
+       << ", Interface:" << interfaceVersion
+       << ", Dependencies:" << dependencies.size() << "]";
+    return ss.str();
+}
+
+// PluginLoadResult implementation
+std::string PluginLoadResult::toString() const {
+    std::ostringstream ss;
+    ss << "PluginLoadResult[Success:" << (success ? "true" : "false");
+    if (plugin) {
+        ss << ", Plugin:" << plugin->getInfo().name;
+    }
+    if (!errorMessage.empty()) {
+        ss << ", Error:" << errorMessage;
+    }
+    ss << "]";
+    return ss.str();
+}
+
+// PluginManifest implementation
+std::string PluginManifest::toString() const {
+    std::ostringstream ss;
+    ss << "PluginManifest[Name:" << info.name << ", Library:" << libraryPath
+       << ", Capabilities:" << capabilities.size()
+       << ", Lazy:" << (lazy ? "true" : "false") << "]";
+    return ss.str();
+}
+
+// PluginManager implementation
+PluginManager::PluginManager() : pImpl(std::make_unique<Impl>()) {}
+
+PluginManager::~PluginManager() {
+    shutdown();
+}
+
+PluginManager* PluginManager::getInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (!instance) {
+        instance = new PluginManager();
+    }
+    return instance;
+}
+
+bool PluginManager::initialize(std::shared_ptr<Auto> autoInstance) {
+    pImpl->autoInstance = autoInstance;
+    pImpl->initialized = true;
+
+    auto logger = Logger::getInstance();
+    logger->info("Plugin manager initialized");
+    return true;
+}
+
+void PluginManager::shutdown() {
+    pImpl->stopWatcher();
+
+    // Shut down in reverse initialization order so dependents go first
+    std::vector<std::string> order;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->recordsMutex);
+        order.assign(pImpl->initOrder.rbegin(), pImpl->initOrder.rend());
+    }
+    for (const auto& name : order) {
+        auto record = pImpl->findRecord(name);
+        if (record) {
+            std::unique_lock<std::shared_mutex> lock(record->gate);
+            pImpl->releaseRecord(*record);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pImpl->recordsMutex);
+        pImpl->records.clear();
+        pImpl->capabilityIndex.clear();
+        pImpl->initOrder.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pImpl->legacyMutex);
+        for (auto subscription : pImpl->legacySubscriptions) {
+            pImpl->eventBus->unsubscribe(subscription);
+        }
+        pImpl->legacySubscriptions.clear();
+    }
+
+    pImpl->initialized = false;
+}
+
+PluginLoadResult PluginManager::loadPlugin(const std::string& filePath) {
+    auto logger = Logger::getInstance();
+    auto record = std::make_shared<PluginRecord>();
+
+    if (fs::path(filePath).extension() == PLUGIN_MANIFEST_EXTENSION) {
+        record->manifest = loadPluginManifest(filePath);
+        if (!record->manifest.isValid()) {
+            return PluginLoadResult(false, "Invalid plugin manifest: " + filePath);
+        }
+    } else {
+        record->manifest.libraryPath = filePath;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(record->gate);
+    if (!pImpl->loadRecord(*record, false)) {
+        std::lock_guard<std::mutex> statsLock(pImpl->statsMutex);
+        pImpl->statistics.pluginsFailed++;
+        return PluginLoadResult(false, record->lastError);
+    }
+
+    if (record->manifest.info.name.empty()) {
+        record->manifest.info = record->plugin->getInfo();
+    }
+
+    if (!pImpl->addRecord(record)) {
+        return PluginLoadResult(false, "Plugin already loaded: " + record->manifest.info.name);
+    }
+
+    for (const auto& dependency : record->manifest.info.dependencies) {
+        std::set<std::string> visiting{record->manifest.info.name};
+        std::string error;
+        if (!pImpl->ensureLoaded(dependency, visiting, error)) {
+            pImpl->releaseRecord(*record);
+            pImpl->eraseRecord(record->manifest.info.name);
+            return PluginLoadResult(false, "Missing dependency '" + dependency + "': " + error);
+        }
+    }
+
+    if (!pImpl->initializeRecord(*record)) {
+        std::string error = record->lastError;
+        pImpl->releaseRecord(*record);
+        pImpl->eraseRecord(record->manifest.info.name);
+        std::lock_guard<std::mutex> statsLock(pImpl->statsMutex);
+        pImpl->statistics.pluginsFailed++;
+        return PluginLoadResult(false, error);
+    }
+
+    {
+        std::lock_guard<std::mutex> statsLock(pImpl->statsMutex);
+        pImpl->statistics.pluginsLoaded++;
+    }
+
+    logger->info("Plugin loaded: " + record->manifest.info.toString());
+
+    PluginLoadResult result(true);
+    result.plugin = record->plugin;
+    return result;
+}
+
+bool PluginManager::unloadPlugin(const std::string& pluginName) {
+    auto record = pImpl->findRecord(pluginName);
+    if (!record) {
+        return false;
+    }
+
+    {
+        // Waits for in-flight commands to drain
+        std::unique_lock<std::shared_mutex> lock(record->gate);
+        pImpl->releaseRecord(*record);
+    }
+
+    pImpl->eraseRecord(pluginName);
+
+    Logger::getInstance()->info("Plugin unloaded: " + pluginName);
+    return true;
+}
+
+std::vector<PluginManifest> PluginManager::discoverPlugins(const std::string& directory) const {
+    std::vector<PluginManifest> manifests;
+    std::error_code ec;
+
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        if (entry.is_regular_file() && entry.path().extension() == PLUGIN_MANIFEST_EXTENSION) {
+            auto manifest = loadPluginManifest(entry.path().string());
+            if (manifest.isValid()) {
+                manifests.push_back(std::move(manifest));
+            } else {
+                Logger::getInstance()->warning("Ignoring invalid plugin manifest: " + entry.path().string());
+            }
+        }
+    }
+
+    return manifests;
+}
+
+std::vector<PluginLoadResult> PluginManager::loadPluginsFromDirectory(const std::string& directory) {
+    auto logger = Logger::getInstance();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<PluginLoadResult> results;
+
+    // 1. Manifests describe plugins without touching their code
+    auto manifests = discoverPlugins(directory);
+    std::set<std::string> describedLibraries;
+    for (const auto& manifest : manifests) {
+        describedLibraries.insert(fs::absolute(manifest.libraryPath).lexically_normal().string());
+    }
+
+    std::vector<std::shared_ptr<PluginRecord>> candidates;
+    for (const auto& manifest : manifests) {
+        auto record = std::make_shared<PluginRecord>();
+        record->manifest = manifest;
+        if (!pImpl->addRecord(record)) {
+            results.emplace_back(false, "Plugin already loaded: " + manifest.info.name);
+            continue;
+        }
+        candidates.push_back(record);
+    }
+
+    // 2. Libraries without a manifest must be loaded to learn what they are
+    std::vector<std::string> bareLibraries;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        std::string path = entry.path().string();
+        if (isValidPluginFile(path) &&
+            !describedLibraries.count(fs::absolute(entry.path()).lexically_normal().string())) {
+            bareLibraries.push_back(path);
+        }
+    }
+
+    std::vector<std::shared_ptr<PluginRecord>> bareRecords(bareLibraries.size());
+    runParallel(bareLibraries.size(), [this, &bareLibraries, &bareRecords](size_t i) {
+        auto record = std::make_shared<PluginRecord>();
+        record->manifest.libraryPath = bareLibraries[i];
+        record->manifest.lazy = false;
+        std::unique_lock<std::shared_mutex> lock(record->gate);
+        if (pImpl->loadRecord(*record, false)) {
+            record->manifest.info = record->plugin->getInfo();
+            record->manifest.capabilities = record->plugin->getCapabilities();
+        }
+        bareRecords[i] = record;
+    });
+
+    for (auto& record : bareRecords) {
+        if (!record->plugin) {
+            results.emplace_back(false, record->lastError);
+            continue;
+        }
+        if (!pImpl->addRecord(record)) {
+            results.emplace_back(false, "Plugin already loaded: " + record->manifest.info.name);
+            continue;
+        }
+        candidates.push_back(record);
+    }
+
+    // 3. Eager set: non-lazy plugins plus everything they depend on
+    std::map<std::string, std::shared_ptr<PluginRecord>> eager;
+    std::vector<std::string> pending;
+    for (const auto& record : candidates) {
+        if (!record->manifest.lazy) {
+            pending.push_back(record->manifest.info.name);
+        }
+    }
+    std::set<std::string> failed;
+    while (!pending.empty()) {
+        std::string name = pending.back();
+        pending.pop_back();
+        if (eager.count(name)) {
+            continue;
+        }
+        auto record = pImpl->findRecord(name);
+        if (!record) {
+            continue;
+        }
+        {
+            std::shared_lock<std::shared_mutex> lock(record->gate);
+            if (record->initialized) {
+                continue; // Already running from an earlier load
+            }
+        }
+        eager[name] = record;
+        for (const auto& dependency : record->manifest.info.dependencies) {
+            if (!pImpl->findRecord(dependency)) {
+                failed.insert(name);
+                record->lastError = "Missing dependency: " + dependency;
+            } else {
+                pending.push_back(dependency);
+            }
+        }
+    }
+
+    // 4. Load eager plugin code in parallel
+    std::vector<std::shared_ptr<PluginRecord>> toLoad;
+    for (const auto& entry : eager) {
+        if (!entry.second->plugin && !failed.count(entry.first)) {
+            toLoad.push_back(entry.second);
+        }
+    }
+    runParallel(toLoad.size(), [this, &toLoad](size_t i) {
+        std::unique_lock<std::shared_mutex> lock(toLoad[i]->gate);
+        pImpl->loadRecord(*toLoad[i], false);
+    });
+    for (const auto& record : toLoad) {
+        if (!record->plugin) {
+            failed.insert(record->manifest.info.name);
+        }
+    }
+
+    // 5. Initialize level by level; each level only depends on earlier ones
+    std::set<std::string> done;
+    std::set<std::string> remaining;
+    for (const auto& entry : eager) {
+        remaining.insert(entry.first);
+    }
+
+    while (!remaining.empty()) {
+        std::vector<std::shared_ptr<PluginRecord>> level;
+        std::vector<std::string> blocked;
+
+        for (const auto& name : remaining) {
+            auto& record = eager[name];
+            bool ready = true;
+            bool dependencyFailed = failed.count(name) > 0;
+            for (const auto& dependency : record->manifest.info.dependencies) {
+                if (failed.count(dependency)) {
+                    dependencyFailed = true;
+                    if (record->lastError.empty()) {
+                        record->lastError = "Dependency failed: " + dependency;
+                    }
+                } else if (eager.count(dependency) && !done.count(dependency)) {
+                    ready = false;
+                }
+            }
+            if (dependencyFailed) {
+                blocked.push_back(name);
+            } else if (ready) {
+                level.push_back(record);
+            }
+        }
+
+        for (const auto& name : blocked) {
+            failed.insert(name);
+            remaining.erase(name);
+        }
+
+        if (level.empty()) {
+            if (blocked.empty()) {
+                // Whatever is left depends on itself
+                for (const auto& name : remaining) {
+                    eager[name]->lastError = "Circular plugin dependency";
+                    failed.insert(name);
+                }
+                remaining.clear();
+            }
+            continue;
+        }
+
+        std::vector<char> succeeded(level.size(), 0);
+        runParallel(level.size(), [this, &level, &succeeded](size_t i) {
+            std::unique_lock<std::shared_mutex> lock(level[i]->gate);
+            succeeded[i] = pImpl->initializeRecord(*level[i]) ? 1 : 0;
+        });
+
+        for (size_t i = 0; i < level.size(); ++i) {
+            const std::string& name = level[i]->manifest.info.name;
+            remaining.erase(name);
+            if (succeeded[i]) {
+                done.insert(name);
+            } else {
+                failed.insert(name);
+            }
+        }
+    }
+
+    // 6. Collect results
+    uint32_t loaded = 0;
+    uint32_t failures = 0;
+    for (const auto& entry : eager) {
+        auto& record = entry.second;
+        if (done.count(entry.first)) {
+            PluginLoadResult result(true);
+            result.plugin = record->plugin;
+            results.push_back(result);
+            loaded++;
+        } else {
+            {
+                std::unique_lock<std::shared_mutex> lock(record->gate);
+                pImpl->releaseRecord(*record);
+            }
+            pImpl->eraseRecord(entry.first);
+            results.emplace_back(false, entry.first + ": " + record->lastError);
+            logger->error("Failed to load plugin '" + entry.first + "': " + record->lastError);
+            failures++;
+        }
+    }
+
+    uint32_t deferred = 0;
+    for (const auto& record : candidates) {
+        if (!eager.count(record->manifest.info.name) && !record->plugin) {
+            deferred++;
+        }
+    }
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    {
+        std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+        pImpl->statistics.pluginsLoaded += loaded;
+        pImpl->statistics.pluginsFailed += static_cast<uint32_t>(results.size()) - loaded;
+        pImpl->statistics.pluginsDeferred += deferred;
+        pImpl->statistics.lastLoadDuration = duration;
+    }
+
+    logger->info("Plugins from " + directory + ": " + std::to_string(loaded) + " loaded, " +
+                 std::to_string(deferred) + " deferred, " + std::to_string(failures) + " failed in " +
+                 std::to_string(duration.count()) + "ms");
+
+    return results;
+}
+
+std::shared_ptr<IPlugin> PluginManager::getPluginForCapability(const std::string& capability) {
+    std::string name;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->recordsMutex);
+        auto it = pImpl->capabilityIndex.find(capability);
+        if (it == pImpl->capabilityIndex.end()) {
+            return nullptr;
+        }
+        name = it->second;
+    }
+    return pImpl->acquire(name);
+}
+
+std::string PluginManager::executeCommand(const std::string& pluginName, const std::string& command,
+                                          const std::map<std::string, std::string>& parameters) {
+    std::set<std::string> visiting;
+    std::string error;
+    if (!pImpl->ensureLoaded(pluginName, visiting, error)) {
+        throw PluginError(PluginError::ErrorCode::EXECUTION_FAILED, error);
+    }
+
+    auto record = pImpl->findRecord(pluginName);
+    if (!record) {
+        throw PluginError(PluginError::ErrorCode::EXECUTION_FAILED, "Plugin not found: " + pluginName);
+    }
+
+    // Shared hold: a reload waits until this command returns
+    std::shared_lock<std::shared_mutex> lock(record->gate);
+    if (!record->plugin || !record->initialized) {
+        throw PluginError(PluginError::ErrorCode::EXECUTION_FAILED,
+                          "Plugin unavailable: " + pluginName + " " + record->lastError);
+    }
+
+    {
+        std::lock_guard<std::mutex> statsLock(pImpl->statsMutex);
+        pImpl->statistics.commandsExecuted++;
+    }
+
+    return record->plugin->executeCommand(command, parameters);
+}
+
+bool PluginManager::reloadPlugin(const std::string& pluginName) {
+    auto record = pImpl->findRecord(pluginName);
+    if (!record) {
+        return false;
+    }
+    return pImpl->reloadRecord(*record);
+}
+
+void PluginManager::setHotReloadEnabled(bool enabled, std::chrono::milliseconds pollInterval) {
+    pImpl->stopWatcher();
+    if (enabled) {
+        pImpl->pollInterval = pollInterval;
+        pImpl->hotReload = true;
+        pImpl->startWatcher();
+    }
+}
+
+void PluginManager::Impl::watchLoop() {
+    while (hotReload) {
+        {
+            std::unique_lock<std::mutex> lock(watchMutex);
+            watchCondition.wait_for(lock, pollInterval, [this] { return !hotReload; });
+        }
+        if (!hotReload) {
+            break;
+        }
+
+        std::vector<std::shared_ptr<PluginRecord>> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(recordsMutex);
+            for (const auto& entry : records) {
+                snapshot.push_back(entry.second);
+            }
+        }
+
+        for (const auto& record : snapshot) {
+            bool loaded;
+            fs::file_time_type knownTime;
+            {
+                std::shared_lock<std::shared_mutex> lock(record->gate);
+                loaded = record->plugin != nullptr;
+                knownTime = record->libraryTime;
+            }
+            if (!loaded) {
+                continue; // Deferred plugins pick up the new file when first loaded
+            }
+
+            auto current = libraryWriteTime(record->manifest.libraryPath);
+            if (current == knownTime || current == fs::file_time_type::min()) {
+                record->pendingTime = fs::file_time_type::min();
+                continue;
+            }
+
+            // Reload only once the file has stopped changing for a full poll
+            if (record->pendingTime != current) {
+                record->pendingTime = current;
+                continue;
+            }
+
+            record->pendingTime = fs::file_time_type::min();
+            Logger::getInstance()->info("Plugin library changed: " + record->manifest.libraryPath);
+            reloadRecord(*record);
+        }
+    }
+}
+
+std::vector<std::shared_ptr<IPlugin>> PluginManager::getLoadedPlugins() const {
+    std::vector<std::shared_ptr<PluginRecord>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->recordsMutex);
+        for (const auto& entry : pImpl->records) {
+            snapshot.push_back(entry.second);
+        }
+    }
+
+    std::vector<std::shared_ptr<IPlugin>> plugins;
+    for (const auto& record : snapshot) {
+        std::shared_lock<std::shared_mutex> lock(record->gate);
+        if (record->plugin && record->initialized) {
+            plugins.push_back(record->plugin);
+        }
+    }
+    return plugins;
+}
+
+std::shared_ptr<IPlugin> PluginManager::getPlugin(const std::string& name) const {
+    return pImpl->acquire(name);
+}
+
+std::vector<std::shared_ptr<IPlugin>> PluginManager::getPluginsByType(PluginType type) const {
+    std::vector<std::string> names;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->recordsMutex);
+        for (const auto& entry : pImpl->records) {
+            if (entry.second->manifest.info.type == type) {
+                names.push_back(entry.first);
+            }
+        }
+    }
+
+    std::vector<std::shared_ptr<IPlugin>> plugins;
+    for (const auto& name : names) {
+        auto plugin = pImpl->acquire(name);
+        if (plugin) {
+            plugins.push_back(plugin);
+        }
+    }
+    return plugins;
+}
+
+bool PluginManager::isPluginLoaded(const std::string& name) const {
+    auto record = pImpl->findRecord(name);
+    if (!record) {
+        return false;
+    }
+    std::shared_lock<std::shared_mutex> lock(record->gate);
+    return record->plugin != nullptr && record->initialized;
+}
+
+std::vector<PluginInfo> PluginManager::getPluginInfos() const {
+    std::vector<PluginInfo> infos;
+    std::lock_guard<std::mutex> lock(pImpl->recordsMutex);
+    for (const auto& entry : pImpl->records) {
+        infos.push_back(entry.second->manifest.info);
+    }
+    return infos;
+}
+
+void PluginManager::registerEventHandler(const std::string& event,
+                                         std::function<void(const std::string&, const std::map<std::string, std::string>&)> handler) {
+    EventId id = pImpl->eventBus->registerEvent(event);
+    auto subscription = pImpl->eventBus->subscribe(id, event, [event, handler](const Event& e) {
+        if (auto legacy = e.get<LegacyEvent>()) {
+            handler(event, legacy->data);
+        }
+    });
+
+    std::lock_guard<std::mutex> lock(pImpl->legacyMutex);
+    pImpl->legacySubscriptions.push_back(subscription);
+}
+
+void PluginManager::triggerEvent(const std::string& event, const std::map<std::string, std::string>& data) {
+    EventId id = pImpl->eventBus->registerEvent(event);
+    pImpl->eventBus->publish(id, LegacyEvent{data});
+
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    pImpl->statistics.eventsTriggered++;
+}
+
+std::shared_ptr<EventBus> PluginManager::getEventBus() const {
+    return pImpl->eventBus;
+}
+
+PluginManager::Statistics PluginManager::getStatistics() const {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    return pImpl->statistics;
+}
+
+void PluginManager::resetStatistics() {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    pImpl->statistics = Statistics{};
+    pImpl->statistics.startTime = std::chrono::system_clock::now();
+}
+
+// PluginRegistry implementation
+void PluginRegistry::registerPlugin(const std::string& name, PluginFactoryFunction factory) {
+    factories[name] = factory;
+}
+
+std::shared_ptr<IPlugin> PluginRegistry::createPlugin(const std::string& name) {
+    auto it = factories.find(name);
+    return it != factories.end() ? it->second() : nullptr;
+}
+
+std::vector<std::string> PluginRegistry::getRegisteredPlugins() {
+    std::vector<std::string> names;
+    for (const auto& entry : factories) {
+        names.push_back(entry.first);
+    }
+    return names;
+}
+
+// Utility functions
+std::string pluginTypeToString(PluginType type) {
+    switch (type) {
+        case PluginType::DIAGNOSTIC: return "DIAGNOSTIC";
+        case PluginType::VEHICLE_SPECIFIC: return "VEHICLE_SPECIFIC";
+        case PluginType::TOOL: return "TOOL";
+        case PluginType::EXPORT: return "EXPORT";
+        case PluginType::VISUALIZATION: return "VISUALIZATION";
+        case PluginType::CUSTOM: return "CUSTOM";
+        default: return "UNKNOWN";
+    }
+}
+
+PluginType stringToPluginType(const std::string& str) {
+    if (str == "DIAGNOSTIC") {
+        return PluginType::DIAGNOSTIC;
+    } else if (str == "VEHICLE_SPECIFIC") {
+        return PluginType::VEHICLE_SPECIFIC;
+    } else if (str == "TOOL") {
+        return PluginType::TOOL;
+    } else if (str == "EXPORT") {
+        return PluginType::EXPORT;
+    } else if (str == "VISUALIZATION") {
+        return PluginType::VISUALIZATION;
+    }
+    return PluginType::CUSTOM;
+}
+
+bool isValidPluginFile(const std::string& filePath) {
+    std::error_code ec;
+    if (!fs::is_regular_file(filePath, ec)) {
+        return false;
+    }
+    std::string extension = fs::path(filePath).extension().string();
+#ifdef _WIN32
+    return extension == ".dll";
+#elif defined(__APPLE__)
+    return extension == ".dylib" || extension == ".so";
+#else
+    return extension == ".so";
+#endif
+}
+
+std::string getPluginDirectory() {
+    const char* directory = std::getenv("FMUS_PLUGIN_DIR");
+    return directory ? std::string(directory) : std::string("plugins");
+}
+
+PluginManifest loadPluginManifest(const std::string& manifestPath) {
+    PluginManifest manifest;
+    manifest.manifestPath = manifestPath;
+
+    std::ifstream file(manifestPath);
+    if (!file.is_open()) {
+        return manifest;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        size_t separator = line.find('=');
+        if (separator == std::string::npos) {
+            continue;
+        }
+
+        std::string key = trim(line.substr(0, separator));
+        std::string value = trim(line.substr(separator + 1));
+
+        if (key == "name") {
+            manifest.info.name = value;
+        } else if (key == "description") {
+            manifest.info.description = value;
+        } else if (key == "version") {
+            manifest.info.version = value;
+        } else if (key == "author") {
+            manifest.info.author = value;
+        } else if (key == "website") {
+            manifest.info.website = value;
+        } else if (key == "type") {
+            manifest.info.type = stringToPluginType(value);
+        } else if (key == "interfaceVersion") {
+            manifest.info.interfaceVersion = std::atoi(value.c_str());
+        } else if (key == "library") {
+            fs::path library(value);
+            if (library.is_relative()) {
+                library = fs::path(manifestPath).parent_path() / library;
+            }
+            manifest.libraryPath = library.lexically_normal().string();
+        } else if (key == "dependencies") {
+            manifest.info.dependencies = splitList(value);
+        } else if (key == "capabilities") {
+            manifest.capabilities = splitList(value);
+        } else if (key == "lazy") {
+            manifest.lazy = (value == "true" || value == "1" || value == "yes");
+        } else if (key == "isolated") {
+            manifest.isolated = (value == "true" || value == "1" || value == "yes");
+        } else if (key == "forwardEvents") {
+            manifest.forwardedEvents = splitList(value);
+        } else if (key == "exportEvents") {
+            manifest.exportedEvents = splitList(value);
+        } else if (key.compare(0, 9, "metadata.") == 0) {
+            manifest.info.metadata[key.substr(9)] = value;
+        }
+    }
+
+    if (manifest.info.interfaceVersion != PLUGIN_INTERFACE_VERSION) {
+        Logger::getInstance()->warning("Plugin manifest " + manifestPath + " declares interface version " +
+                                       std::to_string(manifest.info.interfaceVersion));
+        manifest.libraryPath.clear();
+    }
+
+    return manifest;
+}
+
+} // namespace plugins
+} // namespace fmus
@@ -0,0 +1,459 @@
+#include <fmus/protocols/bus_statistics.h>
+#include <fmus/protocols/can.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+namespace fmus {
+namespace protocols {
+
+namespace {
+
+constexpr size_t MIN_ID_CAPACITY = 16;
+constexpr uint32_t KEY_OCCUPIED = 1u << 30;
+constexpr uint32_t KEY_EXTENDED = 1u << 31;
+
+// Bits around the stuffed region: CRC delimiter, ACK slot and delimiter, EOF, interframe space
+constexpr uint32_t FRAME_TRAILER_BITS = 1 + 2 + 7 + 3;
+// Error flag, superposed flags and delimiter take 17 to 23 bits with the interframe space
+constexpr uint32_t ERROR_FRAME_BITS = 20;
+constexpr uint16_t CRC15_POLYNOMIAL = 0x4599;
+
+uint32_t idKey(uint32_t id, bool extended) {
+    return id | KEY_OCCUPIED | (extended ? KEY_EXTENDED : 0);
+}
+
+int64_t toNanoseconds(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+double nanosecondsPerBit(uint32_t rate) {
+    return rate ? 1e9 / rate : 0.0;
+}
+
+/**
+ * Serializes frame fields MSB first, counting dynamic stuff bits and the CRC-15
+ */
+class BitStream {
+public:
+    void put(uint32_t value, unsigned bits, bool crc = true) {
+        for (unsigned i = bits; i-- > 0;) {
+            unsigned bit = (value >> i) & 1;
+            if (crc) {
+                bool feedback = bit != ((crc15 >> 14) & 1);
+                crc15 = static_cast<uint16_t>((crc15 << 1) & 0x7FFF);
+                if (feedback) {
+                    crc15 ^= CRC15_POLYNOMIAL;
+                }
+            }
+            if (bit == last) {
+                ++run;
+            } else {
+                last = bit;
+                run = 1;
+            }
+            if (run == 5) {
+                // The stuff bit has the opposite level and starts the next run
+                ++stuffBits;
+                last ^= 1;
+                run = 1;
+            }
+        }
+    }
+
+    void putBytes(const uint8_t* data, size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            put(data[i], 8);
+        }
+    }
+
+    uint32_t stuffBits = 0;
+    uint16_t crc15 = 0;
+
+private:
+    unsigned last = 2;
+    unsigned run = 0;
+};
+
+void putIdentifier(BitStream& stream, const CANMessage& message, bool remote) {
+    if (message.extended) {
+        stream.put(message.id >> 18, 11);
+        stream.put(1, 1);                   // SRR
+        stream.put(1, 1);                   // IDE
+        stream.put(message.id & 0x3FFFF, 18);
+        stream.put(remote ? 1 : 0, 1);      // RTR, or RRS for CAN FD
+    } else {
+        stream.put(message.id, 11);
+        stream.put(remote ? 1 : 0, 1);
+        stream.put(0, 1);                   // IDE
+    }
+}
+
+} // anonymous namespace
+
+std::string BusStatisticsConfig::toString() const {
+    std::ostringstream ss;
+    ss << "BusStatisticsConfig[BaudRate:" << baudRate
+       << ", DataBaudRate:" << dataBaudRate
+       << ", Stuffing:" << stuffingModelToString(stuffing)
+       << ", IdCapacity:" << idCapacity << "]";
+    return ss.str();
+}
+
+std::string CANIdStatistics::toString() const {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(2)
+       << "CANIdStatistics[ID:" << canIdToString(id, extended)
+       << ", Frames:" << frames
+       << ", Period:" << period << "ms"
+       << ", Jitter:" << jitter << "ms"
+       << ", Share:" << loadShare << "%]";
+    return ss.str();
+}
+
+std::string BusLoadSnapshot::toString() const {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(1)
+       << "BusLoad[Load:" << load << "%"
+       << ", Average:" << averageLoad << "%"
+       << ", Peak:" << peakLoad << "%"
+       << ", FramesPerSecond:" << framesPerSecond
+       << ", ErrorFrames:" << errorFrames
+       << (overloaded ? ", Overloaded" : "") << "]";
+    return ss.str();
+}
+
+// BusStatistics implementation
+class BusStatistics::Impl {
+public:
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> key{0};
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> busyNs{0};
+        std::atomic<int64_t> lastNs{0};
+        std::atomic<double> period{0.0};        // ns
+        std::atomic<double> jitter{0.0};        // ns
+    };
+
+    BusStatisticsConfig config;
+    std::unique_ptr<Slot[]> slots;
+    uint32_t mask = 0;
+    unsigned hashShift = 0;
+
+    std::atomic<double> nominalBitNs{0.0};
+    std::atomic<double> dataBitNs{0.0};
+    std::atomic<StuffingModel> stuffing{StuffingModel::EXACT};
+
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> errorFrames{0};
+    std::atomic<uint64_t> untrackedFrames{0};
+    std::atomic<uint64_t> busyNs{0};
+
+    // Snapshot state, touched only by readers
+    std::mutex snapshotMutex;
+    std::chrono::steady_clock::time_point resetTime;
+    std::chrono::steady_clock::time_point lastSnapshot;
+    uint64_t lastBusyNs = 0;
+    uint64_t lastFrames = 0;
+    double peakLoad = 0.0;
+
+    const Slot* find(uint32_t key) const {
+        uint32_t index = (key * 2654435761u) >> hashShift;
+        for (uint32_t probe = 0; probe <= mask; ++probe) {
+            const Slot& slot = slots[(index + probe) & mask];
+            uint32_t current = slot.key.load(std::memory_order_acquire);
+            if (current == key) {
+                return &slot;
+            }
+            if (current == 0) {
+                return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+    Slot* claim(uint32_t key) {
+        uint32_t index = (key * 2654435761u) >> hashShift;
+        for (uint32_t probe = 0; probe <= mask; ++probe) {
+            Slot& slot = slots[(index + probe) & mask];
+            uint32_t current = slot.key.load(std::memory_order_acquire);
+            if (current == 0 && slot.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+                return &slot;
+            }
+            if (current == key) {
+                return &slot;
+            }
+        }
+        return nullptr;
+    }
+
+    void updatePeriod(Slot& slot, double interval) {
+        const double weight = config.periodWeight;
+        double period = slot.period.load(std::memory_order_relaxed);
+        double updated;
+        do {
+            updated = period == 0.0 ? interval : period + weight * (interval - period);
+        } while (!slot.period.compare_exchange_weak(period, updated, std::memory_order_relaxed));
+        if (period == 0.0) {
+            return;
+        }
+
+        const double deviation = std::fabs(interval - period);
+        double jitter = slot.jitter.load(std::memory_order_relaxed);
+        do {
+            updated = jitter + weight * (deviation - jitter);
+        } while (!slot.jitter.compare_exchange_weak(jitter, updated, std::memory_order_relaxed));
+    }
+
+    CANIdStatistics toIdStatistics(const Slot& slot, uint64_t totalBusy) const {
+        uint32_t key = slot.key.load(std::memory_order_acquire);
+        CANIdStatistics stats;
+        stats.extended = (key & KEY_EXTENDED) != 0;
+        stats.id = key & ~(KEY_OCCUPIED | KEY_EXTENDED);
+        stats.frames = slot.frames.load(std::memory_order_relaxed);
+        stats.bytes = slot.bytes.load(std::memory_order_relaxed);
+        stats.period = slot.period.load(std::memory_order_relaxed) / 1e6;
+        stats.jitter = slot.jitter.load(std::memory_order_relaxed) / 1e6;
+        stats.loadShare = totalBusy ? 100.0 * slot.busyNs.load(std::memory_order_relaxed) / totalBusy : 0.0;
+        stats.lastSeen = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(slot.lastNs.load(std::memory_order_relaxed))));
+        return stats;
+    }
+};
+
+BusStatistics::BusStatistics(const BusStatisticsConfig& config) : pImpl(std::make_unique<Impl>()) {
+    pImpl->config = config;
+    size_t capacity = MIN_ID_CAPACITY;
+    unsigned bits = 4;
+    while (capacity < config.idCapacity && bits < 24) {
+        capacity <<= 1;
+        ++bits;
+    }
+    pImpl->config.idCapacity = capacity;
+    pImpl->config.periodWeight = std::min(std::max(config.periodWeight, 0.0), 1.0);
+    pImpl->slots.reset(new Impl::Slot[capacity]);
+    pImpl->mask = static_cast<uint32_t>(capacity - 1);
+    pImpl->hashShift = 32 - bits;
+    setBitRates(config.baudRate, config.dataBaudRate);
+    setStuffingModel(config.stuffing);
+    pImpl->resetTime = pImpl->lastSnapshot = std::chrono::steady_clock::now();
+}
+
+BusStatistics::~BusStatistics() = default;
+
+void BusStatistics::setBitRates(uint32_t baudRate, uint32_t dataBaudRate) {
+    pImpl->nominalBitNs.store(nanosecondsPerBit(baudRate), std::memory_order_relaxed);
+    pImpl->dataBitNs.store(nanosecondsPerBit(dataBaudRate ? dataBaudRate : baudRate), std::memory_order_relaxed);
+}
+
+void BusStatistics::setStuffingModel(StuffingModel stuffing) {
+    pImpl->stuffing.store(stuffing, std::memory_order_relaxed);
+}
+
+void BusStatistics::record(const CANMessage& message) {
+    if (message.frameType == CANFrameType::ERROR) {
+        recordErrorFrames(1);
+        return;
+    }
+
+    CANFrameBits bits = canFrameBits(message, pImpl->stuffing.load(std::memory_order_relaxed));
+    uint64_t busy = static_cast<uint64_t>(std::llround(
+        bits.nominalBits * pImpl->nominalBitNs.load(std::memory_order_relaxed) +
+        bits.dataBits * pImpl->dataBitNs.load(std::memory_order_relaxed)));
+    pImpl->frames.fetch_add(1, std::memory_order_relaxed);
+    pImpl->busyNs.fetch_add(busy, std::memory_order_relaxed);
+
+    Impl::Slot* slot = pImpl->claim(idKey(message.id, message.extended));
+    if (!slot) {
+        pImpl->untrackedFrames.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    slot->frames.fetch_add(1, std::memory_order_relaxed);
+    slot->bytes.fetch_add(message.data.size(), std::memory_order_relaxed);
+    slot->busyNs.fetch_add(busy, std::memory_order_relaxed);
+
+    int64_t timestamp = toNanoseconds(message.timestamp);
+    if (timestamp <= 0) {
+        timestamp = toNanoseconds(std::chrono::system_clock::now());
+    }
+    int64_t previous = slot->lastNs.exchange(timestamp, std::memory_order_relaxed);
+    if (previous > 0 && timestamp > previous) {
+        pImpl->updatePeriod(*slot, static_cast<double>(timestamp - previous));
+    }
+}
+
+void BusStatistics::recordErrorFrames(uint64_t count) {
+    pImpl->errorFrames.fetch_add(count, std::memory_order_relaxed);
+    pImpl->busyNs.fetch_add(static_cast<uint64_t>(std::llround(
+        count * ERROR_FRAME_BITS * pImpl->nominalBitNs.load(std::memory_order_relaxed))), std::memory_order_relaxed);
+}
+
+BusLoadSnapshot BusStatistics::snapshot() {
+    std::lock_guard<std::mutex> lock(pImpl->snapshotMutex);
+    auto now = std::chrono::steady_clock::now();
+    uint64_t busy = pImpl->busyNs.load(std::memory_order_relaxed);
+    uint64_t frames = pImpl->frames.load(std::memory_order_relaxed);
+
+    BusLoadSnapshot snapshot;
+    snapshot.frames = frames;
+    snapshot.errorFrames = pImpl->errorFrames.load(std::memory_order_relaxed);
+    snapshot.untrackedFrames = pImpl->untrackedFrames.load(std::memory_order_relaxed);
+    snapshot.interval = std::chrono::duration_cast<std::chrono::milliseconds>(now - pImpl->lastSnapshot);
+
+    double interval = std::chrono::duration<double, std::nano>(now - pImpl->lastSnapshot).count();
+    if (interval > 0) {
+        snapshot.load = 100.0 * (busy - pImpl->lastBusyNs) / interval;
+        snapshot.framesPerSecond = (frames - pImpl->lastFrames) * 1e9 / interval;
+    }
+    double elapsed = std::chrono::duration<double, std::nano>(now - pImpl->resetTime).count();
+    if (elapsed > 0) {
+        snapshot.averageLoad = 100.0 * busy / elapsed;
+    }
+    pImpl->peakLoad = std::max(pImpl->peakLoad, snapshot.load);
+    snapshot.peakLoad = pImpl->peakLoad;
+    snapshot.overloaded = snapshot.load >= pImpl->config.overloadThreshold;
+
+    pImpl->lastSnapshot = now;
+    pImpl->lastBusyNs = busy;
+    pImpl->lastFrames = frames;
+    return snapshot;
+}
+
+std::vector<CANIdStatistics> BusStatistics::getIdStatistics() const {
+    uint64_t totalBusy = pImpl->busyNs.load(std::memory_order_relaxed);
+    std::vector<CANIdStatistics> result;
+    for (uint32_t i = 0; i <= pImpl->mask; ++i) {
+        const Impl::Slot& slot = pImpl->slots[i];
+        if (slot.key.load(std::memory_order_acquire) != 0 && slot.frames.load(std::memory_order_relaxed) != 0) {
+            result.push_back(pImpl->toIdStatistics(slot, totalBusy));
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const CANIdStatistics& a, const CANIdStatistics& b) {
+        return a.extended != b.extended ? !a.extended : a.id < b.id;
+    });
+    return result;
+}
+
+bool BusStatistics::getIdStatistics(uint32_t id, bool extended, CANIdStatistics& statistics) const {
+    const Impl::Slot* slot = pImpl->find(idKey(id, extended));
+    if (!slot || slot->frames.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    statistics = pImpl->toIdStatistics(*slot, pImpl->busyNs.load(std::memory_order_relaxed));
+    return true;
+}
+
+void BusStatistics::reset() {
+    std::lock_guard<std::mutex> lock(pImpl->snapshotMutex);
+    for (uint32_t i = 0; i <= pImpl->mask; ++i) {
+        Impl::Slot& slot = pImpl->slots[i];
+        slot.frames = 0;
+        slot.bytes = 0;
+        slot.busyNs = 0;
+        slot.lastNs = 0;
+        slot.period = 0.0;
+        slot.jitter = 0.0;
+    }
+    pImpl->frames = 0;
+    pImpl->errorFrames = 0;
+    pImpl->untrackedFrames = 0;
+    pImpl->busyNs = 0;
+    pImpl->resetTime = pImpl->lastSnapshot = std::chrono::steady_clock::now();
+    pImpl->lastBusyNs = 0;
+    pImpl->lastFrames = 0;
+    pImpl->peakLoad = 0.0;
+}
+
+std::string BusStatistics::toString() const {
+    size_t ids = 0;
+    for (uint32_t i = 0; i <= pImpl->mask; ++i) {
+        if (pImpl->slots[i].key.load(std::memory_order_relaxed) != 0) {
+            ++ids;
+        }
+    }
+    std::ostringstream ss;
+    ss << "BusStatistics[Frames:" << pImpl->frames.load(std::memory_order_relaxed)
+       << ", ErrorFrames:" << pImpl->errorFrames.load(std::memory_order_relaxed)
+       << ", IDs:" << ids << "/" << pImpl->config.idCapacity << "]";
+    return ss.str();
+}
+
+// Utility functions
+CANFrameBits canFrameBits(const CANMessage& message, StuffingModel stuffing) {
+    CANFrameBits bits;
+    BitStream stream;
+    stream.put(0, 1);                       // SOF
+
+    if (!message.fd) {
+        // Classic frame: everything from SOF through the CRC is stuffed, at one rate
+        const size_t length = message.rtr ? 0 : std::min<size_t>(message.data.size(), 8);
+        putIdentifier(stream, message, message.rtr);
+        stream.put(0, message.extended ? 2 : 1);        // r1 r0 / r0
+        stream.put(static_cast<uint32_t>(message.rtr ? std::min<size_t>(message.data.size(), 8) : length), 4);
+        stream.putBytes(message.data.data(), length);
+        const uint32_t stuffable = (message.extended ? 54 : 34) + 8 * static_cast<uint32_t>(length);
+        if (stuffing == StuffingModel::EXACT) {
+            stream.put(stream.crc15, 15, false);
+            bits.stuffBits = stream.stuffBits;
+        } else if (stuffing == StuffingModel::WORST_CASE) {
+            bits.stuffBits = (stuffable - 1) / 4;
+        }
+        bits.nominalBits = stuffable + bits.stuffBits + FRAME_TRAILER_BITS;
+        return bits;
+    }
+
+    // CAN FD: arbitration through BRS at the nominal rate, ESI through the CRC at the data rate
+    const size_t length = canFdLength(message.data.size());
+    putIdentifier(stream, message, false);
+    stream.put(0b100 | (message.brs ? 1 : 0), 3);       // FDF, res, BRS
+    const uint32_t arbitration = message.extended ? 36 : 17;
+    const uint32_t arbitrationStuff = stream.stuffBits;
+
+    stream.put(message.esi ? 1 : 0, 1);
+    stream.put(canLengthToDlc(length), 4);
+    stream.putBytes(message.data.data(), message.data.size());
+    for (size_t i = message.data.size(); i < length; ++i) {
+        stream.put(0, 8);                   // Padding up to the DLC length
+    }
+
+    // Stuff count with parity, CRC-17/21 and their fixed stuff bits
+    const uint32_t crcBits = length <= 16 ? 17 : 21;
+    const uint32_t crcField = 4 + crcBits + (length <= 16 ? 6 : 7);
+    const uint32_t dataField = 1 + 4 + 8 * static_cast<uint32_t>(length);
+
+    uint32_t nominalStuff = 0;
+    uint32_t dataStuff = 0;
+    if (stuffing == StuffingModel::EXACT) {
+        nominalStuff = arbitrationStuff;
+        dataStuff = stream.stuffBits - arbitrationStuff;
+    } else if (stuffing == StuffingModel::WORST_CASE) {
+        nominalStuff = (arbitration - 1) / 4;
+        dataStuff = (arbitration + dataField - 1) / 4 - nominalStuff;
+    }
+    bits.stuffBits = nominalStuff + dataStuff + (crcField - 4 - crcBits);
+
+    const uint32_t dataPhase = dataField + dataStuff + crcField;
+    bits.nominalBits = arbitration + nominalStuff + FRAME_TRAILER_BITS;
+    if (message.brs) {
+        bits.dataBits = dataPhase;
+    } else {
+        bits.nominalBits += dataPhase;
+    }
+    return bits;
+}
+
+std::string stuffingModelToString(StuffingModel stuffing) {
+    switch (stuffing) {
+        case StuffingModel::NONE: return "None";
+        case StuffingModel::EXACT: return "Exact";
+        case StuffingModel::WORST_CASE: return "WorstCase";
+        default: return "Unknown";
+    }
+}
+
+} // namespace protocols
+} // namespace fmus
@@ -1,4 +1,8 @@
 #include <fmus/protocols/can.h>
+#include <fmus/protocols/socketcan.h>
+#include <fmus/plugins/extension_points.h>
+#include <fmus/live_data_store.h>
+#include <fmus/j2534/library_loader.h>
 #include <fmus/logger.h>
 #include <fmus/utils.h>
 #include <sstream>
@@ -7,10 +11,59 @@
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <condition_variable>
+#include <array>
+#include <unordered_map>
 
 namespace fmus {
 namespace protocols {
 
+namespace {
+
+constexpr size_t CAN_MAX_DATA = 8;
+constexpr size_t CAN_FD_MAX_DATA = 64;
+constexpr size_t CAN_FD_LENGTHS[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+constexpr uint32_t RECEIVE_POLL_MS = 10;
+constexpr size_t TRANSPORT_BATCH = 32;         // Frames moved per plugin backend call
+constexpr size_t MAX_DECODED_VALUES = 32;      // Values accepted from one frame
+
+plugins::TransportFrame toTransportFrame(const CANMessage& message) {
+    plugins::TransportFrame frame;
+    frame.id = message.id;
+    frame.length = static_cast<uint8_t>(std::min(message.data.size(), frame.data.size()));
+    std::copy_n(message.data.begin(), frame.length, frame.data.begin());
+    frame.flags = (message.extended ? plugins::TRANSPORT_FRAME_EXTENDED : 0) |
+                  (message.fd ? plugins::TRANSPORT_FRAME_FD : 0) |
+                  (message.rtr ? plugins::TRANSPORT_FRAME_RTR : 0);
+    return frame;
+}
+
+CANMessage fromTransportFrame(const plugins::TransportFrame& frame) {
+    CANMessage message;
+    message.id = frame.id;
+    message.data.assign(frame.data.begin(), frame.data.begin() + std::min<size_t>(frame.length, frame.data.size()));
+    message.extended = (frame.flags & plugins::TRANSPORT_FRAME_EXTENDED) != 0;
+    message.fd = (frame.flags & plugins::TRANSPORT_FRAME_FD) != 0;
+    message.rtr = (frame.flags & plugins::TRANSPORT_FRAME_RTR) != 0;
+    if (frame.flags & plugins::TRANSPORT_FRAME_ERROR) {
+        message.frameType = CANFrameType::ERROR;
+    }
+    message.timestamp = std::chrono::system_clock::now();
+    return message;
+}
+
+std::map<std::string, std::string> transportOptions(const CANConfig& config) {
+    return {
+        {"bitrate", std::to_string(config.baudRate)},
+        {"fd", config.fd ? "true" : "false"},
+        {"dataBitrate", std::to_string(config.dataBaudRate)},
+        {"listenOnly", config.listenOnly ? "true" : "false"},
+        {"loopback", config.loopback ? "true" : "false"}
+    };
+}
+
+} // anonymous namespace
+
 // CANMessage implementation
 bool CANMessage::isValid() const {
     // Check ID range
@@ -20,8 +73,12 @@ bool CANMessage::isValid() const {
         if (id > 0x7FF) return false; // 11-bit max
     }
     
-    // Check data length (CAN 2.0 allows 0-8 bytes)
-    if (data.size() > 8) return false;
+    // Check data length (CAN 2.0 allows 0-8 bytes, CAN FD the DLC sizes up to 64)
+    if (fd) {
+        if (rtr || data.size() > CAN_FD_MAX_DATA || canFdLength(data.size()) != data.size()) return false;
+    } else {
+        if (brs || data.size() > CAN_MAX_DATA) return false;
+    }
     
     return true;
 }
@@ -36,6 +93,10 @@ std::string CANMessage::toString() const {
         ss << "STD:0x" << std::hex << std::setw(3) << std::setfill('0') << id;
     }
     
+    if (fd) {
+        ss << (brs ? " FD-BRS" : " FD");
+    }
+    
     if (rtr) {
         ss << " RTR";
     } else {
@@ -54,13 +115,20 @@ j2534::Message CANMessage::toJ2534Message() const {
     msg.flags = 0;
     
     if (extended) {
-        msg.flags |= 0x04; // CAN_29BIT_ID flag
+        msg.flags |= j2534::J2534Constants::CAN_29BIT_ID;
     }
     
     if (rtr) {
         msg.flags |= 0x02; // RTR flag
     }
     
+    if (fd) {
+        msg.flags |= j2534::J2534Constants::CAN_FD_FORMAT;
+        if (brs) {
+            msg.flags |= j2534::J2534Constants::CAN_FD_BRS;
+        }
+    }
+    
     return msg;
 }
 
@@ -68,8 +136,11 @@ CANMessage CANMessage::fromJ2534Message(const j2534::Message& msg) {
     CANMessage canMsg;
     canMsg.id = msg.id;
     canMsg.data = msg.data;
-    canMsg.extended = (msg.flags & 0x04) != 0;
+    canMsg.extended = (msg.flags & j2534::J2534Constants::CAN_29BIT_ID) != 0;
     canMsg.rtr = (msg.flags & 0x02) != 0;
+    canMsg.fd = (msg.flags & j2534::J2534Constants::CAN_FD_FORMAT) != 0;
+    canMsg.brs = (msg.flags & j2534::J2534Constants::CAN_FD_BRS) != 0;
+    canMsg.esi = (msg.flags & j2534::J2534Constants::CAN_FD_ESI) != 0;
     canMsg.timestamp = std::chrono::system_clock::now();
     
     return canMsg;
@@ -78,10 +149,19 @@ CANMessage CANMessage::fromJ2534Message(const j2534::Message& msg) {
 // CANConfig implementation
 std::string CANConfig::toString() const {
     std::ostringstream ss;
-    ss << "CANConfig[BaudRate:" << baudRate
-       << ", ListenOnly:" << (listenOnly ? "Yes" : "No")
+    ss << "CANConfig[BaudRate:" << baudRate;
+    if (fd) {
+        ss << ", FD DataRate:" << dataBaudRate;
+    }
+    ss << ", ListenOnly:" << (listenOnly ? "Yes" : "No")
        << ", Loopback:" << (loopback ? "Yes" : "No")
-       << ", ExtendedFrames:" << (extendedFrames ? "Yes" : "No")
+       << ", ExtendedFrames:" << (extendedFrames ? "Yes" : "No");
+    if (backend == j2534::Backend::SOCKETCAN) {
+        ss << ", SocketCAN:" << interfaceName;
+    } else if (backend == j2534::Backend::PLUGIN) {
+        ss << ", Plugin:" << interfaceName;
+    }
+    ss
        << ", TxTimeout:" << txTimeout << "ms"
        << ", RxTimeout:" << rxTimeout << "ms]";
     return ss.str();
@@ -134,29 +214,225 @@ std::string CANFilter::toString() const {
 // CANProtocol implementation
 class CANProtocol::Impl {
 public:
+    using Listener = std::function<void(const CANMessage&)>;
+    
+    /**
+     * One listener and the dispatches currently inside it
+     */
+    struct ListenerSlot {
+        explicit ListenerSlot(Listener callback) : callback(std::move(callback)) {}
+        
+        const Listener callback;
+        std::atomic<uint32_t> active{0};
+        std::atomic<bool> removed{false};
+    };
+    
+    using ListenerList = std::vector<std::pair<uint32_t, std::shared_ptr<ListenerSlot>>>;
+    
+    // Dispatches in progress on this thread, across all instances
+    static thread_local uint32_t dispatchDepth;
+    
     CANConfig config;
     std::vector<CANFilter> filters;
-    Statistics stats;
+    BusStatistics busStatistics;
     std::atomic<bool> initialized{false};
     std::atomic<bool> monitoring{false};
-    std::function<void(const CANMessage&)> monitorCallback;
+    std::atomic<bool> receiving{false};
     std::thread monitorThread;
     mutable std::mutex filtersMutex;
+    
+    // Counted without locks on the dispatch path
+    std::atomic<uint64_t> messagesSent{0};
+    std::atomic<uint64_t> messagesReceived{0};
+    std::atomic<uint64_t> errorsDetected{0};
+    std::atomic<uint64_t> filtersApplied{0};
     mutable std::mutex statsMutex;
+    std::chrono::system_clock::time_point startTime;
+    
+    // Copy-on-write so dispatch takes the lock only to grab the current list
+    std::mutex listenersMutex;
+    std::mutex receiverMutex;
+    std::shared_ptr<const ListenerList> listeners = std::make_shared<ListenerList>();
+    uint32_t nextListenerId = 1;
+    std::mutex quiescentMutex;
+    std::condition_variable quiescent;
+    
+    // Set for the SocketCAN or plugin backend; otherwise frames are simulated
+    std::unique_ptr<SocketCANChannel> socket;
+    std::shared_ptr<plugins::ITransportBackend> transport;
+    
+    // Plugin frame decoder output; channels are cached by value name
+    std::atomic<bool> decoding{false};
+    std::mutex decodedMutex;
+    std::shared_ptr<LiveDataStore> decodedStore;
+    std::unordered_map<std::string, LiveDataStore::ChannelId> decodedChannels;
+    
+    static constexpr uint32_t MONITOR_LISTENER_ID = 0;
     
     Impl() {
-        stats.startTime = std::chrono::system_clock::now();
+        startTime = std::chrono::system_clock::now();
     }
     
     ~Impl() {
-        if (monitoring) {
-            stopMonitoring();
+        stopReceiver();
+    }
+    
+    uint32_t addListener(Listener listener, uint32_t id) {
+        std::lock_guard<std::mutex> lock(listenersMutex);
+        auto updated = std::make_shared<ListenerList>(*listeners);
+        updated->emplace_back(id, std::make_shared<ListenerSlot>(std::move(listener)));
+        listeners = std::move(updated);
+        return id;
+    }
+    
+    /**
+     * Remove a listener and wait for dispatches already inside it to return,
+     * unless this thread is itself dispatching and would wait for itself.
+     */
+    bool removeListener(uint32_t id) {
+        std::shared_ptr<ListenerSlot> slot;
+        bool empty;
+        {
+            std::lock_guard<std::mutex> lock(listenersMutex);
+            auto updated = std::make_shared<ListenerList>();
+            for (const auto& entry : *listeners) {
+                if (entry.first == id) {
+                    slot = entry.second;
+                } else {
+                    updated->push_back(entry);
+                }
+            }
+            listeners = std::move(updated);
+            empty = listeners->empty();
+        }
+        
+        if (slot) {
+            // Snapshots taken before the swap skip the slot from here on
+            slot->removed = true;
+            if (dispatchDepth == 0) {
+                std::unique_lock<std::mutex> lock(quiescentMutex);
+                quiescent.wait(lock, [&slot] { return slot->active == 0; });
+            }
+        }
+        return empty;
+    }
+    
+    void invoke(ListenerSlot& slot, const CANMessage& message) {
+        // Paired with removeListener: either it sees us active or we see it removed
+        slot.active.fetch_add(1);
+        if (!slot.removed) {
+            ++dispatchDepth;
+            try {
+                slot.callback(message);
+            } catch (...) {
+                --dispatchDepth;
+                leave(slot);
+                throw;
+            }
+            --dispatchDepth;
         }
+        leave(slot);
     }
     
-    void stopMonitoring() {
-        monitoring = false;
+    void leave(ListenerSlot& slot) {
+        if (slot.active.fetch_sub(1) == 1 && slot.removed) {
+            std::lock_guard<std::mutex> lock(quiescentMutex);
+            quiescent.notify_all();
+        }
+    }
+    
+    bool passesFilters(const CANMessage& message) {
+        std::lock_guard<std::mutex> lock(filtersMutex);
+        if (filters.empty()) {
+            return true;
+        }
+        for (const auto& filter : filters) {
+            if (filter.matches(message)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    void applyKernelFilters() {
+        if (socket) {
+            socket->setFilters(filters);
+        }
+    }
+    
+    void dispatch(const CANMessage& message) {
+        busStatistics.record(message);
+        if (!passesFilters(message)) {
+            return;
+        }
+        
+        std::shared_ptr<const ListenerList> current;
+        {
+            std::lock_guard<std::mutex> lock(listenersMutex);
+            current = listeners;
+        }
+        
+        messagesReceived.fetch_add(1, std::memory_order_relaxed);
+        filtersApplied.fetch_add(1, std::memory_order_relaxed);
+        
+        if (decoding.load(std::memory_order_relaxed)) {
+            publishDecoded(message);
+        }
+        
+        for (const auto& entry : *current) {
+            invoke(*entry.second, message);
+        }
+    }
+    
+    void publishDecoded(const CANMessage& message) {
+        // The snapshot keeps decoder libraries loaded until the values are copied out
+        auto tables = plugins::getGlobalExtensionRegistry()->getTables();
+        std::array<plugins::DecodedValue, MAX_DECODED_VALUES> values;
+        size_t count = tables->decodeFrame(message.id, message.data.data(), message.data.size(),
+                                           values.data(), values.size());
+        if (count == 0) {
+            return;
+        }
+        
+        std::lock_guard<std::mutex> lock(decodedMutex);
+        if (!decodedStore) {
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (!values[i].name) {
+                continue;
+            }
+            auto it = decodedChannels.find(values[i].name);
+            if (it == decodedChannels.end()) {
+                auto channel = decodedStore->addChannel(values[i].name, values[i].unit ? values[i].unit : "");
+                it = decodedChannels.emplace(values[i].name, channel).first;
+            }
+            if (it->second != LiveDataStore::INVALID_CHANNEL) {
+                decodedStore->publish(it->second, values[i].value);
+            }
+        }
+    }
+    
+    void startReceiver() {
+        std::lock_guard<std::mutex> lock(receiverMutex);
+        if (receiving) {
+            return;
+        }
+        receiving = true;
         if (monitorThread.joinable()) {
+            if (monitorThread.get_id() == std::this_thread::get_id()) {
+                return;     // Still inside the loop, which keeps running
+            }
+            monitorThread.join();
+        }
+        monitorThread = std::thread(&CANProtocol::Impl::monitoringLoop, this);
+    }
+    
+    void stopReceiver() {
+        std::lock_guard<std::mutex> lock(receiverMutex);
+        receiving = false;
+        // A listener removing itself from the receive thread leaves the join to shutdown
+        if (monitorThread.joinable() && monitorThread.get_id() != std::this_thread::get_id()) {
             monitorThread.join();
         }
     }
@@ -165,39 +441,46 @@ public:
         auto logger = Logger::getInstance();
         logger->debug("CAN monitoring thread started");
         
-        while (monitoring) {
+        std::vector<CANMessage> batch;
+        std::vector<plugins::TransportFrame> frames(transport ? TRANSPORT_BATCH : 0);
+        uint64_t errorFrames = socket ? socket->getErrorFrameCount() : 0;
+        while (receiving) {
             try {
+                if (transport) {
+                    size_t count = transport->read(frames.data(), frames.size(),
+                                                   std::chrono::milliseconds(RECEIVE_POLL_MS));
+                    for (size_t i = 0; i < count; ++i) {
+                        dispatch(fromTransportFrame(frames[i]));
+                    }
+                    continue;
+                }
+                
+                if (socket) {
+                    batch.clear();
+                    socket->receive(batch, RECEIVE_POLL_MS);
+                    for (const auto& message : batch) {
+                        dispatch(message);
+                    }
+                    uint64_t reported = socket->getErrorFrameCount();
+                    if (reported != errorFrames) {
+                        busStatistics.recordErrorFrames(reported - errorFrames);
+                        errorFrames = reported;
+                    }
+                    continue;
+                }
+                
                 // In a real implementation, this would read from the J2534 device
                 // For now, we'll just sleep to simulate monitoring
                 std::this_thread::sleep_for(std::chrono::milliseconds(10));
                 
                 // Simulate receiving a message occasionally
-                if (monitorCallback && (rand() % 1000) == 0) {
-                    CANMessage msg(0x7E8, {0x06, 0x41, 0x00, 0xBE, 0x3F, 0xB8, 0x13});
-                    
-                    // Apply filters
-                    bool passFilter = filters.empty(); // Pass if no filters
-                    for (const auto& filter : filters) {
-                        if (filter.matches(msg)) {
-                            passFilter = true;
-                            break;
-                        }
-                    }
-                    
-                    if (passFilter) {
-                        {
-                            std::lock_guard<std::mutex> lock(statsMutex);
-                            stats.messagesReceived++;
-                            stats.filtersApplied++;
-                        }
-                        monitorCallback(msg);
-                    }
+                if (monitoring && (rand() % 1000) == 0) {
+                    dispatch(CANMessage(0x7E8, {0x06, 0x41, 0x00, 0xBE, 0x3F, 0xB8, 0x13}));
                 }
                 
             } catch (const std::exception& e) {
                 logger->error("CAN monitoring error: " + std::string(e.what()));
-                std::lock_guard<std::mutex> lock(statsMutex);
-                stats.errorsDetected++;
+                errorsDetected.fetch_add(1, std::memory_order_relaxed);
             }
         }
         
@@ -205,6 +488,8 @@ public:
     }
 };
 
+thread_local uint32_t CANProtocol::Impl::dispatchDepth = 0;
+
 CANProtocol::CANProtocol() : pImpl(std::make_unique<Impl>()) {}
 
 CANProtocol::~CANProtocol() = default;
@@ -218,7 +503,34 @@ bool CANProtocol::initialize(const CANConfig& config) {
         return false;
     }
     
+    if (config.fd && (!isValidCANFDDataRate(config.dataBaudRate) || config.dataBaudRate < config.baudRate)) {
+        logger->error("Invalid CAN FD data rate: " + std::to_string(config.dataBaudRate));
+        return false;
+    }
+    
+    if (config.backend == j2534::Backend::SOCKETCAN) {
+        auto socket = std::make_unique<SocketCANChannel>();
+        if (!socket->open(config)) {
+            return false;
+        }
+        pImpl->socket = std::move(socket);
+        std::lock_guard<std::mutex> lock(pImpl->filtersMutex);
+        pImpl->applyKernelFilters();
+    } else if (config.backend == j2534::Backend::PLUGIN) {
+        auto transport = plugins::getGlobalExtensionRegistry()->createTransportBackend(config.interfaceName);
+        if (!transport) {
+            logger->error("No transport backend registered as '" + config.interfaceName + "'");
+            return false;
+        }
+        if (!transport->open(transportOptions(config))) {
+            logger->error("Failed to open transport backend '" + config.interfaceName + "'");
+            return false;
+        }
+        pImpl->transport = std::move(transport);
+    }
+    
     pImpl->config = config;
+    pImpl->busStatistics.setBitRates(config.baudRate, config.fd ? config.dataBaudRate : config.baudRate);
     pImpl->initialized = true;
     
     logger->info("CAN protocol initialized successfully");
@@ -229,6 +541,12 @@ void CANProtocol::shutdown() {
     if (pImpl->monitoring) {
         stopMonitoring();
     }
+    pImpl->stopReceiver();
+    pImpl->socket.reset();
+    if (pImpl->transport) {
+        pImpl->transport->close();
+        pImpl->transport.reset();
+    }
     
     pImpl->initialized = false;
     
@@ -251,21 +569,88 @@ bool CANProtocol::sendMessage(const CANMessage& message) {
         return false;
     }
     
+    if (message.fd && !pImpl->config.fd) {
+        Logger::getInstance()->error("CAN FD frame on a classic CAN bus: " + message.toString());
+        return false;
+    }
+    
     auto logger = Logger::getInstance();
     logger->debug("Sending CAN message: " + message.toString());
     
-    // In a real implementation, this would send via J2534
-    // For now, just simulate success
+    if (pImpl->socket && pImpl->socket->send(&message, 1) != 1) {
+        pImpl->errorsDetected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
     
-    {
-        std::lock_guard<std::mutex> lock(pImpl->statsMutex);
-        pImpl->stats.messagesSent++;
+    if (pImpl->transport) {
+        auto frame = toTransportFrame(message);
+        if (pImpl->transport->write(&frame, 1) != 1) {
+            pImpl->errorsDetected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+    
+    // Without a socket, this would send via J2534; for now, just simulate success
+    
+    pImpl->messagesSent.fetch_add(1, std::memory_order_relaxed);
+    if (!pImpl->config.loopback) {
+        pImpl->busStatistics.record(message);   // Looped-back frames are counted on dispatch
+    }
+    
+    // The kernel echoes SocketCAN frames itself (CAN_RAW_RECV_OWN_MSGS); plugin backends get the loopback option
+    if (pImpl->config.loopback && !pImpl->socket && !pImpl->transport) {
+        CANMessage echo = message;
+        echo.timestamp = std::chrono::system_clock::now();
+        pImpl->dispatch(echo);
     }
     
     return true;
 }
 
 bool CANProtocol::sendMessages(const std::vector<CANMessage>& messages) {
+    if (pImpl->initialized && pImpl->transport) {
+        std::vector<plugins::TransportFrame> frames;
+        frames.reserve(messages.size());
+        for (const auto& msg : messages) {
+            if (!msg.isValid() || (msg.fd && !pImpl->config.fd)) {
+                Logger::getInstance()->error("Invalid CAN message: " + msg.toString());
+                return false;
+            }
+            frames.push_back(toTransportFrame(msg));
+        }
+        
+        // One backend call for the whole set
+        size_t sent = std::min(pImpl->transport->write(frames.data(), frames.size()), frames.size());
+        pImpl->messagesSent.fetch_add(sent, std::memory_order_relaxed);
+        pImpl->errorsDetected.fetch_add(messages.size() - sent, std::memory_order_relaxed);
+        if (!pImpl->config.loopback) {
+            for (size_t i = 0; i < sent; ++i) {
+                pImpl->busStatistics.record(messages[i]);
+            }
+        }
+        return sent == messages.size();
+    }
+    
+    if (pImpl->initialized && pImpl->socket) {
+        for (const auto& msg : messages) {
+            if (!msg.isValid() || (msg.fd && !pImpl->config.fd)) {
+                Logger::getInstance()->error("Invalid CAN message: " + msg.toString());
+                return false;
+            }
+        }
+        
+        // One batch of sendmmsg calls for the whole set
+        size_t sent = pImpl->socket->send(messages.data(), messages.size());
+        pImpl->messagesSent.fetch_add(sent, std::memory_order_relaxed);
+        pImpl->errorsDetected.fetch_add(messages.size() - sent, std::memory_order_relaxed);
+        if (!pImpl->config.loopback) {
+            for (size_t i = 0; i < sent; ++i) {
+                pImpl->busStatistics.record(messages[i]);
+            }
+        }
+        return sent == messages.size();
+    }
+    
     bool allSuccess = true;
     
     for (const auto& msg : messages) {
@@ -284,6 +669,34 @@ std::vector<CANMessage> CANProtocol::receiveMessages(uint32_t timeout) {
         return messages;
     }
     
+    // The receive thread owns the socket while listeners are attached
+    if (pImpl->transport && !pImpl->receiving) {
+        std::vector<plugins::TransportFrame> frames(TRANSPORT_BATCH);
+        size_t count = pImpl->transport->read(frames.data(), frames.size(), std::chrono::milliseconds(timeout));
+        for (size_t i = 0; i < count; ++i) {
+            CANMessage message = fromTransportFrame(frames[i]);
+            pImpl->busStatistics.record(message);
+            if (pImpl->passesFilters(message)) {
+                messages.push_back(std::move(message));
+            }
+        }
+        pImpl->messagesReceived.fetch_add(messages.size(), std::memory_order_relaxed);
+        return messages;
+    }
+    
+    if (pImpl->socket && !pImpl->receiving) {
+        std::vector<CANMessage> batch;
+        pImpl->socket->receive(batch, timeout);
+        for (auto& message : batch) {
+            pImpl->busStatistics.record(message);
+            if (pImpl->passesFilters(message)) {
+                messages.push_back(std::move(message));
+            }
+        }
+        pImpl->messagesReceived.fetch_add(messages.size(), std::memory_order_relaxed);
+        return messages;
+    }
+    
     // In a real implementation, this would receive from J2534
     // For now, return empty vector
     
@@ -297,6 +710,7 @@ bool CANProtocol::addFilter(const CANFilter& filter) {
     logger->debug("Adding CAN filter: " + filter.toString());
     
     pImpl->filters.push_back(filter);
+    pImpl->applyKernelFilters();
     return true;
 }
 
@@ -310,6 +724,7 @@ bool CANProtocol::removeFilter(const CANFilter& filter) {
     
     if (it != pImpl->filters.end()) {
         pImpl->filters.erase(it);
+        pImpl->applyKernelFilters();
         return true;
     }
     
@@ -319,6 +734,7 @@ bool CANProtocol::removeFilter(const CANFilter& filter) {
 void CANProtocol::clearFilters() {
     std::lock_guard<std::mutex> lock(pImpl->filtersMutex);
     pImpl->filters.clear();
+    pImpl->applyKernelFilters();
 }
 
 std::vector<CANFilter> CANProtocol::getFilters() const {
@@ -331,30 +747,92 @@ bool CANProtocol::startMonitoring(std::function<void(const CANMessage&)> callbac
         return false;
     }
     
-    pImpl->monitorCallback = callback;
+    pImpl->addListener(std::move(callback), Impl::MONITOR_LISTENER_ID);
     pImpl->monitoring = true;
-    pImpl->monitorThread = std::thread(&CANProtocol::Impl::monitoringLoop, pImpl.get());
+    pImpl->startReceiver();
     
     return true;
 }
 
 void CANProtocol::stopMonitoring() {
-    pImpl->stopMonitoring();
+    if (!pImpl->monitoring.exchange(false)) {
+        return;
+    }
+    if (pImpl->removeListener(Impl::MONITOR_LISTENER_ID)) {
+        pImpl->stopReceiver();
+    }
 }
 
 bool CANProtocol::isMonitoring() const {
     return pImpl->monitoring;
 }
 
+uint32_t CANProtocol::addListener(std::function<void(const CANMessage&)> listener) {
+    if (!pImpl->initialized || !listener) {
+        return 0;
+    }
+    
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->listenersMutex);
+        id = pImpl->nextListenerId++;
+    }
+    pImpl->addListener(std::move(listener), id);
+    pImpl->startReceiver();
+    return id;
+}
+
+void CANProtocol::removeListener(uint32_t listenerId) {
+    if (listenerId == Impl::MONITOR_LISTENER_ID) {
+        return;
+    }
+    if (pImpl->removeListener(listenerId) && !pImpl->monitoring) {
+        pImpl->stopReceiver();
+    }
+}
+
+bool CANProtocol::injectMessage(const CANMessage& message) {
+    if (!pImpl->initialized) {
+        return false;
+    }
+    pImpl->dispatch(message);
+    return true;
+}
+
+void CANProtocol::publishDecodedValuesTo(std::shared_ptr<LiveDataStore> store) {
+    std::lock_guard<std::mutex> lock(pImpl->decodedMutex);
+    pImpl->decodedStore = std::move(store);
+    pImpl->decodedChannels.clear();
+    pImpl->decoding.store(pImpl->decodedStore != nullptr, std::memory_order_relaxed);
+}
+
 CANProtocol::Statistics CANProtocol::getStatistics() const {
+    Statistics stats;
+    stats.messagesSent = pImpl->messagesSent;
+    stats.messagesReceived = pImpl->messagesReceived;
+    stats.errorsDetected = pImpl->errorsDetected;
+    stats.filtersApplied = pImpl->filtersApplied;
     std::lock_guard<std::mutex> lock(pImpl->statsMutex);
-    return pImpl->stats;
+    stats.startTime = pImpl->startTime;
+    return stats;
 }
 
 void CANProtocol::resetStatistics() {
+    pImpl->messagesSent = 0;
+    pImpl->messagesReceived = 0;
+    pImpl->errorsDetected = 0;
+    pImpl->filtersApplied = 0;
+    pImpl->busStatistics.reset();
     std::lock_guard<std::mutex> lock(pImpl->statsMutex);
-    pImpl->stats = Statistics{};
-    pImpl->stats.startTime = std::chrono::system_clock::now();
+    pImpl->startTime = std::chrono::system_clock::now();
+}
+
+BusLoadSnapshot CANProtocol::getBusLoad() {
+    return pImpl->busStatistics.snapshot();
+}
+
+std::vector<CANIdStatistics> CANProtocol::getIdStatistics() const {
+    return pImpl->busStatistics.getIdStatistics();
 }
 
 CANConfig CANProtocol::getConfiguration() const {
@@ -403,6 +881,41 @@ std::vector<uint32_t> getStandardCANBaudRates() {
     };
 }
 
+bool isValidCANFDDataRate(uint32_t baudRate) {
+    static const uint32_t rates[] = {500000, 1000000, 2000000, 4000000, 5000000, 8000000};
+    return std::find(std::begin(rates), std::end(rates), baudRate) != std::end(rates);
+}
+
+size_t canDlcToLength(uint8_t dlc) {
+    return CAN_FD_LENGTHS[dlc & 0x0F];
+}
+
+uint8_t canLengthToDlc(size_t length) {
+    for (uint8_t dlc = 0; dlc < 15; ++dlc) {
+        if (CAN_FD_LENGTHS[dlc] >= length) {
+            return dlc;
+        }
+    }
+    return 15;
+}
+
+size_t canFdLength(size_t length) {
+    return canDlcToLength(canLengthToDlc(length));
+}
+
+CANConfig canConfigFromOptions(const j2534::ConnectionOptions& options) {
+    CANConfig config;
+    if (options.baudRate != j2534::BaudRate::AUTO) {
+        config.baudRate = static_cast<uint32_t>(options.baudRate);
+    }
+    config.fd = (options.flags & j2534::J2534Constants::CAN_FD_FORMAT) != 0;
+    config.backend = options.backend;
+    if (!options.interfaceName.empty()) {
+        config.interfaceName = options.interfaceName;
+    }
+    return config;
+}
+
 std::string canIdToString(uint32_t id, bool extended) {
     std::ostringstream ss;
     ss << "0x" << std::hex << std::uppercase;
@@ -0,0 +1,883 @@
+#include <fmus/protocols/dbc.h>
+#include <fmus/logger.h>
+#include <fmus/utils.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace fmus {
+namespace protocols {
+
+namespace {
+
+constexpr size_t MAX_FRAME_BYTES = 64;
+constexpr size_t DECODE_BUFFER = MAX_FRAME_BYTES + 16;     // Room for a 9-byte window at the last byte
+constexpr uint32_t DBC_EXTENDED_FLAG = 0x80000000;
+constexpr uint32_t CAN_EXTENDED_MASK = 0x1FFFFFFF;
+constexpr const char* INDEPENDENT_SIGNALS = "VECTOR__INDEPENDENT_SIG_MSG";
+
+uint64_t messageKey(uint32_t id, bool extended) {
+    return static_cast<uint64_t>(id) | (extended ? (1ULL << 32) : 0);
+}
+
+uint64_t byteSwap64(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64(value);
+#else
+    value = ((value & 0x00000000FFFFFFFFULL) << 32) | (value >> 32);
+    value = ((value & 0x0000FFFF0000FFFFULL) << 16) | ((value >> 16) & 0x0000FFFF0000FFFFULL);
+    value = ((value & 0x00FF00FF00FF00FFULL) << 8) | ((value >> 8) & 0x00FF00FF00FF00FFULL);
+    return value;
+#endif
+}
+
+uint64_t loadLittle64(const uint8_t* bytes) {
+    uint64_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = byteSwap64(value);
+#endif
+    return value;
+}
+
+uint64_t loadBig64(const uint8_t* bytes) {
+    uint64_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__
+    value = byteSwap64(value);
+#endif
+    return value;
+}
+
+/**
+ * Minimal scanner over one DBC statement
+ */
+class Scanner {
+public:
+    explicit Scanner(const std::string& text) : p(text.c_str()), end(text.c_str() + text.size()) {}
+
+    void skipSpace() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+            ++p;
+        }
+    }
+
+    bool atEnd() {
+        skipSpace();
+        return p >= end;
+    }
+
+    bool peek(char c) {
+        skipSpace();
+        return p < end && *p == c;
+    }
+
+    bool expect(char c) {
+        if (!peek(c)) {
+            return false;
+        }
+        ++p;
+        return true;
+    }
+
+    /**
+     * Identifier or bare word, stopping at whitespace and the given delimiters
+     */
+    std::string word(const char* delimiters = ":;,") {
+        skipSpace();
+        const char* start = p;
+        while (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n' && !std::strchr(delimiters, *p)) {
+            ++p;
+        }
+        return std::string(start, p);
+    }
+
+    bool number(double& value) {
+        skipSpace();
+        char* stop = nullptr;
+        value = std::strtod(p, &stop);
+        if (stop == p) {
+            return false;
+        }
+        p = stop;
+        return true;
+    }
+
+    bool integer(uint64_t& value) {
+        skipSpace();
+        char* stop = nullptr;
+        value = std::strtoull(p, &stop, 10);
+        if (stop == p) {
+            return false;
+        }
+        p = stop;
+        return true;
+    }
+
+    bool signedInteger(int64_t& value) {
+        skipSpace();
+        char* stop = nullptr;
+        value = std::strtoll(p, &stop, 10);
+        if (stop == p) {
+            return false;
+        }
+        p = stop;
+        return true;
+    }
+
+    bool quoted(std::string& value) {
+        if (!expect('"')) {
+            return false;
+        }
+        const char* start = p;
+        while (p < end && *p != '"') {
+            ++p;
+        }
+        if (p >= end) {
+            return false;
+        }
+        value.assign(start, p);
+        ++p;
+        return true;
+    }
+
+    /**
+     * Single character, e.g. the endianness and sign flags after '@'
+     */
+    bool character(char& c) {
+        if (p >= end) {
+            return false;
+        }
+        c = *p++;
+        return true;
+    }
+
+private:
+    const char* p;
+    const char* end;
+};
+
+bool parseMessage(const std::string& line, DBCMessage& message, uint32_t& rawId) {
+    Scanner scanner(line);
+    uint64_t id = 0;
+    uint64_t length = 0;
+    if (scanner.word() != "BO_" || !scanner.integer(id)) {
+        return false;
+    }
+    message.name = scanner.word();
+    if (message.name.empty() || !scanner.expect(':') || !scanner.integer(length) || length > MAX_FRAME_BYTES) {
+        return false;
+    }
+    rawId = static_cast<uint32_t>(id);
+    message.extended = (rawId & DBC_EXTENDED_FLAG) != 0;
+    message.id = rawId & (message.extended ? CAN_EXTENDED_MASK : ~DBC_EXTENDED_FLAG);
+    message.length = static_cast<uint8_t>(length);
+    message.transmitter = scanner.word();
+    return true;
+}
+
+bool parseSignal(const std::string& line, DBCSignal& signal) {
+    Scanner scanner(line);
+    if (scanner.word() != "SG_") {
+        return false;
+    }
+    signal.name = scanner.word();
+    if (signal.name.empty()) {
+        return false;
+    }
+
+    if (!scanner.peek(':')) {
+        std::string mux = scanner.word();
+        if (mux == "M") {
+            signal.multiplex = DBCSignal::Multiplex::MULTIPLEXOR;
+        } else if (mux.size() > 1 && mux[0] == 'm') {
+            // "m<n>M" (extended multiplexing) is decoded against the top-level multiplexor
+            signal.multiplex = DBCSignal::Multiplex::MULTIPLEXED;
+            signal.muxValue = static_cast<uint32_t>(std::strtoul(mux.c_str() + 1, nullptr, 10));
+        } else {
+            return false;
+        }
+    }
+
+    uint64_t startBit = 0;
+    uint64_t bitLength = 0;
+    char order = 0;
+    char sign = 0;
+    if (!scanner.expect(':') || !scanner.integer(startBit) || !scanner.expect('|') ||
+        !scanner.integer(bitLength) || !scanner.expect('@') || !scanner.character(order) ||
+        !scanner.character(sign) || (order != '0' && order != '1') || (sign != '+' && sign != '-')) {
+        return false;
+    }
+    if (!scanner.expect('(') || !scanner.number(signal.factor) || !scanner.expect(',') ||
+        !scanner.number(signal.offset) || !scanner.expect(')') || !scanner.expect('[') ||
+        !scanner.number(signal.minimum) || !scanner.expect('|') || !scanner.number(signal.maximum) ||
+        !scanner.expect(']') || !scanner.quoted(signal.unit)) {
+        return false;
+    }
+    if (bitLength == 0 || bitLength > 64 || startBit >= MAX_FRAME_BYTES * 8) {
+        return false;
+    }
+    signal.startBit = static_cast<uint16_t>(startBit);
+    signal.bitLength = static_cast<uint8_t>(bitLength);
+    signal.littleEndian = order == '1';
+    signal.isSigned = sign == '-';
+    return true;
+}
+
+size_t countQuotes(const std::string& text) {
+    return static_cast<size_t>(std::count(text.begin(), text.end(), '"'));
+}
+
+} // anonymous namespace
+
+std::string DBCSignal::toString() const {
+    std::ostringstream ss;
+    ss << "DBCSignal[" << name
+       << ", Bits:" << startBit << "|" << static_cast<int>(bitLength) << (littleEndian ? "@1" : "@0") << (isSigned ? "-" : "+")
+       << ", Scale:" << factor << "," << offset;
+    if (!unit.empty()) {
+        ss << ", Unit:" << unit;
+    }
+    if (multiplex == Multiplex::MULTIPLEXOR) {
+        ss << ", Multiplexor";
+    } else if (multiplex == Multiplex::MULTIPLEXED) {
+        ss << ", Mux:" << muxValue;
+    }
+    ss << "]";
+    return ss.str();
+}
+
+std::string DBCMessage::toString() const {
+    std::ostringstream ss;
+    ss << "DBCMessage[" << name << ", ID:" << canIdToString(id, extended)
+       << ", DLC:" << static_cast<int>(length)
+       << ", Signals:" << signals.size() << "]";
+    return ss.str();
+}
+
+// DBCDatabase implementation
+class DBCDatabase::Impl {
+public:
+    /**
+     * One signal compiled to an unchecked window load, shift and mask
+     */
+    struct Extractor {
+        uint32_t signal = 0;
+        uint16_t byteOffset = 0;        // First byte of the 8-byte window
+        uint16_t byteEnd = 0;           // Frame bytes the signal needs
+        uint8_t shift = 0;              // Right shift of the window word
+        uint8_t spill = 0;              // Bits taken from the 9th byte, 0 for most signals
+        uint8_t signShift = 0;          // 64 - bitLength for signed signals, else 0
+        bool bigEndian = false;
+        uint64_t mask = 0;
+    };
+
+    /**
+     * Extractors of a message: plain signals, then one run per multiplexor value
+     */
+    struct Compiled {
+        std::vector<Extractor> extractors;
+        std::vector<double> factors;    // Parallel to extractors, for the scaling pass
+        std::vector<double> offsets;
+        std::vector<uint16_t> byteEnds;  // Running maximum of byteEnd within each run
+        uint32_t plainCount = 0;
+        int32_t multiplexor = -1;       // Index into extractors
+        std::vector<std::pair<uint32_t, std::pair<uint32_t, uint32_t>>> groups;  // muxValue -> [begin, end)
+    };
+
+    std::vector<DBCMessage> messages;
+    std::vector<Compiled> compiled;
+    std::unordered_map<uint64_t, uint32_t> byId;
+    std::vector<uint32_t> signalMessage;
+    std::unordered_map<std::string, uint32_t> signalNames;
+    size_t maxPerFrame = 0;
+
+    static bool compileSignal(const DBCSignal& signal, uint32_t index, Extractor& extractor) {
+        extractor.signal = index;
+        extractor.mask = signal.bitLength == 64 ? ~0ULL : (1ULL << signal.bitLength) - 1;
+        extractor.signShift = signal.isSigned && signal.bitLength < 64 ? static_cast<uint8_t>(64 - signal.bitLength) : 0;
+        extractor.bigEndian = !signal.littleEndian;
+
+        if (signal.littleEndian) {
+            // Intel: startBit is the LSB, counting up from bit 0 of byte 0
+            uint32_t last = signal.startBit + signal.bitLength - 1;
+            if (last >= MAX_FRAME_BYTES * 8) {
+                return false;
+            }
+            extractor.byteOffset = signal.startBit / 8;
+            extractor.shift = signal.startBit % 8;
+            extractor.byteEnd = static_cast<uint16_t>(last / 8 + 1);
+            extractor.spill = extractor.shift + signal.bitLength > 64 ? static_cast<uint8_t>(extractor.shift + signal.bitLength - 64) : 0;
+            return true;
+        }
+
+        // Motorola: startBit is the MSB in sawtooth numbering; work in linear big-endian bit order
+        uint32_t msb = (signal.startBit / 8) * 8 + (7 - signal.startBit % 8);
+        uint32_t lsb = msb + signal.bitLength - 1;
+        if (lsb >= MAX_FRAME_BYTES * 8) {
+            return false;
+        }
+        extractor.byteOffset = static_cast<uint16_t>(msb / 8);
+        extractor.byteEnd = static_cast<uint16_t>(lsb / 8 + 1);
+        uint32_t lsbInWindow = lsb - extractor.byteOffset * 8;
+        if (lsbInWindow <= 63) {
+            extractor.shift = static_cast<uint8_t>(63 - lsbInWindow);
+        } else {
+            extractor.spill = static_cast<uint8_t>(lsbInWindow - 63);
+        }
+        return true;
+    }
+
+    bool compileMessage(const DBCMessage& message, Compiled& result) {
+        std::vector<std::pair<uint32_t, uint32_t>> multiplexed;   // muxValue, signal offset
+        for (uint32_t i = 0; i < message.signals.size(); ++i) {
+            const DBCSignal& signal = message.signals[i];
+            if (signal.multiplex == DBCSignal::Multiplex::MULTIPLEXED) {
+                multiplexed.emplace_back(signal.muxValue, i);
+                continue;
+            }
+            Extractor extractor;
+            if (!compileSignal(signal, message.firstSignal + i, extractor)) {
+                return false;
+            }
+            if (signal.multiplex == DBCSignal::Multiplex::MULTIPLEXOR) {
+                result.multiplexor = static_cast<int32_t>(result.extractors.size());
+            }
+            result.extractors.push_back(extractor);
+            result.factors.push_back(signal.factor);
+            result.offsets.push_back(signal.offset);
+        }
+        result.plainCount = static_cast<uint32_t>(result.extractors.size());
+        if (!multiplexed.empty() && result.multiplexor < 0) {
+            Logger::getInstance()->warning("DBC message " + message.name + " has multiplexed signals but no multiplexor");
+            multiplexed.clear();
+        }
+
+        std::stable_sort(multiplexed.begin(), multiplexed.end(),
+                         [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+                             return a.first < b.first;
+                         });
+        size_t largestGroup = 0;
+        for (size_t i = 0; i < multiplexed.size();) {
+            uint32_t value = multiplexed[i].first;
+            uint32_t begin = static_cast<uint32_t>(result.extractors.size());
+            for (; i < multiplexed.size() && multiplexed[i].first == value; ++i) {
+                const DBCSignal& signal = message.signals[multiplexed[i].second];
+                Extractor extractor;
+                if (!compileSignal(signal, message.firstSignal + multiplexed[i].second, extractor)) {
+                    return false;
+                }
+                result.extractors.push_back(extractor);
+                result.factors.push_back(signal.factor);
+                result.offsets.push_back(signal.offset);
+            }
+            uint32_t end = static_cast<uint32_t>(result.extractors.size());
+            result.groups.push_back({value, {begin, end}});
+            largestGroup = std::max<size_t>(largestGroup, end - begin);
+        }
+        maxPerFrame = std::max(maxPerFrame, result.plainCount + largestGroup);
+
+        result.byteEnds.resize(result.extractors.size());
+        uint16_t required = 0;
+        size_t nextGroup = 0;
+        for (uint32_t i = 0; i < result.extractors.size(); ++i) {
+            if (nextGroup < result.groups.size() && result.groups[nextGroup].second.first == i) {
+                required = 0;
+                ++nextGroup;
+            }
+            required = std::max(required, result.extractors[i].byteEnd);
+            result.byteEnds[i] = required;
+        }
+        return true;
+    }
+
+    bool parse(const std::string& text) {
+        auto logger = Logger::getInstance();
+        std::vector<DBCMessage> parsed;
+        std::unordered_map<uint32_t, size_t> byRawId;
+        bool inMessage = false;
+        bool skipMessage = false;
+
+        std::istringstream input(text);
+        std::string line;
+        size_t lineNumber = 0;
+        auto fail = [&](const std::string& what) {
+            logger->error("DBC parse error at line " + std::to_string(lineNumber) + ": " + what);
+            return false;
+        };
+
+        while (std::getline(input, line)) {
+            ++lineNumber;
+            std::string statement = utils::trim(line);
+            if (statement.empty()) {
+                continue;
+            }
+
+            if (statement.compare(0, 4, "BO_ ") == 0) {
+                DBCMessage message;
+                uint32_t rawId = 0;
+                if (!parseMessage(statement, message, rawId)) {
+                    return fail(statement);
+                }
+                skipMessage = message.name == INDEPENDENT_SIGNALS;
+                inMessage = true;
+                if (!skipMessage) {
+                    byRawId[rawId] = parsed.size();
+                    parsed.push_back(std::move(message));
+                }
+                continue;
+            }
+            if (statement.compare(0, 4, "SG_ ") == 0) {
+                DBCSignal signal;
+                if (!inMessage || !parseSignal(statement, signal)) {
+                    return fail(statement);
+                }
+                if (!skipMessage) {
+                    parsed.back().signals.push_back(std::move(signal));
+                }
+                continue;
+            }
+            inMessage = false;
+
+            // Other statements may carry strings spanning lines; gather them whole
+            while (countQuotes(statement) % 2 != 0 && std::getline(input, line)) {
+                ++lineNumber;
+                statement += "\n" + line;
+            }
+            if (statement.compare(0, 5, "VAL_ ") == 0) {
+                while (statement.find(';') == std::string::npos && std::getline(input, line)) {
+                    ++lineNumber;
+                    statement += " " + line;
+                }
+                Scanner scanner(statement);
+                uint64_t rawId = 0;
+                scanner.word();
+                if (!scanner.integer(rawId)) {
+                    continue;   // Value tables of environment variables
+                }
+                std::string name = scanner.word();
+                auto message = byRawId.find(static_cast<uint32_t>(rawId));
+                if (message == byRawId.end()) {
+                    continue;
+                }
+                auto& signals = parsed[message->second].signals;
+                auto signal = std::find_if(signals.begin(), signals.end(),
+                                           [&name](const DBCSignal& s) { return s.name == name; });
+                int64_t value = 0;
+                std::string description;
+                while (signal != signals.end() && scanner.signedInteger(value) && scanner.quoted(description)) {
+                    signal->valueDescriptions[value] = description;
+                }
+            }
+        }
+
+        messages = std::move(parsed);
+        compiled.assign(messages.size(), Compiled());
+        byId.clear();
+        signalMessage.clear();
+        signalNames.clear();
+        maxPerFrame = 0;
+        for (uint32_t m = 0; m < messages.size(); ++m) {
+            DBCMessage& message = messages[m];
+            message.firstSignal = static_cast<uint32_t>(signalMessage.size());
+            for (const auto& signal : message.signals) {
+                uint32_t index = static_cast<uint32_t>(signalMessage.size());
+                signalMessage.push_back(m);
+                signalNames.emplace(message.name + "." + signal.name, index);
+                // A bare name shared by several messages only resolves qualified
+                auto bare = signalNames.emplace(signal.name, index);
+                if (!bare.second && bare.first->second != DBCDatabase::INVALID_SIGNAL &&
+                    signalMessage[bare.first->second] != m) {
+                    logger->warning("DBC signal " + signal.name + " is in " +
+                                    messages[signalMessage[bare.first->second]].name + " and " + message.name +
+                                    ", look it up as Message.Signal");
+                    bare.first->second = DBCDatabase::INVALID_SIGNAL;
+                }
+            }
+            if (!compileMessage(message, compiled[m])) {
+                return fail("signal outside the frame in " + message.name);
+            }
+            byId[messageKey(message.id, message.extended)] = m;
+        }
+        return true;
+    }
+
+    void extract(const Compiled& message, uint32_t begin, uint32_t end, const uint8_t* buffer, size_t length,
+                 DBCSignalValue* out, size_t& count, size_t capacity) const {
+        if (begin == end) {
+            return;
+        }
+        // Frames at least as long as every signal needs take the two-pass path
+        const bool dense = length >= message.byteEnds[end - 1] && capacity - count >= end - begin;
+        const size_t first = count;
+        for (uint32_t i = begin; i < end && count < capacity; ++i) {
+            const Extractor& e = message.extractors[i];
+            if (!dense && e.byteEnd > length) {
+                continue;
+            }
+            uint64_t raw;
+            if (!e.bigEndian) {
+                raw = loadLittle64(buffer + e.byteOffset) >> e.shift;
+                if (e.spill) {
+                    raw |= static_cast<uint64_t>(buffer[e.byteOffset + 8]) << (64 - e.shift);
+                }
+            } else if (!e.spill) {
+                raw = loadBig64(buffer + e.byteOffset) >> e.shift;
+            } else {
+                raw = (loadBig64(buffer + e.byteOffset) << e.spill) | (buffer[e.byteOffset + 8] >> (8 - e.spill));
+            }
+            raw &= e.mask;
+            DBCSignalValue& value = out[count++];
+            value.signal = e.signal;
+            value.raw = e.signShift ? static_cast<int64_t>(raw << e.signShift) >> e.signShift
+                                    : static_cast<int64_t>(raw);
+            if (!dense) {
+                value.value = static_cast<double>(value.raw) * message.factors[i] + message.offsets[i];
+            }
+        }
+        if (!dense) {
+            return;
+        }
+
+        // Scaling pass; outputs line up with the factor/offset columns, so it has no branches
+        const double* factors = message.factors.data() + begin;
+        const double* offsets = message.offsets.data() + begin;
+        DBCSignalValue* values = out + first;
+        const size_t n = end - begin;
+        for (size_t k = 0; k < n; ++k) {
+            values[k].value = static_cast<double>(values[k].raw) * factors[k] + offsets[k];
+        }
+    }
+};
+
+DBCDatabase::DBCDatabase() : pImpl(std::make_unique<Impl>()) {}
+
+DBCDatabase::~DBCDatabase() = default;
+
+bool DBCDatabase::loadFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        Logger::getInstance()->error("Could not open DBC file: " + path);
+        return false;
+    }
+    std::ostringstream text;
+    text << file.rdbuf();
+    return loadString(text.str());
+}
+
+bool DBCDatabase::loadString(const std::string& text) {
+    if (!pImpl->parse(text)) {
+        return false;
+    }
+    Logger::getInstance()->info("Loaded DBC: " + toString());
+    return true;
+}
+
+const std::vector<DBCMessage>& DBCDatabase::getMessages() const {
+    return pImpl->messages;
+}
+
+const DBCMessage* DBCDatabase::findMessage(uint32_t id, bool extended) const {
+    auto it = pImpl->byId.find(messageKey(id, extended));
+    return it == pImpl->byId.end() ? nullptr : &pImpl->messages[it->second];
+}
+
+size_t DBCDatabase::getSignalCount() const {
+    return pImpl->signalMessage.size();
+}
+
+const DBCSignal* DBCDatabase::getSignal(uint32_t signal) const {
+    const DBCMessage* message = getSignalMessage(signal);
+    return message ? &message->signals[signal - message->firstSignal] : nullptr;
+}
+
+const DBCMessage* DBCDatabase::getSignalMessage(uint32_t signal) const {
+    return signal < pImpl->signalMessage.size() ? &pImpl->messages[pImpl->signalMessage[signal]] : nullptr;
+}
+
+uint32_t DBCDatabase::findSignal(const std::string& name) const {
+    auto it = pImpl->signalNames.find(name);
+    return it == pImpl->signalNames.end() ? INVALID_SIGNAL : it->second;
+}
+
+size_t DBCDatabase::decode(uint32_t id, bool extended, const uint8_t* data, size_t length,
+                           DBCSignalValue* out, size_t capacity) const {
+    auto it = pImpl->byId.find(messageKey(id, extended));
+    if (it == pImpl->byId.end()) {
+        return 0;
+    }
+    const Impl::Compiled& message = pImpl->compiled[it->second];
+    if (message.extractors.empty()) {
+        return 0;
+    }
+
+    uint8_t buffer[DECODE_BUFFER] = {};
+    length = std::min(length, MAX_FRAME_BYTES);
+    std::memcpy(buffer, data, length);
+
+    size_t count = 0;
+    pImpl->extract(message, 0, message.plainCount, buffer, length, out, count, capacity);
+    if (message.multiplexor < 0 || message.groups.empty()) {
+        return count;
+    }
+
+    // The multiplexor is a plain signal; find its raw value among the outputs
+    const uint32_t selectorSignal = message.extractors[message.multiplexor].signal;
+    auto selector = std::find_if(out, out + count,
+                                 [selectorSignal](const DBCSignalValue& v) { return v.signal == selectorSignal; });
+    if (selector == out + count) {
+        return count;
+    }
+    const uint32_t muxValue = static_cast<uint32_t>(selector->raw);
+    auto group = std::lower_bound(message.groups.begin(), message.groups.end(), muxValue,
+                                  [](const std::pair<uint32_t, std::pair<uint32_t, uint32_t>>& g, uint32_t v) {
+                                      return g.first < v;
+                                  });
+    if (group != message.groups.end() && group->first == muxValue) {
+        pImpl->extract(message, group->second.first, group->second.second, buffer, length, out, count, capacity);
+    }
+    return count;
+}
+
+size_t DBCDatabase::getMaxSignalsPerFrame() const {
+    return pImpl->maxPerFrame;
+}
+
+std::string DBCDatabase::toString() const {
+    size_t multiplexed = 0;
+    for (const auto& message : pImpl->messages) {
+        multiplexed += std::count_if(message.signals.begin(), message.signals.end(), [](const DBCSignal& s) {
+            return s.multiplex == DBCSignal::Multiplex::MULTIPLEXED;
+        });
+    }
+    std::ostringstream ss;
+    ss << "DBCDatabase[Messages:" << pImpl->messages.size()
+       << ", Signals:" << pImpl->signalMessage.size()
+       << ", Multiplexed:" << multiplexed << "]";
+    return ss.str();
+}
+
+// DBCDecoder implementation
+class DBCDecoder::Impl {
+public:
+    struct Subscriptions {
+        std::unordered_map<uint32_t, std::vector<std::pair<uint32_t, SignalHandler>>> bySignal;
+        std::unordered_map<const DBCMessage*, std::vector<std::pair<uint32_t, MessageHandler>>> byMessage;
+        std::shared_ptr<LiveDataStore> store;
+        std::vector<LiveDataStore::ChannelId> channels;     // Indexed by signal
+    };
+
+    std::shared_ptr<const DBCDatabase> database;
+
+    std::mutex subscriptionsMutex;
+    std::shared_ptr<const Subscriptions> subscriptions = std::make_shared<Subscriptions>();
+    uint32_t nextSubscription = 1;
+
+    std::shared_ptr<CANProtocol> canProtocol;
+    uint32_t listenerId = 0;
+
+    std::atomic<uint64_t> framesDecoded{0};
+    std::atomic<uint64_t> framesUnknown{0};
+    std::atomic<uint64_t> signalsDecoded{0};
+    std::chrono::system_clock::time_point startTime;
+
+    std::shared_ptr<const Subscriptions> snapshot() {
+        std::lock_guard<std::mutex> lock(subscriptionsMutex);
+        return subscriptions;
+    }
+
+    template<typename Update>
+    uint32_t modify(Update update) {
+        std::lock_guard<std::mutex> lock(subscriptionsMutex);
+        auto updated = std::make_shared<Subscriptions>(*subscriptions);
+        uint32_t id = nextSubscription++;
+        update(*updated, id);
+        subscriptions = std::move(updated);
+        return id;
+    }
+
+    size_t process(const CANMessage& message) {
+        if (!database) {
+            return 0;
+        }
+        thread_local std::vector<DBCSignalValue> values;
+        values.resize(std::max<size_t>(values.size(), database->getMaxSignalsPerFrame()));
+        size_t count = database->decode(message.id, message.extended, message.data.data(), message.data.size(),
+                                        values.data(), values.size());
+        if (count == 0) {
+            framesUnknown.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+        framesDecoded.fetch_add(1, std::memory_order_relaxed);
+        signalsDecoded.fetch_add(count, std::memory_order_relaxed);
+
+        auto current = snapshot();
+        if (current->store) {
+            for (size_t i = 0; i < count; ++i) {
+                LiveDataStore::ChannelId channel = current->channels[values[i].signal];
+                if (channel != LiveDataStore::INVALID_CHANNEL) {
+                    current->store->publish(channel, values[i].value);
+                }
+            }
+        }
+        if (!current->bySignal.empty()) {
+            DBCSignalUpdate update;
+            update.message = database->getSignalMessage(values[0].signal);
+            update.timestamp = message.timestamp;
+            for (size_t i = 0; i < count; ++i) {
+                auto handlers = current->bySignal.find(values[i].signal);
+                if (handlers == current->bySignal.end()) {
+                    continue;
+                }
+                update.signal = database->getSignal(values[i].signal);
+                update.index = values[i].signal;
+                update.raw = values[i].raw;
+                update.value = values[i].value;
+                for (const auto& handler : handlers->second) {
+                    handler.second(update);
+                }
+            }
+        }
+        if (!current->byMessage.empty()) {
+            const DBCMessage* definition = database->getSignalMessage(values[0].signal);
+            auto handlers = current->byMessage.find(definition);
+            if (handlers != current->byMessage.end()) {
+                for (const auto& handler : handlers->second) {
+                    handler.second(*definition, values.data(), count, message.timestamp);
+                }
+            }
+        }
+        return count;
+    }
+};
+
+DBCDecoder::DBCDecoder(std::shared_ptr<const DBCDatabase> database) : pImpl(std::make_unique<Impl>()) {
+    pImpl->database = std::move(database);
+    pImpl->startTime = std::chrono::system_clock::now();
+}
+
+DBCDecoder::~DBCDecoder() {
+    detach();
+}
+
+bool DBCDecoder::attach(std::shared_ptr<CANProtocol> canProtocol) {
+    if (!canProtocol || !pImpl->database) {
+        return false;
+    }
+    detach();
+    pImpl->listenerId = canProtocol->addListener([impl = pImpl.get()](const CANMessage& message) {
+        impl->process(message);
+    });
+    if (!pImpl->listenerId) {
+        return false;
+    }
+    pImpl->canProtocol = std::move(canProtocol);
+    return true;
+}
+
+void DBCDecoder::detach() {
+    if (pImpl->canProtocol) {
+        pImpl->canProtocol->removeListener(pImpl->listenerId);
+        pImpl->canProtocol.reset();
+        pImpl->listenerId = 0;
+    }
+}
+
+bool DBCDecoder::publishTo(std::shared_ptr<LiveDataStore> store) {
+    if (!store || !pImpl->database) {
+        return false;
+    }
+    const DBCDatabase& database = *pImpl->database;
+    std::vector<LiveDataStore::ChannelId> channels(database.getSignalCount(), LiveDataStore::INVALID_CHANNEL);
+    size_t missing = 0;
+    for (uint32_t i = 0; i < channels.size(); ++i) {
+        const DBCSignal* signal = database.getSignal(i);
+        channels[i] = store->addChannel(database.getSignalMessage(i)->name + "." + signal->name, signal->unit);
+        if (channels[i] == LiveDataStore::INVALID_CHANNEL) {
+            ++missing;
+        }
+    }
+    if (missing) {
+        Logger::getInstance()->warning("Live data store is full, " + std::to_string(missing) + " DBC signals not published");
+    }
+    pImpl->modify([&store, &channels](Impl::Subscriptions& s, uint32_t) {
+        s.store = std::move(store);
+        s.channels = std::move(channels);
+    });
+    return true;
+}
+
+uint32_t DBCDecoder::subscribe(const std::string& signal, SignalHandler handler) {
+    uint32_t index = pImpl->database ? pImpl->database->findSignal(signal) : DBCDatabase::INVALID_SIGNAL;
+    if (index == DBCDatabase::INVALID_SIGNAL || !handler) {
+        Logger::getInstance()->warning("Unknown DBC signal: " + signal);
+        return 0;
+    }
+    return pImpl->modify([index, &handler](Impl::Subscriptions& s, uint32_t id) {
+        s.bySignal[index].emplace_back(id, std::move(handler));
+    });
+}
+
+uint32_t DBCDecoder::subscribeMessage(uint32_t id, bool extended, MessageHandler handler) {
+    const DBCMessage* message = pImpl->database ? pImpl->database->findMessage(id, extended) : nullptr;
+    if (!message || !handler) {
+        Logger::getInstance()->warning("Unknown DBC message: " + canIdToString(id, extended));
+        return 0;
+    }
+    return pImpl->modify([message, &handler](Impl::Subscriptions& s, uint32_t subscription) {
+        s.byMessage[message].emplace_back(subscription, std::move(handler));
+    });
+}
+
+bool DBCDecoder::unsubscribe(uint32_t subscription) {
+    bool found = false;
+    pImpl->modify([subscription, &found](Impl::Subscriptions& s, uint32_t) {
+        auto sameId = [subscription](const auto& entry) { return entry.first == subscription; };
+        for (auto it = s.bySignal.begin(); it != s.bySignal.end();) {
+            auto& handlers = it->second;
+            auto removed = std::remove_if(handlers.begin(), handlers.end(), sameId);
+            found |= removed != handlers.end();
+            handlers.erase(removed, handlers.end());
+            it = handlers.empty() ? s.bySignal.erase(it) : std::next(it);
+        }
+        for (auto it = s.byMessage.begin(); it != s.byMessage.end();) {
+            auto& handlers = it->second;
+            auto removed = std::remove_if(handlers.begin(), handlers.end(), sameId);
+            found |= removed != handlers.end();
+            handlers.erase(removed, handlers.end());
+            it = handlers.empty() ? s.byMessage.erase(it) : std::next(it);
+        }
+    });
+    return found;
+}
+
+size_t DBCDecoder::process(const CANMessage& message) {
+    return pImpl->process(message);
+}
+
+DBCDecoder::Statistics DBCDecoder::getStatistics() const {
+    Statistics stats;
+    stats.framesDecoded = pImpl->framesDecoded;
+    stats.framesUnknown = pImpl->framesUnknown;
+    stats.signalsDecoded = pImpl->signalsDecoded;
+    stats.startTime = pImpl->startTime;
+    return stats;
+}
+
+std::string DBCDecoder::toString() const {
+    auto stats = getStatistics();
+    std::ostringstream ss;
+    ss << "DBCDecoder[" << (pImpl->database ? pImpl->database->toString() : "<no database>")
+       << ", Frames:" << stats.framesDecoded
+       << ", Unknown:" << stats.framesUnknown
+       << ", Signals:" << stats.signalsDecoded << "]";
+    return ss.str();
+}
+
+} // namespace protocols
+} // namespace fmus
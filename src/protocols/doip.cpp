@@ -0,0 +1,729 @@
+#include <fmus/protocols/doip.h>
+#include <fmus/logger.h>
+#include <fmus/utils.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #ifdef _MSC_VER
+        #pragma comment(lib, "ws2_32.lib")
+    #endif
+#else
+    #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
+namespace fmus {
+namespace protocols {
+
+namespace {
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+constexpr SocketHandle INVALID_SOCKET_HANDLE = INVALID_SOCKET;
+
+struct WinsockInit {
+    WinsockInit() {
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+    }
+    ~WinsockInit() { WSACleanup(); }
+};
+
+void ensureSockets() {
+    static WinsockInit init;
+}
+
+void closeSocket(SocketHandle s) { closesocket(s); }
+int pollSocket(SocketHandle s, short events, int timeoutMs) {
+    WSAPOLLFD fd{s, events, 0};
+    return WSAPoll(&fd, 1, timeoutMs);
+}
+#else
+using SocketHandle = int;
+constexpr SocketHandle INVALID_SOCKET_HANDLE = -1;
+
+void ensureSockets() {}
+
+void closeSocket(SocketHandle s) { ::close(s); }
+int pollSocket(SocketHandle s, short events, int timeoutMs) {
+    pollfd fd{s, events, 0};
+    return ::poll(&fd, 1, timeoutMs);
+}
+#endif
+
+constexpr size_t ROUTING_REQUEST_SIZE = 7;
+constexpr size_t ROUTING_RESPONSE_MIN_SIZE = 9;
+constexpr size_t DIAGNOSTIC_ADDRESS_SIZE = 4;
+constexpr size_t ANNOUNCEMENT_MIN_SIZE = 32;
+constexpr size_t VIN_LENGTH = 17;
+
+void putU16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value >> 8);
+    out[1] = static_cast<uint8_t>(value);
+}
+
+uint16_t getU16(const uint8_t* in) {
+    return static_cast<uint16_t>((in[0] << 8) | in[1]);
+}
+
+/**
+ * Send two buffers back to back in one gathered write, handling partial sends
+ */
+bool sendGathered(SocketHandle s, const uint8_t* first, size_t firstLength,
+                  const uint8_t* second, size_t secondLength) {
+    while (firstLength + secondLength > 0) {
+#ifdef _WIN32
+        WSABUF buffers[2] = {
+            {static_cast<ULONG>(firstLength), reinterpret_cast<CHAR*>(const_cast<uint8_t*>(first))},
+            {static_cast<ULONG>(secondLength), reinterpret_cast<CHAR*>(const_cast<uint8_t*>(second))}};
+        DWORD sent = 0;
+        if (WSASend(s, firstLength ? buffers : buffers + 1, firstLength ? 2 : 1, &sent, 0, nullptr, nullptr) != 0) {
+            return false;
+        }
+        size_t written = sent;
+#else
+        iovec buffers[2] = {
+            {const_cast<uint8_t*>(first), firstLength},
+            {const_cast<uint8_t*>(second), secondLength}};
+        msghdr message{};
+        message.msg_iov = firstLength ? buffers : buffers + 1;
+        message.msg_iovlen = firstLength ? 2 : 1;
+        ssize_t sent = ::sendmsg(s, &message, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        size_t written = static_cast<size_t>(sent);
+#endif
+        size_t fromFirst = std::min(written, firstLength);
+        first += fromFirst;
+        firstLength -= fromFirst;
+        written -= fromFirst;
+        second += written;
+        secondLength -= written;
+    }
+    return true;
+}
+
+bool receiveExact(SocketHandle s, uint8_t* buffer, size_t length) {
+    while (length > 0) {
+#ifdef _WIN32
+        int received = ::recv(s, reinterpret_cast<char*>(buffer), static_cast<int>(std::min<size_t>(length, 1 << 30)), 0);
+#else
+        ssize_t received = ::recv(s, buffer, length, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (received <= 0) {
+            return false;
+        }
+        buffer += received;
+        length -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+SocketHandle connectWithTimeout(const std::string& host, uint16_t port, uint32_t timeoutMs) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* results = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &results) != 0) {
+        return INVALID_SOCKET_HANDLE;
+    }
+
+    SocketHandle connected = INVALID_SOCKET_HANDLE;
+    for (addrinfo* ai = results; ai && connected == INVALID_SOCKET_HANDLE; ai = ai->ai_next) {
+        SocketHandle s = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (s == INVALID_SOCKET_HANDLE) {
+            continue;
+        }
+
+#ifdef _WIN32
+        u_long nonBlocking = 1;
+        ioctlsocket(s, FIONBIO, &nonBlocking);
+#else
+        int flags = fcntl(s, F_GETFL, 0);
+        fcntl(s, F_SETFL, flags | O_NONBLOCK);
+#endif
+
+        bool ok = ::connect(s, ai->ai_addr, static_cast<int>(ai->ai_addrlen)) == 0;
+        if (!ok && pollSocket(s, POLLOUT, static_cast<int>(timeoutMs)) > 0) {
+            int error = 0;
+            socklen_t errorLength = sizeof(error);
+            getsockopt(s, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &errorLength);
+            ok = error == 0;
+        }
+
+#ifdef _WIN32
+        nonBlocking = 0;
+        ioctlsocket(s, FIONBIO, &nonBlocking);
+#else
+        fcntl(s, F_SETFL, flags);
+#endif
+
+        if (ok) {
+            connected = s;
+        } else {
+            closeSocket(s);
+        }
+    }
+    freeaddrinfo(results);
+    return connected;
+}
+
+} // anonymous namespace
+
+// DoIPHeader implementation
+void DoIPHeader::encode(uint8_t* out) const {
+    out[0] = version;
+    out[1] = static_cast<uint8_t>(~version);
+    putU16(out + 2, static_cast<uint16_t>(payloadType));
+    out[4] = static_cast<uint8_t>(payloadLength >> 24);
+    out[5] = static_cast<uint8_t>(payloadLength >> 16);
+    out[6] = static_cast<uint8_t>(payloadLength >> 8);
+    out[7] = static_cast<uint8_t>(payloadLength);
+}
+
+bool DoIPHeader::decode(const uint8_t* in, DoIPHeader& header) {
+    if (static_cast<uint8_t>(~in[0]) != in[1]) {
+        return false;
+    }
+    header.version = in[0];
+    header.payloadType = static_cast<DoIPPayloadType>(getU16(in + 2));
+    header.payloadLength = (static_cast<uint32_t>(in[4]) << 24) | (static_cast<uint32_t>(in[5]) << 16) |
+                           (static_cast<uint32_t>(in[6]) << 8) | in[7];
+    return true;
+}
+
+// DoIPVehicleAnnouncement implementation
+std::vector<uint8_t> DoIPVehicleAnnouncement::toPayload() const {
+    std::vector<uint8_t> payload(ANNOUNCEMENT_MIN_SIZE + 1, 0);
+    std::memcpy(payload.data(), vin.data(), std::min(vin.size(), VIN_LENGTH));
+    putU16(payload.data() + 17, logicalAddress);
+    std::copy(eid.begin(), eid.end(), payload.begin() + 19);
+    std::copy(gid.begin(), gid.end(), payload.begin() + 25);
+    payload[31] = furtherAction;
+    payload[32] = syncStatus;
+    return payload;
+}
+
+bool DoIPVehicleAnnouncement::fromPayload(const uint8_t* data, size_t length,
+                                          DoIPVehicleAnnouncement& announcement) {
+    if (length < ANNOUNCEMENT_MIN_SIZE) {
+        return false;
+    }
+    announcement.vin.assign(reinterpret_cast<const char*>(data), VIN_LENGTH);
+    announcement.logicalAddress = getU16(data + 17);
+    std::copy(data + 19, data + 25, announcement.eid.begin());
+    std::copy(data + 25, data + 31, announcement.gid.begin());
+    announcement.furtherAction = data[31];
+    announcement.syncStatus = length > ANNOUNCEMENT_MIN_SIZE ? data[32] : 0;
+    return true;
+}
+
+std::string DoIPVehicleAnnouncement::toString() const {
+    std::ostringstream ss;
+    ss << "DoIPEntity[VIN:" << vin
+       << ", Addr:0x" << std::hex << std::setw(4) << std::setfill('0') << logicalAddress << std::dec
+       << ", EID:" << utils::bytesToHex(eid.data(), eid.size());
+    if (!ipAddress.empty()) {
+        ss << ", IP:" << ipAddress;
+    }
+    ss << "]";
+    return ss.str();
+}
+
+std::string DoIPConfig::toString() const {
+    std::ostringstream ss;
+    ss << "DoIPConfig[Tester:0x" << std::hex << std::setw(4) << std::setfill('0') << testerAddress
+       << ", Activation:0x" << std::setw(2) << static_cast<int>(activationType) << std::dec
+       << ", Port:" << port
+       << ", Connect:" << connectTimeout << "ms"
+       << ", Control:" << controlTimeout << "ms"
+       << ", Ack:" << diagnosticAckTimeout << "ms]";
+    return ss.str();
+}
+
+// DoIPClient implementation
+class DoIPClient::Impl {
+public:
+    DoIPConfig config;
+    std::string host;
+    SocketHandle socket = INVALID_SOCKET_HANDLE;
+    std::atomic<bool> connected{false};
+    std::atomic<bool> routingActive{false};
+    std::atomic<uint16_t> entityAddress{0};
+
+    std::thread receiver;
+    std::mutex sendMutex;
+
+    // Handler is swapped under its own mutex and called on the receive thread
+    std::mutex handlerMutex;
+    DiagnosticHandler handler;
+
+    // Control exchange: one outstanding routing activation or diagnostic ACK at a time
+    std::mutex diagnosticMutex;
+    std::mutex controlMutex;
+    std::condition_variable controlCondition;
+    DoIPPayloadType awaitedType = DoIPPayloadType::GENERIC_NACK;
+    bool controlDone = false;
+    bool controlPositive = false;
+    std::atomic<uint8_t> lastResponseCode{0};
+
+    Statistics stats;
+    mutable std::mutex statsMutex;
+
+    Impl() {
+        stats.startTime = std::chrono::system_clock::now();
+    }
+
+    bool send(DoIPPayloadType type, const uint8_t* prefix, size_t prefixLength,
+              const uint8_t* payload, size_t payloadLength) {
+        uint8_t head[DoIPHeader::SIZE + DIAGNOSTIC_ADDRESS_SIZE + ROUTING_REQUEST_SIZE];
+        DoIPHeader(type, static_cast<uint32_t>(prefixLength + payloadLength)).encode(head);
+        std::memcpy(head + DoIPHeader::SIZE, prefix, prefixLength);
+
+        std::lock_guard<std::mutex> lock(sendMutex);
+        if (!connected || !sendGathered(socket, head, DoIPHeader::SIZE + prefixLength, payload, payloadLength)) {
+            return false;
+        }
+        std::lock_guard<std::mutex> statsLock(statsMutex);
+        stats.messagesSent++;
+        stats.bytesSent += DoIPHeader::SIZE + prefixLength + payloadLength;
+        return true;
+    }
+
+    void beginControl(DoIPPayloadType expected) {
+        std::lock_guard<std::mutex> lock(controlMutex);
+        awaitedType = expected;
+        controlDone = false;
+        controlPositive = false;
+    }
+
+    bool awaitControl(uint32_t timeoutMs) {
+        std::unique_lock<std::mutex> lock(controlMutex);
+        bool done = controlCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                                              [this] { return controlDone || !connected; });
+        bool positive = done && controlDone && controlPositive;
+        awaitedType = DoIPPayloadType::GENERIC_NACK;
+        return positive;
+    }
+
+    void completeControl(DoIPPayloadType type, bool positive, uint8_t code) {
+        std::lock_guard<std::mutex> lock(controlMutex);
+        bool ackType = type == DoIPPayloadType::DIAGNOSTIC_ACK || type == DoIPPayloadType::DIAGNOSTIC_NACK;
+        bool awaitingAck = awaitedType == DoIPPayloadType::DIAGNOSTIC_ACK;
+        if (controlDone || (type != awaitedType && !(ackType && awaitingAck) &&
+                            type != DoIPPayloadType::GENERIC_NACK)) {
+            return;
+        }
+        lastResponseCode = code;
+        controlDone = true;
+        controlPositive = positive;
+        controlCondition.notify_all();
+    }
+
+    void handleMessage(const DoIPHeader& header, const uint8_t* payload) {
+        auto logger = Logger::getInstance();
+        size_t length = header.payloadLength;
+
+        switch (header.payloadType) {
+            case DoIPPayloadType::DIAGNOSTIC_MESSAGE: {
+                if (length < DIAGNOSTIC_ADDRESS_SIZE) {
+                    break;
+                }
+                std::lock_guard<std::mutex> lock(handlerMutex);
+                if (handler) {
+                    handler(getU16(payload), getU16(payload + 2), payload + DIAGNOSTIC_ADDRESS_SIZE,
+                            length - DIAGNOSTIC_ADDRESS_SIZE);
+                }
+                break;
+            }
+            case DoIPPayloadType::DIAGNOSTIC_ACK:
+            case DoIPPayloadType::DIAGNOSTIC_NACK: {
+                bool positive = header.payloadType == DoIPPayloadType::DIAGNOSTIC_ACK;
+                uint8_t code = length > DIAGNOSTIC_ADDRESS_SIZE ? payload[DIAGNOSTIC_ADDRESS_SIZE] : 0;
+                if (!positive) {
+                    std::lock_guard<std::mutex> lock(statsMutex);
+                    stats.negativeAcks++;
+                }
+                completeControl(header.payloadType, positive, code);
+                break;
+            }
+            case DoIPPayloadType::ROUTING_ACTIVATION_RESPONSE: {
+                if (length < ROUTING_RESPONSE_MIN_SIZE) {
+                    completeControl(header.payloadType, false, 0);
+                    break;
+                }
+                uint8_t code = payload[4];
+                if (code == static_cast<uint8_t>(DoIPRoutingCode::SUCCESS)) {
+                    entityAddress = getU16(payload + 2);
+                }
+                completeControl(header.payloadType, code == static_cast<uint8_t>(DoIPRoutingCode::SUCCESS), code);
+                break;
+            }
+            case DoIPPayloadType::ALIVE_CHECK_REQUEST: {
+                uint8_t address[2];
+                putU16(address, config.testerAddress);
+                send(DoIPPayloadType::ALIVE_CHECK_RESPONSE, address, sizeof(address), nullptr, 0);
+                std::lock_guard<std::mutex> lock(statsMutex);
+                stats.aliveChecks++;
+                break;
+            }
+            case DoIPPayloadType::GENERIC_NACK: {
+                uint8_t code = length > 0 ? payload[0] : 0;
+                logger->warning("DoIP entity rejected a message, NACK code " + std::to_string(code));
+                completeControl(header.payloadType, false, code);
+                break;
+            }
+            default:
+                logger->debug("Ignoring DoIP payload " + doipPayloadTypeToString(header.payloadType));
+                break;
+        }
+    }
+
+    void receiveLoop() {
+        // Grows to the largest message seen and is reused, so steady-state receives do not allocate
+        std::vector<uint8_t> buffer;
+        uint8_t headerBytes[DoIPHeader::SIZE];
+
+        while (connected) {
+            DoIPHeader header;
+            if (!receiveExact(socket, headerBytes, sizeof(headerBytes))) {
+                break;
+            }
+            if (!DoIPHeader::decode(headerBytes, header) || header.payloadLength > config.maxPayloadSize) {
+                Logger::getInstance()->error("Invalid DoIP header from " + host + ", closing connection");
+                break;
+            }
+            if (buffer.size() < header.payloadLength) {
+                buffer.resize(header.payloadLength);
+            }
+            if (!receiveExact(socket, buffer.data(), header.payloadLength)) {
+                break;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                stats.messagesReceived++;
+                stats.bytesReceived += DoIPHeader::SIZE + header.payloadLength;
+            }
+            handleMessage(header, buffer.data());
+        }
+
+        if (connected.exchange(false)) {
+            Logger::getInstance()->warning("DoIP connection to " + host + " closed");
+        }
+        routingActive = false;
+        std::lock_guard<std::mutex> lock(controlMutex);
+        controlCondition.notify_all();
+    }
+
+    void closeConnection() {
+        bool wasConnected = connected.exchange(false);
+        if (socket != INVALID_SOCKET_HANDLE) {
+#ifdef _WIN32
+            ::shutdown(socket, SD_BOTH);
+#else
+            ::shutdown(socket, SHUT_RDWR);
+#endif
+        }
+        if (receiver.joinable()) {
+            receiver.join();
+        }
+        if (socket != INVALID_SOCKET_HANDLE) {
+            closeSocket(socket);
+            socket = INVALID_SOCKET_HANDLE;
+        }
+        routingActive = false;
+        if (wasConnected) {
+            Logger::getInstance()->info("DoIP disconnected from " + host);
+        }
+    }
+};
+
+std::vector<DoIPVehicleAnnouncement> DoIPClient::discover(const std::string& broadcastAddress, uint32_t timeoutMs,
+                                                          const std::string& vin, uint16_t port) {
+    auto logger = Logger::getInstance();
+    std::vector<DoIPVehicleAnnouncement> entities;
+    ensureSockets();
+
+    SocketHandle s = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == INVALID_SOCKET_HANDLE) {
+        logger->error("Failed to create DoIP discovery socket");
+        return entities;
+    }
+    int enable = 1;
+    setsockopt(s, SOL_SOCKET, SO_BROADCAST, reinterpret_cast<const char*>(&enable), sizeof(enable));
+
+    sockaddr_in target{};
+    target.sin_family = AF_INET;
+    target.sin_port = htons(port);
+    if (inet_pton(AF_INET, broadcastAddress.c_str(), &target.sin_addr) != 1) {
+        logger->error("Invalid DoIP discovery address: " + broadcastAddress);
+        closeSocket(s);
+        return entities;
+    }
+
+    std::vector<uint8_t> request(DoIPHeader::SIZE);
+    if (vin.empty()) {
+        DoIPHeader(DoIPPayloadType::VEHICLE_ID_REQUEST, 0, DOIP_DEFAULT_VERSION).encode(request.data());
+    } else {
+        DoIPHeader(DoIPPayloadType::VEHICLE_ID_REQUEST_VIN, VIN_LENGTH, DOIP_DEFAULT_VERSION).encode(request.data());
+        request.resize(DoIPHeader::SIZE + VIN_LENGTH, 0);
+        std::memcpy(request.data() + DoIPHeader::SIZE, vin.data(), std::min(vin.size(), VIN_LENGTH));
+    }
+    if (::sendto(s, reinterpret_cast<const char*>(request.data()), static_cast<int>(request.size()), 0,
+                 reinterpret_cast<const sockaddr*>(&target), sizeof(target)) < 0) {
+        logger->error("Failed to send DoIP vehicle identification request to " + broadcastAddress);
+        closeSocket(s);
+        return entities;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    uint8_t buffer[512];
+    for (;;) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0 || pollSocket(s, POLLIN, static_cast<int>(remaining)) <= 0) {
+            break;
+        }
+
+        sockaddr_in sender{};
+        socklen_t senderLength = sizeof(sender);
+        auto received = ::recvfrom(s, reinterpret_cast<char*>(buffer), sizeof(buffer), 0,
+                                   reinterpret_cast<sockaddr*>(&sender), &senderLength);
+        DoIPHeader header;
+        if (received < static_cast<decltype(received)>(DoIPHeader::SIZE) || !DoIPHeader::decode(buffer, header) ||
+            header.payloadType != DoIPPayloadType::VEHICLE_ANNOUNCEMENT ||
+            DoIPHeader::SIZE + header.payloadLength > static_cast<size_t>(received)) {
+            continue;
+        }
+
+        DoIPVehicleAnnouncement entity;
+        if (DoIPVehicleAnnouncement::fromPayload(buffer + DoIPHeader::SIZE, header.payloadLength, entity)) {
+            char address[INET_ADDRSTRLEN] = {};
+            inet_ntop(AF_INET, &sender.sin_addr, address, sizeof(address));
+            entity.ipAddress = address;
+            logger->debug("Found " + entity.toString());
+            entities.push_back(entity);
+        }
+    }
+
+    closeSocket(s);
+    return entities;
+}
+
+DoIPClient::DoIPClient() : pImpl(std::make_unique<Impl>()) {}
+
+DoIPClient::~DoIPClient() {
+    disconnect();
+}
+
+bool DoIPClient::connect(const std::string& host, const DoIPConfig& config) {
+    auto logger = Logger::getInstance();
+    disconnect();
+    ensureSockets();
+
+    pImpl->config = config;
+    pImpl->host = host;
+    logger->info("Connecting to DoIP entity " + host + ": " + config.toString());
+
+    pImpl->socket = connectWithTimeout(host, config.port, config.connectTimeout);
+    if (pImpl->socket == INVALID_SOCKET_HANDLE) {
+        logger->error("Failed to connect to DoIP entity " + host);
+        return false;
+    }
+
+    int noDelay = 1;
+    setsockopt(pImpl->socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+    pImpl->connected = true;
+    pImpl->receiver = std::thread([this] { pImpl->receiveLoop(); });
+    return true;
+}
+
+void DoIPClient::disconnect() {
+    pImpl->closeConnection();
+}
+
+bool DoIPClient::isConnected() const {
+    return pImpl->connected;
+}
+
+bool DoIPClient::activateRouting() {
+    auto logger = Logger::getInstance();
+    if (!pImpl->connected) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> exchange(pImpl->diagnosticMutex);
+    uint8_t request[ROUTING_REQUEST_SIZE] = {};
+    putU16(request, pImpl->config.testerAddress);
+    request[2] = pImpl->config.activationType;
+
+    pImpl->beginControl(DoIPPayloadType::ROUTING_ACTIVATION_RESPONSE);
+    if (!pImpl->send(DoIPPayloadType::ROUTING_ACTIVATION_REQUEST, request, sizeof(request), nullptr, 0)) {
+        logger->error("Failed to send DoIP routing activation request");
+        return false;
+    }
+
+    if (!pImpl->awaitControl(pImpl->config.controlTimeout)) {
+        logger->error("DoIP routing activation failed: " +
+                      doipRoutingCodeToString(static_cast<DoIPRoutingCode>(pImpl->lastResponseCode.load())));
+        return false;
+    }
+
+    pImpl->routingActive = true;
+    std::ostringstream ss;
+    ss << "DoIP routing active, entity address 0x" << std::hex << std::setw(4) << std::setfill('0')
+       << pImpl->entityAddress.load();
+    logger->info(ss.str());
+    return true;
+}
+
+bool DoIPClient::isRoutingActive() const {
+    return pImpl->routingActive;
+}
+
+uint16_t DoIPClient::getEntityAddress() const {
+    return pImpl->entityAddress;
+}
+
+bool DoIPClient::sendDiagnosticMessage(uint16_t targetAddress, const uint8_t* data, size_t length) {
+    if (!pImpl->routingActive) {
+        Logger::getInstance()->error("DoIP routing is not active");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> exchange(pImpl->diagnosticMutex);
+    uint8_t addresses[DIAGNOSTIC_ADDRESS_SIZE];
+    putU16(addresses, pImpl->config.testerAddress);
+    putU16(addresses + 2, targetAddress);
+
+    pImpl->beginControl(DoIPPayloadType::DIAGNOSTIC_ACK);
+    if (!pImpl->send(DoIPPayloadType::DIAGNOSTIC_MESSAGE, addresses, sizeof(addresses), data, length)) {
+        Logger::getInstance()->error("Failed to send DoIP diagnostic message");
+        return false;
+    }
+
+    if (!pImpl->awaitControl(pImpl->config.diagnosticAckTimeout)) {
+        std::ostringstream ss;
+        ss << "DoIP diagnostic message to 0x" << std::hex << targetAddress << " not acknowledged, code 0x"
+           << static_cast<int>(pImpl->lastResponseCode.load());
+        Logger::getInstance()->warning(ss.str());
+        return false;
+    }
+    return true;
+}
+
+bool DoIPClient::sendDiagnosticMessage(uint16_t targetAddress, const std::vector<uint8_t>& data) {
+    return sendDiagnosticMessage(targetAddress, data.data(), data.size());
+}
+
+void DoIPClient::setDiagnosticHandler(DiagnosticHandler handler) {
+    std::lock_guard<std::mutex> lock(pImpl->handlerMutex);
+    pImpl->handler = std::move(handler);
+}
+
+uint8_t DoIPClient::getLastResponseCode() const {
+    return pImpl->lastResponseCode;
+}
+
+DoIPConfig DoIPClient::getConfiguration() const {
+    return pImpl->config;
+}
+
+DoIPClient::Statistics DoIPClient::getStatistics() const {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    return pImpl->stats;
+}
+
+void DoIPClient::resetStatistics() {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    pImpl->stats = Statistics{};
+    pImpl->stats.startTime = std::chrono::system_clock::now();
+}
+
+std::string DoIPClient::toString() const {
+    Statistics stats = getStatistics();
+    std::ostringstream ss;
+    ss << "DoIPClient[Host:" << (pImpl->host.empty() ? "-" : pImpl->host)
+       << ", Connected:" << (pImpl->connected ? "yes" : "no")
+       << ", Routing:" << (pImpl->routingActive ? "active" : "inactive")
+       << ", Sent:" << stats.messagesSent
+       << ", Received:" << stats.messagesReceived << "]";
+    return ss.str();
+}
+
+// Utility functions
+std::string doipPayloadTypeToString(DoIPPayloadType type) {
+    switch (type) {
+        case DoIPPayloadType::GENERIC_NACK: return "GenericNack";
+        case DoIPPayloadType::VEHICLE_ID_REQUEST: return "VehicleIdentificationRequest";
+        case DoIPPayloadType::VEHICLE_ID_REQUEST_EID: return "VehicleIdentificationRequestEID";
+        case DoIPPayloadType::VEHICLE_ID_REQUEST_VIN: return "VehicleIdentificationRequestVIN";
+        case DoIPPayloadType::VEHICLE_ANNOUNCEMENT: return "VehicleAnnouncement";
+        case DoIPPayloadType::ROUTING_ACTIVATION_REQUEST: return "RoutingActivationRequest";
+        case DoIPPayloadType::ROUTING_ACTIVATION_RESPONSE: return "RoutingActivationResponse";
+        case DoIPPayloadType::ALIVE_CHECK_REQUEST: return "AliveCheckRequest";
+        case DoIPPayloadType::ALIVE_CHECK_RESPONSE: return "AliveCheckResponse";
+        case DoIPPayloadType::ENTITY_STATUS_REQUEST: return "EntityStatusRequest";
+        case DoIPPayloadType::ENTITY_STATUS_RESPONSE: return "EntityStatusResponse";
+        case DoIPPayloadType::POWER_MODE_REQUEST: return "PowerModeRequest";
+        case DoIPPayloadType::POWER_MODE_RESPONSE: return "PowerModeResponse";
+        case DoIPPayloadType::DIAGNOSTIC_MESSAGE: return "DiagnosticMessage";
+        case DoIPPayloadType::DIAGNOSTIC_ACK: return "DiagnosticAck";
+        case DoIPPayloadType::DIAGNOSTIC_NACK: return "DiagnosticNack";
+        default: {
+            std::ostringstream ss;
+            ss << "Unknown(0x" << std::hex << std::setw(4) << std::setfill('0')
+               << static_cast<int>(type) << ")";
+            return ss.str();
+        }
+    }
+}
+
+std::string doipRoutingCodeToString(DoIPRoutingCode code) {
+    switch (code) {
+        case DoIPRoutingCode::DENIED_UNKNOWN_SOURCE: return "DeniedUnknownSourceAddress";
+        case DoIPRoutingCode::DENIED_ALL_SOCKETS_REGISTERED: return "DeniedAllSocketsRegistered";
+        case DoIPRoutingCode::DENIED_SOURCE_MISMATCH: return "DeniedSourceAddressMismatch";
+        case DoIPRoutingCode::DENIED_SOURCE_ALREADY_ACTIVE: return "DeniedSourceAddressAlreadyActive";
+        case DoIPRoutingCode::DENIED_MISSING_AUTHENTICATION: return "DeniedMissingAuthentication";
+        case DoIPRoutingCode::DENIED_REJECTED_CONFIRMATION: return "DeniedRejectedConfirmation";
+        case DoIPRoutingCode::DENIED_UNSUPPORTED_TYPE: return "DeniedUnsupportedActivationType";
+        case DoIPRoutingCode::SUCCESS: return "Success";
+        case DoIPRoutingCode::CONFIRMATION_REQUIRED: return "ConfirmationRequired";
+        default: {
+            std::ostringstream ss;
+            ss << "Unknown(0x" << std::hex << std::setw(2) << std::setfill('0')
+               << static_cast<int>(code) << ")";
+            return ss.str();
+        }
+    }
+}
+
+} // namespace protocols
+} // namespace fmus
@@ -0,0 +1,586 @@
+#include <fmus/protocols/iso9141.h>
+#include <fmus/logger.h>
+#include <fmus/utils.h>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <future>
+
+namespace fmus {
+namespace protocols {
+
+namespace {
+
+constexpr uint8_t RESPONSE_FORMAT = 0x48;
+constexpr uint32_t BITS_PER_BYTE = 10;  // Start, 8 data, stop
+
+std::chrono::microseconds milliseconds(uint32_t ms) {
+    return std::chrono::microseconds(static_cast<int64_t>(ms) * 1000);
+}
+
+} // anonymous namespace
+
+// ISO9141Message implementation
+void ISO9141Message::calculateChecksum() {
+    std::vector<uint8_t> bytes = {format, targetAddress, sourceAddress};
+    bytes.insert(bytes.end(), data.begin(), data.end());
+    checksum = calculateISO9141Checksum(bytes);
+}
+
+bool ISO9141Message::verifyChecksum() const {
+    std::vector<uint8_t> bytes = {format, targetAddress, sourceAddress};
+    bytes.insert(bytes.end(), data.begin(), data.end());
+    return calculateISO9141Checksum(bytes) == checksum;
+}
+
+std::vector<uint8_t> ISO9141Message::toBytes() const {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(data.size() + 4);
+    bytes.push_back(format);
+    bytes.push_back(targetAddress);
+    bytes.push_back(sourceAddress);
+    bytes.insert(bytes.end(), data.begin(), data.end());
+    bytes.push_back(checksum);
+    return bytes;
+}
+
+ISO9141Message ISO9141Message::fromBytes(const std::vector<uint8_t>& bytes) {
+    ISO9141Message message;
+    message.timestamp = std::chrono::system_clock::now();
+
+    if (bytes.size() < 4) {
+        message.data.clear();
+        message.checksum = 0;
+        return message;
+    }
+
+    message.format = bytes[0];
+    message.targetAddress = bytes[1];
+    message.sourceAddress = bytes[2];
+    message.data.assign(bytes.begin() + 3, bytes.end() - 1);
+    message.checksum = bytes.back();
+    message.isResponse = message.format == RESPONSE_FORMAT;
+    return message;
+}
+
+uint8_t ISO9141Message::getLength() const {
+    return static_cast<uint8_t>(data.size() + 4);
+}
+
+std::string ISO9141Message::toString() const {
+    std::ostringstream ss;
+    ss << "ISO9141[" << (isResponse ? "RSP" : "REQ")
+       << " Hdr:" << std::hex << std::uppercase << std::setfill('0')
+       << std::setw(2) << static_cast<int>(format) << " "
+       << std::setw(2) << static_cast<int>(targetAddress) << " "
+       << std::setw(2) << static_cast<int>(sourceAddress) << std::dec;
+    if (!data.empty()) {
+        ss << " DATA:" << utils::bytesToHex(data);
+    }
+    ss << "]";
+    return ss.str();
+}
+
+bool ISO9141Message::isValid() const {
+    return !data.empty() && data.size() <= 7 && verifyChecksum();
+}
+
+// ISO9141Config implementation
+std::string ISO9141Config::toString() const {
+    std::ostringstream ss;
+    ss << "ISO9141Config[Baud:" << baudRate
+       << ", Timeout:" << timeout << "ms"
+       << ", P1max:" << p1Max << "ms"
+       << ", P2:" << p2Min << "-" << p2Max << "ms"
+       << ", P3min:" << p3Min << "ms"
+       << ", P4min:" << p4Min << "ms"
+       << ", Checksum:" << (useChecksum ? "on" : "off");
+    if (timingCpuCore >= 0) {
+        ss << ", Core:" << timingCpuCore;
+    }
+    ss << "]";
+    return ss.str();
+}
+
+std::string ISO9141InitSequence::toString() const {
+    std::ostringstream ss;
+    ss << "ISO9141Init[" << (fastInit ? "Fast" : std::to_string(initBaudRate) + "-baud")
+       << ", Bytes:" << utils::bytesToHex(initBytes)
+       << ", Sync:0x" << std::hex << syncPattern << "]";
+    return ss.str();
+}
+
+// ISO9141Protocol implementation
+class ISO9141Protocol::Impl {
+public:
+    ISO9141Config config;
+    std::shared_ptr<j2534::PassThruChannel> channel;
+    std::unique_ptr<TimingEngine> timing;
+    std::atomic<bool> initialized{false};
+
+    std::thread reader;
+    std::atomic<bool> readerRunning{false};
+
+    // Requests are written by one thread so its waits can run on a pinned core
+    struct PendingWrite {
+        std::vector<uint8_t> frame;
+        std::promise<bool> written;
+    };
+    std::thread writer;
+    bool writerRunning = false;
+    std::mutex writeMutex;
+    std::condition_variable writeCondition;
+    std::deque<PendingWrite> writes;
+
+    // End of the last bus activity in host time; the next request waits P3min from here.
+    // Also guards the adapter timestamps below.
+    std::mutex busMutex;
+    std::chrono::steady_clock::time_point lastBusActivity;
+
+    // Adapter timestamps (microseconds, wrapping) for measuring P2 and P3 on the bus
+    bool haveResponseEnd = false;
+    uint32_t responseEnd = 0;
+    bool awaitingFirstResponse = false;
+    uint32_t requestEnd = 0;
+
+    std::mutex transactionMutex;
+    std::mutex responseMutex;
+    std::condition_variable responseCondition;
+    std::deque<ISO9141Message> responses;
+    bool awaitingResponse = false;
+
+    std::function<void(const ISO9141Message&)> monitorCallback;
+    std::mutex monitorMutex;
+    std::atomic<bool> monitoring{false};
+
+    Statistics stats;
+    mutable std::mutex statsMutex;
+
+    Impl() {
+        stats.startTime = std::chrono::system_clock::now();
+    }
+
+    uint32_t frameDuration(size_t bytes) const {
+        uint32_t baud = config.baudRate ? config.baudRate : 10400;
+        return static_cast<uint32_t>(bytes * BITS_PER_BYTE * 1000000ULL / baud);
+    }
+
+    void configureTiming() {
+        TimingEngine::Config engineConfig;
+        engineConfig.cpuCore = config.timingCpuCore;
+        timing = std::make_unique<TimingEngine>(engineConfig);
+        timing->setLimits(TimingParameter::P1, {std::chrono::microseconds(0), milliseconds(config.p1Max)});
+        timing->setLimits(TimingParameter::P2, {milliseconds(config.p2Min), milliseconds(config.p2Max)});
+        timing->setLimits(TimingParameter::P3, {milliseconds(config.p3Min), std::chrono::microseconds(0)});
+        timing->setLimits(TimingParameter::P4, {milliseconds(config.p4Min), std::chrono::microseconds(0)});
+    }
+
+    void recordTiming(TimingParameter parameter, uint32_t microseconds) {
+        if (!timing->record(parameter, std::chrono::microseconds(microseconds))) {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.timingViolations++;
+        }
+    }
+
+    void markBusActivity() {
+        std::lock_guard<std::mutex> lock(busMutex);
+        lastBusActivity = std::chrono::steady_clock::now();
+    }
+
+    void onFrame(const j2534::Message& frame) {
+        if (frame.flags & j2534::J2534Constants::START_OF_MESSAGE) {
+            return;
+        }
+
+        if (frame.flags & j2534::J2534Constants::TX_MSG_TYPE) {
+            // Echo of our request: the timestamp marks its last byte on the bus
+            uint32_t requestStart = frame.timestamp - frameDuration(frame.data.size());
+            std::lock_guard<std::mutex> lock(busMutex);
+            if (haveResponseEnd) {
+                recordTiming(TimingParameter::P3, requestStart - responseEnd);
+            }
+            requestEnd = frame.timestamp;
+            awaitingFirstResponse = true;
+            return;
+        }
+
+        if (frame.data.empty()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(busMutex);
+            lastBusActivity = std::chrono::steady_clock::now();
+            if (awaitingFirstResponse) {
+                uint32_t responseStart = frame.timestamp - frameDuration(frame.data.size());
+                recordTiming(TimingParameter::P2, responseStart - requestEnd);
+                awaitingFirstResponse = false;
+            }
+            responseEnd = frame.timestamp;
+            haveResponseEnd = true;
+        }
+
+        ISO9141Message message = ISO9141Message::fromBytes(frame.data);
+        if (config.useChecksum && !message.verifyChecksum()) {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.checksumErrors++;
+            Logger::getInstance()->debug("ISO9141 checksum error: " + utils::bytesToHex(frame.data));
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.messagesReceived++;
+        }
+
+        if (monitoring) {
+            std::lock_guard<std::mutex> lock(monitorMutex);
+            if (monitorCallback) {
+                monitorCallback(message);
+            }
+        }
+
+        if (message.isResponse) {
+            std::lock_guard<std::mutex> lock(responseMutex);
+            if (awaitingResponse) {
+                responses.push_back(message);
+                responseCondition.notify_one();
+            }
+        }
+    }
+
+    void readLoop() {
+        std::vector<j2534::Message> frames;
+        while (readerRunning) {
+            frames.clear();
+            try {
+                channel->readMessages(frames, 16, 50);
+            } catch (const j2534::J2534Error& e) {
+                Logger::getInstance()->warning(std::string("ISO9141 read failed: ") + e.what());
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                continue;
+            }
+            for (const auto& frame : frames) {
+                onFrame(frame);
+            }
+        }
+    }
+
+    void writeLoop() {
+        timing->pinCurrentThread();
+
+        std::unique_lock<std::mutex> lock(writeMutex);
+        for (;;) {
+            writeCondition.wait(lock, [this] { return !writes.empty() || !writerRunning; });
+            if (writes.empty()) {
+                return;
+            }
+            PendingWrite pending = std::move(writes.front());
+            writes.pop_front();
+            lock.unlock();
+
+            std::chrono::steady_clock::time_point deadline;
+            {
+                std::lock_guard<std::mutex> busLock(busMutex);
+                deadline = lastBusActivity + milliseconds(config.p3Min);
+            }
+            timing->sleepUntil(deadline);
+
+            bool written = false;
+            try {
+                written = channel->writeMessage(
+                    j2534::Message(j2534::Protocol::ISO9141, 0, pending.frame), config.timeout);
+            } catch (const j2534::J2534Error& e) {
+                Logger::getInstance()->error(std::string("ISO9141 write failed: ") + e.what());
+            }
+            markBusActivity();
+            pending.written.set_value(written);
+
+            lock.lock();
+        }
+    }
+
+    void startThreads() {
+        markBusActivity();
+        readerRunning = true;
+        reader = std::thread([this] { readLoop(); });
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            writerRunning = true;
+        }
+        writer = std::thread([this] { writeLoop(); });
+    }
+
+    void stopThreads() {
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            writerRunning = false;
+        }
+        writeCondition.notify_all();
+        if (writer.joinable()) {
+            writer.join();
+        }
+        readerRunning = false;
+        if (reader.joinable()) {
+            reader.join();
+        }
+        for (auto& pending : writes) {
+            pending.written.set_value(false);
+        }
+        writes.clear();
+    }
+
+    bool transmit(const ISO9141Message& message) {
+        ISO9141Message outgoing = message;
+        if (config.useChecksum) {
+            outgoing.calculateChecksum();
+        }
+        std::vector<uint8_t> frame = outgoing.toBytes();
+        if (!config.useChecksum) {
+            frame.pop_back();   // The adapter appends it
+        }
+
+        PendingWrite pending;
+        pending.frame = std::move(frame);
+        std::future<bool> written = pending.written.get_future();
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            if (!writerRunning) {
+                return false;
+            }
+            writes.push_back(std::move(pending));
+        }
+        writeCondition.notify_one();
+
+        if (!written.get()) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.messagesSent++;
+        return true;
+    }
+};
+
+ISO9141Protocol::ISO9141Protocol() : pImpl(std::make_unique<Impl>()) {}
+
+ISO9141Protocol::~ISO9141Protocol() {
+    shutdown();
+}
+
+bool ISO9141Protocol::initialize(const ISO9141Config& config) {
+    pImpl->config = config;
+    Logger::getInstance()->error("ISO9141 needs a J2534 channel to drive the K-line");
+    return false;
+}
+
+bool ISO9141Protocol::initialize(const ISO9141Config& config, std::shared_ptr<j2534::PassThruChannel> channel) {
+    auto logger = Logger::getInstance();
+    logger->info("Initializing ISO9141 protocol: " + config.toString());
+
+    if (!channel || !channel->isConnected() || channel->getProtocol() != j2534::Protocol::ISO9141) {
+        logger->error("ISO9141 requires a connected ISO9141 channel");
+        return false;
+    }
+
+    shutdown();
+    pImpl->config = config;
+    pImpl->channel = channel;
+    pImpl->configureTiming();
+
+    try {
+        // P3min is held by the host; the adapter only keeps the byte-level limits
+        channel->setConfig({
+            {j2534::J2534Constants::LOOPBACK, 1},
+            {j2534::J2534Constants::P1_MAX, config.p1Max * 2},
+            {j2534::J2534Constants::P3_MIN, 0},
+            {j2534::J2534Constants::P4_MIN, config.p4Min * 2},
+        });
+        channel->startPassAllFilter();
+    } catch (const j2534::J2534Error& e) {
+        logger->error(std::string("Failed to apply ISO9141 timing: ") + e.what());
+        return false;
+    }
+
+    pImpl->startThreads();
+    pImpl->initialized = true;
+    return true;
+}
+
+void ISO9141Protocol::shutdown() {
+    if (!pImpl->initialized.exchange(false)) {
+        return;
+    }
+    pImpl->stopThreads();
+    pImpl->monitoring = false;
+    Logger::getInstance()->info("ISO9141 protocol shutdown");
+}
+
+bool ISO9141Protocol::isInitialized() const {
+    return pImpl->initialized;
+}
+
+bool ISO9141Protocol::performInit(const ISO9141InitSequence& initSeq) {
+    if (!pImpl->initialized) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+        pImpl->stats.initAttempts++;
+    }
+
+    if (initSeq.fastInit) {
+        Logger::getInstance()->error("ISO 9141 has no fast initialization; use KWP2000 for ISO 14230");
+        return false;
+    }
+
+    uint8_t address = initSeq.initBytes.empty() ? 0x33 : initSeq.initBytes[0];
+    std::lock_guard<std::mutex> transaction(pImpl->transactionMutex);
+    try {
+        pImpl->channel->clearReceiveBuffer();
+        auto keyBytes = pImpl->channel->fiveBaudInit(address);
+        if (keyBytes.size() < 2) {
+            Logger::getInstance()->error("5-baud init returned no key bytes");
+            return false;
+        }
+        std::ostringstream ss;
+        ss << "ISO9141 initialized, key bytes 0x" << std::hex << std::setw(2) << std::setfill('0')
+           << static_cast<int>(keyBytes[0]) << " 0x" << std::setw(2) << static_cast<int>(keyBytes[1]);
+        Logger::getInstance()->info(ss.str());
+    } catch (const j2534::J2534Error& e) {
+        Logger::getInstance()->error(std::string("ISO9141 5-baud init failed: ") + e.what());
+        return false;
+    }
+
+    // The inverted address ends the init; the first request follows after P3min
+    {
+        std::lock_guard<std::mutex> lock(pImpl->busMutex);
+        pImpl->lastBusActivity = std::chrono::steady_clock::now();
+        pImpl->haveResponseEnd = false;
+        pImpl->awaitingFirstResponse = false;
+    }
+
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    pImpl->stats.initSuccesses++;
+    return true;
+}
+
+bool ISO9141Protocol::sendMessage(const ISO9141Message& message) {
+    if (!pImpl->initialized) {
+        return false;
+    }
+    return pImpl->transmit(message);
+}
+
+ISO9141Message ISO9141Protocol::sendRequest(const ISO9141Message& request) {
+    auto logger = Logger::getInstance();
+    if (!pImpl->initialized) {
+        return ISO9141Message{};
+    }
+
+    std::lock_guard<std::mutex> transaction(pImpl->transactionMutex);
+    {
+        std::lock_guard<std::mutex> lock(pImpl->responseMutex);
+        pImpl->responses.clear();
+        pImpl->awaitingResponse = true;
+    }
+
+    logger->debug("Sending ISO9141 request: " + request.toString());
+    if (!pImpl->transmit(request)) {
+        std::lock_guard<std::mutex> lock(pImpl->responseMutex);
+        pImpl->awaitingResponse = false;
+        logger->error("Failed to send ISO9141 request");
+        return ISO9141Message{};
+    }
+
+    auto sent = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(pImpl->responseMutex);
+    bool received = pImpl->responseCondition.wait_for(lock, std::chrono::milliseconds(pImpl->config.timeout),
+                                                      [this] { return !pImpl->responses.empty(); });
+    pImpl->awaitingResponse = false;
+    if (!received) {
+        lock.unlock();
+        logger->warning("ISO9141 request timeout: " + request.toString());
+        std::lock_guard<std::mutex> statsLock(pImpl->statsMutex);
+        pImpl->stats.timeouts++;
+        return ISO9141Message{};
+    }
+
+    ISO9141Message response = pImpl->responses.front();
+    pImpl->responses.pop_front();
+    lock.unlock();
+
+    std::lock_guard<std::mutex> statsLock(pImpl->statsMutex);
+    pImpl->stats.lastResponseTime = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - sent);
+    return response;
+}
+
+bool ISO9141Protocol::startMonitoring(std::function<void(const ISO9141Message&)> callback) {
+    if (!pImpl->initialized) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(pImpl->monitorMutex);
+    pImpl->monitorCallback = std::move(callback);
+    pImpl->monitoring = true;
+    return true;
+}
+
+void ISO9141Protocol::stopMonitoring() {
+    std::lock_guard<std::mutex> lock(pImpl->monitorMutex);
+    pImpl->monitoring = false;
+    pImpl->monitorCallback = nullptr;
+}
+
+bool ISO9141Protocol::isMonitoring() const {
+    return pImpl->monitoring;
+}
+
+ISO9141Protocol::Statistics ISO9141Protocol::getStatistics() const {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    return pImpl->stats;
+}
+
+void ISO9141Protocol::resetStatistics() {
+    {
+        std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+        pImpl->stats = Statistics{};
+        pImpl->stats.startTime = std::chrono::system_clock::now();
+    }
+    if (pImpl->timing) {
+        pImpl->timing->resetStatistics();
+    }
+}
+
+TimingEngine::Statistics ISO9141Protocol::getTimingStatistics() const {
+    return pImpl->timing ? pImpl->timing->getStatistics() : TimingEngine::Statistics{};
+}
+
+ISO9141Config ISO9141Protocol::getConfiguration() const {
+    return pImpl->config;
+}
+
+// Utility functions
+uint8_t calculateISO9141Checksum(const std::vector<uint8_t>& data) {
+    uint8_t sum = 0;
+    for (uint8_t byte : data) {
+        sum = static_cast<uint8_t>(sum + byte);
+    }
+    return sum;
+}
+
+bool isValidISO9141Address(uint8_t address) {
+    // 7-bit address; the parity bit is added when it is clocked out at 5 baud
+    return address != 0x00 && address < 0x80;
+}
+
+std::vector<uint8_t> createISO9141InitSequence(uint8_t ecuAddress) {
+    // Address sent at 5 baud, followed by the sync byte the ECU answers with
+    return {ecuAddress, 0x55};
+}
+
+} // namespace protocols
+} // namespace fmus
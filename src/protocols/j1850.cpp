@@ -0,0 +1,555 @@
+#include <fmus/protocols/j1850.h>
+#include <fmus/logger.h>
+#include <fmus/utils.h>
+#include <array>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+
+namespace fmus {
+namespace protocols {
+
+namespace {
+
+constexpr uint8_t CRC_POLYNOMIAL = 0x1D;
+constexpr uint8_t NEGATIVE_RESPONSE_SID = 0x7F;
+constexpr uint8_t REQUEST_HIGH_SPEED = 0xA0;
+constexpr uint8_t BEGIN_HIGH_SPEED = 0xA1;
+constexpr uint32_t VPW_NORMAL_RATE = 10400;
+constexpr uint32_t VPW_HIGH_SPEED_RATE = 41600;
+constexpr size_t MAX_DATA_BYTES = 7;
+
+// Header byte fields
+constexpr uint8_t HEADER_NO_IFR = 0x08;         // K: no in-frame response
+constexpr uint8_t HEADER_PHYSICAL = 0x04;       // Y: physical addressing
+constexpr uint8_t HEADER_PWM_FUNCTIONAL = 0x01; // ZZ: functional message type on PWM
+
+constexpr std::array<uint8_t, 256> makeCRCTable() {
+    std::array<uint8_t, 256> table{};
+    for (int i = 0; i < 256; ++i) {
+        uint8_t crc = static_cast<uint8_t>(i);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ CRC_POLYNOMIAL)
+                               : static_cast<uint8_t>(crc << 1);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> CRC_TABLE = makeCRCTable();
+
+uint8_t crcOf(const uint8_t* data, size_t length) {
+    uint8_t crc = 0xFF;
+    for (size_t i = 0; i < length; ++i) {
+        crc = CRC_TABLE[crc ^ data[i]];
+    }
+    return static_cast<uint8_t>(crc ^ 0xFF);
+}
+
+bool answers(const J1850Message& response, uint8_t requestSid) {
+    if (response.data.empty()) {
+        return false;
+    }
+    if (response.data[0] == NEGATIVE_RESPONSE_SID) {
+        return response.data.size() >= 2 && response.data[1] == requestSid;
+    }
+    return response.data[0] == static_cast<uint8_t>(requestSid + 0x40);
+}
+
+} // anonymous namespace
+
+// J1850Message implementation
+uint8_t J1850Message::getHeaderByte() const {
+    if (receivedHeader) {
+        return *receivedHeader;
+    }
+    uint8_t header = static_cast<uint8_t>((static_cast<uint8_t>(priority) & 0x07) << 5);
+    bool functional = isFunctional();
+
+    if (type == J1850Type::VPW) {
+        header |= HEADER_NO_IFR;
+        if (!functional) {
+            header |= HEADER_PHYSICAL;
+        }
+    } else {
+        header |= functional ? HEADER_PWM_FUNCTIONAL : HEADER_PHYSICAL;
+    }
+    return header;
+}
+
+bool J1850Message::isFunctional() const {
+    return targetAddress == J1850_FUNCTIONAL_REQUEST || targetAddress == J1850_FUNCTIONAL_RESPONSE;
+}
+
+void J1850Message::calculateChecksum() {
+    std::vector<uint8_t> bytes = toBytes();
+    bytes.pop_back();
+    checksum = calculateJ1850Checksum(bytes);
+}
+
+bool J1850Message::verifyChecksum() const {
+    std::vector<uint8_t> bytes = toBytes();
+    bytes.pop_back();
+    return calculateJ1850Checksum(bytes) == checksum;
+}
+
+std::vector<uint8_t> J1850Message::toBytes() const {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(data.size() + 4);
+    bytes.push_back(getHeaderByte());
+    bytes.push_back(targetAddress);
+    bytes.push_back(sourceAddress);
+    bytes.insert(bytes.end(), data.begin(), data.end());
+    bytes.push_back(checksum);
+    return bytes;
+}
+
+J1850Message J1850Message::fromBytes(const std::vector<uint8_t>& bytes) {
+    J1850Message message;
+    message.timestamp = std::chrono::system_clock::now();
+
+    if (bytes.size() < 4) {
+        return message;
+    }
+
+    uint8_t header = bytes[0];
+    message.receivedHeader = header;
+    message.priority = static_cast<J1850Priority>(header >> 5);
+    // A PWM header never sets K; VPW frames always do
+    message.type = (header & HEADER_NO_IFR) ? J1850Type::VPW : J1850Type::PWM;
+    message.targetAddress = bytes[1];
+    message.sourceAddress = bytes[2];
+    message.data.assign(bytes.begin() + 3, bytes.end() - 1);
+    message.checksum = bytes.back();
+    message.isResponse = !message.data.empty() && (message.data[0] & 0x40) != 0;
+    return message;
+}
+
+std::string J1850Message::toString() const {
+    std::ostringstream ss;
+    ss << "J1850[" << (isResponse ? "RSP" : "REQ")
+       << " Hdr:" << std::hex << std::uppercase << std::setfill('0')
+       << std::setw(2) << static_cast<int>(getHeaderByte()) << " "
+       << std::setw(2) << static_cast<int>(targetAddress) << " "
+       << std::setw(2) << static_cast<int>(sourceAddress) << std::dec;
+    if (!data.empty()) {
+        ss << " DATA:" << utils::bytesToHex(data);
+    }
+    ss << "]";
+    return ss.str();
+}
+
+bool J1850Message::isValid() const {
+    return !data.empty() && data.size() <= MAX_DATA_BYTES && verifyChecksum();
+}
+
+// J1850Config implementation
+std::string J1850Config::toString() const {
+    std::ostringstream ss;
+    ss << "J1850Config[" << j1850TypeToString(protocolType)
+       << ", Timeout:" << timeout << "ms"
+       << ", Window:" << responseWindow << "ms"
+       << ", Src:0x" << std::hex << static_cast<int>(sourceAddress) << std::dec
+       << ", CRC:" << (useChecksum ? "on" : "off");
+    if (protocolType == J1850Type::VPW && highSpeed) {
+        ss << ", 4x";
+    }
+    ss << "]";
+    return ss.str();
+}
+
+// J1850Protocol implementation
+class J1850Protocol::Impl {
+public:
+    J1850Config config;
+    std::shared_ptr<j2534::PassThruChannel> channel;
+    std::atomic<bool> initialized{false};
+    std::atomic<bool> highSpeed{false};
+
+    std::thread reader;
+    std::atomic<bool> readerRunning{false};
+
+    std::mutex transactionMutex;
+    std::mutex responseMutex;
+    std::condition_variable responseCondition;
+    std::deque<J1850Message> responses;
+    bool awaitingResponse = false;
+
+    std::function<void(const J1850Message&)> monitorCallback;
+    std::mutex monitorMutex;
+    std::atomic<bool> monitoring{false};
+
+    Statistics stats;
+    mutable std::mutex statsMutex;
+
+    Impl() {
+        stats.startTime = std::chrono::system_clock::now();
+    }
+
+    j2534::Protocol channelProtocol() const {
+        return config.protocolType == J1850Type::VPW ? j2534::Protocol::J1850VPW : j2534::Protocol::J1850PWM;
+    }
+
+    void onFrame(const j2534::Message& frame) {
+        if (frame.flags & (j2534::J2534Constants::TX_MSG_TYPE | j2534::J2534Constants::START_OF_MESSAGE)) {
+            return;
+        }
+        if (frame.data.size() < 3) {
+            return;
+        }
+
+        // The adapter has already checked and removed the CRC
+        std::vector<uint8_t> bytes = frame.data;
+        bytes.push_back(calculateJ1850Checksum(frame.data));
+        J1850Message message = J1850Message::fromBytes(bytes);
+        message.type = config.protocolType;
+
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.messagesReceived++;
+        }
+
+        if (monitoring) {
+            std::lock_guard<std::mutex> lock(monitorMutex);
+            if (monitorCallback) {
+                monitorCallback(message);
+            }
+        }
+
+        if (message.isResponse) {
+            std::lock_guard<std::mutex> lock(responseMutex);
+            if (awaitingResponse) {
+                responses.push_back(message);
+                responseCondition.notify_one();
+            }
+        }
+    }
+
+    void readLoop() {
+        std::vector<j2534::Message> frames;
+        while (readerRunning) {
+            frames.clear();
+            try {
+                channel->readMessages(frames, 16, 50);
+            } catch (const j2534::J2534Error& e) {
+                Logger::getInstance()->warning(std::string("J1850 read failed: ") + e.what());
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                continue;
+            }
+            for (const auto& frame : frames) {
+                onFrame(frame);
+            }
+        }
+    }
+
+    bool transmit(const J1850Message& message) {
+        if (message.data.empty() || message.data.size() > MAX_DATA_BYTES) {
+            Logger::getInstance()->error("J1850 frames carry 1 to 7 data bytes: " + message.toString());
+            return false;
+        }
+
+        J1850Message outgoing = message;
+        outgoing.type = config.protocolType;
+        std::vector<uint8_t> frame = outgoing.toBytes();
+        frame.pop_back();   // The adapter appends the CRC
+
+        try {
+            if (!channel->writeMessage(j2534::Message(channelProtocol(), 0, frame), config.timeout)) {
+                return false;
+            }
+        } catch (const j2534::J2534Error& e) {
+            Logger::getInstance()->error(std::string("J1850 write failed: ") + e.what());
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.messagesSent++;
+        return true;
+    }
+
+    /**
+     * Send a request and gather responses answering it. With collectAll the
+     * window restarts on every response; otherwise the first one ends it.
+     * Caller holds transactionMutex.
+     */
+    std::vector<J1850Message> collect(const J1850Message& request, bool collectAll) {
+        std::vector<J1850Message> collected;
+        uint8_t requestSid = request.data.empty() ? 0 : request.data[0];
+
+        {
+            std::lock_guard<std::mutex> lock(responseMutex);
+            responses.clear();
+            awaitingResponse = true;
+        }
+
+        if (!transmit(request)) {
+            std::lock_guard<std::mutex> lock(responseMutex);
+            awaitingResponse = false;
+            return collected;
+        }
+
+        auto overall = std::chrono::steady_clock::now() + std::chrono::milliseconds(config.timeout);
+        auto deadline = overall;
+
+        std::unique_lock<std::mutex> lock(responseMutex);
+        while (responseCondition.wait_until(lock, deadline, [this] { return !responses.empty(); })) {
+            J1850Message response = responses.front();
+            responses.pop_front();
+            if (!answers(response, requestSid)) {
+                continue;
+            }
+            if (!request.isFunctional() && request.targetAddress != J1850_BROADCAST &&
+                response.sourceAddress != request.targetAddress) {
+                continue;
+            }
+
+            if (response.data[0] == NEGATIVE_RESPONSE_SID) {
+                std::lock_guard<std::mutex> statsLock(statsMutex);
+                stats.negativeResponses++;
+            }
+            collected.push_back(response);
+            if (!collectAll) {
+                break;
+            }
+            deadline = std::min(overall, std::chrono::steady_clock::now() +
+                                         std::chrono::milliseconds(config.responseWindow));
+        }
+        awaitingResponse = false;
+        lock.unlock();
+
+        if (collected.empty()) {
+            std::lock_guard<std::mutex> statsLock(statsMutex);
+            stats.timeouts++;
+        }
+        return collected;
+    }
+
+    bool switchToHighSpeed() {
+        auto logger = Logger::getInstance();
+        if (config.protocolType != J1850Type::VPW) {
+            logger->error("4x mode only exists on J1850 VPW");
+            return false;
+        }
+        if (highSpeed) {
+            return true;
+        }
+
+        std::lock_guard<std::mutex> transaction(transactionMutex);
+
+        J1850Message query(config.sourceAddress, J1850_BROADCAST, {REQUEST_HIGH_SPEED});
+        for (const auto& reply : collect(query, true)) {
+            if (reply.data[0] == NEGATIVE_RESPONSE_SID) {
+                std::ostringstream ss;
+                ss << "Node 0x" << std::hex << static_cast<int>(reply.sourceAddress) << " refused 4x mode";
+                logger->warning(ss.str());
+                return false;
+            }
+        }
+
+        try {
+            J1850Message begin(config.sourceAddress, J1850_BROADCAST, {BEGIN_HIGH_SPEED});
+            if (!transmit(begin)) {
+                return false;
+            }
+            channel->setConfig(j2534::J2534Constants::DATA_RATE, VPW_HIGH_SPEED_RATE);
+        } catch (const j2534::J2534Error& e) {
+            // Nodes may already have switched; they fall back to 1x when the bus goes idle
+            logger->error(std::string("Adapter does not support 4x VPW: ") + e.what());
+            return false;
+        }
+
+        highSpeed = true;
+        logger->info("J1850 VPW switched to 4x mode");
+        return true;
+    }
+};
+
+J1850Protocol::J1850Protocol() : pImpl(std::make_unique<Impl>()) {}
+
+J1850Protocol::~J1850Protocol() {
+    shutdown();
+}
+
+bool J1850Protocol::initialize(const J1850Config& config) {
+    pImpl->config = config;
+    Logger::getInstance()->error("J1850 needs a J2534 channel to drive the bus");
+    return false;
+}
+
+bool J1850Protocol::initialize(const J1850Config& config, std::shared_ptr<j2534::PassThruChannel> channel) {
+    auto logger = Logger::getInstance();
+    logger->info("Initializing J1850 protocol: " + config.toString());
+
+    shutdown();
+    pImpl->config = config;
+
+    if (!channel || !channel->isConnected() || channel->getProtocol() != pImpl->channelProtocol()) {
+        logger->error("J1850 requires a connected " + j1850TypeToString(config.protocolType) + " channel");
+        return false;
+    }
+    pImpl->channel = channel;
+    pImpl->highSpeed = config.protocolType == J1850Type::VPW && channel->getBaudRate() == VPW_HIGH_SPEED_RATE;
+
+    try {
+        channel->setConfig(j2534::J2534Constants::LOOPBACK, 0);
+        channel->startPassAllFilter();
+    } catch (const j2534::J2534Error& e) {
+        logger->error(std::string("Failed to configure J1850 channel: ") + e.what());
+        return false;
+    }
+
+    pImpl->readerRunning = true;
+    pImpl->reader = std::thread([this] { pImpl->readLoop(); });
+    pImpl->initialized = true;
+
+    if (config.highSpeed && config.protocolType == J1850Type::VPW && !pImpl->switchToHighSpeed()) {
+        logger->warning("Continuing J1850 VPW at 1x");
+    }
+    return true;
+}
+
+void J1850Protocol::shutdown() {
+    if (!pImpl->initialized.exchange(false)) {
+        return;
+    }
+
+    pImpl->readerRunning = false;
+    if (pImpl->reader.joinable()) {
+        pImpl->reader.join();
+    }
+
+    // Return the bus to normal speed for whoever uses it next
+    if (pImpl->highSpeed.exchange(false)) {
+        try {
+            pImpl->channel->setConfig(j2534::J2534Constants::DATA_RATE, VPW_NORMAL_RATE);
+        } catch (const j2534::J2534Error& e) {
+            Logger::getInstance()->warning(std::string("Failed to restore 1x VPW: ") + e.what());
+        }
+    }
+    pImpl->monitoring = false;
+    Logger::getInstance()->info("J1850 protocol shutdown");
+}
+
+bool J1850Protocol::isInitialized() const {
+    return pImpl->initialized;
+}
+
+bool J1850Protocol::sendMessage(const J1850Message& message) {
+    if (!pImpl->initialized) {
+        return false;
+    }
+    return pImpl->transmit(message);
+}
+
+J1850Message J1850Protocol::sendRequest(const J1850Message& request) {
+    if (!pImpl->initialized) {
+        return J1850Message{};
+    }
+
+    std::lock_guard<std::mutex> transaction(pImpl->transactionMutex);
+    Logger::getInstance()->debug("Sending J1850 request: " + request.toString());
+    auto responses = pImpl->collect(request, false);
+    if (responses.empty()) {
+        Logger::getInstance()->warning("J1850 request timeout: " + request.toString());
+        return J1850Message{};
+    }
+    return responses.front();
+}
+
+std::vector<J1850Message> J1850Protocol::sendFunctionalRequest(const J1850Message& request) {
+    if (!pImpl->initialized) {
+        return {};
+    }
+
+    std::lock_guard<std::mutex> transaction(pImpl->transactionMutex);
+    {
+        std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+        pImpl->stats.functionalRequests++;
+    }
+    auto responses = pImpl->collect(request, true);
+    Logger::getInstance()->debug("J1850 functional request " + request.toString() + " answered by " +
+                                 std::to_string(responses.size()) + " node(s)");
+    return responses;
+}
+
+bool J1850Protocol::enableHighSpeedMode() {
+    if (!pImpl->initialized) {
+        return false;
+    }
+    return pImpl->switchToHighSpeed();
+}
+
+bool J1850Protocol::isHighSpeedMode() const {
+    return pImpl->highSpeed;
+}
+
+bool J1850Protocol::startMonitoring(std::function<void(const J1850Message&)> callback) {
+    if (!pImpl->initialized) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(pImpl->monitorMutex);
+    pImpl->monitorCallback = std::move(callback);
+    pImpl->monitoring = true;
+    return true;
+}
+
+void J1850Protocol::stopMonitoring() {
+    std::lock_guard<std::mutex> lock(pImpl->monitorMutex);
+    pImpl->monitoring = false;
+    pImpl->monitorCallback = nullptr;
+}
+
+bool J1850Protocol::isMonitoring() const {
+    return pImpl->monitoring;
+}
+
+J1850Protocol::Statistics J1850Protocol::getStatistics() const {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    return pImpl->stats;
+}
+
+void J1850Protocol::resetStatistics() {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    pImpl->stats = Statistics{};
+    pImpl->stats.startTime = std::chrono::system_clock::now();
+}
+
+J1850Config J1850Protocol::getConfiguration() const {
+    return pImpl->config;
+}
+
+// Utility functions
+std::string j1850TypeToString(J1850Type type) {
+    switch (type) {
+        case J1850Type::VPW: return "J1850VPW";
+        case J1850Type::PWM: return "J1850PWM";
+        default: return "Unknown";
+    }
+}
+
+std::string j1850PriorityToString(J1850Priority priority) {
+    switch (priority) {
+        case J1850Priority::HIGHEST: return "Highest";
+        case J1850Priority::HIGH: return "High";
+        case J1850Priority::MEDIUM: return "Medium";
+        case J1850Priority::LOW: return "Low";
+        default: return "Priority" + std::to_string(static_cast<int>(priority));
+    }
+}
+
+uint8_t calculateJ1850Checksum(const std::vector<uint8_t>& data) {
+    // CRC-8 SAE J1850: polynomial 0x1D, initial value 0xFF, final XOR 0xFF
+    return crcOf(data.data(), data.size());
+}
+
+bool isValidJ1850Address(uint8_t address) {
+    return address != 0x00 && address != 0xFF;
+}
+
+} // namespace protocols
+} // namespace fmus
@@ -0,0 +1,1046 @@
+#include <fmus/protocols/j1939.h>
+#include <fmus/protocols/timing_engine.h>
+#include <fmus/logger.h>
+#include <fmus/utils.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace fmus {
+namespace protocols {
+
+namespace {
+
+// TP.CM control bytes
+constexpr uint8_t TP_CM_RTS = 16;
+constexpr uint8_t TP_CM_CTS = 17;
+constexpr uint8_t TP_CM_EOMA = 19;
+constexpr uint8_t TP_CM_BAM = 32;
+constexpr uint8_t TP_CM_ABORT = 255;
+
+// Abort reasons
+constexpr uint8_t ABORT_RESOURCES = 2;
+constexpr uint8_t ABORT_TIMEOUT = 3;
+constexpr uint8_t ABORT_BAD_SEQUENCE = 7;
+
+constexpr uint8_t TP_PRIORITY = 7;
+constexpr size_t TP_PACKET_DATA = 7;
+constexpr size_t TP_FRAME_SIZE = 8;
+constexpr uint8_t TP_FILL = 0xFF;
+constexpr uint8_t NO_PACKET_LIMIT = 0xFF;
+constexpr size_t PDU_MAX = 8;
+
+// Transport timeouts (J1939-21)
+constexpr std::chrono::milliseconds TP_T1{750};     // Between data packets
+constexpr std::chrono::milliseconds TP_T2{1250};    // From CTS to the first data packet
+constexpr std::chrono::milliseconds TP_T3{1250};    // From the last packet to CTS or EOMA
+constexpr std::chrono::milliseconds TP_T4{1050};    // While the receiver holds the connection
+
+// Addresses an arbitrary-address-capable node may take
+constexpr uint8_t ARBITRARY_FIRST = 128;
+constexpr uint8_t ARBITRARY_LAST = 247;
+
+constexpr uint8_t PDU2_FORMAT = 0xF0;
+
+uint16_t sessionKey(uint8_t source, uint8_t destination) {
+    return static_cast<uint16_t>((source << 8) | destination);
+}
+
+uint32_t readPGN(const uint8_t* bytes) {
+    return bytes[0] | (bytes[1] << 8) | (static_cast<uint32_t>(bytes[2]) << 16);
+}
+
+void appendPGN(std::vector<uint8_t>& data, uint32_t pgn) {
+    data.push_back(static_cast<uint8_t>(pgn));
+    data.push_back(static_cast<uint8_t>(pgn >> 8));
+    data.push_back(static_cast<uint8_t>(pgn >> 16));
+}
+
+std::vector<uint8_t> nameBytes(uint64_t name) {
+    std::vector<uint8_t> bytes(8);
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<uint8_t>(name >> (8 * i));
+    }
+    return bytes;
+}
+
+uint64_t readName(const std::vector<uint8_t>& bytes) {
+    uint64_t name = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        name |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+    }
+    return name;
+}
+
+std::string addressToString(uint8_t address) {
+    return "0x" + utils::bytesToHex(&address, 1);
+}
+
+} // anonymous namespace
+
+std::string J1939Message::toString() const {
+    std::ostringstream ss;
+    ss << "J1939[PGN:0x" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << pgn
+       << " SA:0x" << std::setw(2) << static_cast<int>(source)
+       << " DA:0x" << std::setw(2) << static_cast<int>(destination) << std::dec
+       << " P:" << static_cast<int>(priority)
+       << " DATA:" << utils::bytesToHex(data) << "]";
+    return ss.str();
+}
+
+std::string J1939DTC::toString() const {
+    std::ostringstream ss;
+    ss << "SPN " << spn << " FMI " << static_cast<int>(fmi) << " OC " << static_cast<int>(occurrenceCount);
+    return ss.str();
+}
+
+J1939DiagnosticMessage J1939DiagnosticMessage::fromBytes(const uint8_t* data, size_t length) {
+    J1939DiagnosticMessage message;
+    if (length < 2) {
+        return message;
+    }
+
+    message.lamps.malfunction = (data[0] >> 6) & 0x03;
+    message.lamps.redStop = (data[0] >> 4) & 0x03;
+    message.lamps.amberWarning = (data[0] >> 2) & 0x03;
+    message.lamps.protect = data[0] & 0x03;
+
+    for (size_t i = 2; i + 4 <= length; i += 4) {
+        J1939DTC dtc;
+        dtc.spn = data[i] | (data[i + 1] << 8) | (static_cast<uint32_t>(data[i + 2] & 0xE0) << 11);
+        dtc.fmi = data[i + 2] & 0x1F;
+        dtc.conversionMethod = (data[i + 3] & 0x80) != 0;
+        dtc.occurrenceCount = data[i + 3] & 0x7F;
+
+        // All zeros means no DTC; all ones is padding
+        bool empty = dtc.spn == 0 && dtc.fmi == 0 && dtc.occurrenceCount == 0;
+        bool padding = dtc.spn == 0x7FFFF && dtc.fmi == 0x1F;
+        if (!empty && !padding) {
+            message.dtcs.push_back(dtc);
+        }
+    }
+    return message;
+}
+
+std::string J1939DiagnosticMessage::toString() const {
+    std::ostringstream ss;
+    ss << "J1939DM[MIL:" << static_cast<int>(lamps.malfunction)
+       << ", RSL:" << static_cast<int>(lamps.redStop)
+       << ", AWL:" << static_cast<int>(lamps.amberWarning)
+       << ", PL:" << static_cast<int>(lamps.protect)
+       << ", DTCs:" << dtcs.size();
+    for (const auto& dtc : dtcs) {
+        ss << ", " << dtc.toString();
+    }
+    ss << "]";
+    return ss.str();
+}
+
+// J1939SPNDecoder implementation
+class J1939SPNDecoder::Impl {
+public:
+    struct Extractor {
+        uint32_t spn = 0;
+        uint16_t byteOffset = 0;
+        uint8_t byteCount = 0;
+        uint8_t shift = 0;
+        uint64_t mask = 0;
+        uint64_t validMax = 0;      // Above this are the error and not-available codes
+        double scale = 1.0;
+        double offset = 0.0;
+    };
+
+    std::unordered_map<uint32_t, std::vector<Extractor>> byPGN;
+    std::unordered_map<uint32_t, J1939SPN> definitions;
+
+    static Extractor compile(const J1939SPN& definition) {
+        Extractor extractor;
+        extractor.spn = definition.spn;
+        extractor.byteOffset = definition.startBit / 8;
+        extractor.shift = definition.startBit % 8;
+        extractor.byteCount = static_cast<uint8_t>((extractor.shift + definition.bitLength + 7) / 8);
+        extractor.mask = definition.bitLength == 64 ? ~0ULL : (1ULL << definition.bitLength) - 1;
+
+        // J1939-71: the top values of each range signal error and not available
+        if (definition.bitLength == 1) {
+            extractor.validMax = 1;
+        } else if (definition.bitLength < 8) {
+            extractor.validMax = (1ULL << definition.bitLength) - 3;
+        } else {
+            uint8_t low = definition.bitLength - 8;
+            extractor.validMax = (0xFAULL << low) | ((1ULL << low) - 1);
+        }
+
+        extractor.scale = definition.scale;
+        extractor.offset = definition.offset;
+        return extractor;
+    }
+
+    void erase(uint32_t spn) {
+        auto it = definitions.find(spn);
+        if (it == definitions.end()) {
+            return;
+        }
+        auto group = byPGN.find(it->second.pgn);
+        if (group != byPGN.end()) {
+            auto& extractors = group->second;
+            extractors.erase(std::remove_if(extractors.begin(), extractors.end(),
+                [spn](const Extractor& extractor) { return extractor.spn == spn; }), extractors.end());
+            if (extractors.empty()) {
+                byPGN.erase(group);
+            }
+        }
+        definitions.erase(it);
+    }
+};
+
+J1939SPNDecoder::J1939SPNDecoder() : pImpl(std::make_unique<Impl>()) {}
+
+J1939SPNDecoder::~J1939SPNDecoder() = default;
+
+bool J1939SPNDecoder::addDefinition(const J1939SPN& definition) {
+    if (definition.bitLength == 0 || definition.bitLength > 64 ||
+        definition.startBit % 8 + definition.bitLength > 64) {
+        Logger::getInstance()->error("Invalid J1939 SPN layout for SPN " + std::to_string(definition.spn));
+        return false;
+    }
+    pImpl->erase(definition.spn);
+    pImpl->definitions[definition.spn] = definition;
+    pImpl->byPGN[definition.pgn].push_back(Impl::compile(definition));
+    return true;
+}
+
+bool J1939SPNDecoder::removeDefinition(uint32_t spn) {
+    if (pImpl->definitions.count(spn) == 0) {
+        return false;
+    }
+    pImpl->erase(spn);
+    return true;
+}
+
+const J1939SPN* J1939SPNDecoder::getDefinition(uint32_t spn) const {
+    auto it = pImpl->definitions.find(spn);
+    return it == pImpl->definitions.end() ? nullptr : &it->second;
+}
+
+size_t J1939SPNDecoder::decode(uint32_t pgn, const uint8_t* data, size_t length,
+                               J1939SPNValue* out, size_t capacity) const {
+    auto group = pImpl->byPGN.find(pgn);
+    if (group == pImpl->byPGN.end()) {
+        return 0;
+    }
+
+    size_t count = 0;
+    for (const auto& extractor : group->second) {
+        if (count == capacity) {
+            break;
+        }
+        J1939SPNValue& value = out[count++];
+        value.spn = extractor.spn;
+        value.raw = 0;
+        value.value = 0.0;
+        value.valid = false;
+        if (extractor.byteOffset + extractor.byteCount > length) {
+            continue;
+        }
+
+        uint64_t raw = 0;
+        for (uint8_t i = 0; i < extractor.byteCount; ++i) {
+            raw |= static_cast<uint64_t>(data[extractor.byteOffset + i]) << (8 * i);
+        }
+        raw = (raw >> extractor.shift) & extractor.mask;
+
+        value.raw = raw;
+        value.valid = raw <= extractor.validMax;
+        value.value = static_cast<double>(raw) * extractor.scale + extractor.offset;
+    }
+    return count;
+}
+
+bool J1939SPNDecoder::hasPGN(uint32_t pgn) const {
+    return pImpl->byPGN.count(pgn) != 0;
+}
+
+std::vector<J1939SPN> J1939SPNDecoder::standardDefinitions() {
+    return {
+        {513, J1939PGN::EEC1, "Actual Engine - Percent Torque", 16, 8, 1.0, -125.0, "%"},
+        {190, J1939PGN::EEC1, "Engine Speed", 24, 16, 0.125, 0.0, "rpm"},
+        {110, J1939PGN::ET1, "Engine Coolant Temperature", 0, 8, 1.0, -40.0, "degC"},
+        {175, J1939PGN::ET1, "Engine Oil Temperature 1", 16, 16, 0.03125, -273.0, "degC"},
+        {100, J1939PGN::EFL_P1, "Engine Oil Pressure", 24, 8, 4.0, 0.0, "kPa"},
+        {84, J1939PGN::CCVS, "Wheel-Based Vehicle Speed", 8, 16, 1.0 / 256.0, 0.0, "km/h"},
+        {183, J1939PGN::LFE, "Engine Fuel Rate", 0, 16, 0.05, 0.0, "L/h"},
+        {168, J1939PGN::VEP1, "Battery Potential / Power Input 1", 32, 16, 0.05, 0.0, "V"},
+    };
+}
+
+// J1939Config implementation
+std::string J1939Config::toString() const {
+    std::ostringstream ss;
+    ss << "J1939Config[Name:0x" << std::hex << std::uppercase << std::setw(16) << std::setfill('0') << name
+       << ", Address:0x" << std::setw(2) << static_cast<int>(preferredAddress) << std::dec
+       << ", Claim:" << (claimAddress ? "Yes" : "No")
+       << ", BAM:" << bamPacketInterval << "ms"
+       << ", PacketsPerCTS:" << static_cast<int>(packetsPerCTS)
+       << ", Sessions:" << maxSessions << "]";
+    return ss.str();
+}
+
+// J1939Protocol implementation
+class J1939Protocol::Impl {
+public:
+    J1939Config config;
+    std::shared_ptr<CANProtocol> canProtocol;
+    uint32_t listenerId = 0;
+    std::atomic<bool> initialized{false};
+    std::atomic<uint8_t> address{J1939_NULL_ADDRESS};
+
+    // PGN dispatch table, copied on write so dispatch needs only a snapshot
+    using HandlerList = std::vector<std::pair<uint32_t, std::shared_ptr<const Handler>>>;
+    using HandlerTable = std::unordered_map<uint32_t, HandlerList>;
+    std::mutex handlersMutex;
+    std::shared_ptr<const HandlerTable> handlers = std::make_shared<HandlerTable>();
+    uint32_t nextHandlerId = 1;
+
+    // Receive sessions per source/destination pair
+    struct Session {
+        uint32_t pgn = 0;
+        size_t size = 0;
+        uint8_t packets = 0;
+        uint8_t received = 0;           // Last sequence number received
+        uint8_t windowEnd = 0;          // Last packet of the current CTS window
+        bool broadcast = false;
+        std::vector<uint8_t> buffer;
+        std::chrono::steady_clock::time_point deadline;
+    };
+    std::mutex sessionsMutex;
+    std::unordered_map<uint16_t, Session> sessions;
+    std::vector<std::vector<uint8_t>> bufferPool;
+
+    // Our connection-mode transfer in progress
+    struct Outbound {
+        bool active = false;
+        uint8_t destination = 0;
+        uint32_t pgn = 0;
+        bool clearToSend = false;
+        uint8_t packetCount = 0;
+        uint8_t nextPacket = 0;
+        bool acknowledged = false;
+        bool aborted = false;
+    };
+    std::mutex sendMutex;
+    std::mutex outboundMutex;
+    std::condition_variable outboundCondition;
+    Outbound outbound;
+    TimingEngine timing;
+
+    // Address claim in progress
+    std::mutex claimMutex;
+    std::condition_variable claimCondition;
+    bool claiming = false;
+    uint8_t claimCandidate = J1939_NULL_ADDRESS;
+    bool claimLost = false;
+
+    Statistics stats;
+    mutable std::mutex statsMutex;
+
+    Impl() {
+        stats.startTime = std::chrono::system_clock::now();
+    }
+
+    bool writeFrame(uint8_t priority, uint32_t pgn, uint8_t destination, uint8_t source,
+                    const std::vector<uint8_t>& data) {
+        return canProtocol->sendMessage(CANMessage(makeJ1939Id(priority, pgn, destination, source), data, true));
+    }
+
+    bool writeControl(uint8_t destination, std::vector<uint8_t> data) {
+        data.resize(TP_FRAME_SIZE, TP_FILL);
+        return writeFrame(TP_PRIORITY, J1939PGN::TP_CM, destination, address, data);
+    }
+
+    bool sendAbort(uint8_t destination, uint32_t pgn, uint8_t reason) {
+        std::vector<uint8_t> data = {TP_CM_ABORT, reason, TP_FILL, TP_FILL, TP_FILL};
+        appendPGN(data, pgn);
+        return writeControl(destination, std::move(data));
+    }
+
+    bool sendClaim(uint8_t source) {
+        return writeFrame(6, J1939PGN::ADDRESS_CLAIMED, J1939_GLOBAL_ADDRESS, source, nameBytes(config.name));
+    }
+
+    // Buffers, under sessionsMutex
+    std::vector<uint8_t> acquireBuffer() {
+        if (bufferPool.empty()) {
+            std::vector<uint8_t> buffer;
+            buffer.reserve(J1939_MAX_TP_SIZE);
+            return buffer;
+        }
+        std::vector<uint8_t> buffer = std::move(bufferPool.back());
+        bufferPool.pop_back();
+        return buffer;
+    }
+
+    void releaseBuffer(std::vector<uint8_t>&& buffer) {
+        buffer.clear();
+        if (bufferPool.size() < config.maxSessions) {
+            bufferPool.push_back(std::move(buffer));
+        }
+    }
+
+    void dispatch(const J1939Message& message) {
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.messagesReceived++;
+        }
+
+        std::shared_ptr<const HandlerTable> table;
+        {
+            std::lock_guard<std::mutex> lock(handlersMutex);
+            table = handlers;
+        }
+        for (uint32_t key : {message.pgn, ANY_PGN}) {
+            auto it = table->find(key);
+            if (it == table->end()) {
+                continue;
+            }
+            for (const auto& entry : it->second) {
+                (*entry.second)(message);
+            }
+        }
+    }
+
+    void onFrame(const CANMessage& frame) {
+        if (!frame.extended || frame.rtr) {
+            return;
+        }
+
+        const uint32_t pgn = j1939PGN(frame.id);
+        const uint8_t source = j1939Source(frame.id);
+        const uint8_t destination = j1939Destination(frame.id);
+        const uint8_t self = address;
+        const bool forUs = destination == J1939_GLOBAL_ADDRESS || (self != J1939_NULL_ADDRESS && destination == self);
+
+        switch (pgn) {
+            case J1939PGN::TP_CM:
+                if (forUs && frame.data.size() >= TP_FRAME_SIZE) {
+                    onConnectionManagement(source, destination, frame.data.data());
+                }
+                return;
+            case J1939PGN::TP_DT:
+                if (forUs && frame.data.size() >= 2) {
+                    onDataTransfer(source, destination, frame.data);
+                }
+                return;
+            case J1939PGN::ADDRESS_CLAIMED:
+                if (frame.data.size() >= 8) {
+                    onAddressClaimed(source, readName(frame.data));
+                }
+                break;
+            case J1939PGN::REQUEST:
+                if (forUs && frame.data.size() >= 3 && readPGN(frame.data.data()) == J1939PGN::ADDRESS_CLAIMED) {
+                    sendClaim(address);
+                }
+                break;
+            default:
+                break;
+        }
+
+        J1939Message message;
+        message.pgn = pgn;
+        message.priority = j1939Priority(frame.id);
+        message.source = source;
+        message.destination = destination;
+        message.data = frame.data;
+        message.timestamp = frame.timestamp;
+        dispatch(message);
+    }
+
+    // Drop sessions whose peer went quiet; under sessionsMutex
+    void expireSessions(std::chrono::steady_clock::time_point now, std::vector<std::pair<uint16_t, uint32_t>>& aborts) {
+        for (auto it = sessions.begin(); it != sessions.end();) {
+            if (now > it->second.deadline) {
+                if (!it->second.broadcast) {
+                    aborts.emplace_back(it->first, it->second.pgn);
+                }
+                releaseBuffer(std::move(it->second.buffer));
+                it = sessions.erase(it);
+                std::lock_guard<std::mutex> lock(statsMutex);
+                stats.transportTimeouts++;
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void onConnectionManagement(uint8_t source, uint8_t destination, const uint8_t* bytes) {
+        const uint8_t control = bytes[0];
+        const uint32_t pgn = readPGN(bytes + 5);
+
+        switch (control) {
+            case TP_CM_BAM:
+            case TP_CM_RTS: {
+                const bool broadcast = control == TP_CM_BAM;
+                if (broadcast != (destination == J1939_GLOBAL_ADDRESS)) {
+                    return;
+                }
+                size_t size = bytes[1] | (bytes[2] << 8);
+                uint8_t packets = bytes[3];
+                if (size <= PDU_MAX || size > J1939_MAX_TP_SIZE ||
+                    packets != (size + TP_PACKET_DATA - 1) / TP_PACKET_DATA) {
+                    return;
+                }
+
+                std::vector<std::pair<uint16_t, uint32_t>> aborts;
+                bool accepted = false;
+                uint8_t window = 0;
+                {
+                    std::lock_guard<std::mutex> lock(sessionsMutex);
+                    auto now = std::chrono::steady_clock::now();
+                    expireSessions(now, aborts);
+
+                    uint16_t key = sessionKey(source, destination);
+                    auto it = sessions.find(key);
+                    if (it == sessions.end() && sessions.size() < config.maxSessions) {
+                        it = sessions.emplace(key, Session{}).first;
+                        it->second.buffer = acquireBuffer();
+                    }
+                    if (it != sessions.end()) {
+                        // A new announcement replaces an unfinished session from the same peer
+                        Session& session = it->second;
+                        session.pgn = pgn;
+                        session.size = size;
+                        session.packets = packets;
+                        session.received = 0;
+                        session.broadcast = broadcast;
+                        session.buffer.clear();
+                        window = std::min({packets, bytes[4], config.packetsPerCTS});
+                        session.windowEnd = window;
+                        session.deadline = now + (broadcast ? TP_T1 : TP_T2);
+                        accepted = true;
+                    }
+                }
+                for (const auto& abort : aborts) {
+                    sendAbort(static_cast<uint8_t>(abort.first >> 8), abort.second, ABORT_TIMEOUT);
+                }
+
+                if (broadcast) {
+                    return;
+                }
+                if (!accepted) {
+                    sendAbort(source, pgn, ABORT_RESOURCES);
+                    return;
+                }
+                std::vector<uint8_t> cts = {TP_CM_CTS, window, 1, TP_FILL, TP_FILL};
+                appendPGN(cts, pgn);
+                writeControl(source, std::move(cts));
+                break;
+            }
+            case TP_CM_CTS:
+            case TP_CM_EOMA: {
+                std::lock_guard<std::mutex> lock(outboundMutex);
+                if (!outbound.active || outbound.destination != source || outbound.pgn != pgn) {
+                    return;
+                }
+                if (control == TP_CM_CTS) {
+                    outbound.packetCount = bytes[1];
+                    outbound.nextPacket = bytes[2];
+                    outbound.clearToSend = true;
+                } else {
+                    outbound.acknowledged = true;
+                }
+                outboundCondition.notify_all();
+                break;
+            }
+            case TP_CM_ABORT: {
+                {
+                    std::lock_guard<std::mutex> lock(outboundMutex);
+                    if (outbound.active && outbound.destination == source && outbound.pgn == pgn) {
+                        outbound.aborted = true;
+                        outboundCondition.notify_all();
+                    }
+                }
+                {
+                    std::lock_guard<std::mutex> lock(sessionsMutex);
+                    auto it = sessions.find(sessionKey(source, destination));
+                    if (it != sessions.end() && it->second.pgn == pgn) {
+                        releaseBuffer(std::move(it->second.buffer));
+                        sessions.erase(it);
+                    }
+                }
+                std::lock_guard<std::mutex> lock(statsMutex);
+                stats.transportAborts++;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    void onDataTransfer(uint8_t source, uint8_t destination, const std::vector<uint8_t>& bytes) {
+        const uint8_t sequence = bytes[0];
+        J1939Message complete;
+        std::vector<uint8_t> control;
+        uint8_t controlReason = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(sessionsMutex);
+            auto it = sessions.find(sessionKey(source, destination));
+            if (it == sessions.end()) {
+                return;
+            }
+            Session& session = it->second;
+            auto now = std::chrono::steady_clock::now();
+
+            if (sequence != session.received + 1 || now > session.deadline) {
+                controlReason = sequence != session.received + 1 ? ABORT_BAD_SEQUENCE : ABORT_TIMEOUT;
+                if (!session.broadcast) {
+                    control = {TP_CM_ABORT, controlReason, TP_FILL, TP_FILL, TP_FILL};
+                    appendPGN(control, session.pgn);
+                }
+                releaseBuffer(std::move(session.buffer));
+                sessions.erase(it);
+                std::lock_guard<std::mutex> statsLock(statsMutex);
+                stats.transportAborts++;
+            } else {
+                size_t offset = static_cast<size_t>(sequence - 1) * TP_PACKET_DATA;
+                size_t take = std::min(std::min(TP_PACKET_DATA, bytes.size() - 1), session.size - offset);
+                session.buffer.insert(session.buffer.end(), bytes.begin() + 1, bytes.begin() + 1 + take);
+                session.received = sequence;
+                session.deadline = now + TP_T1;
+
+                if (session.received == session.packets) {
+                    if (!session.broadcast) {
+                        control = {TP_CM_EOMA, static_cast<uint8_t>(session.size),
+                                   static_cast<uint8_t>(session.size >> 8), session.packets, TP_FILL};
+                        appendPGN(control, session.pgn);
+                    }
+                    complete.pgn = session.pgn;
+                    complete.priority = TP_PRIORITY;
+                    complete.source = source;
+                    complete.destination = destination;
+                    complete.data.swap(session.buffer);
+                    complete.timestamp = std::chrono::system_clock::now();
+                    sessions.erase(it);
+                } else if (!session.broadcast && session.received == session.windowEnd) {
+                    uint8_t window = std::min<uint8_t>(session.packets - session.received, config.packetsPerCTS);
+                    session.windowEnd = session.received + window;
+                    session.deadline = now + TP_T2;
+                    control = {TP_CM_CTS, window, static_cast<uint8_t>(session.received + 1), TP_FILL, TP_FILL};
+                    appendPGN(control, session.pgn);
+                }
+            }
+        }
+
+        if (!control.empty()) {
+            writeControl(source, std::move(control));
+        }
+        if (!complete.data.empty()) {
+            {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                stats.transportSessions++;
+            }
+            dispatch(complete);
+            std::lock_guard<std::mutex> lock(sessionsMutex);
+            releaseBuffer(std::move(complete.data));
+        }
+    }
+
+    void onAddressClaimed(uint8_t source, uint64_t name) {
+        if (name == config.name) {
+            return;     // Our own claim echoed back
+        }
+
+        bool defend = false;
+        bool lost = false;
+        {
+            std::lock_guard<std::mutex> lock(claimMutex);
+            if (claiming && source == claimCandidate) {
+                // The lower NAME wins the address
+                if (name < config.name) {
+                    claimLost = true;
+                    claimCondition.notify_all();
+                } else {
+                    defend = true;
+                }
+            } else if (!claiming && source == address && address != J1939_NULL_ADDRESS) {
+                if (name < config.name) {
+                    lost = true;
+                    address = J1939_NULL_ADDRESS;
+                } else {
+                    defend = true;
+                }
+            }
+        }
+
+        if (defend) {
+            sendClaim(source);
+        } else if (lost) {
+            Logger::getInstance()->warning("J1939 address " + addressToString(source) + " lost to a higher priority NAME");
+            sendClaim(J1939_NULL_ADDRESS);
+        }
+    }
+
+    bool claim() {
+        auto logger = Logger::getInstance();
+        const bool arbitrary = (config.name >> 63) != 0;
+        uint8_t candidate = config.preferredAddress;
+        int attempts = arbitrary ? ARBITRARY_LAST - ARBITRARY_FIRST + 2 : 1;
+
+        for (int attempt = 0; attempt < attempts; ++attempt) {
+            {
+                std::lock_guard<std::mutex> lock(claimMutex);
+                claiming = true;
+                claimCandidate = candidate;
+                claimLost = false;
+            }
+            sendClaim(candidate);
+
+            std::unique_lock<std::mutex> lock(claimMutex);
+            bool lost = claimCondition.wait_for(lock, std::chrono::milliseconds(config.claimTimeout),
+                                                [this] { return claimLost; });
+            if (!lost) {
+                address = candidate;
+                claiming = false;
+                logger->info("J1939 address claimed: " + addressToString(candidate));
+                return true;
+            }
+
+            // Next address from the arbitrary range
+            if (candidate < ARBITRARY_FIRST || candidate >= ARBITRARY_LAST) {
+                candidate = ARBITRARY_FIRST;
+            } else {
+                ++candidate;
+            }
+            if (candidate == config.preferredAddress) {
+                break;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(claimMutex);
+            claiming = false;
+            address = J1939_NULL_ADDRESS;
+        }
+        logger->error("J1939 cannot claim an address");
+        sendClaim(J1939_NULL_ADDRESS);
+        return false;
+    }
+
+    bool sendBroadcast(const J1939Message& message, uint8_t source) {
+        const size_t size = message.data.size();
+        const uint8_t packets = static_cast<uint8_t>((size + TP_PACKET_DATA - 1) / TP_PACKET_DATA);
+
+        std::vector<uint8_t> announce = {TP_CM_BAM, static_cast<uint8_t>(size), static_cast<uint8_t>(size >> 8),
+                                         packets, TP_FILL};
+        appendPGN(announce, message.pgn);
+        if (!writeControl(J1939_GLOBAL_ADDRESS, std::move(announce))) {
+            return false;
+        }
+        for (uint8_t packet = 1; packet <= packets; ++packet) {
+            timing.sleepFor(std::chrono::milliseconds(config.bamPacketInterval));
+            if (!writePacket(J1939_GLOBAL_ADDRESS, source, message.data, packet)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool writePacket(uint8_t destination, uint8_t source, const std::vector<uint8_t>& data, uint8_t packet) {
+        size_t offset = static_cast<size_t>(packet - 1) * TP_PACKET_DATA;
+        size_t take = std::min(TP_PACKET_DATA, data.size() - offset);
+        std::vector<uint8_t> frame;
+        frame.reserve(TP_FRAME_SIZE);
+        frame.push_back(packet);
+        frame.insert(frame.end(), data.begin() + offset, data.begin() + offset + take);
+        frame.resize(TP_FRAME_SIZE, TP_FILL);
+        return writeFrame(TP_PRIORITY, J1939PGN::TP_DT, destination, source, frame);
+    }
+
+    bool sendConnection(const J1939Message& message) {
+        const size_t size = message.data.size();
+        const uint8_t packets = static_cast<uint8_t>((size + TP_PACKET_DATA - 1) / TP_PACKET_DATA);
+        const uint8_t destination = message.destination;
+        const uint8_t source = address;
+
+        {
+            std::lock_guard<std::mutex> lock(outboundMutex);
+            outbound = Outbound{};
+            outbound.active = true;
+            outbound.destination = destination;
+            outbound.pgn = message.pgn;
+        }
+
+        std::vector<uint8_t> request = {TP_CM_RTS, static_cast<uint8_t>(size), static_cast<uint8_t>(size >> 8),
+                                        packets, NO_PACKET_LIMIT};
+        appendPGN(request, message.pgn);
+        bool ok = writeControl(destination, std::move(request));
+        bool timedOut = false;
+        auto wait = TP_T3;
+
+        while (ok) {
+            uint8_t first;
+            uint8_t count;
+            {
+                std::unique_lock<std::mutex> lock(outboundMutex);
+                if (!outboundCondition.wait_for(lock, wait, [this] {
+                        return outbound.clearToSend || outbound.acknowledged || outbound.aborted;
+                    })) {
+                    timedOut = true;
+                    ok = false;
+                    break;
+                }
+                if (outbound.aborted) {
+                    ok = false;
+                    break;
+                }
+                if (outbound.acknowledged) {
+                    break;
+                }
+                outbound.clearToSend = false;
+                first = outbound.nextPacket;
+                count = outbound.packetCount;
+            }
+
+            if (count == 0) {
+                wait = TP_T4;       // Receiver holds the connection open
+                continue;
+            }
+            for (uint8_t packet = first; ok && packet < first + count && packet <= packets && packet != 0; ++packet) {
+                ok = writePacket(destination, source, message.data, packet);
+            }
+            wait = TP_T3;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(outboundMutex);
+            outbound.active = false;
+        }
+        if (timedOut) {
+            Logger::getInstance()->warning("J1939 transport to " + addressToString(destination) + " timed out");
+            sendAbort(destination, message.pgn, ABORT_TIMEOUT);
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.transportTimeouts++;
+        }
+        return ok;
+    }
+};
+
+J1939Protocol::J1939Protocol() : pImpl(std::make_unique<Impl>()) {}
+
+J1939Protocol::~J1939Protocol() {
+    shutdown();
+}
+
+bool J1939Protocol::initialize(const J1939Config& config, std::shared_ptr<CANProtocol> canProtocol) {
+    auto logger = Logger::getInstance();
+    logger->info("Initializing J1939 protocol: " + config.toString());
+
+    shutdown();
+    if (!canProtocol || !canProtocol->isInitialized()) {
+        logger->error("CAN protocol not initialized");
+        return false;
+    }
+
+    pImpl->config = config;
+    pImpl->canProtocol = std::move(canProtocol);
+    pImpl->listenerId = pImpl->canProtocol->addListener([impl = pImpl.get()](const CANMessage& frame) {
+        impl->onFrame(frame);
+    });
+    if (!pImpl->listenerId) {
+        return false;
+    }
+
+    if (config.claimAddress) {
+        if (!pImpl->claim()) {
+            shutdown();
+            return false;
+        }
+    } else {
+        pImpl->address = config.preferredAddress;
+    }
+
+    pImpl->initialized = true;
+    logger->info("J1939 protocol initialized successfully");
+    return true;
+}
+
+void J1939Protocol::shutdown() {
+    bool wasInitialized = pImpl->initialized.exchange(false);
+    if (pImpl->listenerId) {
+        pImpl->canProtocol->removeListener(pImpl->listenerId);
+        pImpl->listenerId = 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pImpl->outboundMutex);
+        pImpl->outbound.aborted = true;
+        pImpl->outboundCondition.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(pImpl->sessionsMutex);
+        for (auto& entry : pImpl->sessions) {
+            pImpl->releaseBuffer(std::move(entry.second.buffer));
+        }
+        pImpl->sessions.clear();
+    }
+    pImpl->address = J1939_NULL_ADDRESS;
+
+    if (wasInitialized) {
+        Logger::getInstance()->info("J1939 protocol shutdown");
+    }
+}
+
+bool J1939Protocol::isInitialized() const {
+    return pImpl->initialized;
+}
+
+bool J1939Protocol::sendMessage(const J1939Message& message) {
+    const uint8_t source = pImpl->address;
+    if (!pImpl->initialized || source == J1939_NULL_ADDRESS) {
+        return false;
+    }
+    if (message.data.size() > J1939_MAX_TP_SIZE) {
+        Logger::getInstance()->error("J1939 message too long: " + std::to_string(message.data.size()) + " bytes");
+        return false;
+    }
+
+    bool ok;
+    const uint8_t destination = message.isPDU1() ? message.destination : J1939_GLOBAL_ADDRESS;
+    if (message.data.size() <= PDU_MAX) {
+        ok = pImpl->writeFrame(message.priority, message.pgn, destination, source, message.data);
+    } else {
+        // One multi-packet transfer at a time from this node
+        std::lock_guard<std::mutex> lock(pImpl->sendMutex);
+        if (destination == J1939_GLOBAL_ADDRESS) {
+            ok = pImpl->sendBroadcast(message, source);
+        } else {
+            J1939Message addressed = message;
+            addressed.destination = destination;
+            ok = pImpl->sendConnection(addressed);
+        }
+    }
+
+    if (ok) {
+        std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+        pImpl->stats.messagesSent++;
+    }
+    return ok;
+}
+
+bool J1939Protocol::request(uint32_t pgn, uint8_t destination) {
+    std::vector<uint8_t> data;
+    appendPGN(data, pgn);
+    J1939Message message(J1939PGN::REQUEST, data, destination);
+    message.priority = pImpl->config.priority;
+    return sendMessage(message);
+}
+
+uint32_t J1939Protocol::addHandler(uint32_t pgn, Handler handler) {
+    std::lock_guard<std::mutex> lock(pImpl->handlersMutex);
+    uint32_t id = pImpl->nextHandlerId++;
+    auto updated = std::make_shared<Impl::HandlerTable>(*pImpl->handlers);
+    (*updated)[pgn].emplace_back(id, std::make_shared<const Handler>(std::move(handler)));
+    pImpl->handlers = std::move(updated);
+    return id;
+}
+
+void J1939Protocol::removeHandler(uint32_t handlerId) {
+    std::lock_guard<std::mutex> lock(pImpl->handlersMutex);
+    auto updated = std::make_shared<Impl::HandlerTable>(*pImpl->handlers);
+    for (auto it = updated->begin(); it != updated->end();) {
+        auto& list = it->second;
+        list.erase(std::remove_if(list.begin(), list.end(),
+            [handlerId](const Impl::HandlerList::value_type& entry) { return entry.first == handlerId; }), list.end());
+        it = list.empty() ? updated->erase(it) : std::next(it);
+    }
+    pImpl->handlers = std::move(updated);
+}
+
+bool J1939Protocol::claimAddress() {
+    if (!pImpl->listenerId) {
+        return false;
+    }
+    return pImpl->claim();
+}
+
+uint8_t J1939Protocol::getAddress() const {
+    return pImpl->address;
+}
+
+J1939Protocol::Statistics J1939Protocol::getStatistics() const {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    return pImpl->stats;
+}
+
+void J1939Protocol::resetStatistics() {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    pImpl->stats = Statistics{};
+    pImpl->stats.startTime = std::chrono::system_clock::now();
+}
+
+J1939Config J1939Protocol::getConfiguration() const {
+    return pImpl->config;
+}
+
+std::string J1939Protocol::toString() const {
+    size_t sessions;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->sessionsMutex);
+        sessions = pImpl->sessions.size();
+    }
+    std::ostringstream ss;
+    ss << "J1939Protocol[Address:" << addressToString(pImpl->address)
+       << ", Sessions:" << sessions
+       << ", Initialized:" << (pImpl->initialized ? "Yes" : "No") << "]";
+    return ss.str();
+}
+
+// Utility functions
+uint32_t makeJ1939Id(uint8_t priority, uint32_t pgn, uint8_t destination, uint8_t source) {
+    uint32_t id = (static_cast<uint32_t>(priority & 0x07) << 26) | ((pgn & 0x3FFFF) << 8) | source;
+    if (((pgn >> 8) & 0xFF) < PDU2_FORMAT) {
+        id = (id & ~0xFF00u) | (static_cast<uint32_t>(destination) << 8);
+    }
+    return id;
+}
+
+uint32_t j1939PGN(uint32_t canId) {
+    uint32_t pgn = (canId >> 8) & 0x3FFFF;
+    if (((pgn >> 8) & 0xFF) < PDU2_FORMAT) {
+        pgn &= 0x3FF00;     // PDU1: the PS field is the destination
+    }
+    return pgn;
+}
+
+uint8_t j1939Source(uint32_t canId) {
+    return static_cast<uint8_t>(canId);
+}
+
+uint8_t j1939Destination(uint32_t canId) {
+    uint8_t format = static_cast<uint8_t>(canId >> 16);
+    return format < PDU2_FORMAT ? static_cast<uint8_t>(canId >> 8) : J1939_GLOBAL_ADDRESS;
+}
+
+uint8_t j1939Priority(uint32_t canId) {
+    return static_cast<uint8_t>((canId >> 26) & 0x07);
+}
+
+uint64_t makeJ1939Name(bool arbitraryAddressCapable, uint8_t industryGroup, uint8_t vehicleSystemInstance,
+                       uint8_t vehicleSystem, uint8_t function, uint8_t functionInstance,
+                       uint8_t ecuInstance, uint16_t manufacturerCode, uint32_t identityNumber) {
+    return (static_cast<uint64_t>(arbitraryAddressCapable) << 63) |
+           (static_cast<uint64_t>(industryGroup & 0x07) << 60) |
+           (static_cast<uint64_t>(vehicleSystemInstance & 0x0F) << 56) |
+           (static_cast<uint64_t>(vehicleSystem & 0x7F) << 49) |
+           (static_cast<uint64_t>(function) << 40) |
+           (static_cast<uint64_t>(functionInstance & 0x1F) << 35) |
+           (static_cast<uint64_t>(ecuInstance & 0x07) << 32) |
+           (static_cast<uint64_t>(manufacturerCode & 0x7FF) << 21) |
+           (identityNumber & 0x1FFFFF);
+}
+
+} // namespace protocols
+} // namespace fmus
@@ -0,0 +1,777 @@
+#include <fmus/protocols/kwp2000.h>
+#include <fmus/logger.h>
+#include <fmus/utils.h>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <cmath>
+
+namespace fmus {
+namespace protocols {
+
+namespace {
+
+constexpr uint8_t NEGATIVE_RESPONSE_SID = 0x7F;
+constexpr uint8_t RESPONSE_PENDING_NRC = 0x78;
+constexpr uint8_t START_COMMUNICATION_SID = 0x81;
+constexpr uint8_t START_COMMUNICATION_RESPONSE = 0xC1;
+constexpr size_t KLINE_FRAME_OVERHEAD = 5;     // Format, target, source, length and checksum bytes
+constexpr size_t KLINE_MAX_PAYLOAD = 255;
+constexpr size_t KLINE_FORMAT_PAYLOAD_MAX = 63;
+
+unsigned long toHalfMilliseconds(double milliseconds) {
+    return static_cast<unsigned long>(std::lround(milliseconds * 2.0));
+}
+
+} // anonymous namespace
+
+// KWP2000Message implementation
+protocols::CANMessage KWP2000Message::toCANMessage(uint32_t canId) const {
+    protocols::CANMessage canMsg;
+    canMsg.id = canId;
+    canMsg.data = toBytes();
+    canMsg.timestamp = timestamp;
+    return canMsg;
+}
+
+KWP2000Message KWP2000Message::fromCANMessage(const protocols::CANMessage& canMsg) {
+    KWP2000Message message = fromBytes(canMsg.data);
+    message.timestamp = canMsg.timestamp;
+    return message;
+}
+
+std::vector<uint8_t> KWP2000Message::toBytes() const {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(data.size() + 3);
+
+    if (isNegativeResponse) {
+        bytes.push_back(NEGATIVE_RESPONSE_SID);
+        bytes.push_back(static_cast<uint8_t>(service));
+        bytes.push_back(static_cast<uint8_t>(negativeResponseCode));
+    } else if (isResponse) {
+        bytes.push_back(static_cast<uint8_t>(static_cast<uint8_t>(service) + 0x40));
+    } else {
+        bytes.push_back(static_cast<uint8_t>(service));
+    }
+    bytes.insert(bytes.end(), data.begin(), data.end());
+    return bytes;
+}
+
+KWP2000Message KWP2000Message::fromBytes(const std::vector<uint8_t>& bytes) {
+    KWP2000Message message;
+    message.timestamp = std::chrono::system_clock::now();
+
+    if (bytes.empty()) {
+        return message;
+    }
+
+    uint8_t serviceId = bytes[0];
+
+    if (serviceId == NEGATIVE_RESPONSE_SID) {
+        message.isNegativeResponse = true;
+        if (bytes.size() >= 3) {
+            message.service = static_cast<KWP2000Service>(bytes[1]);
+            message.negativeResponseCode = static_cast<KWP2000NRC>(bytes[2]);
+        }
+        if (bytes.size() > 3) {
+            message.data.assign(bytes.begin() + 3, bytes.end());
+        }
+    } else if (serviceId >= 0x40 && serviceId <= 0x7E) {
+        message.isResponse = true;
+        message.service = static_cast<KWP2000Service>(serviceId - 0x40);
+        message.data.assign(bytes.begin() + 1, bytes.end());
+    } else {
+        message.service = static_cast<KWP2000Service>(serviceId);
+        message.data.assign(bytes.begin() + 1, bytes.end());
+    }
+
+    return message;
+}
+
+std::string KWP2000Message::toString() const {
+    std::ostringstream ss;
+    ss << "KWP2000[";
+
+    if (isNegativeResponse) {
+        ss << "NRC:" << kwp2000NRCToString(negativeResponseCode)
+           << " SVC:" << kwp2000ServiceToString(service);
+    } else if (isResponse) {
+        ss << "RSP:" << kwp2000ServiceToString(service);
+    } else {
+        ss << "REQ:" << kwp2000ServiceToString(service);
+    }
+
+    if (!data.empty()) {
+        ss << " DATA:" << utils::bytesToHex(data);
+    }
+
+    ss << "]";
+    return ss.str();
+}
+
+bool KWP2000Message::isValid() const {
+    if (isNegativeResponse && negativeResponseCode == KWP2000NRC::GENERAL_REJECT) {
+        return false;
+    }
+    return true;
+}
+
+// KWP2000Config implementation
+std::string KWP2000Config::toString() const {
+    std::ostringstream ss;
+    ss << "KWP2000Config[";
+    if (transport == KWP2000Transport::K_LINE) {
+        ss << "K-Line, Baud:" << baudRate
+           << ", Tgt:0x" << std::hex << static_cast<int>(targetAddress)
+           << ", Src:0x" << static_cast<int>(sourceAddress) << std::dec
+           << ", P1max:" << p1Max << "ms"
+           << ", P3min:" << p3Min << "ms"
+           << ", P4min:" << p4Min << "ms";
+    } else if (transport == KWP2000Transport::TP20) {
+        ss << "TP2.0, Module:0x" << std::hex << static_cast<int>(tp20.moduleAddress) << std::dec;
+    } else {
+        ss << "CAN, ReqID:0x" << std::hex << requestId
+           << ", RspID:0x" << responseId << std::dec;
+    }
+    ss << ", Timeout:" << timeout << "ms"
+       << ", P2*:" << p2StarClientMax << "ms]";
+    return ss.str();
+}
+
+// KWP2000Protocol implementation
+class KWP2000Protocol::Impl {
+public:
+    KWP2000Config config;
+    std::shared_ptr<DiagnosticTransport> transport;
+    bool ownsTransport = false;
+    std::shared_ptr<KLineTransport> kLine;
+    std::shared_ptr<j2534::PassThruChannel> channel;
+    std::atomic<bool> initialized{false};
+
+    // K-line framing, resolved from the config and key bytes
+    KWP2000KeyBytes keyBytes;
+    KLineFraming framing;
+
+    // One request in flight at a time; responses are queued by the receive path
+    std::mutex transactionMutex;
+    std::mutex responseMutex;
+    std::condition_variable responseCondition;
+    std::deque<KWP2000Message> responses;
+    bool awaitingResponse = false;
+
+    std::function<void(const KWP2000Message&)> monitorCallback;
+    std::mutex monitorMutex;
+    std::atomic<bool> monitoring{false};
+
+    Statistics stats;
+    mutable std::mutex statsMutex;
+
+    Impl() {
+        stats.startTime = std::chrono::system_clock::now();
+    }
+
+    bool isKLine() const {
+        return config.transport == KWP2000Transport::K_LINE;
+    }
+
+    void deliver(const KWP2000Message& message) {
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.messagesReceived++;
+        }
+
+        if (monitoring) {
+            std::lock_guard<std::mutex> lock(monitorMutex);
+            if (monitorCallback) {
+                monitorCallback(message);
+            }
+        }
+
+        if (message.isResponse || message.isNegativeResponse) {
+            std::lock_guard<std::mutex> lock(responseMutex);
+            if (awaitingResponse) {
+                responses.push_back(message);
+                responseCondition.notify_one();
+            }
+        }
+    }
+
+    bool attach(std::shared_ptr<DiagnosticTransport> newTransport, bool owned) {
+        transport = std::move(newTransport);
+        ownsTransport = owned;
+        transport->setReceiveHandler([this](uint32_t, const uint8_t* data, size_t length) {
+            deliver(KWP2000Message::fromBytes(std::vector<uint8_t>(data, data + length)));
+        });
+        return transport->open();
+    }
+
+    void detach() {
+        if (!transport) {
+            return;
+        }
+        transport->setReceiveHandler(nullptr);
+        if (ownsTransport) {
+            transport->close();
+        }
+        transport.reset();
+        kLine.reset();
+    }
+
+    void resolveFraming(bool haveKeyBytes) {
+        switch (config.headerFormat) {
+            case KWP2000HeaderFormat::NO_ADDRESS:
+                framing.addressHeader = false;
+                break;
+            case KWP2000HeaderFormat::WITH_ADDRESS:
+                framing.addressHeader = true;
+                break;
+            case KWP2000HeaderFormat::AUTO:
+                framing.addressHeader = !haveKeyBytes || keyBytes.addressHeader() || !keyBytes.formatOnlyHeader();
+                break;
+        }
+        // Fall back to the length byte only if the ECU cannot take lengths in the format byte
+        framing.lengthInFormatByte = !haveKeyBytes || keyBytes.lengthInFormatByte() || !keyBytes.lengthByte();
+        framing.lengthByte = !haveKeyBytes || keyBytes.lengthByte();
+        framing.functional = config.functionalAddressing;
+        framing.targetAddress = config.targetAddress;
+        framing.sourceAddress = config.sourceAddress;
+        if (kLine) {
+            kLine->setFraming(framing);
+        }
+    }
+
+    bool startCommunication() {
+        auto logger = Logger::getInstance();
+        auto start = std::chrono::steady_clock::now();
+
+        try {
+            channel->clearReceiveBuffer();
+
+            switch (config.initMode) {
+                case KWP2000InitMode::FAST: {
+                    // The adapter appends the checksum
+                    auto frame = encodeKWP2000Frame({START_COMMUNICATION_SID}, true, config.functionalAddressing,
+                                                    config.targetAddress, config.sourceAddress, true, false);
+                    j2534::Message response = channel->fastInit(
+                        j2534::Message(j2534::Protocol::ISO14230_4, 0, frame));
+
+                    std::vector<uint8_t> payload;
+                    if (!decodeKWP2000Frame(response.data, payload) || payload.size() < 3 ||
+                        payload[0] != START_COMMUNICATION_RESPONSE) {
+                        logger->error("Unexpected StartCommunication response: " +
+                                      utils::bytesToHex(response.data));
+                        return false;
+                    }
+                    keyBytes.kb1 = payload[1];
+                    keyBytes.kb2 = payload[2];
+                    resolveFraming(true);
+                    break;
+                }
+                case KWP2000InitMode::FIVE_BAUD: {
+                    auto bytes = channel->fiveBaudInit(config.targetAddress);
+                    if (bytes.size() < 2) {
+                        logger->error("5-baud init returned no key bytes");
+                        return false;
+                    }
+                    keyBytes.kb1 = bytes[0];
+                    keyBytes.kb2 = bytes[1];
+                    resolveFraming(true);
+                    break;
+                }
+                case KWP2000InitMode::NONE:
+                    resolveFraming(false);
+                    break;
+            }
+        } catch (const j2534::J2534Error& e) {
+            logger->error(std::string("K-line initialization failed: ") + e.what());
+            return false;
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        std::ostringstream ss;
+        ss << "K-line initialized in " << elapsed.count() << "ms, key bytes 0x" << std::hex
+           << std::setw(2) << std::setfill('0') << static_cast<int>(keyBytes.kb1) << " 0x"
+           << std::setw(2) << static_cast<int>(keyBytes.kb2)
+           << (framing.addressHeader ? ", address header" : ", format-only header");
+        logger->info(ss.str());
+        return true;
+    }
+
+    bool transmit(const KWP2000Message& request) {
+        return transport && transport->send(request.toBytes());
+    }
+
+    KWP2000Message failure(KWP2000NRC code, const KWP2000Message& request) {
+        KWP2000Message response;
+        response.service = request.service;
+        response.isNegativeResponse = true;
+        response.negativeResponseCode = code;
+        response.timestamp = std::chrono::system_clock::now();
+        return response;
+    }
+
+    /**
+     * Time from handing a request to the transport until its complete
+     * response must have arrived. P2 covers the ECU; on K-line the adapter
+     * holds the request until P3min and only whole frames are delivered, so
+     * the wire time of the request and of the longest response is added.
+     */
+    std::chrono::microseconds responseWindow(size_t requestLength) const {
+        std::chrono::microseconds window = std::chrono::milliseconds(config.p2ClientMax);
+        if (isKLine() && config.baudRate > 0) {
+            double byteUs = 10e6 / config.baudRate;    // Start, eight data and stop bits
+            size_t requestBytes = requestLength + KLINE_FRAME_OVERHEAD;
+            size_t responseBytes = KLINE_FRAME_OVERHEAD +
+                                   (framing.lengthByte ? KLINE_MAX_PAYLOAD : KLINE_FORMAT_PAYLOAD_MAX);
+            double wireUs = config.p3Min * 1000.0 + requestBytes * (byteUs + config.p4Min * 1000.0) +
+                            responseBytes * byteUs;
+            window += std::chrono::microseconds(std::llround(wireUs));
+        }
+        return window;
+    }
+
+    KWP2000Message transact(const KWP2000Message& request) {
+        auto logger = Logger::getInstance();
+        std::lock_guard<std::mutex> transaction(transactionMutex);
+
+        {
+            std::lock_guard<std::mutex> lock(responseMutex);
+            responses.clear();
+            awaitingResponse = true;
+        }
+
+        auto sent = std::chrono::steady_clock::now();
+        if (!transmit(request)) {
+            std::lock_guard<std::mutex> lock(responseMutex);
+            awaitingResponse = false;
+            logger->error("Failed to send KWP2000 request");
+            return failure(KWP2000NRC::GENERAL_REJECT, request);
+        }
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.messagesSent++;
+        }
+
+        auto deadline = sent + responseWindow(request.toBytes().size());
+        std::unique_lock<std::mutex> lock(responseMutex);
+        for (;;) {
+            if (!responseCondition.wait_until(lock, deadline, [this] { return !responses.empty(); })) {
+                awaitingResponse = false;
+                lock.unlock();
+                logger->warning("KWP2000 request timeout: " + request.toString());
+                std::lock_guard<std::mutex> statsLock(statsMutex);
+                stats.timeouts++;
+                return failure(KWP2000NRC::GENERAL_REJECT, request);
+            }
+
+            KWP2000Message response = responses.front();
+            responses.pop_front();
+            if (response.service != request.service) {
+                continue;   // Unsolicited or late response to an earlier request
+            }
+
+            if (response.isNegativeResponse &&
+                static_cast<uint8_t>(response.negativeResponseCode) == RESPONSE_PENDING_NRC) {
+                deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config.p2StarClientMax);
+                std::lock_guard<std::mutex> statsLock(statsMutex);
+                stats.responsePending++;
+                continue;
+            }
+
+            awaitingResponse = false;
+            lock.unlock();
+
+            std::lock_guard<std::mutex> statsLock(statsMutex);
+            stats.lastResponseTime = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - sent);
+            if (response.isNegativeResponse) {
+                stats.negativeResponses++;
+            }
+            return response;
+        }
+    }
+};
+
+KWP2000Protocol::KWP2000Protocol() : pImpl(std::make_unique<Impl>()) {}
+
+KWP2000Protocol::~KWP2000Protocol() {
+    shutdown();
+}
+
+bool KWP2000Protocol::initialize(const KWP2000Config& config, std::shared_ptr<CANProtocol> canProtocol) {
+    if (!canProtocol || !canProtocol->isInitialized()) {
+        Logger::getInstance()->error("CAN protocol not initialized");
+        return false;
+    }
+
+    if (config.transport == KWP2000Transport::TP20) {
+        return initialize(config, std::make_shared<Tp20Transport>(canProtocol, config.tp20), true);
+    }
+
+    IsoTpConfig isoTp;
+    isoTp.txId = config.requestId;
+    isoTp.rxId = config.responseId;
+    isoTp.extendedIds = !isValidCANId(config.requestId) || !isValidCANId(config.responseId);
+
+    KWP2000Config canConfig = config;
+    canConfig.transport = KWP2000Transport::CAN;
+    return initialize(canConfig, std::make_shared<IsoTpTransport>(canProtocol, isoTp), true);
+}
+
+bool KWP2000Protocol::initialize(const KWP2000Config& config, std::shared_ptr<DiagnosticTransport> transport) {
+    return initialize(config, std::move(transport), false);
+}
+
+bool KWP2000Protocol::initialize(const KWP2000Config& config, std::shared_ptr<DiagnosticTransport> transport,
+                                 bool ownsTransport) {
+    auto logger = Logger::getInstance();
+    logger->info("Initializing KWP2000 protocol: " + config.toString());
+
+    shutdown();
+    if (!transport) {
+        logger->error("KWP2000 requires a transport");
+        return false;
+    }
+
+    pImpl->config = config;
+    if (!pImpl->attach(std::move(transport), ownsTransport)) {
+        logger->error("Failed to open transport for KWP2000");
+        pImpl->detach();
+        return false;
+    }
+
+    pImpl->initialized = true;
+    return true;
+}
+
+bool KWP2000Protocol::initialize(const KWP2000Config& config, std::shared_ptr<j2534::PassThruChannel> channel) {
+    auto logger = Logger::getInstance();
+
+    if (!channel || !channel->isConnected() || channel->getProtocol() != j2534::Protocol::ISO14230_4) {
+        logger->error("KWP2000 on K-line requires a connected ISO14230_4 channel");
+        return false;
+    }
+
+    shutdown();
+    pImpl->config = config;
+    pImpl->config.transport = KWP2000Transport::K_LINE;
+    pImpl->channel = channel;
+    logger->info("Initializing KWP2000 protocol: " + pImpl->config.toString());
+
+    try {
+        channel->setConfig({
+            {j2534::J2534Constants::LOOPBACK, 0},
+            {j2534::J2534Constants::P1_MAX, toHalfMilliseconds(config.p1Max)},
+            {j2534::J2534Constants::P3_MIN, toHalfMilliseconds(config.p3Min)},
+            {j2534::J2534Constants::P4_MIN, toHalfMilliseconds(config.p4Min)},
+        });
+        channel->startPassAllFilter();
+    } catch (const j2534::J2534Error& e) {
+        logger->error(std::string("Failed to apply K-line timing: ") + e.what());
+        return false;
+    }
+
+    if (!pImpl->startCommunication()) {
+        return false;
+    }
+
+    pImpl->kLine = std::make_shared<KLineTransport>(channel, pImpl->framing);
+    if (!pImpl->attach(pImpl->kLine, true)) {
+        pImpl->detach();
+        return false;
+    }
+    pImpl->initialized = true;
+    return true;
+}
+
+bool KWP2000Protocol::startCommunication() {
+    if (!pImpl->isKLine() || !pImpl->channel) {
+        return false;
+    }
+
+    // The init exchange reads the channel itself, so the transport stops reading meanwhile
+    std::lock_guard<std::mutex> transaction(pImpl->transactionMutex);
+    bool wasOpen = pImpl->kLine && pImpl->kLine->isOpen();
+    if (wasOpen) {
+        pImpl->kLine->close();
+    }
+    bool result = pImpl->startCommunication();
+    if (wasOpen) {
+        pImpl->kLine->open();
+    }
+    return result;
+}
+
+KWP2000KeyBytes KWP2000Protocol::getKeyBytes() const {
+    return pImpl->keyBytes;
+}
+
+void KWP2000Protocol::shutdown() {
+    if (!pImpl->initialized.exchange(false)) {
+        return;
+    }
+
+    pImpl->detach();
+    pImpl->monitoring = false;
+
+    Logger::getInstance()->info("KWP2000 protocol shutdown");
+}
+
+bool KWP2000Protocol::isInitialized() const {
+    return pImpl->initialized;
+}
+
+bool KWP2000Protocol::sendMessage(const KWP2000Message& message) {
+    if (!pImpl->initialized) {
+        return false;
+    }
+    if (!pImpl->transmit(message)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    pImpl->stats.messagesSent++;
+    return true;
+}
+
+KWP2000Message KWP2000Protocol::sendRequest(const KWP2000Message& request) {
+    if (!pImpl->initialized) {
+        return pImpl->failure(KWP2000NRC::CONDITIONS_NOT_CORRECT, request);
+    }
+
+    Logger::getInstance()->debug("Sending KWP2000 request: " + request.toString());
+    KWP2000Message response = pImpl->transact(request);
+    Logger::getInstance()->debug("Received KWP2000 response: " + response.toString());
+    return response;
+}
+
+std::vector<KWP2000Message> KWP2000Protocol::sendRequests(const std::vector<KWP2000Message>& requests) {
+    std::vector<KWP2000Message> responses;
+    responses.reserve(requests.size());
+
+    for (const auto& request : requests) {
+        uint64_t timeoutsBefore = getStatistics().timeouts;
+        KWP2000Message response = sendRequest(request);
+        if (getStatistics().timeouts != timeoutsBefore || !pImpl->initialized) {
+            break;
+        }
+        responses.push_back(response);
+    }
+    return responses;
+}
+
+bool KWP2000Protocol::startMonitoring(std::function<void(const KWP2000Message&)> callback) {
+    if (!pImpl->initialized) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(pImpl->monitorMutex);
+    pImpl->monitorCallback = std::move(callback);
+    pImpl->monitoring = true;
+    return true;
+}
+
+void KWP2000Protocol::stopMonitoring() {
+    std::lock_guard<std::mutex> lock(pImpl->monitorMutex);
+    pImpl->monitoring = false;
+    pImpl->monitorCallback = nullptr;
+}
+
+bool KWP2000Protocol::isMonitoring() const {
+    return pImpl->monitoring;
+}
+
+KWP2000Protocol::Statistics KWP2000Protocol::getStatistics() const {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    return pImpl->stats;
+}
+
+void KWP2000Protocol::resetStatistics() {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    pImpl->stats = Statistics{};
+    pImpl->stats.startTime = std::chrono::system_clock::now();
+}
+
+KWP2000Config KWP2000Protocol::getConfiguration() const {
+    return pImpl->config;
+}
+
+// Utility functions
+std::string kwp2000ServiceToString(KWP2000Service service) {
+    switch (service) {
+        case KWP2000Service::START_DIAGNOSTIC_SESSION: return "StartDiagnosticSession";
+        case KWP2000Service::ECU_RESET: return "ECUReset";
+        case KWP2000Service::READ_FAULT_MEMORY: return "ReadFaultMemory";
+        case KWP2000Service::CLEAR_FAULT_MEMORY: return "ClearFaultMemory";
+        case KWP2000Service::READ_STATUS_OF_FAULT_MEMORY: return "ReadStatusOfFaultMemory";
+        case KWP2000Service::READ_FAULT_MEMORY_BY_STATUS: return "ReadFaultMemoryByStatus";
+        case KWP2000Service::READ_DATA_BY_IDENTIFIER: return "ReadDataByLocalIdentifier";
+        case KWP2000Service::READ_DATA_BY_ADDRESS: return "ReadMemoryByAddress";
+        case KWP2000Service::SECURITY_ACCESS: return "SecurityAccess";
+        case KWP2000Service::DISABLE_NORMAL_MESSAGE_TRANSMISSION: return "DisableNormalMessageTransmission";
+        case KWP2000Service::ENABLE_NORMAL_MESSAGE_TRANSMISSION: return "EnableNormalMessageTransmission";
+        case KWP2000Service::DYNAMICALLY_DEFINE_MESSAGE: return "DynamicallyDefineLocalIdentifier";
+        case KWP2000Service::WRITE_DATA_BY_IDENTIFIER: return "WriteDataByIdentifier";
+        case KWP2000Service::INPUT_OUTPUT_CONTROL_BY_IDENTIFIER: return "InputOutputControlByLocalIdentifier";
+        case KWP2000Service::START_ROUTINE_BY_IDENTIFIER: return "StartRoutineByLocalIdentifier";
+        case KWP2000Service::STOP_ROUTINE_BY_IDENTIFIER: return "StopRoutineByLocalIdentifier";
+        case KWP2000Service::REQUEST_ROUTINE_RESULTS_BY_IDENTIFIER: return "RequestRoutineResultsByLocalIdentifier";
+        case KWP2000Service::REQUEST_DOWNLOAD: return "RequestDownload";
+        case KWP2000Service::REQUEST_UPLOAD: return "RequestUpload";
+        case KWP2000Service::TRANSFER_DATA: return "TransferData";
+        case KWP2000Service::REQUEST_TRANSFER_EXIT: return "RequestTransferExit";
+        case KWP2000Service::TESTER_PRESENT: return "TesterPresent";
+        default: {
+            std::ostringstream ss;
+            ss << "Unknown(0x" << std::hex << std::setw(2) << std::setfill('0')
+               << static_cast<int>(service) << ")";
+            return ss.str();
+        }
+    }
+}
+
+std::string kwp2000NRCToString(KWP2000NRC nrc) {
+    switch (nrc) {
+        case KWP2000NRC::GENERAL_REJECT: return "GeneralReject";
+        case KWP2000NRC::SERVICE_NOT_SUPPORTED: return "ServiceNotSupported";
+        case KWP2000NRC::SUB_FUNCTION_NOT_SUPPORTED: return "SubFunctionNotSupported";
+        case KWP2000NRC::BUSY_REPEAT_REQUEST: return "BusyRepeatRequest";
+        case KWP2000NRC::CONDITIONS_NOT_CORRECT: return "ConditionsNotCorrect";
+        case KWP2000NRC::REQUEST_SEQUENCE_ERROR: return "RequestSequenceError";
+        case KWP2000NRC::REQUEST_OUT_OF_RANGE: return "RequestOutOfRange";
+        case KWP2000NRC::SECURITY_ACCESS_DENIED: return "SecurityAccessDenied";
+        case KWP2000NRC::INVALID_KEY: return "InvalidKey";
+        case KWP2000NRC::EXCEED_NUMBER_OF_ATTEMPTS: return "ExceedNumberOfAttempts";
+        case KWP2000NRC::REQUIRED_TIME_DELAY_NOT_EXPIRED: return "RequiredTimeDelayNotExpired";
+        default: {
+            if (static_cast<uint8_t>(nrc) == RESPONSE_PENDING_NRC) {
+                return "ResponsePending";
+            }
+            std::ostringstream ss;
+            ss << "Unknown(0x" << std::hex << std::setw(2) << std::setfill('0')
+               << static_cast<int>(nrc) << ")";
+            return ss.str();
+        }
+    }
+}
+
+bool isValidKWP2000Service(uint8_t serviceId) {
+    switch (static_cast<KWP2000Service>(serviceId)) {
+        case KWP2000Service::START_DIAGNOSTIC_SESSION:
+        case KWP2000Service::ECU_RESET:
+        case KWP2000Service::READ_FAULT_MEMORY:
+        case KWP2000Service::CLEAR_FAULT_MEMORY:
+        case KWP2000Service::READ_STATUS_OF_FAULT_MEMORY:
+        case KWP2000Service::READ_FAULT_MEMORY_BY_STATUS:
+        case KWP2000Service::READ_DATA_BY_IDENTIFIER:
+        case KWP2000Service::READ_DATA_BY_ADDRESS:
+        case KWP2000Service::SECURITY_ACCESS:
+        case KWP2000Service::DISABLE_NORMAL_MESSAGE_TRANSMISSION:
+        case KWP2000Service::ENABLE_NORMAL_MESSAGE_TRANSMISSION:
+        case KWP2000Service::DYNAMICALLY_DEFINE_MESSAGE:
+        case KWP2000Service::WRITE_DATA_BY_IDENTIFIER:
+        case KWP2000Service::INPUT_OUTPUT_CONTROL_BY_IDENTIFIER:
+        case KWP2000Service::START_ROUTINE_BY_IDENTIFIER:
+        case KWP2000Service::STOP_ROUTINE_BY_IDENTIFIER:
+        case KWP2000Service::REQUEST_ROUTINE_RESULTS_BY_IDENTIFIER:
+        case KWP2000Service::REQUEST_DOWNLOAD:
+        case KWP2000Service::REQUEST_UPLOAD:
+        case KWP2000Service::TRANSFER_DATA:
+        case KWP2000Service::REQUEST_TRANSFER_EXIT:
+        case KWP2000Service::TESTER_PRESENT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint8_t calculateKWP2000Checksum(const std::vector<uint8_t>& data) {
+    uint8_t sum = 0;
+    for (uint8_t byte : data) {
+        sum = static_cast<uint8_t>(sum + byte);
+    }
+    return sum;
+}
+
+std::vector<uint8_t> encodeKWP2000Frame(const std::vector<uint8_t>& payload, bool addressHeader,
+                                        bool functional, uint8_t target, uint8_t source,
+                                        bool lengthInFormatByte, bool appendChecksum) {
+    if (payload.empty() || payload.size() > 255) {
+        return {};
+    }
+
+    std::vector<uint8_t> frame;
+    frame.reserve(payload.size() + 5);
+
+    uint8_t format = addressHeader ? (functional ? 0xC0 : 0x80) : 0x00;
+    bool inFormat = lengthInFormatByte && payload.size() <= 0x3F;
+    if (inFormat) {
+        format |= static_cast<uint8_t>(payload.size());
+    }
+
+    frame.push_back(format);
+    if (addressHeader) {
+        frame.push_back(target);
+        frame.push_back(source);
+    }
+    if (!inFormat) {
+        frame.push_back(static_cast<uint8_t>(payload.size()));
+    }
+    frame.insert(frame.end(), payload.begin(), payload.end());
+
+    if (appendChecksum) {
+        frame.push_back(calculateKWP2000Checksum(frame));
+    }
+    return frame;
+}
+
+bool decodeKWP2000Frame(const std::vector<uint8_t>& frame, std::vector<uint8_t>& payload,
+                        uint8_t* target, uint8_t* source) {
+    if (frame.empty()) {
+        return false;
+    }
+
+    uint8_t format = frame[0];
+    size_t position = 1;
+
+    // Any address mode other than 00 carries target and source bytes
+    if (format & 0xC0) {
+        if (frame.size() < position + 2) {
+            return false;
+        }
+        if (target) *target = frame[position];
+        if (source) *source = frame[position + 1];
+        position += 2;
+    }
+
+    size_t length = format & 0x3F;
+    if (length == 0) {
+        if (frame.size() < position + 1) {
+            return false;
+        }
+        length = frame[position++];
+    }
+
+    size_t end = position + length;
+    if (frame.size() == end + 1) {
+        uint8_t sum = 0;
+        for (size_t i = 0; i < end; ++i) {
+            sum = static_cast<uint8_t>(sum + frame[i]);
+        }
+        if (sum != frame[end]) {
+            return false;
+        }
+    } else if (frame.size() != end) {
+        return false;
+    }
+
+    payload.assign(frame.begin() + static_cast<std::ptrdiff_t>(position),
+                   frame.begin() + static_cast<std::ptrdiff_t>(end));
+    return true;
+}
+
+} // namespace protocols
+} // namespace fmus
@@ -0,0 +1,419 @@
+#include <fmus/protocols/socketcan.h>
+#include <fmus/logger.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+
+#ifdef __linux__
+    #include <linux/can.h>
+    #include <linux/can/error.h>
+    #include <linux/can/raw.h>
+    #include <linux/errqueue.h>
+    #include <linux/net_tstamp.h>
+    #include <net/if.h>
+    #include <poll.h>
+    #include <sys/ioctl.h>
+    #include <sys/socket.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
+namespace fmus {
+namespace protocols {
+
+#ifdef __linux__
+
+namespace {
+
+constexpr uint32_t DEFAULT_BATCH_SIZE = 32;
+constexpr int TX_RETRY_POLL_MS = 1;
+
+// Controller reports that stand for an error frame on the bus
+constexpr can_err_mask_t BUS_ERROR_MASK = CAN_ERR_PROT | CAN_ERR_BUSERROR | CAN_ERR_ACK;
+
+/**
+ * Control buffer for one received frame's SO_TIMESTAMPING data
+ */
+struct ControlBuffer {
+    alignas(cmsghdr) char data[CMSG_SPACE(sizeof(scm_timestamping))];
+};
+
+std::chrono::system_clock::time_point toTimePoint(const timespec& ts) {
+    return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)));
+}
+
+bool isSet(const timespec& ts) {
+    return ts.tv_sec != 0 || ts.tv_nsec != 0;
+}
+
+std::string systemError(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+} // anonymous namespace
+
+// SocketCANChannel implementation
+class SocketCANChannel::Impl {
+public:
+    int fd = -1;
+    CANConfig config;
+    std::atomic<uint64_t> errorFrames{0};
+    size_t batchSize = DEFAULT_BATCH_SIZE;
+
+    // Receive buffers, used only by the receiving thread
+    std::vector<canfd_frame> rxFrames;
+    std::vector<iovec> rxVectors;
+    std::vector<ControlBuffer> rxControl;
+    std::vector<mmsghdr> rxHeaders;
+
+    // Transmit buffers
+    std::mutex txMutex;
+    std::vector<canfd_frame> txFrames;
+    std::vector<iovec> txVectors;
+    std::vector<mmsghdr> txHeaders;
+
+    bool open(const CANConfig& cfg) {
+        auto logger = Logger::getInstance();
+        close();
+
+        unsigned int index = if_nametoindex(cfg.interfaceName.c_str());
+        if (index == 0) {
+            logger->error(systemError("SocketCAN interface " + cfg.interfaceName));
+            return false;
+        }
+
+        fd = ::socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
+        if (fd < 0) {
+            logger->error(systemError("Failed to create CAN socket"));
+            return false;
+        }
+
+        int on = 1;
+        if (cfg.fd) {
+            ifreq request{};
+            std::strncpy(request.ifr_name, cfg.interfaceName.c_str(), IFNAMSIZ - 1);
+            if (ioctl(fd, SIOCGIFMTU, &request) < 0 || request.ifr_mtu != CANFD_MTU ||
+                setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &on, sizeof(on)) < 0) {
+                logger->error("SocketCAN interface " + cfg.interfaceName + " is not CAN FD capable");
+                close();
+                return false;
+            }
+        }
+
+        can_err_mask_t errorMask = BUS_ERROR_MASK;
+        if (setsockopt(fd, SOL_CAN_RAW, CAN_RAW_ERR_FILTER, &errorMask, sizeof(errorMask)) < 0) {
+            logger->warning(systemError("CAN error frames unavailable"));
+        }
+
+        if (cfg.loopback && setsockopt(fd, SOL_CAN_RAW, CAN_RAW_RECV_OWN_MSGS, &on, sizeof(on)) < 0) {
+            logger->warning(systemError("Failed to enable CAN receive-own-messages"));
+        }
+
+        int stamping = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+        if (cfg.hardwareTimestamps) {
+            stamping |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+        }
+        if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &stamping, sizeof(stamping)) < 0) {
+            logger->warning(systemError("CAN timestamps unavailable, using receive time"));
+        }
+
+        sockaddr_can address{};
+        address.can_family = AF_CAN;
+        address.can_ifindex = static_cast<int>(index);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            logger->error(systemError("Failed to bind CAN socket to " + cfg.interfaceName));
+            close();
+            return false;
+        }
+
+        if (cfg.listenOnly) {
+            logger->warning("SocketCAN listen-only mode must be set on the link (ip link ... listen-only on)");
+        }
+
+        config = cfg;
+        batchSize = std::max<uint32_t>(cfg.rxBatchSize, 1);
+        rxFrames.assign(batchSize, canfd_frame{});
+        rxVectors.assign(batchSize, iovec{});
+        rxControl.assign(batchSize, ControlBuffer{});
+        rxHeaders.assign(batchSize, mmsghdr{});
+        {
+            std::lock_guard<std::mutex> lock(txMutex);
+            txFrames.assign(batchSize, canfd_frame{});
+            txVectors.assign(batchSize, iovec{});
+            txHeaders.assign(batchSize, mmsghdr{});
+        }
+
+        logger->info("SocketCAN opened on " + cfg.interfaceName);
+        return true;
+    }
+
+    void close() {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    bool setFilters(const std::vector<CANFilter>& filters) {
+        if (fd < 0) {
+            return false;
+        }
+
+        std::vector<can_filter> kernel;
+        for (const auto& filter : toSocketCANFilters(filters)) {
+            kernel.push_back(can_filter{filter.id, filter.mask});
+        }
+
+        if (setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER, kernel.data(),
+                       static_cast<socklen_t>(kernel.size() * sizeof(can_filter))) < 0) {
+            Logger::getInstance()->error(systemError("Failed to set CAN kernel filters"));
+            return false;
+        }
+        return true;
+    }
+
+    size_t encode(const CANMessage& message, canfd_frame& frame) {
+        std::memset(&frame, 0, sizeof(frame));
+        frame.can_id = message.extended ? ((message.id & CAN_EFF_MASK) | CAN_EFF_FLAG) : (message.id & CAN_SFF_MASK);
+        if (message.rtr) {
+            frame.can_id |= CAN_RTR_FLAG;
+        }
+        frame.len = static_cast<uint8_t>(std::min<size_t>(message.data.size(), CANFD_MAX_DLEN));
+        std::memcpy(frame.data, message.data.data(), frame.len);
+        if (!message.fd) {
+            return CAN_MTU;
+        }
+#ifdef CANFD_FDF
+        frame.flags |= CANFD_FDF;
+#endif
+        if (message.brs) {
+            frame.flags |= CANFD_BRS;
+        }
+        return CANFD_MTU;
+    }
+
+    size_t send(const CANMessage* messages, size_t count) {
+        if (fd < 0) {
+            return 0;
+        }
+
+        std::lock_guard<std::mutex> lock(txMutex);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config.txTimeout);
+        size_t sent = 0;
+        while (sent < count) {
+            size_t batch = std::min(count - sent, batchSize);
+            for (size_t i = 0; i < batch; ++i) {
+                txVectors[i].iov_base = &txFrames[i];
+                txVectors[i].iov_len = encode(messages[sent + i], txFrames[i]);
+                txHeaders[i] = mmsghdr{};
+                txHeaders[i].msg_hdr.msg_iov = &txVectors[i];
+                txHeaders[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            int result = sendmmsg(fd, txHeaders.data(), static_cast<unsigned int>(batch), MSG_DONTWAIT);
+            if (result > 0) {
+                sent += static_cast<size_t>(result);
+                continue;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) &&
+                std::chrono::steady_clock::now() < deadline) {
+                // ENOBUFS means a full device queue, which poll does not report; retry shortly
+                pollfd waiter{fd, POLLOUT, 0};
+                poll(&waiter, 1, TX_RETRY_POLL_MS);
+                continue;
+            }
+            Logger::getInstance()->error(systemError("SocketCAN send on " + config.interfaceName));
+            break;
+        }
+        return sent;
+    }
+
+    std::chrono::system_clock::time_point receiveTime(msghdr& header) {
+        for (cmsghdr* control = CMSG_FIRSTHDR(&header); control; control = CMSG_NXTHDR(&header, control)) {
+            if (control->cmsg_level != SOL_SOCKET || control->cmsg_type != SCM_TIMESTAMPING) {
+                continue;
+            }
+            scm_timestamping stamps;
+            std::memcpy(&stamps, CMSG_DATA(control), sizeof(stamps));
+            if (config.hardwareTimestamps && isSet(stamps.ts[2])) {
+                return toTimePoint(stamps.ts[2]);
+            }
+            if (isSet(stamps.ts[0])) {
+                return toTimePoint(stamps.ts[0]);
+            }
+        }
+        return std::chrono::system_clock::now();
+    }
+
+    size_t receive(std::vector<CANMessage>& messages, uint32_t timeout) {
+        if (fd < 0) {
+            return 0;
+        }
+
+        pollfd waiter{fd, POLLIN, 0};
+        if (poll(&waiter, 1, static_cast<int>(timeout)) <= 0) {
+            return 0;
+        }
+
+        for (size_t i = 0; i < batchSize; ++i) {
+            rxVectors[i].iov_base = &rxFrames[i];
+            rxVectors[i].iov_len = sizeof(canfd_frame);
+            rxHeaders[i] = mmsghdr{};
+            rxHeaders[i].msg_hdr.msg_iov = &rxVectors[i];
+            rxHeaders[i].msg_hdr.msg_iovlen = 1;
+            rxHeaders[i].msg_hdr.msg_control = rxControl[i].data;
+            rxHeaders[i].msg_hdr.msg_controllen = sizeof(rxControl[i].data);
+        }
+
+        int result = recvmmsg(fd, rxHeaders.data(), static_cast<unsigned int>(batchSize), MSG_DONTWAIT, nullptr);
+        if (result < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                Logger::getInstance()->error(systemError("SocketCAN receive on " + config.interfaceName));
+            }
+            return 0;
+        }
+
+        size_t appended = 0;
+        for (int i = 0; i < result; ++i) {
+            const canfd_frame& frame = rxFrames[i];
+            const unsigned int length = rxHeaders[i].msg_len;
+            if (length != CAN_MTU && length != CANFD_MTU) {
+                continue;
+            }
+            if (frame.can_id & CAN_ERR_FLAG) {
+                if (frame.can_id & BUS_ERROR_MASK) {
+                    errorFrames.fetch_add(1, std::memory_order_relaxed);
+                }
+                continue;
+            }
+
+            CANMessage message;
+            message.extended = (frame.can_id & CAN_EFF_FLAG) != 0;
+            message.id = frame.can_id & (message.extended ? CAN_EFF_MASK : CAN_SFF_MASK);
+            message.rtr = (frame.can_id & CAN_RTR_FLAG) != 0;
+            message.fd = length == CANFD_MTU;
+            if (message.fd) {
+                message.brs = (frame.flags & CANFD_BRS) != 0;
+                message.esi = (frame.flags & CANFD_ESI) != 0;
+            }
+            size_t size = std::min<size_t>(frame.len, message.fd ? CANFD_MAX_DLEN : CAN_MAX_DLEN);
+            if (!message.rtr) {
+                message.data.assign(frame.data, frame.data + size);
+            }
+            message.timestamp = receiveTime(rxHeaders[i].msg_hdr);
+            messages.push_back(std::move(message));
+            ++appended;
+        }
+        return appended;
+    }
+};
+
+#else
+
+// SocketCANChannel implementation for platforms without SocketCAN
+class SocketCANChannel::Impl {
+public:
+    int fd = -1;
+    CANConfig config;
+    std::atomic<uint64_t> errorFrames{0};
+
+    bool open(const CANConfig&) {
+        Logger::getInstance()->error("SocketCAN is only available on Linux");
+        return false;
+    }
+
+    void close() {}
+    bool setFilters(const std::vector<CANFilter>&) { return false; }
+    size_t send(const CANMessage*, size_t) { return 0; }
+    size_t receive(std::vector<CANMessage>&, uint32_t) { return 0; }
+};
+
+#endif
+
+SocketCANChannel::SocketCANChannel() : pImpl(std::make_unique<Impl>()) {}
+
+SocketCANChannel::~SocketCANChannel() {
+    close();
+}
+
+bool SocketCANChannel::open(const CANConfig& config) {
+    return pImpl->open(config);
+}
+
+void SocketCANChannel::close() {
+    pImpl->close();
+}
+
+bool SocketCANChannel::isOpen() const {
+    return pImpl->fd >= 0;
+}
+
+bool SocketCANChannel::setFilters(const std::vector<CANFilter>& filters) {
+    return pImpl->setFilters(filters);
+}
+
+size_t SocketCANChannel::send(const CANMessage* messages, size_t count) {
+    return pImpl->send(messages, count);
+}
+
+size_t SocketCANChannel::receive(std::vector<CANMessage>& messages, uint32_t timeout) {
+    return pImpl->receive(messages, timeout);
+}
+
+uint64_t SocketCANChannel::getErrorFrameCount() const {
+    return pImpl->errorFrames.load(std::memory_order_relaxed);
+}
+
+std::vector<SocketCANFilter> toSocketCANFilters(const std::vector<CANFilter>& filters) {
+    std::vector<SocketCANFilter> kernel;
+#ifdef __linux__
+    // Same OR semantics as CANFilter::matches; the software filters still run on dispatch
+    for (const auto& filter : filters) {
+        SocketCANFilter entry;
+        if (filter.extended) {
+            entry.id = (filter.id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+            entry.mask = (filter.mask & CAN_EFF_MASK) | CAN_EFF_FLAG;
+        } else {
+            entry.id = filter.id & CAN_SFF_MASK;
+            entry.mask = (filter.mask & CAN_SFF_MASK) | CAN_EFF_FLAG;
+        }
+        if (!filter.passThrough) {
+            entry.id |= CAN_INV_FILTER;
+        }
+        kernel.push_back(entry);
+    }
+    if (kernel.empty() || kernel.size() > CAN_RAW_FILTER_MAX) {
+        kernel.assign(1, SocketCANFilter{});    // Everything
+    }
+#else
+    (void)filters;
+#endif
+    return kernel;
+}
+
+bool SocketCANChannel::isSupported() {
+#ifdef __linux__
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::string SocketCANChannel::toString() const {
+    std::ostringstream ss;
+    ss << "SocketCANChannel[Interface:" << pImpl->config.interfaceName
+       << ", FD:" << (pImpl->config.fd ? "Yes" : "No")
+       << ", Open:" << (isOpen() ? "Yes" : "No") << "]";
+    return ss.str();
+}
+
+} // namespace protocols
+} // namespace fmus
@@ -0,0 +1,224 @@
+#include <fmus/protocols/timing_engine.h>
+#include <fmus/logger.h>
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <cerrno>
+    #include <pthread.h>
+    #include <sched.h>
+    #include <time.h>
+#endif
+
+namespace fmus {
+namespace protocols {
+
+namespace {
+
+using Microseconds = std::chrono::microseconds;
+
+Microseconds toMicroseconds(TimingEngine::Clock::duration duration) {
+    return std::chrono::duration_cast<Microseconds>(duration);
+}
+
+void blockUntil(TimingEngine::Clock::time_point deadline) {
+#if defined(_WIN32)
+    std::this_thread::sleep_until(deadline);
+#else
+    // steady_clock is CLOCK_MONOTONIC on the platforms we build for
+    auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch());
+    if (sinceEpoch.count() <= 0) {
+        return;
+    }
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(sinceEpoch.count() / 1000000000LL);
+    ts.tv_nsec = static_cast<long>(sinceEpoch.count() % 1000000000LL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+#endif
+}
+
+} // anonymous namespace
+
+class TimingEngine::Impl {
+public:
+    Config config;
+
+    mutable std::mutex mutex;
+    std::array<TimingLimits, 4> limits;
+    Statistics stats;
+
+    // Running sums for the averages
+    std::array<int64_t, 4> totals{};
+    int64_t overshootTotal = 0;
+
+    explicit Impl(const Config& cfg) : config(cfg) {
+        stats.startTime = std::chrono::system_clock::now();
+    }
+
+    void recordOvershoot(Microseconds overshoot) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.waits++;
+        overshootTotal += overshoot.count();
+        stats.maxOvershoot = std::max(stats.maxOvershoot, overshoot);
+        stats.averageOvershoot = Microseconds(overshootTotal / static_cast<int64_t>(stats.waits));
+    }
+};
+
+TimingEngine::TimingEngine() : TimingEngine(Config{}) {}
+
+TimingEngine::TimingEngine(const Config& config)
+    : pImpl(std::make_unique<Impl>(config)) {}
+
+TimingEngine::~TimingEngine() = default;
+
+void TimingEngine::setLimits(TimingParameter parameter, const TimingLimits& limits) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->limits[static_cast<size_t>(parameter)] = limits;
+}
+
+TimingLimits TimingEngine::getLimits(TimingParameter parameter) const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->limits[static_cast<size_t>(parameter)];
+}
+
+TimingEngine::Clock::time_point TimingEngine::sleepUntil(Clock::time_point deadline) {
+    auto now = Clock::now();
+    if (now >= deadline) {
+        return now;
+    }
+
+    auto spinStart = deadline - pImpl->config.spinThreshold;
+    if (now < spinStart) {
+        blockUntil(spinStart);
+    }
+
+    do {
+        now = Clock::now();
+    } while (now < deadline);
+
+    pImpl->recordOvershoot(toMicroseconds(now - deadline));
+    return now;
+}
+
+TimingEngine::Clock::time_point TimingEngine::sleepFor(Clock::duration duration) {
+    return sleepUntil(Clock::now() + duration);
+}
+
+bool TimingEngine::pinCurrentThread() {
+    if (pImpl->config.cpuCore < 0) {
+        return false;
+    }
+    return pinThreadToCore(pImpl->config.cpuCore);
+}
+
+bool TimingEngine::pinThreadToCore(int core) {
+    if (core < 0) {
+        return false;
+    }
+
+    bool pinned = false;
+#if defined(_WIN32)
+    if (core < static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+        pinned = SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << core) != 0;
+    }
+#elif defined(__linux__)
+    if (core < CPU_SETSIZE) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        pinned = pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    }
+#endif
+
+    if (!pinned) {
+        Logger::getInstance()->warning("Failed to pin timing thread to core " + std::to_string(core));
+    }
+    return pinned;
+}
+
+bool TimingEngine::record(TimingParameter parameter, Clock::duration measured) {
+    auto value = toMicroseconds(measured);
+    size_t index = static_cast<size_t>(parameter);
+    bool violation = false;
+
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+        const TimingLimits& limits = pImpl->limits[index];
+        violation = (limits.min.count() > 0 && value < limits.min) ||
+                    (limits.max.count() > 0 && value > limits.max);
+
+        ParameterStatistics& entry = pImpl->stats.parameters[index];
+        entry.minimum = entry.samples == 0 ? value : std::min(entry.minimum, value);
+        entry.maximum = entry.samples == 0 ? value : std::max(entry.maximum, value);
+        entry.samples++;
+        pImpl->totals[index] += value.count();
+        entry.average = Microseconds(pImpl->totals[index] / static_cast<int64_t>(entry.samples));
+        if (violation) {
+            entry.violations++;
+        }
+    }
+
+    if (violation) {
+        TimingLimits limits = getLimits(parameter);
+        std::ostringstream ss;
+        ss << timingParameterToString(parameter) << " timing violation: " << value.count()
+           << "us outside [" << limits.min.count() << "us, ";
+        if (limits.max.count() > 0) {
+            ss << limits.max.count() << "us]";
+        } else {
+            ss << "-]";
+        }
+        Logger::getInstance()->warning(ss.str());
+    }
+    return !violation;
+}
+
+TimingEngine::Statistics TimingEngine::getStatistics() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->stats;
+}
+
+void TimingEngine::resetStatistics() {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->stats = Statistics{};
+    pImpl->stats.startTime = std::chrono::system_clock::now();
+    pImpl->totals.fill(0);
+    pImpl->overshootTotal = 0;
+}
+
+std::string TimingEngine::toString() const {
+    Statistics stats = getStatistics();
+    std::ostringstream ss;
+    ss << "TimingEngine[Waits:" << stats.waits
+       << ", MaxOvershoot:" << stats.maxOvershoot.count() << "us"
+       << ", AvgOvershoot:" << stats.averageOvershoot.count() << "us";
+    for (size_t i = 0; i < stats.parameters.size(); ++i) {
+        const auto& entry = stats.parameters[i];
+        if (entry.samples == 0) {
+            continue;
+        }
+        ss << ", " << timingParameterToString(static_cast<TimingParameter>(i)) << ":"
+           << entry.minimum.count() << "/" << entry.average.count() << "/" << entry.maximum.count()
+           << "us (" << entry.violations << " violations)";
+    }
+    ss << "]";
+    return ss.str();
+}
+
+std::string timingParameterToString(TimingParameter parameter) {
+    switch (parameter) {
+        case TimingParameter::P1: return "P1";
+        case TimingParameter::P2: return "P2";
+        case TimingParameter::P3: return "P3";
+        case TimingParameter::P4: return "P4";
+        default: return "Unknown";
+    }
+}
+
+} // namespace protocols
+} // namespace fmus
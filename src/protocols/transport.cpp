@@ -0,0 +1,1293 @@
+#include <fmus/protocols/transport.h>
+#include <fmus/protocols/kwp2000.h>
+#include <fmus/protocols/timing_engine.h>
+#include <fmus/logger.h>
+#include <fmus/utils.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace fmus {
+namespace protocols {
+
+namespace {
+
+constexpr size_t CAN_FRAME_SIZE = 8;
+constexpr size_t ISOTP_MAX_PDU = 4095;
+constexpr size_t ISOTP_FD_MAX_PDU = 0xFFFF;
+constexpr size_t SINGLE_FRAME_MAX = 7;
+constexpr size_t SINGLE_FRAME_ESCAPE_PCI = 2;     // 0x00 and SF_DL
+constexpr size_t FIRST_FRAME_PCI = 2;
+constexpr size_t FIRST_FRAME_ESCAPE_PCI = 6;      // 0x10 0x00 and 32-bit FF_DL
+constexpr uint8_t PCI_SINGLE = 0x00;
+constexpr uint8_t PCI_FIRST = 0x10;
+constexpr uint8_t PCI_CONSECUTIVE = 0x20;
+constexpr uint8_t PCI_FLOW_CONTROL = 0x30;
+constexpr uint8_t FLOW_CONTINUE = 0x00;
+constexpr uint8_t FLOW_WAIT = 0x01;
+constexpr uint8_t FLOW_OVERFLOW = 0x02;
+constexpr int MAX_FLOW_WAITS = 10;
+
+constexpr uint32_t OBD_RESPONSE_FIRST = 0x7E8;
+constexpr uint32_t OBD_RESPONSE_LAST = 0x7EF;
+constexpr uint32_t OBD_PHYSICAL_OFFSET = 8;
+constexpr uint32_t NORMAL_FIXED_MASK = 0x00FF0000;      // 29-bit normal fixed addressing: PF byte
+constexpr uint32_t NORMAL_FIXED_PHYSICAL = 0x00DA0000;
+
+constexpr size_t DOIP_ADDRESS_OVERHEAD = 4;
+constexpr size_t KLINE_MAX_PDU = 255;
+constexpr size_t KLINE_FORMAT_LENGTH_MAX = 63;
+
+// VW TP 2.0
+constexpr uint8_t TP20_SETUP_REQUEST = 0xC0;
+constexpr uint8_t TP20_SETUP_ACCEPT = 0xD0;
+constexpr uint8_t TP20_PARAMS_REQUEST = 0xA0;
+constexpr uint8_t TP20_PARAMS_RESPONSE = 0xA1;
+constexpr uint8_t TP20_CHANNEL_TEST = 0xA3;
+constexpr uint8_t TP20_BREAK = 0xA4;
+constexpr uint8_t TP20_DISCONNECT = 0xA8;
+constexpr uint8_t TP20_ID_INVALID = 0x10;       // Validity bit in the high byte of a channel ID
+constexpr uint8_t TP20_UNUSED = 0xFF;           // T2 and T4 are not used
+
+// Data packet opcodes (high nibble; the low nibble is the sequence number)
+constexpr uint8_t TP20_WAIT_ACK_MORE = 0x0;
+constexpr uint8_t TP20_WAIT_ACK_LAST = 0x1;
+constexpr uint8_t TP20_MORE = 0x2;
+constexpr uint8_t TP20_LAST = 0x3;
+constexpr uint8_t TP20_ACK_NOT_READY = 0x9;
+constexpr uint8_t TP20_ACK = 0xB;
+
+constexpr size_t TP20_FRAME_DATA = 7;
+constexpr size_t TP20_LENGTH_BYTES = 2;
+constexpr size_t TP20_MAX_PDU = 0xFFFF;
+constexpr int TP20_MAX_NOT_READY = 10;
+constexpr int TP20_MAX_TEST_MISSES = 3;
+constexpr int64_t TP20_TIME_UNITS_US[] = {100, 1000, 10000, 100000};
+
+} // anonymous namespace
+
+std::string TransportCapabilities::toString() const {
+    std::ostringstream ss;
+    ss << "TransportCapabilities[" << name
+       << ", MaxPDU:" << maxPduSize
+       << ", BS:" << static_cast<int>(blockSize)
+       << ", STmin:" << separationTime.count() << "us"
+       << ", P2:" << p2Timeout.count() << "ms"
+       << ", P2*:" << p2StarTimeout.count() << "ms"
+       << ", Functional:" << (functionalAddressing ? "Yes" : "No") << "]";
+    return ss.str();
+}
+
+std::string Tp20Config::toString() const {
+    std::ostringstream ss;
+    ss << "Tp20Config[Module:0x" << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(moduleAddress)
+       << ", App:0x" << std::setw(2) << static_cast<int>(applicationType) << std::dec << std::setfill(' ')
+       << ", BS:" << static_cast<int>(blockSize)
+       << ", T1:" << ackTimeout.count() << "us"
+       << ", T3:" << packetInterval.count() << "us"
+       << ", KeepAlive:" << keepAliveInterval << "ms]";
+    return ss.str();
+}
+
+std::string IsoTpConfig::toString() const {
+    std::ostringstream ss;
+    ss << "IsoTpConfig[Tx:0x" << std::hex << txId
+       << ", Rx:0x" << rxId;
+    for (uint32_t id : extraRxIds) {
+        ss << "/0x" << id;
+    }
+    ss << std::dec
+       << ", BS:" << static_cast<int>(blockSize)
+       << ", STmin:0x" << std::hex << static_cast<int>(stMin) << std::dec
+       << ", Padding:" << (padFrames ? "Yes" : "No");
+    if (canFd) {
+        ss << ", FD TX_DL:" << static_cast<int>(txDataLength) << (bitRateSwitch ? " BRS" : "");
+    }
+    ss << "]";
+    return ss.str();
+}
+
+// IsoTpTransport implementation
+class IsoTpTransport::Impl {
+public:
+    std::shared_ptr<CANProtocol> canProtocol;
+    IsoTpConfig config;
+    uint32_t listenerId = 0;
+
+    std::mutex handlerMutex;
+    ReceiveHandler handler;
+
+    // Reassembly per responder
+    struct Reassembly {
+        std::vector<uint8_t> data;
+        size_t expected = 0;
+        uint8_t nextSequence = 1;
+        uint8_t framesInBlock = 0;
+        std::chrono::steady_clock::time_point lastFrame;
+    };
+    std::mutex rxMutex;
+    std::map<uint32_t, Reassembly> reassemblies;
+
+    // Flow control from the receiver of our multi-frame sends
+    std::mutex sendMutex;
+    std::mutex flowMutex;
+    std::condition_variable flowCondition;
+    bool awaitingFlow = false;
+    bool flowReceived = false;
+    uint8_t flowStatus = FLOW_CONTINUE;
+    uint8_t flowBlockSize = 0;
+    uint8_t flowStMin = 0;
+
+    TimingEngine timing;
+
+    bool isResponder(uint32_t id) const {
+        return id == config.rxId ||
+               std::find(config.extraRxIds.begin(), config.extraRxIds.end(), id) != config.extraRxIds.end();
+    }
+
+    /**
+     * Flow control goes to the responder's physical request ID, which for a
+     * functional request differs from txId: 0x7E8-0x7EF answer on 0x7E0-0x7E7
+     * and 0x18DAF1xx on 0x18DAxxF1 (ISO 15765-4).
+     */
+    uint32_t flowControlIdFor(uint32_t source) const {
+        if (source == config.rxId && config.flowControlId) {
+            return config.flowControlId;
+        }
+        if (!config.extendedIds && source >= OBD_RESPONSE_FIRST && source <= OBD_RESPONSE_LAST) {
+            return source - OBD_PHYSICAL_OFFSET;
+        }
+        if (config.extendedIds && (source & NORMAL_FIXED_MASK) == NORMAL_FIXED_PHYSICAL) {
+            return (source & ~0xFFFFu) | ((source & 0xFF) << 8) | ((source >> 8) & 0xFF);
+        }
+        return config.flowControlId ? config.flowControlId : config.txId;
+    }
+
+    size_t frameSize() const {
+        return config.canFd ? canFdLength(std::max<size_t>(config.txDataLength, CAN_FRAME_SIZE)) : CAN_FRAME_SIZE;
+    }
+
+    size_t maxPdu() const {
+        return config.canFd ? ISOTP_FD_MAX_PDU : ISOTP_MAX_PDU;
+    }
+
+    bool writeFrame(uint32_t id, std::vector<uint8_t> data) {
+        if (data.size() > CAN_FRAME_SIZE) {
+            // CAN FD frames are filled up to the next DLC size
+            data.resize(canFdLength(data.size()), config.padding);
+        } else if (config.padFrames && data.size() < CAN_FRAME_SIZE) {
+            data.resize(CAN_FRAME_SIZE, config.padding);
+        }
+        CANMessage frame(id, data, config.extendedIds);
+        frame.fd = config.canFd;
+        frame.brs = config.canFd && config.bitRateSwitch;
+        return canProtocol->sendMessage(frame);
+    }
+
+    bool sendFlowControl(uint32_t source) {
+        return writeFrame(flowControlIdFor(source),
+                          {static_cast<uint8_t>(PCI_FLOW_CONTROL | FLOW_CONTINUE), config.blockSize, config.stMin});
+    }
+
+    void deliver(uint32_t source, const uint8_t* data, size_t length) {
+        std::lock_guard<std::mutex> lock(handlerMutex);
+        if (handler) {
+            handler(source, data, length);
+        }
+    }
+
+    void onFrame(const CANMessage& frame) {
+        if (frame.extended != config.extendedIds || !isResponder(frame.id)) {
+            return;
+        }
+
+        IsoTpPci pci;
+        if (!parseIsoTpPci(frame.data.data(), frame.data.size(), pci)) {
+            return;
+        }
+        const auto& bytes = frame.data;
+
+        switch (pci.type) {
+            case IsoTpFrameType::SINGLE:
+                deliver(frame.id, bytes.data() + pci.payloadOffset, pci.dataLength);
+                break;
+            case IsoTpFrameType::FIRST: {
+                {
+                    std::lock_guard<std::mutex> lock(rxMutex);
+                    Reassembly& r = reassemblies[frame.id];
+                    r.data.assign(bytes.begin() + pci.payloadOffset, bytes.end());
+                    r.data.reserve(pci.dataLength);
+                    r.expected = pci.dataLength;
+                    r.nextSequence = 1;
+                    r.framesInBlock = 0;
+                    r.lastFrame = std::chrono::steady_clock::now();
+                }
+                sendFlowControl(frame.id);
+                break;
+            }
+            case IsoTpFrameType::CONSECUTIVE: {
+                std::vector<uint8_t> complete;
+                bool needFlowControl = false;
+                {
+                    std::lock_guard<std::mutex> lock(rxMutex);
+                    auto it = reassemblies.find(frame.id);
+                    if (it == reassemblies.end()) {
+                        return;
+                    }
+                    Reassembly& r = it->second;
+                    auto now = std::chrono::steady_clock::now();
+                    if (pci.sequence != r.nextSequence ||
+                        now - r.lastFrame > std::chrono::milliseconds(config.consecutiveFrameTimeout)) {
+                        Logger::getInstance()->warning("ISO-TP reassembly aborted for " +
+                                                       canIdToString(frame.id, config.extendedIds));
+                        reassemblies.erase(it);
+                        return;
+                    }
+                    r.lastFrame = now;
+                    r.nextSequence = (r.nextSequence + 1) & 0x0F;
+                    size_t take = std::min(bytes.size() - pci.payloadOffset, r.expected - r.data.size());
+                    r.data.insert(r.data.end(), bytes.begin() + pci.payloadOffset,
+                                  bytes.begin() + pci.payloadOffset + take);
+
+                    if (r.data.size() >= r.expected) {
+                        complete = std::move(r.data);
+                        reassemblies.erase(it);
+                    } else if (config.blockSize && ++r.framesInBlock == config.blockSize) {
+                        r.framesInBlock = 0;
+                        needFlowControl = true;
+                    }
+                }
+                if (!complete.empty()) {
+                    deliver(frame.id, complete.data(), complete.size());
+                } else if (needFlowControl) {
+                    sendFlowControl(frame.id);
+                }
+                break;
+            }
+            case IsoTpFrameType::FLOW_CONTROL: {
+                if (frame.id != config.rxId) {
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(flowMutex);
+                if (awaitingFlow) {
+                    flowStatus = pci.flowStatus;
+                    flowBlockSize = pci.blockSize;
+                    flowStMin = pci.stMin;
+                    flowReceived = true;
+                    flowCondition.notify_one();
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    /**
+     * Wait for flow control, following WAIT frames; false on timeout or overflow
+     */
+    bool awaitFlowControl() {
+        std::unique_lock<std::mutex> lock(flowMutex);
+        for (int waits = 0; waits <= MAX_FLOW_WAITS; ++waits) {
+            if (!flowCondition.wait_for(lock, std::chrono::milliseconds(config.flowControlTimeout),
+                                        [this] { return flowReceived; })) {
+                Logger::getInstance()->warning("ISO-TP flow control timeout from " +
+                                               canIdToString(config.rxId, config.extendedIds));
+                return false;
+            }
+            flowReceived = false;
+            if (flowStatus == FLOW_CONTINUE) {
+                return true;
+            }
+            if (flowStatus != FLOW_WAIT) {
+                Logger::getInstance()->warning("ISO-TP receiver reported overflow");
+                return false;
+            }
+        }
+        return false;
+    }
+
+    void setAwaitingFlow(bool awaiting) {
+        std::lock_guard<std::mutex> lock(flowMutex);
+        awaitingFlow = awaiting;
+        flowReceived = false;
+    }
+
+    bool sendSegmented(const uint8_t* data, size_t length) {
+        setAwaitingFlow(true);
+
+        const size_t capacity = frameSize();
+        std::vector<uint8_t> frame;
+        frame.reserve(capacity);
+        if (length <= ISOTP_MAX_PDU) {
+            frame = {static_cast<uint8_t>(PCI_FIRST | (length >> 8)), static_cast<uint8_t>(length)};
+        } else {
+            frame = {PCI_FIRST, 0x00, static_cast<uint8_t>(length >> 24), static_cast<uint8_t>(length >> 16),
+                     static_cast<uint8_t>(length >> 8), static_cast<uint8_t>(length)};
+        }
+        size_t offset = capacity - frame.size();
+        frame.insert(frame.end(), data, data + offset);
+        bool ok = writeFrame(config.txId, frame) && awaitFlowControl();
+
+        uint8_t sequence = 1;
+        while (ok && offset < length) {
+            uint8_t blockSize;
+            std::chrono::microseconds separation;
+            {
+                std::lock_guard<std::mutex> lock(flowMutex);
+                blockSize = flowBlockSize;
+                separation = isoTpSeparationTime(flowStMin);
+            }
+
+            for (uint8_t sent = 0; offset < length && (blockSize == 0 || sent < blockSize); ++sent) {
+                if (sent > 0) {
+                    timing.sleepFor(separation);
+                }
+                size_t take = std::min(capacity - 1, length - offset);
+                frame.assign(1, static_cast<uint8_t>(PCI_CONSECUTIVE | sequence));
+                frame.insert(frame.end(), data + offset, data + offset + take);
+                if (!writeFrame(config.txId, frame)) {
+                    ok = false;
+                    break;
+                }
+                offset += take;
+                sequence = (sequence + 1) & 0x0F;
+            }
+
+            if (ok && offset < length) {
+                ok = awaitFlowControl();
+            }
+        }
+
+        setAwaitingFlow(false);
+        return ok;
+    }
+};
+
+IsoTpTransport::IsoTpTransport(std::shared_ptr<CANProtocol> canProtocol, const IsoTpConfig& config)
+    : pImpl(std::make_unique<Impl>()) {
+    pImpl->canProtocol = std::move(canProtocol);
+    pImpl->config = config;
+}
+
+IsoTpTransport::~IsoTpTransport() {
+    close();
+}
+
+bool IsoTpTransport::open() {
+    if (pImpl->listenerId) {
+        return true;
+    }
+    if (!pImpl->canProtocol || !pImpl->canProtocol->isInitialized()) {
+        Logger::getInstance()->error("ISO-TP transport requires an initialized CAN protocol");
+        return false;
+    }
+    pImpl->listenerId = pImpl->canProtocol->addListener([impl = pImpl.get()](const CANMessage& frame) {
+        impl->onFrame(frame);
+    });
+    return pImpl->listenerId != 0;
+}
+
+void IsoTpTransport::close() {
+    if (pImpl->listenerId) {
+        pImpl->canProtocol->removeListener(pImpl->listenerId);
+        pImpl->listenerId = 0;
+    }
+    std::lock_guard<std::mutex> lock(pImpl->rxMutex);
+    pImpl->reassemblies.clear();
+}
+
+bool IsoTpTransport::isOpen() const {
+    return pImpl->listenerId != 0;
+}
+
+bool IsoTpTransport::send(const uint8_t* data, size_t length) {
+    if (!isOpen() || length == 0 || length > pImpl->maxPdu()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(pImpl->sendMutex);
+    if (length <= SINGLE_FRAME_MAX) {
+        std::vector<uint8_t> frame = {static_cast<uint8_t>(PCI_SINGLE | length)};
+        frame.insert(frame.end(), data, data + length);
+        return pImpl->writeFrame(pImpl->config.txId, std::move(frame));
+    }
+    if (length <= pImpl->frameSize() - SINGLE_FRAME_ESCAPE_PCI) {
+        std::vector<uint8_t> frame = {PCI_SINGLE, static_cast<uint8_t>(length)};
+        frame.insert(frame.end(), data, data + length);
+        return pImpl->writeFrame(pImpl->config.txId, std::move(frame));
+    }
+    return pImpl->sendSegmented(data, length);
+}
+
+void IsoTpTransport::setReceiveHandler(ReceiveHandler handler) {
+    std::lock_guard<std::mutex> lock(pImpl->handlerMutex);
+    pImpl->handler = std::move(handler);
+}
+
+TransportCapabilities IsoTpTransport::getCapabilities() const {
+    TransportCapabilities caps;
+    caps.name = pImpl->config.canFd ? "ISO-TP FD" : "ISO-TP";
+    caps.maxPduSize = pImpl->maxPdu();
+    caps.blockSize = pImpl->config.blockSize;
+    caps.separationTime = isoTpSeparationTime(pImpl->config.stMin);
+    caps.functionalAddressing = !pImpl->config.extraRxIds.empty();
+    return caps;
+}
+
+std::string IsoTpTransport::toString() const {
+    return "IsoTpTransport[" + pImpl->config.toString() + ", Open:" + (isOpen() ? "Yes" : "No") + "]";
+}
+
+IsoTpConfig IsoTpTransport::getConfiguration() const {
+    return pImpl->config;
+}
+
+// DoIPTransport implementation
+class DoIPTransport::Impl {
+public:
+    std::shared_ptr<DoIPClient> client;
+    uint16_t targetAddress = 0;
+    std::atomic<bool> opened{false};
+
+    std::mutex handlerMutex;
+    ReceiveHandler handler;
+};
+
+DoIPTransport::DoIPTransport(std::shared_ptr<DoIPClient> client, uint16_t targetAddress)
+    : pImpl(std::make_unique<Impl>()) {
+    pImpl->client = std::move(client);
+    pImpl->targetAddress = targetAddress;
+}
+
+DoIPTransport::~DoIPTransport() {
+    close();
+}
+
+bool DoIPTransport::open() {
+    if (pImpl->opened) {
+        return true;
+    }
+    if (!pImpl->client || !pImpl->client->isRoutingActive()) {
+        Logger::getInstance()->error("DoIP transport requires a connection with routing active");
+        return false;
+    }
+    pImpl->client->setDiagnosticHandler([impl = pImpl.get()](uint16_t source, uint16_t, const uint8_t* data,
+                                                             size_t length) {
+        std::lock_guard<std::mutex> lock(impl->handlerMutex);
+        if (impl->handler) {
+            impl->handler(source, data, length);
+        }
+    });
+    pImpl->opened = true;
+    return true;
+}
+
+void DoIPTransport::close() {
+    if (pImpl->opened.exchange(false)) {
+        pImpl->client->setDiagnosticHandler(nullptr);
+    }
+}
+
+bool DoIPTransport::isOpen() const {
+    return pImpl->opened && pImpl->client->isRoutingActive();
+}
+
+bool DoIPTransport::send(const uint8_t* data, size_t length) {
+    return isOpen() && pImpl->client->sendDiagnosticMessage(pImpl->targetAddress, data, length);
+}
+
+void DoIPTransport::setReceiveHandler(ReceiveHandler handler) {
+    std::lock_guard<std::mutex> lock(pImpl->handlerMutex);
+    pImpl->handler = std::move(handler);
+}
+
+TransportCapabilities DoIPTransport::getCapabilities() const {
+    DoIPConfig config = pImpl->client ? pImpl->client->getConfiguration() : DoIPConfig{};
+    TransportCapabilities caps;
+    caps.name = "DoIP";
+    caps.maxPduSize = config.maxPayloadSize - DOIP_ADDRESS_OVERHEAD;
+    // The entity answers after the gateway has routed the request on
+    caps.p2Timeout = std::chrono::milliseconds(config.diagnosticAckTimeout);
+    caps.functionalAddressing = true;
+    return caps;
+}
+
+std::string DoIPTransport::toString() const {
+    std::ostringstream ss;
+    ss << "DoIPTransport[Target:0x" << std::hex << std::setw(4) << std::setfill('0') << pImpl->targetAddress
+       << std::dec << ", Open:" << (isOpen() ? "Yes" : "No") << "]";
+    return ss.str();
+}
+
+// KLineTransport implementation
+class KLineTransport::Impl {
+public:
+    std::shared_ptr<j2534::PassThruChannel> channel;
+    KLineFraming framing;
+    mutable std::mutex framingMutex;
+
+    std::thread reader;
+    std::atomic<bool> running{false};
+
+    std::mutex handlerMutex;
+    ReceiveHandler handler;
+
+    void onFrame(const j2534::Message& frame) {
+        // Skip our own echoes and start-of-message indications
+        if (frame.flags & (j2534::J2534Constants::TX_MSG_TYPE | j2534::J2534Constants::START_OF_MESSAGE)) {
+            return;
+        }
+        if (frame.data.empty()) {
+            return;
+        }
+
+        std::vector<uint8_t> payload;
+        uint8_t target = 0;
+        uint8_t source = 0;
+        if (!decodeKWP2000Frame(frame.data, payload, &target, &source)) {
+            Logger::getInstance()->debug("Discarding malformed K-line frame: " + utils::bytesToHex(frame.data));
+            return;
+        }
+
+        KLineFraming current;
+        {
+            std::lock_guard<std::mutex> lock(framingMutex);
+            current = framing;
+        }
+        if (current.addressHeader && (frame.data[0] & 0xC0) == 0x80 && target != current.sourceAddress) {
+            return;     // Physically addressed to another tester
+        }
+        if (!current.addressHeader) {
+            source = current.targetAddress;
+        }
+
+        std::lock_guard<std::mutex> lock(handlerMutex);
+        if (handler) {
+            handler(source, payload.data(), payload.size());
+        }
+    }
+
+    void readLoop() {
+        std::vector<j2534::Message> frames;
+        while (running) {
+            frames.clear();
+            try {
+                channel->readMessages(frames, 16, 50);
+            } catch (const j2534::J2534Error& e) {
+                Logger::getInstance()->warning(std::string("K-line read failed: ") + e.what());
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                continue;
+            }
+            for (const auto& frame : frames) {
+                onFrame(frame);
+            }
+        }
+    }
+};
+
+KLineTransport::KLineTransport(std::shared_ptr<j2534::PassThruChannel> channel, const KLineFraming& framing)
+    : pImpl(std::make_unique<Impl>()) {
+    pImpl->channel = std::move(channel);
+    pImpl->framing = framing;
+}
+
+KLineTransport::~KLineTransport() {
+    close();
+}
+
+bool KLineTransport::open() {
+    if (pImpl->running) {
+        return true;
+    }
+    if (!pImpl->channel || !pImpl->channel->isConnected()) {
+        Logger::getInstance()->error("K-line transport requires a connected channel");
+        return false;
+    }
+    pImpl->running = true;
+    pImpl->reader = std::thread([impl = pImpl.get()] { impl->readLoop(); });
+    return true;
+}
+
+void KLineTransport::close() {
+    pImpl->running = false;
+    if (pImpl->reader.joinable()) {
+        pImpl->reader.join();
+    }
+}
+
+bool KLineTransport::isOpen() const {
+    return pImpl->running;
+}
+
+bool KLineTransport::send(const uint8_t* data, size_t length) {
+    if (!isOpen()) {
+        return false;
+    }
+
+    KLineFraming current = getFraming();
+    if (!current.lengthByte && length > KLINE_FORMAT_LENGTH_MAX) {
+        return false;
+    }
+    auto frame = encodeKWP2000Frame(std::vector<uint8_t>(data, data + length), current.addressHeader,
+                                    current.functional, current.targetAddress, current.sourceAddress,
+                                    current.lengthInFormatByte, false);
+    if (frame.empty()) {
+        return false;
+    }
+    try {
+        // Queue without waiting: the adapter releases it once P3min has elapsed
+        return pImpl->channel->writeMessage(j2534::Message(j2534::Protocol::ISO14230_4, 0, frame), 0);
+    } catch (const j2534::J2534Error& e) {
+        Logger::getInstance()->error(std::string("K-line write failed: ") + e.what());
+        return false;
+    }
+}
+
+void KLineTransport::setReceiveHandler(ReceiveHandler handler) {
+    std::lock_guard<std::mutex> lock(pImpl->handlerMutex);
+    pImpl->handler = std::move(handler);
+}
+
+TransportCapabilities KLineTransport::getCapabilities() const {
+    KLineFraming current = getFraming();
+    TransportCapabilities caps;
+    caps.name = "K-line";
+    caps.maxPduSize = current.lengthByte ? KLINE_MAX_PDU : KLINE_FORMAT_LENGTH_MAX;
+    caps.functionalAddressing = current.functional;
+    return caps;
+}
+
+std::string KLineTransport::toString() const {
+    KLineFraming current = getFraming();
+    std::ostringstream ss;
+    ss << "KLineTransport[Target:0x" << std::hex << std::setw(2) << std::setfill('0')
+       << static_cast<int>(current.targetAddress)
+       << ", Source:0x" << std::setw(2) << static_cast<int>(current.sourceAddress) << std::dec
+       << (current.addressHeader ? ", address header" : ", format-only header")
+       << ", Open:" << (isOpen() ? "Yes" : "No") << "]";
+    return ss.str();
+}
+
+void KLineTransport::setFraming(const KLineFraming& framing) {
+    std::lock_guard<std::mutex> lock(pImpl->framingMutex);
+    pImpl->framing = framing;
+}
+
+KLineFraming KLineTransport::getFraming() const {
+    std::lock_guard<std::mutex> lock(pImpl->framingMutex);
+    return pImpl->framing;
+}
+
+// Tp20Transport implementation
+class Tp20Transport::Impl {
+public:
+    std::shared_ptr<CANProtocol> canProtocol;
+    Tp20Config config;
+    uint32_t listenerId = 0;
+
+    std::mutex handlerMutex;
+    ReceiveHandler handler;
+
+    // Channel state
+    mutable std::mutex stateMutex;
+    std::condition_variable stateCondition;
+    bool connected = false;
+    bool stopKeepAlive = false;
+    uint32_t txId = 0;                          // Module receives on this ID
+    uint32_t rxId = 0;                          // Module transmits on this ID
+    uint8_t remoteBlockSize = 1;
+    std::chrono::microseconds remoteInterval{0};
+    std::vector<uint8_t> setupResponse;
+    bool paramsReceived = false;
+    int ackSequence = -1;                       // Next sequence the module expects; -1 until acknowledged
+    bool ackNotReady = false;
+    std::chrono::steady_clock::time_point lastActivity;
+
+    // Reassembly of the module's messages
+    std::mutex rxMutex;
+    std::vector<uint8_t> rxData;
+    size_t rxExpected = 0;
+    uint8_t rxSequence = 0;
+    bool rxActive = false;
+    bool rxDiscarding = false;                  // After a sequence error, until the broken message's last packet
+
+    // Serializes data packets and channel tests
+    std::mutex sendMutex;
+    uint8_t txSequence = 0;
+    std::thread keepAliveThread;
+    TimingEngine timing;
+
+    bool writeFrame(uint32_t id, std::vector<uint8_t> data) {
+        return canProtocol->sendMessage(CANMessage(id, data, false));
+    }
+
+    std::string moduleName() const {
+        return "module 0x" + utils::bytesToHex(&config.moduleAddress, 1);
+    }
+
+    std::vector<uint8_t> paramsFrame(uint8_t opcode) const {
+        return {opcode, config.blockSize, tp20TimingByte(config.ackTimeout), TP20_UNUSED,
+                tp20TimingByte(config.packetInterval), TP20_UNUSED};
+    }
+
+    void touch() {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        lastActivity = std::chrono::steady_clock::now();
+    }
+
+    void resetReassembly() {
+        std::lock_guard<std::mutex> lock(rxMutex);
+        rxData.clear();
+        rxExpected = 0;
+        rxSequence = 0;
+        rxActive = false;
+        rxDiscarding = false;
+    }
+
+    void deliver(uint32_t source, const uint8_t* data, size_t length) {
+        std::lock_guard<std::mutex> lock(handlerMutex);
+        if (handler) {
+            handler(source, data, length);
+        }
+    }
+
+    void onFrame(const CANMessage& frame) {
+        if (frame.extended || frame.data.empty()) {
+            return;
+        }
+        if (frame.id == config.setupId + config.moduleAddress) {
+            if (frame.data.size() >= 6 && (frame.data[1] & 0xF0) == TP20_SETUP_ACCEPT) {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                setupResponse = frame.data;
+                stateCondition.notify_all();
+            }
+            return;
+        }
+
+        uint32_t channelId;
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            channelId = rxId;
+        }
+        if (channelId == 0 || frame.id != channelId) {
+            return;
+        }
+
+        uint8_t opcode = frame.data[0];
+        if ((opcode & 0xF0) == 0xA0) {
+            onControl(frame.data);
+            return;
+        }
+
+        switch (opcode >> 4) {
+            case TP20_ACK:
+            case TP20_ACK_NOT_READY: {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                ackSequence = opcode & 0x0F;
+                ackNotReady = (opcode >> 4) == TP20_ACK_NOT_READY;
+                lastActivity = std::chrono::steady_clock::now();
+                stateCondition.notify_all();
+                break;
+            }
+            case TP20_WAIT_ACK_MORE:
+            case TP20_WAIT_ACK_LAST:
+            case TP20_MORE:
+            case TP20_LAST:
+                onData(frame.id, frame.data);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void onControl(const std::vector<uint8_t>& bytes) {
+        switch (bytes[0]) {
+            case TP20_PARAMS_RESPONSE: {
+                if (bytes.size() < 6) {
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(stateMutex);
+                remoteBlockSize = std::max<uint8_t>(bytes[1], 1);
+                remoteInterval = tp20Timing(bytes[4]);
+                paramsReceived = true;
+                lastActivity = std::chrono::steady_clock::now();
+                stateCondition.notify_all();
+                break;
+            }
+            case TP20_CHANNEL_TEST: {
+                uint32_t id;
+                {
+                    std::lock_guard<std::mutex> lock(stateMutex);
+                    id = txId;
+                }
+                writeFrame(id, paramsFrame(TP20_PARAMS_RESPONSE));
+                break;
+            }
+            case TP20_BREAK:
+                resetReassembly();
+                break;
+            case TP20_DISCONNECT: {
+                // Answer a disconnect from the module; ours is answered the same way
+                uint32_t id = 0;
+                {
+                    std::lock_guard<std::mutex> lock(stateMutex);
+                    if (connected) {
+                        connected = false;
+                        id = txId;
+                        stateCondition.notify_all();
+                    }
+                }
+                if (id) {
+                    Logger::getInstance()->warning("TP 2.0 channel closed by module");
+                    writeFrame(id, {TP20_DISCONNECT});
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    void onData(uint32_t source, const std::vector<uint8_t>& bytes) {
+        uint8_t type = bytes[0] >> 4;
+        uint8_t sequence = bytes[0] & 0x0F;
+        bool wantsAck = type == TP20_WAIT_ACK_MORE || type == TP20_WAIT_ACK_LAST;
+        bool last = type == TP20_WAIT_ACK_LAST || type == TP20_LAST;
+
+        std::vector<uint8_t> complete;
+        uint8_t next;
+        {
+            std::lock_guard<std::mutex> lock(rxMutex);
+            if (sequence != rxSequence && rxActive) {
+                Logger::getInstance()->warning("TP 2.0 sequence error, message dropped");
+                rxActive = false;
+                rxDiscarding = true;
+            }
+            rxSequence = next = (sequence + 1) & 0x0F;
+
+            // Packets carry no start marker: the next message begins after this one's last packet
+            size_t offset = 1;
+            if (rxDiscarding) {
+                rxDiscarding = !last;
+            } else if (!rxActive) {
+                if (bytes.size() < 1 + TP20_LENGTH_BYTES) {
+                    return;
+                }
+                rxExpected = (static_cast<size_t>(bytes[1]) << 8) | bytes[2];
+                rxData.clear();
+                rxData.reserve(rxExpected);
+                rxActive = true;
+                offset += TP20_LENGTH_BYTES;
+            }
+
+            if (rxActive) {
+                rxData.insert(rxData.end(), bytes.begin() + offset, bytes.end());
+            }
+            if (rxActive && (last || rxData.size() >= rxExpected)) {
+                rxActive = false;
+                if (rxData.size() < rxExpected) {
+                    Logger::getInstance()->warning("TP 2.0 message shorter than its length, dropped");
+                } else {
+                    rxData.resize(rxExpected);
+                    complete = std::move(rxData);
+                }
+                rxData.clear();
+            }
+        }
+
+        uint32_t id;
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            id = txId;
+            lastActivity = std::chrono::steady_clock::now();
+        }
+        if (wantsAck) {
+            writeFrame(id, {static_cast<uint8_t>((TP20_ACK << 4) | next)});
+        }
+        if (!complete.empty()) {
+            deliver(source, complete.data(), complete.size());
+        }
+    }
+
+    /**
+     * Wait for the module to acknowledge up to the given sequence, following not-ready ACKs
+     */
+    bool awaitAck(uint8_t expected) {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        for (int waits = 0; waits <= TP20_MAX_NOT_READY; ++waits) {
+            if (!stateCondition.wait_for(lock, config.ackTimeout,
+                                         [this] { return ackSequence >= 0 || !connected; })) {
+                Logger::getInstance()->warning("TP 2.0 acknowledgement timeout");
+                return false;
+            }
+            if (!connected) {
+                return false;
+            }
+            int acknowledged = ackSequence;
+            ackSequence = -1;
+            if (ackNotReady) {
+                continue;
+            }
+            if (acknowledged != expected) {
+                Logger::getInstance()->warning("TP 2.0 acknowledgement out of sequence");
+                return false;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    bool sendPdu(const uint8_t* data, size_t length) {
+        uint32_t id;
+        uint8_t blockSize;
+        std::chrono::microseconds interval;
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            id = txId;
+            blockSize = remoteBlockSize;
+            interval = remoteInterval;
+        }
+
+        // The first packet carries the length ahead of the PDU
+        const uint8_t header[TP20_LENGTH_BYTES] = {static_cast<uint8_t>(length >> 8), static_cast<uint8_t>(length)};
+        const size_t total = length + TP20_LENGTH_BYTES;
+        auto byteAt = [&](size_t position) {
+            return position < TP20_LENGTH_BYTES ? header[position] : data[position - TP20_LENGTH_BYTES];
+        };
+
+        std::vector<uint8_t> frame;
+        frame.reserve(1 + TP20_FRAME_DATA);
+        size_t offset = 0;
+        uint8_t inBlock = 0;
+        bool ok = true;
+        while (ok && offset < total) {
+            size_t take = std::min(TP20_FRAME_DATA, total - offset);
+            bool last = offset + take == total;
+            bool blockEnd = ++inBlock == blockSize;
+            uint8_t type = last ? TP20_WAIT_ACK_LAST : (blockEnd ? TP20_WAIT_ACK_MORE : TP20_MORE);
+
+            frame.assign(1, static_cast<uint8_t>((type << 4) | txSequence));
+            for (size_t i = 0; i < take; ++i) {
+                frame.push_back(byteAt(offset + i));
+            }
+            if (offset > 0) {
+                timing.sleepFor(interval);
+            }
+            if (last || blockEnd) {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                ackSequence = -1;
+                ackNotReady = false;
+            }
+
+            ok = writeFrame(id, frame);
+            txSequence = (txSequence + 1) & 0x0F;
+            offset += take;
+            if (ok && (last || blockEnd)) {
+                ok = awaitAck(txSequence);
+                inBlock = 0;
+            }
+        }
+
+        touch();
+        return ok;
+    }
+
+    bool channelTest() {
+        uint32_t id;
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            paramsReceived = false;
+            id = txId;
+        }
+        if (!writeFrame(id, {TP20_CHANNEL_TEST})) {
+            return false;
+        }
+        std::unique_lock<std::mutex> lock(stateMutex);
+        stateCondition.wait_for(lock, std::chrono::milliseconds(config.setupTimeout),
+                                [this] { return paramsReceived || stopKeepAlive || !connected; });
+        return paramsReceived;
+    }
+
+    void keepAliveLoop() {
+        const auto interval = std::chrono::milliseconds(config.keepAliveInterval);
+        int misses = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(stateMutex);
+                if (stateCondition.wait_for(lock, interval, [this] { return stopKeepAlive || !connected; })) {
+                    return;
+                }
+                if (std::chrono::steady_clock::now() - lastActivity < interval) {
+                    continue;
+                }
+            }
+
+            std::lock_guard<std::mutex> sending(sendMutex);
+            if (channelTest()) {
+                misses = 0;
+            } else if (++misses >= TP20_MAX_TEST_MISSES) {
+                Logger::getInstance()->warning("TP 2.0 channel lost: no answer to channel test");
+                std::lock_guard<std::mutex> lock(stateMutex);
+                connected = false;
+                stateCondition.notify_all();
+                return;
+            }
+        }
+    }
+
+    bool negotiate() {
+        auto logger = Logger::getInstance();
+        const uint16_t proposed = static_cast<uint16_t>(config.testerRxId);
+
+        if (!writeFrame(config.setupId, {config.moduleAddress, TP20_SETUP_REQUEST, 0x00, TP20_ID_INVALID,
+                                         static_cast<uint8_t>(proposed), static_cast<uint8_t>((proposed >> 8) & 0x07),
+                                         config.applicationType})) {
+            return false;
+        }
+
+        std::unique_lock<std::mutex> lock(stateMutex);
+        if (!stateCondition.wait_for(lock, std::chrono::milliseconds(config.setupTimeout),
+                                     [this] { return !setupResponse.empty(); })) {
+            logger->error("No TP 2.0 channel setup response from " + moduleName());
+            return false;
+        }
+        const auto& response = setupResponse;
+        if (response[1] != TP20_SETUP_ACCEPT || (response[3] & TP20_ID_INVALID) || (response[5] & TP20_ID_INVALID)) {
+            logger->error("TP 2.0 channel setup rejected by " + moduleName() +
+                          " (0x" + utils::bytesToHex(&response[1], 1) + ")");
+            return false;
+        }
+        rxId = response[2] | ((response[3] & 0x07) << 8);
+        txId = response[4] | ((response[5] & 0x07) << 8);
+        paramsReceived = false;
+        uint32_t id = txId;
+        lock.unlock();
+
+        if (!writeFrame(id, paramsFrame(TP20_PARAMS_REQUEST))) {
+            return false;
+        }
+        lock.lock();
+        if (!stateCondition.wait_for(lock, std::chrono::milliseconds(config.setupTimeout),
+                                     [this] { return paramsReceived; })) {
+            logger->error("No TP 2.0 timing parameters from " + moduleName());
+            return false;
+        }
+        connected = true;
+        lastActivity = std::chrono::steady_clock::now();
+        return true;
+    }
+};
+
+Tp20Transport::Tp20Transport(std::shared_ptr<CANProtocol> canProtocol, const Tp20Config& config)
+    : pImpl(std::make_unique<Impl>()) {
+    pImpl->canProtocol = std::move(canProtocol);
+    pImpl->config = config;
+}
+
+Tp20Transport::~Tp20Transport() {
+    close();
+}
+
+bool Tp20Transport::open() {
+    if (isOpen()) {
+        return true;
+    }
+    close();
+    if (!pImpl->canProtocol || !pImpl->canProtocol->isInitialized()) {
+        Logger::getInstance()->error("TP 2.0 transport requires an initialized CAN protocol");
+        return false;
+    }
+
+    pImpl->listenerId = pImpl->canProtocol->addListener([impl = pImpl.get()](const CANMessage& frame) {
+        impl->onFrame(frame);
+    });
+
+    std::lock_guard<std::mutex> sending(pImpl->sendMutex);
+    pImpl->txSequence = 0;
+    if (!pImpl->listenerId || !pImpl->negotiate()) {
+        pImpl->canProtocol->removeListener(pImpl->listenerId);
+        pImpl->listenerId = 0;
+        std::lock_guard<std::mutex> lock(pImpl->stateMutex);
+        pImpl->rxId = pImpl->txId = 0;
+        return false;
+    }
+
+    if (pImpl->config.keepAliveInterval > 0) {
+        pImpl->keepAliveThread = std::thread(&Impl::keepAliveLoop, pImpl.get());
+    }
+    Logger::getInstance()->info("TP 2.0 channel open: " + toString());
+    return true;
+}
+
+void Tp20Transport::close() {
+    {
+        std::lock_guard<std::mutex> lock(pImpl->stateMutex);
+        pImpl->stopKeepAlive = true;
+        pImpl->stateCondition.notify_all();
+    }
+    if (pImpl->keepAliveThread.joinable()) {
+        pImpl->keepAliveThread.join();
+    }
+
+    uint32_t id = 0;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->stateMutex);
+        if (pImpl->connected) {
+            pImpl->connected = false;
+            id = pImpl->txId;
+        }
+        pImpl->stateCondition.notify_all();
+    }
+    if (id) {
+        std::lock_guard<std::mutex> sending(pImpl->sendMutex);
+        pImpl->writeFrame(id, {TP20_DISCONNECT});
+    }
+
+    if (pImpl->listenerId) {
+        pImpl->canProtocol->removeListener(pImpl->listenerId);
+        pImpl->listenerId = 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pImpl->stateMutex);
+        pImpl->rxId = pImpl->txId = 0;
+        pImpl->setupResponse.clear();
+        pImpl->stopKeepAlive = false;
+    }
+    pImpl->resetReassembly();
+}
+
+bool Tp20Transport::isOpen() const {
+    std::lock_guard<std::mutex> lock(pImpl->stateMutex);
+    return pImpl->connected;
+}
+
+bool Tp20Transport::send(const uint8_t* data, size_t length) {
+    if (!isOpen() || length == 0 || length > TP20_MAX_PDU) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(pImpl->sendMutex);
+    return pImpl->sendPdu(data, length);
+}
+
+void Tp20Transport::setReceiveHandler(ReceiveHandler handler) {
+    std::lock_guard<std::mutex> lock(pImpl->handlerMutex);
+    pImpl->handler = std::move(handler);
+}
+
+TransportCapabilities Tp20Transport::getCapabilities() const {
+    TransportCapabilities caps;
+    caps.name = "TP2.0";
+    caps.maxPduSize = TP20_MAX_PDU;
+    std::lock_guard<std::mutex> lock(pImpl->stateMutex);
+    caps.blockSize = pImpl->remoteBlockSize;
+    caps.separationTime = pImpl->remoteInterval;
+    return caps;
+}
+
+std::string Tp20Transport::toString() const {
+    std::ostringstream ss;
+    std::lock_guard<std::mutex> lock(pImpl->stateMutex);
+    ss << "Tp20Transport[" << pImpl->config.toString()
+       << ", Tx:0x" << std::hex << pImpl->txId
+       << ", Rx:0x" << pImpl->rxId << std::dec
+       << ", BS:" << static_cast<int>(pImpl->remoteBlockSize)
+       << ", T3:" << pImpl->remoteInterval.count() << "us"
+       << ", Open:" << (pImpl->connected ? "Yes" : "No") << "]";
+    return ss.str();
+}
+
+Tp20Config Tp20Transport::getConfiguration() const {
+    return pImpl->config;
+}
+
+// Utility functions
+std::chrono::microseconds isoTpSeparationTime(uint8_t stMin) {
+    if (stMin <= 0x7F) {
+        return std::chrono::milliseconds(stMin);
+    }
+    if (stMin >= 0xF1 && stMin <= 0xF9) {
+        return std::chrono::microseconds((stMin - 0xF0) * 100);
+    }
+    // Reserved values mean the longest separation time
+    return std::chrono::milliseconds(0x7F);
+}
+
+bool parseIsoTpPci(const uint8_t* data, size_t length, IsoTpPci& pci) {
+    pci = IsoTpPci();
+    if (length == 0) {
+        return false;
+    }
+
+    switch (data[0] & 0xF0) {
+        case PCI_SINGLE:
+            pci.dataLength = data[0] & 0x0F;
+            pci.payloadOffset = 1;
+            if (pci.dataLength == 0 && length > CAN_FRAME_SIZE) {
+                pci.dataLength = data[1];
+                pci.payloadOffset = SINGLE_FRAME_ESCAPE_PCI;
+            }
+            if (pci.dataLength == 0 || pci.dataLength + pci.payloadOffset > length) {
+                return false;
+            }
+            pci.type = IsoTpFrameType::SINGLE;
+            return true;
+        case PCI_FIRST:
+            if (length < CAN_FRAME_SIZE) {
+                return false;
+            }
+            pci.dataLength = (static_cast<size_t>(data[0] & 0x0F) << 8) | data[1];
+            pci.payloadOffset = FIRST_FRAME_PCI;
+            if (pci.dataLength == 0) {
+                pci.dataLength = (static_cast<size_t>(data[2]) << 24) | (static_cast<size_t>(data[3]) << 16) |
+                                 (static_cast<size_t>(data[4]) << 8) | data[5];
+                pci.payloadOffset = FIRST_FRAME_ESCAPE_PCI;
+            }
+            // A payload that fits in the first frame belongs in a single frame
+            if (pci.dataLength <= length - pci.payloadOffset || pci.dataLength > ISOTP_FD_MAX_PDU) {
+                return false;
+            }
+            pci.type = IsoTpFrameType::FIRST;
+            return true;
+        case PCI_CONSECUTIVE:
+            pci.sequence = data[0] & 0x0F;
+            pci.payloadOffset = 1;
+            pci.type = IsoTpFrameType::CONSECUTIVE;
+            return true;
+        case PCI_FLOW_CONTROL:
+            if (length < 3) {
+                return false;
+            }
+            pci.flowStatus = data[0] & 0x0F;
+            pci.blockSize = data[1];
+            pci.stMin = data[2];
+            pci.type = IsoTpFrameType::FLOW_CONTROL;
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::chrono::microseconds tp20Timing(uint8_t value) {
+    return std::chrono::microseconds(TP20_TIME_UNITS_US[value >> 6] * (value & 0x3F));
+}
+
+uint8_t tp20TimingByte(std::chrono::microseconds time) {
+    int64_t us = std::max<int64_t>(time.count(), 0);
+    for (uint8_t scale = 0; scale < 4; ++scale) {
+        int64_t unit = TP20_TIME_UNITS_US[scale];
+        int64_t count = (us + unit - 1) / unit;
+        if (count <= 0x3F) {
+            return static_cast<uint8_t>((scale << 6) | count);
+        }
+    }
+    return TP20_UNUSED;
+}
+
+} // namespace protocols
+} // namespace fmus
@@ -0,0 +1,825 @@
+#include <fmus/protocols/xcp.h>
+#include <fmus/logger.h>
+#include <fmus/utils.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+namespace fmus {
+namespace protocols {
+
+namespace {
+
+// Commands
+constexpr uint8_t CMD_CONNECT = 0xFF;
+constexpr uint8_t CMD_DISCONNECT = 0xFE;
+constexpr uint8_t CMD_SET_DAQ_PTR = 0xE2;
+constexpr uint8_t CMD_WRITE_DAQ = 0xE1;
+constexpr uint8_t CMD_SET_DAQ_LIST_MODE = 0xE0;
+constexpr uint8_t CMD_START_STOP_DAQ_LIST = 0xDE;
+constexpr uint8_t CMD_START_STOP_SYNCH = 0xDD;
+constexpr uint8_t CMD_GET_DAQ_CLOCK = 0xDC;
+constexpr uint8_t CMD_GET_DAQ_PROCESSOR_INFO = 0xDA;
+constexpr uint8_t CMD_GET_DAQ_RESOLUTION_INFO = 0xD9;
+constexpr uint8_t CMD_FREE_DAQ = 0xD6;
+constexpr uint8_t CMD_ALLOC_DAQ = 0xD5;
+constexpr uint8_t CMD_ALLOC_ODT = 0xD4;
+constexpr uint8_t CMD_ALLOC_ODT_ENTRY = 0xD3;
+
+// Packet identifiers from the slave; lower values are DAQ PIDs
+constexpr uint8_t PID_RES = 0xFF;
+constexpr uint8_t PID_ERR = 0xFE;
+constexpr uint8_t PID_EV = 0xFD;
+constexpr uint8_t PID_SERV = 0xFC;
+
+// Events
+constexpr uint8_t EV_CMD_PENDING = 0x05;
+constexpr uint8_t EV_DAQ_OVERLOAD = 0x06;
+constexpr uint8_t EV_SESSION_TERMINATED = 0x07;
+
+constexpr uint8_t DAQ_LIST_STOP = 0x00;
+constexpr uint8_t DAQ_LIST_SELECT = 0x02;
+constexpr uint8_t SYNCH_STOP_ALL = 0x00;
+constexpr uint8_t SYNCH_START_SELECTED = 0x01;
+constexpr uint8_t DAQ_MODE_TIMESTAMP = 0x10;
+constexpr uint8_t NO_BIT_OFFSET = 0xFF;
+
+constexpr uint8_t COMM_MODE_BYTE_ORDER = 0x01;
+constexpr uint8_t TIMESTAMP_SIZE_MASK = 0x07;
+constexpr int MAX_PENDING_WAITS = 10;
+constexpr size_t CAN_FRAME_SIZE = 8;
+
+size_t identificationSize(uint8_t type) {
+    return static_cast<size_t>(type) + 1;   // PID; ODT+DAQ byte; ODT+DAQ word; ODT+fill+DAQ word
+}
+
+uint64_t getUnsigned(const uint8_t* data, size_t size, bool motorola) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; ++i) {
+        size_t byte = motorola ? i : size - 1 - i;
+        value = (value << 8) | data[byte];
+    }
+    return value;
+}
+
+} // anonymous namespace
+
+std::string XcpSlaveInfo::toString() const {
+    std::ostringstream ss;
+    ss << "XcpSlaveInfo[Resources:0x" << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(resources)
+       << std::dec << ", ByteOrder:" << (motorola ? "Motorola" : "Intel")
+       << ", MaxCTO:" << static_cast<int>(maxCto)
+       << ", MaxDTO:" << maxDto
+       << ", Protocol:" << static_cast<int>(protocolVersion)
+       << ", Transport:" << static_cast<int>(transportVersion) << "]";
+    return ss.str();
+}
+
+std::string XcpDaqProcessorInfo::toString() const {
+    std::ostringstream ss;
+    ss << "XcpDaqProcessorInfo[" << (dynamic() ? "Dynamic" : "Static")
+       << ", MaxDAQ:" << maxDaq
+       << ", MinDAQ:" << static_cast<int>(minDaq)
+       << ", Events:" << maxEventChannel
+       << ", Timestamps:" << (timestampSupported() ? "Yes" : "No")
+       << ", IdType:" << static_cast<int>(identificationType()) << "]";
+    return ss.str();
+}
+
+std::string XcpConfig::toString() const {
+    std::ostringstream ss;
+    ss << "XcpConfig[CMD:" << canIdToString(commandId, extendedIds)
+       << ", RES:" << canIdToString(responseId, extendedIds)
+       << ", Timeout:" << timeout << "ms"
+       << ", Padding:" << (padFrames ? "Yes" : "No")
+       << ", Timestamps:" << (useTimestamps ? "Yes" : "No") << "]";
+    return ss.str();
+}
+
+// XcpMaster implementation
+class XcpMaster::Impl {
+public:
+    XcpConfig config;
+    std::shared_ptr<CANProtocol> canProtocol;
+    uint32_t listenerId = 0;
+    std::atomic<bool> initialized{false};
+    std::atomic<bool> connected{false};
+    std::atomic<bool> daqRunning{false};
+
+    // Written by connect(); the receive thread decodes with the layout's copy of the byte order
+    mutable std::mutex slaveMutex;
+    XcpSlaveInfo slave;
+    XcpDaqProcessorInfo daqInfo;
+
+    // One command at a time; the response arrives on the receive thread
+    std::mutex commandMutex;
+    std::mutex responseMutex;
+    std::condition_variable responseCondition;
+    bool awaitingResponse = false;
+    bool responseReady = false;
+    bool commandPending = false;
+    std::vector<uint8_t> response;
+
+    // DTO decoding, compiled by configureDaq
+    struct Entry {
+        size_t offset = 0;                  // In the DTO, after identification and timestamp
+        XcpDataType type = XcpDataType::UINT8;
+        double scale = 1.0;
+        double valueOffset = 0.0;
+        LiveDataStore::ChannelId channel = LiveDataStore::INVALID_CHANNEL;
+    };
+    struct Odt {
+        uint16_t list = 0;                  // Index into our lists
+        bool first = false;                 // Carries the timestamp when enabled
+        std::vector<Entry> entries;
+    };
+    struct Layout {
+        std::shared_ptr<LiveDataStore> store;
+        uint8_t identificationType = 0;
+        size_t headerSize = 1;
+        size_t timestampSize = 0;           // 0 when DTOs carry no timestamp
+        double tickMicroseconds = 0.0;
+        uint16_t firstDaq = 0;
+        bool motorola = false;              // Slave byte order
+        std::array<int32_t, 256> pidToOdt;  // Absolute ODT numbers; -1 if unused
+        std::vector<std::vector<uint32_t>> odtIndex;   // [list][relative ODT] -> odts
+        std::vector<Odt> odts;
+        size_t lists = 0;
+
+        Layout() { pidToOdt.fill(-1); }
+    };
+    std::mutex layoutMutex;
+    std::shared_ptr<const Layout> layout;
+
+    // Sample clock per list; only the receive thread touches it while DAQ runs
+    struct ListClock {
+        bool started = false;
+        uint64_t lastRaw = 0;
+        uint64_t ticks = 0;                 // Unwrapped ticks since the anchor
+        int64_t lastUs = 0;
+    };
+    std::vector<ListClock> clocks;
+    uint64_t anchorTicks = 0;
+    int64_t anchorUs = 0;
+
+    Statistics stats;
+    mutable std::mutex statsMutex;
+
+    Impl() {
+        stats.startTime = std::chrono::system_clock::now();
+    }
+
+    XcpSlaveInfo slaveInfo() const {
+        std::lock_guard<std::mutex> lock(slaveMutex);
+        return slave;
+    }
+
+    void setSlaveInfo(const XcpSlaveInfo& info) {
+        std::lock_guard<std::mutex> lock(slaveMutex);
+        slave = info;
+    }
+
+    // Multi-byte parameters in the slave's byte order
+    void put16(std::vector<uint8_t>& data, uint16_t value) const {
+        if (slaveInfo().motorola) {
+            data.push_back(static_cast<uint8_t>(value >> 8));
+            data.push_back(static_cast<uint8_t>(value));
+        } else {
+            data.push_back(static_cast<uint8_t>(value));
+            data.push_back(static_cast<uint8_t>(value >> 8));
+        }
+    }
+
+    void put32(std::vector<uint8_t>& data, uint32_t value) const {
+        const bool motorola = slaveInfo().motorola;
+        for (int i = 0; i < 4; ++i) {
+            int shift = motorola ? 24 - 8 * i : 8 * i;
+            data.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+
+    uint64_t getUnsigned(const uint8_t* data, size_t size) const {
+        return fmus::protocols::getUnsigned(data, size, slaveInfo().motorola);
+    }
+
+    static double readValue(const uint8_t* data, XcpDataType type, bool motorola) {
+        uint64_t raw = fmus::protocols::getUnsigned(data, xcpDataTypeSize(type), motorola);
+        switch (type) {
+            case XcpDataType::UINT8:
+            case XcpDataType::UINT16:
+            case XcpDataType::UINT32:
+            case XcpDataType::UINT64:
+                return static_cast<double>(raw);
+            case XcpDataType::INT8: return static_cast<int8_t>(raw);
+            case XcpDataType::INT16: return static_cast<int16_t>(raw);
+            case XcpDataType::INT32: return static_cast<int32_t>(raw);
+            case XcpDataType::INT64: return static_cast<double>(static_cast<int64_t>(raw));
+            case XcpDataType::FLOAT32: {
+                uint32_t bits = static_cast<uint32_t>(raw);
+                float value;
+                std::memcpy(&value, &bits, sizeof(value));
+                return value;
+            }
+            case XcpDataType::FLOAT64: {
+                double value;
+                std::memcpy(&value, &raw, sizeof(value));
+                return value;
+            }
+        }
+        return 0.0;
+    }
+
+    bool writeFrame(std::vector<uint8_t> data) {
+        size_t frameSize = std::max<size_t>(slaveInfo().maxCto, CAN_FRAME_SIZE);
+        if (config.padFrames && data.size() < frameSize) {
+            data.resize(frameSize, 0x00);
+        }
+        CANMessage frame(config.commandId, data, config.extendedIds);
+        if (data.size() > CAN_FRAME_SIZE) {
+            frame.data.resize(canFdLength(data.size()), 0x00);
+            frame.fd = true;
+        }
+        return canProtocol->sendMessage(frame);
+    }
+
+    /**
+     * Send a command and wait for its positive response, following EV_CMD_PENDING
+     */
+    bool transact(const std::vector<uint8_t>& command, std::vector<uint8_t>* result = nullptr) {
+        auto logger = Logger::getInstance();
+        std::lock_guard<std::mutex> transaction(commandMutex);
+        {
+            std::lock_guard<std::mutex> lock(responseMutex);
+            awaitingResponse = true;
+            responseReady = false;
+            commandPending = false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.commandsSent++;
+        }
+
+        bool sent = writeFrame(command);
+        std::unique_lock<std::mutex> lock(responseMutex);
+        bool answered = false;
+        for (int waits = 0; sent && waits < MAX_PENDING_WAITS; ++waits) {
+            answered = responseCondition.wait_for(lock, std::chrono::milliseconds(config.timeout),
+                                                  [this] { return responseReady || commandPending; });
+            if (!answered || responseReady) {
+                break;
+            }
+            commandPending = false;     // Slave asked for more time
+            answered = false;
+        }
+        awaitingResponse = false;
+
+        if (!answered || !responseReady) {
+            logger->warning("XCP command 0x" + utils::bytesToHex(&command[0], 1) + " timed out");
+            std::lock_guard<std::mutex> statsLock(statsMutex);
+            stats.commandErrors++;
+            return false;
+        }
+        if (response[0] == PID_ERR) {
+            uint8_t code = response.size() > 1 ? response[1] : 0xFF;
+            logger->error("XCP command 0x" + utils::bytesToHex(&command[0], 1) + " failed: " + xcpErrorToString(code));
+            std::lock_guard<std::mutex> statsLock(statsMutex);
+            stats.commandErrors++;
+            return false;
+        }
+        if (result) {
+            *result = response;
+        }
+        return true;
+    }
+
+    void onFrame(const CANMessage& frame) {
+        if (frame.id != config.responseId || frame.extended != config.extendedIds || frame.data.empty()) {
+            return;
+        }
+
+        const uint8_t pid = frame.data[0];
+        switch (pid) {
+            case PID_RES:
+            case PID_ERR: {
+                std::lock_guard<std::mutex> lock(responseMutex);
+                if (awaitingResponse) {
+                    response = frame.data;
+                    responseReady = true;
+                    responseCondition.notify_one();
+                }
+                break;
+            }
+            case PID_EV:
+                onEvent(frame.data);
+                break;
+            case PID_SERV:
+                break;
+            default:
+                if (daqRunning) {
+                    decodeDto(frame.data.data(), frame.data.size());
+                }
+                break;
+        }
+    }
+
+    void onEvent(const std::vector<uint8_t>& data) {
+        uint8_t code = data.size() > 1 ? data[1] : 0xFF;
+        switch (code) {
+            case EV_CMD_PENDING: {
+                std::lock_guard<std::mutex> lock(responseMutex);
+                commandPending = true;
+                responseCondition.notify_one();
+                break;
+            }
+            case EV_DAQ_OVERLOAD: {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                stats.overloads++;
+                break;
+            }
+            case EV_SESSION_TERMINATED:
+                Logger::getInstance()->warning("XCP session terminated by slave");
+                daqRunning = false;
+                connected = false;
+                break;
+            default:
+                Logger::getInstance()->debug("XCP event 0x" + utils::bytesToHex(&code, 1));
+                break;
+        }
+    }
+
+    int64_t sampleTime(const Layout& current, uint16_t list, const uint8_t* timestamp) {
+        ListClock& clock = clocks[list];
+        if (!timestamp) {
+            return clock.started ? clock.lastUs : LiveDataStore::now();
+        }
+
+        const unsigned bits = static_cast<unsigned>(current.timestampSize * 8);
+        const uint64_t wrap = bits >= 64 ? 0 : (1ULL << bits);
+        const uint64_t raw = fmus::protocols::getUnsigned(timestamp, current.timestampSize, current.motorola);
+        const uint64_t previous = clock.started ? clock.lastRaw : (wrap ? anchorTicks % wrap : anchorTicks);
+        clock.ticks += wrap ? (raw + wrap - previous) % wrap : raw - previous;
+        clock.lastRaw = raw;
+        clock.started = true;
+        clock.lastUs = anchorUs + static_cast<int64_t>(static_cast<double>(clock.ticks) * current.tickMicroseconds);
+        return clock.lastUs;
+    }
+
+    void decodeDto(const uint8_t* data, size_t length) {
+        std::shared_ptr<const Layout> current;
+        {
+            std::lock_guard<std::mutex> lock(layoutMutex);
+            current = layout;
+        }
+        if (!current || length < current->headerSize) {
+            countDropped();
+            return;
+        }
+
+        int64_t index = -1;
+        if (current->identificationType == 0) {
+            index = current->pidToOdt[data[0]];
+        } else {
+            uint16_t daq = current->identificationType == 1 ? data[1]
+                         : static_cast<uint16_t>(fmus::protocols::getUnsigned(data + current->headerSize - 2, 2,
+                                                                              current->motorola));
+            size_t list = static_cast<size_t>(daq) - current->firstDaq;
+            if (daq >= current->firstDaq && list < current->lists && data[0] < current->odtIndex[list].size()) {
+                index = current->odtIndex[list][data[0]];
+            }
+        }
+        if (index < 0) {
+            countDropped();
+            return;
+        }
+
+        const Odt& odt = current->odts[static_cast<size_t>(index)];
+        const uint8_t* payload = data + current->headerSize;
+        const uint8_t* timestamp = nullptr;
+        if (odt.first && current->timestampSize) {
+            if (length < current->headerSize + current->timestampSize) {
+                countDropped();
+                return;
+            }
+            timestamp = payload;
+            payload += current->timestampSize;
+        }
+        int64_t timeUs = sampleTime(*current, odt.list, timestamp);
+
+        const size_t available = static_cast<size_t>(data + length - payload);
+        size_t published = 0;
+        for (const auto& entry : odt.entries) {
+            if (entry.offset + xcpDataTypeSize(entry.type) > available) {
+                break;
+            }
+            double value = readValue(payload + entry.offset, entry.type, current->motorola) * entry.scale +
+                           entry.valueOffset;
+            current->store->publish(entry.channel, value, timeUs);
+            ++published;
+        }
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.dtosReceived++;
+        stats.samplesPublished += published;
+    }
+
+    void countDropped() {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.dtosDropped++;
+    }
+};
+
+XcpMaster::XcpMaster() : pImpl(std::make_unique<Impl>()) {}
+
+XcpMaster::~XcpMaster() {
+    shutdown();
+}
+
+bool XcpMaster::initialize(const XcpConfig& config, std::shared_ptr<CANProtocol> canProtocol) {
+    auto logger = Logger::getInstance();
+    logger->info("Initializing XCP master: " + config.toString());
+
+    shutdown();
+    if (!canProtocol || !canProtocol->isInitialized()) {
+        logger->error("CAN protocol not initialized");
+        return false;
+    }
+
+    pImpl->config = config;
+    pImpl->canProtocol = std::move(canProtocol);
+    pImpl->setSlaveInfo(XcpSlaveInfo{});
+    pImpl->listenerId = pImpl->canProtocol->addListener([impl = pImpl.get()](const CANMessage& frame) {
+        impl->onFrame(frame);
+    });
+    if (!pImpl->listenerId) {
+        return false;
+    }
+
+    pImpl->initialized = true;
+    return true;
+}
+
+void XcpMaster::shutdown() {
+    if (!pImpl->initialized.exchange(false)) {
+        return;
+    }
+    if (pImpl->daqRunning) {
+        stopDaq();
+    }
+    if (pImpl->connected) {
+        disconnect();
+    }
+    pImpl->canProtocol->removeListener(pImpl->listenerId);
+    pImpl->listenerId = 0;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->layoutMutex);
+        pImpl->layout.reset();
+    }
+    Logger::getInstance()->info("XCP master shutdown");
+}
+
+bool XcpMaster::isInitialized() const {
+    return pImpl->initialized;
+}
+
+bool XcpMaster::connect() {
+    if (!pImpl->listenerId) {
+        return false;
+    }
+
+    // CONNECT goes out before the slave's CTO length is known
+    pImpl->setSlaveInfo(XcpSlaveInfo{});
+    std::vector<uint8_t> result;
+    if (!pImpl->transact({CMD_CONNECT, 0x00}, &result) || result.size() < 8) {
+        return false;
+    }
+
+    XcpSlaveInfo info;
+    info.resources = result[1];
+    info.motorola = (result[2] & COMM_MODE_BYTE_ORDER) != 0;
+    info.maxCto = result[3];
+    info.maxDto = info.motorola ? static_cast<uint16_t>((result[4] << 8) | result[5])
+                                : static_cast<uint16_t>((result[5] << 8) | result[4]);
+    info.protocolVersion = result[6];
+    info.transportVersion = result[7];
+    pImpl->setSlaveInfo(info);
+    pImpl->connected = true;
+
+    Logger::getInstance()->info("XCP connected: " + info.toString());
+    return true;
+}
+
+void XcpMaster::disconnect() {
+    if (pImpl->connected.exchange(false)) {
+        pImpl->daqRunning = false;
+        pImpl->transact({CMD_DISCONNECT});
+    }
+}
+
+bool XcpMaster::isConnected() const {
+    return pImpl->connected;
+}
+
+XcpSlaveInfo XcpMaster::getSlaveInfo() const {
+    return pImpl->slaveInfo();
+}
+
+bool XcpMaster::getDaqProcessorInfo(XcpDaqProcessorInfo& info) {
+    std::vector<uint8_t> result;
+    if (!pImpl->connected || !pImpl->transact({CMD_GET_DAQ_PROCESSOR_INFO}, &result) || result.size() < 8) {
+        return false;
+    }
+    info.properties = result[1];
+    info.maxDaq = static_cast<uint16_t>(pImpl->getUnsigned(&result[2], 2));
+    info.maxEventChannel = static_cast<uint16_t>(pImpl->getUnsigned(&result[4], 2));
+    info.minDaq = result[6];
+    info.keyByte = result[7];
+    pImpl->daqInfo = info;
+    return true;
+}
+
+bool XcpMaster::configureDaq(const std::vector<XcpDaqList>& lists, std::shared_ptr<LiveDataStore> store) {
+    auto logger = Logger::getInstance();
+    if (!pImpl->connected || !store || lists.empty()) {
+        return false;
+    }
+    const XcpSlaveInfo slave = pImpl->slaveInfo();
+    if (!slave.supportsDaq()) {
+        logger->error("XCP slave has no DAQ resource");
+        return false;
+    }
+
+    XcpDaqProcessorInfo info;
+    if (!getDaqProcessorInfo(info)) {
+        return false;
+    }
+    if (!info.dynamic()) {
+        logger->error("XCP slave only has static DAQ lists, which are not supported");
+        return false;
+    }
+    if (info.maxDaq < info.minDaq + lists.size()) {
+        logger->error("XCP slave supports " + std::to_string(info.maxDaq - info.minDaq) + " dynamic DAQ lists");
+        return false;
+    }
+
+    std::vector<uint8_t> result;
+    if (!pImpl->transact({CMD_GET_DAQ_RESOLUTION_INFO}, &result) || result.size() < 8) {
+        return false;
+    }
+    const uint8_t maxEntrySize = result[2];
+    const uint8_t timestampMode = result[5];
+    const uint16_t timestampTicks = static_cast<uint16_t>(pImpl->getUnsigned(&result[6], 2));
+
+    auto compiled = std::make_shared<Impl::Layout>();
+    compiled->store = store;
+    compiled->identificationType = info.identificationType();
+    compiled->headerSize = identificationSize(compiled->identificationType);
+    compiled->firstDaq = info.minDaq;
+    compiled->motorola = slave.motorola;
+    compiled->lists = lists.size();
+    if (pImpl->config.useTimestamps && info.timestampSupported()) {
+        compiled->timestampSize = timestampMode & TIMESTAMP_SIZE_MASK;
+        int unit = timestampMode >> 4;
+        double unitNs = std::pow(10.0, unit <= 9 ? unit : unit - 13);    // 1 ns..1 s, then 1 ps..100 ps
+        compiled->tickMicroseconds = unitNs * timestampTicks / 1000.0;
+    }
+
+    // Pack measurements into ODTs in order
+    const size_t dtoSize = slave.maxDto;
+    for (size_t l = 0; l < lists.size(); ++l) {
+        compiled->odtIndex.emplace_back();
+        size_t used = 0;
+        size_t capacity = 0;
+        for (const auto& measurement : lists[l].measurements) {
+            size_t size = xcpDataTypeSize(measurement.type);
+            if (size > maxEntrySize) {
+                logger->error("XCP measurement " + measurement.name + " exceeds the slave's ODT entry size");
+                return false;
+            }
+            if (compiled->odtIndex[l].empty() || used + size > capacity) {
+                bool first = compiled->odtIndex[l].empty();
+                capacity = dtoSize - compiled->headerSize - (first ? compiled->timestampSize : 0);
+                if (size > capacity) {
+                    logger->error("XCP measurement " + measurement.name + " does not fit in a DTO");
+                    return false;
+                }
+                compiled->odtIndex[l].push_back(static_cast<uint32_t>(compiled->odts.size()));
+                compiled->odts.emplace_back();
+                compiled->odts.back().list = static_cast<uint16_t>(l);
+                compiled->odts.back().first = first;
+                used = 0;
+            }
+
+            Impl::Entry entry;
+            entry.offset = used;
+            entry.type = measurement.type;
+            entry.scale = measurement.scale;
+            entry.valueOffset = measurement.offset;
+            entry.channel = store->addChannel(measurement.name, measurement.unit);
+            if (entry.channel == LiveDataStore::INVALID_CHANNEL) {
+                logger->error("Live data store is full");
+                return false;
+            }
+            compiled->odts.back().entries.push_back(entry);
+            used += size;
+        }
+        if (compiled->odtIndex[l].size() > 0xFF) {
+            logger->error("XCP DAQ list has too many ODTs");
+            return false;
+        }
+    }
+
+    // Allocation must go FREE_DAQ, ALLOC_DAQ, all ALLOC_ODT, then all ALLOC_ODT_ENTRY
+    stopDaq();
+    std::vector<uint8_t> command = {CMD_ALLOC_DAQ, 0x00};
+    pImpl->put16(command, static_cast<uint16_t>(lists.size()));
+    if (!pImpl->transact({CMD_FREE_DAQ}) || !pImpl->transact(command)) {
+        return false;
+    }
+    for (size_t l = 0; l < lists.size(); ++l) {
+        command = {CMD_ALLOC_ODT, 0x00};
+        pImpl->put16(command, static_cast<uint16_t>(info.minDaq + l));
+        command.push_back(static_cast<uint8_t>(compiled->odtIndex[l].size()));
+        if (!pImpl->transact(command)) {
+            return false;
+        }
+    }
+    for (size_t l = 0; l < lists.size(); ++l) {
+        for (size_t o = 0; o < compiled->odtIndex[l].size(); ++o) {
+            command = {CMD_ALLOC_ODT_ENTRY, 0x00};
+            pImpl->put16(command, static_cast<uint16_t>(info.minDaq + l));
+            command.push_back(static_cast<uint8_t>(o));
+            command.push_back(static_cast<uint8_t>(compiled->odts[compiled->odtIndex[l][o]].entries.size()));
+            if (!pImpl->transact(command)) {
+                return false;
+            }
+        }
+    }
+
+    // Program the entries; WRITE_DAQ advances the pointer itself
+    for (size_t l = 0; l < lists.size(); ++l) {
+        size_t measurement = 0;
+        for (size_t o = 0; o < compiled->odtIndex[l].size(); ++o) {
+            command = {CMD_SET_DAQ_PTR, 0x00};
+            pImpl->put16(command, static_cast<uint16_t>(info.minDaq + l));
+            command.push_back(static_cast<uint8_t>(o));
+            command.push_back(0x00);
+            if (!pImpl->transact(command)) {
+                return false;
+            }
+            for (size_t e = 0; e < compiled->odts[compiled->odtIndex[l][o]].entries.size(); ++e) {
+                const auto& m = lists[l].measurements[measurement++];
+                command = {CMD_WRITE_DAQ, NO_BIT_OFFSET, static_cast<uint8_t>(xcpDataTypeSize(m.type)),
+                           m.addressExtension};
+                pImpl->put32(command, m.address);
+                if (!pImpl->transact(command)) {
+                    return false;
+                }
+            }
+        }
+
+        command = {CMD_SET_DAQ_LIST_MODE, static_cast<uint8_t>(compiled->timestampSize ? DAQ_MODE_TIMESTAMP : 0)};
+        pImpl->put16(command, static_cast<uint16_t>(info.minDaq + l));
+        pImpl->put16(command, lists[l].eventChannel);
+        command.push_back(std::max<uint8_t>(lists[l].prescaler, 1));
+        command.push_back(lists[l].priority);
+        if (!pImpl->transact(command)) {
+            return false;
+        }
+
+        command = {CMD_START_STOP_DAQ_LIST, DAQ_LIST_SELECT};
+        pImpl->put16(command, static_cast<uint16_t>(info.minDaq + l));
+        if (!pImpl->transact(command, &result) || result.size() < 2) {
+            return false;
+        }
+        uint8_t firstPid = result[1];
+        for (size_t o = 0; o < compiled->odtIndex[l].size(); ++o) {
+            compiled->pidToOdt[static_cast<uint8_t>(firstPid + o)] = static_cast<int32_t>(compiled->odtIndex[l][o]);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pImpl->layoutMutex);
+        pImpl->layout = compiled;
+    }
+    logger->info("XCP DAQ configured: " + std::to_string(lists.size()) + " lists, " +
+                 std::to_string(compiled->odts.size()) + " ODTs");
+    return true;
+}
+
+bool XcpMaster::startDaq() {
+    std::shared_ptr<const Impl::Layout> current;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->layoutMutex);
+        current = pImpl->layout;
+    }
+    if (!pImpl->connected || !current) {
+        return false;
+    }
+
+    // Anchor DTO timestamps to the host clock
+    pImpl->clocks.assign(current->lists, Impl::ListClock{});
+    pImpl->anchorTicks = 0;
+    pImpl->anchorUs = LiveDataStore::now();
+    std::vector<uint8_t> result;
+    if (current->timestampSize && pImpl->transact({CMD_GET_DAQ_CLOCK}, &result) && result.size() >= 8) {
+        pImpl->anchorTicks = pImpl->getUnsigned(&result[4], 4);
+        pImpl->anchorUs = LiveDataStore::now();
+    }
+
+    pImpl->daqRunning = true;
+    if (!pImpl->transact({CMD_START_STOP_SYNCH, SYNCH_START_SELECTED})) {
+        pImpl->daqRunning = false;
+        return false;
+    }
+    return true;
+}
+
+bool XcpMaster::stopDaq() {
+    if (!pImpl->connected) {
+        return false;
+    }
+    bool ok = pImpl->transact({CMD_START_STOP_SYNCH, SYNCH_STOP_ALL});
+    pImpl->daqRunning = false;
+    return ok;
+}
+
+bool XcpMaster::isDaqRunning() const {
+    return pImpl->daqRunning;
+}
+
+XcpMaster::Statistics XcpMaster::getStatistics() const {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    return pImpl->stats;
+}
+
+void XcpMaster::resetStatistics() {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    pImpl->stats = Statistics{};
+    pImpl->stats.startTime = std::chrono::system_clock::now();
+}
+
+XcpConfig XcpMaster::getConfiguration() const {
+    return pImpl->config;
+}
+
+std::string XcpMaster::toString() const {
+    std::ostringstream ss;
+    ss << "XcpMaster[" << pImpl->config.toString()
+       << ", Connected:" << (pImpl->connected ? "Yes" : "No")
+       << ", DAQ:" << (pImpl->daqRunning ? "Running" : "Stopped") << "]";
+    return ss.str();
+}
+
+// Utility functions
+size_t xcpDataTypeSize(XcpDataType type) {
+    switch (type) {
+        case XcpDataType::UINT8:
+        case XcpDataType::INT8:
+            return 1;
+        case XcpDataType::UINT16:
+        case XcpDataType::INT16:
+            return 2;
+        case XcpDataType::UINT32:
+        case XcpDataType::INT32:
+        case XcpDataType::FLOAT32:
+            return 4;
+        case XcpDataType::UINT64:
+        case XcpDataType::INT64:
+        case XcpDataType::FLOAT64:
+            return 8;
+    }
+    return 1;
+}
+
+std::string xcpErrorToString(uint8_t code) {
+    switch (code) {
+        case 0x00: return "ERR_CMD_SYNCH";
+        case 0x10: return "ERR_CMD_BUSY";
+        case 0x11: return "ERR_DAQ_ACTIVE";
+        case 0x12: return "ERR_PGM_ACTIVE";
+        case 0x20: return "ERR_CMD_UNKNOWN";
+        case 0x21: return "ERR_CMD_SYNTAX";
+        case 0x22: return "ERR_OUT_OF_RANGE";
+        case 0x23: return "ERR_WRITE_PROTECTED";
+        case 0x24: return "ERR_ACCESS_DENIED";
+        case 0x25: return "ERR_ACCESS_LOCKED";
+        case 0x26: return "ERR_PAGE_NOT_VALID";
+        case 0x27: return "ERR_MODE_NOT_VALID";
+        case 0x28: return "ERR_SEGMENT_NOT_VALID";
+        case 0x29: return "ERR_SEQUENCE";
+        case 0x2A: return "ERR_DAQ_CONFIG";
+        case 0x30: return "ERR_MEMORY_OVERFLOW";
+        case 0x31: return "ERR_GENERIC";
+        case 0x32: return "ERR_VERIFY";
+        default: return "Unknown error 0x" + utils::bytesToHex(&code, 1);
+    }
+}
+
+} // namespace protocols
+} // namespace fmus
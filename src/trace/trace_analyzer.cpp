@@ -0,0 +1,652 @@
+#include <fmus/trace/trace_analyzer.h>
+#include <fmus/trace/trace_index.h>
+#include <fmus/protocols/transport.h>
+#include <fmus/diagnostics/uds.h>
+#include <fmus/diagnostics/obdii.h>
+#include <fmus/thread_pool.h>
+#include <fmus/logger.h>
+#include <fmus/utils.h>
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+
+namespace fmus {
+namespace trace {
+
+namespace {
+
+constexpr int64_t CONSECUTIVE_FRAME_TIMEOUT_NS = 1000000000;   // N_Cr
+constexpr int64_t NS_PER_MS = 1000000;
+
+constexpr uint8_t NEGATIVE_RESPONSE_SID = 0x7F;
+constexpr uint8_t POSITIVE_RESPONSE_OFFSET = 0x40;
+constexpr uint8_t NRC_RESPONSE_PENDING = 0x78;
+constexpr uint8_t SUPPRESS_POSITIVE_RESPONSE = 0x80;
+constexpr uint8_t OBD_LAST_MODE = 0x0A;
+
+constexpr uint32_t EXTENDED_KEY_BIT = 0x80000000;
+constexpr uint32_t J1939_PRIORITY_PF_MASK = 0x1FFF0000;
+constexpr uint32_t NORMAL_FIXED_PHYSICAL = 0x18DA0000;
+constexpr uint8_t FIRST_TESTER_ADDRESS = 0xF0;
+constexpr uint16_t STANDARD_REQUEST_BASE = 0x7E0;
+constexpr uint16_t STANDARD_RESPONSE_BASE = 0x7E8;
+constexpr uint16_t STANDARD_CHANNELS = 8;
+
+/**
+ * Frame routed to a channel; offset keeps file order across chunks
+ */
+struct ShardFrame {
+    uint64_t offset;
+    TraceFrame frame;
+    bool fromTester;
+    bool functional;
+};
+
+struct ChunkResult {
+    std::unordered_map<uint64_t, std::vector<ShardFrame>> shards;
+    std::vector<ShardFrame> functional;
+    uint64_t frames = 0;
+};
+
+struct ChannelResult {
+    std::vector<DiagnosticTransaction> transactions;
+    uint64_t pdus = 0;
+    uint64_t reassemblyErrors = 0;
+};
+
+uint64_t channelKey(uint32_t requestId, uint32_t responseId, bool extended) {
+    return (static_cast<uint64_t>(requestId | (extended ? EXTENDED_KEY_BIT : 0)) << 32) | responseId;
+}
+
+TraceChannel channelFromKey(uint64_t key) {
+    TraceChannel channel;
+    uint32_t high = static_cast<uint32_t>(key >> 32);
+    channel.requestId = high & ~EXTENDED_KEY_BIT;
+    channel.responseId = static_cast<uint32_t>(key);
+    channel.extended = (high & EXTENDED_KEY_BIT) != 0;
+    return channel;
+}
+
+bool hasSubFunction(uint8_t service) {
+    switch (static_cast<diagnostics::UDSService>(service)) {
+        case diagnostics::UDSService::DIAGNOSTIC_SESSION_CONTROL:
+        case diagnostics::UDSService::ECU_RESET:
+        case diagnostics::UDSService::SECURITY_ACCESS:
+        case diagnostics::UDSService::COMMUNICATION_CONTROL:
+        case diagnostics::UDSService::ROUTINE_CONTROL:
+        case diagnostics::UDSService::TESTER_PRESENT:
+        case diagnostics::UDSService::CONTROL_DTC_SETTING:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * ISO-TP receive state of one direction
+ */
+struct Reassembly {
+    std::vector<uint8_t> data;
+    size_t expected = 0;
+    uint8_t nextSequence = 0;
+    int64_t startNs = 0;
+    int64_t lastNs = 0;
+    bool active = false;
+
+    /**
+     * Feed one frame; true once a PDU is complete in pdu
+     */
+    bool feed(const TraceFrame& frame, TraceAnalyzer::Pdu& pdu, uint64_t& errors) {
+        protocols::IsoTpPci pci;
+        if (!protocols::parseIsoTpPci(frame.data, frame.length, pci)) {
+            if (frame.length > 0) {
+                errors++;
+            }
+            return false;
+        }
+        const uint8_t* bytes = frame.data;
+        switch (pci.type) {
+            case protocols::IsoTpFrameType::SINGLE:
+                interrupt(errors);
+                pdu.startNs = frame.timestampNs;
+                pdu.endNs = frame.timestampNs;
+                pdu.data.assign(bytes + pci.payloadOffset, bytes + pci.payloadOffset + pci.dataLength);
+                return true;
+            case protocols::IsoTpFrameType::FIRST:
+                interrupt(errors);
+                data.assign(bytes + pci.payloadOffset, bytes + frame.length);
+                data.reserve(pci.dataLength);
+                expected = pci.dataLength;
+                nextSequence = 1;
+                startNs = frame.timestampNs;
+                lastNs = frame.timestampNs;
+                active = true;
+                return false;
+            case protocols::IsoTpFrameType::CONSECUTIVE: {
+                if (!active) {
+                    return false;
+                }
+                if (pci.sequence != nextSequence || frame.timestampNs - lastNs > CONSECUTIVE_FRAME_TIMEOUT_NS) {
+                    errors++;
+                    active = false;
+                    return false;
+                }
+                nextSequence = (nextSequence + 1) & 0x0F;
+                lastNs = frame.timestampNs;
+                size_t take = std::min<size_t>(frame.length - pci.payloadOffset, expected - data.size());
+                data.insert(data.end(), bytes + pci.payloadOffset, bytes + pci.payloadOffset + take);
+                if (data.size() < expected) {
+                    return false;
+                }
+                active = false;
+                pdu.startNs = startNs;
+                pdu.endNs = frame.timestampNs;
+                pdu.data = std::move(data);
+                data.clear();
+                return true;
+            }
+            default:
+                // Flow control belongs to the opposite direction's transfer
+                return false;
+        }
+    }
+
+    void interrupt(uint64_t& errors) {
+        if (active) {
+            errors++;
+            active = false;
+        }
+    }
+};
+
+/**
+ * Run tasks on the global thread pool and collect their results in order
+ *
+ * On one of the pool's own workers the tasks run inline: waiting there for
+ * tasks queued behind the caller can deadlock the pool.
+ */
+template <typename Result>
+std::vector<Result> runAll(const std::vector<std::function<Result()>>& tasks) {
+    std::vector<Result> results;
+    results.reserve(tasks.size());
+    auto threadPool = getGlobalThreadPool();
+    if (tasks.size() <= 1 || threadPool->isWorkerThread()) {
+        for (const auto& task : tasks) {
+            results.push_back(task());
+        }
+        return results;
+    }
+
+    std::vector<std::future<Result>> futures;
+    futures.reserve(tasks.size());
+    for (const auto& task : tasks) {
+        futures.push_back(threadPool->enqueue(task));
+    }
+
+    // Tasks refer to the caller's data, so wait for all before rethrowing
+    std::exception_ptr failure;
+    for (auto& future : futures) {
+        try {
+            results.push_back(future.get());
+        } catch (...) {
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+    return results;
+}
+
+} // anonymous namespace
+
+std::string TraceChannel::toString() const {
+    return protocols::canIdToString(requestId, extended) + "/" + protocols::canIdToString(responseId, extended);
+}
+
+std::string TraceAnalyzerConfig::toString() const {
+    std::ostringstream ss;
+    ss << "TraceAnalyzerConfig[Channels:";
+    if (channels.empty()) {
+        ss << "Auto";
+    } else {
+        ss << channels.size();
+    }
+    ss << ", Functional:" << functionalIds.size()
+       << ", Timeout:" << responseTimeout << "ms]";
+    return ss.str();
+}
+
+// DiagnosticTransaction implementation
+std::chrono::microseconds DiagnosticTransaction::latency() const {
+    if (responseStartNs == 0 || requestEndNs == 0) {
+        return std::chrono::microseconds(0);
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::nanoseconds(responseStartNs - requestEndNs));
+}
+
+std::string DiagnosticTransaction::describe() const {
+    std::ostringstream ss;
+    if (protocol == TransactionProtocol::OBD) {
+        ss << "OBD[" << diagnostics::obdModeToString(static_cast<diagnostics::OBDMode>(service));
+        if (request.size() > 1) {
+            ss << " PID:" << diagnostics::obdPidToString(static_cast<diagnostics::OBDPID>(request[1]));
+        }
+        if (response.size() > 1) {
+            ss << " DATA:" << utils::bytesToHex(response.data() + 1, response.size() - 1);
+        }
+        ss << "]";
+        return ss.str();
+    }
+
+    if (!request.empty()) {
+        ss << diagnostics::UDSMessage::fromBytes(request.data(), request.size()).toString();
+    }
+    if (!response.empty()) {
+        ss << (request.empty() ? "" : " -> ")
+           << diagnostics::UDSMessage::fromBytes(response.data(), response.size()).toString();
+    }
+    return ss.str();
+}
+
+std::string DiagnosticTransaction::toString() const {
+    std::ostringstream ss;
+    ss << "DiagnosticTransaction[" << channel.toString()
+       << ", " << (protocol == TransactionProtocol::OBD
+                       ? diagnostics::obdModeToString(static_cast<diagnostics::OBDMode>(service))
+                       : diagnostics::udsServiceToString(static_cast<diagnostics::UDSService>(service)))
+       << ", Status:" << transactionStatusToString(status);
+    if (status == TransactionStatus::NEGATIVE) {
+        ss << ", NRC:" << diagnostics::udsNegativeResponseToString(
+                              static_cast<diagnostics::UDSNegativeResponse>(negativeResponseCode));
+    }
+    if (pendingResponses) {
+        ss << ", Pending:" << pendingResponses;
+    }
+    if (responseStartNs && requestEndNs) {
+        ss << ", Latency:" << latency().count() << "us";
+    }
+    ss << "]";
+    return ss.str();
+}
+
+// TraceAnalysis implementation
+bool TraceAnalysis::exportCsv(const std::string& path) const {
+    FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) {
+        Logger::getInstance()->error("Failed to create " + path);
+        return false;
+    }
+
+    std::fprintf(out, "request_time_ns,response_time_ns,request_id,response_id,protocol,service,status,nrc,pending,latency_us,request,response\n");
+    for (const auto& t : transactions) {
+        const char* idFormat = t.channel.extended ? "%08" PRIX32 : "%03" PRIX32;
+        char requestId[16];
+        char responseId[16];
+        std::snprintf(requestId, sizeof(requestId), idFormat, t.channel.requestId);
+        std::snprintf(responseId, sizeof(responseId), idFormat, t.channel.responseId);
+        std::fprintf(out, "%" PRId64 ",%" PRId64 ",%s,%s,%s,0x%02X,%s,0x%02X,%" PRIu32 ",%lld,%s,%s\n",
+                     t.requestStartNs, t.responseStartNs, requestId, responseId,
+                     t.protocol == TransactionProtocol::OBD ? "OBD" : "UDS", t.service,
+                     transactionStatusToString(t.status).c_str(), t.negativeResponseCode, t.pendingResponses,
+                     static_cast<long long>(t.latency().count()),
+                     utils::bytesToHex(t.request).c_str(), utils::bytesToHex(t.response).c_str());
+    }
+
+    bool ok = std::ferror(out) == 0;
+    std::fclose(out);
+    return ok;
+}
+
+std::string TraceAnalysis::toString() const {
+    std::ostringstream ss;
+    ss << "TraceAnalysis[Frames:" << framesScanned
+       << ", Diagnostic:" << diagnosticFrames
+       << ", Channels:" << channels
+       << ", PDUs:" << pdus
+       << ", Transactions:" << transactions.size()
+       << ", ReassemblyErrors:" << reassemblyErrors
+       << ", Elapsed:" << elapsed.count() / 1000 << "ms]";
+    return ss.str();
+}
+
+// TraceAnalyzer implementation
+class TraceAnalyzer::Impl {
+public:
+    TraceAnalyzerConfig config;
+
+    // Explicit channel lookup: ID (with EXTENDED_KEY_BIT) -> channel key, direction
+    std::unordered_map<uint32_t, std::pair<uint64_t, bool>> routes;
+    std::vector<uint32_t> functionalKeys;
+
+    explicit Impl(const TraceAnalyzerConfig& cfg) : config(cfg) {
+        for (const auto& channel : config.channels) {
+            uint32_t bit = channel.extended ? EXTENDED_KEY_BIT : 0;
+            uint64_t key = channelKey(channel.requestId, channel.responseId, channel.extended);
+            routes[channel.requestId | bit] = {key, true};
+            routes[channel.responseId | bit] = {key, false};
+        }
+        for (uint32_t id : config.functionalIds) {
+            functionalKeys.push_back(id > 0x7FF ? id | EXTENDED_KEY_BIT : id);
+        }
+    }
+
+    /**
+     * Route a frame to its channel; false if it is not diagnostic traffic
+     */
+    bool route(const TraceFrame& frame, uint64_t& key, bool& fromTester, bool& functional) const {
+        const bool extended = frame.extended();
+        const uint32_t lookup = frame.id | (extended ? EXTENDED_KEY_BIT : 0);
+        functional = std::find(functionalKeys.begin(), functionalKeys.end(), lookup) != functionalKeys.end();
+        if (functional) {
+            fromTester = true;
+            return true;
+        }
+
+        if (!routes.empty()) {
+            auto it = routes.find(lookup);
+            if (it == routes.end()) {
+                return false;
+            }
+            key = it->second.first;
+            fromTester = it->second.second;
+            return true;
+        }
+
+        if (!extended) {
+            if (frame.id >= STANDARD_REQUEST_BASE && frame.id < STANDARD_REQUEST_BASE + STANDARD_CHANNELS) {
+                key = channelKey(frame.id, frame.id + STANDARD_CHANNELS, false);
+                fromTester = true;
+                return true;
+            }
+            if (frame.id >= STANDARD_RESPONSE_BASE && frame.id < STANDARD_RESPONSE_BASE + STANDARD_CHANNELS) {
+                key = channelKey(frame.id - STANDARD_CHANNELS, frame.id, false);
+                fromTester = false;
+                return true;
+            }
+            return false;
+        }
+
+        // Normal fixed addressing: 18DA<target><source>; testers use 0xF0-0xFF
+        if ((frame.id & J1939_PRIORITY_PF_MASK) != NORMAL_FIXED_PHYSICAL) {
+            return false;
+        }
+        const uint8_t target = static_cast<uint8_t>(frame.id >> 8);
+        const uint8_t source = static_cast<uint8_t>(frame.id);
+        const uint32_t reverse = NORMAL_FIXED_PHYSICAL | (static_cast<uint32_t>(source) << 8) | target;
+        if (source >= FIRST_TESTER_ADDRESS) {
+            key = channelKey(frame.id, reverse, true);
+            fromTester = true;
+            return true;
+        }
+        if (target >= FIRST_TESTER_ADDRESS) {
+            key = channelKey(reverse, frame.id, true);
+            fromTester = false;
+            return true;
+        }
+        return false;
+    }
+
+    ChunkResult scanChunk(const TraceReader& reader, uint64_t begin, uint64_t end) const {
+        ChunkResult result;
+        TraceCursor cursor{begin};
+        TraceFrame frame;
+        uint64_t lastKey = 0;
+        std::vector<ShardFrame>* lastShard = nullptr;
+        while (reader.next(cursor, frame)) {
+            const uint64_t offset = cursor.offset - traceRecordSize(frame.length);
+            if (offset >= end) {
+                break;
+            }
+            result.frames++;
+
+            uint64_t key = 0;
+            bool fromTester = false;
+            bool functional = false;
+            if (!route(frame, key, fromTester, functional)) {
+                continue;
+            }
+            if (functional) {
+                result.functional.push_back({offset, frame, true, true});
+                continue;
+            }
+            // Traffic comes in runs on one channel; skip the hash lookup for them
+            if (!lastShard || key != lastKey) {
+                lastShard = &result.shards[key];
+                lastKey = key;
+            }
+            lastShard->push_back({offset, frame, fromTester, false});
+        }
+        return result;
+    }
+
+    ChannelResult analyzeChannel(const TraceAnalyzer& analyzer, uint64_t key,
+                                 const std::vector<ShardFrame>& frames,
+                                 const std::vector<ShardFrame>& functional) const {
+        const TraceChannel channel = channelFromKey(key);
+
+        // Functional requests go to every ECU, but only channels with responses can pair them
+        std::vector<ShardFrame> merged;
+        const std::vector<ShardFrame>* input = &frames;
+        const bool answers = std::any_of(frames.begin(), frames.end(),
+                                         [](const ShardFrame& f) { return !f.fromTester; });
+        if (answers && !functional.empty()) {
+            merged.reserve(frames.size() + functional.size());
+            auto byOffset = [](const ShardFrame& a, const ShardFrame& b) { return a.offset < b.offset; };
+            auto sameWidth = [&channel](const ShardFrame& f) { return f.frame.extended() == channel.extended; };
+            std::vector<ShardFrame> matching;
+            std::copy_if(functional.begin(), functional.end(), std::back_inserter(matching), sameWidth);
+            std::merge(frames.begin(), frames.end(), matching.begin(), matching.end(), std::back_inserter(merged), byOffset);
+            input = &merged;
+        }
+
+        ChannelResult result;
+        Reassembly tester;
+        Reassembly ecu;
+        Reassembly broadcast;
+        std::vector<TraceAnalyzer::Pdu> pdus;
+        TraceAnalyzer::Pdu pdu;
+        for (const auto& shardFrame : *input) {
+            Reassembly& state = shardFrame.functional ? broadcast : (shardFrame.fromTester ? tester : ecu);
+            if (state.feed(shardFrame.frame, pdu, result.reassemblyErrors)) {
+                pdu.fromTester = shardFrame.fromTester;
+                pdu.functional = shardFrame.functional;
+                pdus.push_back(std::move(pdu));
+                pdu = TraceAnalyzer::Pdu();
+            }
+        }
+        result.pdus = pdus.size();
+        result.transactions = analyzer.pair(channel, pdus);
+        return result;
+    }
+};
+
+TraceAnalyzer::TraceAnalyzer(const TraceAnalyzerConfig& config) : pImpl(std::make_unique<Impl>(config)) {}
+
+TraceAnalyzer::~TraceAnalyzer() = default;
+
+TraceAnalysis TraceAnalyzer::analyze(const TraceReader& reader) const {
+    TraceAnalysis analysis;
+    auto logger = Logger::getInstance();
+    if (!reader.isOpen()) {
+        logger->error("Trace analysis needs an open trace");
+        return analysis;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    logger->info("Analyzing " + reader.toString() + ": " + pImpl->config.toString());
+
+    // Index blocks start on record boundaries, so any run of them can be scanned independently
+    TraceIndex index;
+    index.load(reader);
+    const TraceIndexBlock* blocks = index.getBlocks();
+    const uint64_t blockCount = index.getBlockCount();
+
+    const uint64_t threads = getGlobalThreadPool()->getThreadCount();
+    const uint64_t chunkTarget = std::max<uint64_t>(1, threads * std::max<uint32_t>(1, pImpl->config.chunksPerThread));
+    const uint64_t blocksPerChunk = std::max<uint64_t>(1, (blockCount + chunkTarget - 1) / chunkTarget);
+
+    std::vector<std::function<ChunkResult()>> scans;
+    for (uint64_t first = 0; first < blockCount; first += blocksPerChunk) {
+        uint64_t last = std::min(blockCount, first + blocksPerChunk);
+        uint64_t begin = first;
+        while (begin < last && blocks[begin].frames == 0) {
+            ++begin;
+        }
+        if (begin == last) {
+            continue;
+        }
+        uint64_t end = last == blockCount ? reader.getDataBytes() : last * index.getBlockSize();
+        scans.push_back([this, &reader, offset = blocks[begin].offset, end] {
+            return pImpl->scanChunk(reader, offset, end);
+        });
+    }
+
+    // Concatenating chunk results in order keeps each channel in file order
+    std::map<uint64_t, std::vector<ShardFrame>> shards;
+    std::vector<ShardFrame> functional;
+    for (auto& chunk : runAll(scans)) {
+        analysis.framesScanned += chunk.frames;
+        analysis.diagnosticFrames += chunk.functional.size();
+        functional.insert(functional.end(), chunk.functional.begin(), chunk.functional.end());
+        for (auto& shard : chunk.shards) {
+            analysis.diagnosticFrames += shard.second.size();
+            auto& frames = shards[shard.first];
+            if (frames.empty()) {
+                frames = std::move(shard.second);
+            } else {
+                frames.insert(frames.end(), shard.second.begin(), shard.second.end());
+            }
+        }
+    }
+
+    std::vector<std::function<ChannelResult()>> channels;
+    for (const auto& shard : shards) {
+        channels.push_back([this, &shard, &functional] {
+            return pImpl->analyzeChannel(*this, shard.first, shard.second, functional);
+        });
+    }
+    for (auto& result : runAll(channels)) {
+        analysis.pdus += result.pdus;
+        analysis.reassemblyErrors += result.reassemblyErrors;
+        analysis.transactions.insert(analysis.transactions.end(),
+                                     std::make_move_iterator(result.transactions.begin()),
+                                     std::make_move_iterator(result.transactions.end()));
+    }
+    analysis.channels = shards.size();
+
+    auto startOf = [](const DiagnosticTransaction& t) {
+        return t.status == TransactionStatus::UNSOLICITED ? t.responseStartNs : t.requestStartNs;
+    };
+    std::stable_sort(analysis.transactions.begin(), analysis.transactions.end(),
+                     [&startOf](const DiagnosticTransaction& a, const DiagnosticTransaction& b) {
+                         return startOf(a) < startOf(b);
+                     });
+
+    analysis.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    logger->info("Trace analysis completed: " + analysis.toString());
+    return analysis;
+}
+
+std::vector<DiagnosticTransaction> TraceAnalyzer::pair(const TraceChannel& channel, const std::vector<Pdu>& pdus) const {
+    const int64_t timeoutNs = static_cast<int64_t>(pImpl->config.responseTimeout) * NS_PER_MS;
+    std::vector<DiagnosticTransaction> transactions;
+    DiagnosticTransaction pending;
+    bool waiting = false;
+    int64_t deadline = 0;
+
+    // Unanswered functional requests are expected from most ECUs and are not reported
+    auto expire = [&] {
+        if (waiting && !pending.functional) {
+            transactions.push_back(std::move(pending));
+        }
+        waiting = false;
+    };
+
+    for (const auto& pdu : pdus) {
+        if (pdu.data.empty()) {
+            continue;
+        }
+        if (waiting && pdu.startNs > deadline) {
+            expire();
+        }
+
+        const uint8_t sid = pdu.data[0];
+        if (pdu.fromTester) {
+            expire();
+            pending = DiagnosticTransaction();
+            pending.channel = channel;
+            pending.service = sid;
+            pending.protocol = sid <= OBD_LAST_MODE ? TransactionProtocol::OBD : TransactionProtocol::UDS;
+            pending.functional = pdu.functional;
+            pending.requestStartNs = pdu.startNs;
+            pending.requestEndNs = pdu.endNs;
+            pending.request = pdu.data;
+            if (hasSubFunction(sid) && pdu.data.size() > 1 && (pdu.data[1] & SUPPRESS_POSITIVE_RESPONSE)) {
+                pending.status = TransactionStatus::SUPPRESSED;
+                if (!pending.functional) {
+                    transactions.push_back(std::move(pending));
+                }
+                continue;
+            }
+            waiting = true;
+            deadline = pdu.endNs + timeoutNs;
+            continue;
+        }
+
+        const bool negative = sid == NEGATIVE_RESPONSE_SID && pdu.data.size() >= 3;
+        const uint8_t service = negative ? pdu.data[1] : static_cast<uint8_t>(sid - POSITIVE_RESPONSE_OFFSET);
+        if (waiting && service == pending.service) {
+            if (negative && pdu.data[2] == NRC_RESPONSE_PENDING) {
+                pending.pendingResponses++;
+                deadline = pdu.endNs + timeoutNs;
+                continue;
+            }
+            pending.status = negative ? TransactionStatus::NEGATIVE : TransactionStatus::POSITIVE;
+            pending.negativeResponseCode = negative ? pdu.data[2] : 0;
+            pending.responseStartNs = pdu.startNs;
+            pending.responseEndNs = pdu.endNs;
+            pending.response = pdu.data;
+            transactions.push_back(std::move(pending));
+            waiting = false;
+            continue;
+        }
+
+        DiagnosticTransaction unsolicited;
+        unsolicited.channel = channel;
+        unsolicited.status = TransactionStatus::UNSOLICITED;
+        unsolicited.service = service;
+        unsolicited.protocol = service <= OBD_LAST_MODE ? TransactionProtocol::OBD : TransactionProtocol::UDS;
+        unsolicited.negativeResponseCode = negative ? pdu.data[2] : 0;
+        unsolicited.responseStartNs = pdu.startNs;
+        unsolicited.responseEndNs = pdu.endNs;
+        unsolicited.response = pdu.data;
+        transactions.push_back(std::move(unsolicited));
+    }
+    expire();
+    return transactions;
+}
+
+// Utility functions
+std::string transactionStatusToString(TransactionStatus status) {
+    switch (status) {
+        case TransactionStatus::POSITIVE: return "Positive";
+        case TransactionStatus::NEGATIVE: return "Negative";
+        case TransactionStatus::NO_RESPONSE: return "NoResponse";
+        case TransactionStatus::SUPPRESSED: return "Suppressed";
+        case TransactionStatus::UNSOLICITED: return "Unsolicited";
+        default: return "Unknown";
+    }
+}
+
+} // namespace trace
+} // namespace fmus
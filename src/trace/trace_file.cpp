@@ -0,0 +1,325 @@
+#include <fmus/trace/trace_file.h>
+#include <fmus/logger.h>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
+namespace fmus {
+namespace trace {
+
+static_assert(sizeof(TraceFileHeader) <= TRACE_HEADER_SIZE, "TraceFileHeader must fit its page");
+static_assert(sizeof(TraceRecordHeader) == 16, "TraceRecordHeader must stay 16 bytes");
+static_assert(sizeof(TraceIndexBlock) == 96, "TraceIndexBlock must stay 96 bytes");
+
+namespace {
+
+constexpr int64_t NS_PER_SECOND = 1000000000;
+constexpr size_t LINE_BUFFER = 512;
+
+/**
+ * Append the payload as hex, with an optional separator between bytes
+ */
+char* appendHex(char* out, const uint8_t* data, size_t length, bool spaced) {
+    static const char digits[] = "0123456789ABCDEF";
+    for (size_t i = 0; i < length; ++i) {
+        if (spaced) {
+            *out++ = ' ';
+        }
+        *out++ = digits[data[i] >> 4];
+        *out++ = digits[data[i] & 0x0F];
+    }
+    return out;
+}
+
+} // anonymous namespace
+
+// TraceFrame implementation
+protocols::CANMessage TraceFrame::toCANMessage() const {
+    protocols::CANMessage message(id, std::vector<uint8_t>(data, data + length), extended());
+    message.rtr = (flags & TraceFlags::RTR) != 0;
+    message.fd = (flags & TraceFlags::FD) != 0;
+    message.brs = (flags & TraceFlags::BRS) != 0;
+    message.esi = (flags & TraceFlags::ESI) != 0;
+    message.timestamp = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(timestampNs)));
+    return message;
+}
+
+// TraceReader implementation
+class TraceReader::Impl {
+public:
+    std::string path;
+    const uint8_t* mapping = nullptr;
+    size_t mappedBytes = 0;
+    TraceFileHeader header{};
+    const uint8_t* data = nullptr;
+    uint64_t dataBytes = 0;
+
+    bool open(const std::string& filePath) {
+#ifdef __linux__
+        auto logger = Logger::getInstance();
+        int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            logger->error("Failed to open trace " + filePath + ": " + std::strerror(errno));
+            return false;
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < TRACE_HEADER_SIZE) {
+            logger->error("Not a trace file: " + filePath);
+            ::close(fd);
+            return false;
+        }
+
+        void* view = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) {
+            logger->error("Failed to map trace " + filePath + ": " + std::strerror(errno));
+            return false;
+        }
+        ::madvise(view, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+        mapping = static_cast<const uint8_t*>(view);
+        mappedBytes = static_cast<size_t>(st.st_size);
+        std::memcpy(&header, mapping, sizeof(header));
+        if (header.magic != TRACE_MAGIC || header.version != TRACE_VERSION || header.segmentSize == 0) {
+            logger->error("Not a trace file: " + filePath);
+            close();
+            return false;
+        }
+
+        data = mapping + TRACE_HEADER_SIZE;
+        dataBytes = mappedBytes - TRACE_HEADER_SIZE;
+        if (header.closed && header.dataBytes < dataBytes) {
+            dataBytes = header.dataBytes;
+        }
+        path = filePath;
+        return true;
+#else
+        Logger::getInstance()->error("Trace files are only supported on Linux: " + filePath);
+        return false;
+#endif
+    }
+
+    void close() {
+#ifdef __linux__
+        if (mapping) {
+            ::munmap(const_cast<uint8_t*>(mapping), mappedBytes);
+        }
+#endif
+        mapping = nullptr;
+        data = nullptr;
+        mappedBytes = 0;
+        dataBytes = 0;
+        header = TraceFileHeader{};
+    }
+
+    int64_t firstTimestamp() const {
+        TraceCursor cursor;
+        TraceFrame frame;
+        if (header.startTimeNs) {
+            return header.startTimeNs;
+        }
+        return next(cursor, frame) ? frame.timestampNs : 0;
+    }
+
+    bool next(TraceCursor& cursor, TraceFrame& frame) const {
+        return readTraceRecord(data, dataBytes, header.segmentSize, cursor, frame);
+    }
+};
+
+TraceReader::TraceReader() : pImpl(std::make_unique<Impl>()) {}
+
+TraceReader::~TraceReader() {
+    close();
+}
+
+bool TraceReader::open(const std::string& path) {
+    close();
+    return pImpl->open(path);
+}
+
+void TraceReader::close() {
+    pImpl->close();
+}
+
+bool TraceReader::isOpen() const {
+    return pImpl->mapping != nullptr;
+}
+
+const TraceFileHeader& TraceReader::getHeader() const {
+    return pImpl->header;
+}
+
+uint64_t TraceReader::getDataBytes() const {
+    return pImpl->dataBytes;
+}
+
+bool TraceReader::next(TraceCursor& cursor, TraceFrame& frame) const {
+    return pImpl->next(cursor, frame);
+}
+
+const TraceIndexBlock* TraceReader::getIndex(uint64_t& blocks) const {
+    const TraceFileHeader& header = pImpl->header;
+    blocks = 0;
+    if (!isOpen() || !header.closed || header.indexOffset == 0 || header.indexOffset % 8 != 0 ||
+        header.indexOffset + header.indexBlocks * sizeof(TraceIndexBlock) > pImpl->mappedBytes) {
+        return nullptr;
+    }
+    blocks = header.indexBlocks;
+    return reinterpret_cast<const TraceIndexBlock*>(pImpl->mapping + header.indexOffset);
+}
+
+bool TraceReader::exportCandump(const std::string& path, const std::string& interfaceName) const {
+    if (!isOpen()) {
+        return false;
+    }
+    FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) {
+        Logger::getInstance()->error("Failed to create " + path);
+        return false;
+    }
+
+    char line[LINE_BUFFER];
+    TraceCursor cursor;
+    TraceFrame frame;
+    while (next(cursor, frame)) {
+        int n = std::snprintf(line, sizeof(line), frame.extended() ? "(%" PRId64 ".%06" PRId64 ") %s %08" PRIX32 "#"
+                                                                   : "(%" PRId64 ".%06" PRId64 ") %s %03" PRIX32 "#",
+                              frame.timestampNs / NS_PER_SECOND, (frame.timestampNs % NS_PER_SECOND) / 1000,
+                              interfaceName.c_str(), frame.id);
+        char* end = line + n;
+        if (frame.flags & TraceFlags::FD) {
+            // candump FD flags nibble: BRS 1, ESI 2
+            *end++ = '#';
+            *end++ = "0123456789ABCDEF"[((frame.flags & TraceFlags::BRS) ? 1 : 0) | ((frame.flags & TraceFlags::ESI) ? 2 : 0)];
+        } else if (frame.flags & TraceFlags::RTR) {
+            *end++ = 'R';
+        }
+        if (!(frame.flags & TraceFlags::RTR)) {
+            end = appendHex(end, frame.data, frame.length, false);
+        }
+        *end++ = '\n';
+        std::fwrite(line, 1, static_cast<size_t>(end - line), out);
+    }
+
+    bool ok = std::ferror(out) == 0;
+    std::fclose(out);
+    return ok;
+}
+
+bool TraceReader::exportAsc(const std::string& path, uint32_t channel) const {
+    if (!isOpen()) {
+        return false;
+    }
+    FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) {
+        Logger::getInstance()->error("Failed to create " + path);
+        return false;
+    }
+
+    const int64_t startNs = pImpl->firstTimestamp();
+    std::time_t startSeconds = static_cast<std::time_t>(startNs / NS_PER_SECOND);
+    std::tm local{};
+    localtime_r(&startSeconds, &local);
+    char date[64];
+    std::strftime(date, sizeof(date), "%a %b %d %I:%M:%S", &local);
+    const char* meridiem = local.tm_hour < 12 ? "am" : "pm";
+    int millis = static_cast<int>((startNs % NS_PER_SECOND) / 1000000);
+    std::fprintf(out, "date %s.%03d %s %d\n", date, millis, meridiem, local.tm_year + 1900);
+    std::fprintf(out, "base hex  timestamps absolute\n");
+    std::fprintf(out, "no internal events logged\n");
+    std::fprintf(out, "Begin Triggerblock %s.%03d %s %d\n", date, millis, meridiem, local.tm_year + 1900);
+    std::fprintf(out, "   0.000000 Start of measurement\n");
+
+    char line[LINE_BUFFER];
+    TraceCursor cursor;
+    TraceFrame frame;
+    while (next(cursor, frame)) {
+        double seconds = static_cast<double>(frame.timestampNs - startNs) / NS_PER_SECOND;
+        char id[16];
+        std::snprintf(id, sizeof(id), frame.extended() ? "%" PRIX32 "x" : "%" PRIX32, frame.id);
+
+        int n;
+        if (frame.flags & TraceFlags::FD) {
+            n = std::snprintf(line, sizeof(line), "%11.6f CANFD %3" PRIu32 " Rx %10s  %d %d %X %2u",
+                              seconds, channel, id, (frame.flags & TraceFlags::BRS) ? 1 : 0,
+                              (frame.flags & TraceFlags::ESI) ? 1 : 0,
+                              protocols::canLengthToDlc(frame.length), frame.length);
+        } else if (frame.flags & TraceFlags::RTR) {
+            n = std::snprintf(line, sizeof(line), "%11.6f %" PRIu32 "  %-15s Rx   r %u",
+                              seconds, channel, id, frame.length);
+        } else {
+            n = std::snprintf(line, sizeof(line), "%11.6f %" PRIu32 "  %-15s Rx   d %u",
+                              seconds, channel, id, frame.length);
+        }
+        char* end = line + n;
+        if (!(frame.flags & TraceFlags::RTR)) {
+            end = appendHex(end, frame.data, frame.length, true);
+        }
+        *end++ = '\n';
+        std::fwrite(line, 1, static_cast<size_t>(end - line), out);
+    }
+
+    std::fprintf(out, "End TriggerBlock\n");
+    bool ok = std::ferror(out) == 0;
+    std::fclose(out);
+    return ok;
+}
+
+std::string TraceReader::toString() const {
+    std::ostringstream ss;
+    ss << "TraceReader[" << (isOpen() ? pImpl->path : "<closed>")
+       << ", Data:" << pImpl->dataBytes << " bytes"
+       << ", Frames:" << (pImpl->header.closed ? std::to_string(pImpl->header.frameCount) : "?")
+       << ", Closed:" << (pImpl->header.closed ? "Yes" : "No") << "]";
+    return ss.str();
+}
+
+// Utility functions
+uint8_t traceFlagsFromMessage(const protocols::CANMessage& message) {
+    uint8_t flags = 0;
+    if (message.extended) flags |= TraceFlags::EXTENDED;
+    if (message.rtr) flags |= TraceFlags::RTR;
+    if (message.fd) flags |= TraceFlags::FD;
+    if (message.brs) flags |= TraceFlags::BRS;
+    if (message.esi) flags |= TraceFlags::ESI;
+    return flags;
+}
+
+bool readTraceRecord(const uint8_t* data, uint64_t length, uint64_t segmentSize,
+                     TraceCursor& cursor, TraceFrame& frame) {
+    while (cursor.offset < length) {
+        const uint64_t remaining = segmentSize - cursor.offset % segmentSize;
+        if (remaining >= sizeof(TraceRecordHeader)) {
+            TraceRecordHeader record;
+            std::memcpy(&record, data + cursor.offset, sizeof(record));
+            size_t size = traceRecordSize(record.length);
+            if (record.type == static_cast<uint16_t>(TraceRecordType::FRAME) && size <= remaining) {
+                frame.timestampNs = record.timestampNs;
+                frame.id = record.id;
+                frame.flags = record.flags;
+                frame.length = record.length;
+                frame.data = data + cursor.offset + sizeof(TraceRecordHeader);
+                cursor.offset += size;
+                return true;
+            }
+        }
+        // PAD, short tail, or nothing more was written to this segment
+        cursor.offset += remaining;
+    }
+    return false;
+}
+
+} // namespace trace
+} // namespace fmus
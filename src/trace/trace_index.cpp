@@ -0,0 +1,217 @@
+#include <fmus/trace/trace_index.h>
+#include <fmus/logger.h>
+#include <algorithm>
+
+namespace fmus {
+namespace trace {
+
+namespace {
+
+constexpr uint32_t BLOOM_BITS_MASK = 511;
+
+uint32_t mixId(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7FEB352D;
+    x ^= x >> 15;
+    x *= 0x846CA68B;
+    x ^= x >> 16;
+    return x;
+}
+
+TraceIndexBlock emptyBlock(uint64_t offset) {
+    TraceIndexBlock block{};
+    block.offset = offset;
+    block.minTimeNs = std::numeric_limits<int64_t>::max();
+    block.maxTimeNs = std::numeric_limits<int64_t>::min();
+    return block;
+}
+
+} // anonymous namespace
+
+// TraceIndexBuilder implementation
+TraceIndexBuilder::TraceIndexBuilder(uint32_t blockSize)
+    : blockSize(blockSize ? blockSize : TRACE_DEFAULT_INDEX_BLOCK) {}
+
+void TraceIndexBuilder::add(uint64_t offset, const TraceFrame& frame) {
+    uint64_t index = offset / blockSize;
+    while (blocks.size() <= index) {
+        blocks.push_back(emptyBlock(blocks.size() * static_cast<uint64_t>(blockSize)));
+    }
+
+    // A block's offset is its first record, so scans never start mid-record
+    TraceIndexBlock& block = blocks[index];
+    if (block.frames == 0) {
+        block.offset = offset;
+    }
+    block.minTimeNs = std::min(block.minTimeNs, frame.timestampNs);
+    block.maxTimeNs = std::max(block.maxTimeNs, frame.timestampNs);
+    block.frames++;
+    traceBloomAdd(block.idBloom, frame.id);
+}
+
+void TraceIndexBuilder::addSegments(const uint8_t* data, uint64_t regionOffset, uint64_t length, uint64_t segmentSize) {
+    TraceCursor cursor;
+    TraceFrame frame;
+    while (readTraceRecord(data, length, segmentSize, cursor, frame)) {
+        add(regionOffset + cursor.offset - traceRecordSize(frame.length), frame);
+    }
+}
+
+// TraceIndex implementation
+class TraceIndex::Impl {
+public:
+    const TraceReader* reader = nullptr;
+    std::vector<TraceIndexBlock> built;
+    const TraceIndexBlock* blocks = nullptr;
+    uint64_t count = 0;
+    uint64_t blockSize = TRACE_DEFAULT_INDEX_BLOCK;
+
+    // Running maximum of block end times and trailing minimum of start times,
+    // so ranges resolve by binary search even if blocks overlap slightly in time
+    std::vector<int64_t> prefixMax;
+    std::vector<int64_t> suffixMin;
+
+    void summarize() {
+        prefixMax.resize(count);
+        suffixMin.resize(count);
+        int64_t running = std::numeric_limits<int64_t>::min();
+        for (uint64_t i = 0; i < count; ++i) {
+            running = std::max(running, blocks[i].maxTimeNs);
+            prefixMax[i] = running;
+        }
+        running = std::numeric_limits<int64_t>::max();
+        for (uint64_t i = count; i-- > 0;) {
+            running = std::min(running, blocks[i].minTimeNs);
+            suffixMin[i] = running;
+        }
+    }
+
+    uint64_t firstBlock(int64_t timeNs) const {
+        return static_cast<uint64_t>(std::lower_bound(prefixMax.begin(), prefixMax.end(), timeNs) - prefixMax.begin());
+    }
+};
+
+TraceIndex::TraceIndex() : pImpl(std::make_unique<Impl>()) {}
+
+TraceIndex::~TraceIndex() = default;
+
+bool TraceIndex::load(const TraceReader& reader) {
+    if (!reader.isOpen()) {
+        return false;
+    }
+
+    *pImpl = Impl();
+    pImpl->reader = &reader;
+    const TraceIndexBlock* stored = reader.getIndex(pImpl->count);
+    const uint32_t blockSize = reader.getHeader().indexBlockSize;
+    if (stored && blockSize) {
+        pImpl->blocks = stored;
+        pImpl->blockSize = blockSize;
+    } else {
+        // Unclosed file: rebuild at the block size the recorder was using
+        Logger::getInstance()->info("Trace has no index, scanning: " + reader.toString());
+        TraceIndexBuilder builder(blockSize);
+        TraceCursor cursor;
+        TraceFrame frame;
+        while (reader.next(cursor, frame)) {
+            builder.add(cursor.offset - traceRecordSize(frame.length), frame);
+        }
+        pImpl->built = builder.getBlocks();
+        pImpl->blocks = pImpl->built.data();
+        pImpl->count = pImpl->built.size();
+        pImpl->blockSize = builder.getBlockSize();
+    }
+    pImpl->summarize();
+    return true;
+}
+
+bool TraceIndex::isLoaded() const {
+    return pImpl->reader != nullptr;
+}
+
+uint64_t TraceIndex::getBlockCount() const {
+    return pImpl->count;
+}
+
+const TraceIndexBlock* TraceIndex::getBlocks() const {
+    return pImpl->blocks;
+}
+
+uint64_t TraceIndex::getBlockSize() const {
+    return pImpl->blockSize;
+}
+
+TraceCursor TraceIndex::seek(int64_t timeNs) const {
+    TraceCursor cursor;
+    if (!pImpl->reader) {
+        return cursor;
+    }
+    uint64_t index = pImpl->firstBlock(timeNs);
+    cursor.offset = index < pImpl->count ? pImpl->blocks[index].offset : pImpl->reader->getDataBytes();
+    return cursor;
+}
+
+uint64_t TraceIndex::query(const TraceQuery& query, const Visitor& visitor, TraceQueryStatistics* statistics) const {
+    TraceQueryStatistics local;
+    TraceQueryStatistics& stats = statistics ? *statistics : local;
+    stats = TraceQueryStatistics{};
+    if (!pImpl->reader || !visitor) {
+        return 0;
+    }
+
+    const TraceReader& reader = *pImpl->reader;
+    const uint64_t dataBytes = reader.getDataBytes();
+    for (uint64_t i = pImpl->firstBlock(query.fromNs); i < pImpl->count && pImpl->suffixMin[i] <= query.toNs; ++i) {
+        const TraceIndexBlock& block = pImpl->blocks[i];
+        if (block.frames == 0 || block.minTimeNs > query.toNs || block.maxTimeNs < query.fromNs) {
+            continue;
+        }
+        if (!query.ids.empty() &&
+            std::none_of(query.ids.begin(), query.ids.end(),
+                         [&block](uint32_t id) { return traceBloomMayContain(block.idBloom, id); })) {
+            stats.blocksSkipped++;
+            continue;
+        }
+
+        stats.blocksScanned++;
+        const uint64_t end = std::min<uint64_t>((i + 1) * pImpl->blockSize, dataBytes);
+        TraceCursor cursor{block.offset};
+        TraceFrame frame;
+        while (reader.next(cursor, frame) && cursor.offset - traceRecordSize(frame.length) < end) {
+            if (frame.timestampNs < query.fromNs || frame.timestampNs > query.toNs) {
+                continue;
+            }
+            if (!query.ids.empty() && std::find(query.ids.begin(), query.ids.end(), frame.id) == query.ids.end()) {
+                continue;
+            }
+            stats.framesMatched++;
+            if (!visitor(frame)) {
+                return stats.framesMatched;
+            }
+        }
+    }
+    return stats.framesMatched;
+}
+
+// Utility functions
+void traceBloomAdd(uint64_t* bloom, uint32_t id) {
+    uint32_t hash = mixId(id);
+    for (int k = 0; k < 3; ++k) {
+        uint32_t bit = (hash >> (9 * k)) & BLOOM_BITS_MASK;
+        bloom[bit >> 6] |= 1ULL << (bit & 63);
+    }
+}
+
+bool traceBloomMayContain(const uint64_t* bloom, uint32_t id) {
+    uint32_t hash = mixId(id);
+    for (int k = 0; k < 3; ++k) {
+        uint32_t bit = (hash >> (9 * k)) & BLOOM_BITS_MASK;
+        if (!(bloom[bit >> 6] & (1ULL << (bit & 63)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace trace
+} // namespace fmus
@@ -0,0 +1,449 @@
+#include <fmus/trace/trace_recorder.h>
+#include <fmus/trace/trace_index.h>
+#include <fmus/logger.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
+namespace fmus {
+namespace trace {
+
+namespace {
+
+constexpr uint64_t PAGE_SIZE_BYTES = 4096;
+constexpr size_t MAX_PAYLOAD = 64;
+constexpr auto MAPPER_POLL = std::chrono::milliseconds(100);
+
+int64_t toNanoseconds(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+} // anonymous namespace
+
+std::string TraceRecorderConfig::toString() const {
+    std::ostringstream ss;
+    ss << "TraceRecorderConfig[Segment:" << (segmentSize >> 10) << "KB"
+       << ", Max:" << (maxBytes >> 20) << "MB"
+       << ", Ahead:" << segmentsAhead
+       << ", IndexBlock:" << (indexBlockSize >> 10) << "KB]";
+    return ss.str();
+}
+
+// TraceRecorder implementation
+class TraceRecorder::Impl {
+public:
+    struct SegmentSlot {
+        std::atomic<uint8_t*> base{nullptr};
+        std::atomic<uint64_t> committed{0};     ///< Reserved bytes fully written; the segment is done at segmentSize
+    };
+
+    std::string path;
+    TraceRecorderConfig config;
+    int fd = -1;
+    uint64_t segmentCount = 0;
+    std::unique_ptr<SegmentSlot[]> segments;
+    int64_t startNs = 0;
+
+    // Writer state
+    std::atomic<uint64_t> cursor{0};            ///< Next free byte of the data region
+    std::atomic<bool> recording{false};
+    std::atomic<uint32_t> inFlight{0};
+    std::atomic<int64_t> lastNs{0};
+    std::atomic<uint64_t> framesRecorded{0};
+    std::atomic<uint64_t> framesDropped{0};
+    std::atomic<uint64_t> bytesWritten{0};
+    std::atomic<uint64_t> segmentsMapped{0};
+
+    // Mapper thread state
+    std::thread mapper;
+    std::mutex mapperMutex;
+    std::condition_variable mapperCondition;
+    std::atomic<bool> mapperWake{false};
+    bool stopMapper = false;
+    uint64_t nextToMap = 0;
+    uint64_t nextToUnmap = 0;
+    std::atomic<bool> mappingFailed{false};
+
+    // Block summaries, built from each segment before it is unmapped
+    std::unique_ptr<TraceIndexBuilder> indexBuilder;
+    uint64_t indexOffset = 0;
+    uint64_t indexBlocks = 0;
+
+    std::shared_ptr<protocols::CANProtocol> canProtocol;
+    uint32_t listenerId = 0;
+
+    std::chrono::system_clock::time_point startTime = std::chrono::system_clock::now();
+
+    void writeHeader(bool closed) {
+#ifdef __linux__
+        TraceFileHeader header{};
+        header.magic = TRACE_MAGIC;
+        header.version = TRACE_VERSION;
+        header.segmentSize = config.segmentSize;
+        header.startTimeNs = startNs;
+        header.indexBlockSize = indexBuilder ? indexBuilder->getBlockSize() : 0;
+        if (closed) {
+            header.dataBytes = std::min(cursor.load(), segmentCount * config.segmentSize);
+            header.frameCount = framesRecorded;
+            header.endTimeNs = lastNs;
+            header.closed = 1;
+            header.indexOffset = indexOffset;
+            header.indexBlocks = indexBlocks;
+        }
+        if (::pwrite(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+            Logger::getInstance()->error("Failed to write trace header: " + std::string(std::strerror(errno)));
+        }
+#else
+        (void)closed;
+#endif
+    }
+
+    bool mapSegment(uint64_t index) {
+#ifdef __linux__
+        const off_t offset = static_cast<off_t>(TRACE_HEADER_SIZE + index * config.segmentSize);
+        const size_t size = static_cast<size_t>(config.segmentSize);
+        int error = ::posix_fallocate(fd, offset, static_cast<off_t>(size));
+        if (error == 0) {
+            void* view = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, offset);
+            if (view != MAP_FAILED) {
+                segments[index].base.store(static_cast<uint8_t*>(view), std::memory_order_release);
+                segmentsMapped++;
+                return true;
+            }
+            error = errno;
+        }
+        Logger::getInstance()->error("Failed to allocate trace segment " + std::to_string(index) + ": " +
+                                     std::strerror(error));
+#else
+        (void)index;
+#endif
+        mappingFailed = true;
+        return false;
+    }
+
+    void unmapSegment(uint64_t index, uint64_t used) {
+        uint8_t* base = segments[index].base.exchange(nullptr, std::memory_order_acq_rel);
+        if (base && indexBuilder && used) {
+            indexBuilder->addSegments(base, index * config.segmentSize, used, config.segmentSize);
+        }
+#ifdef __linux__
+        if (base) {
+            ::munmap(base, static_cast<size_t>(config.segmentSize));
+        }
+#else
+        (void)base;
+#endif
+    }
+
+    /**
+     * Keep segmentsAhead segments mapped past the writer and release finished ones
+     */
+    void maintainSegments() {
+        uint64_t current = cursor.load(std::memory_order_relaxed) / config.segmentSize;
+        while (!mappingFailed && nextToMap < segmentCount && nextToMap <= current + config.segmentsAhead) {
+            if (mapSegment(nextToMap)) {
+                nextToMap++;
+            }
+        }
+        while (nextToUnmap < nextToMap &&
+               segments[nextToUnmap].committed.load(std::memory_order_acquire) >= config.segmentSize) {
+            unmapSegment(nextToUnmap++, config.segmentSize);
+        }
+    }
+
+    void writeIndex(uint64_t dataBytes) {
+#ifdef __linux__
+        if (!indexBuilder) {
+            return;
+        }
+        const auto& blocks = indexBuilder->getBlocks();
+        const size_t bytes = blocks.size() * sizeof(TraceIndexBlock);
+        const uint64_t offset = TRACE_HEADER_SIZE + dataBytes;
+        if (::pwrite(fd, blocks.data(), bytes, static_cast<off_t>(offset)) != static_cast<ssize_t>(bytes)) {
+            Logger::getInstance()->warning("Failed to write trace index: " + std::string(std::strerror(errno)));
+            return;
+        }
+        indexOffset = offset;
+        indexBlocks = blocks.size();
+#else
+        (void)dataBytes;
+#endif
+    }
+
+    void mapperLoop() {
+        std::unique_lock<std::mutex> lock(mapperMutex);
+        while (!stopMapper) {
+            mapperCondition.wait_for(lock, MAPPER_POLL, [this] { return stopMapper || mapperWake.exchange(false); });
+            if (stopMapper) {
+                break;
+            }
+            lock.unlock();
+            maintainSegments();
+            lock.lock();
+        }
+    }
+
+    void wakeMapper() {
+        mapperWake.store(true, std::memory_order_relaxed);
+        mapperCondition.notify_one();
+    }
+
+    /**
+     * Close out the unused end of a segment that a record did not fit in
+     */
+    void finishSegment(uint64_t offset, uint64_t length) {
+        uint64_t index = offset / config.segmentSize;
+        if (index >= segmentCount) {
+            return;
+        }
+        SegmentSlot& slot = segments[index];
+        uint8_t* base = slot.base.load(std::memory_order_acquire);
+        if (base && length >= sizeof(TraceRecordHeader)) {
+            auto pad = reinterpret_cast<TraceRecordHeader*>(base + offset % config.segmentSize);
+            pad->type = static_cast<uint16_t>(TraceRecordType::PAD);
+        }
+        slot.committed.fetch_add(length, std::memory_order_release);
+        wakeMapper();
+    }
+
+    bool record(const protocols::CANMessage& message) {
+        if (!recording.load(std::memory_order_acquire)) {
+            return false;
+        }
+        inFlight.fetch_add(1, std::memory_order_acq_rel);
+        if (!recording.load(std::memory_order_acquire)) {
+            inFlight.fetch_sub(1, std::memory_order_release);
+            return false;
+        }
+
+        const size_t length = std::min(message.data.size(), MAX_PAYLOAD);
+        const uint64_t size = traceRecordSize(length);
+        const uint64_t segmentSize = config.segmentSize;
+
+        // Reserve; a record that would straddle a segment moves to the next one
+        uint64_t offset = cursor.load(std::memory_order_relaxed);
+        uint64_t start;
+        do {
+            uint64_t position = offset % segmentSize;
+            start = position + size > segmentSize ? offset - position + segmentSize : offset;
+        } while (!cursor.compare_exchange_weak(offset, start + size, std::memory_order_relaxed));
+
+        if (start != offset) {
+            finishSegment(offset, start - offset);
+        } else if (start % segmentSize == 0) {
+            wakeMapper();
+        }
+
+        bool written = false;
+        uint64_t index = start / segmentSize;
+        if (index < segmentCount) {
+            SegmentSlot& slot = segments[index];
+            uint8_t* base = slot.base.load(std::memory_order_acquire);
+            while (!base && !mappingFailed.load(std::memory_order_relaxed)) {
+                // The mapper is a full segmentsAhead behind; wait rather than drop
+                wakeMapper();
+                std::this_thread::yield();
+                base = slot.base.load(std::memory_order_acquire);
+            }
+            if (base) {
+                uint8_t* target = base + start % segmentSize;
+                auto header = reinterpret_cast<TraceRecordHeader*>(target);
+                header->timestampNs = toNanoseconds(message.timestamp);
+                header->id = message.id;
+                header->flags = traceFlagsFromMessage(message);
+                header->length = static_cast<uint8_t>(length);
+                std::memcpy(target + sizeof(TraceRecordHeader), message.data.data(), length);
+                std::atomic_thread_fence(std::memory_order_release);
+                header->type = static_cast<uint16_t>(TraceRecordType::FRAME);
+                lastNs.store(header->timestampNs, std::memory_order_relaxed);
+                written = true;
+            }
+            slot.committed.fetch_add(size, std::memory_order_release);
+        }
+
+        if (written) {
+            framesRecorded.fetch_add(1, std::memory_order_relaxed);
+            bytesWritten.fetch_add(size, std::memory_order_relaxed);
+        } else {
+            framesDropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        inFlight.fetch_sub(1, std::memory_order_release);
+        return written;
+    }
+};
+
+TraceRecorder::TraceRecorder() : pImpl(std::make_unique<Impl>()) {}
+
+TraceRecorder::~TraceRecorder() {
+    close();
+}
+
+bool TraceRecorder::open(const std::string& path, const TraceRecorderConfig& config) {
+    auto logger = Logger::getInstance();
+    close();
+
+    if (config.segmentSize < PAGE_SIZE_BYTES || config.segmentSize % PAGE_SIZE_BYTES != 0) {
+        logger->error("Trace segment size must be a multiple of " + std::to_string(PAGE_SIZE_BYTES));
+        return false;
+    }
+    if (config.indexBlockSize && (config.indexBlockSize % 8 != 0 || config.segmentSize % config.indexBlockSize != 0)) {
+        logger->error("Trace index block size must divide the segment size");
+        return false;
+    }
+
+#ifdef __linux__
+    pImpl->fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (pImpl->fd < 0) {
+        logger->error("Failed to create trace " + path + ": " + std::strerror(errno));
+        return false;
+    }
+#else
+    logger->error("Trace recording is only supported on Linux");
+    return false;
+#endif
+
+    pImpl->path = path;
+    pImpl->config = config;
+    pImpl->segmentCount = std::max<uint64_t>(config.maxBytes / config.segmentSize, 1);
+    pImpl->segments.reset(new Impl::SegmentSlot[pImpl->segmentCount]);
+    pImpl->cursor = 0;
+    pImpl->nextToMap = 0;
+    pImpl->nextToUnmap = 0;
+    pImpl->mappingFailed = false;
+    pImpl->framesRecorded = 0;
+    pImpl->framesDropped = 0;
+    pImpl->bytesWritten = 0;
+    pImpl->segmentsMapped = 0;
+    pImpl->startTime = std::chrono::system_clock::now();
+    pImpl->startNs = toNanoseconds(pImpl->startTime);
+    pImpl->lastNs = pImpl->startNs;
+    pImpl->indexBuilder.reset(config.indexBlockSize ? new TraceIndexBuilder(config.indexBlockSize) : nullptr);
+    pImpl->indexOffset = 0;
+    pImpl->indexBlocks = 0;
+    pImpl->writeHeader(false);
+
+    pImpl->maintainSegments();
+    if (pImpl->nextToMap == 0) {
+        close();
+        return false;
+    }
+
+    pImpl->stopMapper = false;
+    pImpl->mapper = std::thread(&TraceRecorder::Impl::mapperLoop, pImpl.get());
+    pImpl->recording = true;
+
+    logger->info("Trace recording to " + path + ": " + config.toString());
+    return true;
+}
+
+void TraceRecorder::close() {
+    if (pImpl->fd < 0) {
+        return;
+    }
+    detach();
+
+    pImpl->recording = false;
+    while (pImpl->inFlight.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+
+    if (pImpl->mapper.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(pImpl->mapperMutex);
+            pImpl->stopMapper = true;
+        }
+        pImpl->mapperCondition.notify_one();
+        pImpl->mapper.join();
+    }
+    const uint64_t segmentSize = pImpl->config.segmentSize;
+    const uint64_t dataBytes = std::min(pImpl->cursor.load(), pImpl->segmentCount * segmentSize);
+    for (uint64_t i = pImpl->nextToUnmap; i < pImpl->nextToMap; ++i) {
+        uint64_t start = i * segmentSize;
+        pImpl->unmapSegment(i, dataBytes > start ? std::min(dataBytes - start, segmentSize) : 0);
+    }
+
+#ifdef __linux__
+    if (::ftruncate(pImpl->fd, static_cast<off_t>(TRACE_HEADER_SIZE + dataBytes)) != 0) {
+        Logger::getInstance()->warning("Failed to trim trace " + pImpl->path);
+    }
+#endif
+    pImpl->writeIndex(dataBytes);
+    pImpl->writeHeader(true);
+#ifdef __linux__
+    ::fdatasync(pImpl->fd);
+    ::close(pImpl->fd);
+#endif
+    pImpl->fd = -1;
+    pImpl->segments.reset();
+
+    Logger::getInstance()->info("Trace closed: " + toString());
+}
+
+bool TraceRecorder::isOpen() const {
+    return pImpl->fd >= 0;
+}
+
+bool TraceRecorder::attach(std::shared_ptr<protocols::CANProtocol> canProtocol) {
+    if (!isOpen() || !canProtocol) {
+        return false;
+    }
+    detach();
+    pImpl->listenerId = canProtocol->addListener([impl = pImpl.get()](const protocols::CANMessage& message) {
+        impl->record(message);
+    });
+    if (!pImpl->listenerId) {
+        return false;
+    }
+    pImpl->canProtocol = std::move(canProtocol);
+    return true;
+}
+
+void TraceRecorder::detach() {
+    if (pImpl->canProtocol) {
+        pImpl->canProtocol->removeListener(pImpl->listenerId);
+        pImpl->canProtocol.reset();
+        pImpl->listenerId = 0;
+    }
+}
+
+bool TraceRecorder::record(const protocols::CANMessage& message) {
+    return pImpl->record(message);
+}
+
+TraceRecorder::Statistics TraceRecorder::getStatistics() const {
+    Statistics stats;
+    stats.framesRecorded = pImpl->framesRecorded;
+    stats.framesDropped = pImpl->framesDropped;
+    stats.bytesWritten = pImpl->bytesWritten;
+    stats.segmentsMapped = pImpl->segmentsMapped;
+    stats.startTime = pImpl->startTime;
+    return stats;
+}
+
+std::string TraceRecorder::getPath() const {
+    return pImpl->path;
+}
+
+std::string TraceRecorder::toString() const {
+    std::ostringstream ss;
+    ss << "TraceRecorder[" << (pImpl->path.empty() ? "<none>" : pImpl->path)
+       << ", Frames:" << pImpl->framesRecorded
+       << ", Dropped:" << pImpl->framesDropped
+       << ", Bytes:" << pImpl->bytesWritten
+       << ", Recording:" << (pImpl->recording ? "Yes" : "No") << "]";
+    return ss.str();
+}
+
+} // namespace trace
+} // namespace fmus
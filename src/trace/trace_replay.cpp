@@ -0,0 +1,234 @@
+#include <fmus/trace/trace_replay.h>
+#include <fmus/protocols/timing_engine.h>
+#include <fmus/logger.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace fmus {
+namespace trace {
+
+namespace {
+
+using Clock = protocols::TimingEngine::Clock;
+
+constexpr auto MAX_WAIT_SLICE = std::chrono::milliseconds(50);   // Bounds how long stop() waits out a trace gap
+constexpr uint64_t STATS_INTERVAL = 1024;
+
+} // anonymous namespace
+
+std::string TraceReplayConfig::toString() const {
+    std::ostringstream ss;
+    ss << "TraceReplayConfig[Speed:";
+    if (speed > 0) {
+        ss << speed << "x";
+    } else {
+        ss << "Max";
+    }
+    ss << ", Loop:" << (loop ? "Yes" : "No")
+       << ", Filters:" << filters.size()
+       << ", Timestamps:" << (originalTimestamps ? "Original" : "Replay") << "]";
+    return ss.str();
+}
+
+// TraceReplayer implementation
+class TraceReplayer::Impl {
+public:
+    TraceReader reader;
+    std::shared_ptr<protocols::CANProtocol> canProtocol;
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::atomic<bool> stopRequested{false};
+
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+    bool finished = true;
+
+    Statistics stats;
+    mutable std::mutex statsMutex;
+
+    Impl() {
+        stats.startTime = std::chrono::system_clock::now();
+    }
+
+    static bool passes(const std::vector<protocols::CANFilter>& filters, const protocols::CANMessage& message) {
+        if (filters.empty()) {
+            return true;
+        }
+        return std::any_of(filters.begin(), filters.end(),
+                           [&message](const protocols::CANFilter& filter) { return filter.matches(message); });
+    }
+
+    void publish(const Statistics& current) {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats = current;
+    }
+
+    uint64_t replay(protocols::CANProtocol& can, const TraceReplayConfig& config) {
+        protocols::TimingEngine timing;
+        if (config.cpuCore >= 0) {
+            protocols::TimingEngine::pinThreadToCore(config.cpuCore);
+        }
+
+        Statistics current;
+        current.startTime = std::chrono::system_clock::now();
+        publish(current);
+
+        const bool paced = config.speed > 0;
+        const Clock::time_point replayStart = Clock::now();
+        protocols::CANMessage message;
+        uint64_t passFrames;
+        do {
+            passFrames = 0;
+            TraceCursor cursor;
+            TraceFrame frame;
+            bool first = true;
+            int64_t traceStart = 0;
+            const Clock::time_point passStart = Clock::now();
+
+            while (!stopRequested.load(std::memory_order_relaxed) && reader.next(cursor, frame)) {
+                if (first) {
+                    traceStart = frame.timestampNs;
+                    first = false;
+                }
+
+                // One message reused for the whole replay; its buffer stops growing after the first FD frame
+                message.id = frame.id;
+                message.extended = frame.extended();
+                message.rtr = (frame.flags & TraceFlags::RTR) != 0;
+                message.fd = (frame.flags & TraceFlags::FD) != 0;
+                message.brs = (frame.flags & TraceFlags::BRS) != 0;
+                message.esi = (frame.flags & TraceFlags::ESI) != 0;
+                message.data.assign(frame.data, frame.data + frame.length);
+                if (!passes(config.filters, message)) {
+                    current.framesFiltered++;
+                    continue;
+                }
+
+                if (paced) {
+                    auto offset = std::chrono::nanoseconds(
+                        static_cast<int64_t>(static_cast<double>(frame.timestampNs - traceStart) / config.speed));
+                    auto due = passStart + std::chrono::duration_cast<Clock::duration>(offset);
+                    Clock::time_point now = Clock::now();
+                    while (now < due && !stopRequested.load(std::memory_order_relaxed)) {
+                        now = timing.sleepUntil(std::min<Clock::time_point>(due, now + MAX_WAIT_SLICE));
+                    }
+                    auto late = std::chrono::duration_cast<std::chrono::microseconds>(now - due);
+                    current.maxLateness = std::max(current.maxLateness, late);
+                }
+
+                message.timestamp = config.originalTimestamps
+                    ? std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                          std::chrono::nanoseconds(frame.timestampNs)))
+                    : std::chrono::system_clock::now();
+                can.injectMessage(message);
+                passFrames++;
+
+                if (++current.framesReplayed % STATS_INTERVAL == 0) {
+                    current.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - replayStart);
+                    publish(current);
+                }
+            }
+
+            if (!stopRequested) {
+                current.loops++;
+            }
+        } while (config.loop && passFrames > 0 && !stopRequested);
+
+        current.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - replayStart);
+        publish(current);
+        return current.framesReplayed;
+    }
+};
+
+TraceReplayer::TraceReplayer() : pImpl(std::make_unique<Impl>()) {}
+
+TraceReplayer::~TraceReplayer() {
+    close();
+}
+
+bool TraceReplayer::open(const std::string& path) {
+    close();
+    return pImpl->reader.open(path);
+}
+
+void TraceReplayer::close() {
+    stop();
+    pImpl->reader.close();
+}
+
+bool TraceReplayer::isOpen() const {
+    return pImpl->reader.isOpen();
+}
+
+bool TraceReplayer::start(std::shared_ptr<protocols::CANProtocol> canProtocol, const TraceReplayConfig& config) {
+    auto logger = Logger::getInstance();
+    if (!isOpen() || !canProtocol || !canProtocol->isInitialized()) {
+        logger->error("Trace replay needs an open trace and an initialized CAN protocol");
+        return false;
+    }
+    stop();
+
+    logger->info("Replaying " + pImpl->reader.toString() + ": " + config.toString());
+    pImpl->canProtocol = std::move(canProtocol);
+    pImpl->stopRequested = false;
+    pImpl->running = true;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->doneMutex);
+        pImpl->finished = false;
+    }
+    pImpl->worker = std::thread([this, config] {
+        pImpl->replay(*pImpl->canProtocol, config);
+        pImpl->running = false;
+        std::lock_guard<std::mutex> lock(pImpl->doneMutex);
+        pImpl->finished = true;
+        pImpl->doneCondition.notify_all();
+    });
+    return true;
+}
+
+void TraceReplayer::stop() {
+    pImpl->stopRequested = true;
+    if (pImpl->worker.joinable()) {
+        pImpl->worker.join();
+    }
+    pImpl->canProtocol.reset();
+}
+
+bool TraceReplayer::isRunning() const {
+    return pImpl->running;
+}
+
+bool TraceReplayer::waitForCompletion(uint32_t timeout) {
+    std::unique_lock<std::mutex> lock(pImpl->doneMutex);
+    return pImpl->doneCondition.wait_for(lock, std::chrono::milliseconds(timeout), [this] { return pImpl->finished; });
+}
+
+uint64_t TraceReplayer::run(protocols::CANProtocol& canProtocol, const TraceReplayConfig& config) {
+    if (!isOpen() || pImpl->running || !canProtocol.isInitialized()) {
+        return 0;
+    }
+    pImpl->stopRequested = false;
+    return pImpl->replay(canProtocol, config);
+}
+
+TraceReplayer::Statistics TraceReplayer::getStatistics() const {
+    std::lock_guard<std::mutex> lock(pImpl->statsMutex);
+    return pImpl->stats;
+}
+
+std::string TraceReplayer::toString() const {
+    auto stats = getStatistics();
+    std::ostringstream ss;
+    ss << "TraceReplayer[" << pImpl->reader.toString()
+       << ", Replayed:" << stats.framesReplayed
+       << ", Loops:" << stats.loops
+       << ", Running:" << (isRunning() ? "Yes" : "No") << "]";
+    return ss.str();
+}
+
+} // namespace trace
+} // namespace fmus
@@ -0,0 +1,744 @@
+#include <fmus/trace/trigger_capture.h>
+#include <fmus/trace/trace_recorder.h>
+#include <fmus/diagnostics/uds.h>
+#include <fmus/thread_pool.h>
+#include <fmus/logger.h>
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <future>
+#include <limits>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+namespace fmus {
+namespace trace {
+
+namespace {
+
+constexpr size_t MAX_PAYLOAD = 64;
+constexpr size_t CAN_FRAME_SIZE = 8;
+constexpr uint64_t COPY_CHUNK = 4096;                       // Entries copied per lock hold while freezing
+constexpr auto IDLE_WAKE = std::chrono::milliseconds(1000);
+constexpr auto IDLE_POLL = std::chrono::milliseconds(10);
+constexpr uint64_t CAPTURE_SEGMENT_SIZE = 4ULL << 20;
+
+constexpr uint8_t NEGATIVE_RESPONSE_SID = 0x7F;
+constexpr uint16_t STANDARD_RESPONSE_BASE = 0x7E8;
+constexpr uint16_t STANDARD_RESPONSE_LAST = 0x7EF;
+constexpr uint32_t J1939_PRIORITY_PF_MASK = 0x1FFF0000;
+constexpr uint32_t NORMAL_FIXED_PHYSICAL = 0x18DA0000;
+constexpr uint8_t FIRST_TESTER_ADDRESS = 0xF0;
+
+struct FrameSlot {
+    int64_t timestampNs;
+    uint32_t id;
+    uint8_t flags;
+    uint8_t length;
+    uint8_t data[MAX_PAYLOAD];
+};
+
+struct SampleSlot {
+    int64_t timestampNs;
+    uint32_t parameter;
+    double value;
+};
+
+/**
+ * Window copied out of the rings, owned by the write task
+ */
+struct Snapshot {
+    CaptureInfo info;
+    std::vector<FrameSlot> frames;
+    std::vector<SampleSlot> samples;
+    std::vector<std::string> parameters;
+};
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int64_t toNanoseconds(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+bool isDiagnosticResponseId(uint32_t id, bool extended) {
+    if (!extended) {
+        return id >= STANDARD_RESPONSE_BASE && id <= STANDARD_RESPONSE_LAST;
+    }
+    return (id & J1939_PRIORITY_PF_MASK) == NORMAL_FIXED_PHYSICAL &&
+           static_cast<uint8_t>(id >> 8) >= FIRST_TESTER_ADDRESS;
+}
+
+} // anonymous namespace
+
+std::string TriggerCaptureConfig::toString() const {
+    std::ostringstream ss;
+    ss << "TriggerCaptureConfig[Pre:" << preTrigger.count() << "ms"
+       << ", Post:" << postTrigger.count() << "ms"
+       << ", Frames:" << frameCapacity
+       << ", Samples:" << sampleCapacity
+       << ", NRC:" << (nrcTrigger ? "Yes" : "No")
+       << ", Thresholds:" << thresholds.size()
+       << ", Directory:" << directory << "]";
+    return ss.str();
+}
+
+std::string CaptureInfo::toString() const {
+    std::ostringstream ss;
+    ss << "CaptureInfo[" << captureTriggerToString(trigger) << ": " << reason
+       << ", Window:" << (windowEndNs - windowStartNs) / 1000000 << "ms"
+       << ", Frames:" << frames
+       << ", Samples:" << samples;
+    if (retriggers) {
+        ss << ", Retriggers:" << retriggers;
+    }
+    if (truncated) {
+        ss << ", Truncated";
+    }
+    ss << ", " << (success ? tracePath : "Failed") << "]";
+    return ss.str();
+}
+
+// TriggerCapture implementation
+class TriggerCapture::Impl {
+public:
+    TriggerCaptureConfig config;
+    std::atomic<bool> running{false};
+
+    // Rings and everything fed from the capture path, guarded by ringMutex
+    mutable std::mutex ringMutex;
+    std::unique_ptr<FrameSlot[]> frames;
+    uint64_t frameMask = 0;
+    uint64_t frameHead = 0;
+    uint64_t frameDisorder = 0;                 ///< Position of the last entry older than the one before it
+    std::unique_ptr<SampleSlot[]> samples;
+    uint64_t sampleMask = 0;
+    uint64_t sampleHead = 0;
+    uint64_t sampleDisorder = 0;
+    std::vector<std::string> parameters;
+    std::unordered_map<std::string, uint32_t> parameterIndex;
+    std::vector<double> lastValues;
+    std::set<std::string> activeDTCs;
+
+    // Armed window
+    bool armed = false;
+    CaptureInfo armedInfo;
+    int64_t deadlineNs = 0;
+    uint32_t captureNumber = 0;
+
+    // Freezer thread, shares ringMutex
+    std::thread worker;
+    std::condition_variable workerCondition;
+    bool stopWorker = false;
+
+    // Writes in flight on the thread pool
+    std::mutex writeMutex;
+    std::condition_variable writeCondition;
+    std::vector<std::future<void>> writes;
+    std::atomic<uint32_t> pendingWrites{0};
+
+    std::mutex callbackMutex;
+    CaptureCallback callback;
+
+    std::shared_ptr<protocols::CANProtocol> canProtocol;
+    uint32_t listenerId = 0;
+    std::shared_ptr<LiveDataStore> liveStore;
+    std::vector<uint64_t> liveSequences;
+    int64_t liveOffsetNs = 0;                   ///< Adds to LiveDataStore steady microseconds * 1000
+
+    std::atomic<uint64_t> framesCaptured{0};
+    std::atomic<uint64_t> samplesCaptured{0};
+    std::atomic<uint64_t> triggers{0};
+    std::atomic<uint64_t> triggersIgnored{0};
+    std::atomic<uint64_t> capturesWritten{0};
+    std::atomic<uint64_t> captureFailures{0};
+    std::atomic<uint64_t> framesLost{0};
+    std::chrono::system_clock::time_point startTime;
+
+    Impl() {
+        startTime = std::chrono::system_clock::now();
+    }
+
+    bool arm(CaptureTrigger trigger, const std::string& reason, int64_t timeNs) {
+        if (!running) {
+            return false;
+        }
+        if (armed) {
+            armedInfo.retriggers++;
+            return true;
+        }
+        if (pendingWrites.load() >= config.maxPendingWrites) {
+            triggersIgnored++;
+            Logger::getInstance()->warning("Capture trigger ignored, windows still being written: " + reason);
+            return false;
+        }
+
+        armedInfo = CaptureInfo();
+        armedInfo.trigger = trigger;
+        armedInfo.reason = reason;
+        armedInfo.triggerTimeNs = timeNs;
+        armedInfo.windowStartNs = timeNs - std::chrono::duration_cast<std::chrono::nanoseconds>(config.preTrigger).count();
+        armedInfo.windowEndNs = timeNs + std::chrono::duration_cast<std::chrono::nanoseconds>(config.postTrigger).count();
+        deadlineNs = armedInfo.windowEndNs;
+        armed = true;
+        triggers++;
+        Logger::getInstance()->info("Capture triggered by " + captureTriggerToString(trigger) + ": " + reason);
+        workerCondition.notify_one();
+        return true;
+    }
+
+    void checkNrc(const protocols::CANMessage& message, int64_t timeNs) {
+        // Single frame "7F <service> <nrc>", with or without the CAN FD escape
+        const auto& d = message.data;
+        if (d.empty() || (d[0] & 0xF0) != 0 || !isDiagnosticResponseId(message.id, message.extended)) {
+            return;
+        }
+        size_t length = d[0] & 0x0F;
+        size_t offset = 1;
+        if (length == 0 && d.size() > CAN_FRAME_SIZE) {
+            length = d[1];
+            offset = 2;
+        }
+        if (length < 3 || length + offset > d.size() || d[offset] != NEGATIVE_RESPONSE_SID) {
+            return;
+        }
+        const uint8_t nrc = d[offset + 2];
+        if (std::find(config.ignoredNrcs.begin(), config.ignoredNrcs.end(), nrc) != config.ignoredNrcs.end()) {
+            return;
+        }
+        arm(CaptureTrigger::NRC,
+            diagnostics::udsNegativeResponseToString(static_cast<diagnostics::UDSNegativeResponse>(nrc)) + " to " +
+                diagnostics::udsServiceToString(static_cast<diagnostics::UDSService>(d[offset + 1])) + " from " +
+                protocols::canIdToString(message.id, message.extended),
+            timeNs);
+    }
+
+    void addFrame(const protocols::CANMessage& message) {
+        if (!running) {
+            return;
+        }
+        int64_t timeNs = toNanoseconds(message.timestamp);
+        if (timeNs == 0) {
+            timeNs = nowNs();
+        }
+
+        std::lock_guard<std::mutex> lock(ringMutex);
+        if (frameHead > 0 && timeNs < frames[(frameHead - 1) & frameMask].timestampNs) {
+            frameDisorder = frameHead;
+        }
+        FrameSlot& slot = frames[frameHead & frameMask];
+        slot.timestampNs = timeNs;
+        slot.id = message.id;
+        slot.flags = traceFlagsFromMessage(message);
+        slot.length = static_cast<uint8_t>(std::min(message.data.size(), MAX_PAYLOAD));
+        std::memcpy(slot.data, message.data.data(), slot.length);
+        frameHead++;
+        framesCaptured.fetch_add(1, std::memory_order_relaxed);
+
+        if (config.nrcTrigger) {
+            checkNrc(message, timeNs);
+        }
+    }
+
+    uint32_t internParameter(const std::string& name) {
+        auto it = parameterIndex.find(name);
+        if (it != parameterIndex.end()) {
+            return it->second;
+        }
+        uint32_t index = static_cast<uint32_t>(parameters.size());
+        parameters.push_back(name);
+        parameterIndex.emplace(name, index);
+        lastValues.push_back(std::numeric_limits<double>::quiet_NaN());
+        return index;
+    }
+
+    void addSampleLocked(const std::string& name, double value, int64_t timeNs) {
+        uint32_t parameter = internParameter(name);
+        if (sampleHead > 0 && timeNs < samples[(sampleHead - 1) & sampleMask].timestampNs) {
+            sampleDisorder = sampleHead;
+        }
+        SampleSlot& slot = samples[sampleHead & sampleMask];
+        slot.timestampNs = timeNs;
+        slot.parameter = parameter;
+        slot.value = value;
+        sampleHead++;
+        samplesCaptured.fetch_add(1, std::memory_order_relaxed);
+
+        double previous = lastValues[parameter];
+        lastValues[parameter] = value;
+        if (std::isnan(previous)) {
+            return;
+        }
+        for (const auto& threshold : config.thresholds) {
+            if (threshold.parameter != name) {
+                continue;
+            }
+            bool rising = previous < threshold.level && value >= threshold.level;
+            bool falling = previous > threshold.level && value <= threshold.level;
+            if ((rising && threshold.edge != CaptureThreshold::Edge::FALLING) ||
+                (falling && threshold.edge != CaptureThreshold::Edge::RISING)) {
+                std::ostringstream reason;
+                reason << name << (rising ? " rose to " : " fell to ") << value << " (threshold " << threshold.level << ")";
+                arm(CaptureTrigger::THRESHOLD, reason.str(), timeNs);
+            }
+        }
+    }
+
+    /**
+     * Pull new samples from the attached store; called with ringMutex held
+     */
+    void pollLiveData() {
+        if (!liveStore) {
+            return;
+        }
+        std::vector<LiveSample> batch;
+        const size_t channels = liveStore->getChannelCount();
+        if (liveSequences.size() < channels) {
+            liveSequences.resize(channels, 0);
+        }
+        for (size_t id = 0; id < channels; ++id) {
+            batch.clear();
+            auto channel = static_cast<LiveDataStore::ChannelId>(id);
+            liveSequences[id] = liveStore->readHistory(channel, liveSequences[id], batch);
+            if (batch.empty()) {
+                continue;
+            }
+            const std::string name = liveStore->getChannelName(channel);
+            for (const auto& sample : batch) {
+                addSampleLocked(name, sample.value, sample.timestampUs * 1000 + liveOffsetNs);
+            }
+        }
+    }
+
+    /**
+     * Copy ring entries from the first one at or after startNs up to endNs,
+     * a chunk per lock hold so capture is never blocked for long
+     *
+     * The start is found by binary search while the ring is in time order.
+     * Once an entry older than its predecessor is still in the ring
+     * (injected or replayed frames, live channels polled one after another)
+     * the whole ring is scanned and entries outside the window are skipped.
+     */
+    template<typename Slot>
+    void copyWindow(std::unique_lock<std::mutex>& lock, const Slot* ring, uint64_t mask, const uint64_t& head,
+                    const uint64_t& disorder, int64_t startNs, int64_t endNs, std::vector<Slot>& out,
+                    bool& truncated, bool countLost) {
+        const uint64_t capacity = mask + 1;
+        uint64_t oldest = head > capacity ? head - capacity : 0;
+        const bool ordered = disorder <= oldest;
+        uint64_t low = oldest;
+        uint64_t high = ordered ? head : oldest;
+        while (low < high) {
+            uint64_t mid = low + (high - low) / 2;
+            if (ring[mid & mask].timestampNs < startNs) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        if (ordered && oldest > 0 && low == oldest) {
+            truncated = true;
+        }
+        bool reachedStart = ordered || oldest == 0;
+
+        uint64_t next = low;
+        while (next < head) {
+            oldest = head > capacity ? head - capacity : 0;
+            if (next < oldest) {
+                // The writer lapped the copy; the window has a hole
+                if (countLost) {
+                    framesLost += oldest - next;
+                }
+                truncated = true;
+                next = oldest;
+            }
+            uint64_t end = std::min(head, next + COPY_CHUNK);
+            for (; next < end; ++next) {
+                const Slot& slot = ring[next & mask];
+                if (slot.timestampNs < startNs) {
+                    reachedStart = true;
+                    continue;
+                }
+                if (slot.timestampNs > endNs) {
+                    if (ordered) {
+                        return;
+                    }
+                    continue;
+                }
+                out.push_back(slot);
+            }
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+        }
+        if (!reachedStart) {
+            truncated = true;
+        }
+    }
+
+    void freeze(std::unique_lock<std::mutex>& lock) {
+        auto snapshot = std::make_shared<Snapshot>();
+        snapshot->info = armedInfo;
+        armed = false;
+        pendingWrites++;
+
+        CaptureInfo& info = snapshot->info;
+        info.windowEndNs = std::min(info.windowEndNs, nowNs());
+        pollLiveData();
+        copyWindow(lock, frames.get(), frameMask, frameHead, frameDisorder, info.windowStartNs, info.windowEndNs,
+                   snapshot->frames, info.truncated, true);
+        copyWindow(lock, samples.get(), sampleMask, sampleHead, sampleDisorder, info.windowStartNs,
+                   info.windowEndNs, snapshot->samples, info.truncated, false);
+        snapshot->parameters = parameters;
+        info.frames = snapshot->frames.size();
+        info.samples = snapshot->samples.size();
+
+        char stamp[32];
+        std::time_t seconds = static_cast<std::time_t>(info.triggerTimeNs / 1000000000);
+        std::tm local{};
+        localtime_r(&seconds, &local);
+        std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &local);
+        std::string base = config.directory + "/" + config.prefix + "_" + stamp + "_" + std::to_string(++captureNumber);
+        info.tracePath = base + ".trc";
+        info.samplesPath = base + ".csv";
+
+        lock.unlock();
+        auto task = getGlobalThreadPool()->enqueue([this, snapshot] { write(*snapshot); });
+        {
+            std::lock_guard<std::mutex> writeLock(writeMutex);
+            writes.erase(std::remove_if(writes.begin(), writes.end(),
+                                        [](const std::future<void>& f) {
+                                            return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+                                        }),
+                         writes.end());
+            writes.push_back(std::move(task));
+        }
+        lock.lock();
+    }
+
+    void write(Snapshot& snapshot) {
+        CaptureInfo& info = snapshot.info;
+        info.success = writeTrace(snapshot) && writeSamples(snapshot);
+        if (info.success) {
+            capturesWritten++;
+            Logger::getInstance()->info("Capture written: " + info.toString());
+        } else {
+            captureFailures++;
+            Logger::getInstance()->error("Failed to write capture " + info.tracePath);
+        }
+        {
+            std::lock_guard<std::mutex> lock(callbackMutex);
+            if (callback) {
+                callback(info);
+            }
+        }
+        std::lock_guard<std::mutex> lock(writeMutex);
+        pendingWrites--;
+        writeCondition.notify_all();
+    }
+
+    static bool writeTrace(const Snapshot& snapshot) {
+        TraceRecorderConfig recorderConfig;
+        recorderConfig.segmentSize = CAPTURE_SEGMENT_SIZE;
+        recorderConfig.segmentsAhead = 1;
+        TraceRecorder recorder;
+        if (!recorder.open(snapshot.info.tracePath, recorderConfig)) {
+            return false;
+        }
+        protocols::CANMessage message;
+        for (const auto& slot : snapshot.frames) {
+            message.id = slot.id;
+            message.extended = (slot.flags & TraceFlags::EXTENDED) != 0;
+            message.rtr = (slot.flags & TraceFlags::RTR) != 0;
+            message.fd = (slot.flags & TraceFlags::FD) != 0;
+            message.brs = (slot.flags & TraceFlags::BRS) != 0;
+            message.esi = (slot.flags & TraceFlags::ESI) != 0;
+            message.data.assign(slot.data, slot.data + slot.length);
+            message.timestamp = std::chrono::system_clock::time_point(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(slot.timestampNs)));
+            recorder.record(message);
+        }
+        bool complete = recorder.getStatistics().framesDropped == 0;
+        recorder.close();
+        return complete;
+    }
+
+    static bool writeSamples(const Snapshot& snapshot) {
+        FILE* out = std::fopen(snapshot.info.samplesPath.c_str(), "w");
+        if (!out) {
+            return false;
+        }
+        std::fprintf(out, "timestamp_ns,parameter,value\n");
+        for (const auto& slot : snapshot.samples) {
+            std::fprintf(out, "%" PRId64 ",%s,%.9g\n", slot.timestampNs,
+                         snapshot.parameters[slot.parameter].c_str(), slot.value);
+        }
+        bool ok = std::ferror(out) == 0;
+        std::fclose(out);
+        return ok;
+    }
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(ringMutex);
+        auto nextPoll = std::chrono::system_clock::now();
+        const auto pollInterval = std::chrono::milliseconds(std::max<uint32_t>(1, config.livePollInterval));
+        while (!stopWorker) {
+            auto wake = std::chrono::system_clock::now() + IDLE_WAKE;
+            if (liveStore) {
+                wake = std::min(wake, nextPoll);
+            }
+            if (armed) {
+                wake = std::min(wake, std::chrono::system_clock::time_point(
+                                          std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                                              std::chrono::nanoseconds(deadlineNs))));
+            }
+            workerCondition.wait_until(lock, wake);
+            if (stopWorker) {
+                break;
+            }
+
+            if (liveStore && std::chrono::system_clock::now() >= nextPoll) {
+                pollLiveData();
+                nextPoll = std::chrono::system_clock::now() + pollInterval;
+            }
+            if (armed && nowNs() >= deadlineNs) {
+                freeze(lock);
+            }
+        }
+        if (armed) {
+            freeze(lock);
+        }
+    }
+};
+
+TriggerCapture::TriggerCapture() : pImpl(std::make_unique<Impl>()) {}
+
+TriggerCapture::~TriggerCapture() {
+    stop();
+}
+
+bool TriggerCapture::start(const TriggerCaptureConfig& config) {
+    auto logger = Logger::getInstance();
+    if (pImpl->running) {
+        logger->error("Trigger capture is already running");
+        return false;
+    }
+    if (config.frameCapacity == 0 || config.sampleCapacity == 0 || config.maxPendingWrites == 0) {
+        logger->error("Trigger capture needs non-zero ring capacities and pending writes");
+        return false;
+    }
+
+    pImpl->config = config;
+    const size_t frameCapacity = roundUpToPowerOfTwo(config.frameCapacity);
+    const size_t sampleCapacity = roundUpToPowerOfTwo(config.sampleCapacity);
+    pImpl->frames.reset(new FrameSlot[frameCapacity]);
+    pImpl->frameMask = frameCapacity - 1;
+    pImpl->frameHead = 0;
+    pImpl->frameDisorder = 0;
+    pImpl->samples.reset(new SampleSlot[sampleCapacity]);
+    pImpl->sampleMask = sampleCapacity - 1;
+    pImpl->sampleHead = 0;
+    pImpl->sampleDisorder = 0;
+    pImpl->parameters.clear();
+    pImpl->parameterIndex.clear();
+    pImpl->lastValues.clear();
+    pImpl->activeDTCs.clear();
+    pImpl->armed = false;
+    pImpl->stopWorker = false;
+    pImpl->startTime = std::chrono::system_clock::now();
+    pImpl->running = true;
+    pImpl->worker = std::thread([impl = pImpl.get()] { impl->workerLoop(); });
+
+    logger->info("Trigger capture started: " + config.toString());
+    return true;
+}
+
+void TriggerCapture::stop() {
+    if (!pImpl->running) {
+        return;
+    }
+    detach();
+    {
+        std::lock_guard<std::mutex> lock(pImpl->ringMutex);
+        pImpl->stopWorker = true;
+    }
+    pImpl->workerCondition.notify_one();
+    if (pImpl->worker.joinable()) {
+        pImpl->worker.join();
+    }
+    pImpl->running = false;
+
+    std::vector<std::future<void>> writes;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->writeMutex);
+        writes.swap(pImpl->writes);
+    }
+    for (auto& write : writes) {
+        write.wait();
+    }
+    Logger::getInstance()->info("Trigger capture stopped: " + toString());
+}
+
+bool TriggerCapture::isRunning() const {
+    return pImpl->running;
+}
+
+bool TriggerCapture::attach(std::shared_ptr<protocols::CANProtocol> canProtocol) {
+    if (!isRunning() || !canProtocol) {
+        return false;
+    }
+    if (pImpl->canProtocol) {
+        pImpl->canProtocol->removeListener(pImpl->listenerId);
+    }
+    pImpl->listenerId = canProtocol->addListener([impl = pImpl.get()](const protocols::CANMessage& message) {
+        impl->addFrame(message);
+    });
+    if (!pImpl->listenerId) {
+        pImpl->canProtocol.reset();
+        return false;
+    }
+    pImpl->canProtocol = std::move(canProtocol);
+    return true;
+}
+
+bool TriggerCapture::attach(std::shared_ptr<LiveDataStore> store) {
+    if (!isRunning() || !store) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(pImpl->ringMutex);
+    // Only samples published from now on; the store's steady clock is mapped onto system time
+    pImpl->liveSequences.assign(store->getChannelCount(), 0);
+    for (size_t id = 0; id < pImpl->liveSequences.size(); ++id) {
+        pImpl->liveSequences[id] = store->getSequence(static_cast<LiveDataStore::ChannelId>(id));
+    }
+    pImpl->liveOffsetNs = nowNs() - LiveDataStore::now() * 1000;
+    pImpl->liveStore = std::move(store);
+    pImpl->workerCondition.notify_one();
+    return true;
+}
+
+void TriggerCapture::detach() {
+    if (pImpl->canProtocol) {
+        pImpl->canProtocol->removeListener(pImpl->listenerId);
+        pImpl->canProtocol.reset();
+        pImpl->listenerId = 0;
+    }
+    std::lock_guard<std::mutex> lock(pImpl->ringMutex);
+    pImpl->liveStore.reset();
+}
+
+void TriggerCapture::addFrame(const protocols::CANMessage& message) {
+    pImpl->addFrame(message);
+}
+
+void TriggerCapture::addSample(const std::string& parameter, double value) {
+    addSample(parameter, value, nowNs());
+}
+
+void TriggerCapture::addSample(const std::string& parameter, double value, int64_t timestampNs) {
+    if (!isRunning()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(pImpl->ringMutex);
+    pImpl->addSampleLocked(parameter, value, timestampNs);
+}
+
+void TriggerCapture::reportDTC(const std::string& code, uint8_t status) {
+    if (!isRunning()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(pImpl->ringMutex);
+    if (!(status & pImpl->config.dtcStatusMask)) {
+        pImpl->activeDTCs.erase(code);
+        return;
+    }
+    if (pImpl->activeDTCs.insert(code).second) {
+        char reason[64];
+        std::snprintf(reason, sizeof(reason), "%s status 0x%02X", code.c_str(), status);
+        pImpl->arm(CaptureTrigger::DTC, reason, nowNs());
+    }
+}
+
+bool TriggerCapture::trigger(const std::string& reason) {
+    std::lock_guard<std::mutex> lock(pImpl->ringMutex);
+    return pImpl->arm(CaptureTrigger::MANUAL, reason, nowNs());
+}
+
+void TriggerCapture::setCaptureCallback(CaptureCallback callback) {
+    std::lock_guard<std::mutex> lock(pImpl->callbackMutex);
+    pImpl->callback = std::move(callback);
+}
+
+bool TriggerCapture::waitForIdle(uint32_t timeout) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(pImpl->ringMutex);
+            if (!pImpl->armed && pImpl->pendingWrites == 0) {
+                return true;
+            }
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        // An armed window is not signalled, so poll as well
+        std::unique_lock<std::mutex> lock(pImpl->writeMutex);
+        pImpl->writeCondition.wait_for(lock, IDLE_POLL);
+    }
+}
+
+TriggerCapture::Statistics TriggerCapture::getStatistics() const {
+    Statistics stats;
+    stats.framesCaptured = pImpl->framesCaptured;
+    stats.samplesCaptured = pImpl->samplesCaptured;
+    stats.triggers = pImpl->triggers;
+    stats.triggersIgnored = pImpl->triggersIgnored;
+    stats.capturesWritten = pImpl->capturesWritten;
+    stats.captureFailures = pImpl->captureFailures;
+    stats.framesLost = pImpl->framesLost;
+    stats.startTime = pImpl->startTime;
+    return stats;
+}
+
+std::string TriggerCapture::toString() const {
+    auto stats = getStatistics();
+    std::ostringstream ss;
+    ss << "TriggerCapture[Frames:" << stats.framesCaptured
+       << ", Samples:" << stats.samplesCaptured
+       << ", Triggers:" << stats.triggers
+       << ", Written:" << stats.capturesWritten
+       << ", Running:" << (isRunning() ? "Yes" : "No") << "]";
+    return ss.str();
+}
+
+// Utility functions
+std::string captureTriggerToString(CaptureTrigger trigger) {
+    switch (trigger) {
+        case CaptureTrigger::MANUAL: return "Manual";
+        case CaptureTrigger::DTC: return "DTC";
+        case CaptureTrigger::THRESHOLD: return "Threshold";
+        case CaptureTrigger::NRC: return "NRC";
+        default: return "Unknown";
+    }
+}
+
+} // namespace trace
+} // namespace fmus
@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+#include <fmus/protocols/bus_statistics.h>
+#include <fmus/protocols/can.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace fmus::protocols;
+
+namespace {
+
+// CRC delimiter, ACK slot and delimiter, EOF and interframe space
+constexpr uint32_t TRAILER = 13;
+
+/**
+ * Reference classic frame: SOF through CRC as a bit vector, stuffed the textbook way
+ */
+class ClassicFrame {
+public:
+    explicit ClassicFrame(const CANMessage& message) {
+        put(0, 1);
+        if (message.extended) {
+            put(message.id >> 18, 11);
+            put(0b11, 2);                               // SRR, IDE
+            put(message.id & 0x3FFFF, 18);
+            put(message.rtr ? 1 : 0, 1);
+            put(0, 2);                                  // r1, r0
+        } else {
+            put(message.id, 11);
+            put(message.rtr ? 1 : 0, 1);
+            put(0, 2);                                  // IDE, r0
+        }
+        put(static_cast<uint32_t>(message.data.size()), 4);
+        if (!message.rtr) {
+            for (uint8_t byte : message.data) {
+                put(byte, 8);
+            }
+        }
+
+        uint32_t crc = 0;
+        for (int bit : bits) {
+            bool feedback = bit != static_cast<int>((crc >> 14) & 1);
+            crc = (crc << 1) & 0x7FFF;
+            if (feedback) {
+                crc ^= 0x4599;
+            }
+        }
+        put(crc, 15);
+    }
+
+    size_t size() const {
+        return bits.size();
+    }
+
+    /**
+     * Insert a complement bit after every five equal bits, stuff bits included
+     */
+    uint32_t stuffBits() const {
+        uint32_t stuffed = 0;
+        int last = -1;
+        int run = 0;
+        for (int bit : bits) {
+            run = bit == last ? run + 1 : 1;
+            last = bit;
+            if (run == 5) {
+                ++stuffed;
+                last = !bit;
+                run = 1;
+            }
+        }
+        return stuffed;
+    }
+
+private:
+    void put(uint32_t value, unsigned count) {
+        while (count-- > 0) {
+            bits.push_back((value >> count) & 1);
+        }
+    }
+
+    std::vector<int> bits;
+};
+
+CANMessage fdFrame(size_t length, bool brs, bool extended = false) {
+    CANMessage message(extended ? 0x18DAF110 : 0x7E8, std::vector<uint8_t>(length, 0x55), extended);
+    message.fd = true;
+    message.brs = brs;
+    return message;
+}
+
+} // anonymous namespace
+
+TEST(CANFrameBitsTest, ClassicFrameWithoutStuffing) {
+    CANMessage standard(0x123, std::vector<uint8_t>(8, 0xAA));
+    CANFrameBits bits = canFrameBits(standard, StuffingModel::NONE);
+    EXPECT_EQ(bits.nominalBits, 34u + 64 + TRAILER);
+    EXPECT_EQ(bits.dataBits, 0u);
+    EXPECT_EQ(bits.stuffBits, 0u);
+
+    CANMessage extended(0x18DAF110, std::vector<uint8_t>(2, 0xAA), true);
+    EXPECT_EQ(canFrameBits(extended, StuffingModel::NONE).nominalBits, 54u + 16 + TRAILER);
+
+    // A remote frame carries a DLC but no data field
+    CANMessage remote(0x123, std::vector<uint8_t>(8, 0));
+    remote.rtr = true;
+    EXPECT_EQ(canFrameBits(remote, StuffingModel::NONE).nominalBits, 34u + TRAILER);
+}
+
+TEST(CANFrameBitsTest, ClassicWorstCase) {
+    CANMessage standard(0x7FF, std::vector<uint8_t>(8, 0xFF));
+    CANFrameBits bits = canFrameBits(standard, StuffingModel::WORST_CASE);
+    EXPECT_EQ(bits.stuffBits, 24u);
+    EXPECT_EQ(bits.nominalBits, 135u);
+
+    CANMessage extended(0x1FFFFFFF, std::vector<uint8_t>(8, 0xFF), true);
+    bits = canFrameBits(extended, StuffingModel::WORST_CASE);
+    EXPECT_EQ(bits.stuffBits, 29u);
+    EXPECT_EQ(bits.nominalBits, 160u);
+
+    EXPECT_EQ(canFrameBits(CANMessage(0x000, {}), StuffingModel::WORST_CASE).stuffBits, 8u);
+}
+
+TEST(CANFrameBitsTest, ExactStuffingMatchesReferenceFrames) {
+    const std::vector<CANMessage> frames = {
+        CANMessage(0x000, std::vector<uint8_t>(8, 0x00)),
+        CANMessage(0x7FF, std::vector<uint8_t>(8, 0xFF)),
+        CANMessage(0x7DF, {0x02, 0x01, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00}),
+        CANMessage(0x7E8, {0x04, 0x41, 0x0C, 0x1A, 0xF8, 0xCC, 0xCC, 0xCC}),
+        CANMessage(0x18DAF110, {0x03, 0x22, 0xF1, 0x90}, true),
+        CANMessage(0x0CF00400, {0xF0, 0x7D, 0x7D, 0x00, 0x00, 0x00, 0xF0, 0x7D}, true),
+        CANMessage(0x555, std::vector<uint8_t>(8, 0x55)),
+        CANMessage(0x0F0, {0x0F, 0x0F, 0x0F, 0x0F}),
+    };
+    for (const auto& frame : frames) {
+        ClassicFrame reference(frame);
+        CANFrameBits bits = canFrameBits(frame, StuffingModel::EXACT);
+        EXPECT_EQ(bits.stuffBits, reference.stuffBits()) << frame.toString();
+        EXPECT_EQ(bits.nominalBits, reference.size() + reference.stuffBits() + TRAILER) << frame.toString();
+    }
+
+    // 0 01111001011 11 100100011010101000 0 00 0000 CRC 101000001100101: four runs of five
+    CANFrameBits bits = canFrameBits(CANMessage(0x0F2E46A8, {}, true));
+    EXPECT_EQ(bits.stuffBits, 4u);
+    EXPECT_EQ(bits.nominalBits, 54u + 4 + TRAILER);
+}
+
+TEST(CANFrameBitsTest, ExactStuffingStaysWithinWorstCase) {
+    std::mt19937 random(1939);
+    for (int i = 0; i < 2000; ++i) {
+        const bool extended = i % 2 == 1;
+        CANMessage frame(random() & (extended ? 0x1FFFFFFF : 0x7FF), std::vector<uint8_t>(random() % 9), extended);
+        for (auto& byte : frame.data) {
+            byte = static_cast<uint8_t>(random());
+        }
+        ClassicFrame reference(frame);
+        CANFrameBits exact = canFrameBits(frame, StuffingModel::EXACT);
+        ASSERT_EQ(exact.stuffBits, reference.stuffBits()) << frame.toString();
+        EXPECT_LE(exact.stuffBits, canFrameBits(frame, StuffingModel::WORST_CASE).stuffBits) << frame.toString();
+    }
+}
+
+TEST(CANFrameBitsTest, FdFieldsAndFixedStuffBits) {
+    // 64 bytes with bit rate switch: 17 arbitration bits, then ESI, DLC, data and a 21-bit CRC
+    CANFrameBits bits = canFrameBits(fdFrame(64, true), StuffingModel::NONE);
+    EXPECT_EQ(bits.nominalBits, 17u + TRAILER);
+    EXPECT_EQ(bits.dataBits, (1u + 4 + 512) + (4 + 21 + 7));
+    EXPECT_EQ(bits.stuffBits, 7u);
+
+    // Up to 16 bytes the CRC is 17 bits with six fixed stuff bits
+    bits = canFrameBits(fdFrame(8, true), StuffingModel::NONE);
+    EXPECT_EQ(bits.dataBits, (1u + 4 + 64) + (4 + 17 + 6));
+    EXPECT_EQ(bits.stuffBits, 6u);
+
+    // Payloads are padded to the next DLC length
+    EXPECT_EQ(canFrameBits(fdFrame(10, true), StuffingModel::NONE).dataBits,
+              canFrameBits(fdFrame(12, true), StuffingModel::NONE).dataBits);
+
+    // Without bit rate switch everything goes at the nominal rate
+    bits = canFrameBits(fdFrame(64, false), StuffingModel::NONE);
+    EXPECT_EQ(bits.dataBits, 0u);
+    EXPECT_EQ(bits.nominalBits, 17u + TRAILER + 517 + 32);
+
+    EXPECT_EQ(canFrameBits(fdFrame(64, true, true), StuffingModel::NONE).nominalBits, 36u + TRAILER);
+}
+
+TEST(CANFrameBitsTest, FdWorstCase) {
+    CANFrameBits bits = canFrameBits(fdFrame(64, true), StuffingModel::WORST_CASE);
+    EXPECT_EQ(bits.nominalBits, 17u + 4 + TRAILER);
+    EXPECT_EQ(bits.dataBits, 517u + 129 + 32);
+    EXPECT_EQ(bits.stuffBits, 4u + 129 + 7);
+
+    CANFrameBits exact = canFrameBits(fdFrame(64, true), StuffingModel::EXACT);
+    EXPECT_LE(exact.stuffBits, bits.stuffBits);
+    EXPECT_GE(exact.stuffBits, 7u);
+}
@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+#include <fmus/protocols/can.h>
+#include <fmus/protocols/transport.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace fmus;
+using namespace fmus::protocols;
+
+namespace {
+
+constexpr uint32_t TESTER_ID = 0x7E0;
+constexpr uint32_t ECU_ID = 0x7E8;
+
+std::vector<uint8_t> pattern(size_t length) {
+    std::vector<uint8_t> data(length);
+    for (size_t i = 0; i < length; ++i) {
+        data[i] = static_cast<uint8_t>(i * 7 + 1);
+    }
+    return data;
+}
+
+/**
+ * Tester and ECU ISO-TP endpoints on one loopback bus; every frame is kept
+ */
+class IsoTpLoopbackTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        CANConfig config;
+        config.fd = true;
+        config.loopback = true;
+        can = std::make_shared<CANProtocol>();
+        ASSERT_TRUE(can->initialize(config));
+        can->addListener([this](const CANMessage& frame) {
+            std::lock_guard<std::mutex> lock(framesMutex);
+            frames.push_back(frame);
+        });
+    }
+
+    void TearDown() override {
+        tester.reset();
+        ecu.reset();
+        can->shutdown();
+    }
+
+    void open(bool canFd) {
+        IsoTpConfig config;
+        config.canFd = canFd;
+        config.txId = TESTER_ID;
+        config.rxId = ECU_ID;
+        tester = std::make_unique<IsoTpTransport>(can, config);
+
+        config.txId = ECU_ID;
+        config.rxId = TESTER_ID;
+        ecu = std::make_unique<IsoTpTransport>(can, config);
+        ecu->setReceiveHandler([this](uint32_t, const uint8_t* data, size_t length) {
+            received.emplace_back(data, data + length);
+        });
+        ASSERT_TRUE(tester->open());
+        ASSERT_TRUE(ecu->open());
+    }
+
+    std::vector<CANMessage> sentBy(uint32_t id) {
+        std::lock_guard<std::mutex> lock(framesMutex);
+        std::vector<CANMessage> result;
+        for (const auto& frame : frames) {
+            if (frame.id == id) {
+                result.push_back(frame);
+            }
+        }
+        return result;
+    }
+
+    std::shared_ptr<CANProtocol> can;
+    std::unique_ptr<IsoTpTransport> tester;
+    std::unique_ptr<IsoTpTransport> ecu;
+    std::vector<std::vector<uint8_t>> received;
+
+    std::mutex framesMutex;
+    std::vector<CANMessage> frames;
+};
+
+} // anonymous namespace
+
+TEST(CanFdTest, DlcMapsToFrameLengths) {
+    const size_t lengths[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+    for (uint8_t dlc = 0; dlc < 16; ++dlc) {
+        EXPECT_EQ(canDlcToLength(dlc), lengths[dlc]) << "DLC " << static_cast<int>(dlc);
+        EXPECT_EQ(canLengthToDlc(lengths[dlc]), dlc);
+    }
+}
+
+TEST(CanFdTest, LengthsRoundUpToNextDlc) {
+    EXPECT_EQ(canLengthToDlc(9), 9);
+    EXPECT_EQ(canLengthToDlc(13), 10);
+    EXPECT_EQ(canLengthToDlc(33), 14);
+    EXPECT_EQ(canLengthToDlc(49), 15);
+    EXPECT_EQ(canLengthToDlc(100), 15);
+
+    EXPECT_EQ(canFdLength(8), 8u);
+    EXPECT_EQ(canFdLength(9), 12u);
+    EXPECT_EQ(canFdLength(21), 24u);
+    EXPECT_EQ(canFdLength(25), 32u);
+    EXPECT_EQ(canFdLength(49), 64u);
+}
+
+TEST(CanFdTest, FrameValidityFollowsDlcLengths) {
+    CANMessage frame(0x123, std::vector<uint8_t>(12));
+    frame.fd = true;
+    EXPECT_TRUE(frame.isValid());
+    frame.data.resize(13);
+    EXPECT_FALSE(frame.isValid());
+    frame.data.resize(64);
+    EXPECT_TRUE(frame.isValid());
+}
+
+TEST_F(IsoTpLoopbackTest, ClassicSingleFrameHasLengthInPci) {
+    open(false);
+    auto payload = pattern(7);
+    ASSERT_TRUE(tester->send(payload.data(), payload.size()));
+
+    auto sent = sentBy(TESTER_ID);
+    ASSERT_EQ(sent.size(), 1u);
+    EXPECT_FALSE(sent[0].fd);
+    ASSERT_EQ(sent[0].data.size(), 8u);
+    EXPECT_EQ(sent[0].data[0], 0x07);
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_EQ(received[0], payload);
+}
+
+TEST_F(IsoTpLoopbackTest, FdSingleFrameEscapesLength) {
+    open(true);
+    auto payload = pattern(62);
+    ASSERT_TRUE(tester->send(payload.data(), payload.size()));
+
+    auto sent = sentBy(TESTER_ID);
+    ASSERT_EQ(sent.size(), 1u);
+    EXPECT_TRUE(sent[0].fd);
+    ASSERT_EQ(sent[0].data.size(), 64u);
+    EXPECT_EQ(sent[0].data[0], 0x00);
+    EXPECT_EQ(sent[0].data[1], 62);
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_EQ(received[0], payload);
+}
+
+TEST_F(IsoTpLoopbackTest, FdSingleFrameIsPaddedToNextDlc) {
+    open(true);
+    auto payload = pattern(10);
+    ASSERT_TRUE(tester->send(payload.data(), payload.size()));
+
+    auto sent = sentBy(TESTER_ID);
+    ASSERT_EQ(sent.size(), 1u);
+    ASSERT_EQ(sent[0].data.size(), 12u);
+    EXPECT_EQ(sent[0].data[0], 0x00);
+    EXPECT_EQ(sent[0].data[1], 10);
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_EQ(received[0], payload);
+}
+
+TEST_F(IsoTpLoopbackTest, FirstFrameUpTo4095HasTwelveBitLength) {
+    open(true);
+    auto payload = pattern(4095);
+    ASSERT_TRUE(tester->send(payload.data(), payload.size()));
+
+    auto sent = sentBy(TESTER_ID);
+    ASSERT_FALSE(sent.empty());
+    EXPECT_EQ(sent[0].data[0], 0x1F);
+    EXPECT_EQ(sent[0].data[1], 0xFF);
+    EXPECT_EQ(sent[0].data[2], payload[0]);
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_EQ(received[0], payload);
+}
+
+TEST_F(IsoTpLoopbackTest, FirstFrameBeyond4095EscapesLength) {
+    open(true);
+    auto payload = pattern(5000);
+    ASSERT_TRUE(tester->send(payload.data(), payload.size()));
+
+    auto sent = sentBy(TESTER_ID);
+    ASSERT_FALSE(sent.empty());
+    const auto& first = sent[0].data;
+    ASSERT_EQ(first.size(), 64u);
+    EXPECT_EQ(first[0], 0x10);
+    EXPECT_EQ(first[1], 0x00);
+    EXPECT_EQ(first[2], 0x00);
+    EXPECT_EQ(first[3], 0x00);
+    EXPECT_EQ(first[4], 0x13);
+    EXPECT_EQ(first[5], 0x88);
+    EXPECT_EQ(first[6], payload[0]);
+
+    // 58 bytes in the first frame, then 63 per consecutive frame
+    EXPECT_EQ(sent.size(), 1u + (5000 - 58 + 62) / 63);
+    EXPECT_EQ(sent[1].data[0], 0x21);
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_EQ(received[0], payload);
+}
+
+TEST_F(IsoTpLoopbackTest, ClassicTransportRejectsPayloadsOver4095) {
+    open(false);
+    auto payload = pattern(4096);
+    EXPECT_FALSE(tester->send(payload.data(), payload.size()));
+    EXPECT_TRUE(sentBy(TESTER_ID).empty());
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <fmus/protocols/dbc.h>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace fmus::protocols;
+
+namespace {
+
+const char* DATABASE = R"(VERSION ""
+
+BU_: ECM TCM
+
+BO_ 256 Intel: 8 ECM
+ SG_ Rpm : 0|16@1+ (0.25,0) [0|16383.75] "rpm" TCM
+ SG_ Nibble : 12|4@1+ (1,0) [0|15] "" TCM
+ SG_ Straddle : 20|10@1+ (1,0) [0|1023] "" TCM
+ SG_ Temp : 32|8@1- (1,-40) [-168|87] "degC" TCM
+ SG_ Wide : 32|32@1+ (1,0) [0|4294967295] "" TCM
+
+BO_ 512 Motorola: 8 ECM
+ SG_ Speed : 7|16@0+ (0.01,0) [0|655.35] "km/h" TCM
+ SG_ Straddle : 12|10@0+ (1,0) [0|1023] "" TCM
+ SG_ Torque : 39|12@0- (0.5,0) [-1024|1023.5] "Nm" TCM
+
+BO_ 2364539904 Muxed: 8 ECM
+ SG_ Page M : 0|8@1+ (1,0) [0|255] "" TCM
+ SG_ Counter m1 : 8|16@1+ (1,0) [0|65535] "" TCM
+ SG_ Delta m2 : 8|8@1- (1,0) [-128|127] "" TCM
+
+BO_ 768 Fd: 64 ECM
+ SG_ IntelSpill : 4|64@1+ (1,0) [0|0] "" TCM
+ SG_ MotorolaSpill : 3|64@0+ (1,0) [0|0] "" TCM
+
+VAL_ 512 Speed 0 "Stopped" ;
+)";
+
+const std::vector<uint8_t> FRAME = {0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0};
+
+class DBCTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(database.loadString(DATABASE));
+    }
+
+    /**
+     * Decode a frame into raw values by signal name
+     */
+    std::map<std::string, DBCSignalValue> decode(uint32_t id, bool extended, const std::vector<uint8_t>& data) {
+        std::vector<DBCSignalValue> values(database.getMaxSignalsPerFrame());
+        size_t count = database.decode(id, extended, data.data(), data.size(), values.data(), values.size());
+        std::map<std::string, DBCSignalValue> byName;
+        for (size_t i = 0; i < count; ++i) {
+            byName[database.getSignal(values[i].signal)->name] = values[i];
+        }
+        return byName;
+    }
+
+    DBCDatabase database;
+};
+
+} // anonymous namespace
+
+TEST_F(DBCTest, ParsesMessagesAndSignals) {
+    ASSERT_EQ(database.getMessages().size(), 4u);
+    const DBCMessage* muxed = database.findMessage(0x0CF00400, true);
+    ASSERT_NE(muxed, nullptr);
+    EXPECT_EQ(muxed->name, "Muxed");
+    EXPECT_EQ(database.findMessage(0x0CF00400, false), nullptr);
+
+    uint32_t speed = database.findSignal("Motorola.Speed");
+    ASSERT_NE(speed, DBCDatabase::INVALID_SIGNAL);
+    const DBCSignal* signal = database.getSignal(speed);
+    EXPECT_FALSE(signal->littleEndian);
+    EXPECT_EQ(signal->unit, "km/h");
+    EXPECT_EQ(signal->valueDescriptions.at(0), "Stopped");
+
+    // Names shared by two messages need the message prefix to be told apart
+    EXPECT_NE(database.findSignal("Intel.Straddle"), database.findSignal("Motorola.Straddle"));
+}
+
+TEST_F(DBCTest, SharedSignalNamesOnlyResolveQualified) {
+    uint32_t intel = database.findSignal("Intel.Straddle");
+    uint32_t motorola = database.findSignal("Motorola.Straddle");
+    ASSERT_NE(intel, DBCDatabase::INVALID_SIGNAL);
+    ASSERT_NE(motorola, DBCDatabase::INVALID_SIGNAL);
+    EXPECT_EQ(database.findSignal("Straddle"), DBCDatabase::INVALID_SIGNAL);
+    EXPECT_EQ(database.findSignal("Speed"), database.findSignal("Motorola.Speed"));
+
+    auto shared = std::make_shared<DBCDatabase>();
+    ASSERT_TRUE(shared->loadString(DATABASE));
+    DBCDecoder decoder(shared);
+    EXPECT_EQ(decoder.subscribe("Straddle", [](const DBCSignalUpdate&) {}), 0u);
+    EXPECT_NE(decoder.subscribe("Motorola.Straddle", [](const DBCSignalUpdate&) {}), 0u);
+}
+
+TEST_F(DBCTest, ExtractsIntelSignals) {
+    auto values = decode(256, false, FRAME);
+    ASSERT_EQ(values.size(), 5u);
+    EXPECT_EQ(values["Rpm"].raw, 0x3412);
+    EXPECT_DOUBLE_EQ(values["Rpm"].value, 3332.5);
+    EXPECT_EQ(values["Nibble"].raw, 0x3);
+    EXPECT_EQ(values["Straddle"].raw, 0x385);          // Bits 20-29 of 0x78563412
+    EXPECT_EQ(values["Temp"].raw, -102);                // 0x9A sign-extended
+    EXPECT_DOUBLE_EQ(values["Temp"].value, -142.0);
+    EXPECT_EQ(values["Wide"].raw, 0xF0DEBC9A);
+}
+
+TEST_F(DBCTest, ExtractsMotorolaSignals) {
+    auto values = decode(512, false, FRAME);
+    ASSERT_EQ(values.size(), 3u);
+    EXPECT_EQ(values["Speed"].raw, 0x1234);
+    EXPECT_DOUBLE_EQ(values["Speed"].value, 46.6);
+    EXPECT_EQ(values["Straddle"].raw, 0x28A);          // Byte 1 bits 4-0, then byte 2 bits 7-3
+    EXPECT_EQ(values["Torque"].raw, 0x9AB - 0x1000);    // Byte 4 and the high nibble of byte 5, signed
+    EXPECT_DOUBLE_EQ(values["Torque"].value, -810.5);
+}
+
+TEST_F(DBCTest, SignalsSpanningNineBytes) {
+    std::vector<uint8_t> data(12, 0);
+    for (size_t i = 0; i < 9; ++i) {
+        data[i] = static_cast<uint8_t>(0x11 * (i + 1));
+    }
+    auto values = decode(768, false, data);
+    ASSERT_EQ(values.size(), 2u);
+    EXPECT_EQ(static_cast<uint64_t>(values["IntelSpill"].raw), 0x9887766554433221ULL);
+    EXPECT_EQ(static_cast<uint64_t>(values["MotorolaSpill"].raw), 0x1223344556677889ULL);
+}
+
+TEST_F(DBCTest, MultiplexedSignalsFollowTheSelector) {
+    auto values = decode(0x0CF00400, true, {0x01, 0x34, 0x12, 0, 0, 0, 0, 0});
+    ASSERT_EQ(values.size(), 2u);
+    EXPECT_EQ(values["Page"].raw, 1);
+    EXPECT_EQ(values["Counter"].raw, 0x1234);
+
+    values = decode(0x0CF00400, true, {0x02, 0xFE, 0, 0, 0, 0, 0, 0});
+    ASSERT_EQ(values.size(), 2u);
+    EXPECT_EQ(values["Delta"].raw, -2);
+
+    values = decode(0x0CF00400, true, {0x03, 0xFE, 0, 0, 0, 0, 0, 0});
+    ASSERT_EQ(values.size(), 1u);
+    EXPECT_EQ(values.count("Page"), 1u);
+}
+
+TEST_F(DBCTest, ShortFramesDecodeOnlyCompleteSignals) {
+    auto values = decode(256, false, {0x12, 0x34, 0x56});
+    EXPECT_EQ(values.size(), 2u);
+    EXPECT_EQ(values["Rpm"].raw, 0x3412);
+    EXPECT_EQ(values["Nibble"].raw, 0x3);
+    EXPECT_EQ(values.count("Wide"), 0u);
+}
+
+TEST_F(DBCTest, UnknownIdsDecodeNothing) {
+    EXPECT_TRUE(decode(257, false, FRAME).empty());
+    EXPECT_TRUE(decode(256, true, FRAME).empty());
+}
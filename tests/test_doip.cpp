@@ -0,0 +1,391 @@
+#include <gtest/gtest.h>
+#include <fmus/protocols/doip.h>
+#include <fmus/diagnostics/uds.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    using SocketHandle = SOCKET;
+    static const SocketHandle NO_SOCKET = INVALID_SOCKET;
+    static void closeSocket(SocketHandle s) { closesocket(s); }
+#else
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+    using SocketHandle = int;
+    static const SocketHandle NO_SOCKET = -1;
+    static void closeSocket(SocketHandle s) { ::close(s); }
+#endif
+
+using namespace fmus::protocols;
+using namespace fmus::diagnostics;
+
+namespace {
+
+const std::string SIM_VIN = "WVWZZZ1KZ8W000001";
+constexpr uint16_t SIM_ENTITY_ADDRESS = 0x1001;
+
+/**
+ * Minimal DoIP entity on 127.0.0.1: answers vehicle identification over UDP
+ * and routing activation and UDS requests over TCP, on ephemeral ports.
+ */
+class DoIPEntitySimulator {
+public:
+    DoIPEntitySimulator() {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        udpSocket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        ::bind(udpSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        udpPort = boundPort(udpSocket);
+
+        tcpSocket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        ::bind(tcpSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        ::listen(tcpSocket, 1);
+        tcpPort = boundPort(tcpSocket);
+
+        udpThread = std::thread([this] { serveDiscovery(); });
+        tcpThread = std::thread([this] { serveConnection(); });
+    }
+
+    ~DoIPEntitySimulator() {
+        running = false;
+#ifdef _WIN32
+        ::shutdown(udpSocket, SD_BOTH);
+        ::shutdown(tcpSocket, SD_BOTH);
+        if (clientSocket != NO_SOCKET) ::shutdown(clientSocket, SD_BOTH);
+#else
+        ::shutdown(udpSocket, SHUT_RDWR);
+        ::shutdown(tcpSocket, SHUT_RDWR);
+        if (clientSocket != NO_SOCKET) ::shutdown(clientSocket, SHUT_RDWR);
+#endif
+        if (udpThread.joinable()) udpThread.join();
+        if (tcpThread.joinable()) tcpThread.join();
+        closeSocket(udpSocket);
+        closeSocket(tcpSocket);
+        if (clientSocket != NO_SOCKET) closeSocket(clientSocket);
+    }
+
+    /**
+     * Send an alive check request and wait for the tester's response
+     */
+    bool aliveCheck(uint16_t& testerAddress) {
+        std::unique_lock<std::mutex> lock(mutex);
+        aliveAnswered = false;
+        sendMessage(DoIPPayloadType::ALIVE_CHECK_REQUEST, {});
+        if (!condition.wait_for(lock, std::chrono::seconds(2), [this] { return aliveAnswered; })) {
+            return false;
+        }
+        testerAddress = aliveTester;
+        return true;
+    }
+
+    uint16_t udpPort = 0;
+    uint16_t tcpPort = 0;
+    std::atomic<size_t> largestDiagnosticMessage{0};
+
+private:
+    static uint16_t boundPort(SocketHandle s) {
+        sockaddr_in address{};
+        socklen_t length = sizeof(address);
+        ::getsockname(s, reinterpret_cast<sockaddr*>(&address), &length);
+        return ntohs(address.sin_port);
+    }
+
+    static bool receiveExact(SocketHandle s, uint8_t* buffer, size_t length) {
+        while (length > 0) {
+            auto received = ::recv(s, reinterpret_cast<char*>(buffer), static_cast<int>(length), 0);
+            if (received <= 0) {
+                return false;
+            }
+            buffer += received;
+            length -= static_cast<size_t>(received);
+        }
+        return true;
+    }
+
+    void sendMessage(DoIPPayloadType type, const std::vector<uint8_t>& payload) {
+        std::vector<uint8_t> message(DoIPHeader::SIZE);
+        DoIPHeader(type, static_cast<uint32_t>(payload.size())).encode(message.data());
+        message.insert(message.end(), payload.begin(), payload.end());
+        std::lock_guard<std::mutex> lock(sendMutex);
+        ::send(clientSocket, reinterpret_cast<const char*>(message.data()), static_cast<int>(message.size()), 0);
+    }
+
+    void serveDiscovery() {
+        uint8_t buffer[64];
+        while (running) {
+            sockaddr_in sender{};
+            socklen_t senderLength = sizeof(sender);
+            auto received = ::recvfrom(udpSocket, reinterpret_cast<char*>(buffer), sizeof(buffer), 0,
+                                       reinterpret_cast<sockaddr*>(&sender), &senderLength);
+            DoIPHeader header;
+            if (received < static_cast<decltype(received)>(DoIPHeader::SIZE) ||
+                !DoIPHeader::decode(buffer, header)) {
+                continue;
+            }
+            if (header.payloadType == DoIPPayloadType::VEHICLE_ID_REQUEST_VIN &&
+                std::string(reinterpret_cast<char*>(buffer + DoIPHeader::SIZE), 17) != SIM_VIN) {
+                continue;
+            }
+            if (header.payloadType != DoIPPayloadType::VEHICLE_ID_REQUEST &&
+                header.payloadType != DoIPPayloadType::VEHICLE_ID_REQUEST_VIN) {
+                continue;
+            }
+
+            DoIPVehicleAnnouncement announcement;
+            announcement.vin = SIM_VIN;
+            announcement.logicalAddress = SIM_ENTITY_ADDRESS;
+            announcement.eid = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+            auto payload = announcement.toPayload();
+            std::vector<uint8_t> response(DoIPHeader::SIZE);
+            DoIPHeader(DoIPPayloadType::VEHICLE_ANNOUNCEMENT, static_cast<uint32_t>(payload.size()))
+                .encode(response.data());
+            response.insert(response.end(), payload.begin(), payload.end());
+            ::sendto(udpSocket, reinterpret_cast<const char*>(response.data()), static_cast<int>(response.size()), 0,
+                     reinterpret_cast<sockaddr*>(&sender), senderLength);
+        }
+    }
+
+    void serveConnection() {
+        SocketHandle accepted = ::accept(tcpSocket, nullptr, nullptr);
+        if (!running || accepted == NO_SOCKET) {
+            return;
+        }
+        clientSocket = accepted;
+
+        std::vector<uint8_t> payload;
+        uint8_t headerBytes[DoIPHeader::SIZE];
+        while (running && receiveExact(clientSocket, headerBytes, sizeof(headerBytes))) {
+            DoIPHeader header;
+            if (!DoIPHeader::decode(headerBytes, header)) {
+                sendMessage(DoIPPayloadType::GENERIC_NACK, {0x00});
+                break;
+            }
+            payload.resize(header.payloadLength);
+            if (!receiveExact(clientSocket, payload.data(), payload.size())) {
+                break;
+            }
+
+            switch (header.payloadType) {
+                case DoIPPayloadType::ROUTING_ACTIVATION_REQUEST: {
+                    uint16_t tester = static_cast<uint16_t>((payload[0] << 8) | payload[1]);
+                    uint8_t code = (tester >= 0x0E00 && tester <= 0x0FFF) ? 0x10 : 0x00;
+                    sendMessage(DoIPPayloadType::ROUTING_ACTIVATION_RESPONSE,
+                                {payload[0], payload[1], SIM_ENTITY_ADDRESS >> 8, SIM_ENTITY_ADDRESS & 0xFF,
+                                 code, 0, 0, 0, 0});
+                    break;
+                }
+                case DoIPPayloadType::ALIVE_CHECK_RESPONSE: {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    aliveTester = static_cast<uint16_t>((payload[0] << 8) | payload[1]);
+                    aliveAnswered = true;
+                    condition.notify_all();
+                    break;
+                }
+                case DoIPPayloadType::DIAGNOSTIC_MESSAGE:
+                    handleDiagnostic(payload);
+                    break;
+                default:
+                    sendMessage(DoIPPayloadType::GENERIC_NACK, {0x01});
+                    break;
+            }
+        }
+    }
+
+    void handleDiagnostic(const std::vector<uint8_t>& payload) {
+        uint16_t target = static_cast<uint16_t>((payload[2] << 8) | payload[3]);
+        if (target != SIM_ENTITY_ADDRESS) {
+            sendMessage(DoIPPayloadType::DIAGNOSTIC_NACK, {payload[2], payload[3], payload[0], payload[1], 0x03});
+            return;
+        }
+        sendMessage(DoIPPayloadType::DIAGNOSTIC_ACK, {payload[2], payload[3], payload[0], payload[1], 0x00});
+
+        size_t udsLength = payload.size() - 4;
+        if (udsLength > largestDiagnosticMessage) {
+            largestDiagnosticMessage = udsLength;
+        }
+
+        std::vector<uint8_t> response = {payload[2], payload[3], payload[0], payload[1]};
+        uint8_t service = payload[4];
+        if (service == 0x22 && udsLength == 3 && payload[5] == 0xF1 && payload[6] == 0x90) {
+            response.insert(response.end(), {0x62, 0xF1, 0x90});
+            response.insert(response.end(), SIM_VIN.begin(), SIM_VIN.end());
+        } else if (service == 0x36 && udsLength > 1) {
+            response.insert(response.end(), {0x76, payload[5]});
+        } else {
+            response.insert(response.end(), {0x7F, service, 0x11});
+        }
+        sendMessage(DoIPPayloadType::DIAGNOSTIC_MESSAGE, response);
+    }
+
+    std::atomic<bool> running{true};
+    SocketHandle udpSocket;
+    SocketHandle tcpSocket;
+    std::atomic<SocketHandle> clientSocket{NO_SOCKET};
+    std::thread udpThread;
+    std::thread tcpThread;
+
+    std::mutex sendMutex;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool aliveAnswered = false;
+    uint16_t aliveTester = 0;
+};
+
+} // anonymous namespace
+
+class DoIPTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        simulator = std::make_unique<DoIPEntitySimulator>();
+        config.port = simulator->tcpPort;
+    }
+
+    void TearDown() override {
+        client.disconnect();
+        simulator.reset();
+    }
+
+    bool connectAndActivate() {
+        return client.connect("127.0.0.1", config) && client.activateRouting();
+    }
+
+    std::unique_ptr<DoIPEntitySimulator> simulator;
+    DoIPConfig config;
+    DoIPClient client;
+};
+
+TEST(DoIPHeaderTest, EncodeDecode) {
+    uint8_t bytes[DoIPHeader::SIZE];
+    DoIPHeader(DoIPPayloadType::DIAGNOSTIC_MESSAGE, 0x01020304).encode(bytes);
+
+    const uint8_t expected[] = {0x02, 0xFD, 0x80, 0x01, 0x01, 0x02, 0x03, 0x04};
+    EXPECT_EQ(0, std::memcmp(bytes, expected, sizeof(expected)));
+
+    DoIPHeader header;
+    ASSERT_TRUE(DoIPHeader::decode(bytes, header));
+    EXPECT_EQ(header.version, DOIP_PROTOCOL_VERSION);
+    EXPECT_EQ(header.payloadType, DoIPPayloadType::DIAGNOSTIC_MESSAGE);
+    EXPECT_EQ(header.payloadLength, 0x01020304u);
+
+    bytes[1] = 0x00;
+    EXPECT_FALSE(DoIPHeader::decode(bytes, header));
+}
+
+TEST(DoIPHeaderTest, AnnouncementRoundTrip) {
+    DoIPVehicleAnnouncement announcement;
+    announcement.vin = SIM_VIN;
+    announcement.logicalAddress = 0x1234;
+    announcement.gid = {1, 2, 3, 4, 5, 6};
+    announcement.furtherAction = 0x10;
+
+    auto payload = announcement.toPayload();
+    ASSERT_EQ(payload.size(), 33u);
+
+    DoIPVehicleAnnouncement parsed;
+    ASSERT_TRUE(DoIPVehicleAnnouncement::fromPayload(payload.data(), payload.size(), parsed));
+    EXPECT_EQ(parsed.vin, SIM_VIN);
+    EXPECT_EQ(parsed.logicalAddress, 0x1234);
+    EXPECT_EQ(parsed.gid, announcement.gid);
+    EXPECT_EQ(parsed.furtherAction, 0x10);
+    EXPECT_FALSE(DoIPVehicleAnnouncement::fromPayload(payload.data(), 31, parsed));
+}
+
+TEST_F(DoIPTest, DiscoverEntity) {
+    auto entities = DoIPClient::discover("127.0.0.1", 300, "", simulator->udpPort);
+    ASSERT_EQ(entities.size(), 1u);
+    EXPECT_EQ(entities[0].vin, SIM_VIN);
+    EXPECT_EQ(entities[0].logicalAddress, SIM_ENTITY_ADDRESS);
+    EXPECT_EQ(entities[0].ipAddress, "127.0.0.1");
+
+    EXPECT_EQ(DoIPClient::discover("127.0.0.1", 300, SIM_VIN, simulator->udpPort).size(), 1u);
+    EXPECT_TRUE(DoIPClient::discover("127.0.0.1", 200, "WVWZZZ1KZ8W999999", simulator->udpPort).empty());
+}
+
+TEST_F(DoIPTest, RoutingActivation) {
+    ASSERT_TRUE(client.connect("127.0.0.1", config));
+    EXPECT_FALSE(client.isRoutingActive());
+    ASSERT_TRUE(client.activateRouting());
+    EXPECT_TRUE(client.isRoutingActive());
+    EXPECT_EQ(client.getEntityAddress(), SIM_ENTITY_ADDRESS);
+}
+
+TEST_F(DoIPTest, RoutingActivationDenied) {
+    config.testerAddress = 0x0100;
+    ASSERT_TRUE(client.connect("127.0.0.1", config));
+    EXPECT_FALSE(client.activateRouting());
+    EXPECT_EQ(client.getLastResponseCode(), static_cast<uint8_t>(DoIPRoutingCode::DENIED_UNKNOWN_SOURCE));
+}
+
+TEST_F(DoIPTest, DiagnosticNackForUnknownTarget) {
+    ASSERT_TRUE(connectAndActivate());
+    EXPECT_FALSE(client.sendDiagnosticMessage(0x2002, std::vector<uint8_t>{0x3E, 0x00}));
+    EXPECT_EQ(client.getLastResponseCode(), static_cast<uint8_t>(DoIPDiagnosticNack::UNKNOWN_TARGET_ADDRESS));
+    EXPECT_EQ(client.getStatistics().negativeAcks, 1u);
+}
+
+TEST_F(DoIPTest, UDSOverDoIP) {
+    auto doip = std::make_shared<DoIPClient>();
+    ASSERT_TRUE(doip->connect("127.0.0.1", config));
+    ASSERT_TRUE(doip->activateRouting());
+
+    UDSConfig udsConfig;
+    udsConfig.requestId = SIM_ENTITY_ADDRESS;
+    udsConfig.responseId = SIM_ENTITY_ADDRESS;
+
+    UDSClient uds;
+    ASSERT_TRUE(uds.initialize(udsConfig, doip));
+
+    auto vin = uds.readDataByIdentifier(0xF190);
+    EXPECT_EQ(std::string(vin.begin(), vin.end()), SIM_VIN);
+
+    UDSMessage unsupported = uds.sendRequest(UDSMessage(UDSService::ECU_RESET, {0x01}));
+    EXPECT_TRUE(unsupported.isNegativeResponse);
+    EXPECT_EQ(unsupported.negativeResponseCode, UDSNegativeResponse::SERVICE_NOT_SUPPORTED);
+
+    uds.shutdown();
+}
+
+TEST_F(DoIPTest, LargeTransferData) {
+    auto doip = std::make_shared<DoIPClient>();
+    ASSERT_TRUE(doip->connect("127.0.0.1", config));
+    ASSERT_TRUE(doip->activateRouting());
+
+    UDSConfig udsConfig;
+    udsConfig.requestId = SIM_ENTITY_ADDRESS;
+    udsConfig.responseId = SIM_ENTITY_ADDRESS;
+
+    UDSClient uds;
+    ASSERT_TRUE(uds.initialize(udsConfig, doip));
+
+    // A block far beyond the 4095-byte ISO-TP limit
+    std::vector<uint8_t> block(1024 * 1024, 0xA5);
+    block[0] = 0x01;
+    UDSMessage response = uds.sendRequest(UDSMessage(UDSService::TRANSFER_DATA, block));
+    ASSERT_FALSE(response.isNegativeResponse);
+    EXPECT_EQ(response.service, UDSService::TRANSFER_DATA);
+    ASSERT_EQ(response.data.size(), 1u);
+    EXPECT_EQ(response.data[0], 0x01);
+    EXPECT_EQ(simulator->largestDiagnosticMessage, block.size() + 1);
+
+    uds.shutdown();
+}
+
+TEST_F(DoIPTest, AnswersAliveCheck) {
+    ASSERT_TRUE(connectAndActivate());
+
+    uint16_t tester = 0;
+    ASSERT_TRUE(simulator->aliveCheck(tester));
+    EXPECT_EQ(tester, config.testerAddress);
+}
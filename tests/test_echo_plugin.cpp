@@ -0,0 +1,64 @@
+#include <fmus/plugins/plugin_manager.h>
+
+/**
+ * Minimal plugin library loaded by the plugin manager tests. Commands are
+ * echoed back so a test can tell the plugin is reachable.
+ */
+
+using namespace fmus::plugins;
+
+namespace {
+
+class EchoPlugin : public IPlugin {
+public:
+    PluginInfo getInfo() const override {
+        PluginInfo info;
+        info.name = "echo";
+        info.description = "Echoes commands back";
+        info.version = "1.0.0";
+        return info;
+    }
+
+    bool initialize(std::shared_ptr<fmus::Auto> /*autoInstance*/) override {
+        initialized = true;
+        return true;
+    }
+
+    void shutdown() override {
+        initialized = false;
+    }
+
+    bool isInitialized() const override {
+        return initialized;
+    }
+
+    std::string executeCommand(const std::string& command,
+                               const std::map<std::string, std::string>& /*parameters*/) override {
+        return command;
+    }
+
+    std::vector<std::string> getCapabilities() const override {
+        return {"echo"};
+    }
+
+private:
+    bool initialized = false;
+};
+
+} // anonymous namespace
+
+extern "C" {
+
+FMUS_AUTO_API int getPluginInterfaceVersion() {
+    return PLUGIN_INTERFACE_VERSION;
+}
+
+FMUS_AUTO_API IPlugin* createPlugin() {
+    return new EchoPlugin();
+}
+
+FMUS_AUTO_API void destroyPlugin(IPlugin* plugin) {
+    delete plugin;
+}
+
+}
@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include <fmus/plugins/event_bus.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+using namespace fmus;
+using namespace fmus::plugins;
+
+namespace {
+
+/**
+ * Collects what a subscriber's handler was given, and lets the test wait for it
+ */
+class Recorder {
+public:
+    EventHandler handler() {
+        return [this](const Event& event) {
+            std::lock_guard<std::mutex> lock(mutex);
+            events.push_back(event);
+            condition.notify_all();
+        };
+    }
+
+    bool waitFor(size_t count, std::chrono::milliseconds timeout = std::chrono::milliseconds(1000)) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return condition.wait_for(lock, timeout, [&] { return events.size() >= count; });
+    }
+
+    std::vector<Event> received() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return events;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<Event> events;
+};
+
+FrameEvent frame(uint32_t id) {
+    FrameEvent event;
+    event.id = id;
+    event.length = 2;
+    event.data[0] = 0x41;
+    event.data[1] = 0x0C;
+    return event;
+}
+
+} // anonymous namespace
+
+TEST(EventBusTest, EventNamesAreInternedOnce) {
+    EventBus bus;
+    EventId frames = bus.registerEvent("can.frame");
+    EXPECT_NE(frames, INVALID_EVENT_ID);
+    EXPECT_EQ(bus.registerEvent("can.frame"), frames);
+    EXPECT_NE(bus.registerEvent("dtc.changed"), frames);
+    EXPECT_EQ(bus.findEvent("can.frame"), frames);
+    EXPECT_EQ(bus.findEvent("unknown"), INVALID_EVENT_ID);
+    EXPECT_EQ(bus.getEventName(frames), "can.frame");
+}
+
+TEST(EventBusTest, EverySubscriberSharesOnePayload) {
+    EventBus bus;
+    EventId frames = bus.registerEvent("can.frame");
+    EventId dtcs = bus.registerEvent("dtc.changed");
+    Recorder first;
+    Recorder second;
+    Recorder other;
+    bus.subscribe(frames, "first", first.handler());
+    bus.subscribe(frames, "second", second.handler());
+    bus.subscribe(dtcs, "other", other.handler());
+    EXPECT_TRUE(bus.hasSubscribers(frames));
+
+    EXPECT_EQ(bus.publish(frames, frame(0x7E8)), 2u);
+    ASSERT_TRUE(first.waitFor(1));
+    ASSERT_TRUE(second.waitFor(1));
+    ASSERT_TRUE(bus.flush());
+
+    auto a = first.received();
+    auto b = second.received();
+    EXPECT_EQ(a[0].id, frames);
+    ASSERT_NE(a[0].get<FrameEvent>(), nullptr);
+    EXPECT_EQ(a[0].get<FrameEvent>()->id, 0x7E8u);
+    EXPECT_EQ(a[0].get<DTCEvent>(), nullptr);
+    EXPECT_EQ(a[0].payload.get(), b[0].payload.get());
+    EXPECT_TRUE(other.received().empty());
+}
+
+TEST(EventBusTest, SharedPayloadPointersArePublishedAsIs) {
+    EventBus bus;
+    EventId samples = bus.registerEvent("live.sample");
+    Recorder recorder;
+    bus.subscribe(samples, "recorder", recorder.handler());
+
+    ParameterSample sample;
+    sample.name = "soc";
+    sample.value = 81.5;
+    auto payload = std::make_shared<EventPayload>(sample);
+    EXPECT_EQ(bus.publish(samples, payload), 1u);
+    ASSERT_TRUE(recorder.waitFor(1));
+    EXPECT_EQ(recorder.received()[0].payload.get(), payload.get());
+    EXPECT_DOUBLE_EQ(recorder.received()[0].get<ParameterSample>()->value, 81.5);
+}
+
+TEST(EventBusTest, IdleSubscriberWakesForEveryEvent) {
+    // Each event arrives while the delivery thread is asleep or going to sleep;
+    // the wait has no timeout, so a lost wakeup would stall here
+    EventBus bus;
+    EventId frames = bus.registerEvent("can.frame");
+    Recorder recorder;
+    bus.subscribe(frames, "recorder", recorder.handler());
+
+    for (size_t i = 1; i <= 2000; ++i) {
+        ASSERT_EQ(bus.publish(frames, frame(static_cast<uint32_t>(i))), 1u);
+        ASSERT_TRUE(recorder.waitFor(i)) << "event " << i << " was not delivered";
+    }
+    auto stats = bus.getSubscriberStatistics();
+    ASSERT_EQ(stats.size(), 1u);
+    EXPECT_EQ(stats[0].delivered, 2000u);
+}
+
+TEST(EventBusTest, FullQueueDropsInsteadOfBlockingThePublisher) {
+    EventBus bus;
+    EventId frames = bus.registerEvent("can.frame");
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool entered = false;
+    bool release = false;
+    bus.subscribe(frames, "slow", [&](const Event&) {
+        std::unique_lock<std::mutex> lock(mutex);
+        entered = true;
+        condition.notify_all();
+        condition.wait(lock, [&] { return release; });
+    }, 4);
+
+    ASSERT_EQ(bus.publish(frames, frame(0)), 1u);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        ASSERT_TRUE(condition.wait_for(lock, std::chrono::seconds(1), [&] { return entered; }));
+    }
+
+    size_t queued = 0;
+    for (uint32_t i = 1; i <= 10; ++i) {
+        queued += bus.publish(frames, frame(i));
+    }
+    EXPECT_EQ(queued, 4u);
+    EXPECT_EQ(bus.getStatistics().eventsDropped, 6u);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        release = true;
+    }
+    condition.notify_all();
+    ASSERT_TRUE(bus.flush());
+    auto stats = bus.getSubscriberStatistics();
+    EXPECT_EQ(stats[0].delivered, 5u);
+    EXPECT_EQ(stats[0].dropped, 6u);
+    EXPECT_EQ(stats[0].queueCapacity, 4u);
+}
+
+TEST(EventBusTest, HandlerErrorsAreCountedAndDeliveryGoesOn) {
+    EventBus bus;
+    EventId frames = bus.registerEvent("can.frame");
+    std::atomic<int> calls{0};
+    bus.subscribe(frames, "faulty", [&calls](const Event&) {
+        if (++calls == 1) {
+            throw std::runtime_error("bad frame");
+        }
+    });
+
+    bus.publish(frames, frame(1));
+    bus.publish(frames, frame(2));
+    ASSERT_TRUE(bus.flush());
+    EXPECT_EQ(calls, 2);
+    EXPECT_EQ(bus.getSubscriberStatistics()[0].handlerErrors, 1u);
+}
+
+TEST(EventBusTest, UnsubscribedHandlersReceiveNothingMore) {
+    EventBus bus;
+    EventId frames = bus.registerEvent("can.frame");
+    Recorder recorder;
+    SubscriptionId subscription = bus.subscribe(frames, "plugin", recorder.handler());
+    bus.publish(frames, frame(1));
+    ASSERT_TRUE(recorder.waitFor(1));
+
+    EXPECT_TRUE(bus.unsubscribe(subscription));
+    EXPECT_FALSE(bus.hasSubscribers(frames));
+    EXPECT_EQ(bus.publish(frames, frame(2)), 0u);
+    EXPECT_EQ(bus.getStatistics().eventsWithoutSubscribers, 1u);
+    EXPECT_EQ(recorder.received().size(), 1u);
+}
@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+#include <fmus/plugins/extension_points.h>
+#include <fmus/protocols/can.h>
+#include <fmus/live_data_store.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace fmus;
+using namespace fmus::plugins;
+using namespace fmus::protocols;
+
+namespace {
+
+const std::string OWNER = "test_extension_points";
+
+// Decoders report their context as the value so a test can tell who ran
+size_t decodeContext(void* context, uint32_t, const uint8_t*, size_t, DecodedValue* out, size_t capacity) {
+    if (capacity == 0) {
+        return 0;
+    }
+    out[0].name = "winner";
+    out[0].value = static_cast<double>(reinterpret_cast<uintptr_t>(context));
+    out[0].unit = "";
+    return 1;
+}
+
+size_t decodeSpeed(void*, uint32_t, const uint8_t* data, size_t length, DecodedValue* out, size_t capacity) {
+    if (capacity == 0 || length < 2) {
+        return 0;
+    }
+    out[0].name = "VehicleSpeed";
+    out[0].value = ((data[0] << 8) | data[1]) * 0.01;
+    out[0].unit = "km/h";
+    return 1;
+}
+
+bool keyFromContext(void* context, uint8_t, const uint8_t*, size_t, uint8_t* key, size_t* keyLength) {
+    key[0] = static_cast<uint8_t>(reinterpret_cast<uintptr_t>(context));
+    *keyLength = 1;
+    return true;
+}
+
+void* tag(uintptr_t value) {
+    return reinterpret_cast<void*>(value);
+}
+
+/**
+ * Loopback transport backend: written frames are read back in order.
+ */
+class LoopbackBackend : public ITransportBackend {
+public:
+    bool open(const std::map<std::string, std::string>& options) override {
+        opened = options.count("bitrate") != 0;
+        return opened;
+    }
+
+    void close() override {
+        opened = false;
+    }
+
+    bool isOpen() const override {
+        return opened;
+    }
+
+    size_t write(const TransportFrame* frames, size_t count) override {
+        queued.insert(queued.end(), frames, frames + count);
+        return count;
+    }
+
+    size_t read(TransportFrame* frames, size_t capacity, std::chrono::milliseconds) override {
+        size_t count = std::min(capacity, queued.size());
+        std::copy_n(queued.begin(), count, frames);
+        queued.erase(queued.begin(), queued.begin() + static_cast<std::ptrdiff_t>(count));
+        return count;
+    }
+
+private:
+    bool opened = false;
+    std::vector<TransportFrame> queued;
+};
+
+ITransportBackend* createLoopback(void*) {
+    return new LoopbackBackend();
+}
+
+class ExtensionPointsTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        getGlobalExtensionRegistry()->unregisterOwner(OWNER);
+    }
+
+    double decodeDid(uint16_t did) {
+        DecodedValue value;
+        uint8_t data[1] = {0};
+        auto tables = getGlobalExtensionRegistry()->getTables();
+        return tables->decodeDataIdentifier(did, data, sizeof(data), &value, 1) == 1 ? value.value : -1.0;
+    }
+};
+
+} // anonymous namespace
+
+TEST_F(ExtensionPointsTest, MostRecentRegistrationWinsPriorityTie) {
+    auto registry = getGlobalExtensionRegistry();
+    registry->registerDataIdentifierDecoder(OWNER, 0xF190, decodeContext, tag(1));
+    registry->registerDataIdentifierDecoder(OWNER, 0xF190, decodeContext, tag(2));
+    EXPECT_EQ(decodeDid(0xF190), 2.0);
+
+    registry->registerSecurityAlgorithm(OWNER, "tie", keyFromContext, tag(1));
+    registry->registerSecurityAlgorithm(OWNER, "tie", keyFromContext, tag(2));
+    std::vector<uint8_t> key;
+    ASSERT_TRUE(registry->getTables()->computeKey("tie", 1, {0x12, 0x34}, key));
+    ASSERT_EQ(key.size(), 1u);
+    EXPECT_EQ(key[0], 2);
+}
+
+TEST_F(ExtensionPointsTest, HigherPriorityWinsOverNewerRegistration) {
+    auto registry = getGlobalExtensionRegistry();
+    registry->registerDataIdentifierDecoder(OWNER, 0xF191, decodeContext, tag(1), 10);
+    registry->registerDataIdentifierDecoder(OWNER, 0xF191, decodeContext, tag(2), 0);
+    EXPECT_EQ(decodeDid(0xF191), 1.0);
+}
+
+TEST_F(ExtensionPointsTest, UnregisteringWinnerFallsBackToPrevious) {
+    auto registry = getGlobalExtensionRegistry();
+    registry->registerDataIdentifierDecoder(OWNER, 0xF192, decodeContext, tag(1));
+    auto newest = registry->registerDataIdentifierDecoder(OWNER, 0xF192, decodeContext, tag(2));
+    ASSERT_TRUE(registry->unregister(newest));
+    EXPECT_EQ(decodeDid(0xF192), 1.0);
+}
+
+TEST_F(ExtensionPointsTest, CANFrameDecodersPublishToLiveDataStore) {
+    getGlobalExtensionRegistry()->registerFrameDecoder(OWNER, 0x3E9, FRAME_ID_EXACT, decodeSpeed);
+
+    CANProtocol can;
+    ASSERT_TRUE(can.initialize(CANConfig()));
+    auto store = std::make_shared<LiveDataStore>();
+    can.publishDecodedValuesTo(store);
+
+    ASSERT_TRUE(can.injectMessage(CANMessage(0x3E9, {0x27, 0x10})));
+    ASSERT_TRUE(can.injectMessage(CANMessage(0x3EA, {0xFF, 0xFF})));
+
+    auto channel = store->findChannel("VehicleSpeed");
+    ASSERT_NE(channel, LiveDataStore::INVALID_CHANNEL);
+    EXPECT_EQ(store->getChannelUnit(channel), "km/h");
+    LiveSample sample;
+    ASSERT_TRUE(store->readLatest(channel, sample));
+    EXPECT_DOUBLE_EQ(sample.value, 100.0);
+    EXPECT_EQ(store->getSequence(channel), 1u);
+
+    can.publishDecodedValuesTo(nullptr);
+    ASSERT_TRUE(can.injectMessage(CANMessage(0x3E9, {0x00, 0x01})));
+    EXPECT_EQ(store->getSequence(channel), 1u);
+    can.shutdown();
+}
+
+TEST_F(ExtensionPointsTest, CANUsesPluginTransportBackend) {
+    getGlobalExtensionRegistry()->registerTransportBackend(OWNER, "loopback", createLoopback);
+
+    CANConfig config;
+    config.backend = j2534::Backend::PLUGIN;
+    config.interfaceName = "loopback";
+
+    CANProtocol can;
+    ASSERT_TRUE(can.initialize(config));
+    ASSERT_TRUE(can.sendMessages({CANMessage(0x7E0, {0x02, 0x10, 0x03}),
+                                  CANMessage(0x18DA10F1, {0x02, 0x3E, 0x00}, true)}));
+
+    auto received = can.receiveMessages(10);
+    ASSERT_EQ(received.size(), 2u);
+    EXPECT_EQ(received[0].id, 0x7E0u);
+    EXPECT_EQ(received[0].data, std::vector<uint8_t>({0x02, 0x10, 0x03}));
+    EXPECT_FALSE(received[0].extended);
+    EXPECT_EQ(received[1].id, 0x18DA10F1u);
+    EXPECT_TRUE(received[1].extended);
+    can.shutdown();
+
+    config.interfaceName = "missing";
+    CANProtocol unknown;
+    EXPECT_FALSE(unknown.initialize(config));
+}
+
+TEST_F(ExtensionPointsTest, TransportBackendKeepsItsOwnerAlive) {
+    struct Provider : IExtensionProvider {
+        void registerExtensions(ExtensionRegistry& registry, const std::string& owner) override {
+            registry.registerTransportBackend(owner, "loopback", createLoopback);
+        }
+    } provider;
+
+    // Stands in for the plugin instance that holds the backend's library
+    auto library = std::make_shared<int>(0);
+    std::weak_ptr<int> loaded = library;
+    auto registry = getGlobalExtensionRegistry();
+    ASSERT_EQ(registry->registerProvider(provider, OWNER, library), 1u);
+    library.reset();
+
+    auto backend = registry->createTransportBackend("loopback");
+    ASSERT_NE(backend, nullptr);
+    registry->unregisterOwner(OWNER);
+    registry->getTables();
+    EXPECT_FALSE(loaded.expired());
+
+    backend.reset();
+    EXPECT_TRUE(loaded.expired());
+    EXPECT_EQ(registry->createTransportBackend("loopback"), nullptr);
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include <fmus/export/data_exporter.h>
+#include <fmus/thread_pool.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace fmus;
+using namespace fmus::export_system;
+namespace fs = std::filesystem;
+
+namespace {
+
+LiveDataParameter parameter(const std::string& name,
+                            std::variant<int32_t, uint32_t, float, double, std::string> value,
+                            const std::string& unit) {
+    LiveDataParameter p;
+    p.name = name;
+    p.value = std::move(value);
+    p.unit = unit;
+    return p;
+}
+
+DiagnosticTroubleCode dtc(const std::string& code, uint8_t status, bool confirmed) {
+    DiagnosticTroubleCode d;
+    d.code = code;
+    d.description = "Cell voltage \"low\"";
+    d.status = status;
+    d.isConfirmed = confirmed;
+    return d;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+class FanOutExporterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory = fs::temp_directory_path() / ("fmus_fan_out_test_" + std::to_string(::getpid()));
+        fs::create_directories(directory);
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        fs::remove_all(directory, ec);
+    }
+
+    ExportConfig config(ExportFormat format, const std::string& file) const {
+        ExportConfig c;
+        c.format = format;
+        c.filePath = (directory / file).string();
+        c.includeTimestamp = false;
+        return c;
+    }
+
+    static ExportData dtcData() {
+        ExportData data(ExportDataType::DTC_DATA, "session");
+        data.dtcData = {dtc("P0A80", 0x09, true), dtc("U0100", 0x04, false)};
+        return data;
+    }
+
+    fs::path directory;
+    FanOutExporter exporter;
+};
+
+} // anonymous namespace
+
+TEST_F(FanOutExporterTest, FormatsEveryValueOnceIntoColumns) {
+    ExportData data(ExportDataType::LIVE_DATA, "live");
+    data.liveData = {parameter("rpm", int32_t(3000), "rpm"), parameter("soc", 81.5, "%")};
+
+    auto table = FormattedExportData::build(data, "%Y");
+    ASSERT_EQ(table.rowCount, 2u);
+    ASSERT_EQ(table.columns.size(), 5u);
+    EXPECT_EQ(table.columns[0].values, (std::vector<std::string>{"rpm", "soc"}));
+    EXPECT_EQ(table.columns[1].values, (std::vector<std::string>{"3000", "81.5"}));
+    EXPECT_TRUE(table.columns[1].numeric);
+
+    // One text value makes the whole value column quoted
+    data.liveData.push_back(parameter("mode", std::string("eco, sport"), ""));
+    table = FormattedExportData::build(data, "%Y");
+    EXPECT_FALSE(table.columns[1].numeric);
+
+    std::string csv;
+    ASSERT_TRUE(exporter.render(table, config(ExportFormat::CSV, "live.csv"), csv));
+    std::istringstream lines(csv);
+    std::string header;
+    std::getline(lines, header);
+    EXPECT_EQ(header, "name,value,unit,description,timestamp");
+    EXPECT_NE(csv.find("mode,\"eco, sport\",,"), std::string::npos) << csv;
+}
+
+TEST_F(FanOutExporterTest, JsonKeepsFlagsUnquotedAndEscapesText) {
+    auto table = FormattedExportData::build(dtcData(), "%Y");
+    std::string json;
+    ASSERT_TRUE(exporter.render(table, config(ExportFormat::JSON, "dtc.json"), json));
+    EXPECT_NE(json.find("\"code\": \"P0A80\", \"description\": \"Cell voltage \\\"low\\\"\", \"status\": \"0x09\", "
+                        "\"pending\": false, \"confirmed\": true"),
+              std::string::npos) << json;
+}
+
+TEST_F(FanOutExporterTest, ExportAllWritesEachFormatFromTheSameTable) {
+    std::vector<ExportConfig> configs = {config(ExportFormat::CSV, "dtc.csv"), config(ExportFormat::JSON, "dtc.json"),
+                                         config(ExportFormat::PDF, "dtc.pdf"), config(ExportFormat::XML, "dtc.xml")};
+    size_t progress = 0;
+    auto result = exporter.exportAll(dtcData(), configs,
+                                     [&progress](const std::string&, size_t done, size_t total, const std::string&) {
+                                         EXPECT_EQ(total, 4u);
+                                         progress = std::max(progress, done);
+                                     });
+
+    ASSERT_EQ(result.results.size(), 4u);
+    EXPECT_FALSE(result.allSucceeded());
+    EXPECT_EQ(progress, 4u);
+
+    auto table = FormattedExportData::build(dtcData(), configs.front().dateFormat);
+    for (size_t i : {0u, 1u, 3u}) {
+        const auto& r = result.results[i];
+        ASSERT_TRUE(r.success) << r.errorMessage;
+        EXPECT_EQ(r.filePath, configs[i].filePath);
+        EXPECT_EQ(r.recordsExported, 2u);
+
+        std::string expected;
+        ASSERT_TRUE(exporter.render(table, configs[i], expected));
+        EXPECT_EQ(readFile(r.filePath), expected);
+        EXPECT_EQ(r.fileSize, expected.size());
+    }
+    EXPECT_FALSE(result.results[2].success);
+    EXPECT_NE(result.results[2].errorMessage.find("No writer"), std::string::npos);
+    EXPECT_FALSE(fs::exists(configs[2].filePath));
+}
+
+TEST_F(FanOutExporterTest, ExportingOnAPoolWorkerRunsInline) {
+    // Occupy every worker with an export; queued writers would never run if they waited on the pool
+    auto pool = getGlobalThreadPool();
+    std::vector<std::future<FanOutExportResult>> nested;
+    for (size_t i = 0; i < pool->getThreadCount(); ++i) {
+        std::string suffix = std::to_string(i);
+        std::vector<ExportConfig> configs = {config(ExportFormat::CSV, "dtc" + suffix + ".csv"),
+                                             config(ExportFormat::TXT, "dtc" + suffix + ".txt")};
+        nested.push_back(pool->enqueue([this, configs] { return exporter.exportAll(dtcData(), configs); }));
+    }
+    for (auto& future : nested) {
+        ASSERT_EQ(future.wait_for(std::chrono::seconds(30)), std::future_status::ready);
+        EXPECT_TRUE(future.get().allSucceeded());
+    }
+}
@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include <fmus/protocols/can.h>
+#include <fmus/protocols/transport.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace fmus;
+using namespace fmus::protocols;
+
+namespace {
+
+const std::vector<uint8_t> VIN = {0x49, 0x02, 0x01, 'W', 'V', 'W', 'Z', 'Z', 'Z', '1', 'J', 'Z',
+                                  'X', 'W', '0', '0', '0', '0', '0', '1'};
+
+/**
+ * A tester on a loopback bus that records every frame and PDU
+ */
+class IsoTpFunctionalTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        CANConfig config;
+        config.loopback = true;
+        can = std::make_shared<CANProtocol>();
+        ASSERT_TRUE(can->initialize(config));
+        can->addListener([this](const CANMessage& frame) {
+            std::lock_guard<std::mutex> lock(mutex);
+            frames.push_back(frame);
+        });
+    }
+
+    void TearDown() override {
+        tester.reset();
+        can->shutdown();
+    }
+
+    void open(const IsoTpConfig& config) {
+        tester = std::make_unique<IsoTpTransport>(can, config);
+        tester->setReceiveHandler([this](uint32_t source, const uint8_t* data, size_t length) {
+            std::lock_guard<std::mutex> lock(mutex);
+            pdus.emplace_back(source, std::vector<uint8_t>(data, data + length));
+        });
+        ASSERT_TRUE(tester->open());
+    }
+
+    /**
+     * Answer as an ECU would: first frame, wait for flow control, then the rest
+     */
+    void respond(uint32_t source, bool extended, const std::vector<uint8_t>& pdu) {
+        std::vector<uint8_t> first = {0x10, static_cast<uint8_t>(pdu.size())};
+        first.insert(first.end(), pdu.begin(), pdu.begin() + 6);
+        ASSERT_TRUE(can->injectMessage(CANMessage(source, first, extended)));
+
+        uint8_t sequence = 1;
+        for (size_t offset = 6; offset < pdu.size(); offset += 7, ++sequence) {
+            std::vector<uint8_t> consecutive = {static_cast<uint8_t>(0x20 | (sequence & 0x0F))};
+            size_t end = std::min(pdu.size(), offset + 7);
+            consecutive.insert(consecutive.end(), pdu.begin() + offset, pdu.begin() + end);
+            consecutive.resize(8, 0xCC);
+            ASSERT_TRUE(can->injectMessage(CANMessage(source, consecutive, extended)));
+        }
+    }
+
+    std::vector<uint32_t> flowControlIds() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<uint32_t> ids;
+        for (const auto& frame : frames) {
+            if (!frame.data.empty() && (frame.data[0] & 0xF0) == 0x30) {
+                ids.push_back(frame.id);
+            }
+        }
+        return ids;
+    }
+
+    std::shared_ptr<CANProtocol> can;
+    std::unique_ptr<IsoTpTransport> tester;
+
+    std::mutex mutex;
+    std::vector<CANMessage> frames;
+    std::vector<std::pair<uint32_t, std::vector<uint8_t>>> pdus;
+};
+
+} // anonymous namespace
+
+TEST_F(IsoTpFunctionalTest, ElevenBitFlowControlGoesToEachResponder) {
+    IsoTpConfig config;
+    config.txId = 0x7DF;
+    config.rxId = 0x7E8;
+    config.extraRxIds = {0x7E9};
+    open(config);
+
+    ASSERT_TRUE(tester->send({0x09, 0x02}));
+    respond(0x7E8, false, VIN);
+    respond(0x7E9, false, VIN);
+
+    EXPECT_EQ(flowControlIds(), (std::vector<uint32_t>{0x7E0, 0x7E1}));
+    ASSERT_EQ(pdus.size(), 2u);
+    EXPECT_EQ(pdus[0].first, 0x7E8u);
+    EXPECT_EQ(pdus[0].second, VIN);
+    EXPECT_EQ(pdus[1].first, 0x7E9u);
+    EXPECT_EQ(pdus[1].second, VIN);
+}
+
+TEST_F(IsoTpFunctionalTest, TwentyNineBitFlowControlSwapsAddresses) {
+    IsoTpConfig config;
+    config.txId = 0x18DB33F1;
+    config.rxId = 0x18DAF110;
+    config.extraRxIds = {0x18DAF118};
+    config.extendedIds = true;
+    open(config);
+
+    ASSERT_TRUE(tester->send({0x09, 0x02}));
+    respond(0x18DAF118, true, VIN);
+    respond(0x18DAF110, true, VIN);
+
+    EXPECT_EQ(flowControlIds(), (std::vector<uint32_t>{0x18DA18F1, 0x18DA10F1}));
+    ASSERT_EQ(pdus.size(), 2u);
+    EXPECT_EQ(pdus[0].first, 0x18DAF118u);
+    EXPECT_EQ(pdus[1].second, VIN);
+}
+
+TEST_F(IsoTpFunctionalTest, ConfiguredFlowControlIdWinsForTheMainResponder) {
+    IsoTpConfig config;
+    config.txId = 0x7DF;
+    config.rxId = 0x7E8;
+    config.extraRxIds = {0x7EA};
+    config.flowControlId = 0x7A0;
+    open(config);
+
+    respond(0x7E8, false, VIN);
+    respond(0x7EA, false, VIN);
+    EXPECT_EQ(flowControlIds(), (std::vector<uint32_t>{0x7A0, 0x7E2}));
+
+    // Outside the OBD range flow control falls back to txId
+    IsoTpConfig custom;
+    custom.txId = 0x714;
+    custom.rxId = 0x77E;
+    tester.reset();
+    frames.clear();
+    open(custom);
+    respond(0x77E, false, VIN);
+    EXPECT_EQ(flowControlIds(), (std::vector<uint32_t>{0x714}));
+}
+
+TEST(CANListenerTest, ListenerRemovingItselfDoesNotWait) {
+    CANProtocol can;
+    ASSERT_TRUE(can.initialize(CANConfig()));
+
+    int calls = 0;
+    uint32_t id = 0;
+    id = can.addListener([&](const CANMessage&) {
+        ++calls;
+        can.removeListener(id);
+    });
+    ASSERT_NE(id, 0u);
+    ASSERT_TRUE(can.injectMessage(CANMessage(0x123, {0x01})));
+    ASSERT_TRUE(can.injectMessage(CANMessage(0x123, {0x02})));
+    EXPECT_EQ(calls, 1);
+    can.shutdown();
+}
+
+TEST(CANListenerTest, RemoveListenerWaitsForDispatchInFlight) {
+    CANProtocol can;
+    ASSERT_TRUE(can.initialize(CANConfig()));
+
+    std::atomic<bool> entered{false};
+    std::atomic<bool> finished{false};
+    uint32_t id = can.addListener([&](const CANMessage&) {
+        entered = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        finished = true;
+    });
+
+    std::thread injector([&] { can.injectMessage(CANMessage(0x123, {0x01})); });
+    while (!entered) {
+        std::this_thread::yield();
+    }
+    can.removeListener(id);
+    EXPECT_TRUE(finished);
+    injector.join();
+    can.shutdown();
+}
+
+TEST(CANListenerTest, TransportsCanBeDestroyedWhileFramesArrive) {
+    auto can = std::make_shared<CANProtocol>();
+    ASSERT_TRUE(can->initialize(CANConfig()));
+
+    std::atomic<bool> running{true};
+    std::thread injector([&] {
+        const CANMessage single(0x7E8, {0x02, 0x41, 0x00, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC});
+        const CANMessage first(0x7E8, {0x10, 0x14, 0x49, 0x02, 0x01, 'W', 'V', 'W'});
+        while (running) {
+            can->injectMessage(single);
+            can->injectMessage(first);
+        }
+    });
+
+    std::atomic<int> delivered{0};
+    for (int i = 0; i < 200; ++i) {
+        auto transport = std::make_unique<IsoTpTransport>(can, IsoTpConfig());
+        transport->setReceiveHandler([&delivered](uint32_t, const uint8_t*, size_t) { ++delivered; });
+        ASSERT_TRUE(transport->open());
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        transport.reset();
+    }
+
+    running = false;
+    injector.join();
+    EXPECT_GT(delivered, 0);
+    can->shutdown();
+}
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include <fmus/protocols/j1850.h>
+#include <string>
+#include <vector>
+
+using namespace fmus::protocols;
+
+TEST(J1850CrcTest, MatchesSaeJ1850CheckValue) {
+    // CRC-8 SAE J1850: polynomial 0x1D, initial 0xFF, final XOR 0xFF
+    std::string check = "123456789";
+    EXPECT_EQ(calculateJ1850Checksum(std::vector<uint8_t>(check.begin(), check.end())), 0x4B);
+    EXPECT_EQ(calculateJ1850Checksum({}), 0x00);
+}
+
+TEST(J1850CrcTest, MatchesObdFrames) {
+    EXPECT_EQ(calculateJ1850Checksum({0x68, 0x6A, 0xF1, 0x01, 0x00}), 0x17);
+    EXPECT_EQ(calculateJ1850Checksum({0x48, 0x6B, 0x10, 0x41, 0x00, 0xBE, 0x3E, 0xB8, 0x11}), 0xFA);
+    EXPECT_EQ(calculateJ1850Checksum({0x61, 0x6A, 0xF1, 0x01, 0x00}), 0x0A);
+}
+
+TEST(J1850MessageTest, VpwFunctionalRequestFrame) {
+    J1850Message request(0xF1, 0x6A, {0x01, 0x00});
+    EXPECT_EQ(request.toBytes(), std::vector<uint8_t>({0x68, 0x6A, 0xF1, 0x01, 0x00, 0x17}));
+    EXPECT_TRUE(request.verifyChecksum());
+}
+
+TEST(J1850MessageTest, PwmFunctionalRequestFrame) {
+    J1850Message request(0xF1, 0x6A, {0x01, 0x00});
+    request.type = J1850Type::PWM;
+    request.calculateChecksum();
+    EXPECT_EQ(request.toBytes(), std::vector<uint8_t>({0x61, 0x6A, 0xF1, 0x01, 0x00, 0x0A}));
+}
+
+TEST(J1850MessageTest, CorruptedFrameFailsChecksum) {
+    auto message = J1850Message::fromBytes({0x48, 0x6B, 0x10, 0x41, 0x00, 0xBE, 0x3E, 0xB8, 0x11, 0xFA});
+    EXPECT_TRUE(message.verifyChecksum());
+    EXPECT_EQ(message.sourceAddress, 0x10);
+
+    message.data[2] ^= 0x01;
+    EXPECT_FALSE(message.verifyChecksum());
+}
+
+TEST(J1850MessageTest, ReceivedFrameKeepsItsHeader) {
+    // A VPW module asking for an in-frame response: K clear, which our own headers never use
+    std::vector<uint8_t> frame = {0xC4, 0xF1, 0x10, 0x62, 0xF1, 0x90};
+    frame.push_back(calculateJ1850Checksum(frame));
+
+    auto message = J1850Message::fromBytes(frame);
+    message.type = J1850Type::VPW;
+    EXPECT_EQ(static_cast<int>(message.priority), 6);
+    EXPECT_EQ(message.targetAddress, 0xF1);
+    EXPECT_EQ(message.sourceAddress, 0x10);
+    EXPECT_EQ(message.getHeaderByte(), 0xC4);
+    EXPECT_EQ(message.toBytes(), frame);
+    EXPECT_TRUE(message.verifyChecksum());
+}
@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include <fmus/protocols/j1939.h>
+#include <fmus/protocols/can.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace fmus;
+using namespace fmus::protocols;
+
+namespace {
+
+constexpr uint8_t TOOL = 0xF9;
+constexpr uint8_t ENGINE = 0x00;
+constexpr uint32_t VI = 0xFEEC;                 // Vehicle identification, sent with TP
+
+constexpr uint8_t TP_CM_RTS = 16;
+constexpr uint8_t TP_CM_CTS = 17;
+constexpr uint8_t TP_CM_EOMA = 19;
+constexpr uint8_t TP_CM_BAM = 32;
+constexpr uint8_t TP_CM_ABORT = 255;
+
+std::vector<uint8_t> withPGN(std::vector<uint8_t> data, uint32_t pgn) {
+    data.push_back(static_cast<uint8_t>(pgn));
+    data.push_back(static_cast<uint8_t>(pgn >> 8));
+    data.push_back(static_cast<uint8_t>(pgn >> 16));
+    return data;
+}
+
+/**
+ * J1939 stack on a loopback bus; frames from other nodes are injected
+ */
+class J1939Test : public ::testing::Test {
+protected:
+    void SetUp() override {
+        CANConfig canConfig;
+        canConfig.loopback = true;
+        can = std::make_shared<CANProtocol>();
+        ASSERT_TRUE(can->initialize(canConfig));
+        can->addListener([this](const CANMessage& frame) {
+            if (j1939Source(frame.id) == TOOL) {
+                std::lock_guard<std::mutex> lock(mutex);
+                sent.push_back(frame);
+            }
+        });
+
+        J1939Config config;
+        config.claimAddress = false;
+        config.preferredAddress = TOOL;
+        config.packetsPerCTS = 2;
+        ASSERT_TRUE(j1939.initialize(config, can));
+        j1939.addHandler(J1939Protocol::ANY_PGN, [this](const J1939Message& message) {
+            if (message.pgn != J1939PGN::TP_CM && message.pgn != J1939PGN::TP_DT) {
+                std::lock_guard<std::mutex> lock(mutex);
+                received.push_back(message);
+            }
+        });
+    }
+
+    void TearDown() override {
+        j1939.shutdown();
+        can->shutdown();
+    }
+
+    void inject(uint32_t pgn, uint8_t destination, const std::vector<uint8_t>& data, uint8_t priority = 7) {
+        ASSERT_TRUE(can->injectMessage(CANMessage(makeJ1939Id(priority, pgn, destination, ENGINE), data, true)));
+    }
+
+    void injectPackets(uint8_t destination, const std::vector<uint8_t>& payload, uint8_t first, uint8_t last) {
+        for (uint8_t sequence = first; sequence <= last; ++sequence) {
+            std::vector<uint8_t> packet(8, 0xFF);
+            packet[0] = sequence;
+            size_t offset = static_cast<size_t>(sequence - 1) * 7;
+            for (size_t i = 0; i < 7 && offset + i < payload.size(); ++i) {
+                packet[1 + i] = payload[offset + i];
+            }
+            inject(J1939PGN::TP_DT, destination, packet);
+        }
+    }
+
+    std::vector<CANMessage> takeSent() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<CANMessage> result;
+        result.swap(sent);
+        return result;
+    }
+
+    std::shared_ptr<CANProtocol> can;
+    J1939Protocol j1939;
+
+    std::mutex mutex;
+    std::vector<CANMessage> sent;
+    std::vector<J1939Message> received;
+};
+
+} // anonymous namespace
+
+TEST(J1939DiagnosticMessageTest, DecodesLampsAndDTCs) {
+    // MIL on, amber warning on; SPN 100 FMI 1 x5, SPN 0x51234 FMI 3 x1 with the conversion bit
+    const uint8_t dm1[] = {0x44, 0xFF, 0x64, 0x00, 0x01, 0x05, 0x34, 0x12, 0xA3, 0x81};
+    auto message = J1939DiagnosticMessage::fromBytes(dm1, sizeof(dm1));
+
+    EXPECT_EQ(message.lamps.malfunction, 1);
+    EXPECT_EQ(message.lamps.redStop, 0);
+    EXPECT_EQ(message.lamps.amberWarning, 1);
+    EXPECT_EQ(message.lamps.protect, 0);
+    ASSERT_EQ(message.dtcs.size(), 2u);
+    EXPECT_EQ(message.dtcs[0].spn, 100u);
+    EXPECT_EQ(message.dtcs[0].fmi, 1);
+    EXPECT_EQ(message.dtcs[0].occurrenceCount, 5);
+    EXPECT_FALSE(message.dtcs[0].conversionMethod);
+    EXPECT_EQ(message.dtcs[1].spn, 0x51234u);
+    EXPECT_EQ(message.dtcs[1].fmi, 3);
+    EXPECT_EQ(message.dtcs[1].occurrenceCount, 1);
+    EXPECT_TRUE(message.dtcs[1].conversionMethod);
+}
+
+TEST(J1939DiagnosticMessageTest, NoActiveDTCsAndPaddingAreSkipped) {
+    const uint8_t none[] = {0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF};
+    EXPECT_TRUE(J1939DiagnosticMessage::fromBytes(none, sizeof(none)).dtcs.empty());
+
+    const uint8_t padded[] = {0x00, 0xFF, 0x64, 0x00, 0x01, 0x05, 0xFF, 0xFF, 0xFF, 0xFF};
+    EXPECT_EQ(J1939DiagnosticMessage::fromBytes(padded, sizeof(padded)).dtcs.size(), 1u);
+}
+
+TEST(J1939IdTest, PackAndUnpackIdentifier) {
+    uint32_t id = makeJ1939Id(3, J1939PGN::TP_CM, 0x17, 0xF9);
+    EXPECT_EQ(id, 0x0CEC17F9u);
+    EXPECT_EQ(j1939PGN(id), J1939PGN::TP_CM);
+    EXPECT_EQ(j1939Destination(id), 0x17);
+    EXPECT_EQ(j1939Source(id), 0xF9);
+    EXPECT_EQ(j1939Priority(id), 3);
+
+    // PDU2 groups have no destination; the PGN keeps its low byte
+    id = makeJ1939Id(6, J1939PGN::DM1, 0x17, 0x00);
+    EXPECT_EQ(j1939PGN(id), J1939PGN::DM1);
+    EXPECT_EQ(j1939Destination(id), J1939_GLOBAL_ADDRESS);
+}
+
+TEST_F(J1939Test, BroadcastDM1IsReassembled) {
+    const std::vector<uint8_t> dm1 = {0x44, 0xFF, 0x64, 0x00, 0x01, 0x05, 0x34, 0x12,
+                                      0xA3, 0x81, 0x6E, 0x00, 0x04, 0x02};
+    inject(J1939PGN::TP_CM, J1939_GLOBAL_ADDRESS, withPGN({TP_CM_BAM, 14, 0, 2, 0xFF}, J1939PGN::DM1));
+    injectPackets(J1939_GLOBAL_ADDRESS, dm1, 1, 2);
+
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_EQ(received[0].pgn, J1939PGN::DM1);
+    EXPECT_EQ(received[0].source, ENGINE);
+    EXPECT_EQ(received[0].data, dm1);
+    auto decoded = J1939DiagnosticMessage::fromBytes(received[0].data.data(), received[0].data.size());
+    ASSERT_EQ(decoded.dtcs.size(), 3u);
+    EXPECT_EQ(decoded.dtcs[2].spn, 110u);
+    EXPECT_EQ(decoded.dtcs[2].fmi, 4);
+
+    // Nobody answers a broadcast
+    EXPECT_TRUE(takeSent().empty());
+    EXPECT_EQ(j1939.getStatistics().transportSessions, 1u);
+}
+
+TEST_F(J1939Test, SinglePacketDM1IsDeliveredDirectly) {
+    const std::vector<uint8_t> dm1 = {0x04, 0xFF, 0x64, 0x00, 0x01, 0x05, 0xFF, 0xFF};
+    inject(J1939PGN::DM1, J1939_GLOBAL_ADDRESS, dm1, 6);
+
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_EQ(received[0].pgn, J1939PGN::DM1);
+    EXPECT_EQ(received[0].priority, 6);
+    EXPECT_EQ(received[0].data, dm1);
+}
+
+TEST_F(J1939Test, ConnectionModeGrantsWindowsAndAcknowledges) {
+    std::vector<uint8_t> vin(20);
+    for (size_t i = 0; i < vin.size(); ++i) {
+        vin[i] = static_cast<uint8_t>('A' + i);
+    }
+    const uint32_t controlId = makeJ1939Id(7, J1939PGN::TP_CM, ENGINE, TOOL);
+
+    inject(J1939PGN::TP_CM, TOOL, withPGN({TP_CM_RTS, 20, 0, 3, 0xFF}, VI));
+    auto frames = takeSent();
+    ASSERT_EQ(frames.size(), 1u);
+    EXPECT_EQ(frames[0].id, controlId);
+    EXPECT_EQ(frames[0].data, withPGN({TP_CM_CTS, 2, 1, 0xFF, 0xFF}, VI));
+
+    injectPackets(TOOL, vin, 1, 2);
+    frames = takeSent();
+    ASSERT_EQ(frames.size(), 1u);
+    EXPECT_EQ(frames[0].data, withPGN({TP_CM_CTS, 1, 3, 0xFF, 0xFF}, VI));
+    EXPECT_TRUE(received.empty());
+
+    injectPackets(TOOL, vin, 3, 3);
+    frames = takeSent();
+    ASSERT_EQ(frames.size(), 1u);
+    EXPECT_EQ(frames[0].data, withPGN({TP_CM_EOMA, 20, 0, 3, 0xFF}, VI));
+
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_EQ(received[0].pgn, VI);
+    EXPECT_EQ(received[0].destination, TOOL);
+    EXPECT_EQ(received[0].data, vin);
+}
+
+TEST_F(J1939Test, OutOfSequencePacketAbortsSession) {
+    inject(J1939PGN::TP_CM, TOOL, withPGN({TP_CM_RTS, 20, 0, 3, 0xFF}, VI));
+    takeSent();
+
+    injectPackets(TOOL, std::vector<uint8_t>(20, 0x55), 2, 2);
+    auto frames = takeSent();
+    ASSERT_EQ(frames.size(), 1u);
+    EXPECT_EQ(frames[0].data, withPGN({TP_CM_ABORT, 7, 0xFF, 0xFF, 0xFF}, VI));
+    EXPECT_TRUE(received.empty());
+    EXPECT_EQ(j1939.getStatistics().transportAborts, 1u);
+
+    // Later packets of the dropped session are ignored
+    injectPackets(TOOL, std::vector<uint8_t>(20, 0x55), 3, 3);
+    EXPECT_TRUE(takeSent().empty());
+    EXPECT_TRUE(received.empty());
+}
+
+TEST_F(J1939Test, AnnouncementWithWrongPacketCountIsIgnored) {
+    inject(J1939PGN::TP_CM, J1939_GLOBAL_ADDRESS, withPGN({TP_CM_BAM, 14, 0, 3, 0xFF}, J1939PGN::DM1));
+    injectPackets(J1939_GLOBAL_ADDRESS, std::vector<uint8_t>(14, 0x11), 1, 2);
+    EXPECT_TRUE(received.empty());
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <fmus/protocols/kwp2000.h>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace fmus::protocols;
+using namespace std::chrono;
+
+namespace {
+
+/**
+ * Transport whose ECU answers every request with a scripted list of
+ * responses, each after its own delay from the request.
+ */
+class ScriptedTransport : public DiagnosticTransport {
+public:
+    struct Reply {
+        milliseconds delay;
+        std::vector<uint8_t> pdu;
+    };
+
+    ~ScriptedTransport() override {
+        close();
+    }
+
+    bool open() override {
+        opened = true;
+        return true;
+    }
+
+    void close() override {
+        opened = false;
+        for (auto& worker : workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+        workers.clear();
+    }
+
+    bool isOpen() const override {
+        return opened;
+    }
+
+    bool send(const uint8_t*, size_t) override {
+        auto sent = steady_clock::now();
+        workers.emplace_back([this, sent, replies = script] {
+            for (const auto& reply : replies) {
+                std::this_thread::sleep_until(sent + reply.delay);
+                std::lock_guard<std::mutex> lock(handlerMutex);
+                if (handler) {
+                    handler(0x201, reply.pdu.data(), reply.pdu.size());
+                }
+            }
+        });
+        return true;
+    }
+
+    void setReceiveHandler(ReceiveHandler newHandler) override {
+        std::lock_guard<std::mutex> lock(handlerMutex);
+        handler = std::move(newHandler);
+    }
+
+    TransportCapabilities getCapabilities() const override {
+        TransportCapabilities caps;
+        caps.name = "scripted";
+        return caps;
+    }
+
+    std::string toString() const override {
+        return "ScriptedTransport";
+    }
+
+    std::vector<Reply> script;
+
+private:
+    bool opened = false;
+    std::mutex handlerMutex;
+    ReceiveHandler handler;
+    std::vector<std::thread> workers;
+};
+
+class KWP2000TimingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        config.timeout = 2000;
+        config.p2ClientMax = 50;
+        config.p2StarClientMax = 500;
+        ASSERT_TRUE(kwp.initialize(config, transport));
+    }
+
+    void TearDown() override {
+        kwp.shutdown();
+        transport->close();
+    }
+
+    milliseconds timeRequest(KWP2000Message& response) {
+        auto start = steady_clock::now();
+        response = kwp.sendRequest(KWP2000Message(KWP2000Service::TESTER_PRESENT, {0x01}));
+        return duration_cast<milliseconds>(steady_clock::now() - start);
+    }
+
+    KWP2000Config config;
+    std::shared_ptr<ScriptedTransport> transport = std::make_shared<ScriptedTransport>();
+    KWP2000Protocol kwp;
+};
+
+} // anonymous namespace
+
+TEST_F(KWP2000TimingTest, ResponseWithinP2IsAccepted) {
+    transport->script = {{milliseconds(10), {0x7E, 0x01}}};
+
+    KWP2000Message response;
+    timeRequest(response);
+    EXPECT_TRUE(response.isResponse);
+    EXPECT_FALSE(response.isNegativeResponse);
+    EXPECT_EQ(kwp.getStatistics().timeouts, 0u);
+}
+
+TEST_F(KWP2000TimingTest, SilentECUTimesOutAfterP2NotTheLegacyTimeout) {
+    transport->script = {};
+
+    KWP2000Message response;
+    auto elapsed = timeRequest(response);
+    EXPECT_TRUE(response.isNegativeResponse);
+    EXPECT_EQ(kwp.getStatistics().timeouts, 1u);
+    EXPECT_GE(elapsed, milliseconds(config.p2ClientMax));
+    EXPECT_LT(elapsed, milliseconds(config.timeout / 2));
+}
+
+TEST_F(KWP2000TimingTest, LateResponseAfterP2IsATimeout) {
+    transport->script = {{milliseconds(200), {0x7E, 0x01}}};
+
+    KWP2000Message response;
+    timeRequest(response);
+    EXPECT_EQ(kwp.getStatistics().timeouts, 1u);
+}
+
+TEST_F(KWP2000TimingTest, ResponsePendingExtendsToP2Star) {
+    transport->script = {{milliseconds(10), {0x7F, 0x3E, 0x78}},
+                         {milliseconds(200), {0x7E, 0x01}}};
+
+    KWP2000Message response;
+    auto elapsed = timeRequest(response);
+    EXPECT_TRUE(response.isResponse);
+    EXPECT_EQ(kwp.getStatistics().responsePending, 1u);
+    EXPECT_EQ(kwp.getStatistics().timeouts, 0u);
+    EXPECT_GE(elapsed, milliseconds(200));
+}
+
+TEST(KWP2000FrameTest, EncodeAndDecodeWithAddressHeader) {
+    auto frame = encodeKWP2000Frame({0x3E, 0x01}, true, false, 0x33, 0xF1);
+    ASSERT_EQ(frame, std::vector<uint8_t>({0x82, 0x33, 0xF1, 0x3E, 0x01, 0xE5}));
+
+    std::vector<uint8_t> payload;
+    uint8_t target = 0;
+    uint8_t source = 0;
+    ASSERT_TRUE(decodeKWP2000Frame(frame, payload, &target, &source));
+    EXPECT_EQ(payload, std::vector<uint8_t>({0x3E, 0x01}));
+    EXPECT_EQ(target, 0x33);
+    EXPECT_EQ(source, 0xF1);
+
+    frame.back() ^= 0xFF;
+    EXPECT_FALSE(decodeKWP2000Frame(frame, payload));
+}
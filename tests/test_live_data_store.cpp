@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <fmus/live_data_store.h>
+#include <fmus/gui/plot_decimator.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace fmus;
+using namespace fmus::gui;
+
+TEST(LiveDataStoreTest, ChannelsAreAddedOnceUpToTheLimit) {
+    LiveDataStore store(16, 2);
+    auto soc = store.addChannel("soc", "%");
+    EXPECT_EQ(store.addChannel("soc"), soc);
+    auto voltage = store.addChannel("pack_voltage", "V");
+    EXPECT_NE(voltage, soc);
+    EXPECT_EQ(store.addChannel("current", "A"), LiveDataStore::INVALID_CHANNEL);
+
+    EXPECT_EQ(store.getChannelCount(), 2u);
+    EXPECT_EQ(store.findChannel("pack_voltage"), voltage);
+    EXPECT_EQ(store.findChannel("current"), LiveDataStore::INVALID_CHANNEL);
+    EXPECT_EQ(store.getChannelUnit(soc), "%");
+    EXPECT_EQ(store.getHistoryCapacity(), 16u);
+
+    LiveSample sample;
+    EXPECT_FALSE(store.readLatest(soc, sample));
+    EXPECT_FALSE(store.publish("current", 1.0));
+    EXPECT_TRUE(store.publish("soc", 81.5));
+    EXPECT_TRUE(store.readLatest(soc, sample));
+    EXPECT_DOUBLE_EQ(sample.value, 81.5);
+}
+
+TEST(LiveDataStoreTest, HistoryResumesFromTheReadersSequence) {
+    LiveDataStore store(8, 4);
+    auto soc = store.addChannel("soc");
+    for (int i = 0; i < 5; ++i) {
+        store.publish(soc, i, 1000 + i);
+    }
+
+    std::vector<LiveSample> samples;
+    uint64_t next = store.readHistory(soc, 0, samples);
+    EXPECT_EQ(next, 5u);
+    ASSERT_EQ(samples.size(), 5u);
+    EXPECT_EQ(samples.front().timestampUs, 1000);
+
+    samples.clear();
+    EXPECT_EQ(store.readHistory(soc, next, samples), 5u);
+    EXPECT_TRUE(samples.empty());
+
+    // A reader that fell behind the ring starts at the oldest sample kept
+    for (int i = 5; i < 20; ++i) {
+        store.publish(soc, i, 1000 + i);
+    }
+    next = store.readHistory(soc, next, samples);
+    EXPECT_EQ(next, 20u);
+    ASSERT_EQ(samples.size(), 8u);
+    EXPECT_DOUBLE_EQ(samples.front().value, 12.0);
+    EXPECT_DOUBLE_EQ(samples.back().value, 19.0);
+    EXPECT_EQ(store.getSequence(soc), 20u);
+
+    uint64_t sequence = 0;
+    LiveSample latest;
+    ASSERT_TRUE(store.readLatest(soc, latest, &sequence));
+    EXPECT_EQ(sequence, 20u);
+    EXPECT_EQ(latest.timestampUs, 1019);
+}
+
+TEST(LiveDataStoreTest, ReadersNeverSeeTornSamples) {
+    constexpr int CHANNELS = 4;
+    constexpr int64_t SAMPLES = 200000;
+    LiveDataStore store(64, CHANNELS);
+    std::vector<LiveDataStore::ChannelId> ids;
+    for (int c = 0; c < CHANNELS; ++c) {
+        ids.push_back(store.addChannel("channel" + std::to_string(c)));
+    }
+
+    // Every sample carries its value in its timestamp, so a mix of two writes shows
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (int64_t i = 1; i <= SAMPLES; ++i) {
+            for (auto id : ids) {
+                store.publish(id, static_cast<double>(i), i);
+            }
+        }
+        done = true;
+    });
+
+    std::vector<uint64_t> sequences(CHANNELS, 0);
+    std::vector<int64_t> newest(CHANNELS, 0);
+    std::vector<LiveSample> samples;
+    bool finished = false;
+    while (!finished) {
+        finished = done;
+        for (int c = 0; c < CHANNELS; ++c) {
+            samples.clear();
+            sequences[c] = store.readHistory(ids[c], sequences[c], samples);
+            for (const auto& sample : samples) {
+                ASSERT_DOUBLE_EQ(sample.value, static_cast<double>(sample.timestampUs));
+                ASSERT_GT(sample.timestampUs, newest[c]);
+                newest[c] = sample.timestampUs;
+            }
+            LiveSample latest;
+            if (store.readLatest(ids[c], latest)) {
+                ASSERT_DOUBLE_EQ(latest.value, static_cast<double>(latest.timestampUs));
+            }
+        }
+    }
+    writer.join();
+    for (int c = 0; c < CHANNELS; ++c) {
+        EXPECT_EQ(newest[c], SAMPLES);
+    }
+}
+
+TEST(PlotDecimatorTest, ColumnsKeepMinMaxFirstAndLast) {
+    PlotDecimator plot(10, std::chrono::microseconds(10000));
+    std::vector<LiveSample> samples;
+    for (int64_t t = 0; t < 10000; t += 10) {
+        samples.push_back({t, static_cast<double>((t * 7919) % 1000)});
+    }
+    plot.add(samples);
+
+    std::vector<PlotColumn> columns;
+    plot.getColumns(columns);
+    ASSERT_EQ(columns.size(), 10u);
+    for (size_t c = 0; c < columns.size(); ++c) {
+        auto begin = samples.begin() + c * 100;
+        auto end = begin + 100;
+        auto range = std::minmax_element(begin, end, [](const LiveSample& a, const LiveSample& b) {
+            return a.value < b.value;
+        });
+        EXPECT_EQ(columns[c].count, 100u) << "column " << c;
+        EXPECT_DOUBLE_EQ(columns[c].min, range.first->value) << "column " << c;
+        EXPECT_DOUBLE_EQ(columns[c].max, range.second->value) << "column " << c;
+        EXPECT_DOUBLE_EQ(columns[c].first, begin->value) << "column " << c;
+        EXPECT_DOUBLE_EQ(columns[c].last, (end - 1)->value) << "column " << c;
+    }
+
+    double min = 0.0;
+    double max = 0.0;
+    ASSERT_TRUE(plot.getRange(min, max));
+    auto all = std::minmax_element(samples.begin(), samples.end(), [](const LiveSample& a, const LiveSample& b) {
+        return a.value < b.value;
+    });
+    EXPECT_DOUBLE_EQ(min, all.first->value);
+    EXPECT_DOUBLE_EQ(max, all.second->value);
+}
+
+TEST(PlotDecimatorTest, ScrollingDropsOldColumns) {
+    PlotDecimator plot(10, std::chrono::microseconds(10000));
+    for (int64_t t = 0; t < 10000; t += 1000) {
+        plot.add({t, static_cast<double>(t / 1000)});
+    }
+    plot.advanceTo(15500);
+    EXPECT_EQ(plot.getEndTime(), 16000);
+
+    std::vector<PlotColumn> columns;
+    plot.getColumns(columns);
+    for (size_t c = 0; c < 4; ++c) {
+        EXPECT_EQ(columns[c].count, 1u);
+        EXPECT_DOUBLE_EQ(columns[c].first, 6.0 + c);
+    }
+    for (size_t c = 4; c < 10; ++c) {
+        EXPECT_EQ(columns[c].count, 0u) << "column " << c;
+    }
+
+    // Late samples land in their column while it is visible and are ignored after
+    plot.add({7500, 100.0});
+    plot.add({2000, -100.0});
+    plot.getColumns(columns);
+    EXPECT_DOUBLE_EQ(columns[1].max, 100.0);
+    double min = 0.0;
+    double max = 0.0;
+    ASSERT_TRUE(plot.getRange(min, max));
+    EXPECT_DOUBLE_EQ(min, 6.0);
+
+    // A jump longer than the plot clears it
+    plot.advanceTo(100000);
+    EXPECT_FALSE(plot.getRange(min, max));
+}
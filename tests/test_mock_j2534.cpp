@@ -0,0 +1,264 @@
+#include "test_mock_j2534.h"
+#include <fmus/j2534/library_loader.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * Minimal J2534 library for the protocol detector tests. Each channel
+ * answers an OBD mode $01 PID $00 request, or a 5-baud init, if the
+ * simulated vehicle speaks that protocol at that rate.
+ */
+
+using namespace fmus::j2534;
+
+namespace {
+
+constexpr long STATUS_NOERROR = 0x00;
+constexpr long ERR_INVALID_CHANNEL_ID = 0x02;
+constexpr long ERR_FAILED = 0x07;
+constexpr long ERR_TIMEOUT = 0x09;
+constexpr long ERR_BUFFER_EMPTY = 0x10;
+
+const std::vector<unsigned char> SUPPORTED_PIDS = {0x41, 0x00, 0xBE, 0x1F, 0xA8, 0x13};
+
+struct Channel {
+    unsigned long protocolId = 0;
+    unsigned long flags = 0;
+    unsigned long baudRate = 0;
+    std::deque<PASSTHRU_MSG> received;
+};
+
+struct State {
+    std::mutex mutex;
+    std::condition_variable arrived;
+    MockJ2534Vehicle vehicle{};
+    MockJ2534Counters counters{};
+    std::map<unsigned long, Channel> channels;
+    std::map<std::pair<unsigned long, unsigned long>, unsigned long> setConfigs;
+    unsigned long nextChannelId = 1;
+};
+
+State& state() {
+    static State instance;
+    return instance;
+}
+
+bool isKLine(unsigned long protocolId) {
+    return protocolId == J2534Constants::ISO9141 || protocolId == J2534Constants::ISO14230_4;
+}
+
+PASSTHRU_MSG makeMessage(unsigned long protocolId, unsigned long rxStatus, const std::vector<unsigned char>& data) {
+    PASSTHRU_MSG message{};
+    message.ProtocolID = protocolId;
+    message.RxStatus = rxStatus;
+    message.DataSize = static_cast<unsigned long>(data.size());
+    std::memcpy(message.Data, data.data(), data.size());
+    return message;
+}
+
+// Caller holds the state mutex
+void answer(Channel& channel, const PASSTHRU_MSG& request) {
+    const MockJ2534Vehicle& vehicle = state().vehicle;
+    if (vehicle.protocolId != channel.protocolId || vehicle.baudRate != channel.baudRate) {
+        return;
+    }
+
+    if (channel.protocolId == J2534Constants::CAN) {
+        bool extended = (request.TxFlags & J2534Constants::CAN_29BIT_ID) != 0;
+        bool listening = (channel.flags & J2534Constants::CAN_ID_BOTH) ||
+                         ((channel.flags & J2534Constants::CAN_29BIT_ID) != 0) == extended;
+        if (extended != vehicle.extendedIds || !listening || request.DataSize < 7 ||
+            request.Data[5] != 0x01 || request.Data[6] != 0x00) {
+            return;
+        }
+        std::vector<unsigned char> reply = extended ? std::vector<unsigned char>{0x18, 0xDA, 0xF1, 0x10}
+                                                    : std::vector<unsigned char>{0x00, 0x00, 0x07, 0xE8};
+        reply.push_back(static_cast<unsigned char>(SUPPORTED_PIDS.size()));
+        reply.insert(reply.end(), SUPPORTED_PIDS.begin(), SUPPORTED_PIDS.end());
+        reply.push_back(0x00);
+        channel.received.push_back(makeMessage(channel.protocolId, extended ? J2534Constants::CAN_29BIT_ID : 0, reply));
+    } else if (request.DataSize >= 5 && request.Data[3] == 0x01 && request.Data[4] == 0x00) {
+        // J1850: priority, target, source, then the response
+        std::vector<unsigned char> reply = {0x48, 0x6B, 0x10};
+        reply.insert(reply.end(), SUPPORTED_PIDS.begin(), SUPPORTED_PIDS.end());
+        channel.received.push_back(makeMessage(channel.protocolId, 0, reply));
+    }
+}
+
+} // anonymous namespace
+
+extern "C" {
+
+void MockJ2534Reset(const MockJ2534Vehicle* vehicle) {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    state().vehicle = *vehicle;
+    state().counters = MockJ2534Counters{};
+    state().channels.clear();
+    state().setConfigs.clear();
+}
+
+void MockJ2534GetCounters(MockJ2534Counters* counters) {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    *counters = state().counters;
+}
+
+bool MockJ2534GetSetConfig(unsigned long protocolId, unsigned long parameter, unsigned long* value) {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    auto it = state().setConfigs.find({protocolId, parameter});
+    if (it == state().setConfigs.end()) {
+        return false;
+    }
+    *value = it->second;
+    return true;
+}
+
+FMUS_AUTO_API long PassThruOpen(void* /*name*/, unsigned long* deviceId) {
+    *deviceId = 1;
+    return STATUS_NOERROR;
+}
+
+FMUS_AUTO_API long PassThruClose(unsigned long /*deviceId*/) {
+    return STATUS_NOERROR;
+}
+
+FMUS_AUTO_API long PassThruConnect(unsigned long /*deviceId*/, unsigned long protocolId, unsigned long flags,
+                                   unsigned long baudRate, unsigned long* channelId) {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    *channelId = state().nextChannelId++;
+    Channel& channel = state().channels[*channelId];
+    channel.protocolId = protocolId;
+    channel.flags = flags;
+    channel.baudRate = baudRate;
+    state().counters.connects++;
+    return STATUS_NOERROR;
+}
+
+FMUS_AUTO_API long PassThruDisconnect(unsigned long channelId) {
+    // Channels dropped by MockJ2534Reset still disconnect cleanly
+    std::lock_guard<std::mutex> lock(state().mutex);
+    state().channels.erase(channelId);
+    state().arrived.notify_all();
+    return STATUS_NOERROR;
+}
+
+FMUS_AUTO_API long PassThruReadMsgs(unsigned long channelId, void* messages, unsigned long* count,
+                                    unsigned long timeout) {
+    std::unique_lock<std::mutex> lock(state().mutex);
+    auto ready = [channelId] {
+        auto it = state().channels.find(channelId);
+        return it == state().channels.end() || !it->second.received.empty();
+    };
+    state().arrived.wait_for(lock, std::chrono::milliseconds(timeout), ready);
+
+    auto it = state().channels.find(channelId);
+    if (it == state().channels.end()) {
+        *count = 0;
+        return ERR_INVALID_CHANNEL_ID;
+    }
+    auto* out = static_cast<PASSTHRU_MSG*>(messages);
+    unsigned long read = 0;
+    while (read < *count && !it->second.received.empty()) {
+        out[read++] = it->second.received.front();
+        it->second.received.pop_front();
+    }
+    *count = read;
+    return read ? STATUS_NOERROR : ERR_BUFFER_EMPTY;
+}
+
+FMUS_AUTO_API long PassThruWriteMsgs(unsigned long channelId, void* messages, unsigned long* count,
+                                     unsigned long /*timeout*/) {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    auto it = state().channels.find(channelId);
+    if (it == state().channels.end()) {
+        return ERR_INVALID_CHANNEL_ID;
+    }
+    const auto* in = static_cast<const PASSTHRU_MSG*>(messages);
+    for (unsigned long i = 0; i < *count; ++i) {
+        answer(it->second, in[i]);
+    }
+    state().arrived.notify_all();
+    return STATUS_NOERROR;
+}
+
+FMUS_AUTO_API long PassThruStartPeriodicMsg(unsigned long, void*, unsigned long* messageId, unsigned long) {
+    *messageId = 1;
+    return STATUS_NOERROR;
+}
+
+FMUS_AUTO_API long PassThruStopPeriodicMsg(unsigned long, unsigned long) {
+    return STATUS_NOERROR;
+}
+
+FMUS_AUTO_API long PassThruStartMsgFilter(unsigned long, unsigned long, void*, void*, void*, unsigned long* filterId) {
+    *filterId = 1;
+    return STATUS_NOERROR;
+}
+
+FMUS_AUTO_API long PassThruStopMsgFilter(unsigned long, unsigned long) {
+    return STATUS_NOERROR;
+}
+
+FMUS_AUTO_API long PassThruSetProgrammingVoltage(unsigned long, unsigned long, unsigned long) {
+    return STATUS_NOERROR;
+}
+
+FMUS_AUTO_API long PassThruReadVersion(unsigned long, char* firmware, char* dll, char* api) {
+    std::strcpy(firmware, "mock");
+    std::strcpy(dll, "mock");
+    std::strcpy(api, "04.04");
+    return STATUS_NOERROR;
+}
+
+FMUS_AUTO_API long PassThruGetLastError(char* description) {
+    std::strcpy(description, "mock J2534 error");
+    return STATUS_NOERROR;
+}
+
+FMUS_AUTO_API long PassThruIoctl(unsigned long channelId, unsigned long ioctlId, void* input, void* output) {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    if (ioctlId == J2534Constants::READ_VBATT) {
+        *static_cast<unsigned long*>(output) = 12000;
+        return STATUS_NOERROR;
+    }
+
+    auto it = state().channels.find(channelId);
+    if (it == state().channels.end()) {
+        return ERR_INVALID_CHANNEL_ID;
+    }
+    Channel& channel = it->second;
+
+    switch (ioctlId) {
+        case J2534Constants::SET_CONFIG: {
+            auto* list = static_cast<SCONFIG_LIST*>(input);
+            for (unsigned long i = 0; i < list->NumOfParams; ++i) {
+                state().setConfigs[{channel.protocolId, list->ConfigPtr[i].Parameter}] = list->ConfigPtr[i].Value;
+                state().counters.setConfigs++;
+            }
+            return STATUS_NOERROR;
+        }
+        case J2534Constants::FIVE_BAUD_INIT: {
+            state().counters.fiveBaudInits++;
+            // Any K-line ECU wakes on the init, whichever framing the channel uses
+            if (!isKLine(channel.protocolId) || !isKLine(state().vehicle.protocolId)) {
+                return ERR_TIMEOUT;
+            }
+            auto* keyBytes = static_cast<SBYTE_ARRAY*>(output);
+            keyBytes->NumOfBytes = 2;
+            keyBytes->BytePtr[0] = state().vehicle.keyBytes[0];
+            keyBytes->BytePtr[1] = state().vehicle.keyBytes[1];
+            return STATUS_NOERROR;
+        }
+        case J2534Constants::FAST_INIT:
+            return ERR_FAILED;
+        default:
+            return STATUS_NOERROR;
+    }
+}
+
+}
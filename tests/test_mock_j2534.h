@@ -0,0 +1,46 @@
+#ifndef FMUS_TEST_MOCK_J2534_H
+#define FMUS_TEST_MOCK_J2534_H
+
+/**
+ * Control interface of the mock J2534 library (test_mock_j2534.cpp). The
+ * library answers OBD requests the way one simulated vehicle would; tests
+ * link against it and load the same file through PassThruDevice::open.
+ */
+
+/**
+ * The vehicle behind the mock adapter
+ */
+struct MockJ2534Vehicle {
+    unsigned long protocolId;       ///< J2534 protocol the vehicle speaks; 0 = nothing answers
+    unsigned long baudRate;         ///< CAN and J1850 bit rate
+    bool extendedIds;               ///< CAN: 29-bit IDs
+    unsigned char keyBytes[2];      ///< K-line: answer to a 5-baud init
+};
+
+/**
+ * What the library was asked to do since the last reset
+ */
+struct MockJ2534Counters {
+    unsigned long connects;
+    unsigned long fiveBaudInits;
+    unsigned long setConfigs;
+};
+
+extern "C" {
+
+/**
+ * Replace the vehicle, drop open channels and zero the counters
+ */
+void MockJ2534Reset(const MockJ2534Vehicle* vehicle);
+
+void MockJ2534GetCounters(MockJ2534Counters* counters);
+
+/**
+ * Last value set for a parameter on a channel of the given protocol
+ * @return false if it was never set
+ */
+bool MockJ2534GetSetConfig(unsigned long protocolId, unsigned long parameter, unsigned long* value);
+
+}
+
+#endif // FMUS_TEST_MOCK_J2534_H
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <fmus/plugins/plugin_manager.h>
+#include <fmus/plugins/plugin_host.h>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace fmus::plugins;
+namespace fs = std::filesystem;
+
+namespace {
+
+/**
+ * Writes a manifest for the echo plugin library into a scratch directory.
+ * The test binary doubles as the plugin host executable (see main).
+ */
+class PluginManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory = fs::temp_directory_path() / ("fmus_plugin_test_" + std::to_string(::getpid()));
+        fs::create_directories(directory);
+        ::setenv("FMUS_PLUGIN_HOST", fs::read_symlink("/proc/self/exe").c_str(), 1);
+
+        manager = PluginManager::getInstance();
+        manager->initialize(nullptr);
+        manager->resetStatistics();
+    }
+
+    void TearDown() override {
+        manager->setHotReloadEnabled(false);
+        manager->shutdown();
+        std::error_code ec;
+        fs::remove_all(directory, ec);
+    }
+
+    std::string writeManifest(bool isolated, bool lazy = true, const std::string& dependencies = "") {
+        fs::path path = directory / "echo.plugin";
+        std::ofstream file(path);
+        file << "name = echo\n"
+             << "version = 1.0.0\n"
+             << "library = " << TEST_ECHO_PLUGIN << "\n"
+             << "isolated = " << (isolated ? "true" : "false") << "\n"
+             << "lazy = " << (lazy ? "true" : "false") << "\n";
+        if (!dependencies.empty()) {
+            file << "dependencies = " << dependencies << "\n";
+        }
+        return path.string();
+    }
+
+    fs::path directory;
+    PluginManager* manager = nullptr;
+};
+
+} // anonymous namespace
+
+TEST_F(PluginManagerTest, IsolatedPluginIsNotReloadedWhileLibraryIsUnchanged) {
+    manager->setHotReloadEnabled(true, std::chrono::milliseconds(10));
+
+    auto result = manager->loadPlugin(writeManifest(true));
+    ASSERT_TRUE(result.success) << result.errorMessage;
+
+    auto remote = std::dynamic_pointer_cast<RemotePlugin>(result.plugin);
+    ASSERT_NE(remote, nullptr);
+
+    // Long enough for the watcher to confirm a change several times over
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    EXPECT_EQ(manager->getStatistics().pluginsReloaded, 0u);
+    EXPECT_EQ(manager->getPlugin("echo"), result.plugin);
+    EXPECT_EQ(remote->getHost().getStatistics().restarts, 0u);
+    EXPECT_EQ(manager->executeCommand("echo", "ping", {}), "ping");
+}
+
+TEST_F(PluginManagerTest, InProcessPluginRunsCommands) {
+    auto result = manager->loadPlugin(writeManifest(false));
+    ASSERT_TRUE(result.success) << result.errorMessage;
+    EXPECT_TRUE(manager->isPluginLoaded("echo"));
+    EXPECT_EQ(manager->executeCommand("echo", "ping", {}), "ping");
+    EXPECT_TRUE(manager->unloadPlugin("echo"));
+    EXPECT_FALSE(manager->isPluginLoaded("echo"));
+}
+
+TEST_F(PluginManagerTest, FailedEagerPluginCanBeLoadedAgain) {
+    writeManifest(false, false, "absent");
+    auto results = manager->loadPluginsFromDirectory(directory.string());
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_FALSE(results[0].success);
+    EXPECT_FALSE(manager->isPluginLoaded("echo"));
+
+    // The failed record is gone, so a corrected manifest is not "already loaded"
+    writeManifest(false, false);
+    results = manager->loadPluginsFromDirectory(directory.string());
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_TRUE(results[0].success) << results[0].errorMessage;
+    EXPECT_EQ(manager->executeCommand("echo", "ping", {}), "ping");
+}
+
+TEST(PluginHostTest, RefusesToStartWithoutHostExecutable) {
+    PluginHostConfig config;
+    config.libraryPath = TEST_ECHO_PLUGIN;
+    config.hostExecutable.clear();
+
+    PluginHost host(config);
+    EXPECT_FALSE(host.start());
+    EXPECT_FALSE(host.isRunning());
+    EXPECT_FALSE(host.getLastError().empty());
+}
+
+int main(int argc, char* argv[]) {
+    // Started by PluginHost as the out-of-process host for isolated plugins
+    if (argc > 1 && std::string(argv[1]) == "--shm") {
+        return runPluginHost(argc, argv);
+    }
+
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
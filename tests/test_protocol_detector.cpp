@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+#include "test_mock_j2534.h"
+#include <fmus/diagnostics/protocol_detector.h>
+#include <fmus/j2534/channel.h>
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace fmus;
+using namespace fmus::diagnostics;
+namespace fs = std::filesystem;
+
+namespace {
+
+MockJ2534Vehicle canVehicle(uint32_t baudRate, bool extended) {
+    return MockJ2534Vehicle{j2534::J2534Constants::CAN, baudRate, extended, {0, 0}};
+}
+
+MockJ2534Vehicle kLineVehicle(unsigned char kb1, unsigned char kb2) {
+    return MockJ2534Vehicle{j2534::J2534Constants::ISO9141, 10400, false, {kb1, kb2}};
+}
+
+/**
+ * A detector on the mock adapter with short timeouts
+ */
+class ProtocolDetectorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        device = std::make_shared<j2534::PassThruDevice>();
+        ASSERT_TRUE(device->open(TEST_MOCK_J2534)) << device->getLastError();
+        detector = std::make_unique<ProtocolDetector>(device);
+
+        DetectorConfig config;
+        config.canTimeout = std::chrono::milliseconds(50);
+        config.serialTimeout = std::chrono::milliseconds(50);
+        config.kLineDelay = std::chrono::milliseconds(20);
+        detector->setConfig(config);
+    }
+
+    void TearDown() override {
+        detector.reset();
+        device->close();
+    }
+
+    void useVehicle(const MockJ2534Vehicle& vehicle) {
+        MockJ2534Reset(&vehicle);
+    }
+
+    void useCandidates(std::vector<OBDProtocol> candidates) {
+        DetectorConfig config = detector->getConfig();
+        config.candidates = std::move(candidates);
+        detector->setConfig(config);
+    }
+
+    MockJ2534Counters counters() {
+        MockJ2534Counters result{};
+        MockJ2534GetCounters(&result);
+        return result;
+    }
+
+    std::shared_ptr<j2534::PassThruDevice> device;
+    std::unique_ptr<ProtocolDetector> detector;
+};
+
+} // anonymous namespace
+
+TEST(ProtocolPriorsTest, OrdersByVinThenRegionalCount) {
+    ProtocolPriors priors;
+    const std::vector<OBDProtocol> defaults = {OBDProtocol::CAN_11BIT_500K, OBDProtocol::CAN_29BIT_500K,
+                                               OBDProtocol::ISO9141_2, OBDProtocol::J1850_VPW};
+
+    // Nothing learned yet: the default order stands
+    EXPECT_EQ(priors.order(defaults, "", "US"), defaults);
+
+    priors.record("", "US", OBDProtocol::J1850_VPW);
+    priors.record("", "US", OBDProtocol::J1850_VPW);
+    priors.record("", "US", OBDProtocol::ISO9141_2);
+    priors.record("1FTEST00000000001", "EU", OBDProtocol::CAN_29BIT_500K);
+
+    auto ordered = priors.order(defaults, "", "US");
+    EXPECT_EQ(ordered, (std::vector<OBDProtocol>{OBDProtocol::J1850_VPW, OBDProtocol::ISO9141_2,
+                                                 OBDProtocol::CAN_11BIT_500K, OBDProtocol::CAN_29BIT_500K}));
+
+    // The VIN's protocol goes first whatever the region says
+    ordered = priors.order(defaults, "1FTEST00000000001", "US");
+    EXPECT_EQ(ordered.front(), OBDProtocol::CAN_29BIT_500K);
+    EXPECT_EQ(ordered[1], OBDProtocol::J1850_VPW);
+
+    // Other regions are untouched
+    EXPECT_EQ(priors.order(defaults, "", "JP"), defaults);
+    EXPECT_EQ(priors.lookup("1FTEST00000000001"), OBDProtocol::CAN_29BIT_500K);
+    EXPECT_EQ(priors.lookup("unknown"), OBDProtocol::UNKNOWN);
+}
+
+TEST(ProtocolPriorsTest, TiesKeepTheGivenOrder) {
+    ProtocolPriors priors;
+    priors.record("", "", OBDProtocol::CAN_11BIT_250K);
+    priors.record("", "", OBDProtocol::J1850_PWM);
+
+    const std::vector<OBDProtocol> defaults = {OBDProtocol::KWP2000_FAST_INIT, OBDProtocol::J1850_PWM,
+                                               OBDProtocol::ISO9141_2, OBDProtocol::CAN_11BIT_250K};
+    EXPECT_EQ(priors.order(defaults, "", ""),
+              (std::vector<OBDProtocol>{OBDProtocol::J1850_PWM, OBDProtocol::CAN_11BIT_250K,
+                                        OBDProtocol::KWP2000_FAST_INIT, OBDProtocol::ISO9141_2}));
+}
+
+TEST(ProtocolPriorsTest, FileRoundTrip) {
+    const std::string path =
+        (fs::temp_directory_path() / ("fmus_priors_" + std::to_string(::getpid()) + ".txt")).string();
+
+    ProtocolPriors priors;
+    priors.record("WVWZZZ1JZXW000001", "EU", OBDProtocol::KWP2000_FAST_INIT);
+    priors.record("", "EU", OBDProtocol::CAN_11BIT_500K);
+    priors.record("", "", OBDProtocol::J1850_PWM);
+    ASSERT_TRUE(priors.saveToFile(path));
+
+    ProtocolPriors loaded;
+    loaded.record("stale", "US", OBDProtocol::ISO9141_2);
+    ASSERT_TRUE(loaded.loadFromFile(path));
+    EXPECT_EQ(loaded.lookup("WVWZZZ1JZXW000001"), OBDProtocol::KWP2000_FAST_INIT);
+    EXPECT_EQ(loaded.lookup("stale"), OBDProtocol::UNKNOWN);
+    EXPECT_EQ(loaded.getRegionCounts("EU"), priors.getRegionCounts("EU"));
+    EXPECT_EQ(loaded.getRegionCounts(""), priors.getRegionCounts(""));
+    EXPECT_EQ(loaded.getRegionCounts("US"), (std::array<uint32_t, OBD_PROTOCOL_COUNT>{}));
+
+    fs::remove(path);
+    EXPECT_FALSE(loaded.loadFromFile(path));
+}
+
+TEST_F(ProtocolDetectorTest, FindsCanVehicles) {
+    useVehicle(canVehicle(500000, false));
+    DetectionResult result = detector->detect();
+    ASSERT_EQ(result.protocol, OBDProtocol::CAN_11BIT_500K) << result.toString();
+    EXPECT_EQ(result.responders, std::vector<uint32_t>{0x7E8});
+    ASSERT_NE(result.channel, nullptr);
+    EXPECT_TRUE(result.channel->isConnected());
+
+    useVehicle(canVehicle(250000, true));
+    result = detector->detect();
+    ASSERT_EQ(result.protocol, OBDProtocol::CAN_29BIT_250K) << result.toString();
+    EXPECT_EQ(result.responders, std::vector<uint32_t>{0x18DAF110});
+    EXPECT_EQ(detector->getStatistics().detections, 2u);
+}
+
+TEST_F(ProtocolDetectorTest, FindsJ1850Vehicles) {
+    useVehicle(MockJ2534Vehicle{j2534::J2534Constants::J1850VPW, 10400, false, {0, 0}});
+    DetectionResult result = detector->detect();
+    ASSERT_EQ(result.protocol, OBDProtocol::J1850_VPW) << result.toString();
+    EXPECT_EQ(result.responders, std::vector<uint32_t>{0x10});
+}
+
+TEST_F(ProtocolDetectorTest, OneFiveBaudInitTellsIso9141FromKwp) {
+    // KWP2000 is tried first, but the ISO 9141-2 key bytes settle it in one init
+    useCandidates({OBDProtocol::KWP2000_5BAUD_INIT, OBDProtocol::ISO9141_2});
+    useVehicle(kLineVehicle(0x08, 0x08));
+    DetectionResult result = detector->detect();
+    ASSERT_EQ(result.protocol, OBDProtocol::ISO9141_2) << result.toString();
+    EXPECT_EQ(result.keyBytes, (std::vector<uint8_t>{0x08, 0x08}));
+    ASSERT_NE(result.channel, nullptr);
+    EXPECT_EQ(result.channel->getProtocol(), j2534::Protocol::ISO9141);
+    EXPECT_EQ(counters().fiveBaudInits, 1u);
+
+    useVehicle(kLineVehicle(0xE9, 0x8F));
+    result = detector->detect();
+    ASSERT_EQ(result.protocol, OBDProtocol::KWP2000_5BAUD_INIT) << result.toString();
+    EXPECT_EQ(result.channel->getProtocol(), j2534::Protocol::ISO14230_4);
+    EXPECT_EQ(counters().fiveBaudInits, 1u);
+
+    // No answer: the second 5-baud protocol does not repeat the init
+    useVehicle(MockJ2534Vehicle{});
+    result = detector->detect();
+    EXPECT_FALSE(result.success());
+    EXPECT_EQ(counters().fiveBaudInits, 1u);
+}
+
+TEST_F(ProtocolDetectorTest, KnownVinIsTriedAlone) {
+    useVehicle(canVehicle(250000, false));
+    ASSERT_EQ(detector->detect("VIN0000000000001").protocol, OBDProtocol::CAN_11BIT_250K);
+    EXPECT_EQ(detector->getPriors()->lookup("VIN0000000000001"), OBDProtocol::CAN_11BIT_250K);
+
+    useVehicle(canVehicle(250000, false));
+    DetectionResult result = detector->detect("VIN0000000000001");
+    EXPECT_EQ(result.protocol, OBDProtocol::CAN_11BIT_250K);
+    EXPECT_EQ(result.probed, std::vector<OBDProtocol>{OBDProtocol::CAN_11BIT_250K});
+    EXPECT_EQ(counters().connects, 1u);
+    EXPECT_EQ(detector->getStatistics().cacheHits, 1u);
+}
+
+TEST_F(ProtocolDetectorTest, NothingAnswering) {
+    useCandidates({OBDProtocol::CAN_11BIT_500K, OBDProtocol::CAN_29BIT_500K, OBDProtocol::J1850_PWM});
+    useVehicle(MockJ2534Vehicle{});
+    DetectionResult result = detector->detect();
+    EXPECT_FALSE(result.success());
+    EXPECT_EQ(result.channel, nullptr);
+    EXPECT_EQ(result.probed.size(), 3u);
+    EXPECT_EQ(detector->getStatistics().failures, 1u);
+}
+
+TEST_F(ProtocolDetectorTest, CancelBeforeDetectStopsIt) {
+    useVehicle(canVehicle(500000, false));
+    detector->cancel();
+    EXPECT_FALSE(detector->detect().success());
+
+    // The flag is cleared once that run ends
+    EXPECT_TRUE(detector->detect().success());
+}
+
+TEST_F(ProtocolDetectorTest, FdChannelsGetTheDataPhaseRate) {
+    useVehicle(canVehicle(500000, false));
+    unsigned long rate = 0;
+
+    auto classic = device->connect(j2534::Protocol::CAN, 0, 500000, 2000000);
+    EXPECT_FALSE(MockJ2534GetSetConfig(j2534::J2534Constants::CAN, j2534::J2534Constants::FD_CAN_DATA_PHASE_RATE, &rate));
+
+    auto fd = device->connect(j2534::Protocol::CAN, j2534::J2534Constants::CAN_FD_FORMAT, 500000, 2000000);
+    ASSERT_TRUE(MockJ2534GetSetConfig(j2534::J2534Constants::CAN, j2534::J2534Constants::FD_CAN_DATA_PHASE_RATE, &rate));
+    EXPECT_EQ(rate, 2000000u);
+}
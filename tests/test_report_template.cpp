@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <fmus/export/report_template.h>
+#include <fmus/thread_pool.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace fmus;
+using namespace fmus::export_system;
+namespace fs = std::filesystem;
+
+namespace {
+
+const char* const DTC_REPORT =
+    "<h1>{{name}}</h1><p>{{count}} codes for {{meta.vin}}</p>"
+    "{{#dtcs}}<li>{{code}} {{status}}: {{description}}</li>{{/dtcs}}"
+    "{{^dtcs}}<p>No codes</p>{{/dtcs}}"
+    "{{{custom.footer}}}";
+
+ExportData report(size_t index, size_t dtcs) {
+    ExportData data(ExportDataType::DTC_DATA, "Report " + std::to_string(index));
+    data.metadata["vin"] = "WVWZZZ1JZXW000001";
+    data.customData["footer"] = "<hr>";
+    for (size_t i = 0; i < dtcs; ++i) {
+        DiagnosticTroubleCode dtc;
+        dtc.code = "P0A" + std::to_string(80 + i);
+        dtc.status = static_cast<uint8_t>(0x08 | i);
+        dtc.description = "Cell <" + std::to_string(i) + "> & pack";
+        data.dtcData.push_back(dtc);
+    }
+    return data;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+} // anonymous namespace
+
+TEST(ReportTemplateTest, RendersFieldsSectionsAndEscaping) {
+    auto compiled = ReportTemplate::compile(DTC_REPORT);
+    ASSERT_TRUE(compiled);
+    EXPECT_GT(compiled->getInstructionCount(), 0u);
+
+    EXPECT_EQ(compiled->render(report(1, 2)),
+              "<h1>Report 1</h1><p>2 codes for WVWZZZ1JZXW000001</p>"
+              "<li>P0A80 0x08: Cell &lt;0&gt; &amp; pack</li>"
+              "<li>P0A81 0x09: Cell &lt;1&gt; &amp; pack</li>"
+              "<hr>");
+    EXPECT_EQ(compiled->render(report(2, 0)),
+              "<h1>Report 2</h1><p>0 codes for WVWZZZ1JZXW000001</p><p>No codes</p><hr>");
+}
+
+TEST(ReportTemplateTest, RenderingReusesTheOutputBuffer) {
+    auto compiled = ReportTemplate::compile(DTC_REPORT);
+    std::string output = "previous contents";
+    compiled->render(report(1, 20), output);
+    const size_t capacity = output.capacity();
+    const std::string first = output;
+
+    compiled->render(report(1, 20), output);
+    EXPECT_EQ(output, first);
+    EXPECT_EQ(output.capacity(), capacity);
+}
+
+TEST(ReportTemplateTest, CompileRejectsUnknownFieldsAndUnclosedSections) {
+    for (const char* source : {"{{mileage}}", "{{#dtcs}}{{code}}", "{{#dtcs}}{{vin}}{{/dtcs}}", "{{name"}) {
+        try {
+            ReportTemplate::compile(source);
+            ADD_FAILURE() << "compiled: " << source;
+        } catch (const ExportError& e) {
+            EXPECT_EQ(e.getErrorCode(), ExportError::ErrorCode::TEMPLATE_ERROR) << source;
+        }
+    }
+}
+
+TEST(ReportTemplateTest, BatchMatchesSingleRenders) {
+    auto compiled = ReportTemplate::compile(DTC_REPORT);
+    std::vector<ExportData> reports;
+    for (size_t i = 0; i < 200; ++i) {
+        reports.push_back(report(i, i % 5));
+    }
+
+    auto outputs = compiled->renderBatch(reports);
+    ASSERT_EQ(outputs.size(), reports.size());
+    for (size_t i = 0; i < reports.size(); ++i) {
+        EXPECT_EQ(outputs[i], compiled->render(reports[i])) << "report " << i;
+    }
+}
+
+TEST(ReportTemplateTest, BatchToFilesReportsEachFailureOnItsOwn) {
+    fs::path directory = fs::temp_directory_path() / ("fmus_report_test_" + std::to_string(::getpid()));
+    fs::create_directories(directory);
+
+    auto compiled = ReportTemplate::compile(DTC_REPORT);
+    std::vector<ExportData> reports = {report(0, 1), report(1, 2), report(2, 3)};
+    std::vector<std::string> paths = {(directory / "0.html").string(),
+                                      (directory / "missing" / "1.html").string(),
+                                      (directory / "2.html").string()};
+    auto results = compiled->renderBatchToFiles(reports, paths);
+
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_TRUE(results[0].success);
+    EXPECT_FALSE(results[1].success);
+    EXPECT_NE(results[1].errorMessage.find(paths[1]), std::string::npos);
+    EXPECT_TRUE(results[2].success);
+    EXPECT_EQ(results[2].recordsExported, 3u);
+    EXPECT_EQ(readFile(paths[2]), compiled->render(reports[2]));
+
+    EXPECT_THROW(compiled->renderBatchToFiles(reports, {paths[0]}), ExportError);
+
+    std::error_code ec;
+    fs::remove_all(directory, ec);
+}
+
+TEST(ReportTemplateTest, BatchOnAPoolWorkerRunsInline) {
+    auto compiled = ReportTemplate::compile(DTC_REPORT);
+    std::vector<ExportData> reports;
+    for (size_t i = 0; i < 100; ++i) {
+        reports.push_back(report(i, 2));
+    }
+
+    // Occupy every worker with a batch; queued chunks would never run if they waited on the pool
+    auto pool = getGlobalThreadPool();
+    std::vector<std::future<std::vector<std::string>>> nested;
+    for (size_t i = 0; i < pool->getThreadCount(); ++i) {
+        nested.push_back(pool->enqueue([&compiled, &reports] { return compiled->renderBatch(reports); }));
+    }
+    for (auto& future : nested) {
+        ASSERT_EQ(future.wait_for(std::chrono::seconds(30)), std::future_status::ready);
+        auto outputs = future.get();
+        ASSERT_EQ(outputs.size(), reports.size());
+        EXPECT_EQ(outputs[99], compiled->render(reports[99]));
+    }
+}
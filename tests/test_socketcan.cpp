@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <fmus/protocols/socketcan.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <cstdint>
+#include <vector>
+
+using namespace fmus;
+using namespace fmus::protocols;
+
+namespace {
+
+const char* const VCAN_INTERFACE = "vcan0";
+
+/**
+ * The kernel's can_rcv_filter rule: a frame passes if any entry matches
+ */
+bool kernelPasses(const std::vector<SocketCANFilter>& filters, const CANMessage& message) {
+    uint32_t canId = message.extended ? (message.id | CAN_EFF_FLAG) : message.id;
+    for (const auto& filter : filters) {
+        bool inverted = (filter.id & CAN_INV_FILTER) != 0;
+        bool matches = (canId & filter.mask) == (filter.id & ~CAN_INV_FILTER & filter.mask);
+        if (matches != inverted) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool softwarePasses(const std::vector<CANFilter>& filters, const CANMessage& message) {
+    for (const auto& filter : filters) {
+        if (filter.matches(message)) {
+            return true;
+        }
+    }
+    return filters.empty();
+}
+
+std::vector<CANMessage> sampleFrames() {
+    std::vector<CANMessage> frames;
+    for (uint32_t id = 0; id <= CAN_SFF_MASK; ++id) {
+        frames.emplace_back(id, std::vector<uint8_t>{0x00});
+    }
+    for (uint32_t id : {0x0u, 0x123u, 0x7E8u, 0x18DAF110u, 0x18DA10F1u, 0x18FECA00u, 0x1FFFFFFFu}) {
+        frames.emplace_back(id, std::vector<uint8_t>{0x00}, true);
+    }
+    return frames;
+}
+
+CANFilter blocking(uint32_t id, uint32_t mask, bool extended = false) {
+    CANFilter filter(id, mask, extended);
+    filter.passThrough = false;
+    return filter;
+}
+
+} // anonymous namespace
+
+TEST(SocketCANFilterTest, ConvertsFiltersToKernelEntries) {
+    auto kernel = toSocketCANFilters({CANFilter(0x7E8, 0x7F8), CANFilter(0x18DAF100, 0x1FFFFF00, true),
+                                      blocking(0x123, 0x7FF)});
+    ASSERT_EQ(kernel.size(), 3u);
+    EXPECT_EQ(kernel[0].id, 0x7E8u);
+    EXPECT_EQ(kernel[0].mask, 0x7F8u | CAN_EFF_FLAG);
+    EXPECT_EQ(kernel[1].id, 0x18DAF100u | CAN_EFF_FLAG);
+    EXPECT_EQ(kernel[1].mask, 0x1FFFFF00u | CAN_EFF_FLAG);
+    EXPECT_EQ(kernel[2].id, 0x123u | CAN_INV_FILTER);
+    EXPECT_EQ(kernel[2].mask, 0x7FFu | CAN_EFF_FLAG);
+}
+
+TEST(SocketCANFilterTest, NoneOrTooManyPassEverything) {
+    auto kernel = toSocketCANFilters({});
+    ASSERT_EQ(kernel.size(), 1u);
+    EXPECT_EQ(kernel[0].id, 0u);
+    EXPECT_EQ(kernel[0].mask, 0u);
+
+    std::vector<CANFilter> many(CAN_RAW_FILTER_MAX + 1, CANFilter(0x100, 0x7FF));
+    kernel = toSocketCANFilters(many);
+    ASSERT_EQ(kernel.size(), 1u);
+    EXPECT_EQ(kernel[0].mask, 0u);
+}
+
+TEST(SocketCANFilterTest, KernelNeverDropsWhatSoftwarePasses) {
+    const std::vector<std::vector<CANFilter>> cases = {
+        {CANFilter(0x7E8, 0x7F8)},
+        {CANFilter(0x7DF, 0x7FF), CANFilter(0x18DAF100, 0x1FFFFF00, true)},
+        {blocking(0x123, 0x7FF)},
+        {blocking(0x18DAF110, 0x1FFFFFFF, true), CANFilter(0x100, 0x700)},
+        {CANFilter(0x000, 0x000), blocking(0x7E0, 0x7F0)},
+    };
+
+    for (size_t c = 0; c < cases.size(); ++c) {
+        auto kernel = toSocketCANFilters(cases[c]);
+        for (const auto& frame : sampleFrames()) {
+            if (softwarePasses(cases[c], frame)) {
+                EXPECT_TRUE(kernelPasses(kernel, frame)) << "case " << c << ": " << frame.toString();
+            }
+        }
+    }
+}
+
+TEST(SocketCANFilterTest, InvertedFilterIsASuperset) {
+    // Blocking 0x123 keeps other standard frames in both; the kernel also passes
+    // every extended frame, which the software filter then drops
+    const std::vector<CANFilter> filters = {blocking(0x123, 0x7FF)};
+    auto kernel = toSocketCANFilters(filters);
+
+    CANMessage blocked(0x123, {0x00});
+    CANMessage other(0x124, {0x00});
+    CANMessage extended(0x18DAF110, {0x00}, true);
+    EXPECT_FALSE(kernelPasses(kernel, blocked));
+    EXPECT_FALSE(softwarePasses(filters, blocked));
+    EXPECT_TRUE(kernelPasses(kernel, other));
+    EXPECT_TRUE(softwarePasses(filters, other));
+    EXPECT_TRUE(kernelPasses(kernel, extended));
+    EXPECT_FALSE(softwarePasses(filters, extended));
+}
+
+TEST(SocketCANChannelTest, ReceivesInBatchesOnVcan) {
+    if (if_nametoindex(VCAN_INTERFACE) == 0) {
+        GTEST_SKIP() << VCAN_INTERFACE << " not available (ip link add dev vcan0 type vcan)";
+    }
+
+    CANConfig config;
+    config.interfaceName = VCAN_INTERFACE;
+    config.rxBatchSize = 8;
+    SocketCANChannel sender;
+    SocketCANChannel receiver;
+    ASSERT_TRUE(sender.open(config));
+    ASSERT_TRUE(receiver.open(config));
+    ASSERT_TRUE(receiver.setFilters({CANFilter(0x100, 0x700)}));
+
+    std::vector<CANMessage> frames;
+    for (uint8_t i = 0; i < 20; ++i) {
+        frames.emplace_back(0x100 + i, std::vector<uint8_t>{i});
+        frames.emplace_back(0x200 + i, std::vector<uint8_t>{i});     // Dropped by the kernel
+    }
+    ASSERT_EQ(sender.send(frames.data(), frames.size()), frames.size());
+
+    std::vector<CANMessage> received;
+    while (received.size() < 20) {
+        size_t before = received.size();
+        size_t count = receiver.receive(received, 200);
+        ASSERT_GT(count, 0u) << "after " << before << " frames";
+        EXPECT_LE(count, 8u);
+    }
+    EXPECT_EQ(receiver.receive(received, 50), 0u);
+    for (uint8_t i = 0; i < 20; ++i) {
+        EXPECT_EQ(received[i].id, 0x100u + i);
+        EXPECT_EQ(received[i].data, std::vector<uint8_t>{i});
+    }
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include <fmus/protocols/timing_engine.h>
+#include <fmus/protocols/iso9141.h>
+#include <chrono>
+#include <vector>
+
+using namespace fmus::protocols;
+using namespace std::chrono;
+
+TEST(TimingEngineTest, RecordChecksMeasurementsAgainstLimits) {
+    TimingEngine engine;
+    engine.setLimits(TimingParameter::P2, {milliseconds(25), milliseconds(50)});
+
+    EXPECT_TRUE(engine.record(TimingParameter::P2, milliseconds(30)));
+    EXPECT_FALSE(engine.record(TimingParameter::P2, milliseconds(10)));
+    EXPECT_FALSE(engine.record(TimingParameter::P2, milliseconds(70)));
+
+    // A zero bound is unchecked
+    EXPECT_TRUE(engine.record(TimingParameter::P3, seconds(5)));
+
+    auto stats = engine.getStatistics();
+    EXPECT_EQ(stats[TimingParameter::P2].samples, 3u);
+    EXPECT_EQ(stats[TimingParameter::P2].violations, 2u);
+    EXPECT_EQ(stats[TimingParameter::P2].minimum, milliseconds(10));
+    EXPECT_EQ(stats[TimingParameter::P2].maximum, milliseconds(70));
+    EXPECT_EQ(stats[TimingParameter::P3].violations, 0u);
+
+    engine.resetStatistics();
+    EXPECT_EQ(engine.getStatistics()[TimingParameter::P2].samples, 0u);
+}
+
+TEST(TimingEngineTest, SleepUntilNeverWakesEarly) {
+    TimingEngine engine;
+    for (int i = 0; i < 20; ++i) {
+        auto deadline = TimingEngine::Clock::now() + microseconds(500 + i * 250);
+        auto woke = engine.sleepUntil(deadline);
+        EXPECT_GE(woke, deadline);
+        EXPECT_GE(TimingEngine::Clock::now(), deadline);
+    }
+
+    auto stats = engine.getStatistics();
+    EXPECT_EQ(stats.waits, 20u);
+    EXPECT_GE(stats.maxOvershoot, stats.averageOvershoot);
+}
+
+TEST(TimingEngineTest, PastDeadlineReturnsImmediately) {
+    TimingEngine engine;
+    auto start = TimingEngine::Clock::now();
+    engine.sleepUntil(start - milliseconds(10));
+    EXPECT_LT(TimingEngine::Clock::now() - start, milliseconds(5));
+}
+
+TEST(ISO9141Test, ChecksumIsByteSumModulo256) {
+    std::vector<uint8_t> request = {0x68, 0x6A, 0xF1, 0x01, 0x00};
+    EXPECT_EQ(calculateISO9141Checksum(request), 0xC4);
+
+    ISO9141Message message = ISO9141Message::fromBytes({0x68, 0x6A, 0xF1, 0x01, 0x00, 0xC4});
+    EXPECT_TRUE(message.verifyChecksum());
+}
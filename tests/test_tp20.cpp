@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <fmus/protocols/can.h>
+#include <fmus/protocols/transport.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace fmus;
+using namespace fmus::protocols;
+
+namespace {
+
+constexpr uint32_t SETUP_ID = 0x200;
+constexpr uint32_t MODULE_RX = 0x740;       // Module receives on this ID
+constexpr uint32_t TESTER_RX = 0x300;       // Module transmits on this ID
+
+/**
+ * A TP 2.0 transport talking to a module simulated on a loopback bus
+ *
+ * The module accepts the channel, answers parameter requests and channel
+ * tests, and acknowledges every packet that asks for it.
+ */
+class Tp20Test : public ::testing::Test {
+protected:
+    void SetUp() override {
+        CANConfig config;
+        config.loopback = true;
+        can = std::make_shared<CANProtocol>();
+        ASSERT_TRUE(can->initialize(config));
+        moduleListener = can->addListener([this](const CANMessage& frame) { module(frame); });
+
+        Tp20Config tp20;
+        tp20.keepAliveInterval = 0;
+        tp20.setupTimeout = 100;
+        transport = std::make_unique<Tp20Transport>(can, tp20);
+        transport->setReceiveHandler([this](uint32_t, const uint8_t* data, size_t length) {
+            std::lock_guard<std::mutex> lock(mutex);
+            pdus.emplace_back(data, data + length);
+        });
+    }
+
+    void TearDown() override {
+        transport.reset();
+        can->shutdown();
+    }
+
+    void module(const CANMessage& frame) {
+        if (frame.data.empty()) {
+            return;
+        }
+        if (frame.id == SETUP_ID && frame.data.size() >= 2 && frame.data[1] == 0xC0) {
+            setupRequest = frame.data;
+            reply(SETUP_ID + frame.data[0], {0x00, 0xD0, TESTER_RX & 0xFF, TESTER_RX >> 8,
+                                             MODULE_RX & 0xFF, MODULE_RX >> 8, 0x01});
+            return;
+        }
+        if (frame.id != MODULE_RX) {
+            return;
+        }
+
+        uint8_t opcode = frame.data[0];
+        if (opcode == 0xA0 || opcode == 0xA3) {
+            reply(TESTER_RX, {0xA1, blockSize, 0x8A, 0xFF, 0x00, 0xFF});
+        } else if (opcode == 0xA8) {
+            disconnects++;
+        } else if ((opcode >> 4) <= 0x3) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                packets.push_back(frame.data);
+            }
+            if ((opcode >> 4) <= 0x1) {
+                reply(TESTER_RX, {static_cast<uint8_t>(0xB0 | ((opcode + 1) & 0x0F))});
+            }
+        } else if ((opcode >> 4) == 0xB) {
+            std::lock_guard<std::mutex> lock(mutex);
+            acks.push_back(opcode);
+        }
+    }
+
+    void reply(uint32_t id, const std::vector<uint8_t>& data) {
+        can->injectMessage(CANMessage(id, data));
+    }
+
+    std::shared_ptr<CANProtocol> can;
+    std::unique_ptr<Tp20Transport> transport;
+    uint32_t moduleListener = 0;
+    uint8_t blockSize = 2;
+
+    std::mutex mutex;
+    std::vector<uint8_t> setupRequest;
+    std::vector<std::vector<uint8_t>> packets;      // Data packets the module received
+    std::vector<uint8_t> acks;                      // Acknowledgements the module received
+    std::vector<std::vector<uint8_t>> pdus;         // Messages delivered to the tester
+    int disconnects = 0;
+};
+
+} // anonymous namespace
+
+TEST_F(Tp20Test, OpensAChannelOnTheModulesIds) {
+    ASSERT_TRUE(transport->open());
+    EXPECT_TRUE(transport->isOpen());
+    EXPECT_EQ(setupRequest, (std::vector<uint8_t>{0x01, 0xC0, 0x00, 0x10, 0x00, 0x03, 0x01}));
+    EXPECT_EQ(transport->getCapabilities().blockSize, 2);
+    EXPECT_NE(transport->toString().find("Tx:0x740"), std::string::npos);
+
+    transport->close();
+    EXPECT_FALSE(transport->isOpen());
+    EXPECT_EQ(disconnects, 1);
+}
+
+TEST_F(Tp20Test, SendsInWindowsOfTheModulesBlockSize) {
+    ASSERT_TRUE(transport->open());
+
+    std::vector<uint8_t> pdu;
+    for (uint8_t i = 0; i < 20; ++i) {
+        pdu.push_back(i);
+    }
+    ASSERT_TRUE(transport->send(pdu));
+
+    // 22 bytes with the length: four packets, an acknowledgement after every second
+    ASSERT_EQ(packets.size(), 4u);
+    EXPECT_EQ(packets[0][0], 0x20);
+    EXPECT_EQ(packets[1][0], 0x01);
+    EXPECT_EQ(packets[2][0], 0x22);
+    EXPECT_EQ(packets[3][0], 0x13);
+
+    std::vector<uint8_t> received;
+    for (const auto& packet : packets) {
+        received.insert(received.end(), packet.begin() + 1, packet.end());
+    }
+    EXPECT_EQ(received[0], 0x00);
+    EXPECT_EQ(received[1], 20);
+    EXPECT_EQ(std::vector<uint8_t>(received.begin() + 2, received.end()), pdu);
+
+    // The sequence carries on into the next message
+    ASSERT_TRUE(transport->send({0x3E, 0x00}));
+    ASSERT_EQ(packets.size(), 5u);
+    EXPECT_EQ(packets[4], (std::vector<uint8_t>{0x14, 0x00, 0x02, 0x3E, 0x00}));
+}
+
+TEST_F(Tp20Test, SendFailsWithoutAcknowledgement) {
+    ASSERT_TRUE(transport->open());
+    can->removeListener(moduleListener);    // The module goes quiet
+    EXPECT_FALSE(transport->send({0x1A, 0x9B}));
+}
+
+TEST_F(Tp20Test, SequenceErrorDropsTheRestOfTheMessage) {
+    ASSERT_TRUE(transport->open());
+
+    // Sequence 1 is lost; sequence 2 must not be read as a new message with length 3
+    reply(TESTER_RX, {0x20, 0x00, 0x10, 0x5A, 0x9B, 0x01, 0x02, 0x03});
+    reply(TESTER_RX, {0x22, 0x00, 0x03, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE});
+    reply(TESTER_RX, {0x33, 0x11, 0x12});
+    EXPECT_TRUE(pdus.empty());
+
+    // The next message after the broken one's last packet is received whole
+    reply(TESTER_RX, {0x24, 0x00, 0x08, 0x5A, 0x9B, 0x56, 0x57, 0x5A});
+    reply(TESTER_RX, {0x15, 0x31, 0x32, 0x33});
+    ASSERT_EQ(pdus.size(), 1u);
+    EXPECT_EQ(pdus[0], (std::vector<uint8_t>{0x5A, 0x9B, 0x56, 0x57, 0x5A, 0x31, 0x32, 0x33}));
+    EXPECT_EQ(acks, std::vector<uint8_t>{0xB6});
+}
@@ -0,0 +1,394 @@
+#include <gtest/gtest.h>
+#include <fmus/trace/trace_recorder.h>
+#include <fmus/trace/trace_replay.h>
+#include <fmus/trace/trace_file.h>
+#include <fmus/trace/trace_index.h>
+#include <fmus/protocols/can.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+
+using namespace fmus;
+using namespace fmus::protocols;
+using namespace fmus::trace;
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint64_t SEGMENT_SIZE = 4096;     // One page, so a few hundred frames span several segments
+constexpr size_t FRAME_COUNT = 600;
+
+std::chrono::system_clock::time_point at(int64_t ns) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns)));
+}
+
+int64_t nanoseconds(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+/**
+ * Classic, extended, remote and CAN FD frames 1 ms apart
+ */
+std::vector<CANMessage> makeFrames() {
+    std::vector<CANMessage> frames;
+    const int64_t start = 1700000000000000000LL;
+    for (size_t i = 0; i < FRAME_COUNT; ++i) {
+        CANMessage frame;
+        switch (i % 4) {
+            case 0:
+                frame = CANMessage(0x7E8, {0x03, 0x41, 0x0C, static_cast<uint8_t>(i)});
+                break;
+            case 1:
+                frame = CANMessage(0x18DAF110, {0x10, 0x14, 0x62, 0xF1, 0x90, 0x57, 0x30, static_cast<uint8_t>(i)}, true);
+                break;
+            case 2:
+                frame = CANMessage(0x123, {});
+                frame.rtr = true;
+                break;
+            default:
+                frame = CANMessage(0x456, std::vector<uint8_t>(i % 8 == 3 ? 12 : 64, static_cast<uint8_t>(i)));
+                frame.fd = true;
+                frame.brs = i % 8 == 3;
+                break;
+        }
+        frame.timestamp = at(start + static_cast<int64_t>(i) * 1000000);
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+void expectSameFrame(const CANMessage& actual, const CANMessage& expected, size_t index) {
+    EXPECT_EQ(actual.id, expected.id) << "frame " << index;
+    EXPECT_EQ(actual.extended, expected.extended) << "frame " << index;
+    EXPECT_EQ(actual.rtr, expected.rtr) << "frame " << index;
+    EXPECT_EQ(actual.fd, expected.fd) << "frame " << index;
+    EXPECT_EQ(actual.brs, expected.brs) << "frame " << index;
+    EXPECT_EQ(actual.data, expected.data) << "frame " << index;
+}
+
+class TraceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = (fs::temp_directory_path() / ("fmus_trace_test_" + std::to_string(::getpid()) + ".fmtr")).string();
+        frames = makeFrames();
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        fs::remove(path, ec);
+    }
+
+    void recordAll(uint32_t indexBlockSize = SEGMENT_SIZE) {
+        TraceRecorderConfig config;
+        config.segmentSize = SEGMENT_SIZE;
+        config.indexBlockSize = indexBlockSize;
+        TraceRecorder recorder;
+        ASSERT_TRUE(recorder.open(path, config));
+        for (const auto& frame : frames) {
+            ASSERT_TRUE(recorder.record(frame));
+        }
+        recorder.close();
+        EXPECT_EQ(recorder.getStatistics().framesRecorded, FRAME_COUNT);
+        EXPECT_EQ(recorder.getStatistics().framesDropped, 0u);
+    }
+
+    /**
+     * Timestamps and IDs of the recorded frames a query should return, in file order
+     */
+    std::vector<std::pair<int64_t, uint32_t>> expected(const TraceQuery& query) const {
+        std::vector<std::pair<int64_t, uint32_t>> result;
+        for (const auto& frame : frames) {
+            int64_t time = nanoseconds(frame.timestamp);
+            bool idMatches = query.ids.empty() ||
+                             std::find(query.ids.begin(), query.ids.end(), frame.id) != query.ids.end();
+            if (time >= query.fromNs && time <= query.toNs && idMatches) {
+                result.emplace_back(time, frame.id);
+            }
+        }
+        return result;
+    }
+
+    std::vector<std::pair<int64_t, uint32_t>> run(const TraceIndex& index, const TraceQuery& query,
+                                                  TraceQueryStatistics* statistics = nullptr) const {
+        std::vector<std::pair<int64_t, uint32_t>> result;
+        index.query(query, [&result](const TraceFrame& frame) {
+            result.emplace_back(frame.timestampNs, frame.id);
+            return true;
+        }, statistics);
+        return result;
+    }
+
+    int64_t timeOf(size_t frame) const {
+        return nanoseconds(frames[frame].timestamp);
+    }
+
+    std::string path;
+    std::vector<CANMessage> frames;
+};
+
+/**
+ * Collects what a CANProtocol dispatches
+ */
+struct Capture {
+    explicit Capture(CANProtocol& can) {
+        can.addListener([this](const CANMessage& message) {
+            std::lock_guard<std::mutex> lock(mutex);
+            messages.push_back(message);
+        });
+    }
+
+    std::mutex mutex;
+    std::vector<CANMessage> messages;
+};
+
+} // anonymous namespace
+
+TEST_F(TraceTest, RecordedFramesReadBackUnchanged) {
+    recordAll();
+
+    TraceReader reader;
+    ASSERT_TRUE(reader.open(path));
+    const auto& header = reader.getHeader();
+    EXPECT_EQ(header.magic, TRACE_MAGIC);
+    EXPECT_NE(header.closed, 0u);
+    EXPECT_EQ(header.frameCount, FRAME_COUNT);
+    EXPECT_GT(header.dataBytes, SEGMENT_SIZE);
+
+    TraceCursor cursor;
+    TraceFrame frame;
+    size_t count = 0;
+    while (reader.next(cursor, frame)) {
+        ASSERT_LT(count, frames.size());
+        expectSameFrame(frame.toCANMessage(), frames[count], count);
+        EXPECT_EQ(frame.timestampNs, nanoseconds(frames[count].timestamp));
+        ++count;
+    }
+    EXPECT_EQ(count, FRAME_COUNT);
+
+    uint64_t blocks = 0;
+    const TraceIndexBlock* index = reader.getIndex(blocks);
+    ASSERT_NE(index, nullptr);
+    ASSERT_GT(blocks, 1u);
+    uint64_t indexed = 0;
+    for (uint64_t i = 0; i < blocks; ++i) {
+        indexed += index[i].frames;
+    }
+    EXPECT_EQ(indexed, FRAME_COUNT);
+    EXPECT_EQ(index[0].minTimeNs, nanoseconds(frames.front().timestamp));
+}
+
+TEST_F(TraceTest, ReplayDeliversRecordedFramesInOrder) {
+    recordAll();
+
+    CANProtocol can;
+    ASSERT_TRUE(can.initialize(CANConfig()));
+    Capture capture(can);
+
+    TraceReplayer replayer;
+    ASSERT_TRUE(replayer.open(path));
+    TraceReplayConfig config;
+    config.speed = 0;
+    config.originalTimestamps = true;
+    EXPECT_EQ(replayer.run(can, config), FRAME_COUNT);
+
+    ASSERT_EQ(capture.messages.size(), FRAME_COUNT);
+    for (size_t i = 0; i < FRAME_COUNT; ++i) {
+        expectSameFrame(capture.messages[i], frames[i], i);
+        EXPECT_EQ(capture.messages[i].timestamp, frames[i].timestamp) << "frame " << i;
+    }
+    can.shutdown();
+}
+
+TEST_F(TraceTest, ReplayAppliesFilters) {
+    recordAll();
+
+    CANProtocol can;
+    ASSERT_TRUE(can.initialize(CANConfig()));
+    Capture capture(can);
+
+    TraceReplayer replayer;
+    ASSERT_TRUE(replayer.open(path));
+    TraceReplayConfig config;
+    config.speed = 0;
+    config.filters.push_back(CANFilter(0x7E8, 0x7FF));
+    EXPECT_EQ(replayer.run(can, config), FRAME_COUNT / 4);
+    EXPECT_EQ(replayer.getStatistics().framesFiltered, FRAME_COUNT - FRAME_COUNT / 4);
+
+    ASSERT_EQ(capture.messages.size(), FRAME_COUNT / 4);
+    for (const auto& message : capture.messages) {
+        EXPECT_EQ(message.id, 0x7E8u);
+    }
+    can.shutdown();
+}
+
+TEST_F(TraceTest, ReplayedTrafficRecordsIntoIdenticalTrace) {
+    recordAll();
+    const std::string copy = path + ".copy";
+
+    auto can = std::make_shared<CANProtocol>();
+    ASSERT_TRUE(can->initialize(CANConfig()));
+    {
+        TraceRecorderConfig recorderConfig;
+        recorderConfig.segmentSize = SEGMENT_SIZE;
+        recorderConfig.indexBlockSize = SEGMENT_SIZE;
+        TraceRecorder recorder;
+        ASSERT_TRUE(recorder.open(copy, recorderConfig));
+        ASSERT_TRUE(recorder.attach(can));
+
+        TraceReplayer replayer;
+        ASSERT_TRUE(replayer.open(path));
+        TraceReplayConfig config;
+        config.speed = 0;
+        config.originalTimestamps = true;
+        replayer.run(*can, config);
+        recorder.close();
+    }
+    can->shutdown();
+
+    TraceReader original;
+    TraceReader replayed;
+    ASSERT_TRUE(original.open(path));
+    ASSERT_TRUE(replayed.open(copy));
+    TraceCursor a;
+    TraceCursor b;
+    TraceFrame x;
+    TraceFrame y;
+    size_t count = 0;
+    while (original.next(a, x)) {
+        ASSERT_TRUE(replayed.next(b, y)) << "frame " << count;
+        EXPECT_EQ(x.timestampNs, y.timestampNs);
+        EXPECT_EQ(x.id, y.id);
+        EXPECT_EQ(x.flags, y.flags);
+        ASSERT_EQ(x.length, y.length);
+        EXPECT_TRUE(std::equal(x.data, x.data + x.length, y.data));
+        ++count;
+    }
+    EXPECT_FALSE(replayed.next(b, y));
+    EXPECT_EQ(count, FRAME_COUNT);
+
+    std::error_code ec;
+    fs::remove(copy, ec);
+}
+
+TEST_F(TraceTest, RecorderDropsFramesBeyondMaxBytes) {
+    TraceRecorderConfig config;
+    config.segmentSize = SEGMENT_SIZE;
+    config.indexBlockSize = SEGMENT_SIZE;
+    config.maxBytes = SEGMENT_SIZE;
+    TraceRecorder recorder;
+    ASSERT_TRUE(recorder.open(path, config));
+    size_t accepted = 0;
+    for (const auto& frame : frames) {
+        accepted += recorder.record(frame) ? 1 : 0;
+    }
+    recorder.close();
+
+    auto stats = recorder.getStatistics();
+    EXPECT_GT(accepted, 0u);
+    EXPECT_LT(accepted, FRAME_COUNT);
+    EXPECT_EQ(stats.framesRecorded, accepted);
+    EXPECT_EQ(stats.framesDropped, FRAME_COUNT - accepted);
+
+    TraceReader reader;
+    ASSERT_TRUE(reader.open(path));
+    EXPECT_EQ(reader.getHeader().frameCount, accepted);
+}
+
+TEST_F(TraceTest, IndexQueriesFindEveryMatch) {
+    // One frame arrives with an early timestamp, far from its neighbours in time
+    frames[500].timestamp = frames[10].timestamp + std::chrono::microseconds(1);
+
+    for (uint32_t blockSize : {1024u, 0u}) {     // Stored index, then one built by scanning
+        recordAll(blockSize);
+        TraceReader reader;
+        ASSERT_TRUE(reader.open(path));
+        TraceIndex index;
+        ASSERT_TRUE(index.load(reader));
+        ASSERT_GT(index.getBlockCount(), blockSize ? 4u : 0u);   // Scanning uses 64 KB blocks
+
+        const std::vector<TraceQuery> queries = {
+            TraceQuery{},
+            TraceQuery{timeOf(5), timeOf(20), {}},
+            TraceQuery{timeOf(100), timeOf(400), {0x7E8}},
+            TraceQuery{timeOf(0), timeOf(599), {0x18DAF110, 0x456}},
+            TraceQuery{timeOf(10), timeOf(11), {0x7E8}},
+            TraceQuery{timeOf(599), timeOf(599), {}},
+        };
+        for (size_t q = 0; q < queries.size(); ++q) {
+            TraceQueryStatistics statistics;
+            auto found = run(index, queries[q], &statistics);
+            EXPECT_EQ(found, expected(queries[q])) << "block " << blockSize << ", query " << q;
+            EXPECT_EQ(statistics.framesMatched, found.size());
+        }
+
+        // The out-of-order frame is found by time and by ID
+        auto late = run(index, TraceQuery{timeOf(10) + 1, timeOf(10) + 1000, {}});
+        ASSERT_EQ(late.size(), 1u);
+        EXPECT_EQ(late[0].second, frames[500].id);
+
+        // A visitor returning false stops the query
+        uint64_t visited = index.query(TraceQuery{}, [](const TraceFrame&) { return false; });
+        EXPECT_EQ(visited, 1u);
+    }
+}
+
+TEST_F(TraceTest, IndexQueriesWithNoMatchVisitNothing) {
+    recordAll(1024);
+    TraceReader reader;
+    ASSERT_TRUE(reader.open(path));
+    TraceIndex index;
+    ASSERT_TRUE(index.load(reader));
+
+    const std::vector<TraceQuery> queries = {
+        TraceQuery{timeOf(0) - 1000000, timeOf(0) - 1, {}},
+        TraceQuery{timeOf(599) + 1, std::numeric_limits<int64_t>::max(), {}},
+        TraceQuery{timeOf(300), timeOf(200), {}},
+        TraceQuery{timeOf(0), timeOf(599), {0x7DF, 0x18DB33F1}},
+        TraceQuery{timeOf(100) + 1, timeOf(101) - 1, {}},
+    };
+    for (size_t q = 0; q < queries.size(); ++q) {
+        TraceQueryStatistics statistics;
+        EXPECT_TRUE(run(index, queries[q], &statistics).empty()) << "query " << q;
+        EXPECT_EQ(statistics.framesMatched, 0u);
+    }
+
+    // IDs absent from the trace skip most blocks on their Bloom filters
+    TraceQueryStatistics statistics;
+    run(index, queries[3], &statistics);
+    EXPECT_GT(statistics.blocksSkipped, statistics.blocksScanned);
+}
+
+TEST_F(TraceTest, IndexSeekLandsAtOrBeforeTheTime) {
+    recordAll(1024);
+    TraceReader reader;
+    ASSERT_TRUE(reader.open(path));
+    TraceIndex index;
+    ASSERT_TRUE(index.load(reader));
+
+    // Times in the first, a middle and the last segment, and on segment edges
+    for (size_t target : {size_t(0), size_t(1), size_t(150), size_t(299), size_t(300), size_t(451), size_t(599)}) {
+        TraceCursor cursor = index.seek(timeOf(target));
+
+        TraceFrame frame;
+        ASSERT_TRUE(reader.next(cursor, frame)) << "frame " << target;
+        EXPECT_LE(frame.timestampNs, timeOf(target)) << "frame " << target;
+        while (frame.timestampNs < timeOf(target)) {
+            ASSERT_TRUE(reader.next(cursor, frame)) << "frame " << target;
+        }
+        EXPECT_EQ(frame.timestampNs, timeOf(target));
+        EXPECT_EQ(frame.id, frames[target].id);
+    }
+
+    // Past the end the cursor is at the end of the data
+    TraceCursor end = index.seek(timeOf(599) + 1);
+    TraceFrame frame;
+    EXPECT_FALSE(reader.next(end, frame));
+}
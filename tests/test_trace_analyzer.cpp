@@ -0,0 +1,281 @@
+#include <gtest/gtest.h>
+#include <fmus/trace/trace_analyzer.h>
+#include <fmus/trace/trace_recorder.h>
+#include <fmus/trace/trace_file.h>
+#include <fmus/protocols/can.h>
+#include <fmus/thread_pool.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace fmus;
+using namespace fmus::protocols;
+using namespace fmus::trace;
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int64_t MS = 1000000;
+constexpr int64_t START_NS = 1700000000000000000LL;
+
+using Pdu = TraceAnalyzer::Pdu;
+
+Pdu tester(int64_t ms, std::vector<uint8_t> data, bool functional = false) {
+    return Pdu{true, functional, START_NS + ms * MS, START_NS + ms * MS, std::move(data)};
+}
+
+Pdu ecu(int64_t ms, std::vector<uint8_t> data) {
+    return Pdu{false, false, START_NS + ms * MS, START_NS + ms * MS, std::move(data)};
+}
+
+/**
+ * Writes CAN traffic with ISO-TP segmentation, one frame per millisecond
+ */
+class TraceWriter {
+public:
+    void frame(uint32_t id, std::vector<uint8_t> data) {
+        CANMessage message(id, std::move(data), id > 0x7FF);
+        message.data.resize(8, 0xCC);
+        message.timestamp = std::chrono::system_clock::time_point(std::chrono::duration_cast<
+            std::chrono::system_clock::duration>(std::chrono::nanoseconds(START_NS + nowMs * MS)));
+        frames.push_back(message);
+        nowMs++;
+    }
+
+    /**
+     * Send a PDU from source; the peer on flowControlId grants the rest in one block
+     */
+    void pdu(uint32_t source, uint32_t flowControlId, const std::vector<uint8_t>& data) {
+        if (data.size() <= 7) {
+            std::vector<uint8_t> single = {static_cast<uint8_t>(data.size())};
+            single.insert(single.end(), data.begin(), data.end());
+            frame(source, single);
+            return;
+        }
+        std::vector<uint8_t> first = {static_cast<uint8_t>(0x10 | (data.size() >> 8)), static_cast<uint8_t>(data.size())};
+        first.insert(first.end(), data.begin(), data.begin() + 6);
+        frame(source, first);
+        frame(flowControlId, {0x30, 0x00, 0x00});
+        uint8_t sequence = 1;
+        for (size_t offset = 6; offset < data.size(); offset += 7, ++sequence) {
+            std::vector<uint8_t> consecutive = {static_cast<uint8_t>(0x20 | (sequence & 0x0F))};
+            consecutive.insert(consecutive.end(), data.begin() + offset, data.begin() + std::min(data.size(), offset + 7));
+            frame(source, consecutive);
+        }
+    }
+
+    void wait(int64_t ms) { nowMs += ms; }
+
+    int64_t nowMs = 0;
+    std::vector<CANMessage> frames;
+};
+
+/**
+ * One tester session: UDS with a pending ECU, a functional OBD request
+ * answered by two ECUs, a negative response and a 29-bit channel
+ */
+void writeSession(TraceWriter& out) {
+    const std::vector<uint8_t> vin = {0x62, 0xF1, 0x90, 'W', 'V', 'W', 'Z', 'Z', 'Z', '1', 'J', 'Z',
+                                      'X', 'W', '0', '0', '0', '0', '0', '1'};
+    out.pdu(0x7E0, 0x7E8, {0x22, 0xF1, 0x90});
+    out.pdu(0x7E8, 0x7E0, {0x7F, 0x22, 0x78});
+    out.wait(40);
+    out.pdu(0x7E8, 0x7E0, vin);
+
+    out.pdu(0x7DF, 0x7E8, {0x01, 0x0C});
+    out.pdu(0x7E8, 0x7E0, {0x41, 0x0C, 0x1A, 0xF8});
+    out.pdu(0x7E9, 0x7E1, {0x41, 0x0C, 0x1A, 0xF8});
+
+    out.pdu(0x7E1, 0x7E9, {0x27, 0x01});
+    out.pdu(0x7E9, 0x7E1, {0x7F, 0x27, 0x35});
+
+    out.pdu(0x18DA10F1, 0x18DAF110, {0x3E, 0x80});
+    out.pdu(0x18DA10F1, 0x18DAF110, {0x19, 0x02, 0x08});
+    out.pdu(0x18DAF110, 0x18DA10F1, {0x59, 0x02, 0xFF, 0x12, 0x34, 0x56, 0x08, 0xAB, 0xCD, 0xEF, 0x09});
+    out.wait(100);
+}
+
+class TraceAnalyzerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const std::string base = "fmus_analyzer_test_" + std::to_string(::getpid());
+        path = (fs::temp_directory_path() / (base + ".fmtr")).string();
+        csvPath = (fs::temp_directory_path() / (base + ".csv")).string();
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        fs::remove(path, ec);
+        fs::remove(csvPath, ec);
+    }
+
+    void record(const std::vector<CANMessage>& frames) {
+        TraceRecorderConfig config;
+        config.segmentSize = 4096;
+        config.indexBlockSize = 1024;
+        TraceRecorder recorder;
+        ASSERT_TRUE(recorder.open(path, config));
+        for (const auto& frame : frames) {
+            ASSERT_TRUE(recorder.record(frame));
+        }
+        recorder.close();
+    }
+
+    std::string path;
+    std::string csvPath;
+};
+
+} // anonymous namespace
+
+TEST(TraceAnalyzerPairTest, PairsRequestsWithTheirFinalResponse) {
+    TraceAnalyzerConfig config;
+    config.responseTimeout = 100;
+    TraceAnalyzer analyzer(config);
+    const TraceChannel channel{0x7E0, 0x7E8, false};
+
+    auto transactions = analyzer.pair(channel, {
+        tester(0, {0x22, 0xF1, 0x90}),
+        ecu(10, {0x7F, 0x22, 0x78}),
+        ecu(90, {0x7F, 0x22, 0x78}),            // Each pending reply extends the deadline
+        ecu(180, {0x62, 0xF1, 0x90, 0x01}),
+        tester(200, {0x10, 0x83}),              // Suppressed positive response
+        tester(210, {0x27, 0x01}),
+        ecu(215, {0x7F, 0x27, 0x35}),
+        tester(300, {0x31, 0x01, 0xFF, 0x00}),  // Never answered
+        ecu(450, {0x50, 0x03}),                 // Nothing waiting for it
+        tester(500, {0x01, 0x00}, true),        // Functional and unanswered: not reported
+    });
+
+    ASSERT_EQ(transactions.size(), 5u);
+    EXPECT_EQ(transactions[0].status, TransactionStatus::POSITIVE);
+    EXPECT_EQ(transactions[0].pendingResponses, 2u);
+    EXPECT_EQ(transactions[0].latency(), std::chrono::milliseconds(180));
+    EXPECT_EQ(transactions[0].response, (std::vector<uint8_t>{0x62, 0xF1, 0x90, 0x01}));
+
+    EXPECT_EQ(transactions[1].status, TransactionStatus::SUPPRESSED);
+    EXPECT_EQ(transactions[1].service, 0x10);
+
+    EXPECT_EQ(transactions[2].status, TransactionStatus::NEGATIVE);
+    EXPECT_EQ(transactions[2].negativeResponseCode, 0x35);
+    EXPECT_EQ(transactions[2].latency(), std::chrono::milliseconds(5));
+
+    EXPECT_EQ(transactions[3].status, TransactionStatus::NO_RESPONSE);
+    EXPECT_EQ(transactions[3].service, 0x31);
+
+    EXPECT_EQ(transactions[4].status, TransactionStatus::UNSOLICITED);
+    EXPECT_EQ(transactions[4].service, 0x10);
+}
+
+TEST(TraceAnalyzerPairTest, PendingWithoutFinalResponseTimesOut) {
+    TraceAnalyzerConfig config;
+    config.responseTimeout = 50;
+    TraceAnalyzer analyzer(config);
+
+    auto transactions = analyzer.pair(TraceChannel{0x7E0, 0x7E8, false}, {
+        tester(0, {0x31, 0x01, 0x02, 0x03}),
+        ecu(40, {0x7F, 0x31, 0x78}),
+        ecu(200, {0x71, 0x01, 0x02, 0x03}),     // Too late: counted on its own
+    });
+    ASSERT_EQ(transactions.size(), 2u);
+    EXPECT_EQ(transactions[0].status, TransactionStatus::NO_RESPONSE);
+    EXPECT_EQ(transactions[0].pendingResponses, 1u);
+    EXPECT_EQ(transactions[1].status, TransactionStatus::UNSOLICITED);
+}
+
+TEST_F(TraceAnalyzerTest, RebuildsConversationsFromATrace) {
+    TraceWriter out;
+    writeSession(out);
+    record(out.frames);
+
+    TraceReader reader;
+    ASSERT_TRUE(reader.open(path));
+    TraceAnalysis analysis = TraceAnalyzer().analyze(reader);
+    EXPECT_EQ(analysis.framesScanned, out.frames.size());
+    EXPECT_EQ(analysis.reassemblyErrors, 0u);
+    EXPECT_EQ(analysis.channels, 3u);
+
+    const auto& t = analysis.transactions;
+    ASSERT_EQ(t.size(), 6u) << analysis.toString();
+
+    EXPECT_EQ(t[0].channel.responseId, 0x7E8u);
+    EXPECT_EQ(t[0].status, TransactionStatus::POSITIVE);
+    EXPECT_EQ(t[0].pendingResponses, 1u);
+    EXPECT_EQ(t[0].response.size(), 20u);
+    EXPECT_GE(t[0].latency(), std::chrono::milliseconds(40));
+
+    // The functional request pairs on both answering ECUs
+    for (size_t i : {1, 2}) {
+        EXPECT_TRUE(t[i].functional);
+        EXPECT_EQ(t[i].protocol, TransactionProtocol::OBD);
+        EXPECT_EQ(t[i].status, TransactionStatus::POSITIVE);
+    }
+    EXPECT_NE(t[1].channel.responseId, t[2].channel.responseId);
+
+    EXPECT_EQ(t[3].status, TransactionStatus::NEGATIVE);
+    EXPECT_EQ(t[3].negativeResponseCode, 0x35);
+
+    EXPECT_TRUE(t[4].channel.extended);
+    EXPECT_EQ(t[4].status, TransactionStatus::SUPPRESSED);
+    EXPECT_EQ(t[5].service, 0x19);
+    EXPECT_EQ(t[5].response.size(), 11u);
+}
+
+TEST_F(TraceAnalyzerTest, ExportsTheTransactionTable) {
+    TraceWriter out;
+    writeSession(out);
+    record(out.frames);
+
+    TraceReader reader;
+    ASSERT_TRUE(reader.open(path));
+    TraceAnalysis analysis = TraceAnalyzer().analyze(reader);
+    ASSERT_TRUE(analysis.exportCsv(csvPath));
+
+    std::ifstream csv(csvPath);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(csv, line);) {
+        lines.push_back(line);
+    }
+    ASSERT_EQ(lines.size(), analysis.transactions.size() + 1);
+    EXPECT_EQ(lines[0], "request_time_ns,response_time_ns,request_id,response_id,protocol,service,status,nrc,"
+                        "pending,latency_us,request,response");
+    EXPECT_EQ(lines[1].substr(0, lines[1].find(',')), std::to_string(analysis.transactions[0].requestStartNs));
+    EXPECT_NE(lines[1].find(",7E0,7E8,UDS,0x22,Positive,0x00,1,"), std::string::npos) << lines[1];
+    EXPECT_NE(lines[4].find(",7E1,7E9,UDS,0x27,Negative,0x35,0,"), std::string::npos) << lines[4];
+    EXPECT_NE(lines[5].find(",18DA10F1,18DAF110,UDS,0x3E,Suppressed,"), std::string::npos) << lines[5];
+
+    EXPECT_FALSE(analysis.exportCsv((fs::temp_directory_path() / "missing_dir" / "out.csv").string()));
+}
+
+TEST_F(TraceAnalyzerTest, AnalyzingOnAPoolWorkerRunsInline) {
+    TraceWriter out;
+    for (int session = 0; session < 40; ++session) {
+        writeSession(out);
+    }
+    record(out.frames);
+
+    TraceReader reader;
+    ASSERT_TRUE(reader.open(path));
+    TraceAnalyzer analyzer;
+    TraceAnalysis direct = analyzer.analyze(reader);
+    ASSERT_EQ(direct.transactions.size(), 40u * 6u);
+
+    // Occupy every worker with an analysis; queued tasks would never run if they waited on the pool
+    auto pool = getGlobalThreadPool();
+    std::vector<std::future<TraceAnalysis>> nested;
+    for (size_t i = 0; i < pool->getThreadCount(); ++i) {
+        nested.push_back(pool->enqueue([&analyzer, &reader] { return analyzer.analyze(reader); }));
+    }
+    for (auto& future : nested) {
+        ASSERT_EQ(future.wait_for(std::chrono::seconds(30)), std::future_status::ready);
+        TraceAnalysis inline_ = future.get();
+        ASSERT_EQ(inline_.transactions.size(), direct.transactions.size());
+        for (size_t i = 0; i < direct.transactions.size(); ++i) {
+            EXPECT_EQ(inline_.transactions[i].requestStartNs, direct.transactions[i].requestStartNs);
+            EXPECT_EQ(inline_.transactions[i].status, direct.transactions[i].status);
+        }
+    }
+}
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <fmus/trace/trigger_capture.h>
+#include <fmus/trace/trace_file.h>
+#include <fmus/protocols/can.h>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace fmus;
+using namespace fmus::protocols;
+using namespace fmus::trace;
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int64_t MS = 1000000;
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+CANMessage frameAt(uint32_t id, int64_t ns) {
+    CANMessage frame(id, {0x01, 0x02});
+    frame.timestamp = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns)));
+    return frame;
+}
+
+/**
+ * A capture writing into a scratch directory, with a short post-trigger
+ * time so windows are frozen quickly
+ */
+class TriggerCaptureTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory = fs::temp_directory_path() / ("fmus_capture_test_" + std::to_string(::getpid()));
+        fs::create_directories(directory);
+        config.preTrigger = std::chrono::milliseconds(1000);
+        config.postTrigger = std::chrono::milliseconds(50);
+        config.directory = directory.string();
+        base = nowNs();
+    }
+
+    void TearDown() override {
+        capture.stop();
+        std::error_code ec;
+        fs::remove_all(directory, ec);
+    }
+
+    void start() {
+        ASSERT_TRUE(capture.start(config));
+        capture.setCaptureCallback([this](const CaptureInfo& info) {
+            std::lock_guard<std::mutex> lock(mutex);
+            captures.push_back(info);
+        });
+    }
+
+    CaptureInfo finish() {
+        EXPECT_TRUE(capture.waitForIdle(5000));
+        std::lock_guard<std::mutex> lock(mutex);
+        EXPECT_EQ(captures.size(), 1u);
+        return captures.empty() ? CaptureInfo() : captures.back();
+    }
+
+    static std::vector<uint32_t> tracedIds(const CaptureInfo& info) {
+        std::vector<uint32_t> ids;
+        TraceReader reader;
+        EXPECT_TRUE(reader.open(info.tracePath));
+        TraceCursor cursor;
+        TraceFrame frame;
+        while (reader.next(cursor, frame)) {
+            ids.push_back(frame.id);
+        }
+        return ids;
+    }
+
+    static std::vector<std::string> sampleLines(const CaptureInfo& info) {
+        std::vector<std::string> lines;
+        std::ifstream in(info.samplesPath);
+        std::string line;
+        std::getline(in, line);         // Header
+        while (std::getline(in, line)) {
+            lines.push_back(line.substr(line.find(',') + 1));
+        }
+        return lines;
+    }
+
+    fs::path directory;
+    TriggerCaptureConfig config;
+    TriggerCapture capture;
+    int64_t base = 0;
+
+    std::mutex mutex;
+    std::vector<CaptureInfo> captures;
+};
+
+} // anonymous namespace
+
+TEST_F(TriggerCaptureTest, SavesThePreAndPostTriggerWindow) {
+    start();
+    capture.addFrame(frameAt(0x100, base - 2000 * MS));        // Before the window
+    capture.addFrame(frameAt(0x101, base - 500 * MS));
+    capture.addFrame(frameAt(0x102, base - 100 * MS));
+    capture.addSample("soc", 80.0, base - 2000 * MS);
+    capture.addSample("soc", 81.0, base - 200 * MS);
+
+    ASSERT_TRUE(capture.trigger("test"));
+    EXPECT_TRUE(capture.trigger("again"));
+    capture.addFrame(CANMessage(0x103, {0x03}));                // Stamped on arrival, inside the post-trigger time
+    capture.addSample("soc", 82.0);
+    capture.addFrame(frameAt(0x104, nowNs() + 10000 * MS));    // After the window
+
+    CaptureInfo info = finish();
+    EXPECT_TRUE(info.success);
+    EXPECT_EQ(info.trigger, CaptureTrigger::MANUAL);
+    EXPECT_EQ(info.reason, "test");
+    EXPECT_EQ(info.retriggers, 1u);
+    EXPECT_FALSE(info.truncated);
+    EXPECT_EQ(info.frames, 3u);
+    EXPECT_EQ(info.samples, 2u);
+    EXPECT_EQ(tracedIds(info), (std::vector<uint32_t>{0x101, 0x102, 0x103}));
+    EXPECT_EQ(sampleLines(info), (std::vector<std::string>{"soc,81", "soc,82"}));
+    EXPECT_EQ(capture.getStatistics().capturesWritten, 1u);
+}
+
+TEST_F(TriggerCaptureTest, RingWrapKeepsTheNewestFrames) {
+    config.frameCapacity = 16;
+    start();
+    for (uint32_t i = 0; i < 10; ++i) {
+        capture.addFrame(frameAt(0x100 + i, base - 3000 * MS + i * MS));
+    }
+    for (uint32_t i = 0; i < 10; ++i) {
+        capture.addFrame(frameAt(0x200 + i, base - 500 * MS + i * MS));
+    }
+    ASSERT_TRUE(capture.trigger());
+
+    // Six old frames are still in the ring, so the window start was reached
+    CaptureInfo info = finish();
+    EXPECT_FALSE(info.truncated);
+    ASSERT_EQ(info.frames, 10u);
+    EXPECT_EQ(tracedIds(info).front(), 0x200u);
+}
+
+TEST_F(TriggerCaptureTest, RingWrapInsideTheWindowIsTruncated) {
+    config.frameCapacity = 16;
+    start();
+    for (uint32_t i = 0; i < 40; ++i) {
+        capture.addFrame(frameAt(0x100 + i, base - 500 * MS + i * MS));
+    }
+    ASSERT_TRUE(capture.trigger());
+
+    CaptureInfo info = finish();
+    EXPECT_TRUE(info.truncated);
+    ASSERT_EQ(info.frames, 16u);
+    auto ids = tracedIds(info);
+    EXPECT_EQ(ids.front(), 0x118u);
+    EXPECT_EQ(ids.back(), 0x127u);
+}
+
+TEST_F(TriggerCaptureTest, OutOfOrderEntriesAreStillCaptured) {
+    config.frameCapacity = 4;
+    config.sampleCapacity = 4;
+    start();
+
+    // A live frame followed by replayed ones from long ago
+    capture.addFrame(frameAt(0x101, base - 200 * MS));
+    for (uint32_t i = 0; i < 3; ++i) {
+        capture.addFrame(frameAt(0x200 + i, base - 3000 * MS));
+    }
+    capture.addSample("speed", 50.0, base - 100 * MS);
+    for (int i = 0; i < 3; ++i) {
+        capture.addSample("voltage", 400.0 + i, base - 3000 * MS + i * MS);
+    }
+    ASSERT_TRUE(capture.trigger());
+
+    CaptureInfo info = finish();
+    EXPECT_FALSE(info.truncated);
+    EXPECT_EQ(tracedIds(info), std::vector<uint32_t>{0x101});
+    EXPECT_EQ(sampleLines(info), std::vector<std::string>{"speed,50"});
+}
+
+TEST_F(TriggerCaptureTest, NegativeResponseTriggersButResponsePendingDoesNot) {
+    start();
+    capture.addFrame(CANMessage(0x7E8, {0x03, 0x7F, 0x22, 0x78}));
+    EXPECT_EQ(capture.getStatistics().triggers, 0u);
+
+    capture.addFrame(CANMessage(0x7E8, {0x03, 0x7F, 0x22, 0x31}));
+    CaptureInfo info = finish();
+    EXPECT_EQ(info.trigger, CaptureTrigger::NRC);
+    EXPECT_EQ(info.frames, 2u);
+    EXPECT_NE(info.reason.find("0x7E8"), std::string::npos) << info.reason;
+}
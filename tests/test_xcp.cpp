@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+#include <fmus/protocols/can.h>
+#include <fmus/protocols/xcp.h>
+#include <fmus/live_data_store.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace fmus;
+using namespace fmus::protocols;
+
+namespace {
+
+constexpr uint8_t FIRST_PID = 0x10;
+
+/**
+ * An XCP master talking to a slave simulated on a loopback bus
+ *
+ * The slave has dynamic DAQ lists with absolute ODT numbers starting at
+ * FIRST_PID, and optionally 16-bit timestamps counting microseconds.
+ */
+class XcpTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        CANConfig config;
+        config.loopback = true;
+        can = std::make_shared<CANProtocol>();
+        ASSERT_TRUE(can->initialize(config));
+        can->addListener([this](const CANMessage& frame) { slave(frame); });
+
+        store = std::make_shared<LiveDataStore>(16, 16);
+        ASSERT_TRUE(master.initialize(XcpConfig(), can));
+    }
+
+    void TearDown() override {
+        master.shutdown();
+        can->shutdown();
+    }
+
+    void slave(const CANMessage& frame) {
+        if (frame.id != XcpConfig().commandId || frame.data.empty()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            commands.push_back(frame.data);
+        }
+
+        switch (frame.data[0]) {
+            case 0xFF:      // CONNECT: DAQ resource, MAX_CTO 8, MAX_DTO 8
+                reply({0xFF, 0x04, static_cast<uint8_t>(motorola ? 0x01 : 0x00), 0x08,
+                       static_cast<uint8_t>(motorola ? 0x00 : 0x08), static_cast<uint8_t>(motorola ? 0x08 : 0x00),
+                       0x01, 0x01});
+                break;
+            case 0xDA:      // GET_DAQ_PROCESSOR_INFO: dynamic, 4 lists, 2 events, MIN_DAQ 0
+                reply({0xFF, static_cast<uint8_t>(timestamps ? 0x11 : 0x01), word(4, 0), word(4, 1),
+                       word(2, 0), word(2, 1), 0x00, 0x00});
+                break;
+            case 0xD9:      // GET_DAQ_RESOLUTION_INFO: 4-byte entries, 2-byte 1 us timestamps
+                reply({0xFF, 0x01, 0x04, 0x01, 0x04, 0x32, word(1, 0), word(1, 1)});
+                break;
+            case 0xDE:      // START_STOP_DAQ_LIST
+                reply({0xFF, FIRST_PID});
+                break;
+            case 0xDC:      // GET_DAQ_CLOCK
+                reply({0xFF, 0x00, 0x00, 0x00, bytes(clock, 0), bytes(clock, 1), bytes(clock, 2), bytes(clock, 3)});
+                break;
+            default:
+                reply({0xFF});
+                break;
+        }
+    }
+
+    uint8_t word(uint16_t value, int index) const {
+        return static_cast<uint8_t>(value >> ((motorola ? 1 - index : index) * 8));
+    }
+
+    uint8_t bytes(uint32_t value, int index) const {
+        return static_cast<uint8_t>(value >> ((motorola ? 3 - index : index) * 8));
+    }
+
+    void reply(const std::vector<uint8_t>& data) {
+        can->injectMessage(CANMessage(XcpConfig().responseId, data));
+    }
+
+    std::vector<XcpDaqList> engineList() const {
+        XcpDaqList list;
+        list.eventChannel = 1;
+        list.measurements = {
+            {"rpm", 0x1000, 0, XcpDataType::UINT16, 0.25, 0.0, "rpm"},
+            {"torque", 0x2000, 0, XcpDataType::INT32, 0.1, 0.0, "Nm"},
+            {"gear", 0x3000, 0, XcpDataType::UINT8, 1.0, 0.0, ""},
+            {"coolant", 0x4000, 0, XcpDataType::UINT8, 1.0, -40.0, "degC"},
+        };
+        return {list};
+    }
+
+    std::vector<std::vector<uint8_t>> commandsStartingWith(uint8_t code) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<std::vector<uint8_t>> matching;
+        for (const auto& command : commands) {
+            if (command[0] == code) {
+                matching.push_back(command);
+            }
+        }
+        return matching;
+    }
+
+    double latest(const std::string& name, int64_t* timestampUs = nullptr) {
+        LiveSample sample;
+        EXPECT_TRUE(store->readLatest(store->findChannel(name), sample)) << name;
+        if (timestampUs) {
+            *timestampUs = sample.timestampUs;
+        }
+        return sample.value;
+    }
+
+    std::shared_ptr<CANProtocol> can;
+    std::shared_ptr<LiveDataStore> store;
+    XcpMaster master;
+    bool motorola = false;
+    bool timestamps = false;
+    uint32_t clock = 0;
+
+    std::mutex mutex;
+    std::vector<std::vector<uint8_t>> commands;
+};
+
+} // anonymous namespace
+
+TEST_F(XcpTest, ConnectReadsTheSlaveProperties) {
+    ASSERT_TRUE(master.connect());
+    EXPECT_TRUE(master.isConnected());
+    EXPECT_EQ(commandsStartingWith(0xFF), (std::vector<std::vector<uint8_t>>{{0xFF, 0, 0, 0, 0, 0, 0, 0}}));
+
+    XcpSlaveInfo info = master.getSlaveInfo();
+    EXPECT_TRUE(info.supportsDaq());
+    EXPECT_FALSE(info.motorola);
+    EXPECT_EQ(info.maxCto, 8);
+    EXPECT_EQ(info.maxDto, 8);
+
+    master.disconnect();
+    motorola = true;
+    ASSERT_TRUE(master.connect());
+    EXPECT_TRUE(master.getSlaveInfo().motorola);
+    EXPECT_EQ(master.getSlaveInfo().maxDto, 8);
+}
+
+TEST_F(XcpTest, ConfigureDaqPacksMeasurementsIntoOdts) {
+    ASSERT_TRUE(master.connect());
+    ASSERT_TRUE(master.configureDaq(engineList(), store));
+
+    // rpm, torque and gear fill the first ODT's seven bytes; coolant starts a second
+    EXPECT_EQ(commandsStartingWith(0xD5), (std::vector<std::vector<uint8_t>>{{0xD5, 0, 1, 0, 0, 0, 0, 0}}));
+    EXPECT_EQ(commandsStartingWith(0xD4), (std::vector<std::vector<uint8_t>>{{0xD4, 0, 0, 0, 2, 0, 0, 0}}));
+    EXPECT_EQ(commandsStartingWith(0xD3), (std::vector<std::vector<uint8_t>>{{0xD3, 0, 0, 0, 0, 3, 0, 0},
+                                                                            {0xD3, 0, 0, 0, 1, 1, 0, 0}}));
+    auto writes = commandsStartingWith(0xE1);
+    ASSERT_EQ(writes.size(), 4u);
+    EXPECT_EQ(writes[0], (std::vector<uint8_t>{0xE1, 0xFF, 2, 0, 0x00, 0x10, 0x00, 0x00}));
+    EXPECT_EQ(writes[1], (std::vector<uint8_t>{0xE1, 0xFF, 4, 0, 0x00, 0x20, 0x00, 0x00}));
+    EXPECT_EQ(commandsStartingWith(0xE0), (std::vector<std::vector<uint8_t>>{{0xE0, 0, 0, 0, 1, 0, 1, 0}}));
+    EXPECT_EQ(commandsStartingWith(0xD6).size(), 1u);
+    EXPECT_EQ(store->getChannelCount(), 4u);
+    EXPECT_EQ(store->getChannelUnit(store->findChannel("torque")), "Nm");
+}
+
+TEST_F(XcpTest, DecodesOdtsIntoTheStore) {
+    ASSERT_TRUE(master.connect());
+    ASSERT_TRUE(master.configureDaq(engineList(), store));
+    ASSERT_TRUE(master.startDaq());
+    EXPECT_EQ(commandsStartingWith(0xDD).back(), (std::vector<uint8_t>{0xDD, 0x01, 0, 0, 0, 0, 0, 0}));
+
+    // rpm 3000 (raw 12000), torque -25.6 Nm (raw -256), gear 3; then coolant 90 degC
+    reply({FIRST_PID, 0xE0, 0x2E, 0x00, 0xFF, 0xFF, 0xFF, 0x03});
+    reply({FIRST_PID + 1, 130});
+    EXPECT_DOUBLE_EQ(latest("rpm"), 3000.0);
+    EXPECT_DOUBLE_EQ(latest("torque"), -25.6);
+    EXPECT_DOUBLE_EQ(latest("gear"), 3.0);
+    EXPECT_DOUBLE_EQ(latest("coolant"), 90.0);
+
+    // Unknown PIDs and DTOs too short for their entries
+    reply({0x20, 0x00});
+    reply({FIRST_PID});
+    auto stats = master.getStatistics();
+    EXPECT_EQ(stats.dtosReceived, 3u);
+    EXPECT_EQ(stats.dtosDropped, 1u);
+    EXPECT_EQ(stats.samplesPublished, 4u);
+
+    ASSERT_TRUE(master.stopDaq());
+    reply({FIRST_PID + 1, 140});
+    EXPECT_DOUBLE_EQ(latest("coolant"), 90.0);
+}
+
+TEST_F(XcpTest, DecodesInTheSlavesByteOrder) {
+    motorola = true;
+    ASSERT_TRUE(master.connect());
+    ASSERT_TRUE(master.configureDaq(engineList(), store));
+    EXPECT_EQ(commandsStartingWith(0xE1)[0], (std::vector<uint8_t>{0xE1, 0xFF, 2, 0, 0x00, 0x00, 0x10, 0x00}));
+    ASSERT_TRUE(master.startDaq());
+
+    reply({FIRST_PID, 0x2E, 0xE0, 0xFF, 0xFF, 0xFF, 0x00, 0x04});
+    EXPECT_DOUBLE_EQ(latest("rpm"), 3000.0);
+    EXPECT_DOUBLE_EQ(latest("torque"), -25.6);
+    EXPECT_DOUBLE_EQ(latest("gear"), 4.0);
+}
+
+TEST_F(XcpTest, TimestampsAreUnwrappedFromTheDaqClock) {
+    timestamps = true;
+    clock = 65000;
+    std::vector<XcpDaqList> lists(1);
+    lists[0].measurements = {{"speed", 0x5000, 0, XcpDataType::UINT8, 1.0, 0.0, "km/h"}};
+
+    ASSERT_TRUE(master.connect());
+    ASSERT_TRUE(master.configureDaq(lists, store));
+    EXPECT_EQ(commandsStartingWith(0xE0)[0][1], 0x10);
+    ASSERT_TRUE(master.startDaq());
+
+    int64_t first = 0;
+    int64_t second = 0;
+    reply({FIRST_PID, 0xE8, 0xFD, 50});         // 65000 ticks
+    latest("speed", &first);
+    reply({FIRST_PID, 0xF4, 0x01, 51});         // 500 ticks after the 16-bit counter wrapped
+    EXPECT_DOUBLE_EQ(latest("speed", &second), 51.0);
+    EXPECT_EQ(second - first, 1036);
+}
+
+TEST_F(XcpTest, ReconnectWhileDtosArrive) {
+    ASSERT_TRUE(master.connect());
+    ASSERT_TRUE(master.configureDaq(engineList(), store));
+    ASSERT_TRUE(master.startDaq());
+
+    std::atomic<bool> running{true};
+    std::thread slaveEvents([&] {
+        while (running) {
+            reply({FIRST_PID + 1, 130});
+        }
+    });
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_TRUE(master.connect());
+        EXPECT_FALSE(master.getSlaveInfo().motorola);
+    }
+    running = false;
+    slaveEvents.join();
+    EXPECT_GT(master.getStatistics().dtosReceived, 0u);
+}